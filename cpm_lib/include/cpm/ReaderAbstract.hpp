@@ -1,5 +1,9 @@
 #pragma once
 
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <dds/core/ddscore.hpp>
 #include <dds/sub/ddssub.hpp>
 #include "cpm/ParticipantSingleton.hpp"
 #include "cpm/get_topic.hpp"
@@ -18,8 +22,43 @@ namespace cpm
     {
     private:
 
+        /**
+         * \brief Conditions used by wait_for_messages, only created for readers that actually wait
+         */
+        struct WaitConditions
+        {
+            //! Triggered as long as the reader holds samples that have not been taken yet, see wait_for_messages
+            dds::sub::cond::ReadCondition read_condition;
+            //! Triggered by interrupt_wait, to wake up a thread blocked in wait_for_messages
+            dds::core::cond::GuardCondition interrupt_condition;
+            //! Waits for read_condition or interrupt_condition
+            dds::core::cond::WaitSet waitset;
+
+            WaitConditions(dds::sub::DataReader<T>& reader)
+            :read_condition(reader, dds::sub::status::DataState::any())
+            {
+                waitset += read_condition;
+                waitset += interrupt_condition;
+            }
+        };
+
         //! Internal DDS reader that is abstracted by this class
         dds::sub::DataReader<T> dds_reader;
+        //! Created on first use by get_wait_conditions, s.t. readers that only use take() do not create them
+        std::unique_ptr<WaitConditions> wait_conditions;
+        //! Makes sure wait_conditions is created only once, also if wait_for_messages and interrupt_wait are called concurrently
+        std::once_flag wait_conditions_created;
+
+        /**
+         * \brief Returns the conditions used by wait_for_messages, creates them on the first call
+         */
+        WaitConditions& get_wait_conditions()
+        {
+            std::call_once(wait_conditions_created, [this] () {
+                wait_conditions.reset(new WaitConditions(dds_reader));
+            });
+            return *wait_conditions;
+        }
 
         /**
          * \brief Returns qos for the settings s.t. the constructor becomes more readable
@@ -71,7 +110,6 @@ namespace cpm
         ReaderAbstract(std::string topic, bool reliable = false, bool history_keep_all = false, bool transient_local = false)
         :dds_reader(dds::sub::Subscriber(ParticipantSingleton::Instance()), cpm::get_topic<T>(topic), get_qos(reliable, history_keep_all, transient_local))
         { 
-            
         }
 
         /**
@@ -92,7 +130,6 @@ namespace cpm
         )
         :dds_reader(dds::sub::Subscriber(_participant), cpm::get_topic<T>(_participant, topic), get_qos(reliable, history_keep_all, transient_local))
         { 
-            
         }
         
         /**
@@ -115,6 +152,54 @@ namespace cpm
             return samples_vec;
         }
 
+        /**
+         * \brief Block until samples can be taken, interrupt_wait() was called or the timeout expired.
+         * Replaces polling take() in a loop with sleeps. The read condition stays triggered until all samples were taken,
+         * so samples that arrive between take() and wait_for_messages() are not missed.
+         * The underlying DDS conditions are only created on the first call.
+         * Must not be called by more than one thread at a time.
+         * \param timeout Maximum time to wait
+         * \return True if samples can be taken, false on timeout or interrupt without new samples
+         */
+        bool wait_for_messages(std::chrono::nanoseconds timeout)
+        {
+            WaitConditions& conditions = get_wait_conditions();
+
+            if (timeout.count() > 0)
+            {
+                try
+                {
+                    conditions.waitset.wait(dds::core::Duration(
+                        static_cast<int32_t>(timeout.count() / 1000000000ll),
+                        static_cast<uint32_t>(timeout.count() % 1000000000ll)
+                    ));
+                }
+                catch (const dds::core::TimeoutError&)
+                {
+                    //Timeout -> No samples were received, checked below
+                }
+            }
+
+            return conditions.read_condition.trigger_value();
+        }
+
+        /**
+         * \brief Wake up a thread that is blocked in wait_for_messages (e.g. to stop it).
+         * Further calls of wait_for_messages return immediately until reset_interrupt() is called.
+         */
+        void interrupt_wait()
+        {
+            get_wait_conditions().interrupt_condition.trigger_value(true);
+        }
+
+        /**
+         * \brief Undo interrupt_wait(), s.t. wait_for_messages blocks again
+         */
+        void reset_interrupt()
+        {
+            get_wait_conditions().interrupt_condition.trigger_value(false);
+        }
+
         /**
          * \brief Returns # of matched writers, needs template parameter for topic type
          */
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace cpm {
+    /**
+     * \class ThreadPool
+     * \brief Fixed set of worker threads for data-parallel loops, e.g. to step many simulated vehicles or obstacles
+     * in each period without creating threads (or std::async tasks) each time.
+     * The threads are created once in the constructor and sleep while no loop is running.
+     * Only one parallel_for can run at a time, concurrent calls are serialized.
+     * \ingroup cpmlib
+     */
+    class ThreadPool
+    {
+    private:
+        //! Worker threads, the calling thread of parallel_for works as well
+        std::vector<std::thread> workers;
+
+        //! Protects the job data below
+        std::mutex job_mutex;
+        //! Serializes concurrent calls of parallel_for
+        std::mutex parallel_for_mutex;
+        //! Wakes up the workers when a new job is available or the pool is destroyed
+        std::condition_variable job_available;
+        //! Notifies parallel_for when all workers left the current job
+        std::condition_variable job_finished;
+
+        //! Function of the current job, called for each index
+        std::function<void(size_t)> job_function;
+        //! Number of indices of the current job
+        size_t job_size = 0;
+        //! Next index that has not been claimed yet
+        std::atomic<size_t> job_next_index;
+        //! Incremented for each new job, so that workers do not run a job twice
+        uint64_t job_generation = 0;
+        //! Number of workers that still work on the current job
+        size_t active_workers = 0;
+        //! Set in the destructor
+        bool shutdown = false;
+
+        /**
+         * \brief Claim and process indices of the current job until none are left
+         */
+        void run_job();
+
+        /**
+         * \brief Loop of each worker thread
+         */
+        void worker_loop();
+
+    public:
+        /**
+         * \brief Create the pool
+         * \param n_threads Total number of threads that work on a loop, including the calling thread.
+         * 0 uses std::thread::hardware_concurrency()
+         */
+        ThreadPool(size_t n_threads = 0);
+
+        /**
+         * \brief Stops and joins all workers
+         */
+        ~ThreadPool();
+
+        ThreadPool(ThreadPool const&) = delete;
+        ThreadPool& operator=(ThreadPool const&) = delete;
+
+        /**
+         * \brief Call function(i) for all i in [0, n) on the pool and block until all calls returned.
+         * The order of the calls is not defined. Exceptions must be handled within the function.
+         * \param n Number of indices
+         * \param function Function to call for each index
+         */
+        void parallel_for(size_t n, std::function<void(size_t)> function);
+
+        /**
+         * \brief Total number of threads that work on a loop, including the calling thread
+         */
+        size_t size() const;
+    };
+}
@@ -0,0 +1,109 @@
+#include "cpm/ThreadPool.hpp"
+
+/**
+ * \file ThreadPool.cpp
+ * \ingroup cpmlib
+ */
+
+namespace cpm {
+    ThreadPool::ThreadPool(size_t n_threads)
+    {
+        if (n_threads == 0)
+        {
+            n_threads = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+        }
+
+        job_next_index.store(0);
+
+        // The calling thread of parallel_for is the last worker
+        for (size_t i = 1; i < n_threads; ++i)
+        {
+            workers.emplace_back(&ThreadPool::worker_loop, this);
+        }
+    }
+
+    ThreadPool::~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(job_mutex);
+            shutdown = true;
+        }
+        job_available.notify_all();
+
+        for (auto& worker : workers)
+        {
+            if (worker.joinable()) worker.join();
+        }
+    }
+
+    void ThreadPool::run_job()
+    {
+        while (true)
+        {
+            size_t i = job_next_index.fetch_add(1);
+            if (i >= job_size) break;
+            job_function(i);
+        }
+    }
+
+    void ThreadPool::worker_loop()
+    {
+        uint64_t last_generation = 0;
+
+        while (true)
+        {
+            {
+                std::unique_lock<std::mutex> lock(job_mutex);
+                job_available.wait(lock, [&](){ return shutdown || job_generation != last_generation; });
+                if (shutdown) return;
+                last_generation = job_generation;
+                ++active_workers;
+            }
+
+            run_job();
+
+            {
+                std::lock_guard<std::mutex> lock(job_mutex);
+                --active_workers;
+            }
+            job_finished.notify_all();
+        }
+    }
+
+    void ThreadPool::parallel_for(size_t n, std::function<void(size_t)> function)
+    {
+        if (n == 0) return;
+
+        std::lock_guard<std::mutex> parallel_for_lock(parallel_for_mutex);
+
+        // Not worth waking up the workers
+        if (workers.empty() || n == 1)
+        {
+            for (size_t i = 0; i < n; ++i) function(i);
+            return;
+        }
+
+        {
+            // A worker that woke up too late for the previous job may still be about to leave it
+            std::unique_lock<std::mutex> lock(job_mutex);
+            job_finished.wait(lock, [&](){ return active_workers == 0; });
+
+            job_function = function;
+            job_size = n;
+            job_next_index.store(0);
+            ++job_generation;
+        }
+        job_available.notify_all();
+
+        run_job();
+
+        // Workers that woke up late find no index left and leave immediately
+        std::unique_lock<std::mutex> lock(job_mutex);
+        job_finished.wait(lock, [&](){ return active_workers == 0 && job_next_index.load() >= job_size; });
+    }
+
+    size_t ThreadPool::size() const
+    {
+        return workers.size() + 1;
+    }
+}
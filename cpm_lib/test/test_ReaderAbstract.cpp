@@ -1,3 +1,6 @@
+#include <chrono>
+#include <thread>
+
 #include "catch.hpp"
 #include "cpm/dds/VehicleState.hpp"
 #include "cpm/ParticipantSingleton.hpp"
@@ -68,4 +71,54 @@ TEST_CASE( "ReaderAbstract" ) {
     {
         REQUIRE( std::find(received_odometer_values.begin(), received_odometer_values.end(), expected_value) != received_odometer_values.end() );
     }
-}
\ No newline at end of file
+}
+/**
+ * \test Tests ReaderAbstract::wait_for_messages
+ * 
+ * - Times out if nothing is sent
+ * - Wakes up when a sample is received, which can then be taken
+ * - Wakes up when interrupt_wait is called
+ * \ingroup cpmlib
+ */
+TEST_CASE( "ReaderAbstract_wait_for_messages" ) {
+    cpm::Logging::Instance().set_id("test_readerAbstract_wait");
+
+    cpm::Writer<VehicleState> sample_writer("ReaderAbstract_wait_for_messages", true, true);
+    cpm::ReaderAbstract<VehicleState> reader("ReaderAbstract_wait_for_messages", true, true);
+
+    //It usually takes some time for all instances to see each other - wait until then
+    while (reader.matched_publications_size() == 0 || sample_writer.matched_subscriptions_size() == 0)
+    {
+        usleep(10000); //Wait 10ms
+    }
+
+    //Nothing sent -> Timeout
+    auto start = std::chrono::steady_clock::now();
+    CHECK( !reader.wait_for_messages(std::chrono::milliseconds(50)) );
+    CHECK( std::chrono::steady_clock::now() - start >= std::chrono::milliseconds(40) );
+
+    //Sample sent -> Wake up, sample can be taken, afterwards the condition is no longer triggered
+    std::thread writer_thread([&] {
+        usleep(20000);
+        VehicleState vehicleState;
+        vehicleState.odometer_distance(42.0);
+        sample_writer.write(vehicleState);
+    });
+    REQUIRE( reader.wait_for_messages(std::chrono::seconds(1)) );
+    writer_thread.join();
+    auto samples = reader.take();
+    REQUIRE( samples.size() == 1 );
+    CHECK( samples.at(0).odometer_distance() == 42.0 );
+    CHECK( !reader.wait_for_messages(std::chrono::nanoseconds(0)) );
+
+    //Interrupt -> Wake up long before the timeout
+    start = std::chrono::steady_clock::now();
+    std::thread interrupt_thread([&] {
+        usleep(20000);
+        reader.interrupt_wait();
+    });
+    CHECK( !reader.wait_for_messages(std::chrono::seconds(2)) );
+    interrupt_thread.join();
+    CHECK( std::chrono::steady_clock::now() - start < std::chrono::seconds(1) );
+    reader.reset_interrupt();
+}
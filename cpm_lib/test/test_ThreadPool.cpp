@@ -0,0 +1,42 @@
+#include "catch.hpp"
+#include "cpm/ThreadPool.hpp"
+
+#include <atomic>
+#include <vector>
+
+/**
+ * \test Tests ThreadPool
+ * 
+ * - Is the function called exactly once for each index
+ * - Does parallel_for only return after all calls returned
+ * - Can the pool be reused for many consecutive loops of different sizes
+ * \ingroup cpmlib
+ */
+TEST_CASE( "ThreadPool" ) {
+    cpm::ThreadPool pool(4);
+    REQUIRE(pool.size() == 4);
+
+    for (size_t n : {0, 1, 3, 100, 10000})
+    {
+        for (int repetition = 0; repetition < 20; ++repetition)
+        {
+            std::vector<std::atomic<int>> calls(n);
+            for (auto& c : calls) c.store(0);
+
+            pool.parallel_for(n, [&](size_t i){
+                calls[i].fetch_add(1);
+            });
+
+            for (size_t i = 0; i < n; ++i)
+            {
+                REQUIRE(calls[i].load() == 1);
+            }
+        }
+    }
+
+    //Single threaded pool runs in the calling thread
+    cpm::ThreadPool single_pool(1);
+    int sum = 0;
+    single_pool.parallel_for(10, [&](size_t i){ sum += static_cast<int>(i); });
+    CHECK(sum == 45);
+}
@@ -74,11 +74,12 @@ std::string execute_command(const char* cmd)
 
 /**
  * \brief Helper function to check if a tmux session exists
+ * \param session_id ID of the tmux session
+ * \param running_sessions Output of tmux ls, so that it can be shared by several checks
  * \ingroup autostart
  */
-bool session_exists(std::string session_id)
+bool session_exists(std::string session_id, const std::string& running_sessions)
 {
-    std::string running_sessions = execute_command("tmux ls");
     session_id += ":";
     return running_sessions.find(session_id) != std::string::npos;
 }
@@ -164,8 +165,10 @@ int main (int argc, char *argv[]) {
 
     timer->start([&](uint64_t t_now) {
         //Check if script / middleware are running with hello msg (distinguish between simulation running / not running at receiver (LCC))
-        hello_msg.script_running(session_exists("script"));
-        hello_msg.middleware_running(session_exists("middleware"));
+        //Only spawn one process per check for both sessions
+        std::string running_sessions = execute_command("tmux ls");
+        hello_msg.script_running(session_exists("script", running_sessions));
+        hello_msg.middleware_running(session_exists("middleware", running_sessions));
 
         writer_readyMessage.write(hello_msg);
 
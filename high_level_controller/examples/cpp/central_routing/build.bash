@@ -13,4 +13,9 @@ sed -e "s/TEMPLATE_IP/${IP_SELF}/g" \
 cd build
 cmake .. -DCMAKE_BUILD_TYPE=Release
 make -j$(nproc)
+# Precompute the collision tables, so that the HLCs do not have to compute them at startup
+./generate_collision_table
+./generate_collision_table_reduced
+./generate_collision_table_150_jahre_RWTH_szenario
+./generate_collision_table_outer_circle
 cd ..
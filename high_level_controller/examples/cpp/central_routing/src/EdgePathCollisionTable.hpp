@@ -0,0 +1,195 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+#include "lane_graph.hpp"
+
+/**
+ * \class EdgePathCollisionTable
+ * \brief Table containing info about which pairs of points on the graph (edge index, edge path index) are collisions,
+ * i.e. vehicles standing on both points would be closer than the collision distance.
+ * \ingroup central_routing
+ *
+ * The table is symmetric, so only its upper triangle (including the diagonal) is stored, as a packed bitset.
+ * It can either be computed in memory or memory-mapped from a file written offline by generate_collision_table,
+ * so that the HLCs do not need to compute it at every startup. The file is named after a hash of the lane graph
+ * and the collision parameters (see get_file_name), so that a table is never used for the wrong graph.
+ */
+class EdgePathCollisionTable
+{
+    //! Header of a collision table file, followed by the bitset
+    struct FileHeader
+    {
+        //! Identifies the file format, see file_magic
+        char magic[8];
+        //! See compute_lane_graph_hash
+        uint64_t lane_graph_hash;
+        //! Number of edges of the lane graph
+        uint64_t n_edges;
+        //! Number of path nodes per edge
+        uint64_t n_edge_path_nodes;
+        //! Number of 64 bit words of the bitset
+        uint64_t n_words;
+    };
+
+    //! Identifies the file format (and its version)
+    static constexpr char file_magic[8] = {'C', 'P', 'M', 'E', 'P', 'C', 'T', '1'};
+
+    //! Number of edges of the lane graph
+    size_t n_edges = 0;
+    //! Number of path nodes per edge
+    size_t n_edge_path_nodes = 0;
+    //! Number of points on the graph, n_edges * n_edge_path_nodes
+    size_t n_points = 0;
+
+    //! Bitset, if computed in memory
+    std::vector<uint64_t> owned_words;
+    //! Bitset, either owned_words or mapped from a file
+    const uint64_t* words = nullptr;
+    //! Start of the mapped file (nullptr if the table was computed)
+    void* mapped_data = nullptr;
+    //! Size of the mapped file
+    size_t mapped_size = 0;
+
+    /**
+     * \brief Unmap the file, if a file was mapped
+     */
+    void unmap();
+
+    /**
+     * \brief Number of 64 bit words required for the upper triangle of a table with the given number of points
+     * \param n_points Number of points on the graph
+     */
+    static size_t get_n_words(size_t n_points);
+
+    /**
+     * \brief Index of the bit of two points in the upper triangle
+     * \param i Index of the first point (edge index * n_edge_path_nodes + edge path index)
+     * \param j Index of the second point, must not be smaller than i
+     */
+    inline size_t get_bit_index(size_t i, size_t j) const
+    {
+        //Row i of the upper triangle starts after the rows 0..i-1, which have n_points, n_points - 1, ... entries
+        return i * (2 * n_points - i + 1) / 2 + (j - i);
+    }
+
+public:
+    //! Creates an empty table
+    EdgePathCollisionTable() = default;
+    //! Unmaps the file, if a file was mapped
+    ~EdgePathCollisionTable();
+    //! Move constructor, the mapping is moved as well
+    EdgePathCollisionTable(EdgePathCollisionTable&& other);
+    //! Move assignment, the mapping is moved as well
+    EdgePathCollisionTable& operator=(EdgePathCollisionTable&& other);
+    EdgePathCollisionTable(const EdgePathCollisionTable&) = delete;
+    EdgePathCollisionTable& operator=(const EdgePathCollisionTable&) = delete;
+
+    /**
+     * \brief Compute the table in memory. The path nodes are sorted into a uniform grid, so that the exact
+     * (and expensive) distance between the vehicles is only computed for pairs of nodes whose bounding circles
+     * are closer than the collision distance. The rows of the table are distributed to a fixed number of threads.
+     * \param lane_graph The lane graph
+     * \param collision_distance Two points are a collision if the distance between vehicles standing on them is below this value, meters
+     */
+    static EdgePathCollisionTable compute(const LaneGraph &lane_graph, double collision_distance);
+
+    /**
+     * \brief Compute the table in memory for edge paths that are not given as a LaneGraph, e.g. a generated graph
+     * \param edges_x x-positions of the path nodes, per edge (all edges must have the same number of path nodes)
+     * \param edges_y y-positions of the path nodes, per edge
+     * \param edges_cos Cosine of the angle of the path nodes, per edge
+     * \param edges_sin Sine of the angle of the path nodes, per edge
+     * \param collision_distance See compute
+     */
+    static EdgePathCollisionTable compute(
+        const std::vector<std::vector<double>> &edges_x,
+        const std::vector<std::vector<double>> &edges_y,
+        const std::vector<std::vector<double>> &edges_cos,
+        const std::vector<std::vector<double>> &edges_sin,
+        double collision_distance);
+
+    /**
+     * \brief Hash of everything the table depends on: The edge paths of the lane graph, the vehicle dimensions and the collision distance
+     * \param lane_graph The lane graph
+     * \param collision_distance See compute
+     */
+    static uint64_t compute_lane_graph_hash(const LaneGraph &lane_graph, double collision_distance);
+
+    /**
+     * \brief Name of the table file for a lane graph hash
+     * \param lane_graph_hash See compute_lane_graph_hash
+     */
+    static std::string get_file_name(uint64_t lane_graph_hash);
+
+    /**
+     * \brief Folder of the running executable, where generate_collision_table writes the table files by default
+     */
+    static std::string get_executable_folder();
+
+    /**
+     * \brief Write the table to a file
+     * \param file_path Path of the file
+     * \param lane_graph_hash See compute_lane_graph_hash, stored in the file to check it when mapping the file
+     * \return False if the file could not be written
+     */
+    bool write_file(const std::string &file_path, uint64_t lane_graph_hash) const;
+
+    /**
+     * \brief Memory-map a table file (read-only, so it is shared by all processes that use it)
+     * \param file_path Path of the file
+     * \param lane_graph_hash Expected hash (see compute_lane_graph_hash)
+     * \param expected_n_edges Expected number of edges of the lane graph
+     * \param expected_n_edge_path_nodes Expected number of path nodes per edge
+     * \return False if the file does not exist or does not match, the table is unchanged then
+     */
+    bool map_file(const std::string &file_path, uint64_t lane_graph_hash, size_t expected_n_edges, size_t expected_n_edge_path_nodes);
+
+    /**
+     * \brief True if the table was mapped from a file
+     */
+    bool is_mapped() const { return mapped_data != nullptr; }
+
+    /**
+     * \brief Size of the bitset in bytes
+     */
+    size_t size_bytes() const { return get_n_words(n_points) * sizeof(uint64_t); }
+
+    /**
+     * \brief Index of a point of the graph, for the lookup by point indices.
+     * Allows to store paths as flat arrays of point indices.
+     * \param edge_index Edge of the point
+     * \param edge_path_index Edge path index of the point
+     */
+    inline size_t get_point_index(size_t edge_index, size_t edge_path_index) const
+    {
+        return edge_index * n_edge_path_nodes + edge_path_index;
+    }
+
+    /**
+     * \brief Check if vehicles on two points of the graph collide
+     * \param point_index_A First point, see get_point_index
+     * \param point_index_B Second point, see get_point_index
+     */
+    inline bool operator()(size_t point_index_A, size_t point_index_B) const
+    {
+        if (point_index_A > point_index_B) std::swap(point_index_A, point_index_B);
+
+        const size_t bit = get_bit_index(point_index_A, point_index_B);
+        return (words[bit >> 6] >> (bit & 63)) & 1u;
+    }
+
+    /**
+     * \brief Check if vehicles on two points of the graph collide
+     * \param edge_index_A Edge of the first point
+     * \param edge_path_index_A Edge path index of the first point
+     * \param edge_index_B Edge of the second point
+     * \param edge_path_index_B Edge path index of the second point
+     */
+    inline bool operator()(size_t edge_index_A, size_t edge_path_index_A, size_t edge_index_B, size_t edge_path_index_B) const
+    {
+        return (*this)(get_point_index(edge_index_A, edge_path_index_A), get_point_index(edge_index_B, edge_path_index_B));
+    }
+};
@@ -20,29 +20,49 @@
 MultiVehicleTrajectoryPlanner::MultiVehicleTrajectoryPlanner(uint64_t dt_nanos):dt_nanos(dt_nanos){}
 
 MultiVehicleTrajectoryPlanner::~MultiVehicleTrajectoryPlanner(){
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stop_planning = true;
+    }
+    real_time_cv.notify_all();
     if ( planning_thread.joinable() ) planning_thread.join();
 }
 
-std::vector<VehicleCommandTrajectory> MultiVehicleTrajectoryPlanner::get_trajectory_commands(uint64_t t_now)
+const std::vector<VehicleCommandTrajectory>& MultiVehicleTrajectoryPlanner::get_trajectory_commands(uint64_t t_now)
 {
     std::lock_guard<std::mutex> lock(mutex);
-    std::vector<VehicleCommandTrajectory> result;
+
+    // The buffers of all vehicles are created at once, in the first planning step
+    if (trajectory_commands.size() != trajectory_point_buffer.size())
+    {
+        trajectory_commands.clear();
+        for(auto &e:trajectory_point_buffer)
+        {
+            trajectory_commands.push_back(VehicleCommandTrajectory());
+            trajectory_commands.back().vehicle_id(e.first);
+        }
+    }
+
+    auto command_it = trajectory_commands.begin();
     for(auto &e:trajectory_point_buffer)
     {
-        VehicleCommandTrajectory vehicleCommandTrajectory;
-        vehicleCommandTrajectory.vehicle_id(e.first);
-        vehicleCommandTrajectory.trajectory_points(rti::core::vector<TrajectoryPoint>(e.second));
+        // The controller of the vehicle replaces its trajectory with each command, so the command
+        // has to contain all relevant points, but only those that changed are copied
+        VehicleCommandTrajectory &vehicleCommandTrajectory = *command_it++;
+        e.second.sync_trajectory_points(vehicleCommandTrajectory.trajectory_points());
         vehicleCommandTrajectory.header().create_stamp().nanoseconds(t_now); //You just need to set t_now here, as it was created at t_now
         vehicleCommandTrajectory.header().valid_after_stamp().nanoseconds(t_now + 1000000000ull); //Hardcoded value from the planner (t_start), should be correct (this value should correlate with the trajectory point that should be valid at t_now)
-        result.push_back(vehicleCommandTrajectory);
     }
-    return result;
+    return trajectory_commands;
 }
 
 void MultiVehicleTrajectoryPlanner::set_real_time(uint64_t t)
 {
-    std::lock_guard<std::mutex> lock(mutex);
-    t_real_time = t;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        t_real_time = t;
+    }
+    real_time_cv.notify_all();
 }
 
 
@@ -101,23 +121,15 @@ void MultiVehicleTrajectoryPlanner::start()
 
                 for(auto &e:trajectoryPlans)
                 {
+                    TrajectoryPointBuffer &buffer = trajectory_point_buffer[e.first];
+                    assert(!buffer.empty());
+
                     // delete all points that are no longer relevant
-                    // find latest point in the past
-                    std::vector<TrajectoryPoint>::iterator it_to_delete = trajectory_point_buffer[e.first].begin();
-                    assert(!trajectory_point_buffer[e.first].empty());
-                    for (std::vector<TrajectoryPoint>::iterator tp_it = trajectory_point_buffer[e.first].begin() + 1; tp_it != trajectory_point_buffer[e.first].end(); ++tp_it)
-                    {
-                        if (tp_it->t().nanoseconds() > t_real_time)
-                        {
-                            it_to_delete = tp_it-1;
-                            break;
-                        }
-                    }
-                    trajectory_point_buffer[e.first].erase(trajectory_point_buffer[e.first].begin(), it_to_delete);
+                    buffer.remove_past_points(t_real_time);
 
                     auto trajectory_point = e.second->get_trajectory_point();
                     trajectory_point.t().nanoseconds(trajectory_point.t().nanoseconds() + t_start);
-                    trajectory_point_buffer[e.first].push_back(trajectory_point);
+                    buffer.push_back(trajectory_point);
                 }
             }
 
@@ -128,8 +140,11 @@ void MultiVehicleTrajectoryPlanner::start()
 
             t_planning += dt_nanos;
 
-            while(t_real_time + T_PLAN_AHEAD_NANOS < t_planning) usleep(110000);
+            // Wait until the next timestep is needed, set_real_time wakes this up
+            std::unique_lock<std::mutex> lock(mutex);
+            real_time_cv.wait(lock, [&](){ return stop_planning || t_real_time + T_PLAN_AHEAD_NANOS >= t_planning; });
+            if (stop_planning) break;
         }
     });
 
-}
\ No newline at end of file
+}
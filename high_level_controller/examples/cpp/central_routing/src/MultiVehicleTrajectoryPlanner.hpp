@@ -1,10 +1,12 @@
 #pragma once
 
+#include <condition_variable>
 #include <memory>
 #include <mutex>
 #include <thread>
 #include "VehicleCommandTrajectory.hpp"
 #include "VehicleTrajectoryPlanningState.hpp"
+#include "TrajectoryPointBuffer.hpp"
 using std::vector;
 
 /**
@@ -24,12 +26,18 @@ class MultiVehicleTrajectoryPlanner
     uint64_t t_real_time = 0;
     //! TODO
     std::mutex mutex;
+    //! Notified by set_real_time, the planning thread waits on it until it may plan the next timestep
+    std::condition_variable real_time_cv;
+    //! Tells the planning thread to terminate, set by the destructor
+    bool stop_planning = false;
     //! TODO
     std::thread planning_thread;
     //! TODO
     const uint64_t dt_nanos;
-    //! TODO
-    std::map<uint8_t, std::vector<TrajectoryPoint> > trajectory_point_buffer;
+    //! Planned trajectory points that are still relevant, per vehicle
+    std::map<uint8_t, TrajectoryPointBuffer> trajectory_point_buffer;
+    //! Commands returned by get_trajectory_commands, in the order of trajectory_point_buffer; kept up to date incrementally
+    std::vector<VehicleCommandTrajectory> trajectory_commands;
 
 public:
     /**
@@ -44,14 +52,15 @@ public:
     ~MultiVehicleTrajectoryPlanner();
 
     /**
-     * \brief TODO
-     * \param t_now TODO
+     * \brief Trajectory commands for all vehicles. Only the points that changed since the last call are copied,
+     * so this must only be called from one thread. The commands stay valid until the next call.
+     * \param t_now Current time, nanoseconds
      */
-    std::vector<VehicleCommandTrajectory> get_trajectory_commands(uint64_t t_now);
+    const std::vector<VehicleCommandTrajectory>& get_trajectory_commands(uint64_t t_now);
 
     /**
-     * \brief TODO
-     * \param t TODO
+     * \brief Set the current time, which paces the planning thread
+     * \param t Current time, nanoseconds
      */
     void set_real_time(uint64_t t);
 
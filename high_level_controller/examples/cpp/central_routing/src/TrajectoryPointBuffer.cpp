@@ -0,0 +1,53 @@
+#include "TrajectoryPointBuffer.hpp"
+#include <cassert>
+
+/**
+ * \file TrajectoryPointBuffer.cpp
+ * \ingroup central_routing
+ */
+
+void TrajectoryPointBuffer::push_back(const TrajectoryPoint &point)
+{
+    assert(points.empty() || points.back().t().nanoseconds() <= point.t().nanoseconds());
+    points.push_back(point);
+    ++n_appended_since_sync;
+}
+
+void TrajectoryPointBuffer::remove_past_points(uint64_t t_now)
+{
+    // Keep all points if none of them is in the future
+    if (points.empty() || points.back().t().nanoseconds() <= t_now) return;
+
+    while (points.size() >= 2 && points[1].t().nanoseconds() <= t_now)
+    {
+        points.pop_front();
+        ++n_removed_since_sync;
+    }
+}
+
+void TrajectoryPointBuffer::sync_trajectory_points(rti::core::vector<TrajectoryPoint> &trajectory_points)
+{
+    const bool is_incremental = n_removed_since_sync <= trajectory_points.size()
+        && trajectory_points.size() - n_removed_since_sync + n_appended_since_sync == points.size()
+        && n_appended_since_sync <= points.size();
+
+    if (is_incremental)
+    {
+        trajectory_points.erase(trajectory_points.begin(), trajectory_points.begin() + n_removed_since_sync);
+        for (size_t i = points.size() - n_appended_since_sync; i < points.size(); ++i)
+        {
+            trajectory_points.push_back(points[i]);
+        }
+    }
+    else
+    {
+        trajectory_points.clear();
+        for (const TrajectoryPoint &point : points)
+        {
+            trajectory_points.push_back(point);
+        }
+    }
+
+    n_appended_since_sync = 0;
+    n_removed_since_sync = 0;
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include "VehicleCommandTrajectory.hpp"
+
+/**
+ * \class TrajectoryPointBuffer
+ * \brief Planned trajectory points of a vehicle that are still relevant: The latest point in the past and all future points.
+ * Points are appended at the back and removed from the front, both in constant time.
+ * The changes since the last call of sync_trajectory_points are tracked, s.t. a command can be kept up to date incrementally.
+ * \ingroup central_routing
+ */
+class TrajectoryPointBuffer
+{
+    //! The points, ordered by time
+    std::deque<TrajectoryPoint> points;
+    //! Number of points appended since the last sync_trajectory_points
+    size_t n_appended_since_sync = 0;
+    //! Number of points removed since the last sync_trajectory_points
+    size_t n_removed_since_sync = 0;
+
+public:
+    /**
+     * \brief Append a point, which must not be older than the last point
+     * \param point The point
+     */
+    void push_back(const TrajectoryPoint &point);
+
+    /**
+     * \brief Remove the points that are no longer relevant, i.e. all points in the past except for the latest one,
+     * s.t. a controller can still interpolate between it and the next one. Nothing is removed if there is no future point.
+     * \param t_now Current time, nanoseconds
+     */
+    void remove_past_points(uint64_t t_now);
+
+    /**
+     * \brief True if there are no points
+     */
+    bool empty() const {return points.empty();}
+
+    /**
+     * \brief Number of points
+     */
+    size_t size() const {return points.size();}
+
+    /**
+     * \brief Make trajectory_points equal to the buffer. If they were equal after the last call, only the points
+     * removed and appended since then are removed and appended, otherwise all points are copied.
+     * \param trajectory_points The points of the command of the vehicle
+     */
+    void sync_trajectory_points(rti::core::vector<TrajectoryPoint> &trajectory_points);
+};
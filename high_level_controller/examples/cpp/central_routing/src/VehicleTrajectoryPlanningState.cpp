@@ -115,48 +115,53 @@ TrajectoryPoint VehicleTrajectoryPlanningState::get_trajectory_point()
 
 // Change the own speed profile so as not to collide with the other_vehicles.
 bool VehicleTrajectoryPlanningState::avoid_collisions(
-    vector< std::shared_ptr<VehicleTrajectoryPlanningState> > other_vehicles)
+    const vector< std::shared_ptr<VehicleTrajectoryPlanningState> > &other_vehicles)
 {
+    const EdgePathCollisionTable &edge_path_collisions = laneGraphTools.edge_path_collisions;
+    int n_speed_reductions = 0;
+
     // TODO termination condition
     // for now: if this gets stuck the vehicles will stop, because they wont get a new command
     while(1)
     {
-        vector<std::pair<size_t, size_t>> self_path = get_planned_path();
+        compute_planned_path(planned_path);
 
         // An index exceeding N_STEPS_SPEED_PROFILE indicates that there is no collision
         size_t earliest_collision__speed_profile_index = 1<<30;
         int colliding_vehicle_id = 0;
 
         // Find the earliest collision
-        for(std::shared_ptr<VehicleTrajectoryPlanningState> other_vehicle:other_vehicles)
+        for(const std::shared_ptr<VehicleTrajectoryPlanningState> &other_vehicle:other_vehicles)
         {
-            vector<std::pair<size_t, size_t>> other_path = other_vehicle->get_planned_path();
+            // The other vehicles already planned, their paths do not change anymore
+            const PlannedPath &other_path = other_vehicle->get_planned_path();
 
-            assert(self_path.size() == N_STEPS_SPEED_PROFILE);
-            assert(other_path.size() == N_STEPS_SPEED_PROFILE);
+            // Collisions after the earliest one found so far do not matter
+            const size_t n_checked_steps = std::min<size_t>(earliest_collision__speed_profile_index, N_STEPS_SPEED_PROFILE);
 
-            for (size_t i = 0; i < N_STEPS_SPEED_PROFILE; ++i)
+            for (size_t i = 0; i < n_checked_steps; ++i)
             {
-                if(laneGraphTools.edge_path_collisions
-                    [self_path[i].first]
-                    [self_path[i].second]
-                    [other_path[i].first]
-                    [other_path[i].second])
+                if(edge_path_collisions(planned_path.point_indices[i], other_path.point_indices[i]))
                 {
-                    // collision detected
-                    if(i < earliest_collision__speed_profile_index)
-                    {
-                        earliest_collision__speed_profile_index = i;
-                        colliding_vehicle_id = other_vehicle->vehicle_id;
-                    }
-                    // earliest collision for this vehicle found, stop
+                    // collision detected, earliest collision for this vehicle found, stop
+                    earliest_collision__speed_profile_index = i;
+                    colliding_vehicle_id = other_vehicle->vehicle_id;
                     break;
                 }
             }
         }
 
         // stop if there is no collision
-        if(earliest_collision__speed_profile_index >= N_STEPS_SPEED_PROFILE) return true;
+        if(earliest_collision__speed_profile_index >= N_STEPS_SPEED_PROFILE)
+        {
+            // Printing every detected collision takes longer than detecting it, so only a summary is printed
+            if (n_speed_reductions > 0)
+            {
+                std::cout << "Vehicle " << int(vehicle_id) << ": reduced speed " << n_speed_reductions
+                    << " times to avoid collisions" << std::endl;
+            }
+            return true;
+        }
 
 
         // fix speed profile to avoid collision
@@ -170,13 +175,6 @@ bool VehicleTrajectoryPlanningState::avoid_collisions(
 
         const double reduced_speed = fmax(speed_profile[idx_speed_reduction] - 0.3, min_speed);
 
-        std::cout << 
-        "Collision detected t:" << earliest_collision__speed_profile_index << 
-        "  self id: " << int(vehicle_id) << 
-        "  other id: " << colliding_vehicle_id << 
-        "  Speed reduction,  t: " << idx_speed_reduction  << 
-        "  spd: " << reduced_speed << std::endl;
-
         if(idx_speed_reduction < 15)
         {
             cpm::Logging::Instance().write(
@@ -195,6 +193,7 @@ bool VehicleTrajectoryPlanningState::avoid_collisions(
         }
 
         set_speed(idx_speed_reduction, reduced_speed);
+        ++n_speed_reductions;
     }
     return true;
 }
@@ -225,10 +224,10 @@ void VehicleTrajectoryPlanningState::set_speed(int idx_speed_reduction, double s
     }
 }
 
-vector<std::pair<size_t, size_t>> VehicleTrajectoryPlanningState::get_planned_path()
+void VehicleTrajectoryPlanningState::compute_planned_path(PlannedPath &path_out)
 {
-    vector<std::pair<size_t, size_t>> result;
-    
+    const EdgePathCollisionTable &edge_path_collisions = laneGraphTools.edge_path_collisions;
+
     double delta_s = delta_s_path_node_offset;
     for (size_t i = 0; i < N_STEPS_SPEED_PROFILE; ++i)
     {
@@ -246,8 +245,7 @@ vector<std::pair<size_t, size_t>> VehicleTrajectoryPlanningState::get_planned_pa
             delta_s_copy
         );
 
-        result.push_back(std::make_pair(future_edge_index, future_edge_path_index));
+        path_out.point_indices[i] = static_cast<uint32_t>(
+            edge_path_collisions.get_point_index(future_edge_index, future_edge_path_index));
     }
-
-    return result;
-}
\ No newline at end of file
+}
@@ -11,6 +11,17 @@ using std::array;
 
 #define N_STEPS_SPEED_PROFILE (3000)
 
+/**
+ * \struct PlannedPath
+ * \brief Points of the lane graph (see EdgePathCollisionTable::get_point_index) that a vehicle passes, one per speed profile step.
+ * Has a fixed size, s.t. paths can be recomputed while planning without allocations.
+ * \ingroup central_routing
+ */
+struct PlannedPath
+{
+    //! Point index for each speed profile step
+    array<uint32_t, N_STEPS_SPEED_PROFILE> point_indices;
+};
 
 /**
  * \class VehicleTrajectoryPlanningState
@@ -49,6 +60,9 @@ class VehicleTrajectoryPlanningState
     //! TODO
     array<double, N_STEPS_SPEED_PROFILE> speed_profile;
 
+    //! Path for the current speed_profile, updated by avoid_collisions
+    PlannedPath planned_path;
+
     /**
      * \brief TODO
      */
@@ -61,9 +75,10 @@ class VehicleTrajectoryPlanningState
     void extend_random_route(size_t n);
 
     /**
-     * \brief TODO
+     * \brief Compute the path for the current speed_profile
+     * \param path_out Path to write into
      */
-    vector<std::pair<size_t, size_t>> get_planned_path();
+    void compute_planned_path(PlannedPath &path_out);
 
     /**
      * \brief TODO
@@ -102,9 +117,15 @@ public:
 
     /**
      * \brief Change the own speed profile so as not to collide with the other_vehicles.
-     * \param other_vehicles
+     * Their paths are not recomputed, see get_planned_path.
+     * \param other_vehicles Vehicles with a higher priority, which already planned in this timestep
+     */
+    bool avoid_collisions(const vector< std::shared_ptr<VehicleTrajectoryPlanningState> > &other_vehicles);
+
+    /**
+     * \brief Path planned by the last call of avoid_collisions
      */
-    bool avoid_collisions(vector< std::shared_ptr<VehicleTrajectoryPlanningState> > other_vehicles);
+    const PlannedPath& get_planned_path() const {return planned_path;}
 
     /**
      * \brief TODO
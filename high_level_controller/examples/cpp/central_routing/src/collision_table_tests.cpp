@@ -0,0 +1,321 @@
+#include "EdgePathCollisionTable.hpp"
+#include "geometry.hpp"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <future>
+#include <iostream>
+#include <string>
+#include <unistd.h>
+
+/**
+ * \file collision_table_tests.cpp
+ * \brief Checks that the packed edge path collision table, both computed in memory and mapped from a file,
+ * is bit-exact equal to the four-dimensional table that the HLCs used to compute at startup.
+ * Also measures the startup time of each variant. Which lane graph is used depends on the include directory set by CMake.
+ *
+ * Then does the same for a generated grid-like graph with as many edges as given by the first argument
+ * (default 1000, 0 to skip), compared to an exhaustive check of all pairs of points. Returns 1 if any tables differ.
+ * \ingroup central_routing
+ */
+
+//! Four-dimensional table, as it was computed by LaneGraphTools before the table could be mapped from a file
+using LegacyCollisionTable = std::vector< std::vector< std::vector< std::vector<bool> > > >;
+
+/**
+ * \brief Computes the table like LaneGraphTools did before, as the reference for the packed table
+ * \ingroup central_routing
+ * \param lane_graph The lane graph
+ */
+static LegacyCollisionTable compute_legacy_table(const LaneGraph &lane_graph)
+{
+    const size_t n_edges = lane_graph.n_edges;
+    const size_t n_edge_path_nodes = lane_graph.n_edge_path_nodes;
+    LegacyCollisionTable edge_path_collisions(
+        n_edges,
+        std::vector< std::vector< std::vector<bool> > >(
+            n_edge_path_nodes,
+            std::vector< std::vector<bool> >(n_edges, std::vector<bool>(n_edge_path_nodes, false))
+        )
+    );
+
+    std::vector<std::future<bool>> jobs;
+    for (size_t i_edge_A = 0; i_edge_A < n_edges; ++i_edge_A)
+    {
+        jobs.push_back(std::async(std::launch::async,
+            [&lane_graph, &edge_path_collisions, i_edge_A, n_edges, n_edge_path_nodes](){
+                for (size_t i_path_A = 0; i_path_A < n_edge_path_nodes; ++i_path_A)
+                {
+                    PathNode nodeA (
+                        lane_graph.edges_x.at(i_edge_A).at(i_path_A),
+                        lane_graph.edges_y.at(i_edge_A).at(i_path_A),
+                        lane_graph.edges_cos.at(i_edge_A).at(i_path_A),
+                        lane_graph.edges_sin.at(i_edge_A).at(i_path_A)
+                    );
+
+                    for (size_t i_edge_B = 0; i_edge_B < n_edges; ++i_edge_B)
+                    {
+                        for (size_t i_path_B = 0; i_path_B < n_edge_path_nodes; ++i_path_B)
+                        {
+                            PathNode nodeB (
+                                lane_graph.edges_x.at(i_edge_B).at(i_path_B),
+                                lane_graph.edges_y.at(i_edge_B).at(i_path_B),
+                                lane_graph.edges_cos.at(i_edge_B).at(i_path_B),
+                                lane_graph.edges_sin.at(i_edge_B).at(i_path_B)
+                            );
+
+                            const double distance = min_distance_vehicle_to_vehicle(nodeA, nodeB);
+                            edge_path_collisions.at(i_edge_A).at(i_path_A).at(i_edge_B).at(i_path_B) = (distance < EDGE_PATH_COLLISION_DISTANCE);
+                        }
+                    }
+                }
+                return true;
+            }
+        ));
+    }
+
+    for(auto& job:jobs)
+    {
+        job.get();
+    }
+    return edge_path_collisions;
+}
+
+/**
+ * \brief Compares all entries of the packed table with the legacy table
+ * \ingroup central_routing
+ * \return Number of differing entries
+ */
+static size_t count_differences(const LaneGraph &lane_graph, const LegacyCollisionTable &expected, const EdgePathCollisionTable &table)
+{
+    size_t differences = 0;
+    for (size_t i_edge_A = 0; i_edge_A < lane_graph.n_edges; ++i_edge_A)
+    {
+        for (size_t i_path_A = 0; i_path_A < lane_graph.n_edge_path_nodes; ++i_path_A)
+        {
+            for (size_t i_edge_B = 0; i_edge_B < lane_graph.n_edges; ++i_edge_B)
+            {
+                for (size_t i_path_B = 0; i_path_B < lane_graph.n_edge_path_nodes; ++i_path_B)
+                {
+                    if (table(i_edge_A, i_path_A, i_edge_B, i_path_B) != expected[i_edge_A][i_path_A][i_edge_B][i_path_B])
+                    {
+                        ++differences;
+                    }
+                }
+            }
+        }
+    }
+    return differences;
+}
+
+//! Edge paths of a generated graph, see make_synthetic_graph
+struct SyntheticGraph
+{
+    //! x-positions of the path nodes, per edge
+    std::vector<std::vector<double>> edges_x;
+    //! y-positions of the path nodes, per edge
+    std::vector<std::vector<double>> edges_y;
+    //! Cosine of the angle of the path nodes, per edge
+    std::vector<std::vector<double>> edges_cos;
+    //! Sine of the angle of the path nodes, per edge
+    std::vector<std::vector<double>> edges_sin;
+};
+
+/**
+ * \brief Generates a grid of streets (1 m apart) with one lane per direction, with straight edges between the crossings.
+ * Vehicles collide at the crossings and on consecutive edges, but not with the opposite lane.
+ * \ingroup central_routing
+ * \param n_edges Number of edges
+ * \param n_edge_path_nodes Number of path nodes per edge
+ */
+static SyntheticGraph make_synthetic_graph(size_t n_edges, size_t n_edge_path_nodes)
+{
+    const double street_distance = 1.0;
+    const double lane_offset = 0.1;
+    const size_t n_streets = static_cast<size_t>(std::ceil(std::sqrt(n_edges / 4.0))) + 1;
+
+    SyntheticGraph graph;
+    for (size_t i_edge = 0; i_edge < n_edges; ++i_edge)
+    {
+        // Edge index -> street (horizontal/vertical), direction and segment between two crossings
+        const bool vertical = (i_edge % 2) == 1;
+        const bool reverse = ((i_edge / 2) % 2) == 1;
+        const size_t segment = (i_edge / 4) % (n_streets - 1);
+        const size_t street = (i_edge / 4) / (n_streets - 1);
+
+        const double direction = reverse ? -1.0 : 1.0;
+        const double along_start = (reverse ? segment + 1 : segment) * street_distance;
+        const double across = street * street_distance - direction * lane_offset;
+
+        std::vector<double> x, y, c, s;
+        for (size_t i_path = 0; i_path < n_edge_path_nodes; ++i_path)
+        {
+            const double along = along_start + direction * street_distance * i_path / (n_edge_path_nodes - 1);
+            x.push_back(vertical ? across : along);
+            y.push_back(vertical ? along : across);
+            c.push_back(vertical ? 0.0 : direction);
+            s.push_back(vertical ? direction : 0.0);
+        }
+        graph.edges_x.push_back(x);
+        graph.edges_y.push_back(y);
+        graph.edges_cos.push_back(c);
+        graph.edges_sin.push_back(s);
+    }
+    return graph;
+}
+
+/**
+ * \brief Compares the packed table with the exact distance of all pairs of points, without storing the expected table
+ * \ingroup central_routing
+ * \return Number of differing entries
+ */
+static size_t count_differences_exhaustive(const SyntheticGraph &graph, const EdgePathCollisionTable &table)
+{
+    const size_t n_edges = graph.edges_x.size();
+    const size_t n_edge_path_nodes = graph.edges_x.at(0).size();
+    auto get_node = [&graph] (size_t i_edge, size_t i_path) {
+        return PathNode(graph.edges_x[i_edge][i_path], graph.edges_y[i_edge][i_path], graph.edges_cos[i_edge][i_path], graph.edges_sin[i_edge][i_path]);
+    };
+
+    std::vector<std::future<size_t>> jobs;
+    for (size_t i_edge_A = 0; i_edge_A < n_edges; ++i_edge_A)
+    {
+        jobs.push_back(std::async(std::launch::async,
+            [&get_node, &table, i_edge_A, n_edges, n_edge_path_nodes](){
+                size_t differences = 0;
+                for (size_t i_path_A = 0; i_path_A < n_edge_path_nodes; ++i_path_A)
+                {
+                    const PathNode nodeA = get_node(i_edge_A, i_path_A);
+                    // The table is symmetric, so the lower triangle is checked by count_differences for the shipped graphs only
+                    for (size_t i_edge_B = i_edge_A; i_edge_B < n_edges; ++i_edge_B)
+                    {
+                        for (size_t i_path_B = (i_edge_B == i_edge_A) ? i_path_A : 0; i_path_B < n_edge_path_nodes; ++i_path_B)
+                        {
+                            const bool expected = min_distance_vehicle_to_vehicle(nodeA, get_node(i_edge_B, i_path_B)) < EDGE_PATH_COLLISION_DISTANCE;
+                            if (table(i_edge_A, i_path_A, i_edge_B, i_path_B) != expected)
+                            {
+                                ++differences;
+                            }
+                        }
+                    }
+                }
+                return differences;
+            }
+        ));
+    }
+
+    size_t differences = 0;
+    for(auto& job:jobs)
+    {
+        differences += job.get();
+    }
+    return differences;
+}
+
+/**
+ * \brief Time since start in milliseconds
+ * \ingroup central_routing
+ */
+static double milliseconds_since(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char *argv[])
+{
+    const size_t n_synthetic_edges = (argc > 1) ? std::strtoul(argv[1], nullptr, 10) : 1000;
+
+    const LaneGraph lane_graph;
+    bool success = true;
+
+    auto start = std::chrono::steady_clock::now();
+    const LegacyCollisionTable legacy_table = compute_legacy_table(lane_graph);
+    const double legacy_ms = milliseconds_since(start);
+
+    start = std::chrono::steady_clock::now();
+    const EdgePathCollisionTable computed_table = EdgePathCollisionTable::compute(lane_graph, EDGE_PATH_COLLISION_DISTANCE);
+    const double compute_ms = milliseconds_since(start);
+
+    const size_t computed_differences = count_differences(lane_graph, legacy_table, computed_table);
+    if (computed_differences != 0)
+    {
+        std::cerr << "Computed collision table differs from the legacy table in " << computed_differences << " entries" << std::endl;
+        success = false;
+    }
+
+    // Round trip through a file, like generate_collision_table and LaneGraphTools do it
+    const uint64_t lane_graph_hash = EdgePathCollisionTable::compute_lane_graph_hash(lane_graph, EDGE_PATH_COLLISION_DISTANCE);
+    const std::string file_path = "/tmp/" + std::to_string(getpid()) + "_" + EdgePathCollisionTable::get_file_name(lane_graph_hash);
+    if (!computed_table.write_file(file_path, lane_graph_hash))
+    {
+        std::cerr << "Could not write " << file_path << std::endl;
+        return 1;
+    }
+
+    start = std::chrono::steady_clock::now();
+    EdgePathCollisionTable mapped_table;
+    const bool mapped = mapped_table.map_file(file_path, lane_graph_hash, lane_graph.n_edges, lane_graph.n_edge_path_nodes);
+    const double map_ms = milliseconds_since(start);
+
+    if (!mapped || !mapped_table.is_mapped())
+    {
+        std::cerr << "Could not map " << file_path << std::endl;
+        success = false;
+    }
+    else
+    {
+        const size_t mapped_differences = count_differences(lane_graph, legacy_table, mapped_table);
+        if (mapped_differences != 0)
+        {
+            std::cerr << "Mapped collision table differs from the legacy table in " << mapped_differences << " entries" << std::endl;
+            success = false;
+        }
+    }
+
+    // A table file of a different lane graph or collision distance must be rejected
+    EdgePathCollisionTable rejected_table;
+    if (rejected_table.map_file(file_path, lane_graph_hash + 1, lane_graph.n_edges, lane_graph.n_edge_path_nodes)
+        || rejected_table.map_file(file_path, lane_graph_hash, lane_graph.n_edges + 1, lane_graph.n_edge_path_nodes))
+    {
+        std::cerr << "A table file with a wrong hash or size was mapped" << std::endl;
+        success = false;
+    }
+    std::remove(file_path.c_str());
+
+    const size_t n_points = lane_graph.n_edges * lane_graph.n_edge_path_nodes;
+    std::cout << "Collision table for " << lane_graph.n_edges << " edges: "
+        << n_points * n_points << " entries, " << computed_table.size_bytes() << " bytes packed" << std::endl;
+    std::cout << "Startup time [ms]: legacy table " << legacy_ms
+        << ", packed table computed " << compute_ms
+        << ", packed table mapped " << map_ms << std::endl;
+
+    if (n_synthetic_edges > 0)
+    {
+        const SyntheticGraph synthetic_graph = make_synthetic_graph(n_synthetic_edges, lane_graph.n_edge_path_nodes);
+
+        start = std::chrono::steady_clock::now();
+        const EdgePathCollisionTable synthetic_table = EdgePathCollisionTable::compute(
+            synthetic_graph.edges_x, synthetic_graph.edges_y, synthetic_graph.edges_cos, synthetic_graph.edges_sin, EDGE_PATH_COLLISION_DISTANCE);
+        const double synthetic_compute_ms = milliseconds_since(start);
+
+        start = std::chrono::steady_clock::now();
+        const size_t synthetic_differences = count_differences_exhaustive(synthetic_graph, synthetic_table);
+        const double synthetic_exhaustive_ms = milliseconds_since(start);
+
+        if (synthetic_differences != 0)
+        {
+            std::cerr << "Collision table of the generated graph differs from the exhaustive check in " << synthetic_differences << " entries" << std::endl;
+            success = false;
+        }
+
+        std::cout << "Generated graph with " << n_synthetic_edges << " edges, build time [ms]: packed table computed " << synthetic_compute_ms
+            << ", exhaustive check of all pairs " << synthetic_exhaustive_ms << std::endl;
+    }
+
+    if (!success)
+    {
+        return 1;
+    }
+    return 0;
+}
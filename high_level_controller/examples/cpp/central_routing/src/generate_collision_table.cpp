@@ -0,0 +1,32 @@
+#include "EdgePathCollisionTable.hpp"
+#include "geometry.hpp"
+#include <iostream>
+#include <string>
+
+/**
+ * \file generate_collision_table.cpp
+ * \brief Computes the edge path collision table of the lane graph (which one depends on the include directory set by CMake)
+ * and writes it to a file, which the HLCs map at startup instead of computing the table themselves.
+ * The file is written next to the executable, or to the folder given as first argument.
+ * \ingroup central_routing
+ */
+
+int main(int argc, char *argv[])
+{
+    const std::string output_folder = (argc > 1) ? argv[1] : EdgePathCollisionTable::get_executable_folder();
+
+    // Only the lane graph itself is needed here, LaneGraphTools would compute the table at startup
+    const LaneGraph lane_graph;
+    const uint64_t lane_graph_hash = EdgePathCollisionTable::compute_lane_graph_hash(lane_graph, EDGE_PATH_COLLISION_DISTANCE);
+    const std::string file_path = output_folder + "/" + EdgePathCollisionTable::get_file_name(lane_graph_hash);
+
+    const EdgePathCollisionTable table = EdgePathCollisionTable::compute(lane_graph, EDGE_PATH_COLLISION_DISTANCE);
+    if (!table.write_file(file_path, lane_graph_hash))
+    {
+        std::cerr << "Could not write the collision table to " << file_path << std::endl;
+        return 1;
+    }
+
+    std::cout << "Wrote collision table for " << lane_graph.n_edges << " edges (" << table.size_bytes() << " bytes) to " << file_path << std::endl;
+    return 0;
+}
@@ -6,6 +6,8 @@ using std::vector;
 
 #define VEHICLE_HALF_LENGTH (0.15)
 #define VEHICLE_HALF_WIDTH (0.06)
+//! Two points of the lane graph are a collision if the distance between vehicles standing on them is below this value, meters
+#define EDGE_PATH_COLLISION_DISTANCE (0.01)
 
 /**
  * \struct PathNode
@@ -169,7 +169,7 @@ int main(int argc, char *argv[])
                 planner->start();
             }
             //get trajectory commands from MultiVehicleTrajectoryPlanner with new points for each vehicle ID
-            auto commands = planner->get_trajectory_commands(t_now);
+            const auto &commands = planner->get_trajectory_commands(t_now);
 
             for(auto& command:commands)
             {
@@ -0,0 +1,181 @@
+#include "lane_graph_tools.hpp"
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+
+/**
+ * \file map_matching_tests.cpp
+ * \brief Checks that LaneGraphTools::map_match_pose (grid search) and LaneGraphTools::find_subsequent_edges (adjacency lists)
+ * give the same results as searching all path nodes / edges, and measures the speed-up of map_match_pose.
+ * The number of random poses can be given as first argument (default 100000). Returns 1 if any result differs.
+ * \ingroup central_routing
+ */
+
+/**
+ * \brief Map matching by searching all path nodes, as LaneGraphTools did before
+ * \ingroup central_routing
+ */
+static bool map_match_pose_exhaustive(const LaneGraphTools &graph, Pose2D pose, int &out_edge_index, int &out_edge_path_index)
+{
+    bool match_found = false;
+    double min_squared_distance = 1e300;
+
+    for (size_t i_edge = 0; i_edge < graph.n_edges; ++i_edge)
+    {
+        for (size_t i_path = 0; i_path < graph.n_edge_path_nodes; ++i_path)
+        {
+            const double x = graph.edges_x[i_edge][i_path];
+            const double y = graph.edges_y[i_edge][i_path];
+            const double c = graph.edges_cos[i_edge][i_path];
+            const double s = graph.edges_sin[i_edge][i_path];
+
+            const double cos_delta_yaw = c * cos(pose.yaw()) + s * sin(pose.yaw());
+            const double dx = x - pose.x();
+            const double dy = y - pose.y();
+            const double squared_distance = dx*dx + dy*dy;
+
+            if( cos_delta_yaw > 0.7
+                && squared_distance < 0.09
+                && squared_distance < min_squared_distance)
+            {
+                match_found = true;
+                out_edge_index = i_edge;
+                out_edge_path_index = i_path;
+                min_squared_distance = squared_distance;
+            }
+        }
+    }
+    return match_found;
+}
+
+/**
+ * \brief Time since start in milliseconds
+ * \ingroup central_routing
+ */
+static double milliseconds_since(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char *argv[])
+{
+    const size_t n_poses = (argc > 1) ? std::strtoul(argv[1], nullptr, 10) : 100000;
+    bool success = true;
+
+    // Subsequent edges
+    for (size_t i_edge = 0; i_edge < laneGraphTools.n_edges; ++i_edge)
+    {
+        vector<size_t> expected;
+        for (size_t i_next_edge = 0; i_next_edge < laneGraphTools.n_edges; ++i_next_edge)
+        {
+            if (laneGraphTools.edges_start_index[i_next_edge] == laneGraphTools.edges_end_index[i_edge])
+            {
+                expected.push_back(i_next_edge);
+            }
+        }
+        if (laneGraphTools.find_subsequent_edges(i_edge) != expected)
+        {
+            std::cerr << "Subsequent edges of edge " << i_edge << " differ" << std::endl;
+            success = false;
+        }
+    }
+
+    // Random poses: Half of them anywhere around the map, half of them close to a path node with a similar heading
+    double min_x = 1e300, max_x = -1e300, min_y = 1e300, max_y = -1e300;
+    for (size_t i_edge = 0; i_edge < laneGraphTools.n_edges; ++i_edge)
+    {
+        for (size_t i_path = 0; i_path < laneGraphTools.n_edge_path_nodes; ++i_path)
+        {
+            min_x = fmin(min_x, laneGraphTools.edges_x[i_edge][i_path]);
+            max_x = fmax(max_x, laneGraphTools.edges_x[i_edge][i_path]);
+            min_y = fmin(min_y, laneGraphTools.edges_y[i_edge][i_path]);
+            max_y = fmax(max_y, laneGraphTools.edges_y[i_edge][i_path]);
+        }
+    }
+
+    std::mt19937 random_engine(42);
+    std::uniform_real_distribution<double> random_x(min_x - 0.5, max_x + 0.5);
+    std::uniform_real_distribution<double> random_y(min_y - 0.5, max_y + 0.5);
+    std::uniform_real_distribution<double> random_yaw(-M_PI, M_PI);
+    std::uniform_int_distribution<size_t> random_edge(0, laneGraphTools.n_edges - 1);
+    std::uniform_int_distribution<size_t> random_path(0, laneGraphTools.n_edge_path_nodes - 1);
+    std::normal_distribution<double> random_offset(0.0, 0.15);
+    std::normal_distribution<double> random_yaw_offset(0.0, 0.5);
+
+    std::vector<Pose2D> poses;
+    for (size_t i = 0; i < n_poses; ++i)
+    {
+        if (i % 2 == 0)
+        {
+            poses.push_back(Pose2D(random_x(random_engine), random_y(random_engine), random_yaw(random_engine)));
+        }
+        else
+        {
+            const size_t i_edge = random_edge(random_engine);
+            const size_t i_path = random_path(random_engine);
+            poses.push_back(Pose2D(
+                laneGraphTools.edges_x[i_edge][i_path] + random_offset(random_engine),
+                laneGraphTools.edges_y[i_edge][i_path] + random_offset(random_engine),
+                atan2(laneGraphTools.edges_sin[i_edge][i_path], laneGraphTools.edges_cos[i_edge][i_path]) + random_yaw_offset(random_engine)
+            ));
+        }
+    }
+
+    // Path nodes themselves, to check equal distances
+    for (size_t i_edge = 0; i_edge < laneGraphTools.n_edges; ++i_edge)
+    {
+        for (size_t i_path = 0; i_path < laneGraphTools.n_edge_path_nodes; ++i_path)
+        {
+            poses.push_back(Pose2D(
+                laneGraphTools.edges_x[i_edge][i_path],
+                laneGraphTools.edges_y[i_edge][i_path],
+                atan2(laneGraphTools.edges_sin[i_edge][i_path], laneGraphTools.edges_cos[i_edge][i_path])
+            ));
+        }
+    }
+
+    std::vector<int> expected_edges(poses.size(), -1), expected_paths(poses.size(), -1);
+    std::vector<bool> expected_matches(poses.size());
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < poses.size(); ++i)
+    {
+        expected_matches[i] = map_match_pose_exhaustive(laneGraphTools, poses[i], expected_edges[i], expected_paths[i]);
+    }
+    const double exhaustive_ms = milliseconds_since(start);
+
+    std::vector<int> edges(poses.size(), -1), paths(poses.size(), -1);
+    std::vector<bool> matches(poses.size());
+    start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < poses.size(); ++i)
+    {
+        matches[i] = laneGraphTools.map_match_pose(poses[i], edges[i], paths[i]);
+    }
+    const double grid_ms = milliseconds_since(start);
+
+    size_t n_matches = 0;
+    size_t n_differences = 0;
+    for (size_t i = 0; i < poses.size(); ++i)
+    {
+        if (matches[i]) ++n_matches;
+        if (matches[i] != expected_matches[i] || edges[i] != expected_edges[i] || paths[i] != expected_paths[i])
+        {
+            ++n_differences;
+        }
+    }
+    if (n_differences > 0)
+    {
+        std::cerr << "map_match_pose differs from the exhaustive search for " << n_differences << " poses" << std::endl;
+        success = false;
+    }
+
+    std::cout << "Map matching of " << poses.size() << " poses (" << n_matches << " matched) [ms]: exhaustive " << exhaustive_ms
+        << ", grid " << grid_ms << ", speed-up " << exhaustive_ms / grid_ms << std::endl;
+
+    if (!success)
+    {
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,180 @@
+#include "TrajectoryPointBuffer.hpp"
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <vector>
+
+/**
+ * \file trajectory_buffer_tests.cpp
+ * \brief Checks that the trajectory commands of MultiVehicleTrajectoryPlanner, built incrementally from a TrajectoryPointBuffer
+ * per vehicle, contain the same points as the commands built from scratch from a std::vector per vehicle, as the planner did before.
+ * Also measures the time per timestep of both, for updating the buffers (like the planning thread) and for building the
+ * commands (like get_trajectory_commands). The number of vehicles and timesteps can be given as first and second argument
+ * (default 50 and 10000). Returns 1 if any command differs.
+ * \ingroup central_routing
+ */
+
+//! Length of a timestep in nanoseconds, same as in main.cpp
+static const uint64_t dt_nanos = 400000000ull;
+
+//! How far the planner plans ahead, same as T_PLAN_AHEAD_NANOS in MultiVehicleTrajectoryPlanner.cpp
+static const uint64_t t_plan_ahead_nanos = 6000000000ull;
+
+/**
+ * \brief Trajectory point of a vehicle at a time
+ * \ingroup central_routing
+ */
+static TrajectoryPoint get_point(uint8_t vehicle_id, uint64_t t)
+{
+    TrajectoryPoint point;
+    point.t().nanoseconds(t);
+    point.px(vehicle_id + 1e-9 * t);
+    point.py(vehicle_id);
+    point.vx(1.0);
+    point.vy(0.0);
+    return point;
+}
+
+/**
+ * \brief Remove the points that are no longer relevant, as MultiVehicleTrajectoryPlanner did before
+ * \ingroup central_routing
+ */
+static void remove_past_points_legacy(std::vector<TrajectoryPoint> &buffer, uint64_t t_real_time)
+{
+    std::vector<TrajectoryPoint>::iterator it_to_delete = buffer.begin();
+    for (std::vector<TrajectoryPoint>::iterator tp_it = buffer.begin() + 1; tp_it != buffer.end(); ++tp_it)
+    {
+        if (tp_it->t().nanoseconds() > t_real_time)
+        {
+            it_to_delete = tp_it-1;
+            break;
+        }
+    }
+    buffer.erase(buffer.begin(), it_to_delete);
+}
+
+/**
+ * \brief Build the commands, as MultiVehicleTrajectoryPlanner did before
+ * \ingroup central_routing
+ */
+static std::vector<VehicleCommandTrajectory> get_trajectory_commands_legacy(
+    const std::map<uint8_t, std::vector<TrajectoryPoint> > &trajectory_point_buffer,
+    uint64_t t_now)
+{
+    std::vector<VehicleCommandTrajectory> result;
+    for(auto &e:trajectory_point_buffer)
+    {
+        VehicleCommandTrajectory vehicleCommandTrajectory;
+        vehicleCommandTrajectory.vehicle_id(e.first);
+        vehicleCommandTrajectory.trajectory_points(rti::core::vector<TrajectoryPoint>(e.second));
+        vehicleCommandTrajectory.header().create_stamp().nanoseconds(t_now);
+        vehicleCommandTrajectory.header().valid_after_stamp().nanoseconds(t_now + 1000000000ull);
+        result.push_back(vehicleCommandTrajectory);
+    }
+    return result;
+}
+
+/**
+ * \brief Main of the trajectory buffer tests
+ * \ingroup central_routing
+ */
+int main(int argc, char *argv[])
+{
+    const int n_vehicles = (argc > 1) ? std::max(1, std::min(254, atoi(argv[1]))) : 50;
+    const int n_timesteps = (argc > 2) ? std::max(1, atoi(argv[2])) : 10000;
+
+    std::map<uint8_t, std::vector<TrajectoryPoint> > legacy_buffers;
+    std::map<uint8_t, TrajectoryPointBuffer> buffers;
+    std::vector<VehicleCommandTrajectory> commands;
+
+    double legacy_update_ms = 0;
+    double legacy_commands_ms = 0;
+    double update_ms = 0;
+    double commands_ms = 0;
+    size_t n_points = 0;
+
+    uint64_t t_real_time = 1000000000000ull;
+    uint64_t t_planning = t_real_time;
+    for (int timestep = 0; timestep < n_timesteps; ++timestep)
+    {
+        // The planning thread plans up to T_PLAN_AHEAD_NANOS ahead, one point per vehicle and timestep
+        while (t_planning <= t_real_time + t_plan_ahead_nanos)
+        {
+            auto t_0 = std::chrono::steady_clock::now();
+            for (int i = 1; i <= n_vehicles; ++i)
+            {
+                auto &buffer = legacy_buffers[i];
+                if (!buffer.empty()) remove_past_points_legacy(buffer, t_real_time);
+                buffer.push_back(get_point(i, t_planning));
+            }
+            auto t_1 = std::chrono::steady_clock::now();
+            for (int i = 1; i <= n_vehicles; ++i)
+            {
+                auto &buffer = buffers[i];
+                buffer.remove_past_points(t_real_time);
+                buffer.push_back(get_point(i, t_planning));
+            }
+            auto t_2 = std::chrono::steady_clock::now();
+            legacy_update_ms += std::chrono::duration<double, std::milli>(t_1 - t_0).count();
+            update_ms += std::chrono::duration<double, std::milli>(t_2 - t_1).count();
+
+            t_planning += dt_nanos;
+        }
+
+        // Same as MultiVehicleTrajectoryPlanner::get_trajectory_commands
+        auto t_0 = std::chrono::steady_clock::now();
+        const std::vector<VehicleCommandTrajectory> legacy_commands = get_trajectory_commands_legacy(legacy_buffers, t_real_time);
+        auto t_1 = std::chrono::steady_clock::now();
+        if (commands.size() != buffers.size())
+        {
+            commands.clear();
+            for(auto &e:buffers)
+            {
+                commands.push_back(VehicleCommandTrajectory());
+                commands.back().vehicle_id(e.first);
+            }
+        }
+        auto command_it = commands.begin();
+        for(auto &e:buffers)
+        {
+            VehicleCommandTrajectory &command = *command_it++;
+            e.second.sync_trajectory_points(command.trajectory_points());
+            command.header().create_stamp().nanoseconds(t_real_time);
+            command.header().valid_after_stamp().nanoseconds(t_real_time + 1000000000ull);
+        }
+        auto t_2 = std::chrono::steady_clock::now();
+        legacy_commands_ms += std::chrono::duration<double, std::milli>(t_1 - t_0).count();
+        commands_ms += std::chrono::duration<double, std::milli>(t_2 - t_1).count();
+
+        for (size_t i = 0; i < commands.size(); ++i)
+        {
+            auto &legacy_points = legacy_commands[i].trajectory_points();
+            auto &points = commands[i].trajectory_points();
+            bool is_equal = legacy_points.size() == points.size();
+            for (size_t j = 0; is_equal && j < points.size(); ++j)
+            {
+                is_equal = legacy_points[j].t().nanoseconds() == points[j].t().nanoseconds()
+                    && legacy_points[j].px() == points[j].px();
+            }
+            if (!is_equal)
+            {
+                std::cerr << "Timestep " << timestep << ": command " << i << " differs" << std::endl;
+                return 1;
+            }
+            n_points += points.size();
+        }
+
+        t_real_time += dt_nanos;
+    }
+
+    std::cout << std::fixed << std::setprecision(4);
+    std::cout << n_vehicles << " vehicles, " << n_timesteps << " timesteps, "
+        << static_cast<double>(n_points) / (n_vehicles * n_timesteps) << " points per command on average" << std::endl;
+    std::cout << "Buffer update [ms per timestep]: legacy " << legacy_update_ms / n_timesteps
+        << ", incremental " << update_ms / n_timesteps << std::endl;
+    std::cout << "Command construction [ms per timestep]: legacy " << legacy_commands_ms / n_timesteps
+        << ", incremental " << commands_ms / n_timesteps << std::endl;
+    return 0;
+}
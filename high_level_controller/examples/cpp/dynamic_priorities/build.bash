@@ -14,4 +14,6 @@ sed -e "s/TEMPLATE_IP/${IP_SELF}/g" \
 cd build
 cmake .. 
 make -j$(nproc)
+# Precompute the collision table, so that the HLCs do not have to compute it at startup
+./generate_collision_table
 cd ..
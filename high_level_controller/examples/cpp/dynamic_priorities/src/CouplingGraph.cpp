@@ -14,69 +14,111 @@ CouplingGraph::CouplingGraph(vector<int> vehicleIds) :
 
 void CouplingGraph::setDefaultOrder(){
     assert(vehicleSet.size() != 0);
-    
-    couplingData.clear();
+
+    vehicleBits.reset();
     for( auto const &vehicleId : vehicleSet ){
-        map<uint8_t, CouplingType> vehicleData;
-        for( auto const &otherVehicle : vehicleSet ){
-            if( otherVehicle < vehicleId ) {
-                vehicleData.insert(std::make_pair(otherVehicle, previousVehicle));
-            } else {
-                vehicleData.insert(std::make_pair(otherVehicle, ignoredVehicle));
-            }
-        }
-        couplingData.insert({vehicleId, vehicleData});
+        vehicleBits.set(vehicleId);
+    }
+
+    VehicleBits lowerIds;
+    for( size_t vehicleId = 0; vehicleId < max_vehicles; ++vehicleId ){
+        previousData[vehicleId] = lowerIds & vehicleBits;
+        concurrentData[vehicleId].reset();
+        lowerIds.set(vehicleId);
     }
 }
 
 void CouplingGraph::addIterativeBlock(vector<int> blockIds){
     //TODO: Check if blockIds are actually a block, i.e. vehicles that are next to each other on the graph
 
-    for( auto const &vehicleId1 : blockIds )
+    VehicleBits blockBits;
+    for( auto const &vehicleId : blockIds )
     {
-        // Vehicles need to be inside our vehicleSet 
-        assert(vehicleSet.find(vehicleId1) != vehicleSet.end());
-        auto &vehicleData = couplingData.at(vehicleId1);
-        for( auto const &vehicleId2 : blockIds )
-        {
-            if( vehicleId1 != vehicleId2 )
-            {
-            vehicleData[vehicleId2] = concurrentVehicle;
-            }
-        }
+        // Vehicles need to be inside our vehicleSet
+        assert(vehicleSet.find(vehicleId) != vehicleSet.end());
+        blockBits.set(static_cast<uint8_t>(vehicleId));
+    }
+
+    for( auto const &vehicleId : blockIds )
+    {
+        const uint8_t id = static_cast<uint8_t>(vehicleId);
+        VehicleBits others = blockBits;
+        others.reset(id);
+        concurrentData[id] |= others;
+        previousData[id] &= ~others;
     }
 }
 
 set<uint8_t> CouplingGraph::getPreviousVehicles(uint8_t vehicleId) {
-    return getMatchingVehicles(vehicleId, previousVehicle);
+    return bitsToSet(getMatchingBits(vehicleId, previousVehicle));
 }
 
 set<uint8_t> CouplingGraph::getConcurrentVehicles(uint8_t vehicleId) {
-    return getMatchingVehicles(vehicleId, concurrentVehicle);
+    return bitsToSet(getMatchingBits(vehicleId, concurrentVehicle));
 }
 
 set<uint8_t> CouplingGraph::getIgnoredVehicles(uint8_t vehicleId) {
-    return getMatchingVehicles(vehicleId, ignoredVehicle);
+    return bitsToSet(getMatchingBits(vehicleId, ignoredVehicle));
 }
 
 set<uint8_t> CouplingGraph::getVehicles() {
     return vehicleSet;
 }
 
-set<uint8_t> CouplingGraph::getMatchingVehicles(uint8_t vehicleId, CouplingType type) {
+CouplingGraph::VehicleBits CouplingGraph::getMatchingBits(uint8_t vehicleId, CouplingType type) {
     // vehicleId needs to be part of vehicleList
     assert(vehicleSet.find(vehicleId) != vehicleSet.end());
 
-    auto vehicleData = couplingData.at(vehicleId);
+    switch( type ) {
+        case previousVehicle:
+            return previousData[vehicleId];
+        case concurrentVehicle:
+            return concurrentData[vehicleId];
+        default:
+            return vehicleBits & ~previousData[vehicleId] & ~concurrentData[vehicleId];
+    }
+}
 
-    set<uint8_t> result;
+vector<uint8_t> CouplingGraph::getPlanningOrder() {
+    vector<uint8_t> order;
+    order.reserve(vehicleSet.size());
+
+    VehicleBits remaining = vehicleBits;
+    while( remaining.any() ) {
+        // Vehicles of this level, collected first s.t. they do not depend on each other
+        VehicleBits level;
+        for( auto const &vehicleId : vehicleSet ) {
+            if( remaining.test(vehicleId) && (previousData[vehicleId] & remaining).none() ) {
+                level.set(vehicleId);
+            }
+        }
+
+        if( level.none() ) {
+            // Every remaining vehicle waits for another remaining vehicle
+            return vector<uint8_t>();
+        }
 
-    for( auto const &entry : vehicleData ) {
-        if ( entry.second == type ) {
-           result.insert(entry.first);
-        } 
+        for( auto const &vehicleId : vehicleSet ) {
+            if( level.test(vehicleId) ) {
+                order.push_back(vehicleId);
+            }
+        }
+        remaining &= ~level;
     }
+    return order;
+}
 
+bool CouplingGraph::isAcyclic() {
+    return getPlanningOrder().size() == vehicleSet.size();
+}
+
+set<uint8_t> CouplingGraph::bitsToSet(const VehicleBits &bits) {
+    set<uint8_t> result;
+    for( auto const &vehicleId : vehicleSet ) {
+        if( bits.test(vehicleId) ) {
+            result.insert(result.end(), vehicleId);
+        }
+    }
     return result;
 }
 
@@ -89,14 +131,18 @@ set<uint8_t> CouplingGraph::vectorToSet(vector<uint8_t> vector) {
 }
 
 string CouplingGraph::toString() {
-    std::stringstream ss;  
+    std::stringstream ss;
 
-    for(auto const &entry1 : couplingData){
-        auto vehicleId   = entry1.first;
-        auto vehicleData = entry1.second;
+    for(auto const &vehicleId : vehicleSet){
         ss << "Data for vehicle " << static_cast<uint32_t>(vehicleId) << " : ";
-        for(auto const &entry2 : vehicleData) {
-            ss << entry2.second << ", ";
+        for(auto const &otherVehicle : vehicleSet) {
+            CouplingType type = ignoredVehicle;
+            if( previousData[vehicleId].test(otherVehicle) ) {
+                type = previousVehicle;
+            } else if( concurrentData[vehicleId].test(otherVehicle) ) {
+                type = concurrentVehicle;
+            }
+            ss << type << ", ";
         }
         ss << std::endl;
     }
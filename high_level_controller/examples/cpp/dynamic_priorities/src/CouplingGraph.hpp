@@ -3,6 +3,8 @@
 #include <vector>
 #include <map>
 #include <set>
+#include <array>
+#include <bitset>
 #include <cstdint>
 #include <cassert>
 
@@ -18,7 +20,15 @@ using std::string;
 
 class CouplingGraph
 {
+    public:
+        //! Vehicle IDs are uint8_t, so every set of vehicles fits into a bitset of this size
+        static constexpr size_t max_vehicles = 256;
+        //! Set of vehicles, bit i is set if vehicle i is contained
+        using VehicleBits = std::bitset<max_vehicles>;
+
+    private:
     set<uint8_t> vehicleSet;
+    VehicleBits vehicleBits;
 
     /* Defines how a vehicle is supposed to treat other vehicles.
      * previous means, the other vehicle needs to finish planning before we do.
@@ -27,10 +37,15 @@ class CouplingGraph
      *  We still have to wait for its result though.
      */
     enum CouplingType { previousVehicle, concurrentVehicle, ignoredVehicle };
-    map<uint8_t, map<uint8_t, CouplingType>> couplingData;
-    
-    void setPreviousVehiclesToDefault(uint8_t vehicleId);
-    set<uint8_t> getMatchingVehicles(uint8_t vehicleId, CouplingType type);
+
+    /* Adjacency bitsets, one row per vehicle ID.
+     * A vehicle that is neither previous nor concurrent is ignored (this includes the vehicle itself).
+     */
+    std::array<VehicleBits, max_vehicles> previousData;
+    std::array<VehicleBits, max_vehicles> concurrentData;
+
+    VehicleBits getMatchingBits(uint8_t vehicleId, CouplingType type);
+    set<uint8_t> bitsToSet(const VehicleBits &bits);
     set<uint8_t> vectorToSet(vector<uint8_t> vector);
 
     public:
@@ -38,7 +53,7 @@ class CouplingGraph
         CouplingGraph(vector<uint8_t> vehicleIds);
         // Alternative constructor, because not much else uses uint8_t
         CouplingGraph(vector<int> vehicleIds);
-        
+
         void setDefaultOrder();
         void addIterativeBlock(vector<int> vehicleIds);
 
@@ -47,6 +62,16 @@ class CouplingGraph
         set<uint8_t> getIgnoredVehicles(uint8_t vehicleId);
         set<uint8_t> getVehicles();
 
+        /* Order in which the vehicles can plan, s.t. all previous vehicles of a vehicle planned before it.
+         * Computed level by level: A level contains all remaining vehicles whose previous vehicles
+         * are all in earlier levels, which is a single bitset intersection per vehicle.
+         * Vehicles of the same level are ordered by their ID.
+         * Empty if the previous vehicles contain a cycle.
+         */
+        vector<uint8_t> getPlanningOrder();
+        // True if no vehicle (indirectly) needs to wait for itself
+        bool isAcyclic();
+
         void setParallelPlanningMode(uint8_t mode);
         uint8_t getParallelPlanningMode();
 
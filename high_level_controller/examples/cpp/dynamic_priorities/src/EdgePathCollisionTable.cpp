@@ -0,0 +1,390 @@
+// MIT License
+//
+// Copyright (c) 2020 Lehrstuhl Informatik 11 - RWTH Aachen University
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// This file is part of cpm_lab.
+//
+// Author: i11 - Embedded Software, RWTH Aachen University
+
+#include "EdgePathCollisionTable.hpp"
+#include "geometry.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+#include <thread>
+
+//To map the table file
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/**
+ * \file EdgePathCollisionTable.cpp
+ * \ingroup distributed_routing
+ */
+
+constexpr char EdgePathCollisionTable::file_magic[8];
+
+EdgePathCollisionTable::~EdgePathCollisionTable()
+{
+    unmap();
+}
+
+EdgePathCollisionTable::EdgePathCollisionTable(EdgePathCollisionTable&& other)
+{
+    *this = std::move(other);
+}
+
+EdgePathCollisionTable& EdgePathCollisionTable::operator=(EdgePathCollisionTable&& other)
+{
+    if (this != &other)
+    {
+        unmap();
+        n_edges = other.n_edges;
+        n_edge_path_nodes = other.n_edge_path_nodes;
+        n_points = other.n_points;
+        owned_words = std::move(other.owned_words);
+        words = other.mapped_data ? other.words : owned_words.data();
+        mapped_data = other.mapped_data;
+        mapped_size = other.mapped_size;
+
+        other.words = nullptr;
+        other.mapped_data = nullptr;
+        other.mapped_size = 0;
+    }
+    return *this;
+}
+
+void EdgePathCollisionTable::unmap()
+{
+    if (mapped_data)
+    {
+        munmap(mapped_data, mapped_size);
+        mapped_data = nullptr;
+        mapped_size = 0;
+        words = nullptr;
+    }
+}
+
+size_t EdgePathCollisionTable::get_n_words(size_t n_points)
+{
+    const size_t n_bits = n_points * (n_points + 1) / 2;
+    return (n_bits + 63) / 64;
+}
+
+EdgePathCollisionTable EdgePathCollisionTable::compute(const LaneGraph &lane_graph, double collision_distance)
+{
+    return compute(lane_graph.edges_x, lane_graph.edges_y, lane_graph.edges_cos, lane_graph.edges_sin, collision_distance);
+}
+
+EdgePathCollisionTable EdgePathCollisionTable::compute(
+    const std::vector<std::vector<double>> &edges_x,
+    const std::vector<std::vector<double>> &edges_y,
+    const std::vector<std::vector<double>> &edges_cos,
+    const std::vector<std::vector<double>> &edges_sin,
+    double collision_distance)
+{
+    EdgePathCollisionTable table;
+    table.n_edges = edges_x.size();
+    table.n_edge_path_nodes = (table.n_edges > 0) ? edges_x.at(0).size() : 0;
+    table.n_points = table.n_edges * table.n_edge_path_nodes;
+    table.owned_words.assign(get_n_words(table.n_points), 0);
+    table.words = table.owned_words.data();
+
+    const size_t n_points = table.n_points;
+    if (n_points == 0)
+    {
+        return table;
+    }
+
+    std::vector<PathNode> nodes;
+    nodes.reserve(n_points);
+    for (size_t i_edge = 0; i_edge < table.n_edges; ++i_edge)
+    {
+        for (size_t i_path = 0; i_path < table.n_edge_path_nodes; ++i_path)
+        {
+            nodes.push_back(PathNode(
+                edges_x.at(i_edge).at(i_path),
+                edges_y.at(i_edge).at(i_path),
+                edges_cos.at(i_edge).at(i_path),
+                edges_sin.at(i_edge).at(i_path)
+            ));
+        }
+    }
+
+    // Broadphase: min_distance_vehicle_to_vehicle is at least the larger of the longitudinal and lateral distances
+    // between a vehicle and a corner of the other vehicle, which is at least the euclidean distance / sqrt(2) minus
+    // VEHICLE_HALF_LENGTH (scaled by the length of the heading vector, which is not exactly 1 for all path nodes).
+    // Vehicles on two points can therefore only collide if their centers are closer than the following cell size,
+    // so all candidates of a point are in its own and the neighbouring cells of a uniform grid.
+    // The small margin only adds candidates, the result is the same as checking all pairs.
+    double min_heading_length = 1e300;
+    double max_heading_length = 0;
+    for (const PathNode &node : nodes)
+    {
+        const double heading_length = std::hypot(node.cos_yaw, node.sin_yaw);
+        min_heading_length = std::min(min_heading_length, heading_length);
+        max_heading_length = std::max(max_heading_length, heading_length);
+    }
+    const double half_length = std::max(VEHICLE_HALF_LENGTH, VEHICLE_HALF_WIDTH);
+    const double corner_radius = std::hypot(static_cast<double>(VEHICLE_HALF_LENGTH), static_cast<double>(VEHICLE_HALF_WIDTH));
+    // Without a usable heading, all pairs are candidates
+    const double cell_size = (min_heading_length > 1e-3)
+        ? std::sqrt(2.0) * (collision_distance + half_length) / min_heading_length + corner_radius * max_heading_length + 1e-6
+        : std::numeric_limits<double>::infinity();
+    const double max_candidate_squared_distance = cell_size * cell_size;
+
+    double min_x = nodes[0].x, max_x = nodes[0].x;
+    double min_y = nodes[0].y, max_y = nodes[0].y;
+    for (const PathNode &node : nodes)
+    {
+        min_x = std::min(min_x, node.x);
+        max_x = std::max(max_x, node.x);
+        min_y = std::min(min_y, node.y);
+        max_y = std::max(max_y, node.y);
+    }
+    const size_t n_cells_x = static_cast<size_t>((max_x - min_x) / cell_size) + 1;
+    const size_t n_cells_y = static_cast<size_t>((max_y - min_y) / cell_size) + 1;
+
+    // Points sorted by cell: The points of cell c are cell_points[cell_start[c]] ... cell_points[cell_start[c+1] - 1]
+    std::vector<size_t> point_cell_x(n_points);
+    std::vector<size_t> point_cell_y(n_points);
+    std::vector<size_t> cell_start(n_cells_x * n_cells_y + 1, 0);
+    for (size_t i = 0; i < n_points; ++i)
+    {
+        point_cell_x[i] = std::min(static_cast<size_t>((nodes[i].x - min_x) / cell_size), n_cells_x - 1);
+        point_cell_y[i] = std::min(static_cast<size_t>((nodes[i].y - min_y) / cell_size), n_cells_y - 1);
+        ++cell_start[point_cell_y[i] * n_cells_x + point_cell_x[i] + 1];
+    }
+    for (size_t c = 1; c < cell_start.size(); ++c)
+    {
+        cell_start[c] += cell_start[c - 1];
+    }
+    std::vector<size_t> cell_points(n_points);
+    {
+        std::vector<size_t> cell_fill(cell_start.begin(), cell_start.end() - 1);
+        for (size_t i = 0; i < n_points; ++i)
+        {
+            cell_points[cell_fill[point_cell_y[i] * n_cells_x + point_cell_x[i]]++] = i;
+        }
+    }
+
+    // Each thread takes blocks of rows of the upper triangle and collects the bits of the collisions it finds.
+    // The bits are set afterwards, as rows of different threads may share a word of the bitset.
+    const size_t n_threads = std::max(1u, std::thread::hardware_concurrency());
+    const size_t rows_per_block = 64;
+    std::atomic<size_t> next_row{0};
+    std::vector<std::vector<size_t>> collision_bits(n_threads);
+    std::vector<std::thread> threads;
+    for (size_t i_thread = 0; i_thread < n_threads; ++i_thread)
+    {
+        threads.push_back(std::thread([&, i_thread](){
+            std::vector<size_t> &bits = collision_bits[i_thread];
+            size_t first_row;
+            while ((first_row = next_row.fetch_add(rows_per_block)) < n_points)
+            {
+                const size_t last_row = std::min(first_row + rows_per_block, n_points);
+                for (size_t i = first_row; i < last_row; ++i)
+                {
+                    const PathNode &nodeA = nodes[i];
+                    const size_t cell_x_begin = (point_cell_x[i] > 0) ? point_cell_x[i] - 1 : 0;
+                    const size_t cell_y_begin = (point_cell_y[i] > 0) ? point_cell_y[i] - 1 : 0;
+                    const size_t cell_x_end = std::min(point_cell_x[i] + 2, n_cells_x);
+                    const size_t cell_y_end = std::min(point_cell_y[i] + 2, n_cells_y);
+
+                    for (size_t cell_y = cell_y_begin; cell_y < cell_y_end; ++cell_y)
+                    {
+                        for (size_t cell_x = cell_x_begin; cell_x < cell_x_end; ++cell_x)
+                        {
+                            const size_t cell = cell_y * n_cells_x + cell_x;
+                            for (size_t k = cell_start[cell]; k < cell_start[cell + 1]; ++k)
+                            {
+                                const size_t j = cell_points[k];
+                                if (j < i) continue;
+
+                                const PathNode &nodeB = nodes[j];
+                                const double dx = nodeB.x - nodeA.x;
+                                const double dy = nodeB.y - nodeA.y;
+                                if (dx*dx + dy*dy >= max_candidate_squared_distance) continue;
+
+                                if (min_distance_vehicle_to_vehicle(nodeA, nodeB) < collision_distance)
+                                {
+                                    bits.push_back(table.get_bit_index(i, j));
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+        }));
+    }
+
+    for(auto& thread:threads)
+    {
+        thread.join();
+    }
+
+    for (const auto &bits : collision_bits)
+    {
+        for (size_t bit : bits)
+        {
+            table.owned_words[bit >> 6] |= (uint64_t(1) << (bit & 63));
+        }
+    }
+
+    return table;
+}
+
+uint64_t EdgePathCollisionTable::compute_lane_graph_hash(const LaneGraph &lane_graph, double collision_distance)
+{
+    // FNV-1a over the binary representation of all values the table depends on
+    uint64_t hash = 14695981039346656037ull;
+    auto add_bytes = [&hash] (const void* data, size_t size) {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < size; ++i)
+        {
+            hash ^= bytes[i];
+            hash *= 1099511628211ull;
+        }
+    };
+    auto add_paths = [&add_bytes] (const std::vector<std::vector<double>> &paths) {
+        for (const auto &path : paths)
+        {
+            add_bytes(path.data(), path.size() * sizeof(double));
+        }
+    };
+
+    const uint64_t n_edges = lane_graph.n_edges;
+    const uint64_t n_edge_path_nodes = lane_graph.n_edge_path_nodes;
+    const float vehicle_half_length = VEHICLE_HALF_LENGTH;
+    const float vehicle_half_width = VEHICLE_HALF_WIDTH;
+    add_bytes(file_magic, sizeof(file_magic));
+    add_bytes(&n_edges, sizeof(n_edges));
+    add_bytes(&n_edge_path_nodes, sizeof(n_edge_path_nodes));
+    add_bytes(&vehicle_half_length, sizeof(vehicle_half_length));
+    add_bytes(&vehicle_half_width, sizeof(vehicle_half_width));
+    add_bytes(&collision_distance, sizeof(collision_distance));
+    add_paths(lane_graph.edges_x);
+    add_paths(lane_graph.edges_y);
+    add_paths(lane_graph.edges_cos);
+    add_paths(lane_graph.edges_sin);
+
+    return hash;
+}
+
+std::string EdgePathCollisionTable::get_file_name(uint64_t lane_graph_hash)
+{
+    std::stringstream file_name;
+    file_name << "edge_path_collisions_" << std::hex << std::setw(16) << std::setfill('0') << lane_graph_hash << ".bin";
+    return file_name.str();
+}
+
+std::string EdgePathCollisionTable::get_executable_folder()
+{
+    char path[4096];
+    const ssize_t length = readlink("/proc/self/exe", path, sizeof(path) - 1);
+    if (length <= 0)
+    {
+        return ".";
+    }
+
+    std::string executable_path(path, static_cast<size_t>(length));
+    const auto last_slash = executable_path.find_last_of('/');
+    return (last_slash == std::string::npos) ? "." : executable_path.substr(0, last_slash);
+}
+
+bool EdgePathCollisionTable::write_file(const std::string &file_path, uint64_t lane_graph_hash) const
+{
+    FileHeader header;
+    std::memcpy(header.magic, file_magic, sizeof(header.magic));
+    header.lane_graph_hash = lane_graph_hash;
+    header.n_edges = n_edges;
+    header.n_edge_path_nodes = n_edge_path_nodes;
+    header.n_words = get_n_words(n_points);
+
+    // Write to a temporary file first, so that HLCs starting at the same time never map a partially written file
+    const std::string temporary_path = file_path + ".tmp";
+    {
+        std::ofstream file(temporary_path, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(words), header.n_words * sizeof(uint64_t));
+        if (!file.good())
+        {
+            return false;
+        }
+    }
+
+    return std::rename(temporary_path.c_str(), file_path.c_str()) == 0;
+}
+
+bool EdgePathCollisionTable::map_file(const std::string &file_path, uint64_t lane_graph_hash, size_t expected_n_edges, size_t expected_n_edge_path_nodes)
+{
+    const int fd = open(file_path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        return false;
+    }
+
+    struct stat file_stat;
+    const size_t n_words = get_n_words(expected_n_edges * expected_n_edge_path_nodes);
+    const size_t expected_size = sizeof(FileHeader) + n_words * sizeof(uint64_t);
+    if (fstat(fd, &file_stat) != 0 || static_cast<size_t>(file_stat.st_size) != expected_size)
+    {
+        close(fd);
+        return false;
+    }
+
+    void* data = mmap(nullptr, expected_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED)
+    {
+        return false;
+    }
+
+    const FileHeader* header = static_cast<const FileHeader*>(data);
+    if (std::memcmp(header->magic, file_magic, sizeof(file_magic)) != 0
+        || header->lane_graph_hash != lane_graph_hash
+        || header->n_edges != expected_n_edges
+        || header->n_edge_path_nodes != expected_n_edge_path_nodes
+        || header->n_words != n_words)
+    {
+        munmap(data, expected_size);
+        return false;
+    }
+
+    unmap();
+    owned_words.clear();
+    owned_words.shrink_to_fit();
+    n_edges = expected_n_edges;
+    n_edge_path_nodes = expected_n_edge_path_nodes;
+    n_points = n_edges * n_edge_path_nodes;
+    mapped_data = data;
+    mapped_size = expected_size;
+    words = reinterpret_cast<const uint64_t*>(static_cast<const char*>(data) + sizeof(FileHeader));
+    return true;
+}
@@ -0,0 +1,244 @@
+// MIT License
+//
+// Copyright (c) 2020 Lehrstuhl Informatik 11 - RWTH Aachen University
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// This file is part of cpm_lab.
+//
+// Author: i11 - Embedded Software, RWTH Aachen University
+
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <typeindex>
+#include <utility>
+#include <vector>
+#include "MessageChannel.hpp"
+
+template<typename T> class InMemoryMessageReader;
+
+/**
+ * \class InMemoryTopic
+ * \brief Topic of an InMemoryMessageBus, delivers each written message to all readers of the topic
+ * \ingroup distributed_routing
+ */
+template<typename T>
+class InMemoryTopic
+{
+    //! Protects readers
+    std::mutex readers_mutex;
+    //! Readers of the topic, they register and unregister themselves
+    std::vector<InMemoryMessageReader<T>*> readers;
+
+public:
+    /**
+     * \brief Deliver a message to all readers, including the readers of the writing planner (as with DDS)
+     * \param msg The message
+     */
+    void publish(const T &msg)
+    {
+        std::lock_guard<std::mutex> lock(readers_mutex);
+        for (InMemoryMessageReader<T> *reader : readers)
+        {
+            reader->deliver(msg);
+        }
+    }
+
+    /**
+     * \brief Register a reader
+     */
+    void add_reader(InMemoryMessageReader<T> *reader)
+    {
+        std::lock_guard<std::mutex> lock(readers_mutex);
+        readers.push_back(reader);
+    }
+
+    /**
+     * \brief Unregister a reader
+     */
+    void remove_reader(InMemoryMessageReader<T> *reader)
+    {
+        std::lock_guard<std::mutex> lock(readers_mutex);
+        readers.erase(std::remove(readers.begin(), readers.end(), reader), readers.end());
+    }
+};
+
+/**
+ * \class InMemoryMessageWriter
+ * \brief MessageWriter of an InMemoryMessageBus
+ * \ingroup distributed_routing
+ */
+template<typename T>
+class InMemoryMessageWriter : public MessageWriter<T>
+{
+    //! Topic to write to
+    std::shared_ptr<InMemoryTopic<T>> topic;
+
+public:
+    /**
+     * \brief Create a writer, see InMemoryMessageBus::create_writer
+     */
+    InMemoryMessageWriter(std::shared_ptr<InMemoryTopic<T>> _topic) : topic(_topic) {}
+
+    void write(const T &msg) override { topic->publish(msg); }
+};
+
+/**
+ * \class InMemoryMessageReader
+ * \brief MessageReader of an InMemoryMessageBus. Keeps all messages until they are taken, in the order they were written,
+ * i.e. behaves like a reliable DDS reader that keeps the whole history.
+ * \ingroup distributed_routing
+ */
+template<typename T>
+class InMemoryMessageReader : public MessageReader<T>
+{
+    //! Topic the reader is registered at
+    std::shared_ptr<InMemoryTopic<T>> topic;
+    //! Protects received_messages and interrupted
+    std::mutex messages_mutex;
+    //! Notified when a message is delivered or interrupt_wait() is called
+    std::condition_variable messages_cv;
+    //! Messages that were not taken yet
+    std::vector<T> received_messages;
+    //! Set by interrupt_wait()
+    bool interrupted = false;
+
+public:
+    /**
+     * \brief Create a reader, see InMemoryMessageBus::create_reader. Only receives messages written after its creation.
+     */
+    InMemoryMessageReader(std::shared_ptr<InMemoryTopic<T>> _topic) : topic(_topic)
+    {
+        topic->add_reader(this);
+    }
+
+    ~InMemoryMessageReader()
+    {
+        topic->remove_reader(this);
+    }
+
+    InMemoryMessageReader(const InMemoryMessageReader&) = delete;
+    InMemoryMessageReader& operator=(const InMemoryMessageReader&) = delete;
+
+    /**
+     * \brief Called by the topic for each written message
+     */
+    void deliver(const T &msg)
+    {
+        {
+            std::lock_guard<std::mutex> lock(messages_mutex);
+            received_messages.push_back(msg);
+        }
+        messages_cv.notify_all();
+    }
+
+    std::vector<T> take() override
+    {
+        std::vector<T> messages;
+        std::lock_guard<std::mutex> lock(messages_mutex);
+        messages.swap(received_messages);
+        return messages;
+    }
+
+    bool wait_for_messages(std::chrono::nanoseconds timeout) override
+    {
+        std::unique_lock<std::mutex> lock(messages_mutex);
+        if (timeout.count() > 0)
+        {
+            messages_cv.wait_for(lock, timeout, [&] { return !received_messages.empty() || interrupted; });
+        }
+        return !received_messages.empty();
+    }
+
+    void interrupt_wait() override
+    {
+        {
+            std::lock_guard<std::mutex> lock(messages_mutex);
+            interrupted = true;
+        }
+        messages_cv.notify_all();
+    }
+
+    void reset_interrupt() override
+    {
+        std::lock_guard<std::mutex> lock(messages_mutex);
+        interrupted = false;
+    }
+};
+
+/**
+ * \class InMemoryMessageBus
+ * \brief Replaces DDS for planners that run in the same process, e.g. in the scenario evaluation (see scenario_evaluation.cpp).
+ * Messages are delivered synchronously in write(), so no messages are lost or delayed and the communication
+ * does not depend on the network or on the load of the machine. Each bus is independent of all other buses,
+ * so several scenarios can run in parallel in one process.
+ * \ingroup distributed_routing
+ */
+class InMemoryMessageBus
+{
+    //! Protects topics
+    std::mutex topics_mutex;
+    //! Topics by name and message type; the values are InMemoryTopic<T> of the type of the key
+    std::map<std::pair<std::string, std::type_index>, std::shared_ptr<void>> topics;
+
+    /**
+     * \brief Get a topic, creates it if it does not exist yet
+     * \param topic_name Name of the topic
+     */
+    template<typename T>
+    std::shared_ptr<InMemoryTopic<T>> get_topic(const std::string &topic_name)
+    {
+        std::lock_guard<std::mutex> lock(topics_mutex);
+        std::shared_ptr<void> &topic = topics[std::make_pair(topic_name, std::type_index(typeid(T)))];
+        if (!topic)
+        {
+            topic = std::make_shared<InMemoryTopic<T>>();
+        }
+        return std::static_pointer_cast<InMemoryTopic<T>>(topic);
+    }
+
+public:
+    /**
+     * \brief Create a writer for a topic
+     * \param topic_name Name of the topic
+     */
+    template<typename T>
+    std::unique_ptr<MessageWriter<T>> create_writer(const std::string &topic_name)
+    {
+        return std::unique_ptr<MessageWriter<T>>(new InMemoryMessageWriter<T>(get_topic<T>(topic_name)));
+    }
+
+    /**
+     * \brief Create a reader for a topic
+     * \param topic_name Name of the topic
+     */
+    template<typename T>
+    std::unique_ptr<MessageReader<T>> create_reader(const std::string &topic_name)
+    {
+        return std::unique_ptr<MessageReader<T>>(new InMemoryMessageReader<T>(get_topic<T>(topic_name)));
+    }
+};
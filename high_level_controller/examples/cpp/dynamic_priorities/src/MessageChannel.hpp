@@ -0,0 +1,146 @@
+// MIT License
+//
+// Copyright (c) 2020 Lehrstuhl Informatik 11 - RWTH Aachen University
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// This file is part of cpm_lab.
+//
+// Author: i11 - Embedded Software, RWTH Aachen University
+
+
+#pragma once
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+#include "cpm/Writer.hpp"
+#include "cpm/ReaderAbstract.hpp"
+
+/**
+ * \class MessageWriter
+ * \brief Interface of the writers the VehicleTrajectoryPlanner sends its messages with.
+ * Implemented for DDS (DdsMessageWriter) and for the in-process evaluation (see InMemoryMessageBus).
+ * \ingroup distributed_routing
+ */
+template<typename T>
+class MessageWriter
+{
+public:
+    virtual ~MessageWriter() = default;
+
+    /**
+     * \brief Send a message to all readers of the topic
+     * \param msg The message to send
+     */
+    virtual void write(const T &msg) = 0;
+};
+
+/**
+ * \class MessageReader
+ * \brief Interface of the readers the VehicleTrajectoryPlanner receives messages with,
+ * same semantics as the corresponding functions of cpm::ReaderAbstract.
+ * \ingroup distributed_routing
+ */
+template<typename T>
+class MessageReader
+{
+public:
+    virtual ~MessageReader() = default;
+
+    /**
+     * \brief Get the received messages, each message is returned only once
+     */
+    virtual std::vector<T> take() = 0;
+
+    /**
+     * \brief Block until messages can be taken, interrupt_wait() was called or the timeout expired
+     * \param timeout Maximum time to wait
+     * \return True if messages can be taken
+     */
+    virtual bool wait_for_messages(std::chrono::nanoseconds timeout) = 0;
+
+    /**
+     * \brief Wake up a thread that is blocked in wait_for_messages, until reset_interrupt() is called
+     */
+    virtual void interrupt_wait() = 0;
+
+    /**
+     * \brief Undo interrupt_wait(), s.t. wait_for_messages blocks again
+     */
+    virtual void reset_interrupt() = 0;
+};
+
+/**
+ * \class DdsMessageWriter
+ * \brief MessageWriter that writes to a DDS topic with a cpm::Writer
+ * \ingroup distributed_routing
+ */
+template<typename T>
+class DdsMessageWriter : public MessageWriter<T>
+{
+    //! The DDS writer
+    std::unique_ptr<cpm::Writer<T>> writer;
+
+public:
+    /**
+     * \brief Wrap an existing cpm::Writer
+     * \param _writer The writer to use
+     */
+    DdsMessageWriter(std::unique_ptr<cpm::Writer<T>> _writer) : writer(std::move(_writer)) {}
+
+    /**
+     * \brief Create a cpm::Writer with default QoS for a topic
+     * \param topic Name of the topic
+     */
+    DdsMessageWriter(std::string topic) : writer(new cpm::Writer<T>(topic)) {}
+
+    void write(const T &msg) override { writer->write(msg); }
+};
+
+/**
+ * \class DdsMessageReader
+ * \brief MessageReader that reads from a DDS topic with a cpm::ReaderAbstract
+ * \ingroup distributed_routing
+ */
+template<typename T>
+class DdsMessageReader : public MessageReader<T>
+{
+    //! The DDS reader
+    std::unique_ptr<cpm::ReaderAbstract<T>> reader;
+
+public:
+    /**
+     * \brief Wrap an existing cpm::ReaderAbstract
+     * \param _reader The reader to use
+     */
+    DdsMessageReader(std::unique_ptr<cpm::ReaderAbstract<T>> _reader) : reader(std::move(_reader)) {}
+
+    /**
+     * \brief Create a cpm::ReaderAbstract with default QoS for a topic
+     * \param topic Name of the topic
+     */
+    DdsMessageReader(std::string topic) : reader(new cpm::ReaderAbstract<T>(topic)) {}
+
+    std::vector<T> take() override { return reader->take(); }
+    bool wait_for_messages(std::chrono::nanoseconds timeout) override { return reader->wait_for_messages(timeout); }
+    void interrupt_wait() override { reader->interrupt_wait(); }
+    void reset_interrupt() override { reader->reset_interrupt(); }
+};
@@ -0,0 +1,285 @@
+// MIT License
+//
+// Copyright (c) 2020 Lehrstuhl Informatik 11 - RWTH Aachen University
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// This file is part of cpm_lab.
+//
+// Author: i11 - Embedded Software, RWTH Aachen University
+
+
+#include "ScenarioEvaluation.hpp"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include "InMemoryMessageBus.hpp"
+#include "lane_graph_tools.hpp"
+
+/**
+ * \file ScenarioEvaluation.cpp
+ * \ingroup distributed_routing
+ */
+
+//! Successive colliding steps of two paths within this window count as one collision, as in the FCA of VehicleTrajectoryPlanningState
+static const size_t collision_damping_window = 8;
+
+/**
+ * \brief Count the collisions of two paths
+ * \ingroup distributed_routing
+ */
+static int count_collisions(const PlannedPath &path_A, const PlannedPath &path_B)
+{
+    const EdgePathCollisionTable &edge_path_collisions = laneGraphTools.edge_path_collisions;
+    int n_collisions = 0;
+    bool has_collision = false;
+    size_t last_collision = 0;
+    for (size_t i = 0; i < N_STEPS_SPEED_PROFILE; ++i)
+    {
+        if (edge_path_collisions(path_A.point_indices[i], path_B.point_indices[i]))
+        {
+            if (!has_collision || last_collision + collision_damping_window < i)
+            {
+                ++n_collisions;
+            }
+            has_collision = true;
+            last_collision = i;
+        }
+    }
+    return n_collisions;
+}
+
+std::string EvaluationResult::csv_header()
+{
+    return "mode;vehicles;seed;steps;completed_steps;aborted_plans;new_priorities;old_priorities;safety_stops;"
+        "potential_collisions;remaining_collisions;avoided_collisions;speed_loss;mean_fca;max_fca;"
+        "mean_plan_ms;max_plan_ms;mean_round_ms;checksum;error";
+}
+
+std::string EvaluationResult::to_csv() const
+{
+    std::ostringstream line;
+    line << std::fixed << std::setprecision(4);
+    line << static_cast<int>(scenario.mode) << ";" << scenario.n_vehicles << ";" << scenario.seed << ";" << scenario.n_steps << ";"
+        << completed_steps << ";" << aborted_plans << ";" << new_priorities << ";" << old_priorities << ";" << safety_stops << ";"
+        << potential_collisions << ";" << remaining_collisions << ";" << potential_collisions - remaining_collisions << ";"
+        << speed_loss << ";" << mean_fca << ";" << max_fca << ";"
+        << mean_plan_ms << ";" << max_plan_ms << ";" << mean_round_ms << ";"
+        << std::hex << checksum << std::dec << ";" << error;
+    return line.str();
+}
+
+ScenarioEvaluation::ScenarioEvaluation(std::vector<Pose2D> _start_poses, uint64_t _dt_nanos, uint64_t _round_timeout_nanos)
+:start_poses(_start_poses)
+,dt_nanos(_dt_nanos)
+,round_timeout_nanos(_round_timeout_nanos)
+{
+}
+
+EvaluationResult ScenarioEvaluation::run(const EvaluationScenario &scenario) const
+{
+    EvaluationResult result;
+    result.scenario = scenario;
+    result.checksum = 1469598103934665603ull;
+
+    if (scenario.n_vehicles < 1 || scenario.n_vehicles > static_cast<int>(start_poses.size()))
+    {
+        result.error = "only 1 to " + std::to_string(start_poses.size()) + " vehicles are supported";
+        return result;
+    }
+
+    std::vector<uint8_t> vehicle_ids;
+    for (int i = 1; i <= scenario.n_vehicles; ++i)
+    {
+        vehicle_ids.push_back(static_cast<uint8_t>(i));
+    }
+
+    // Create the planners, as simulation.cpp does, but with in-memory communication
+    InMemoryMessageBus bus;
+    std::vector<std::unique_ptr<VehicleTrajectoryPlanner>> planners;
+    for (uint8_t vehicle_id : vehicle_ids)
+    {
+        int out_edge_index = -1;
+        int out_edge_path_index = -1;
+        if (!laneGraphTools.map_match_pose(start_poses.at(vehicle_id - 1), out_edge_index, out_edge_path_index))
+        {
+            result.error = "could not match start pose of vehicle " + std::to_string(vehicle_id);
+            return result;
+        }
+
+        std::unique_ptr<VehicleTrajectoryPlanner> planner(new VehicleTrajectoryPlanner(
+            scenario.mode,
+            scenario.seed + vehicle_id,
+            bus.create_writer<FallbackSync>("fallbacksync"),
+            bus.create_reader<FallbackSync>("fallbacksync")
+        ));
+        if (scenario.compact_paths)
+        {
+            planner->set_vehicle_path_writer(bus.create_writer<VehiclePath>("vehiclePath"));
+            planner->set_vehicle_path_reader(bus.create_reader<VehiclePath>("vehiclePath"));
+        }
+        else
+        {
+            planner->set_writer(bus.create_writer<Trajectory>("trajectory"));
+            planner->set_reader(bus.create_reader<Trajectory>("trajectory"));
+        }
+        planner->set_fca_writer(bus.create_writer<FutureCollisionAssessment>("futureCollisionAssessment"));
+        planner->set_fca_reader(bus.create_reader<FutureCollisionAssessment>("futureCollisionAssessment"));
+        planner->set_visualization_writer(bus.create_writer<Visualization>("visualization"));
+        planner->set_round_timeout(round_timeout_nanos);
+        planner->set_write_evaluation_file(false);
+        planner->set_collect_statistics(true);
+
+        planner->set_coupling_graph(CouplingGraph(vehicle_ids));
+        planner->set_vehicle(
+            std::unique_ptr<VehicleTrajectoryPlanningState>(
+                new VehicleTrajectoryPlanningState(
+                    vehicle_id,
+                    out_edge_index,
+                    out_edge_path_index,
+                    dt_nanos,
+                    scenario.seed + vehicle_id
+                )
+            )
+        );
+        planners.push_back(std::move(planner));
+    }
+
+    // One thread per planner, as the planners wait for each other's messages.
+    // The threads plan timestep started_step as soon as it is set, the next timestep is only started when all planners finished.
+    std::mutex step_mutex;
+    std::condition_variable step_started;
+    std::condition_variable step_finished;
+    int started_step = -1;
+    size_t n_finished = 0;
+    bool stop_threads = false;
+    std::vector<int> failed(planners.size(), 0);
+    const uint64_t t_first = 10; // initial time != 0, as in simulation.cpp
+
+    std::vector<std::thread> threads;
+    threads.reserve(planners.size());
+    for (size_t i = 0; i < planners.size(); ++i)
+    {
+        threads.emplace_back([&, i] {
+            for (int step = 0; ; ++step)
+            {
+                {
+                    std::unique_lock<std::mutex> lock(step_mutex);
+                    step_started.wait(lock, [&] { return stop_threads || started_step >= step; });
+                    if (stop_threads) return;
+                }
+
+                try
+                {
+                    planners[i]->plan(t_first + step * dt_nanos, dt_nanos);
+                }
+                catch (const std::exception &)
+                {
+                    failed[i] = 1;
+                }
+
+                {
+                    std::lock_guard<std::mutex> lock(step_mutex);
+                    ++n_finished;
+                }
+                step_finished.notify_one();
+            }
+        });
+    }
+
+    double sum_speed_loss = 0;
+    double sum_fca = 0;
+    double sum_plan_ms = 0;
+    double sum_round_ms = 0;
+    for (int step = 0; step < scenario.n_steps; ++step)
+    {
+        auto round_start = std::chrono::steady_clock::now();
+        {
+            std::lock_guard<std::mutex> lock(step_mutex);
+            n_finished = 0;
+            started_step = step;
+        }
+        step_started.notify_all();
+        {
+            std::unique_lock<std::mutex> lock(step_mutex);
+            step_finished.wait(lock, [&] { return n_finished == planners.size(); });
+        }
+        sum_round_ms += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - round_start).count();
+
+        if (std::find(failed.begin(), failed.end(), 1) != failed.end())
+        {
+            result.error = "a planner missed too many timesteps in timestep " + std::to_string(step);
+            break;
+        }
+
+        // All planners wait for the next timestep, so their statistics can be read
+        for (size_t i = 0; i < planners.size(); ++i)
+        {
+            const PlanningStepStatistics &statistics = planners[i]->get_step_statistics();
+            result.aborted_plans += statistics.has_trajectory ? 0 : 1;
+            result.new_priorities += (statistics.priority_outcome == 0) ? 1 : 0;
+            result.old_priorities += (statistics.priority_outcome == 1) ? 1 : 0;
+            result.safety_stops += (statistics.priority_outcome == 2) ? 1 : 0;
+            sum_speed_loss += 1.0 - statistics.mean_speed / VehicleTrajectoryPlanningState::get_max_speed();
+            sum_fca += statistics.fca;
+            result.max_fca = std::max(result.max_fca, static_cast<int>(statistics.fca));
+            sum_plan_ms += statistics.plan_ms;
+            result.max_plan_ms = std::max(result.max_plan_ms, statistics.plan_ms);
+
+            for (size_t j = i + 1; j < planners.size(); ++j)
+            {
+                const PlanningStepStatistics &other_statistics = planners[j]->get_step_statistics();
+                result.potential_collisions += count_collisions(statistics.optimal_path, other_statistics.optimal_path);
+                result.remaining_collisions += count_collisions(statistics.planned_path, other_statistics.planned_path);
+            }
+
+            for (uint32_t point_index : statistics.planned_path.point_indices)
+            {
+                result.checksum = (result.checksum ^ point_index) * 1099511628211ull;
+            }
+        }
+        ++result.completed_steps;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(step_mutex);
+        stop_threads = true;
+    }
+    step_started.notify_all();
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+
+    const double n_plans = static_cast<double>(result.completed_steps) * planners.size();
+    if (n_plans > 0)
+    {
+        result.speed_loss = sum_speed_loss / n_plans;
+        result.mean_fca = sum_fca / n_plans;
+        result.mean_plan_ms = sum_plan_ms / n_plans;
+        result.mean_round_ms = sum_round_ms / result.completed_steps;
+    }
+    return result;
+}
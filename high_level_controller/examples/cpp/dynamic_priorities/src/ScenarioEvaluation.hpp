@@ -0,0 +1,137 @@
+// MIT License
+//
+// Copyright (c) 2020 Lehrstuhl Informatik 11 - RWTH Aachen University
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// This file is part of cpm_lab.
+//
+// Author: i11 - Embedded Software, RWTH Aachen University
+
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Pose2D.hpp"
+#include "VehicleTrajectoryPlanner.hpp"
+
+/**
+ * \struct EvaluationScenario
+ * \brief Settings of one scenario of the ScenarioEvaluation
+ * \ingroup distributed_routing
+ */
+struct EvaluationScenario
+{
+    //! Priority assignment strategy of all planners
+    PriorityMode mode = PriorityMode::fca;
+    //! Number of vehicles, with IDs 1..n_vehicles
+    int n_vehicles = 0;
+    //! Seed of the scenario; vehicle i uses seed + i for its path and its random priorities, like in simulation.cpp
+    int seed = 0;
+    //! Number of timesteps to plan
+    int n_steps = 0;
+    //! Send the planned paths in the compact VehiclePath encoding instead of Trajectory messages, must not change the results
+    bool compact_paths = false;
+};
+
+/**
+ * \struct EvaluationResult
+ * \brief Results of one scenario of the ScenarioEvaluation, summed or averaged over all vehicles and timesteps.
+ * Everything except the timings is deterministic for a given scenario.
+ * \ingroup distributed_routing
+ */
+struct EvaluationResult
+{
+    //! The evaluated scenario
+    EvaluationScenario scenario;
+    //! Empty if the scenario could be run, else the reason why it could not be run
+    std::string error;
+    //! Number of timesteps that all planners finished; smaller than scenario.n_steps if a planner gave up
+    int completed_steps = 0;
+    //! Timesteps in which a planner returned no trajectory
+    int aborted_plans = 0;
+    //! Timesteps in which a planner used new priorities (PlanningStepStatistics::priority_outcome 0)
+    int new_priorities = 0;
+    //! Timesteps in which a planner used the old priorities (PlanningStepStatistics::priority_outcome 1)
+    int old_priorities = 0;
+    //! Timesteps in which a planner had to keep its previous speed profile (PlanningStepStatistics::priority_outcome 2)
+    int safety_stops = 0;
+    //! Collisions between the paths the vehicles would drive without other vehicles, per pair of vehicles and timestep
+    int potential_collisions = 0;
+    //! Collisions between the planned paths, per pair of vehicles and timestep
+    int remaining_collisions = 0;
+    //! Mean of 1 - driven speed / maximum speed
+    double speed_loss = 0;
+    //! Mean FCA value (see PlanningStepStatistics::fca)
+    double mean_fca = 0;
+    //! Maximum FCA value
+    int max_fca = 0;
+    //! Mean duration of plan() in ms
+    double mean_plan_ms = 0;
+    //! Maximum duration of plan() in ms
+    double max_plan_ms = 0;
+    //! Mean time until all planners finished a timestep in ms
+    double mean_round_ms = 0;
+    //! Hash of all planned paths, changes if any planned path changes
+    uint64_t checksum = 0;
+
+    /**
+     * \brief Column names of to_csv, separated with ';'
+     */
+    static std::string csv_header();
+
+    /**
+     * \brief The result as one line of a CSV file (without line break), separated with ';'
+     */
+    std::string to_csv() const;
+};
+
+/**
+ * \class ScenarioEvaluation
+ * \brief Runs the planners of a scenario in one process without DDS: Each planner runs in its own thread and communicates
+ * with the other planners of the scenario via an InMemoryMessageBus. The timesteps are virtual, i.e. the next timestep is
+ * planned as soon as all planners finished the previous one. The scenarios are independent of each other, so they can be run in parallel.
+ * \ingroup distributed_routing
+ */
+class ScenarioEvaluation
+{
+    //! Start poses of the vehicles, vehicle i starts at start_poses[i - 1]
+    std::vector<Pose2D> start_poses;
+    //! Length of a timestep in nanoseconds
+    uint64_t dt_nanos;
+    //! See VehicleTrajectoryPlanner::set_round_timeout; only guards against planners that wait forever, as no messages get lost
+    uint64_t round_timeout_nanos;
+
+public:
+    /**
+     * \brief Create the evaluation
+     * \param _start_poses Start poses of the vehicles, also limits the number of vehicles
+     * \param _dt_nanos Length of a timestep in nanoseconds
+     * \param _round_timeout_nanos Maximum wall clock time the planners wait for each other in a timestep
+     */
+    ScenarioEvaluation(std::vector<Pose2D> _start_poses, uint64_t _dt_nanos, uint64_t _round_timeout_nanos);
+
+    /**
+     * \brief Run a scenario, blocks until it is finished. Can be called by several threads at once.
+     * \param scenario The scenario
+     */
+    EvaluationResult run(const EvaluationScenario &scenario) const;
+};
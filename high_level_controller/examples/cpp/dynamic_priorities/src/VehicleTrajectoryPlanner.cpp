@@ -34,6 +34,7 @@
  */
 
 #include "VehicleTrajectoryPlanner.hpp"
+#include "lane_graph_tools.hpp"
 #include <cstdlib>
 #include <string.h>
 #include <iostream>
@@ -46,13 +47,23 @@
  * \ingroup distributed_routing
  */
 
-VehicleTrajectoryPlanner::VehicleTrajectoryPlanner(PriorityMode _mode, int _seed){
-    writer_sync = std::unique_ptr<cpm::Writer<FallbackSync>>(
-        new cpm::Writer<FallbackSync>("fallbacksync")
-        );
-    reader_sync =  std::unique_ptr<cpm::ReaderAbstract<FallbackSync>>(
-        new cpm::ReaderAbstract<FallbackSync>("fallbacksync")
-        );
+VehicleTrajectoryPlanner::VehicleTrajectoryPlanner(PriorityMode _mode, int _seed)
+:VehicleTrajectoryPlanner(_mode, _seed,
+    std::unique_ptr<MessageWriter<FallbackSync>>(
+        new DdsMessageWriter<FallbackSync>("fallbacksync")
+        ),
+    std::unique_ptr<MessageReader<FallbackSync>>(
+        new DdsMessageReader<FallbackSync>("fallbacksync")
+        )
+    )
+{
+}
+
+VehicleTrajectoryPlanner::VehicleTrajectoryPlanner(PriorityMode _mode, int _seed,
+        std::unique_ptr<MessageWriter<FallbackSync>> _writer_sync,
+        std::unique_ptr<MessageReader<FallbackSync>> _reader_sync){
+    writer_sync = std::move(_writer_sync);
+    reader_sync = std::move(_reader_sync);
     mode = _mode;
     
     if (mode == PriorityMode::random){
@@ -85,12 +96,15 @@ void VehicleTrajectoryPlanner::set_vehicle(std::unique_ptr<VehicleTrajectoryPlan
     
     vehicle_id = trajectoryPlan->get_vehicle_id();
 
-    for (auto vehicle_id : coupling_graph.getVehicles())
-    {
-        prio_vec.push_back(vehicle_id);
-    }
+    // Initial priorities: Every vehicle plans after its previous vehicles in the coupling graph
+    prio_vec = coupling_graph.getPlanningOrder();
+    assert(prio_vec.size() == coupling_graph.getVehicles().size());
 
     // Open file to write evaluation data
+    if (!write_evaluation_file)
+    {
+        return;
+    }
     evaluation_stream.open(("evaluation_" +  std::to_string((int)vehicle_id) + ".csv"));
 
     if (evaluation_stream.is_open())
@@ -107,6 +121,11 @@ std::unique_ptr<VehicleCommandTrajectory> VehicleTrajectoryPlanner::plan(uint64_
     isStopped = false;
     t_real_time = t;
     dt_nanos = dt;
+    round_deadline = start_time + std::chrono::nanoseconds((round_timeout_nanos > 0) ? round_timeout_nanos : dt_nanos);
+    round_timed_out = false;
+    step_statistics.t = t;
+    step_statistics.fca = 0;
+    step_statistics.priority_outcome = 0;
 
     // Timesteps should come in a logical order
     assert(t_prev < t_real_time);
@@ -173,6 +192,7 @@ std::unique_ptr<VehicleCommandTrajectory> VehicleTrajectoryPlanner::plan(uint64_
     if (new_prios_feasible)
     {
         evaluation_stream << 0 << ";";
+        step_statistics.priority_outcome = 0;
     } 
     // if dynamic prio, but change not feasible, try if old prios work
     else
@@ -190,17 +210,20 @@ std::unique_ptr<VehicleCommandTrajectory> VehicleTrajectoryPlanner::plan(uint64_
         {
             std::cout << "Old prios infeasible: " << std::endl;
             evaluation_stream << 2 << ";";
+            step_statistics.priority_outcome = 2;
             trajectoryPlan->revert_speed_profile();
         }
         else
         {
             evaluation_stream << 1 << ";";
+            step_statistics.priority_outcome = 1;
         }
     }
 
     
-    int coll_left = trajectoryPlan->potential_collisions(other_vehicles_buffer, false);
+    int coll_left = trajectoryPlan->potential_collisions(other_vehicle_paths, false);
     evaluation_stream << "col_left " << coll_left << ";";
+    step_statistics.collisions_left = coll_left;
     if (coll_left > 0)
     {
         std::cout << "we still have: " << coll_left << " collisions" << std::endl;
@@ -214,7 +237,7 @@ std::unique_ptr<VehicleCommandTrajectory> VehicleTrajectoryPlanner::plan(uint64_
     evaluation_stream << ";";
 
     // compute the trajectory point vector which will be send to the vehicle
-    if (!stopFlag)
+    if (!round_aborted())
     {
         if (t_start == 0)
         {
@@ -251,6 +274,13 @@ std::unique_ptr<VehicleCommandTrajectory> VehicleTrajectoryPlanner::plan(uint64_
     //debug_writeOutReceivedTrajectories();
     //debug_analyzeTrajectoryPointBuffer();
 
+    step_statistics.mean_speed = trajectoryPlan->get_timestep_mean_speed();
+    if (collect_statistics)
+    {
+        trajectoryPlan->compute_planned_path(true, step_statistics.optimal_path);
+        trajectoryPlan->compute_planned_path(false, step_statistics.planned_path);
+    }
+
     // Advance trajectoryPlanningState by 1 timestep
     trajectoryPlan->apply_timestep();
     auto end_time = std::chrono::steady_clock::now();
@@ -264,7 +294,9 @@ std::unique_ptr<VehicleCommandTrajectory> VehicleTrajectoryPlanner::plan(uint64_
     evaluation_stream <<  std::chrono::duration<double, std::milli>(diff).count() << ";";
     // flush evaluation buffer line
     evaluation_stream  << std::endl;
-    if (!stopFlag)
+    step_statistics.plan_ms = std::chrono::duration<double, std::milli>(diff).count();
+    step_statistics.has_trajectory = !round_aborted();
+    if (!round_aborted())
     {
         isStopped = true;
         no_trajectory_counter = 0;
@@ -273,7 +305,7 @@ std::unique_ptr<VehicleCommandTrajectory> VehicleTrajectoryPlanner::plan(uint64_
     }
     else
     {
-        // middleware set stopFlag
+        // middleware set stopFlag or other vehicles did not answer in time
         cpm::Logging::Instance().write(2,
                                        "%lu: Not returning trajectory", t_real_time);
         no_trajectory_counter++;
@@ -293,11 +325,12 @@ std::unique_ptr<VehicleCommandTrajectory> VehicleTrajectoryPlanner::plan(uint64_
 }
 
 bool VehicleTrajectoryPlanner::plan_random_priorities(){
-    other_vehicles_buffer.clear(); // received trajectories are cleared
+    other_vehicle_paths.clear(); // received trajectories are cleared
 
     uint16_t rand_fca = uniform_distrib(random_gen); // generate random fca in [0,500]
     write_fca(vehicle_id, rand_fca, 1);
     evaluation_stream << (int)rand_fca << ";";
+    step_statistics.fca = rand_fca;
 
     std::vector<uint8_t> old_prio_vec = prio_vec;
     prio_vec = fca_prio_vec(rand_fca);
@@ -305,7 +338,7 @@ bool VehicleTrajectoryPlanner::plan_random_priorities(){
     bool feasible = plan_static_priorities();
     std::cout << "new prios fasible: " << feasible << std::endl;
     bool other_feasible = synchronise(coupling_graph.getVehicles(), feasible, 3);
-    feasible = feasible && other_feasible;
+    feasible = feasible && other_feasible && !round_aborted(); // the new priorities are incomplete if reading was aborted
     std::cout << "other vehicles fasible: " << feasible << std::endl;
     if (!feasible)
     {
@@ -318,15 +351,15 @@ bool VehicleTrajectoryPlanner::plan_random_priorities(){
 bool VehicleTrajectoryPlanner::plan_static_priorities(){
     bool prios_feasible = true;
     
-    other_vehicles_buffer.clear();
+    other_vehicle_paths.clear();
 
-    bool other_feasible = !read_vehicles(prev_vehicles(), other_vehicles_buffer, true);
-    prios_feasible = prios_feasible && other_feasible; // Waits until we received the trajs needed for planning
+    bool other_feasible = !read_vehicles(prev_vehicles(), other_vehicle_paths, true);
+    prios_feasible = prios_feasible && other_feasible && !round_aborted(); // Waits until we received the trajs needed for planning
 
     if (prios_feasible)
     {
         bool avoid_successful = trajectoryPlan->avoid_collisions(
-            other_vehicles_buffer
+            other_vehicle_paths
         );
         bool has_collisions = !avoid_successful;
         prios_feasible = prios_feasible && avoid_successful;
@@ -350,14 +383,15 @@ bool VehicleTrajectoryPlanner::plan_fca_priorities()
 
 
     new_prio_vec.clear();          // save new priorities until we know they are feasible and update prio_vec
-    other_vehicles_buffer.clear(); // received trajectories are cleared
+    other_vehicle_paths.clear(); // received trajectories are cleared
 
     
 
     send_plan_to_hlcs(true, false);                                                 // send own optimal trajectory
-    read_optimal_trajectories();                                                    // read all optimal trajectories
-    uint16_t own_fca = trajectoryPlan->potential_collisions(vehicles_buffer, true); // compute fca based on optimal trajectories
+    read_optimal_paths();                                                           // read all optimal trajectories
+    uint16_t own_fca = trajectoryPlan->potential_collisions(vehicle_paths, true);   // compute fca based on optimal trajectories
     evaluation_stream << (int)own_fca << ";";
+    step_statistics.fca = own_fca;
     // all vehicles become active
     active_vehicles = coupling_graph.getVehicles();
     is_active = true;
@@ -368,10 +402,15 @@ bool VehicleTrajectoryPlanner::plan_fca_priorities()
         synchronise(active_vehicles, true, 5);
         write_fca(vehicle_id, own_fca, iteration);
         uint8_t winner_id = get_largest_fca(own_fca); // read fca -> winner plans
+        if (round_aborted())
+        {
+            new_prios_feasible = false;
+            break;
+        }
         if (winner_id == vehicle_id) // if winner plan; send trajectory;
         {
             avoid_successful = trajectoryPlan->avoid_collisions(
-                other_vehicles_buffer
+                other_vehicle_paths
             ); // plan own trajectory
             new_prios_feasible = new_prios_feasible && avoid_successful;
             has_collisions = !avoid_successful;
@@ -380,12 +419,13 @@ bool VehicleTrajectoryPlanner::plan_fca_priorities()
         }
         else
         {
-            bool winner_feasible = !read_vehicles({winner_id}, other_vehicles_buffer, true); // else read winner and repeat
+            bool winner_feasible = !read_vehicles({winner_id}, other_vehicle_paths, true); // else read winner and repeat
             new_prios_feasible = new_prios_feasible && winner_feasible;
             if (winner_feasible)
             {
-                vehicles_buffer[winner_id] = other_vehicles_buffer[winner_id];
-                own_fca = trajectoryPlan->update_potential_collisions(vehicles_buffer, winner_id, own_fca);
+                PlannedPath &winner_path = get_vehicle_path(vehicle_paths, winner_id);
+                winner_path = get_vehicle_path(other_vehicle_paths, winner_id);
+                own_fca = trajectoryPlan->update_potential_collisions(winner_path, own_fca);
             }
         }
         active_vehicles.erase(winner_id);  // winner is not active anymore -> remove from set
@@ -396,7 +436,7 @@ bool VehicleTrajectoryPlanner::plan_fca_priorities()
     if (new_prios_feasible)
     {
         bool other_feasible = !read_vehicles(active_vehicles, ignored_vehicles_buffer); // read remaining and check if still feasible
-        new_prios_feasible = new_prios_feasible && other_feasible;
+        new_prios_feasible = new_prios_feasible && other_feasible && !round_aborted(); // the new priorities are incomplete if reading was aborted
     }
     if (new_prios_feasible)
     {
@@ -413,13 +453,14 @@ bool VehicleTrajectoryPlanner::plan_fca_priorities()
 bool VehicleTrajectoryPlanner::plan_vertex_ordering_priorities()
 {
     new_prio_vec.clear();          // save new priorities until we know they are feasible and update prio_vec
-    other_vehicles_buffer.clear(); // received trajectories are cleared
+    other_vehicle_paths.clear(); // received trajectories are cleared
 
     send_plan_to_hlcs(true, false);                                                 // send own optimal trajectory
     read_optimal_trajectories();                                                    // read all optimal trajectories
     
     std::vector<uint8_t> old_prio_vec = prio_vec;
     prio_vec = trajectoryPlan->compute_graph_based_priorities(vehicles_buffer);
+    debug_write_prio_vec();
     synchronise(coupling_graph.getVehicles(), true, 5);
     evaluation_stream << 0 << ";";
 
@@ -441,14 +482,17 @@ bool VehicleTrajectoryPlanner::plan_vertex_ordering_priorities()
             std::cout << "stopping" << std::endl;
             trajectoryPlan->revert_speed_profile();
             evaluation_stream << 2 << ";";
+            step_statistics.priority_outcome = 2;
         }
         else
         {
             evaluation_stream << 1 << ";";
+            step_statistics.priority_outcome = 1;
         }
     } else 
     {
         evaluation_stream << 0 << ";";
+        step_statistics.priority_outcome = 0;
     }
     return true;
 }
@@ -476,6 +520,26 @@ std::set<uint8_t> VehicleTrajectoryPlanner::ignored_vehicles()
     return ig_veh;
 }
 
+template<typename MessageType>
+void VehicleTrajectoryPlanner::wait_for_messages(MessageReader<MessageType> &reader)
+{
+    if (round_aborted())
+    {
+        return;
+    }
+
+    reader.wait_for_messages(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(round_deadline - std::chrono::steady_clock::now())
+    );
+
+    if (!stopFlag && std::chrono::steady_clock::now() >= round_deadline)
+    {
+        round_timed_out = true;
+        cpm::Logging::Instance().write(2,
+                                       "%lu: Other vehicles did not answer in time, aborting timestep", t_real_time);
+    }
+}
+
 bool VehicleTrajectoryPlanner::synchronise(std::set<uint8_t> vehicle_ids, bool feasible, uint8_t sync_id){
     FallbackSync sync_message;
     sync_message.vehicle_id(trajectoryPlan->get_vehicle_id());
@@ -487,8 +551,10 @@ bool VehicleTrajectoryPlanner::synchronise(std::set<uint8_t> vehicle_ids, bool f
 
     bool other_feasible = true;
     std::set<uint8_t> received_ids;
-    while (     !std::includes(received_ids.begin(), received_ids.end(), vehicle_ids.begin(), vehicle_ids.end()) 
-            &&  !stopFlag)
+    auto all_received = [&] () {
+        return std::includes(received_ids.begin(), received_ids.end(), vehicle_ids.begin(), vehicle_ids.end());
+    };
+    while (!all_received() && !round_aborted())
     {
         auto messages = reader_sync->take();
         for (auto sync_message : messages)
@@ -500,6 +566,11 @@ bool VehicleTrajectoryPlanner::synchronise(std::set<uint8_t> vehicle_ids, bool f
                 std::cout << (int)sync_message.vehicle_id() << " ,";
             }
         }
+
+        if (!all_received())
+        {
+            wait_for_messages(*reader_sync);
+        }
     }
     return other_feasible;
 }
@@ -509,11 +580,12 @@ uint8_t VehicleTrajectoryPlanner::get_largest_fca(uint16_t own_fca){
     std::set<uint8_t> received_fcas;
     uint8_t winner = trajectoryPlan->get_vehicle_id();
     uint16_t largest_fca = own_fca;
+    auto all_received = [&] () {
+        // Becomes true, when we received fca from all active vehicles
+        return std::includes(received_fcas.begin(), received_fcas.end(), active_vehicles.begin(), active_vehicles.end());
+    };
 
-    while( !std::includes(received_fcas.begin(), received_fcas.end(),
-                active_vehicles.begin(), active_vehicles.end()) // Becomes true, when we received fca from all active vehicles 
-                 && !active_vehicles.empty()
-            ) 
+    while (!all_received() && !active_vehicles.empty() && !round_aborted())
     {   
         auto samples = reader_fca->take();
         
@@ -528,7 +600,11 @@ uint8_t VehicleTrajectoryPlanner::get_largest_fca(uint16_t own_fca){
                 }
             } 
         }
-        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+        if (!all_received())
+        {
+            wait_for_messages(*reader_fca);
+        }
     }
     return winner;
 }
@@ -536,14 +612,14 @@ uint8_t VehicleTrajectoryPlanner::get_largest_fca(uint16_t own_fca){
  * Reads the trajectories of vehicles with a higher prio
  */
 bool VehicleTrajectoryPlanner::read_previous_vehicles() {
-    return read_vehicles(coupling_graph.getPreviousVehicles(trajectoryPlan->get_vehicle_id()), other_vehicles_buffer, true, false);
+    return read_vehicles(coupling_graph.getPreviousVehicles(trajectoryPlan->get_vehicle_id()), other_vehicle_paths, true, false);
 }
 
 /*
  * Reads the planned paths of concurrent planning vehicles
  */
 bool VehicleTrajectoryPlanner::read_concurrent_vehicles() {
-    return read_vehicles(coupling_graph.getConcurrentVehicles(trajectoryPlan->get_vehicle_id()), other_vehicles_buffer, true, false, false); 
+    return read_vehicles(coupling_graph.getConcurrentVehicles(trajectoryPlan->get_vehicle_id()), other_vehicle_paths, true, false, false); 
 }
 
 /*
@@ -560,9 +636,14 @@ void VehicleTrajectoryPlanner::read_optimal_trajectories(){
     read_vehicles(other_vehicles, vehicles_buffer, true, false, true);
 }
 
+void VehicleTrajectoryPlanner::read_optimal_paths(){
+    vehicle_paths.clear();
+    read_vehicles(coupling_graph.getVehicles(), vehicle_paths, true, false, true);
+}
+
 
 // Reads LaneGraphTrajectories sent by other vehicles in this timestep
-// into other_vehicles_buffer.
+// into the given buffer.
 // Blocks until a message from all vehicles specified in the comm graph
 // is received or the stop() method is called.
 
@@ -572,6 +653,36 @@ bool VehicleTrajectoryPlanner::read_vehicles(
     bool write_to_buffer, 
     bool final_messages_only,
     bool only_optimal)
+{
+    if (reader_vehicle_path)
+    {
+        return read_vehicles(*reader_vehicle_path, vehicle_ids, vehicles_buffer, write_to_buffer, final_messages_only, only_optimal);
+    }
+    return read_vehicles(*reader_trajectory, vehicle_ids, vehicles_buffer, write_to_buffer, final_messages_only, only_optimal);
+}
+
+bool VehicleTrajectoryPlanner::read_vehicles(
+    std::set<uint8_t> vehicle_ids, 
+    std::vector<PlannedPath> &vehicle_paths, 
+    bool write_to_buffer, 
+    bool final_messages_only,
+    bool only_optimal)
+{
+    if (reader_vehicle_path)
+    {
+        return read_vehicles(*reader_vehicle_path, vehicle_ids, vehicle_paths, write_to_buffer, final_messages_only, only_optimal);
+    }
+    return read_vehicles(*reader_trajectory, vehicle_ids, vehicle_paths, write_to_buffer, final_messages_only, only_optimal);
+}
+
+template<typename PathMessage, typename Buffer>
+bool VehicleTrajectoryPlanner::read_vehicles(
+    MessageReader<PathMessage> &reader,
+    const std::set<uint8_t> &vehicle_ids, 
+    Buffer &buffer, 
+    bool write_to_buffer, 
+    bool final_messages_only,
+    bool only_optimal)
 {
     assert(started);
 
@@ -583,13 +694,16 @@ bool VehicleTrajectoryPlanner::read_vehicles(
     // our messages_received contains all vehicles we're waiting for
     std::set<uint8_t> received_messages;
     bool received_collisions = false;
-    while( !std::includes(received_messages.begin(), received_messages.end(),
-                vehicle_ids.begin(), vehicle_ids.end()) // Becomes true, when we received msg from all vehicle_ids
+    auto all_received = [&] () {
+        // Becomes true, when we received msg from all vehicle_ids
+        return std::includes(received_messages.begin(), received_messages.end(), vehicle_ids.begin(), vehicle_ids.end());
+    };
+    while( !all_received()
             && !vehicle_ids.empty() // Stop immediately when vehicle_ids is empty
-            && !stopFlag // Stop early, when we receive a stopFlag
+            && !round_aborted() // Stop early, when we receive a stopFlag or the round deadline passed
             ) {
-        auto samples = reader_trajectory->take();
-        for(Trajectory sample : samples) {
+        auto samples = reader.take();
+        for(const PathMessage &sample : samples) {
             uint64_t t_message = sample.header().create_stamp().nanoseconds();
 
             // Usually we only listen to messages with MessageType Final
@@ -623,44 +737,17 @@ bool VehicleTrajectoryPlanner::read_vehicles(
                     continue;
                 }
 
-                // Clear out the buffer for this specific vehicle
+                // Overwrite the buffer for this specific vehicle
                 // Especially important for iterative planning vehicles
-                vehicles_buffer[sample.vehicle_id()].clear();
-                vehicles_buffer[sample.vehicle_id()].reserve(1000);
-
-                // Save all received positions that are not in the past already
-                for ( LaneGraphPosition position : sample.lane_graph_positions() ) {
-
-                    // Check TimeStamp of each Position to see where it fits into our buffer
-                    // Casting to signed number because we might get negative values
-                    long long t_eta = position.estimated_arrival_time().nanoseconds();
-                    long long dt_speed_profile_nanos = trajectoryPlan->get_dt_speed_profile_nanos();
-                    int index = 
-                        ( t_eta - (long long) t_real_time)
-                        / dt_speed_profile_nanos;
-
-                    // We sometimes get unrealistic indices, which we don't want to use
-                    if( index < -10 ) {
-                        continue;
-                    }
-
-                    // Only write into buffer if index is positive, no interpolation is done since this hlc sends the full speed profiles
-                    if( index >= 0 ) {
-                        vehicles_buffer[sample.vehicle_id()].push_back(
-                            std::make_pair( index,
-                                std::make_pair(
-                                    position.edge_index(),
-                                    position.edge_path_index()
-                                )
-                            )
-                        );
-                    }
-                }
+                store_received(sample, buffer);
             }
         }
 
-        // Slow down loop a little
-        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        // Block until the next messages arrive
+        if (!all_received())
+        {
+            wait_for_messages(reader);
+        }
     }
 
 #if TIMED
@@ -680,18 +767,117 @@ bool VehicleTrajectoryPlanner::read_vehicles(
     return received_collisions;
 }
 
+void VehicleTrajectoryPlanner::get_received_positions(
+    const Trajectory &sample,
+    std::vector<std::pair<size_t, std::pair<size_t, size_t>>> &positions)
+{
+    positions.clear();
+    positions.reserve(1000);
+
+    // Save all received positions that are not in the past already
+    for ( const LaneGraphPosition &position : sample.lane_graph_positions() ) {
+
+        // Check TimeStamp of each Position to see where it fits into our buffer
+        // Casting to signed number because we might get negative values
+        long long t_eta = position.estimated_arrival_time().nanoseconds();
+        long long dt_speed_profile_nanos = trajectoryPlan->get_dt_speed_profile_nanos();
+        int index = 
+            ( t_eta - (long long) t_real_time)
+            / dt_speed_profile_nanos;
+
+        // We sometimes get unrealistic indices, which we don't want to use
+        if( index < -10 ) {
+            continue;
+        }
+
+        // Only write into buffer if index is positive, no interpolation is done since this hlc sends the full speed profiles
+        if( index >= 0 ) {
+            positions.push_back(
+                std::make_pair( index,
+                    std::make_pair(
+                        position.edge_index(),
+                        position.edge_path_index()
+                    )
+                )
+            );
+        }
+    }
+}
+
+void VehicleTrajectoryPlanner::store_received(
+    const Trajectory &sample,
+    std::map<uint8_t, std::vector<std::pair<size_t, std::pair<size_t, size_t>>>> &vehicles_buffer)
+{
+    get_received_positions(sample, vehicles_buffer[sample.vehicle_id()]);
+}
+
+void VehicleTrajectoryPlanner::store_received(
+    const VehiclePath &sample,
+    std::map<uint8_t, std::vector<std::pair<size_t, std::pair<size_t, size_t>>>> &vehicles_buffer)
+{
+    if (!VehicleTrajectoryPlanningState::get_received_positions(sample, t_real_time, vehicles_buffer[sample.vehicle_id()]))
+    {
+        cpm::Logging::Instance().write(1,
+            "Received an inconsistent path from vehicle %d",
+            static_cast<int>(sample.vehicle_id()));
+    }
+}
+
+void VehicleTrajectoryPlanner::store_received(
+    const Trajectory &sample,
+    std::vector<PlannedPath> &vehicle_paths)
+{
+    get_received_positions(sample, received_positions);
+    VehicleTrajectoryPlanningState::load_other_path(
+        sample.vehicle_id(), received_positions, get_vehicle_path(vehicle_paths, sample.vehicle_id()));
+}
+
+void VehicleTrajectoryPlanner::store_received(
+    const VehiclePath &sample,
+    std::vector<PlannedPath> &vehicle_paths)
+{
+    if (!VehicleTrajectoryPlanningState::load_other_path(sample, t_real_time, get_vehicle_path(vehicle_paths, sample.vehicle_id())))
+    {
+        cpm::Logging::Instance().write(1,
+            "Received an inconsistent path from vehicle %d",
+            static_cast<int>(sample.vehicle_id()));
+    }
+}
+
+PlannedPath &VehicleTrajectoryPlanner::get_vehicle_path(std::vector<PlannedPath> &vehicle_paths, uint8_t vehicle_id)
+{
+    auto path = std::lower_bound(vehicle_paths.begin(), vehicle_paths.end(), vehicle_id,
+        [] (const PlannedPath &other, uint8_t id) { return other.vehicle_id < id; });
+    if (path == vehicle_paths.end() || path->vehicle_id != vehicle_id)
+    {
+        path = vehicle_paths.insert(path, PlannedPath());
+        path->vehicle_id = vehicle_id;
+        path->point_indices.fill(PlannedPath::no_point);
+    }
+    return *path;
+}
+
 /*
  * Stop planning of this timestep
  */
 void VehicleTrajectoryPlanner::stop() {
     evaluation_stream.close();
     stopFlag = true; 
+    // Wake up the planner if it is waiting for messages of other vehicles
+    if (reader_trajectory) reader_trajectory->interrupt_wait();
+    if (reader_vehicle_path) reader_vehicle_path->interrupt_wait();
+    if (reader_fca) reader_fca->interrupt_wait();
+    reader_sync->interrupt_wait();
     // Block until planner is stopped
     while( !isStopped) {
         std::this_thread::sleep_for(std::chrono::milliseconds(1));
     }
     std::cout << "Stopped planning early at timestep " << t_real_time << std::endl;
 
+    if (reader_trajectory) reader_trajectory->reset_interrupt();
+    if (reader_vehicle_path) reader_vehicle_path->reset_interrupt();
+    if (reader_fca) reader_fca->reset_interrupt();
+    reader_sync->reset_interrupt();
     stopFlag = false;
     return;
 }
@@ -700,6 +886,12 @@ void VehicleTrajectoryPlanner::stop() {
  * Publish the planned trajectory to DDS
  */
 void VehicleTrajectoryPlanner::send_plan_to_hlcs(bool optimal, bool is_final, bool has_collisions) {
+    if( writer_vehicle_path )
+    {
+        send_path_to_hlcs(optimal, is_final, has_collisions);
+        return;
+    }
+
     Trajectory hlc_comms;
     trajectoryPlan->get_lane_graph_positions(hlc_comms, optimal);
     // Add TimeStamp to each point
@@ -731,7 +923,36 @@ void VehicleTrajectoryPlanner::send_plan_to_hlcs(bool optimal, bool is_final, bo
 }
 
 /*
- * Fills in points between two points on the Lane Graph in our other_vehicles_buffer.
+ * Publish the planned path to DDS, in the compact encoding
+ */
+void VehicleTrajectoryPlanner::send_path_to_hlcs(bool optimal, bool is_final, bool has_collisions) {
+    VehiclePath vehicle_path;
+    trajectoryPlan->get_vehicle_path(vehicle_path, optimal);
+    // The first point is reached now, the following ones one speed profile step later each
+    vehicle_path.start_time().nanoseconds(t_real_time);
+
+    if( is_final )
+    {
+        vehicle_path.type(MessageType::Final);
+    }
+    else if (optimal)
+    {
+        vehicle_path.type(MessageType::Optimal);
+    } 
+    else
+    {
+        vehicle_path.type(MessageType::Iterative);
+    }
+
+    vehicle_path.has_collisions(has_collisions);
+    vehicle_path.header().create_stamp().nanoseconds(t_real_time);
+    vehicle_path.header().valid_after_stamp().nanoseconds(0); //unused
+
+    writer_vehicle_path->write(vehicle_path);
+}
+
+/*
+ * Fills in points between two points on the Lane Graph in the given vehicles_buffer.
  * This naively assumes a fixed speed, equidistant edge_paths-Points
  * and assumes that we are interpolating between two adjacent edges.
  */
@@ -797,19 +1018,52 @@ void VehicleTrajectoryPlanner::clear_past_trajectory_point_buffer() {
 
 void VehicleTrajectoryPlanner::set_writer(
         std::unique_ptr< cpm::Writer<Trajectory> > writer){
+    writer_trajectory.reset(new DdsMessageWriter<Trajectory>(std::move(writer)));
+}
+void VehicleTrajectoryPlanner::set_writer(
+        std::unique_ptr< MessageWriter<Trajectory> > writer){
     writer_trajectory = std::move(writer);
 }
 void VehicleTrajectoryPlanner::set_reader(
         std::unique_ptr< cpm::ReaderAbstract<Trajectory> > reader){
+    reader_trajectory.reset(new DdsMessageReader<Trajectory>(std::move(reader)));
+}
+void VehicleTrajectoryPlanner::set_reader(
+        std::unique_ptr< MessageReader<Trajectory> > reader){
     reader_trajectory = std::move(reader);
 }
 
+void VehicleTrajectoryPlanner::set_vehicle_path_writer(
+        std::unique_ptr< cpm::Writer<VehiclePath> > writer){
+    writer_vehicle_path.reset(new DdsMessageWriter<VehiclePath>(std::move(writer)));
+}
+void VehicleTrajectoryPlanner::set_vehicle_path_writer(
+        std::unique_ptr< MessageWriter<VehiclePath> > writer){
+    writer_vehicle_path = std::move(writer);
+}
+void VehicleTrajectoryPlanner::set_vehicle_path_reader(
+        std::unique_ptr< cpm::ReaderAbstract<VehiclePath> > reader){
+    reader_vehicle_path.reset(new DdsMessageReader<VehiclePath>(std::move(reader)));
+}
+void VehicleTrajectoryPlanner::set_vehicle_path_reader(
+        std::unique_ptr< MessageReader<VehiclePath> > reader){
+    reader_vehicle_path = std::move(reader);
+}
+
 void VehicleTrajectoryPlanner::set_fca_writer(
         std::unique_ptr< cpm::Writer<FutureCollisionAssessment> > writer){
+    writer_fca.reset(new DdsMessageWriter<FutureCollisionAssessment>(std::move(writer)));
+}
+void VehicleTrajectoryPlanner::set_fca_writer(
+        std::unique_ptr< MessageWriter<FutureCollisionAssessment> > writer){
     writer_fca = std::move(writer);
 }
 void VehicleTrajectoryPlanner::set_fca_reader(
         std::unique_ptr< cpm::ReaderAbstract<FutureCollisionAssessment> > reader){
+    reader_fca.reset(new DdsMessageReader<FutureCollisionAssessment>(std::move(reader)));
+}
+void VehicleTrajectoryPlanner::set_fca_reader(
+        std::unique_ptr< MessageReader<FutureCollisionAssessment> > reader){
     reader_fca = std::move(reader);
 }
 
@@ -818,6 +1072,10 @@ void VehicleTrajectoryPlanner::set_fca_reader(
  */
 void VehicleTrajectoryPlanner::set_visualization_writer(
     std::unique_ptr< cpm::Writer<Visualization> > writer){
+        writer_visualization.reset(new DdsMessageWriter<Visualization>(std::move(writer)));
+}
+void VehicleTrajectoryPlanner::set_visualization_writer(
+    std::unique_ptr< MessageWriter<Visualization> > writer){
         writer_visualization  = std::move(writer);
 }
 
@@ -883,18 +1141,21 @@ std::vector<uint8_t> VehicleTrajectoryPlanner::compute_priorities(){
 }
 
 /*
- * Prints contents of other_vehicles_buffer to stdout.
+ * Prints contents of other_vehicle_paths to stdout.
  */
 void VehicleTrajectoryPlanner::debug_writeOutReceivedTrajectories() {
-    for(auto const& vehicle : other_vehicles_buffer) {
-        std::cout << "Vehicle " << static_cast<uint32_t>(vehicle.first) << std::endl;
-        for(auto point : vehicle.second) {
+    for(auto const& path : other_vehicle_paths) {
+        std::cout << "Vehicle " << static_cast<uint32_t>(path.vehicle_id) << std::endl;
+        for(size_t i = 0; i < path.point_indices.size(); i++) {
+            if( path.point_indices[i] == PlannedPath::no_point ) {
+                continue;
+            }
             std::cout
-                << point.first
+                << i
                 << ", " 
-                << point.second.first
+                << path.point_indices[i] / laneGraphTools.n_edge_path_nodes
                 << ", "
-                << point.second.second
+                << path.point_indices[i] % laneGraphTools.n_edge_path_nodes
                 << std::endl; 
         }
     }
@@ -954,11 +1215,12 @@ std::vector<uint8_t> VehicleTrajectoryPlanner::fca_prio_vec(uint16_t &own_fca) {
 
     received_fcas.insert(vehicle_id);
     prio_vec.push_back(vehicle_id);
+    auto all_received = [&] () {
+        // Becomes true, when we received fca from all vehicles
+        return std::includes(received_fcas.begin(), received_fcas.end(), all_vehicles.begin(), all_vehicles.end());
+    };
 
-    while( !std::includes(received_fcas.begin(), received_fcas.end(),
-                all_vehicles.begin(), all_vehicles.end()) // Becomes true, when we received fca from all active vehicles 
-                 && !all_vehicles.empty()
-            ) 
+    while (!all_received() && !all_vehicles.empty() && !round_aborted())
     {   
         auto samples = reader_fca->take();
         
@@ -978,7 +1240,11 @@ std::vector<uint8_t> VehicleTrajectoryPlanner::fca_prio_vec(uint16_t &own_fca) {
                 }
             }
         }
-        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+        if (!all_received())
+        {
+            wait_for_messages(*reader_fca);
+        }
     }
     return prio_vec;
 }
\ No newline at end of file
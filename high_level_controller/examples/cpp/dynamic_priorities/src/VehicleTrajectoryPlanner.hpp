@@ -44,10 +44,12 @@
 #include "FutureCollisionAssessment.hpp"
 #include "Visualization.hpp"
 #include "Trajectory.hpp"
+#include "VehiclePath.hpp"
 #include "FallbackSync.hpp"
 
 #include "VehicleTrajectoryPlanningState.hpp"
 #include "CouplingGraph.hpp"
+#include "MessageChannel.hpp"
 
 //using std::vector;
 
@@ -60,6 +62,33 @@ enum class PriorityMode
     vertex_ordering
 };
 
+/**
+ * \struct PlanningStepStatistics
+ * \brief Outcome of one call of VehicleTrajectoryPlanner::plan, for evaluations without the evaluation files (see scenario_evaluation.cpp)
+ * \ingroup decentral_routing
+ */
+struct PlanningStepStatistics
+{
+    //! Time of the timestep in nanoseconds
+    uint64_t t = 0;
+    //! Future collision assessment value as in the evaluation file: fca (PriorityMode::fca), random value (PriorityMode::random) or 0
+    uint16_t fca = 0;
+    //! As new_old_fallback_prio in the evaluation file: new priorities used (0), old priorities used (1), safety stop (2)
+    int priority_outcome = 0;
+    //! Collisions of the planned trajectory with the received trajectories of the vehicles with higher priority
+    int collisions_left = 0;
+    //! Mean speed in this timestep in m/s
+    double mean_speed = 0;
+    //! Duration of plan() in ms
+    double plan_ms = 0;
+    //! False if planning of this timestep was aborted and no trajectory was returned
+    bool has_trajectory = false;
+    //! Path with the speed profile the vehicle would have without other vehicles; only computed when enabled by set_collect_statistics
+    PlannedPath optimal_path;
+    //! Planned path; only computed when enabled by set_collect_statistics
+    PlannedPath planned_path;
+};
+
 /**
  * \class VehicleTrajectoryPlanner
  * \brief Plans a random trajectory, while communicating planned trajectories with other vehicles.
@@ -69,14 +98,17 @@ class VehicleTrajectoryPlanner
 {
     //! PlanningState plans a route, treating other vehicles as fixed obstacles.
     std::unique_ptr<VehicleTrajectoryPlanningState> trajectoryPlan;
-    //! The received trajectories of other vehicles (previous and concurrent) get saved in here; overwritten each timestep
-    //std::map<uint8_t, std::map<size_t, std::pair<size_t, size_t>>> other_vehicles_buffer;
-    std::map<uint8_t, std::vector<std::pair<size_t, std::pair<size_t, size_t>>>> other_vehicles_buffer;
+    //! The received paths of other vehicles (previous and concurrent) get saved in here, sorted by vehicle id; overwritten each timestep
+    std::vector<PlannedPath> other_vehicle_paths;
     //! The received trajectories of vehicles of less priority get saved in here
     //std::map<uint8_t, std::map<size_t, std::pair<size_t, size_t>>> ignored_vehicles_buffer;
     std::map<uint8_t, std::vector<std::pair<size_t, std::pair<size_t, size_t>>>> ignored_vehicles_buffer;
-    //! All trajectories, updated when needed for dyn priorities. Contains optimal predicted and actual planned trajectories.
+    //! All trajectories, for the vertex ordering priorities. Contains optimal predicted trajectories.
     std::map<uint8_t, std::vector<std::pair<size_t, std::pair<size_t, size_t>>>> vehicles_buffer;
+    //! All paths, sorted by vehicle id, for the fca priorities. Contains optimal predicted and actual planned paths.
+    std::vector<PlannedPath> vehicle_paths;
+    //! Positions of a received Trajectory, before they are converted into a path; a member to avoid allocations
+    std::vector<std::pair<size_t, std::pair<size_t, size_t>>> received_positions;
     //! Optimal trajectories of all vehicles
     std::map<uint8_t, std::map<size_t, std::pair<size_t, size_t>>> optimal_vehicles_buffer;
     //! FutureCollisionAssesments of all vehicles; maps vehicle id to its fca
@@ -84,19 +116,23 @@ class VehicleTrajectoryPlanner
     //! Mutex to safely access the stored fcas 
     std::mutex collision_assessments_mutex;
     //! Writer to broadcast our own planned or optimal trajectory
-    std::unique_ptr< cpm::Writer<Trajectory> > writer_trajectory;
+    std::unique_ptr< MessageWriter<Trajectory> > writer_trajectory;
     //! Reader to receive other planned or optimal trajectories
-    std::unique_ptr< cpm::ReaderAbstract<Trajectory> > reader_trajectory;
+    std::unique_ptr< MessageReader<Trajectory> > reader_trajectory;
+    //! Writer to broadcast our own planned or optimal path in the compact encoding; replaces writer_trajectory if set
+    std::unique_ptr< MessageWriter<VehiclePath> > writer_vehicle_path;
+    //! Reader to receive other planned or optimal paths in the compact encoding; replaces reader_trajectory if set
+    std::unique_ptr< MessageReader<VehiclePath> > reader_vehicle_path;
     //! Writer to visualize priority and fca
-    std::unique_ptr< cpm::Writer<Visualization> > writer_visualization;
+    std::unique_ptr< MessageWriter<Visualization> > writer_visualization;
     //! Reader to read FutureCollisionAssessment messages
-    std::unique_ptr< cpm::ReaderAbstract<FutureCollisionAssessment> > reader_fca;
+    std::unique_ptr< MessageReader<FutureCollisionAssessment> > reader_fca;
     //! Writer to send FutureCollisionAssessments
-    std::unique_ptr< cpm::Writer<FutureCollisionAssessment> > writer_fca;
+    std::unique_ptr< MessageWriter<FutureCollisionAssessment> > writer_fca;
     //! Reader to read FallbackSync messages
-    std::unique_ptr< cpm::ReaderAbstract<FallbackSync> > reader_sync;
+    std::unique_ptr< MessageReader<FallbackSync> > reader_sync;
     //! Writer to send FallbackSync messages
-    std::unique_ptr< cpm::Writer<FallbackSync> > writer_sync;
+    std::unique_ptr< MessageWriter<FallbackSync> > writer_sync;
     //! Is false on the first planning step and after the planner crashed
     bool started = false;
     //! Is true, when we either couldn't find any trajectory, or we missed too many timesteps
@@ -105,6 +141,12 @@ class VehicleTrajectoryPlanner
     bool volatile stopFlag = false;
     //! Becomes true, when we are currently not planning a timestep
     bool volatile isStopped = true;
+    //! Maximum time to wait for other vehicles in one planning round in nanoseconds; 0 means the length of the timestep
+    uint64_t round_timeout_nanos = 0;
+    //! Point in time after which we stop waiting for other vehicles in the current planning round
+    std::chrono::steady_clock::time_point round_deadline;
+    //! Becomes true when the round_deadline passed before all expected messages were received; the timestep is then aborted like after stop()
+    bool round_timed_out = false;
     //! Time in nanoseconds, when we first started planning
     uint64_t t_start = 0;
     //! Time in nanoseconds of the current timestep
@@ -156,6 +198,12 @@ class VehicleTrajectoryPlanner
 
     // Evaluation filestream
     std::ofstream evaluation_stream;
+    //! Whether set_vehicle opens the evaluation file
+    bool write_evaluation_file = true;
+    //! Outcome of the last call of plan()
+    PlanningStepStatistics step_statistics;
+    //! Whether plan() computes the paths of step_statistics
+    bool collect_statistics = false;
 
     /**
      * \brief Read planned trajectories of vehicles that planned before us
@@ -172,14 +220,20 @@ class VehicleTrajectoryPlanner
      */
     bool wait_for_ignored_vehicles();
     /**
-     * \brief Reads the optimal trajectories of all other vehicles
+     * \brief Reads the optimal trajectories of all other vehicles into vehicles_buffer
      */
     void read_optimal_trajectories();
 
+    /**
+     * \brief Reads the optimal paths of all other vehicles into vehicle_paths
+     */
+    void read_optimal_paths();
+
     /**
      * \brief Generalized method to read planned trajectories of other vehicles
      * \param vehicle_ids Which vehicle ids should be read (blocks until all these are received)
-     * \param write_to_buffer When false, do not write messages to other_vehicles_buffer
+     * \param vehicles_buffer The buffer to write the received trajectories into
+     * \param write_to_buffer When false, do not write messages to the buffer
      * \param final_messages_only Only read messages with the "final" message attribute
      * \param only_optimal Only read messages containing optimal trajectories
      * \return True if one of the received messages has a collision `false` otherwise.
@@ -190,6 +244,60 @@ class VehicleTrajectoryPlanner
             bool final_messages_only=true,
             bool only_optimal=false);
 
+    /**
+     * \brief Like read_vehicles, but the received messages are decoded into the paths of the collision check
+     * \param vehicle_paths The received paths are written into this, sorted by vehicle id
+     */
+    bool read_vehicles(std::set<uint8_t> vehicle_ids,
+            std::vector<PlannedPath> &vehicle_paths,
+            bool write_to_buffer=false, 
+            bool final_messages_only=true,
+            bool only_optimal=false);
+
+    /**
+     * \brief read_vehicles for one message type, either Trajectory or VehiclePath, and one type of buffer
+     * \param reader The reader to take the messages from
+     */
+    template<typename PathMessage, typename Buffer>
+    bool read_vehicles(MessageReader<PathMessage> &reader,
+            const std::set<uint8_t> &vehicle_ids,
+            Buffer &buffer,
+            bool write_to_buffer,
+            bool final_messages_only,
+            bool only_optimal);
+
+    /**
+     * \brief Convert the positions of a received Trajectory into the format of the vehicles buffers
+     * \param sample The received message
+     * \param positions Cleared, then filled with (speed profile index, (edge index, edge path index)) of the points that are not in the past
+     */
+    void get_received_positions(const Trajectory &sample, std::vector<std::pair<size_t, std::pair<size_t, size_t>>> &positions);
+
+    /**
+     * \brief Write the positions of a received Trajectory into the buffer of the sending vehicle, see get_received_positions
+     */
+    void store_received(const Trajectory &sample, std::map<uint8_t, std::vector<std::pair<size_t, std::pair<size_t, size_t>>>> &vehicles_buffer);
+
+    /**
+     * \brief Write the positions of a received VehiclePath into the buffer of the sending vehicle, like for a Trajectory
+     */
+    void store_received(const VehiclePath &sample, std::map<uint8_t, std::vector<std::pair<size_t, std::pair<size_t, size_t>>>> &vehicles_buffer);
+
+    /**
+     * \brief Convert a received Trajectory into the path of the sending vehicle
+     */
+    void store_received(const Trajectory &sample, std::vector<PlannedPath> &vehicle_paths);
+
+    /**
+     * \brief Decode a received VehiclePath directly into the path of the sending vehicle
+     */
+    void store_received(const VehiclePath &sample, std::vector<PlannedPath> &vehicle_paths);
+
+    /**
+     * \brief Returns the path of the vehicle in vehicle_paths, inserted at its sorted position if it is not contained yet
+     */
+    static PlannedPath &get_vehicle_path(std::vector<PlannedPath> &vehicle_paths, uint8_t vehicle_id);
+
     /**
      * \brief Method to read the fcas of all active vehicles which haven't yet planned their path this time step
      *          Returns the winner which can plan now and will be removed from the active set
@@ -206,6 +314,19 @@ class VehicleTrajectoryPlanner
      */
     bool synchronise(std::set<uint8_t> vehicle_ids, bool feasible, uint8_t sync_id);
 
+    /**
+     * \brief True if planning of the current timestep should be aborted, because stop() was called or the round_deadline passed
+     */
+    bool round_aborted() const { return stopFlag || round_timed_out; }
+
+    /**
+     * \brief Block until the reader received new messages, stop() was called or the round_deadline passed
+     * (sets round_timed_out then). Used instead of polling the readers while waiting for other vehicles.
+     * \param reader The reader to wait on
+     */
+    template<typename MessageType>
+    void wait_for_messages(MessageReader<MessageType> &reader);
+
     /**
      * \brief Broadcast our planned trajectory to other HLCs
      * \param is_final When false, message is iterative message, else final
@@ -213,6 +334,11 @@ class VehicleTrajectoryPlanner
      */
     void send_plan_to_hlcs(bool optimal, bool is_final=true, bool has_collisions=false );
 
+    /**
+     * \brief Part of send_plan_to_hlcs if the compact VehiclePath encoding is used, see set_vehicle_path_writer
+     */
+    void send_path_to_hlcs(bool optimal, bool is_final, bool has_collisions);
+
     /**
      * \brief Interpolate between two received trajectory points using fixed velocity
      * \param vehicle_id Which vehicle id these points came from
@@ -241,7 +367,7 @@ class VehicleTrajectoryPlanner
     VehicleCommandTrajectory get_trajectory_command(uint64_t t_now);
 
     /**
-     * \brief Debugging method; writes other_vehicles_buffer to stdout
+     * \brief Debugging method; writes other_vehicle_paths to stdout
      */
     void debug_writeOutReceivedTrajectories();
 
@@ -313,10 +439,22 @@ class VehicleTrajectoryPlanner
 public:
 
     /**
-     * \brief Create a VehicleTrajectoryPlanner
+     * \brief Create a VehicleTrajectoryPlanner, which synchronises with the other planners via DDS
      */
     VehicleTrajectoryPlanner(const PriorityMode _mode, const int _seed);
 
+    /**
+     * \brief Create a VehicleTrajectoryPlanner, which synchronises with the other planners via the given writer and reader
+     * (e.g. of an InMemoryMessageBus)
+     * \param _mode Priority assignment strategy
+     * \param _seed Seed for random priorities
+     * \param _writer_sync Writer to send FallbackSync messages
+     * \param _reader_sync Reader to read FallbackSync messages
+     */
+    VehicleTrajectoryPlanner(const PriorityMode _mode, const int _seed,
+            std::unique_ptr< MessageWriter<FallbackSync> > _writer_sync,
+            std::unique_ptr< MessageReader<FallbackSync> > _reader_sync);
+
     /**
      * \brief Returns started
      */
@@ -345,17 +483,60 @@ public:
      */
     void set_writer(std::unique_ptr< cpm::Writer<Trajectory> > writer);
 
+    /**
+     * \brief Set writer to send planned trajectories
+     * \param writer MessageWriter object
+     */
+    void set_writer(std::unique_ptr< MessageWriter<Trajectory> > writer);
+
     /**
      * \brief Set reader to read planned trajectories
      * \param reader cpm::ReaderAbstract object
      */
     void set_reader(std::unique_ptr< cpm::ReaderAbstract<Trajectory> > reader);
+
+    /**
+     * \brief Set reader to read planned trajectories
+     * \param reader MessageReader object
+     */
+    void set_reader(std::unique_ptr< MessageReader<Trajectory> > reader);
     
+    /**
+     * \brief Set writer to send planned paths in the compact VehiclePath encoding instead of Trajectory messages.
+     * All planners need to use the same encoding.
+     * \param writer cpm::Writer object
+     */
+    void set_vehicle_path_writer(std::unique_ptr< cpm::Writer<VehiclePath> > writer);
+
+    /**
+     * \brief Set writer to send planned paths in the compact VehiclePath encoding instead of Trajectory messages
+     * \param writer MessageWriter object
+     */
+    void set_vehicle_path_writer(std::unique_ptr< MessageWriter<VehiclePath> > writer);
+
+    /**
+     * \brief Set reader to read planned paths in the compact VehiclePath encoding instead of Trajectory messages
+     * \param reader cpm::ReaderAbstract object
+     */
+    void set_vehicle_path_reader(std::unique_ptr< cpm::ReaderAbstract<VehiclePath> > reader);
+
+    /**
+     * \brief Set reader to read planned paths in the compact VehiclePath encoding instead of Trajectory messages
+     * \param reader MessageReader object
+     */
+    void set_vehicle_path_reader(std::unique_ptr< MessageReader<VehiclePath> > reader);
+
     /**
      * \brief Set reader to read planned trajectories
      * \param reader cpm::ReaderAbstract object
      */
     void set_fca_reader(std::unique_ptr< cpm::ReaderAbstract<FutureCollisionAssessment> > reader);
+
+    /**
+     * \brief Set reader to read FutureCollisionAssessments
+     * \param reader MessageReader object
+     */
+    void set_fca_reader(std::unique_ptr< MessageReader<FutureCollisionAssessment> > reader);
     
     /**
      * \brief Set writer to send planned trajectories
@@ -363,6 +544,12 @@ public:
      */
     void set_fca_writer(std::unique_ptr< cpm::Writer<FutureCollisionAssessment> > writer);
 
+    /**
+     * \brief Set writer to send FutureCollisionAssessments
+     * \param writer MessageWriter object
+     */
+    void set_fca_writer(std::unique_ptr< MessageWriter<FutureCollisionAssessment> > writer);
+
     /**
      * \brief Creates a FutureCollisionAssessment message and publishes it.
      * \param 
@@ -375,6 +562,12 @@ public:
      */
     void set_visualization_writer(std::unique_ptr< cpm::Writer<Visualization> > writer);
 
+    /**
+     * \brief Sets the visualisation writer
+     * \param writer MessageWriter object
+     */
+    void set_visualization_writer(std::unique_ptr< MessageWriter<Visualization> > writer);
+
     /**
      * \brief Writes out the info to be displayed by the LCC near the vehicle.
      * \param id the id of the vehicle
@@ -389,6 +582,30 @@ public:
      */
     std::unique_ptr<VehicleCommandTrajectory> plan(uint64_t t_real_time, uint64_t dt);
 
+    /**
+     * \brief Set the maximum time to wait for other vehicles in one planning round
+     * \param timeout_nanos Timeout in nanoseconds, 0 (default) to use the length of the timestep
+     */
+    void set_round_timeout(uint64_t timeout_nanos) { round_timeout_nanos = timeout_nanos; }
+
+    /**
+     * \brief Set whether set_vehicle opens the evaluation file evaluation_<vehicle id>.csv (default: true).
+     * Must be called before set_vehicle.
+     * \param enabled False to not write the evaluation file
+     */
+    void set_write_evaluation_file(bool enabled) { write_evaluation_file = enabled; }
+
+    /**
+     * \brief Set whether plan() computes the paths of the step statistics (default: false)
+     * \param enabled True to compute the paths
+     */
+    void set_collect_statistics(bool enabled) { collect_statistics = enabled; }
+
+    /**
+     * \brief Outcome of the last call of plan()
+     */
+    const PlanningStepStatistics& get_step_statistics() const { return step_statistics; }
+
     /**
      * \brief Stop planning of this timestep, even if we aren't finished
      */
@@ -27,6 +27,7 @@
 #include "VehicleTrajectoryPlanningState.hpp" //sw folder central routing
 
 #include "lane_graph_tools.hpp" //sw folder distributed routing
+#include <algorithm>
 #include <string>
 #include <iostream>
 #include <math.h>       /* ceil */
@@ -124,6 +125,16 @@ void VehicleTrajectoryPlanningState::apply_timestep()
     t_elapsed += dt_nanos;
 }
 
+double VehicleTrajectoryPlanningState::get_timestep_mean_speed() const
+{
+    double sum_speed = 0;
+    for (size_t i = 0; i < n_steps; ++i)
+    {
+        sum_speed += speed_profile[i];
+    }
+    return sum_speed / n_steps;
+}
+
 void VehicleTrajectoryPlanningState::extend_random_route(size_t n)
 {
     invariant();
@@ -171,19 +182,21 @@ TrajectoryPoint VehicleTrajectoryPlanningState::get_trajectory_point(
 }
 
 // returns the delta to previous fca
-uint16_t VehicleTrajectoryPlanningState::update_potential_collisions(std::map<uint8_t, std::vector<std::pair<size_t, std::pair<size_t, size_t>>>> &other_vehicles, uint8_t winner, uint16_t old_fca)
+uint16_t VehicleTrajectoryPlanningState::update_potential_collisions(const PlannedPath &winner_path, uint16_t old_fca)
 {
-    std::map<uint8_t, std::vector<std::pair<size_t, std::pair<size_t, size_t>>>> m={{winner, other_vehicles[winner]}};
     uint16_t prev_collisions = 0;
     for (auto pair : collisions_with_opt_traj)
     {
-        if (pair.first == winner)
+        if (pair.first == winner_path.vehicle_id)
         {
             prev_collisions = pair.second;
         }
     }
 
-    uint16_t collisions_with_winner = potential_collisions(m, true);
+    // Only the winner's trajectory changed
+    other_paths.assign(1, winner_path);
+
+    uint16_t collisions_with_winner = count_potential_collisions(true);
     return old_fca + (collisions_with_winner - prev_collisions);
 }
 
@@ -192,15 +205,16 @@ uint16_t VehicleTrajectoryPlanningState::update_potential_collisions(std::map<ui
  *  known trajectories
  *  Future Collision Assessment (based on Luo et al. 2016)  
  */
-uint16_t VehicleTrajectoryPlanningState::potential_collisions(std::map<uint8_t, std::vector<std::pair<size_t, std::pair<size_t, size_t>>>> &other_vehicles, bool optimal){
-    vector<std::pair<size_t, size_t>> self_path;
-    if(!optimal){
-        self_path = get_planned_path(false);
-    }
-    else
-    {
-        self_path = get_planned_path(true);
-    }
+uint16_t VehicleTrajectoryPlanningState::potential_collisions(const vector<PlannedPath> &other_vehicle_paths, bool optimal){
+    other_paths.assign(other_vehicle_paths.begin(), other_vehicle_paths.end());
+    return count_potential_collisions(optimal);
+}
+
+uint16_t VehicleTrajectoryPlanningState::count_potential_collisions(bool optimal)
+{
+    compute_planned_path(optimal, self_path);
+    const EdgePathCollisionTable &edge_path_collisions = laneGraphTools.edge_path_collisions;
+
     uint16_t sum_collisions = 0;
     uint16_t collisions_with_vehicle = 0;
 
@@ -210,40 +224,26 @@ uint16_t VehicleTrajectoryPlanningState::potential_collisions(std::map<uint8_t,
 
     std::cout << "potential collisions: ";
     // Find the earliest collision
-    for( auto iter = other_vehicles.begin(); iter != other_vehicles.end(); ++iter ){
-        std::vector<std::pair<size_t, std::pair<size_t, size_t>>> other_path = iter->second;
+    for (const PlannedPath &other_path : other_paths)
+    {
         last_collision = 0;
 
-        if (iter->first == vehicle_id) { continue; }
-        
+        if (other_path.vehicle_id == vehicle_id) { continue; }
 
         for (size_t i = 0; i < N_STEPS_SPEED_PROFILE; ++i)
         {   
             // It's possible that we don't have data for this index
             // We will skip it, which is unsafe, but our only option right now
-            try {
-                if( other_path.at(i).first != i ) { 
-                    std::cout << "other_path.at(i).first is: "
-                                << other_path.at(i).first 
-                                << "and i is"
-                                << i
-                                << std::endl;
-                    continue; }
-            } catch (std::out_of_range const& exc) {
-                continue;
-            }
+            const uint32_t other_point = other_path.point_indices[i];
+            if (other_point == PlannedPath::no_point) { continue; }
 
-            if(laneGraphTools.edge_path_collisions
-                [self_path[i].first]
-                [self_path[i].second]
-                [other_path[i].second.first]
-                [other_path[i].second.second])
+            if (edge_path_collisions(self_path.point_indices[i], other_point))
             {
                 // check wether it's still the "same" collision
                 if (last_collision == 0 || last_collision + damping_window < i)
                 {
                      ++collisions_with_vehicle;
-                     std::cout << "t:" << i << "v:" << (int) iter->first << ";";
+                     std::cout << "t:" << i << "v:" << (int) other_path.vehicle_id << ";";
                     
                 }
                 last_collision = i;
@@ -253,7 +253,7 @@ uint16_t VehicleTrajectoryPlanningState::potential_collisions(std::map<uint8_t,
         
         if (optimal)
         {
-            collisions_with_opt_traj.push_back(std::make_pair(iter->first, collisions_with_vehicle));
+            collisions_with_opt_traj.push_back(std::make_pair(other_path.vehicle_id, collisions_with_vehicle));
         }
         collisions_with_vehicle = 0;
     }
@@ -267,22 +267,36 @@ uint16_t VehicleTrajectoryPlanningState::potential_collisions(std::map<uint8_t,
 // Change the own speed profile so as not to collide with the other_vehicles.
 // other_vehicles may only contain vehicles with a higher priority
 bool VehicleTrajectoryPlanningState::avoid_collisions(
-    std::map<uint8_t, std::vector<std::pair<size_t, std::pair<size_t, size_t>>>> other_vehicles
+    const std::map<uint8_t, std::vector<std::pair<size_t, std::pair<size_t, size_t>>>> &other_vehicles
 )
+{
+    // The paths of the other vehicles do not change while we adapt our speed profile
+    load_other_paths(other_vehicles);
+    return avoid_collisions_with_other_paths();
+}
+
+bool VehicleTrajectoryPlanningState::avoid_collisions(const vector<PlannedPath> &other_vehicle_paths)
+{
+    other_paths.assign(other_vehicle_paths.begin(), other_vehicle_paths.end());
+    return avoid_collisions_with_other_paths();
+}
+
+bool VehicleTrajectoryPlanningState::avoid_collisions_with_other_paths()
 {
     int min_idx_zero_speed = std::max<int>(
         n_steps,
         static_cast<int>(n_steps-1 + ceil(speed_profile[n_steps-1] / delta_v_step))
     );
 
+    const EdgePathCollisionTable &edge_path_collisions = laneGraphTools.edge_path_collisions;
+
     bool are_collisions_avoidable = true;
     bool is_collision_free = false;
+    int n_speed_reductions = 0;
     while(!is_collision_free && are_collisions_avoidable)
     {
-        vector<std::pair<size_t, size_t>> self_path = get_planned_path(false);
+        compute_planned_path(false, self_path);
 
-        //cpm::Logging::Instance().write(1,
-        //        "Loopy");
         // An index exceeding N_STEPS_SPEED_PROFILE indicates that there is no collision
         size_t earliest_collision__speed_profile_index = 1<<30;
         int colliding_vehicle_id = 0;
@@ -290,36 +304,24 @@ bool VehicleTrajectoryPlanningState::avoid_collisions(
 
         // Find the earliest collision 
         // with previous planned vehicles
-        for( auto iter = other_vehicles.begin(); iter != other_vehicles.end(); ++iter ){
-            std::vector<std::pair<size_t, std::pair<size_t, size_t>>> other_path = iter->second;
+        for (const PlannedPath &other_path : other_paths)
+        {
+            // Collisions after the earliest one found so far do not matter
+            const size_t n_checked_steps = std::min<size_t>(earliest_collision__speed_profile_index, N_STEPS_SPEED_PROFILE);
 
-            for (size_t i = 0; i < N_STEPS_SPEED_PROFILE; ++i)
+            for (size_t i = 0; i < n_checked_steps; ++i)
             {
                 // It's possible that we don't have data for this index
                 // We will skip it, which is unsafe, but our only option right now
-                try {
-                    if( other_path.at(i).first != i ) { 
-                        std::cout << "no data for index: " << i << std::endl;
-                        continue; }
-                } catch (std::out_of_range const& exc) {
-                    continue;
-                }
-                
+                const uint32_t other_point = other_path.point_indices[i];
+                if (other_point == PlannedPath::no_point) { continue; }
 
-                if(laneGraphTools.edge_path_collisions
-                    [self_path[i].first]
-                    [self_path[i].second]
-                    [other_path[i].second.first]
-                    [other_path[i].second.second])
+                if (edge_path_collisions(self_path.point_indices[i], other_point))
                 {
-                    // collision detected
-                    if(i < earliest_collision__speed_profile_index)
-                    {
-                        earliest_collision__speed_profile_index = i;
-                        colliding_vehicle_id = iter->first;
-                        time_of_collision = i;
-                    }
-                    // earliest collision for this vehicle found, stop
+                    // collision detected, earliest collision for this vehicle found, stop
+                    earliest_collision__speed_profile_index = i;
+                    colliding_vehicle_id = other_path.vehicle_id;
+                    time_of_collision = i;
                     break;
                 }
             }
@@ -331,11 +333,6 @@ bool VehicleTrajectoryPlanningState::avoid_collisions(
             break;
         }
 
-
-        cpm::Logging::Instance().write(2,
-                "Detected potential collision; avoiding"
-        );
-
         // fix speed profile to avoid collision,
         // beginning from 10 steps before the collision
         // TODO: Change magic numbers to named parameters/constants
@@ -352,24 +349,15 @@ bool VehicleTrajectoryPlanningState::avoid_collisions(
         if (idx_speed_reduction < min_idx_zero_speed 
             && speed_profile[min_idx_zero_speed] > min_speed + 0.05)
         {
-            std::cout << "trying to reduce speed at beginning, idx: " << idx_speed_reduction << std::endl;
-            std::cout << "speed at minidx: " << std::setw(4) << speed_profile[min_idx_zero_speed]
-            << " larger than min speed " << min_speed + 0.05 <<std::endl;
-            std::cout << "setting idx to " << min_idx_zero_speed <<std::endl;
+            // Reduce the speed at the beginning
             idx_speed_reduction = min_idx_zero_speed;
         }
 
         if(idx_speed_reduction >= min_idx_zero_speed)
         {
             const double reduced_speed = fmax(speed_profile[idx_speed_reduction] - 0.3, min_speed);
-            std::cout << 
-                "Collision detected t: " << std::setw(4) << earliest_collision__speed_profile_index << 
-                "  self id: " << std::setw(2)  << int(vehicle_id) << 
-                "  other id: " << std::setw(2)  << colliding_vehicle_id << 
-                "  Speed reduction,  t: " << std::setw(4) << idx_speed_reduction  << 
-                "  cur spd: " << std::setw(4) << speed_profile[idx_speed_reduction]  << 
-                "  red spd: " << reduced_speed << std::endl;
             set_speed(idx_speed_reduction, reduced_speed);
+            ++n_speed_reductions;
         }
         else
         {
@@ -382,6 +370,14 @@ bool VehicleTrajectoryPlanningState::avoid_collisions(
             are_collisions_avoidable = false;
         }
     }
+
+    // Printing every detected collision takes longer than detecting it, so only a summary is printed
+    if (n_speed_reductions > 0)
+    {
+        std::cout << "Vehicle " << int(vehicle_id) << ": reduced speed " << n_speed_reductions
+            << " times to avoid potential collisions" << std::endl;
+    }
+
     // assert we haven't changed current timestep
     for (size_t i = 0; i < n_steps; i++)
     {
@@ -495,6 +491,149 @@ vector<std::pair<size_t, size_t>> VehicleTrajectoryPlanningState::get_planned_pa
     return result;
 }
 
+void VehicleTrajectoryPlanningState::compute_planned_path(bool optimal, PlannedPath &path_out)
+{
+    const EdgePathCollisionTable &edge_path_collisions = laneGraphTools.edge_path_collisions;
+    path_out.vehicle_id = vehicle_id;
+
+    size_t future_edge_index = current_edge_index;
+    size_t future_edge_path_index = current_edge_path_index;
+    size_t route_index = 0;
+    double delta_s = delta_s_path_node_offset;
+    array<double, N_STEPS_SPEED_PROFILE> cur_speed_profile = speed_profile;
+    if (optimal) {reset_speed_profile(cur_speed_profile);};
+
+    for (size_t i = 0; i < N_STEPS_SPEED_PROFILE; ++i)
+    {
+        delta_s += cur_speed_profile[i] * dt_speed_profile;
+
+        laneGraphTools.move_along_route
+        (
+            current_route_edge_indices,
+            route_index, 
+            future_edge_index, 
+            future_edge_path_index, 
+            delta_s
+        );
+
+        path_out.point_indices[i] = static_cast<uint32_t>(
+            edge_path_collisions.get_point_index(future_edge_index, future_edge_path_index));
+    }
+}
+
+void VehicleTrajectoryPlanningState::load_other_path(
+    uint8_t other_vehicle_id,
+    const std::vector<std::pair<size_t, std::pair<size_t, size_t>>> &trajectory,
+    PlannedPath &path_out)
+{
+    const EdgePathCollisionTable &edge_path_collisions = laneGraphTools.edge_path_collisions;
+    path_out.vehicle_id = other_vehicle_id;
+
+    for (size_t i = 0; i < N_STEPS_SPEED_PROFILE; ++i)
+    {
+        // The entry for step i is only at position i if the trajectory contains all previous steps
+        if (i < trajectory.size() && trajectory[i].first == i)
+        {
+            path_out.point_indices[i] = static_cast<uint32_t>(
+                edge_path_collisions.get_point_index(trajectory[i].second.first, trajectory[i].second.second));
+        }
+        else
+        {
+            path_out.point_indices[i] = PlannedPath::no_point;
+        }
+    }
+}
+
+bool VehicleTrajectoryPlanningState::load_other_path(const VehiclePath &vehicle_path, uint64_t t_real_time, PlannedPath &path_out)
+{
+    const EdgePathCollisionTable &edge_path_collisions = laneGraphTools.edge_path_collisions;
+    path_out.vehicle_id = vehicle_path.vehicle_id();
+    path_out.point_indices.fill(PlannedPath::no_point);
+
+    // Speed profile step of the first point, negative if the path started before the current step
+    const long long first_step =
+        (static_cast<long long>(vehicle_path.start_time().nanoseconds()) - static_cast<long long>(t_real_time))
+        / static_cast<long long>(dt_speed_profile_nanos);
+
+    const auto &advances = vehicle_path.edge_path_advances();
+    size_t point = 0;
+    for (const EdgeRun &run : vehicle_path.edge_runs())
+    {
+        if (run.edge_index() >= laneGraphTools.n_edges || point + run.length() > advances.size())
+        {
+            path_out.point_indices.fill(PlannedPath::no_point);
+            return false;
+        }
+
+        size_t edge_path_index = run.start_edge_path_index();
+        for (size_t i = 0; i < run.length(); ++i, ++point)
+        {
+            if (i > 0) edge_path_index += advances[point];
+            if (edge_path_index >= laneGraphTools.n_edge_path_nodes)
+            {
+                path_out.point_indices.fill(PlannedPath::no_point);
+                return false;
+            }
+
+            const long long step = first_step + static_cast<long long>(point);
+            if (step >= 0 && step < N_STEPS_SPEED_PROFILE)
+            {
+                path_out.point_indices[step] = static_cast<uint32_t>(
+                    edge_path_collisions.get_point_index(run.edge_index(), edge_path_index));
+            }
+        }
+    }
+    return point == advances.size();
+}
+
+bool VehicleTrajectoryPlanningState::get_received_positions(
+    const VehiclePath &vehicle_path,
+    uint64_t t_real_time,
+    std::vector<std::pair<size_t, std::pair<size_t, size_t>>> &positions_out)
+{
+    positions_out.clear();
+
+    const long long first_step =
+        (static_cast<long long>(vehicle_path.start_time().nanoseconds()) - static_cast<long long>(t_real_time))
+        / static_cast<long long>(dt_speed_profile_nanos);
+
+    const auto &advances = vehicle_path.edge_path_advances();
+    size_t point = 0;
+    for (const EdgeRun &run : vehicle_path.edge_runs())
+    {
+        if (point + run.length() > advances.size())
+        {
+            return false;
+        }
+
+        size_t edge_path_index = run.start_edge_path_index();
+        for (size_t i = 0; i < run.length(); ++i, ++point)
+        {
+            if (i > 0) edge_path_index += advances[point];
+
+            // Points in the past are not needed, like in read_vehicles
+            const long long step = first_step + static_cast<long long>(point);
+            if (step >= 0)
+            {
+                positions_out.push_back(std::make_pair(step, std::make_pair(run.edge_index(), edge_path_index)));
+            }
+        }
+    }
+    return point == advances.size();
+}
+
+void VehicleTrajectoryPlanningState::load_other_paths(
+    const std::map<uint8_t, std::vector<std::pair<size_t, std::pair<size_t, size_t>>>> &other_vehicles)
+{
+    other_paths.resize(other_vehicles.size());
+    size_t path_index = 0;
+    for (const auto &other_vehicle : other_vehicles)
+    {
+        load_other_path(other_vehicle.first, other_vehicle.second, other_paths[path_index]);
+        ++path_index;
+    }
+}
+
 vector<TrajectoryPoint> VehicleTrajectoryPlanningState::get_planned_trajectory(int max_length) {
     vector<TrajectoryPoint> result;
     uint index = 0;
@@ -541,6 +680,43 @@ void VehicleTrajectoryPlanningState::get_lane_graph_positions(
     );
 }
 
+void VehicleTrajectoryPlanningState::get_vehicle_path(VehiclePath &vehicle_path, bool optimal)
+{
+    PlannedPath path;
+    compute_planned_path(optimal, path);
+    const size_t n_edge_path_nodes = laneGraphTools.n_edge_path_nodes;
+
+    vehicle_path.vehicle_id(vehicle_id);
+    auto &edge_runs = vehicle_path.edge_runs();
+    auto &advances = vehicle_path.edge_path_advances();
+    edge_runs.clear();
+    advances.clear();
+    advances.reserve(N_STEPS_SPEED_PROFILE);
+
+    size_t previous_edge_path_index = 0;
+    for (size_t i = 0; i < N_STEPS_SPEED_PROFILE; ++i)
+    {
+        const size_t edge_index = path.point_indices[i] / n_edge_path_nodes;
+        const size_t edge_path_index = path.point_indices[i] % n_edge_path_nodes;
+
+        // A new run starts on the next edge, or if the path returns to the start of the same edge
+        if (edge_runs.empty()
+            || edge_runs.back().edge_index() != edge_index
+            || edge_path_index < previous_edge_path_index
+            || edge_path_index - previous_edge_path_index > UINT8_MAX)
+        {
+            edge_runs.push_back(EdgeRun(edge_index, edge_path_index, 0));
+            advances.push_back(0);
+        }
+        else
+        {
+            advances.push_back(static_cast<uint8_t>(edge_path_index - previous_edge_path_index));
+        }
+        edge_runs.back().length(edge_runs.back().length() + 1);
+        previous_edge_path_index = edge_path_index;
+    }
+}
+
 std::pair<double, double> VehicleTrajectoryPlanningState::get_position(){
     return std::make_pair (laneGraphTools.edges_x.at(current_edge_index).at(current_edge_path_index), laneGraphTools.edges_y.at(current_edge_index).at(current_edge_path_index));
 } 
@@ -571,101 +747,134 @@ std::vector<std::pair<int, std::vector<int>>> VehicleTrajectoryPlanningState::co
     
     std::vector<std::pair<int, std::vector<int>>> graph;
 
+    // Adjacency bitset of each node and its position in graph, so that nodes and edges are found without searching graph
+    const size_t n_nodes = laneGraphTools.n_edges;
+    const size_t n_row_words = (n_nodes + 63) / 64;
+    std::vector<uint64_t> adjacency(n_nodes * n_row_words, 0);
+    std::vector<int> graph_index(n_nodes, -1);
+
     // vehicles_buffer contains the optimal trajectories
     // encoded as (timestep, node, edge_node)
     // we need to extract the nodes and resulting edges (discarding edge_nodes)
-    for (auto vehicle : vehicles_buffer)
+    for (const auto &vehicle : vehicles_buffer)
     {
-        std::vector<std::pair<size_t, std::pair<size_t, size_t>>> path = vehicle.second;
-        for (size_t i=0; i < path.size()-1; i++) //we could use bigger steps
+        const std::vector<std::pair<size_t, std::pair<size_t, size_t>>> &path = vehicle.second;
+        for (size_t i=0; i + 1 < path.size(); i++) //we could use bigger steps
         {
-            int v_1 = path.at(i).second.first;
-            int v_2 = path.at(i+1).second.first;
+            size_t v_1 = path[i].second.first;
+            size_t v_2 = path[i+1].second.first;
             if (v_1 == v_2)
             {
                 continue;
             }
-            
-            bool found = false;
-            for (auto &v_i : graph)
+
+            uint64_t &word = adjacency.at(v_1 * n_row_words + (v_2 >> 6));
+            const uint64_t bit = 1ull << (v_2 & 63);
+            if (word & bit)
             {
-                if (v_i.first == v_1)
-                {
-                    found = true;
-                    auto index = std::find(v_i.second.begin(), v_i.second.end(), v_2);
-                    if (index == v_i.second.end())
-                    {
-                        v_i.second.push_back(v_2);
-                    }
-                    break;
-                }
+                continue;
             }
-            if (!found)
+            word |= bit;
+
+            if (graph_index[v_1] < 0)
             {
-                graph.push_back(std::make_pair(v_1, std::vector<int>{v_2}));
+                graph_index[v_1] = static_cast<int>(graph.size());
+                graph.push_back(std::make_pair(static_cast<int>(v_1), std::vector<int>()));
             }
+            graph[graph_index[v_1]].second.push_back(static_cast<int>(v_2));
         }
         
     }
     return graph;
 }
 
-// TODO: implement here: (1) compute minimum wdfvs and (2) topological ordering
-std::vector<uint8_t> VehicleTrajectoryPlanningState::compute_graph_based_priorities(std::map<uint8_t, std::vector<std::pair<size_t, std::pair<size_t, size_t>>>> &vehicles_buffer)
+void VehicleTrajectoryPlanningState::get_edge_transitions(const std::vector<std::pair<size_t, std::pair<size_t, size_t>>> &path, vector<EdgeTransition> &out_transitions)
 {
-
-    std::cout << "graph: " ;
-    std::vector<std::pair<int, std::vector<int>>> graph = compute_path_induced_subgraph(vehicles_buffer);
-    for (auto v1 : graph)
+    out_transitions.clear();
+    for (size_t i = 0; i + 1 < path.size(); i++)
     {
-        std::cout << "(" << v1.first << ":";
-        for (auto v2 : v1.second)
+        const int v_1 = static_cast<int>(path[i].second.first);
+        const int v_2 = static_cast<int>(path[i+1].second.first);
+        if (v_1 != v_2)
         {
-            std::cout << v2  << ","; 
+            out_transitions.push_back({static_cast<int>(i), v_1, v_2});
         }
-        std::cout << "),";
-        
     }
-    std::cout << "\n";
-    for (auto v1 : graph)
+}
+
+// TODO: implement here: (1) compute minimum wdfvs and (2) topological ordering
+std::vector<uint8_t> VehicleTrajectoryPlanningState::compute_graph_based_priorities(std::map<uint8_t, std::vector<std::pair<size_t, std::pair<size_t, size_t>>>> &vehicles_buffer)
+{
+    // Compare the edge transitions of each vehicle to the last call, to find the first vehicle from which the ordering changes
+    const size_t n_cached = graph_priority_cache.size();
+    size_t first_changed = std::min(n_cached, vehicles_buffer.size());
+    graph_priority_cache.resize(vehicles_buffer.size());
+    size_t k = 0;
+    for (const auto &vehicle : vehicles_buffer)
     {
-        for (auto v2 : v1.second)
+        GraphPriorityCacheEntry &entry = graph_priority_cache[k];
+        get_edge_transitions(vehicle.second, received_transitions);
+        const int first_edge = vehicle.second.empty() ? -1 : static_cast<int>(vehicle.second.front().second.first);
+
+        if (k >= n_cached
+            || entry.vehicle_id != vehicle.first
+            || entry.first_edge != first_edge
+            || entry.transitions != received_transitions)
         {
-            std::cout  << "(" << v1.first << ", " << v2  << ") ,"; 
+            first_changed = std::min(first_changed, k);
+            entry.vehicle_id = vehicle.first;
+            entry.first_edge = first_edge;
+            std::swap(entry.transitions, received_transitions);
         }
+        ++k;
+    }
+
+    if (n_cached == vehicles_buffer.size() && first_changed == n_cached)
+    {
+        return graph_based_priorities;
     }
-    std::cout << "\n";
 
-    // order function for each node (node, value, t_v) ... (n, v, t_v):
-    std::vector<std::tuple<int, int, int>> order;
-    for (auto vehicle : vehicles_buffer)
+    // order function for each node (node, value, t_v) ... (n, v, t_v), continued from the ordering of the last unchanged vehicle
+    const size_t n_nodes = laneGraphTools.n_edges;
+    for (k = first_changed; k < graph_priority_cache.size(); ++k)
     {
-        std::vector<std::pair<size_t, std::pair<size_t, size_t>>> path = vehicle.second;
-        for (int i=0; i < ((int)path.size())-1; i++)
+        VertexOrdering &order = graph_priority_cache[k].ordering;
+        if (k == 0)
         {
-            int v_1 = path.at(i).second.first;
-            int v_2 = path.at(i+1).second.first;
-            if (v_1 == v_2)
-            {
-                continue;
-            }
-            
-            auto idx_v1 = std::find_if( order.begin(), order.end(),
-                            [&v_1](const std::tuple<int, int, int>& element){ return std::get<0>(element) == v_1;} );
-            auto idx_v2 = std::find_if( order.begin(), order.end(),
-                            [&v_2](const std::tuple<int, int, int>& element){ return std::get<0>(element) == v_2;} );
+            order.is_ordered.assign(n_nodes, 0);
+            order.value.assign(n_nodes, 0);
+            order.path_index.assign(n_nodes, 0);
+        }
+        else
+        {
+            order = graph_priority_cache[k-1].ordering;
+        }
+
+        for (const EdgeTransition &transition : graph_priority_cache[k].transitions)
+        {
+            const int i = transition.path_index;
+            const size_t v_1 = transition.from_edge;
+            const size_t v_2 = transition.to_edge;
+            const bool is_ordered_v1 = order.is_ordered.at(v_1);
+            const bool is_ordered_v2 = order.is_ordered.at(v_2);
 
-            if (idx_v1 == order.end() && idx_v2 == order.end())
+            if (!is_ordered_v1 && !is_ordered_v2)
             {
-                order.push_back(std::make_tuple(v_1, 1, i));
+                order.is_ordered[v_1] = 1;
+                order.value[v_1] = 1;
+                order.path_index[v_1] = i;
             } 
-            else if (idx_v1 == order.end() && idx_v2 != order.end())
+            else if (!is_ordered_v1 && is_ordered_v2)
             {
-                order.push_back(std::make_tuple(v_1, std::get<1>(*idx_v2) - 1, i));
+                order.is_ordered[v_1] = 1;
+                order.value[v_1] = order.value[v_2] - 1;
+                order.path_index[v_1] = i;
             } 
-            else if (idx_v1 != order.end() && idx_v2 == order.end())
+            else if (is_ordered_v1 && !is_ordered_v2)
             {
-                order.push_back(std::make_tuple(v_2, std::get<1>(*idx_v1) + 1, i));
+                order.is_ordered[v_2] = 1;
+                order.value[v_2] = order.value[v_1] + 1;
+                order.path_index[v_2] = i;
             } 
             else // we might want to employ some smart decisions here to avoid conflicts early in the path of a vehicle 
             {
@@ -674,50 +883,27 @@ std::vector<uint8_t> VehicleTrajectoryPlanningState::compute_graph_based_priorit
                 // 3
                 // t_v <= i-3 kein update
 
-                if (i < std::get<2>(*idx_v2) + 3)// std::get<2>(*idx_v1))
+                if (i < order.path_index[v_2] + 3)
                 {
-                        std::get<1>(*idx_v2) = std::get<1>(*idx_v1) + 1;
-                        std::get<2>(*idx_v2) = i;
+                        order.value[v_2] = order.value[v_1] + 1;
+                        order.path_index[v_2] = i;
                 }
             }
         }
     }
 
-    std::cout << "order";
-    std::cout << "{";
-    for (auto pi_i : order)
-    {
-        std::cout << std::get<0>(pi_i) << ":" << std::get<1>(pi_i) << ",";
-    }
-    std::cout << "}";
-    std::cout << "\n";
-
-    // planning order: (pi(id_1), ..., pi(id_n))
+    // planning order: (pi(id_1), ..., pi(id_n)), where pi(id) is the value of the vertex the vehicle is currently on.
+    // The vertex of a vehicle without edge transitions might not be ordered, it gets the value 0 then.
     std::vector<std::pair<uint8_t, int>> pi_vec;
-    int own_pi = 0;
-    for (auto& vehicle : vehicles_buffer)
+    for (const GraphPriorityCacheEntry &entry : graph_priority_cache)
     {
-        // path of vehicle
-        std::vector<std::pair<size_t, std::pair<size_t, size_t>>> path = vehicle.second;
-        // vehicle is currently on vertex:
-        int v_1 = path.at(0).second.first;
-        // find vertex
-        auto idx_v1 = std::find_if( order.begin(), order.end(),
-                            [&v_1](const std::tuple<int, int, int>& element){ return std::get<0>(element) == v_1;});
-        // get vertex value: pi(v_1)
-        if (vehicle_id == vehicle.first)
-        {
-            own_pi = std::get<1>(*idx_v1);
-        }
-        
-        if (!pi_vec.empty() && own_pi < std::get<1>(*idx_v1))
+        const VertexOrdering &order = graph_priority_cache.back().ordering;
+        int pi = 0;
+        if (entry.first_edge >= 0 && order.is_ordered.at(entry.first_edge))
         {
-            pi_vec.insert(pi_vec.begin(), std::make_pair(vehicle.first, std::get<1>(*idx_v1)));
-        }
-        else
-        {
-            pi_vec.emplace_back(std::make_pair(vehicle.first, std::get<1>(*idx_v1)));
+            pi = order.value[entry.first_edge];
         }
+        pi_vec.emplace_back(std::make_pair(entry.vehicle_id, pi));
     }
 
     // define consistent sorting of vehicles pi(v1)>pi(v_2) <=> a > b
@@ -725,18 +911,11 @@ std::vector<uint8_t> VehicleTrajectoryPlanningState::compute_graph_based_priorit
         return a.second > b.second || (a.second == b.second && a.first > b.first);
     });
 
-    std::cout << "graph based prios: ";
-    for (auto pi_n:pi_vec)
-    {
-        std::cout << (int)pi_n.first << ":" << pi_n.second << ",";
-    }
-    std::cout << std::endl;
-
-    std::vector<uint8_t> prio_vec;
+    graph_based_priorities.clear();
     for (auto pi_n:pi_vec)
     {
-        prio_vec.emplace_back(pi_n.first);
+        graph_based_priorities.emplace_back(pi_n.first);
     }
-    return prio_vec;
+    return graph_based_priorities;
     
-}
\ No newline at end of file
+}
@@ -30,10 +30,12 @@
 #include <array>
 #include <utility>
 #include <cstdint>
+#include <map>
 #include <random>
 #include "cpm/Logging.hpp"
 #include "VehicleCommandTrajectory.hpp"
 #include "Trajectory.hpp"
+#include "VehiclePath.hpp"
 
 using std::vector;
 using std::array;
@@ -41,6 +43,21 @@ using std::array;
 //TODO: Replace this with a proper variable
 #define N_STEPS_SPEED_PROFILE (200)
 
+/**
+ * \struct PlannedPath
+ * \brief Points of the lane graph (see EdgePathCollisionTable::get_point_index) that a vehicle passes, one per speed profile step.
+ * Has a fixed size, s.t. paths can be recomputed while planning without allocations.
+ * \ingroup distributed_routing
+ */
+struct PlannedPath
+{
+    //! Marks steps for which the point is not known, e.g. because a received trajectory does not contain it
+    static constexpr uint32_t no_point = UINT32_MAX;
+    //! Id of the vehicle the path belongs to
+    uint8_t vehicle_id = 0;
+    //! Point index for each speed profile step
+    array<uint32_t, N_STEPS_SPEED_PROFILE> point_indices;
+};
 
 /**
  * \class VehicleTrajectoryPlanningState
@@ -83,9 +100,77 @@ class VehicleTrajectoryPlanningState
     //! Pointer to real time
     uint64_t* t_real_time;
 
+    //! Own path, recomputed in each iteration of avoid_collisions; a member to avoid allocations
+    PlannedPath self_path;
+    //! Paths of the other vehicles; converted once per call of avoid_collisions / potential_collisions, keeps its capacity between calls
+    vector<PlannedPath> other_paths;
+
     //! Save collisions with other vehicles optimal trajectories for efficient fca update when the winner planned
     std::vector<std::pair<uint8_t, uint16_t>> collisions_with_opt_traj;
 
+    /**
+     * \struct EdgeTransition
+     * \brief Change of the edge between two consecutive points of a path, an edge of the path-induced subgraph
+     */
+    struct EdgeTransition
+    {
+        //! Index of the point before the transition in the path
+        int path_index;
+        //! Edge index before the transition
+        int from_edge;
+        //! Edge index after the transition
+        int to_edge;
+
+        bool operator==(const EdgeTransition &other) const
+        {
+            return path_index == other.path_index && from_edge == other.from_edge && to_edge == other.to_edge;
+        }
+    };
+
+    /**
+     * \struct VertexOrdering
+     * \brief Order function of the lane graph edges, see compute_graph_based_priorities. Indexed by edge index.
+     */
+    struct VertexOrdering
+    {
+        //! Whether the edge got a value yet
+        vector<char> is_ordered;
+        //! Value pi(v) of the edge
+        vector<int> value;
+        //! Path index of the transition that set the value
+        vector<int> path_index;
+    };
+
+    /**
+     * \struct GraphPriorityCacheEntry
+     * \brief What compute_graph_based_priorities derived from the path of one vehicle in its last call
+     */
+    struct GraphPriorityCacheEntry
+    {
+        //! Id of the vehicle
+        uint8_t vehicle_id = 0;
+        //! Edge of the first point of the path, -1 if the path is empty
+        int first_edge = -1;
+        //! Edge transitions of the path, in order
+        vector<EdgeTransition> transitions;
+        //! Ordering after the transitions of this vehicle and all vehicles before it were applied
+        VertexOrdering ordering;
+    };
+
+    //! One entry per vehicle of the last call of compute_graph_based_priorities, in the order of the buffer
+    vector<GraphPriorityCacheEntry> graph_priority_cache;
+    //! Result of the last call of compute_graph_based_priorities
+    std::vector<uint8_t> graph_based_priorities;
+    //! Transitions of a received path; a member to avoid allocations
+    vector<EdgeTransition> received_transitions;
+
+    /**
+     * \brief Extract the edge transitions of a path
+     * \param path Path as received, see VehicleTrajectoryPlanner::read_vehicles
+     * \param out_transitions Cleared, then filled with the transitions
+     */
+    static void get_edge_transitions(const std::vector<std::pair<size_t, std::pair<size_t, size_t>>> &path, vector<EdgeTransition> &out_transitions);
+
     //! Pseudorandom sequence generator for random priorities
     std::mt19937 random_gen;
     //! Uniform distribution
@@ -113,6 +198,23 @@ class VehicleTrajectoryPlanningState
      */
     vector<std::pair<size_t, size_t>> get_planned_path(bool optimal);
 
+    /**
+     * \brief Convert all received trajectories into other_paths, in the order of the vehicle ids
+     * \param other_vehicles Received trajectories per vehicle id
+     */
+    void load_other_paths(const std::map<uint8_t, std::vector<std::pair<size_t, std::pair<size_t, size_t>>>> &other_vehicles);
+
+    /**
+     * \brief Shared part of both avoid_collisions variants, after the paths of the other vehicles were written to other_paths
+     */
+    bool avoid_collisions_with_other_paths();
+
+    /**
+     * \brief Count the potential collisions of the own path with other_paths, see potential_collisions
+     * \param optimal Use the optimal speed profile instead of the current one
+     */
+    uint16_t count_potential_collisions(bool optimal);
+
     /**
      * \brief Set speed at index, and adjust the previous/following speeds as well
      * \param idx_speed_reduction Index of where we want to set the speed
@@ -141,6 +243,50 @@ public:
      */
     void get_lane_graph_positions(Trajectory &lane_graph_trajectory, bool optimal);
 
+    /**
+     * \brief Write out the planned path into a VehiclePath object, as runs of points on the same edge.
+     * The start time, header and message type are left to the caller.
+     * \param vehicle_path VehiclePath object to write into
+     * \param optimal Use the optimal speed profile instead of the current one
+     */
+    void get_vehicle_path(VehiclePath &vehicle_path, bool optimal);
+
+    /**
+     * \brief Convert a received trajectory (see VehicleTrajectoryPlanner::read_vehicles) into a path.
+     * Steps for which the trajectory contains no data are marked with PlannedPath::no_point.
+     * \param other_vehicle_id Id of the other vehicle
+     * \param trajectory The received trajectory, (speed profile index, (edge index, edge path index)) per step
+     * \param path_out The path to write into
+     */
+    static void load_other_path(
+        uint8_t other_vehicle_id,
+        const std::vector<std::pair<size_t, std::pair<size_t, size_t>>> &trajectory,
+        PlannedPath &path_out);
+
+    /**
+     * \brief Decode a received VehiclePath directly into a path, without the per point conversion of a received Trajectory.
+     * Point k of the message is written to speed profile step (start_time - t_real_time) / dt_speed_profile + k,
+     * steps without a point are marked with PlannedPath::no_point.
+     * \param vehicle_path The received message
+     * \param t_real_time Time of the current planning step
+     * \param path_out The path to write into
+     * \return False if the message is inconsistent, all steps are marked with PlannedPath::no_point then
+     */
+    static bool load_other_path(const VehiclePath &vehicle_path, uint64_t t_real_time, PlannedPath &path_out);
+
+    /**
+     * \brief Decode a received VehiclePath into the (speed profile index, (edge index, edge path index)) entries
+     * that VehicleTrajectoryPlanner::read_vehicles creates for a received Trajectory. Points in the past are skipped.
+     * \param vehicle_path The received message
+     * \param t_real_time Time of the current planning step
+     * \param positions_out Cleared, then filled with the entries
+     * \return False if the message is inconsistent
+     */
+    static bool get_received_positions(
+        const VehiclePath &vehicle_path,
+        uint64_t t_real_time,
+        std::vector<std::pair<size_t, std::pair<size_t, size_t>>> &positions_out);
+
     /**
      * \brief Returns a single TrajectoryPoint object, with the given parameters
      * \param time Time, when we reach this point (ns)
@@ -162,6 +308,23 @@ public:
      */
     void apply_timestep();
 
+    /**
+     * \brief Like get_planned_path, but writes point indices into a preallocated path
+     * \param optimal Use the optimal speed profile instead of the current one
+     * \param path_out The path to write into
+     */
+    void compute_planned_path(bool optimal, PlannedPath &path_out);
+
+    /**
+     * \brief Mean of the planned speed in the current timestep (the part of the speed profile that apply_timestep drives), m/s
+     */
+    double get_timestep_mean_speed() const;
+
+    /**
+     * \brief Maximum speed in m/s
+     */
+    static constexpr double get_max_speed() {return max_speed;}
+
     /**
      * \brief Return length of one speed profile step
      */
@@ -173,16 +336,17 @@ public:
     void debug_writeOutOwnTrajectory(); // Debugging method
 
     /**
-    *  \brief Compute the number of potential collisions in on the already known trajectories
+    *  \brief Compute the number of potential collisions in on the already known paths, see load_other_path
     *  (Future Collision Assessment) 
     */
-    uint16_t potential_collisions(std::map<uint8_t, std::vector<std::pair<size_t, std::pair<size_t, size_t>>>> &other_vehicles, bool optimal);
+    uint16_t potential_collisions(const vector<PlannedPath> &other_vehicle_paths, bool optimal);
 
     /**
     *  \brief Updates the number of potential collisions by recomputing the potential collisions with the winner of the last plan step
     *  (Future Collision Assessment) 
+    *  \param winner_path The path of the winner, its vehicle_id identifies the winner
     */
-    uint16_t update_potential_collisions(std::map<uint8_t, std::vector<std::pair<size_t, std::pair<size_t, size_t>>>> &other_vehicles, uint8_t winner, uint16_t old_fca);
+    uint16_t update_potential_collisions(const PlannedPath &winner_path, uint16_t old_fca);
 
     /**
      * TODO
@@ -191,13 +355,20 @@ public:
 
     /**
      * \brief Change the own speed profile so as not to collide with the other_vehicles.
-     * \param other_vehicles
+     * \param other_vehicles Received trajectories of the vehicles with a higher priority
      * \return True if successful and False otherwise.
      */
     bool avoid_collisions(
-        std::map<uint8_t, std::vector<std::pair<size_t, std::pair<size_t, size_t>>>> other_vehicles
+        const std::map<uint8_t, std::vector<std::pair<size_t, std::pair<size_t, size_t>>>> &other_vehicles
     );
 
+    /**
+     * \brief Like avoid_collisions, for paths that were already decoded, see load_other_path
+     * \param other_vehicle_paths Paths of the vehicles with a higher priority
+     * \return True if successful and False otherwise.
+     */
+    bool avoid_collisions(const vector<PlannedPath> &other_vehicle_paths);
+
     /**
      * \brief Returns the corresponding vehicle id
      */
@@ -240,15 +411,18 @@ public:
    void write_current_speed_profile(std::ofstream &stream);
 
     /**
-    * \brief compute the subgraph induced by the paths of the vehicles
-    * \return nodes
+    * \brief compute the subgraph induced by the paths of the vehicles.
+    * Duplicate edges are found in an adjacency bitset per lane graph edge.
+    * \return nodes in the order of their first transition, each with its successors in the order of their first transition
     **/
    std::vector<std::pair<int, std::vector<int>>> compute_path_induced_subgraph(std::map<uint8_t, std::vector<std::pair<size_t, std::pair<size_t, size_t>>>> &vehicles_buffer);
 
 
     /**
-     * \brief computes a vertex ordering based priority vector
-     * \return ^
+     * \brief computes a vertex ordering based priority vector.
+     * The vehicles are processed in the order of the buffer, and the ordering after each vehicle is cached. The ordering is only
+     * recomputed from the first vehicle whose edge transitions changed since the last call; if none changed, the last result is returned.
+     * \return vehicle ids, highest priority first
      **/
     std::vector<uint8_t> compute_graph_based_priorities(std::map<uint8_t, std::vector<std::pair<size_t, std::pair<size_t, size_t>>>> &vehicles_buffer);
 
@@ -0,0 +1,58 @@
+// MIT License
+// 
+// Copyright (c) 2020 Lehrstuhl Informatik 11 - RWTH Aachen University
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// 
+// This file is part of cpm_lab.
+// 
+// Author: i11 - Embedded Software, RWTH Aachen University
+
+#include "EdgePathCollisionTable.hpp"
+#include "geometry.hpp"
+#include <iostream>
+#include <string>
+
+/**
+ * \file generate_collision_table.cpp
+ * \brief Computes the edge path collision table of the lane graph (which one depends on the include directory set by CMake)
+ * and writes it to a file, which the HLCs map at startup instead of computing the table themselves.
+ * The file is written next to the executable, or to the folder given as first argument.
+ * \ingroup distributed_routing
+ */
+
+int main(int argc, char *argv[])
+{
+    const std::string output_folder = (argc > 1) ? argv[1] : EdgePathCollisionTable::get_executable_folder();
+
+    // Only the lane graph itself is needed here, LaneGraphTools would compute the table at startup
+    const LaneGraph lane_graph;
+    const uint64_t lane_graph_hash = EdgePathCollisionTable::compute_lane_graph_hash(lane_graph, EDGE_PATH_COLLISION_DISTANCE);
+    const std::string file_path = output_folder + "/" + EdgePathCollisionTable::get_file_name(lane_graph_hash);
+
+    const EdgePathCollisionTable table = EdgePathCollisionTable::compute(lane_graph, EDGE_PATH_COLLISION_DISTANCE);
+    if (!table.write_file(file_path, lane_graph_hash))
+    {
+        std::cerr << "Could not write the collision table to " << file_path << std::endl;
+        return 1;
+    }
+
+    std::cout << "Wrote collision table for " << lane_graph.n_edges << " edges (" << table.size_bytes() << " bytes) to " << file_path << std::endl;
+    return 0;
+}
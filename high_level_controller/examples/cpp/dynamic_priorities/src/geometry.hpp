@@ -32,6 +32,8 @@ using std::vector;
 
 const float VEHICLE_HALF_LENGTH = 0.15;
 const float VEHICLE_HALF_WIDTH = 0.06;
+//! Two points of the lane graph are a collision if the distance between vehicles standing on them is below this value, meters
+const double EDGE_PATH_COLLISION_DISTANCE = 0.012;
 
 /**
  * \file geometry.hpp
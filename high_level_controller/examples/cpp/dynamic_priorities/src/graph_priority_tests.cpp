@@ -0,0 +1,457 @@
+// MIT License
+// 
+// Copyright (c) 2020 Lehrstuhl Informatik 11 - RWTH Aachen University
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// 
+// This file is part of cpm_lab.
+// 
+// Author: i11 - Embedded Software, RWTH Aachen University
+
+#include "lane_graph_tools.hpp"
+#include "CouplingGraph.hpp"
+#include "VehicleTrajectoryPlanningState.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <random>
+#include <sstream>
+#include <tuple>
+#include <vector>
+
+/**
+ * \file graph_priority_tests.cpp
+ * \brief Checks that CouplingGraph (adjacency bitsets) returns the same vehicles as the nested maps it used before, and that
+ * VehicleTrajectoryPlanningState::compute_path_induced_subgraph and compute_graph_based_priorities (dense vertex ordering,
+ * cached per vehicle) give the same results as before, for vehicles driving random routes on the lane graph.
+ * In each round, each vehicle either stands still (same path as in the last round) or moves on, and sometimes a vehicle is missing.
+ * Also measures the time per call of both. The number of rounds can be given as first argument (default 2000).
+ * Returns 1 if any result differs.
+ * \ingroup distributed_routing
+ */
+
+//! Type of the received paths, see VehicleTrajectoryPlanner::read_vehicles
+using VehiclesBuffer = std::map<uint8_t, std::vector<std::pair<size_t, std::pair<size_t, size_t>>>>;
+
+//! Number of points of a path, one per speed profile step
+static const size_t n_path_points = N_STEPS_SPEED_PROFILE;
+
+/**
+ * \class LegacyCouplingGraph
+ * \brief CouplingGraph as it was before, with a map per vehicle
+ * \ingroup distributed_routing
+ */
+class LegacyCouplingGraph
+{
+    enum CouplingType { previousVehicle, concurrentVehicle, ignoredVehicle };
+    std::set<uint8_t> vehicleSet;
+    std::map<uint8_t, std::map<uint8_t, CouplingType>> couplingData;
+
+    std::set<uint8_t> getMatchingVehicles(uint8_t vehicleId, CouplingType type)
+    {
+        auto vehicleData = couplingData.at(vehicleId);
+        std::set<uint8_t> result;
+        for (auto const &entry : vehicleData)
+        {
+            if (entry.second == type)
+            {
+                result.insert(entry.first);
+            }
+        }
+        return result;
+    }
+
+public:
+    LegacyCouplingGraph(std::vector<uint8_t> vehicleIds) : vehicleSet(vehicleIds.begin(), vehicleIds.end())
+    {
+        for (auto const &vehicleId : vehicleSet)
+        {
+            std::map<uint8_t, CouplingType> vehicleData;
+            for (auto const &otherVehicle : vehicleSet)
+            {
+                vehicleData.insert(std::make_pair(otherVehicle, (otherVehicle < vehicleId) ? previousVehicle : ignoredVehicle));
+            }
+            couplingData.insert({vehicleId, vehicleData});
+        }
+    }
+
+    void addIterativeBlock(std::vector<int> blockIds)
+    {
+        for (auto const &vehicleId1 : blockIds)
+        {
+            auto &vehicleData = couplingData.at(vehicleId1);
+            for (auto const &vehicleId2 : blockIds)
+            {
+                if (vehicleId1 != vehicleId2)
+                {
+                    vehicleData[vehicleId2] = concurrentVehicle;
+                }
+            }
+        }
+    }
+
+    std::set<uint8_t> getPreviousVehicles(uint8_t vehicleId) { return getMatchingVehicles(vehicleId, previousVehicle); }
+    std::set<uint8_t> getConcurrentVehicles(uint8_t vehicleId) { return getMatchingVehicles(vehicleId, concurrentVehicle); }
+    std::set<uint8_t> getIgnoredVehicles(uint8_t vehicleId) { return getMatchingVehicles(vehicleId, ignoredVehicle); }
+
+    std::string toString()
+    {
+        std::stringstream ss;
+        for (auto const &entry1 : couplingData)
+        {
+            ss << "Data for vehicle " << static_cast<uint32_t>(entry1.first) << " : ";
+            for (auto const &entry2 : entry1.second)
+            {
+                ss << entry2.second << ", ";
+            }
+            ss << std::endl;
+        }
+        return ss.str();
+    }
+};
+
+/**
+ * \brief compute_path_induced_subgraph as it was before, searching the node and edge lists
+ * \ingroup distributed_routing
+ */
+static std::vector<std::pair<int, std::vector<int>>> compute_path_induced_subgraph_legacy(const VehiclesBuffer &vehicles_buffer)
+{
+    std::vector<std::pair<int, std::vector<int>>> graph;
+    for (auto vehicle : vehicles_buffer)
+    {
+        std::vector<std::pair<size_t, std::pair<size_t, size_t>>> path = vehicle.second;
+        for (size_t i=0; i < path.size()-1; i++)
+        {
+            int v_1 = path.at(i).second.first;
+            int v_2 = path.at(i+1).second.first;
+            if (v_1 == v_2)
+            {
+                continue;
+            }
+
+            bool found = false;
+            for (auto &v_i : graph)
+            {
+                if (v_i.first == v_1)
+                {
+                    found = true;
+                    auto index = std::find(v_i.second.begin(), v_i.second.end(), v_2);
+                    if (index == v_i.second.end())
+                    {
+                        v_i.second.push_back(v_2);
+                    }
+                    break;
+                }
+            }
+            if (!found)
+            {
+                graph.push_back(std::make_pair(v_1, std::vector<int>{v_2}));
+            }
+        }
+    }
+    return graph;
+}
+
+/**
+ * \brief compute_graph_based_priorities as it was before (without its debug output), searching the ordered vertices in a list
+ * \ingroup distributed_routing
+ */
+static std::vector<uint8_t> compute_graph_based_priorities_legacy(uint8_t vehicle_id, const VehiclesBuffer &vehicles_buffer)
+{
+    std::vector<std::tuple<int, int, int>> order;
+    for (auto vehicle : vehicles_buffer)
+    {
+        std::vector<std::pair<size_t, std::pair<size_t, size_t>>> path = vehicle.second;
+        for (int i=0; i < ((int)path.size())-1; i++)
+        {
+            int v_1 = path.at(i).second.first;
+            int v_2 = path.at(i+1).second.first;
+            if (v_1 == v_2)
+            {
+                continue;
+            }
+
+            auto idx_v1 = std::find_if( order.begin(), order.end(),
+                            [&v_1](const std::tuple<int, int, int>& element){ return std::get<0>(element) == v_1;} );
+            auto idx_v2 = std::find_if( order.begin(), order.end(),
+                            [&v_2](const std::tuple<int, int, int>& element){ return std::get<0>(element) == v_2;} );
+
+            if (idx_v1 == order.end() && idx_v2 == order.end())
+            {
+                order.push_back(std::make_tuple(v_1, 1, i));
+            }
+            else if (idx_v1 == order.end() && idx_v2 != order.end())
+            {
+                order.push_back(std::make_tuple(v_1, std::get<1>(*idx_v2) - 1, i));
+            }
+            else if (idx_v1 != order.end() && idx_v2 == order.end())
+            {
+                order.push_back(std::make_tuple(v_2, std::get<1>(*idx_v1) + 1, i));
+            }
+            else if (i < std::get<2>(*idx_v2) + 3)
+            {
+                std::get<1>(*idx_v2) = std::get<1>(*idx_v1) + 1;
+                std::get<2>(*idx_v2) = i;
+            }
+        }
+    }
+
+    std::vector<std::pair<uint8_t, int>> pi_vec;
+    int own_pi = 0;
+    for (auto& vehicle : vehicles_buffer)
+    {
+        std::vector<std::pair<size_t, std::pair<size_t, size_t>>> path = vehicle.second;
+        int v_1 = path.at(0).second.first;
+        auto idx_v1 = std::find_if( order.begin(), order.end(),
+                            [&v_1](const std::tuple<int, int, int>& element){ return std::get<0>(element) == v_1;});
+        if (vehicle_id == vehicle.first)
+        {
+            own_pi = std::get<1>(*idx_v1);
+        }
+
+        if (!pi_vec.empty() && own_pi < std::get<1>(*idx_v1))
+        {
+            pi_vec.insert(pi_vec.begin(), std::make_pair(vehicle.first, std::get<1>(*idx_v1)));
+        }
+        else
+        {
+            pi_vec.emplace_back(std::make_pair(vehicle.first, std::get<1>(*idx_v1)));
+        }
+    }
+
+    std::sort(pi_vec.begin(), pi_vec.end(), [](auto &a, auto &b) {
+        return a.second > b.second || (a.second == b.second && a.first > b.first);
+    });
+
+    std::vector<uint8_t> prio_vec;
+    for (auto pi_n:pi_vec)
+    {
+        prio_vec.emplace_back(pi_n.first);
+    }
+    return prio_vec;
+}
+
+/**
+ * \brief Compare CouplingGraph to LegacyCouplingGraph, with iterative blocks of random vehicles
+ * \ingroup distributed_routing
+ * \param n_vehicles Number of vehicles, with the IDs 1..n_vehicles
+ * \param random_engine Random engine for the blocks
+ * \return False if any result differs
+ */
+static bool check_coupling_graph(size_t n_vehicles, std::mt19937 &random_engine)
+{
+    std::vector<uint8_t> vehicle_ids;
+    for (size_t i = 1; i <= n_vehicles; ++i)
+    {
+        vehicle_ids.push_back(static_cast<uint8_t>(i));
+    }
+
+    CouplingGraph graph(vehicle_ids);
+    LegacyCouplingGraph legacy_graph(vehicle_ids);
+    std::uniform_int_distribution<int> random_vehicle(1, static_cast<int>(n_vehicles));
+    for (int i_block = 0; i_block < 3; ++i_block)
+    {
+        std::vector<int> block;
+        for (int i = 0; i < 3; ++i)
+        {
+            block.push_back(random_vehicle(random_engine));
+        }
+        graph.addIterativeBlock(block);
+        legacy_graph.addIterativeBlock(block);
+    }
+
+    bool is_equal = graph.toString() == legacy_graph.toString();
+    for (uint8_t vehicle_id : vehicle_ids)
+    {
+        is_equal = is_equal
+            && graph.getPreviousVehicles(vehicle_id) == legacy_graph.getPreviousVehicles(vehicle_id)
+            && graph.getConcurrentVehicles(vehicle_id) == legacy_graph.getConcurrentVehicles(vehicle_id)
+            && graph.getIgnoredVehicles(vehicle_id) == legacy_graph.getIgnoredVehicles(vehicle_id);
+    }
+    if (!is_equal)
+    {
+        std::cerr << "Coupling graph of " << n_vehicles << " vehicles differs" << std::endl;
+        return false;
+    }
+
+    // Previous vehicles only get removed by the blocks, so the vehicles still plan in the order of their IDs
+    if (!graph.isAcyclic() || graph.getPlanningOrder() != vehicle_ids)
+    {
+        std::cerr << "Planning order of " << n_vehicles << " vehicles differs" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * \brief Vehicle driving along a random route, one lane graph point per path point
+ * \ingroup distributed_routing
+ */
+struct RouteVehicle
+{
+    //! Edges of the route
+    std::vector<size_t> route;
+    //! Index of the current point on the route, route index * n_edge_path_nodes + edge path index
+    size_t position = 0;
+};
+
+/**
+ * \brief Extend the route of a vehicle, s.t. it contains the path starting at its position
+ * \ingroup distributed_routing
+ */
+static void extend_route(RouteVehicle &vehicle, std::mt19937 &random_engine)
+{
+    while (vehicle.route.size() * laneGraphTools.n_edge_path_nodes < vehicle.position + n_path_points)
+    {
+        const auto next_edges = laneGraphTools.find_subsequent_edges(vehicle.route.back());
+        vehicle.route.push_back(next_edges.at(random_engine() % next_edges.size()));
+    }
+}
+
+/**
+ * \brief Path of a vehicle, as received by read_vehicles
+ * \ingroup distributed_routing
+ */
+static std::vector<std::pair<size_t, std::pair<size_t, size_t>>> get_path(const RouteVehicle &vehicle)
+{
+    std::vector<std::pair<size_t, std::pair<size_t, size_t>>> path;
+    for (size_t i = 0; i < n_path_points; ++i)
+    {
+        const size_t route_point = vehicle.position + i;
+        path.push_back(std::make_pair(i, std::make_pair(
+            vehicle.route.at(route_point / laneGraphTools.n_edge_path_nodes),
+            route_point % laneGraphTools.n_edge_path_nodes)));
+    }
+    return path;
+}
+
+/**
+ * \brief Time since start in milliseconds
+ * \ingroup distributed_routing
+ */
+static double milliseconds_since(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * \brief Main of the graph priority tests
+ * \ingroup distributed_routing
+ */
+int main(int argc, char *argv[])
+{
+    const int n_rounds = (argc > 1) ? std::max(1, atoi(argv[1])) : 2000;
+    std::mt19937 random_engine(42);
+
+    for (size_t n_vehicles : {1, 4, 20, 64, 255})
+    {
+        if (!check_coupling_graph(n_vehicles, random_engine))
+        {
+            return 1;
+        }
+    }
+
+    std::ostringstream results;
+    results << std::fixed << std::setprecision(4);
+    results << "vehicles; probability to stand still; rounds; subgraph legacy [ms]; subgraph [ms]; "
+        << "priorities legacy [ms]; priorities [ms]; speed-up" << std::endl;
+
+    for (size_t n_vehicles : {20, 64})
+    {
+        for (double p_stand_still : {0.0, 0.5, 0.9})
+        {
+            std::vector<RouteVehicle> vehicles(n_vehicles);
+            std::uniform_int_distribution<size_t> random_edge(0, laneGraphTools.n_edges - 1);
+            std::uniform_int_distribution<size_t> random_vehicle(0, n_vehicles - 1);
+            std::uniform_real_distribution<double> random_probability(0.0, 1.0);
+            for (auto &vehicle : vehicles)
+            {
+                vehicle.route.push_back(random_edge(random_engine));
+                vehicle.position = random_engine() % laneGraphTools.n_edge_path_nodes;
+                extend_route(vehicle, random_engine);
+            }
+
+            VehicleTrajectoryPlanningState state(1, vehicles[0].route[0], 0, 400000000ull, 1);
+            double legacy_subgraph_ms = 0;
+            double subgraph_ms = 0;
+            double legacy_priorities_ms = 0;
+            double priorities_ms = 0;
+
+            for (int round = 0; round < n_rounds; ++round)
+            {
+                // Sometimes the path of a vehicle is missing, e.g. because the round timed out
+                const size_t missing_vehicle = (random_probability(random_engine) < 0.1) ? random_vehicle(random_engine) : n_vehicles;
+
+                VehiclesBuffer vehicles_buffer;
+                for (size_t i = 0; i < n_vehicles; ++i)
+                {
+                    if (i != missing_vehicle)
+                    {
+                        vehicles_buffer[static_cast<uint8_t>(i + 1)] = get_path(vehicles[i]);
+                    }
+                }
+
+                auto t_0 = std::chrono::steady_clock::now();
+                const auto legacy_subgraph = compute_path_induced_subgraph_legacy(vehicles_buffer);
+                legacy_subgraph_ms += milliseconds_since(t_0);
+                t_0 = std::chrono::steady_clock::now();
+                const auto subgraph = state.compute_path_induced_subgraph(vehicles_buffer);
+                subgraph_ms += milliseconds_since(t_0);
+                t_0 = std::chrono::steady_clock::now();
+                const auto legacy_priorities = compute_graph_based_priorities_legacy(1, vehicles_buffer);
+                legacy_priorities_ms += milliseconds_since(t_0);
+                t_0 = std::chrono::steady_clock::now();
+                const auto priorities = state.compute_graph_based_priorities(vehicles_buffer);
+                priorities_ms += milliseconds_since(t_0);
+
+                if (subgraph != legacy_subgraph)
+                {
+                    std::cerr << n_vehicles << " vehicles, round " << round << ": path-induced subgraph differs" << std::endl;
+                    return 1;
+                }
+                if (priorities != legacy_priorities)
+                {
+                    std::cerr << n_vehicles << " vehicles, round " << round << ": graph based priorities differ" << std::endl;
+                    return 1;
+                }
+
+                // Move on by one planning step (8 speed profile steps), like the optimal trajectories do
+                for (auto &vehicle : vehicles)
+                {
+                    if (random_probability(random_engine) >= p_stand_still)
+                    {
+                        vehicle.position += 1 + random_engine() % 8;
+                        extend_route(vehicle, random_engine);
+                    }
+                }
+            }
+
+            results << n_vehicles << "; " << p_stand_still << "; " << n_rounds << "; "
+                << legacy_subgraph_ms / n_rounds << "; " << subgraph_ms / n_rounds << "; "
+                << legacy_priorities_ms / n_rounds << "; " << priorities_ms / n_rounds << "; "
+                << legacy_priorities_ms / priorities_ms << std::endl;
+        }
+    }
+
+    std::cout << std::endl << "Time per call:" << std::endl << results.str();
+    return 0;
+}
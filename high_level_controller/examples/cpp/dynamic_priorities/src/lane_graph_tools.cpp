@@ -26,13 +26,18 @@
 
 #include "lane_graph_tools.hpp"
 #include "geometry.hpp"
-#include <future>
+#include <algorithm>
+#include <cmath>
+#include <iostream>
 
 /**
  * \file lane_graph_tools.cpp
  * \ingroup distributed_routing
  */
 
+//! Side length of the cells of the map matching grid, the maximum matching distance (0.3 m) plus a margin for rounding
+static const double map_match_cell_size = 0.3 + 1e-9;
+
 const LaneGraphTools laneGraphTools;
 
 LaneGraphTools::LaneGraphTools()
@@ -57,115 +62,149 @@ LaneGraphTools::LaneGraphTools()
     }
 
 
-    //////////////// Precompute collision between all reference poses
-    edge_path_collisions = std::vector< std::vector< std::vector< std::vector<bool> > > >
-    (
-        n_edges,
-        std::vector< std::vector< std::vector<bool> > >
-        (
-            n_edge_path_nodes,
-            std::vector< std::vector<bool> >
-            (
-                n_edges,
-                std::vector<bool> 
-                (
-                    n_edge_path_nodes,
-                    false
-                )
-            )
-        )
-    );
-    // In the vector <jobs> all distances from node A to every known node B is listed. 
-    // In vector <edge_path_collisions> every potential collision is written under criteria that the distance is under 0.01 m.
-    std::vector<std::future<bool>> jobs;
-    for (size_t i_edge_A = 0; i_edge_A < n_edges; ++i_edge_A)
+    //////////////// Precompute the subsequent edges of each edge
+    subsequent_edges.resize(n_edges);
+    for (size_t i_edge = 0; i_edge < n_edges; ++i_edge)
     {
-        jobs.push_back(std::async(std::launch::async, 
-            [this, i_edge_A](){
-                for (size_t i_path_A = 0; i_path_A < n_edge_path_nodes; ++i_path_A)
-                {
-                    PathNode nodeA (
-                        edges_x.at(i_edge_A).at(i_path_A),
-                        edges_y.at(i_edge_A).at(i_path_A),
-                        edges_cos.at(i_edge_A).at(i_path_A),
-                        edges_sin.at(i_edge_A).at(i_path_A)
-                    );
-
-                    for (size_t i_edge_B = 0; i_edge_B < n_edges; ++i_edge_B)
-                    {
-                        for (size_t i_path_B = 0; i_path_B < n_edge_path_nodes; ++i_path_B)
-                        {
-                            PathNode nodeB (
-                                edges_x.at(i_edge_B).at(i_path_B),
-                                edges_y.at(i_edge_B).at(i_path_B),
-                                edges_cos.at(i_edge_B).at(i_path_B),
-                                edges_sin.at(i_edge_B).at(i_path_B)
-                            );
-
-                            const double distance = min_distance_vehicle_to_vehicle(nodeA, nodeB);
-                            edge_path_collisions.at(i_edge_A).at(i_path_A).at(i_edge_B).at(i_path_B) = (distance < 0.012);
-                        }
-                    }
-                }
-                return true;
+        for (size_t i_next_edge = 0; i_next_edge < n_edges; ++i_next_edge)
+        {
+            if(edges_start_index[i_next_edge] == edges_end_index[i_edge])
+            {
+                subsequent_edges[i_edge].push_back(i_next_edge);
             }
-        ));
+        }
+    }
+
+    //////////////// Sort all path nodes into a grid for map matching
+    // With the maximum matching distance as cell size, all candidates of a pose are in its own and the neighbouring cells
+    map_match_min_x = edges_x[0][0];
+    map_match_min_y = edges_y[0][0];
+    double max_x = map_match_min_x;
+    double max_y = map_match_min_y;
+    for (size_t i_edge = 0; i_edge < n_edges; ++i_edge)
+    {
+        for (size_t i_path = 0; i_path < n_edge_path_nodes; ++i_path)
+        {
+            map_match_min_x = fmin(map_match_min_x, edges_x[i_edge][i_path]);
+            map_match_min_y = fmin(map_match_min_y, edges_y[i_edge][i_path]);
+            max_x = fmax(max_x, edges_x[i_edge][i_path]);
+            max_y = fmax(max_y, edges_y[i_edge][i_path]);
+        }
+    }
+    map_match_n_cells_x = static_cast<size_t>((max_x - map_match_min_x) / map_match_cell_size) + 1;
+    map_match_n_cells_y = static_cast<size_t>((max_y - map_match_min_y) / map_match_cell_size) + 1;
+
+    std::vector<size_t> node_cells;
+    map_match_cell_start.assign(map_match_n_cells_x * map_match_n_cells_y + 1, 0);
+    for (size_t i_edge = 0; i_edge < n_edges; ++i_edge)
+    {
+        for (size_t i_path = 0; i_path < n_edge_path_nodes; ++i_path)
+        {
+            const size_t cell_x = std::min(static_cast<size_t>((edges_x[i_edge][i_path] - map_match_min_x) / map_match_cell_size), map_match_n_cells_x - 1);
+            const size_t cell_y = std::min(static_cast<size_t>((edges_y[i_edge][i_path] - map_match_min_y) / map_match_cell_size), map_match_n_cells_y - 1);
+            node_cells.push_back(cell_y * map_match_n_cells_x + cell_x);
+            ++map_match_cell_start[node_cells.back() + 1];
+        }
+    }
+    for (size_t cell = 1; cell < map_match_cell_start.size(); ++cell)
+    {
+        map_match_cell_start[cell] += map_match_cell_start[cell - 1];
     }
+    map_match_nodes.resize(node_cells.size());
+    std::vector<size_t> cell_fill(map_match_cell_start.begin(), map_match_cell_start.end() - 1);
+    for (size_t i_point = 0; i_point < node_cells.size(); ++i_point)
+    {
+        const size_t i_edge = i_point / n_edge_path_nodes;
+        const size_t i_path = i_point % n_edge_path_nodes;
+        MapMatchNode &node = map_match_nodes[cell_fill[node_cells[i_point]]++];
+        node.x = edges_x[i_edge][i_path];
+        node.y = edges_y[i_edge][i_path];
+        node.cos_yaw = edges_cos[i_edge][i_path];
+        node.sin_yaw = edges_sin[i_edge][i_path];
+        node.point_index = i_point;
+    }
+
 
-    for(auto& job:jobs)
+    //////////////// Precompute collision between all reference poses
+    // The table is usually generated offline by generate_collision_table and only mapped here.
+    // If there is no table file for this lane graph next to the executable, it is computed in memory.
+    const uint64_t lane_graph_hash = EdgePathCollisionTable::compute_lane_graph_hash(*this, EDGE_PATH_COLLISION_DISTANCE);
+    const std::string table_path = EdgePathCollisionTable::get_executable_folder() + "/" + EdgePathCollisionTable::get_file_name(lane_graph_hash);
+    if (!edge_path_collisions.map_file(table_path, lane_graph_hash, n_edges, n_edge_path_nodes))
     {
-        job.get();
+        std::cout << "No collision table file " << table_path << " found, computing the collision table" << std::endl;
+        edge_path_collisions = EdgePathCollisionTable::compute(*this, EDGE_PATH_COLLISION_DISTANCE);
     }
 }
 //////////////////Localization on the map////////////////////////////////////////
 //each edge is searched on the lane graph and if it matched, true is returned
 bool LaneGraphTools::map_match_pose(Pose2D pose, int &out_edge_index, int &out_edge_path_index) const
 {
+    if (!std::isfinite(pose.x()) || !std::isfinite(pose.y()))
+    {
+        return false;
+    }
+
+    // Only the cells around the pose can contain nodes closer than the maximum matching distance
+    const double cell_x = floor((pose.x() - map_match_min_x) / map_match_cell_size);
+    const double cell_y = floor((pose.y() - map_match_min_y) / map_match_cell_size);
+    if (cell_x + 1 < 0 || cell_y + 1 < 0
+        || cell_x - 1 >= static_cast<double>(map_match_n_cells_x)
+        || cell_y - 1 >= static_cast<double>(map_match_n_cells_y))
+    {
+        return false;
+    }
+    const size_t cell_x_begin = static_cast<size_t>(fmax(cell_x - 1, 0));
+    const size_t cell_y_begin = static_cast<size_t>(fmax(cell_y - 1, 0));
+    const size_t cell_x_end = static_cast<size_t>(fmin(cell_x + 2, map_match_n_cells_x));
+    const size_t cell_y_end = static_cast<size_t>(fmin(cell_y + 2, map_match_n_cells_y));
+
+    const double cos_yaw = cos(pose.yaw());
+    const double sin_yaw = sin(pose.yaw());
+
     bool match_found = false;
     double min_squared_distance = 1e300;
+    size_t best_point_index = 0;
 
-    for (size_t i_edge = 0; i_edge < n_edges; ++i_edge)
+    for (size_t i_cell_y = cell_y_begin; i_cell_y < cell_y_end; ++i_cell_y)
     {
-        for (size_t i_path = 0; i_path < n_edge_path_nodes; ++i_path)
+        for (size_t i_cell_x = cell_x_begin; i_cell_x < cell_x_end; ++i_cell_x)
         {
-            const double x = edges_x[i_edge][i_path];
-            const double y = edges_y[i_edge][i_path];
-            const double c = edges_cos[i_edge][i_path];
-            const double s = edges_sin[i_edge][i_path];
-
-            const double cos_delta_yaw = c * cos(pose.yaw()) + s * sin(pose.yaw());
-            const double dx = x - pose.x();
-            const double dy = y - pose.y();
-            const double squared_distance = dx*dx + dy*dy;
-
-            if( cos_delta_yaw > 0.7
-                && squared_distance < 0.09
-                && squared_distance < min_squared_distance)
+            const size_t cell = i_cell_y * map_match_n_cells_x + i_cell_x;
+            for (size_t i_node = map_match_cell_start[cell]; i_node < map_match_cell_start[cell + 1]; ++i_node)
             {
-                match_found = true;
-                out_edge_index = i_edge;
-                out_edge_path_index = i_path;
-                min_squared_distance = squared_distance;
+                const MapMatchNode &node = map_match_nodes[i_node];
+
+                const double cos_delta_yaw = node.cos_yaw * cos_yaw + node.sin_yaw * sin_yaw;
+                const double dx = node.x - pose.x();
+                const double dy = node.y - pose.y();
+                const double squared_distance = dx*dx + dy*dy;
+
+                // On equal distances, the node with the lowest index wins, as when searching all nodes in order
+                if( cos_delta_yaw > 0.7
+                    && squared_distance < 0.09
+                    && (squared_distance < min_squared_distance
+                        || (squared_distance == min_squared_distance && node.point_index < best_point_index)))
+                {
+                    match_found = true;
+                    min_squared_distance = squared_distance;
+                    best_point_index = node.point_index;
+                }
             }
         }
     }
+
+    if (match_found)
+    {
+        out_edge_index = best_point_index / n_edge_path_nodes;
+        out_edge_path_index = best_point_index % n_edge_path_nodes;
+    }
     return match_found;
 }
-//find
+
 vector<size_t> LaneGraphTools::find_subsequent_edges(int edge_index) const
 {
-    vector<size_t> result;
-    //if start index is the same as end index, remebr that
-    size_t subsequent_node_index = edges_end_index.at(edge_index);
-    for (size_t i_edge = 0; i_edge < n_edges; ++i_edge)
-    {
-        if(edges_start_index[i_edge] == subsequent_node_index)
-        {
-            result.push_back(i_edge);
-        }
-    }
-
-    return result;
+    return subsequent_edges.at(edge_index);
 }
 
 vector<size_t> LaneGraphTools::follow_predefined_trajectory(int edge_index, vector<size_t> oval) const
@@ -26,6 +26,7 @@
 
 #pragma once
 #include "lane_graph.hpp"
+#include "EdgePathCollisionTable.hpp"
 #include "Pose2D.hpp"
 #include <vector>
 using std::vector;
@@ -41,9 +42,39 @@ class LaneGraphTools : public LaneGraph
 {
     //! "Matrix" containing distances between edges
     std::vector<std::vector<double>> edges_s;
+
+    //! Edges that start at the end node of an edge, by edge index, see find_subsequent_edges
+    std::vector<std::vector<size_t>> subsequent_edges;
+
+    //! Path node in the map matching grid
+    struct MapMatchNode
+    {
+        //! x-position, meters
+        double x;
+        //! y-position, meters
+        double y;
+        //! Cosine of angle of pose
+        double cos_yaw;
+        //! Sine of angle of pose
+        double sin_yaw;
+        //! Index of the path node on the graph, edge index * n_edge_path_nodes + edge path index
+        size_t point_index;
+    };
+    //! Lower left corner of the map matching grid, meters
+    double map_match_min_x = 0;
+    //! Lower left corner of the map matching grid, meters
+    double map_match_min_y = 0;
+    //! Number of cells of the map matching grid in x direction
+    size_t map_match_n_cells_x = 0;
+    //! Number of cells of the map matching grid in y direction
+    size_t map_match_n_cells_y = 0;
+    //! All path nodes, sorted by cell of the map matching grid (and by point index within a cell)
+    std::vector<MapMatchNode> map_match_nodes;
+    //! The nodes of cell c are map_match_nodes[map_match_cell_start[c]] ... map_match_nodes[map_match_cell_start[c+1] - 1]
+    std::vector<size_t> map_match_cell_start;
 public:
-    //! "3D-matrix" containing info about which points on the graph are collisions
-    std::vector< std::vector< std::vector< std::vector<bool> > > > edge_path_collisions;
+    //! Info about which points on the graph are collisions, call as edge_path_collisions(edge_A, edge_path_A, edge_B, edge_path_B)
+    EdgePathCollisionTable edge_path_collisions;
     //! Constructor for class LaneGraphTools
     LaneGraphTools();
 
@@ -47,6 +47,7 @@
 #include "VehicleCommandTrajectory.hpp"
 #include "VehicleStateList.hpp"
 #include "Trajectory.hpp"
+#include "VehiclePath.hpp"
 
 // General C++ libs
 #include <chrono>
@@ -171,6 +172,11 @@ int main(int argc, char *argv[]) {
         "prio_seed", {0}, argc, argv
     ) + vehicle_id;
 
+    // Send planned paths in the compact VehiclePath encoding instead of Trajectory messages, needs to be the same for all HLCs
+    const bool compact_paths = cpm::cmd_parameter_bool(
+        "compact_paths", false, argc, argv
+    );
+
     // Outstream in shell which vehicles were selected
     std::stringstream vehicle_id_stream;
     vehicle_id_stream << "Started HLC for Vehicle ID: ";
@@ -209,18 +215,6 @@ int main(int argc, char *argv[]) {
     cpm::Writer<Visualization> writer_visualization(
             hlc_communicator.getLocalParticipant()->get_participant(),
             "visualization");
-    /* ---------------------------------------------------------------------------------
-     * Reader/Writers for direct comms between vehicles
-     * ---------------------------------------------------------------------------------
-     */
-    // Writer to communicate plans with other vehicles
-    cpm::Writer<Trajectory> writer_trajectory(
-            "trajectory");
-
-    // Reader to receive planned trajectories of other vehicles
-    cpm::ReaderAbstract<Trajectory> reader_trajectory(
-            "trajectory");
-
     /* ---------------------------------------------------------------------------------
      * Create planner object
      * ---------------------------------------------------------------------------------
@@ -228,16 +222,33 @@ int main(int argc, char *argv[]) {
     auto planner = std::unique_ptr<VehicleTrajectoryPlanner>(new VehicleTrajectoryPlanner(mode, prio_seed));
 
     // Set reader/writers of planner so it can communicate with other planners
-    planner->set_writer(
-    std::unique_ptr<cpm::Writer<Trajectory>>(
-        new cpm::Writer<Trajectory>("trajectory")
-        )
-    );
-    planner->set_reader(
-    std::unique_ptr<cpm::ReaderAbstract<Trajectory>>(
-        new cpm::ReaderAbstract<Trajectory>("trajectory")
-        )
-    );
+    // Only one encoding is subscribed, s.t. HLCs with different encodings do not silently ignore each other
+    if( compact_paths )
+    {
+        planner->set_vehicle_path_writer(
+        std::unique_ptr<cpm::Writer<VehiclePath>>(
+            new cpm::Writer<VehiclePath>("vehiclePath")
+            )
+        );
+        planner->set_vehicle_path_reader(
+        std::unique_ptr<cpm::ReaderAbstract<VehiclePath>>(
+            new cpm::ReaderAbstract<VehiclePath>("vehiclePath")
+            )
+        );
+    }
+    else
+    {
+        planner->set_writer(
+        std::unique_ptr<cpm::Writer<Trajectory>>(
+            new cpm::Writer<Trajectory>("trajectory")
+            )
+        );
+        planner->set_reader(
+        std::unique_ptr<cpm::ReaderAbstract<Trajectory>>(
+            new cpm::ReaderAbstract<Trajectory>("trajectory")
+            )
+        );
+    }
     // set fca reader and writer
     planner->set_fca_reader(
         std::unique_ptr<cpm::ReaderAbstract<FutureCollisionAssessment>>(
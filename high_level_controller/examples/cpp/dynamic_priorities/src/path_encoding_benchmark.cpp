@@ -0,0 +1,276 @@
+// MIT License
+//
+// Copyright (c) 2020 Lehrstuhl Informatik 11 - RWTH Aachen University
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// This file is part of cpm_lab.
+//
+// Author: i11 - Embedded Software, RWTH Aachen University
+
+#include "lane_graph_tools.hpp"
+#include "VehicleTrajectoryPlanningState.hpp"
+#include "Trajectory.hpp"
+#include "VehiclePath.hpp"
+#include "cpm/CommandLineReader.hpp"
+#include "cpm/init.hpp"
+#include "cpm/Writer.hpp"
+#include "cpm/ReaderAbstract.hpp"
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+/**
+ * \file path_encoding_benchmark.cpp
+ * \brief Compares the Trajectory and the VehiclePath encoding of the planned paths: --vehicles=INT (default 20) vehicles plan
+ * sequentially on lane_graph_full for --rounds=INT (default 50) planning steps, like in planning_step_benchmark.
+ * Each planned path is sent in both encodings via DDS to a reader in the same process (use --dds_domain=INT
+ * to run the benchmark on a local domain). The benchmark reports the serialized size of the messages and the time
+ * to encode them and to decode the received messages into the paths the planners use for the collision check (as
+ * VehicleTrajectoryPlanner::store_received does),
+ * and checks that both encodings result in the same paths.
+ * \ingroup distributed_routing
+ */
+
+//! Length of a timestep in nanoseconds, same as in simulation.cpp
+static const uint64_t dt = 400000000ull;
+
+//! Maximum time to wait for the loopback of a message
+static const std::chrono::nanoseconds receive_timeout = std::chrono::seconds(1);
+
+//! Start poses of the vehicles, same as in simulation.cpp
+static const std::vector<Pose2D> start_poses( {Pose2D(3.15802,3.88862,-0.0507011), Pose2D(3.8791,3.72123,-0.497375),
+                                    Pose2D(4.35882,2.95562,-1.41334), Pose2D(4.39471,1.99965,-1.56801),
+                                    Pose2D(4.35932,1.04568,-1.72724), Pose2D(3.87964,0.278448,-2.64031),
+                                    Pose2D(3.15654,0.111178,-3.09329), Pose2D(2.24999,0.104926,3.14091),
+                                    Pose2D(1.34368,0.111556,3.08998), Pose2D(0.62071,0.278691,2.63872),
+                                    Pose2D(0.141397,1.04581,1.7287), Pose2D(0.104006,2.00092,1.57371),
+                                    Pose2D(0.141131,2.9547,1.4113), Pose2D(0.62021,3.72161,0.500138),
+                                    Pose2D(1.34238,3.88924,0.0494666), Pose2D(3.05031,2.22542,3.14112),
+                                    Pose2D(3.05088,1.77524,-0.00189507), Pose2D(2.47512,1.19944,1.57269),
+                                    Pose2D(2.02503,1.19963,-1.57305), Pose2D(1.4504,1.77449,-0.0020518)});
+
+/**
+ * \brief Measured values of one encoding
+ * \ingroup distributed_routing
+ */
+struct EncodingStatistics
+{
+    //! Sum of the serialized sizes of all messages
+    size_t bytes = 0;
+    //! Time spent to create the messages
+    double encode_ms = 0.0;
+    //! Time spent to convert the received messages into paths
+    double decode_ms = 0.0;
+};
+
+/**
+ * \brief Take the next message of the vehicle from the reader
+ * \param reader Loopback reader
+ * \param vehicle_id The vehicle whose message is expected
+ * \param sample_out The received message
+ * \return False if the message did not arrive in time
+ * \ingroup distributed_routing
+ */
+template<typename Message>
+static bool receive(cpm::ReaderAbstract<Message> &reader, uint8_t vehicle_id, Message &sample_out)
+{
+    auto deadline = std::chrono::steady_clock::now() + receive_timeout;
+    while (std::chrono::steady_clock::now() < deadline)
+    {
+        for (auto &sample : reader.take())
+        {
+            if (sample.vehicle_id() == vehicle_id)
+            {
+                sample_out = sample;
+                return true;
+            }
+        }
+        reader.wait_for_messages(deadline - std::chrono::steady_clock::now());
+    }
+    return false;
+}
+
+/**
+ * \brief Serialized size of a message, as it is sent by DDS
+ * \ingroup distributed_routing
+ */
+template<typename Message>
+static size_t serialized_size(const Message &sample)
+{
+    std::vector<char> buffer;
+    dds::topic::topic_type_support<Message>::to_cdr_buffer(buffer, sample);
+    return buffer.size();
+}
+
+int main(int argc, char *argv[])
+{
+    cpm::init(argc, argv);
+
+    const size_t n_vehicles = std::min(start_poses.size(),
+        static_cast<size_t>(std::max(1, cpm::cmd_parameter_int("vehicles", 20, argc, argv))));
+    const int n_rounds = std::max(1, cpm::cmd_parameter_int("rounds", 50, argc, argv));
+
+    std::vector<std::unique_ptr<VehicleTrajectoryPlanningState>> vehicles;
+    for (size_t i = 0; i < n_vehicles; ++i)
+    {
+        const uint8_t vehicle_id = static_cast<uint8_t>(i + 1);
+        int edge_index = -1;
+        int edge_path_index = -1;
+        if (!laneGraphTools.map_match_pose(start_poses[i], edge_index, edge_path_index))
+        {
+            std::cerr << "Could not match start pose of vehicle " << static_cast<int>(vehicle_id) << std::endl;
+            return 1;
+        }
+        vehicles.emplace_back(new VehicleTrajectoryPlanningState(vehicle_id, edge_index, edge_path_index, dt, vehicle_id));
+    }
+
+    cpm::Writer<Trajectory> writer_trajectory("pathEncodingBenchmarkTrajectory", true);
+    cpm::ReaderAbstract<Trajectory> reader_trajectory("pathEncodingBenchmarkTrajectory", true);
+    cpm::Writer<VehiclePath> writer_vehicle_path("pathEncodingBenchmarkVehiclePath", true);
+    cpm::ReaderAbstract<VehiclePath> reader_vehicle_path("pathEncodingBenchmarkVehiclePath", true);
+
+    EncodingStatistics trajectory_statistics;
+    EncodingStatistics vehicle_path_statistics;
+    size_t n_edge_runs = 0;
+    size_t n_messages = 0;
+    size_t n_mismatches = 0;
+
+    for (int round = 0; round < n_rounds; ++round)
+    {
+        const uint64_t t_real_time = (round + 1) * dt;
+
+        // Paths of the vehicles that already planned in this round, as decoded from the received messages
+        std::vector<PlannedPath> previous_paths;
+        previous_paths.reserve(vehicles.size());
+
+        for (auto &vehicle : vehicles)
+        {
+            const uint8_t vehicle_id = vehicle->get_vehicle_id();
+            vehicle->save_speed_profile();
+            vehicle->reset_speed_profile();
+            if (!vehicle->avoid_collisions(previous_paths))
+            {
+                vehicle->revert_speed_profile();
+            }
+
+            // Encode like VehicleTrajectoryPlanner::send_plan_to_hlcs
+            auto start_time = std::chrono::steady_clock::now();
+            Trajectory trajectory;
+            vehicle->get_lane_graph_positions(trajectory, false);
+            for (size_t i = 0; i < trajectory.lane_graph_positions().size(); ++i)
+            {
+                trajectory.lane_graph_positions()[i].estimated_arrival_time().nanoseconds(
+                    t_real_time + vehicle->get_dt_speed_profile_nanos() * i);
+            }
+            trajectory.type(MessageType::Final);
+            trajectory.vehicle_id(vehicle_id);
+            trajectory.header().create_stamp().nanoseconds(t_real_time);
+            trajectory.header().valid_after_stamp().nanoseconds(0);
+            trajectory_statistics.encode_ms +=
+                std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start_time).count();
+
+            start_time = std::chrono::steady_clock::now();
+            VehiclePath vehicle_path;
+            vehicle->get_vehicle_path(vehicle_path, false);
+            vehicle_path.start_time().nanoseconds(t_real_time);
+            vehicle_path.type(MessageType::Final);
+            vehicle_path.header().create_stamp().nanoseconds(t_real_time);
+            vehicle_path.header().valid_after_stamp().nanoseconds(0);
+            vehicle_path_statistics.encode_ms +=
+                std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start_time).count();
+
+            trajectory_statistics.bytes += serialized_size(trajectory);
+            vehicle_path_statistics.bytes += serialized_size(vehicle_path);
+            n_edge_runs += vehicle_path.edge_runs().size();
+            ++n_messages;
+
+            writer_trajectory.write(trajectory);
+            writer_vehicle_path.write(vehicle_path);
+
+            Trajectory received_trajectory;
+            VehiclePath received_vehicle_path;
+            if (!receive(reader_trajectory, vehicle_id, received_trajectory)
+                || !receive(reader_vehicle_path, vehicle_id, received_vehicle_path))
+            {
+                std::cerr << "Did not receive the messages of vehicle " << static_cast<int>(vehicle_id)
+                    << " in round " << round << std::endl;
+                return 1;
+            }
+
+            // Decode both messages like VehicleTrajectoryPlanner::store_received does for the collision check and the fca priorities
+            start_time = std::chrono::steady_clock::now();
+            std::vector<std::pair<size_t, std::pair<size_t, size_t>>> positions;
+            positions.reserve(1000);
+            for (const LaneGraphPosition &position : received_trajectory.lane_graph_positions())
+            {
+                long long index =
+                    (static_cast<long long>(position.estimated_arrival_time().nanoseconds()) - static_cast<long long>(t_real_time))
+                    / static_cast<long long>(vehicle->get_dt_speed_profile_nanos());
+                if (index >= 0)
+                {
+                    positions.push_back(std::make_pair(index, std::make_pair(position.edge_index(), position.edge_path_index())));
+                }
+            }
+            PlannedPath trajectory_path;
+            VehicleTrajectoryPlanningState::load_other_path(received_trajectory.vehicle_id(), positions, trajectory_path);
+            trajectory_statistics.decode_ms +=
+                std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start_time).count();
+
+            start_time = std::chrono::steady_clock::now();
+            PlannedPath compact_path;
+            const bool consistent = VehicleTrajectoryPlanningState::load_other_path(received_vehicle_path, t_real_time, compact_path);
+            vehicle_path_statistics.decode_ms +=
+                std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start_time).count();
+
+            if (!consistent
+                || trajectory_path.vehicle_id != compact_path.vehicle_id
+                || trajectory_path.point_indices != compact_path.point_indices)
+            {
+                ++n_mismatches;
+            }
+
+            previous_paths.push_back(compact_path);
+        }
+
+        for (auto &vehicle : vehicles)
+        {
+            vehicle->apply_timestep();
+        }
+    }
+
+    auto print = [&](const char *name, const EncodingStatistics &statistics)
+    {
+        std::cout << name << ": " << static_cast<double>(statistics.bytes) / n_messages << " bytes per message, "
+            << static_cast<double>(statistics.bytes) / n_rounds << " bytes per round, "
+            << 1000.0 * statistics.encode_ms / n_messages << " us to encode, "
+            << 1000.0 * statistics.decode_ms / n_messages << " us to decode per message" << std::endl;
+    };
+
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "Sending the paths of " << vehicles.size() << " vehicles for " << n_rounds << " rounds" << std::endl;
+    print("Trajectory ", trajectory_statistics);
+    print("VehiclePath", vehicle_path_statistics);
+    std::cout << "Edge runs per VehiclePath: " << static_cast<double>(n_edge_runs) / n_messages << std::endl;
+    std::cout << "Paths that differ between the encodings: " << n_mismatches << std::endl;
+    return (n_mismatches == 0) ? 0 : 1;
+}
@@ -0,0 +1,202 @@
+#include <algorithm>
+#include <chrono>
+#include <ctime>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "VehicleTrajectoryPlanner.hpp"
+#include "VehicleState.hpp"
+#include "Pose2D.hpp"
+#include "lane_graph_tools.hpp"
+#include "cpm/Logging.hpp"
+#include "cpm/CommandLineReader.hpp"
+#include "cpm/init.hpp"
+#include "cpm/Writer.hpp"
+#include "cpm/ReaderAbstract.hpp"
+
+/**
+ * \file planning_round_benchmark.cpp
+ * \brief Runs --min_vehicles=INT (default 4) to --max_vehicles=INT (default 20, in steps of --vehicle_step=INT, default 4) planners
+ * in one process, each in its own thread, and measures how long a planning round takes until all planners are done
+ * (--rounds=INT per vehicle count, default 20, priority assignment strategy --hlc_mode=INT, default fca).
+ * The planners communicate via DDS, use --dds_domain=INT to run the benchmark on a local domain.
+ * Also reports the CPU time per round, which shows how much time the planners spend waiting actively.
+ * \ingroup distributed_routing
+ */
+
+//! Length of a timestep in nanoseconds, same as in simulation.cpp
+static const uint64_t dt = 400000000ull;
+
+//! Start poses of the vehicles, same as in simulation.cpp
+static const std::vector<Pose2D> start_poses( {Pose2D(3.15802,3.88862,-0.0507011), Pose2D(3.8791,3.72123,-0.497375),
+                                    Pose2D(4.35882,2.95562,-1.41334), Pose2D(4.39471,1.99965,-1.56801),
+                                    Pose2D(4.35932,1.04568,-1.72724), Pose2D(3.87964,0.278448,-2.64031),
+                                    Pose2D(3.15654,0.111178,-3.09329), Pose2D(2.24999,0.104926,3.14091),
+                                    Pose2D(1.34368,0.111556,3.08998), Pose2D(0.62071,0.278691,2.63872),
+                                    Pose2D(0.141397,1.04581,1.7287), Pose2D(0.104006,2.00092,1.57371),
+                                    Pose2D(0.141131,2.9547,1.4113), Pose2D(0.62021,3.72161,0.500138),
+                                    Pose2D(1.34238,3.88924,0.0494666), Pose2D(3.05031,2.22542,3.14112),
+                                    Pose2D(3.05088,1.77524,-0.00189507), Pose2D(2.47512,1.19944,1.57269),
+                                    Pose2D(2.02503,1.19963,-1.57305), Pose2D(1.4504,1.77449,-0.0020518)});
+
+/**
+ * \brief Create a planner with its readers and writers, starting at the given start pose
+ * \param vehicle_id ID of the vehicle, starting at 1
+ * \param vehicle_ids IDs of all vehicles, for the coupling graph
+ * \param mode Priority assignment strategy
+ * \param round_timeout_nanos See VehicleTrajectoryPlanner::set_round_timeout
+ * \return The planner, or nullptr if the start pose could not be matched to the lane graph
+ * \ingroup distributed_routing
+ */
+static std::shared_ptr<VehicleTrajectoryPlanner> create_planner(
+    uint8_t vehicle_id,
+    std::vector<uint8_t> vehicle_ids,
+    PriorityMode mode,
+    uint64_t round_timeout_nanos)
+{
+    int out_edge_index = -1;
+    int out_edge_path_index = -1;
+    if (!laneGraphTools.map_match_pose(start_poses.at(vehicle_id - 1), out_edge_index, out_edge_path_index))
+    {
+        return nullptr;
+    }
+
+    auto planner = std::make_shared<VehicleTrajectoryPlanner>(mode, vehicle_id);
+    planner->set_writer(
+        std::unique_ptr<cpm::Writer<Trajectory>>(
+            new cpm::Writer<Trajectory>("trajectory")));
+    planner->set_reader(
+        std::unique_ptr<cpm::ReaderAbstract<Trajectory>>(
+            new cpm::ReaderAbstract<Trajectory>("trajectory")));
+    planner->set_fca_reader(
+        std::unique_ptr<cpm::ReaderAbstract<FutureCollisionAssessment>>(
+            new cpm::ReaderAbstract<FutureCollisionAssessment>("futureCollisionAssessment")));
+    planner->set_fca_writer(
+        std::unique_ptr<cpm::Writer<FutureCollisionAssessment>>(
+            new cpm::Writer<FutureCollisionAssessment>("futureCollisionAssessment")));
+    planner->set_visualization_writer(
+        std::unique_ptr<cpm::Writer<Visualization>>(
+            new cpm::Writer<Visualization>("visualization")));
+    planner->set_round_timeout(round_timeout_nanos);
+
+    planner->set_coupling_graph(CouplingGraph(vehicle_ids));
+    planner->set_vehicle(
+        std::unique_ptr<VehicleTrajectoryPlanningState>(
+            new VehicleTrajectoryPlanningState(
+                vehicle_id,
+                out_edge_index,
+                out_edge_path_index,
+                dt,
+                vehicle_id
+            )
+        )
+    );
+    return planner;
+}
+
+int main(int argc, char* argv[])
+{
+    cpm::init(argc, argv);
+    cpm::Logging::Instance().set_id("planning_round_benchmark");
+
+    const int min_vehicles = std::max(1, cpm::cmd_parameter_int("min_vehicles", 4, argc, argv));
+    const int max_vehicles = std::min(static_cast<int>(start_poses.size()), cpm::cmd_parameter_int("max_vehicles", 20, argc, argv));
+    const int vehicle_step = std::max(1, cpm::cmd_parameter_int("vehicle_step", 4, argc, argv));
+    const int n_rounds = std::max(1, cpm::cmd_parameter_int("rounds", 20, argc, argv));
+    const uint64_t round_timeout_nanos = 1000000ull * cpm::cmd_parameter_int("round_timeout_ms", 10000, argc, argv);
+    const PriorityMode mode = static_cast<PriorityMode>(
+        cpm::cmd_parameter_int(
+            "hlc_mode", static_cast<int>(PriorityMode::fca), argc, argv
+        )
+    );
+
+    std::ostringstream results;
+    results << std::fixed << std::setprecision(2);
+    results << "vehicles; rounds; aborted plans; mean round [ms]; median round [ms]; max round [ms]; CPU time per round [ms]" << std::endl;
+
+    for (int n_vehicles = min_vehicles; n_vehicles <= max_vehicles; n_vehicles += vehicle_step)
+    {
+        std::vector<uint8_t> vehicle_ids;
+        for (int i = 1; i <= n_vehicles; ++i)
+        {
+            vehicle_ids.push_back(static_cast<uint8_t>(i));
+        }
+
+        std::vector<std::shared_ptr<VehicleTrajectoryPlanner>> planners;
+        for (uint8_t vehicle_id : vehicle_ids)
+        {
+            auto planner = create_planner(vehicle_id, vehicle_ids, mode, round_timeout_nanos);
+            if (!planner)
+            {
+                std::cerr << "Could not match start pose of vehicle " << static_cast<int>(vehicle_id) << std::endl;
+                return 1;
+            }
+            planners.push_back(planner);
+        }
+
+        // The planners do not wait for each other to be discovered, so messages of the first round could get lost otherwise
+        std::this_thread::sleep_for(std::chrono::seconds(2));
+
+        // Each vehicle count gets its own time range, s.t. late messages of the previous run are ignored
+        uint64_t t = 10 + static_cast<uint64_t>(n_vehicles) * 1000000000000ull;
+        std::vector<double> round_times_ms;
+        int n_aborted = 0;
+        const std::clock_t cpu_start = std::clock();
+
+        for (int round = 0; round < n_rounds; ++round)
+        {
+            std::vector<int> aborted(planners.size(), 0);
+            std::vector<std::thread> threads;
+            threads.reserve(planners.size());
+
+            auto round_start = std::chrono::steady_clock::now();
+            for (size_t i = 0; i < planners.size(); ++i)
+            {
+                threads.emplace_back([&, i] {
+                    try
+                    {
+                        aborted[i] = planners[i]->plan(t, dt) ? 0 : 1;
+                    }
+                    catch (const std::exception& e)
+                    {
+                        std::cerr << "Planner " << i + 1 << " failed: " << e.what() << std::endl;
+                        aborted[i] = 1;
+                    }
+                });
+            }
+            for (auto &thread : threads)
+            {
+                thread.join();
+            }
+            round_times_ms.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - round_start).count());
+
+            for (int is_aborted : aborted)
+            {
+                n_aborted += is_aborted;
+            }
+            t += dt;
+        }
+
+        const double cpu_ms = 1000.0 * static_cast<double>(std::clock() - cpu_start) / CLOCKS_PER_SEC;
+
+        std::vector<double> sorted_times = round_times_ms;
+        std::sort(sorted_times.begin(), sorted_times.end());
+        double mean_ms = 0.0;
+        for (double time_ms : sorted_times)
+        {
+            mean_ms += time_ms;
+        }
+        mean_ms /= static_cast<double>(sorted_times.size());
+
+        results << n_vehicles << "; " << n_rounds << "; " << n_aborted << "; " << mean_ms << "; "
+            << sorted_times.at(sorted_times.size() / 2) << "; " << sorted_times.back() << "; " << cpu_ms / n_rounds << std::endl;
+    }
+
+    // The planners write a lot to stdout, so the results are printed at the end
+    std::cout << std::endl << "Planning round times:" << std::endl << results.str();
+    return 0;
+}
@@ -0,0 +1,134 @@
+// MIT License
+//
+// Copyright (c) 2020 Lehrstuhl Informatik 11 - RWTH Aachen University
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// This file is part of cpm_lab.
+//
+// Author: i11 - Embedded Software, RWTH Aachen University
+
+#include "lane_graph_tools.hpp"
+#include "VehicleTrajectoryPlanningState.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <vector>
+
+/**
+ * \file planning_step_benchmark.cpp
+ * \brief Plans 20 vehicles on lane_graph_full with static priorities (vehicle 1 first), like the dynamic_priorities HLCs
+ * would, but sequentially in one thread and without DDS. Each vehicle avoids the trajectories of the vehicles that planned before it,
+ * converted to the format the planners receive (see VehicleTrajectoryPlanner::read_vehicles).
+ * Start poses and path seeds are fixed, so the result is deterministic: A checksum of all speed profiles is printed,
+ * which must not change when only the performance of the planning is changed.
+ * The number of planning steps can be given as first argument (default 50).
+ * \ingroup distributed_routing
+ */
+
+//! Length of a timestep in nanoseconds, same as in simulation.cpp
+static const uint64_t dt = 400000000ull;
+
+//! Start poses of the vehicles, same as in simulation.cpp
+static const std::vector<Pose2D> start_poses( {Pose2D(3.15802,3.88862,-0.0507011), Pose2D(3.8791,3.72123,-0.497375),
+                                    Pose2D(4.35882,2.95562,-1.41334), Pose2D(4.39471,1.99965,-1.56801),
+                                    Pose2D(4.35932,1.04568,-1.72724), Pose2D(3.87964,0.278448,-2.64031),
+                                    Pose2D(3.15654,0.111178,-3.09329), Pose2D(2.24999,0.104926,3.14091),
+                                    Pose2D(1.34368,0.111556,3.08998), Pose2D(0.62071,0.278691,2.63872),
+                                    Pose2D(0.141397,1.04581,1.7287), Pose2D(0.104006,2.00092,1.57371),
+                                    Pose2D(0.141131,2.9547,1.4113), Pose2D(0.62021,3.72161,0.500138),
+                                    Pose2D(1.34238,3.88924,0.0494666), Pose2D(3.05031,2.22542,3.14112),
+                                    Pose2D(3.05088,1.77524,-0.00189507), Pose2D(2.47512,1.19944,1.57269),
+                                    Pose2D(2.02503,1.19963,-1.57305), Pose2D(1.4504,1.77449,-0.0020518)});
+
+int main(int argc, char *argv[])
+{
+    const int n_planning_steps = (argc > 1) ? std::max(1, atoi(argv[1])) : 50;
+
+    std::vector<std::unique_ptr<VehicleTrajectoryPlanningState>> vehicles;
+    for (size_t i = 0; i < start_poses.size(); ++i)
+    {
+        const uint8_t vehicle_id = static_cast<uint8_t>(i + 1);
+        int edge_index = -1;
+        int edge_path_index = -1;
+        if (!laneGraphTools.map_match_pose(start_poses[i], edge_index, edge_path_index))
+        {
+            std::cerr << "Could not match start pose of vehicle " << static_cast<int>(vehicle_id) << std::endl;
+            return 1;
+        }
+        vehicles.emplace_back(new VehicleTrajectoryPlanningState(vehicle_id, edge_index, edge_path_index, dt, vehicle_id));
+    }
+
+    double avoid_collisions_ms = 0.0;
+    double max_step_ms = 0.0;
+    int n_infeasible = 0;
+    uint64_t checksum = 1469598103934665603ull;
+
+    for (int step = 0; step < n_planning_steps; ++step)
+    {
+        // Trajectories of the vehicles that already planned in this step, as received by read_vehicles
+        std::map<uint8_t, std::vector<std::pair<size_t, std::pair<size_t, size_t>>>> previous_vehicles;
+        double step_ms = 0.0;
+
+        for (auto &vehicle : vehicles)
+        {
+            vehicle->save_speed_profile();
+            vehicle->reset_speed_profile();
+
+            auto start_time = std::chrono::steady_clock::now();
+            if (!vehicle->avoid_collisions(previous_vehicles))
+            {
+                ++n_infeasible;
+                vehicle->revert_speed_profile();
+            }
+            step_ms += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start_time).count();
+
+            Trajectory trajectory;
+            vehicle->get_lane_graph_positions(trajectory, false);
+            auto &buffer = previous_vehicles[vehicle->get_vehicle_id()];
+            for (size_t i = 0; i < trajectory.lane_graph_positions().size(); ++i)
+            {
+                const auto &position = trajectory.lane_graph_positions()[i];
+                buffer.push_back(std::make_pair(i, std::make_pair(position.edge_index(), position.edge_path_index())));
+
+                checksum = (checksum ^ (position.edge_index() * 1000 + position.edge_path_index())) * 1099511628211ull;
+            }
+        }
+
+        for (auto &vehicle : vehicles)
+        {
+            vehicle->apply_timestep();
+        }
+
+        avoid_collisions_ms += step_ms;
+        max_step_ms = std::max(max_step_ms, step_ms);
+    }
+
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "Planning " << vehicles.size() << " vehicles for " << n_planning_steps << " steps: "
+        << "avoid_collisions took " << avoid_collisions_ms / n_planning_steps << " ms per step on average, "
+        << max_step_ms << " ms max" << std::endl;
+    std::cout << "Infeasible plans: " << n_infeasible << std::endl;
+    std::cout << "Checksum of all planned paths: " << std::hex << checksum << std::dec << std::endl;
+    return 0;
+}
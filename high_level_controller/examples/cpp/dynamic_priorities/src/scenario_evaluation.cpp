@@ -0,0 +1,238 @@
+// MIT License
+//
+// Copyright (c) 2020 Lehrstuhl Informatik 11 - RWTH Aachen University
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// This file is part of cpm_lab.
+//
+// Author: i11 - Embedded Software, RWTH Aachen University
+
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "ScenarioEvaluation.hpp"
+#include "cpm/CommandLineReader.hpp"
+#include "cpm/Logging.hpp"
+#include "cpm/ThreadPool.hpp"
+#include "cpm/init.hpp"
+
+/**
+ * \file scenario_evaluation.cpp
+ * \brief Evaluates the priority assignment strategies like eval.sh, but in one process and without DDS and timers (see ScenarioEvaluation).
+ * Runs every combination of --hlc_modes=INTS (default 0,1,2, as eval.sh; 3 = vertex ordering is not deterministic yet), --vehicles=INTS (default 4,8,12,16,20) and --seeds=INTS
+ * (default 101,...,105) for --steps=INT timesteps (default 100), --jobs=INT scenarios in parallel (default: number of cores),
+ * and writes one line per scenario to the CSV file --output=STRING (default scenario_evaluation.csv).
+ * All columns except the timings are deterministic. If a previous output is given with --reference=STRING, these columns are
+ * compared to it and the program returns 1 if any scenario differs, s.t. it can be used as a regression test.
+ * With --compact_paths=true, the planners send their paths as VehiclePath instead of Trajectory messages, which must give the same results.
+ * The planners write a lot to stdout, use --verbose=true to see it.
+ * \ingroup distributed_routing
+ */
+
+//! Length of a timestep in nanoseconds, same as in simulation.cpp
+static const uint64_t dt = 400000000ull;
+
+//! Start poses of the vehicles, same as in simulation.cpp
+static const std::vector<Pose2D> start_poses( {Pose2D(3.15802,3.88862,-0.0507011), Pose2D(3.8791,3.72123,-0.497375),
+                                    Pose2D(4.35882,2.95562,-1.41334), Pose2D(4.39471,1.99965,-1.56801),
+                                    Pose2D(4.35932,1.04568,-1.72724), Pose2D(3.87964,0.278448,-2.64031),
+                                    Pose2D(3.15654,0.111178,-3.09329), Pose2D(2.24999,0.104926,3.14091),
+                                    Pose2D(1.34368,0.111556,3.08998), Pose2D(0.62071,0.278691,2.63872),
+                                    Pose2D(0.141397,1.04581,1.7287), Pose2D(0.104006,2.00092,1.57371),
+                                    Pose2D(0.141131,2.9547,1.4113), Pose2D(0.62021,3.72161,0.500138),
+                                    Pose2D(1.34238,3.88924,0.0494666), Pose2D(3.05031,2.22542,3.14112),
+                                    Pose2D(3.05088,1.77524,-0.00189507), Pose2D(2.47512,1.19944,1.57269),
+                                    Pose2D(2.02503,1.19963,-1.57305), Pose2D(1.4504,1.77449,-0.0020518)});
+
+//! Columns of EvaluationResult::to_csv that depend on the wall clock time (mean_plan_ms, max_plan_ms, mean_round_ms)
+static const size_t first_timing_column = 15;
+//! See first_timing_column
+static const size_t last_timing_column = 17;
+
+/**
+ * \brief Split a CSV line at ';'
+ * \ingroup distributed_routing
+ */
+static std::vector<std::string> split_csv_line(const std::string &line)
+{
+    std::vector<std::string> columns;
+    std::stringstream stream(line);
+    std::string column;
+    while (std::getline(stream, column, ';'))
+    {
+        columns.push_back(column);
+    }
+    return columns;
+}
+
+/**
+ * \brief Key of a scenario in a CSV file: mode, vehicles, seed and steps
+ * \ingroup distributed_routing
+ */
+static std::string get_scenario_key(const std::vector<std::string> &columns)
+{
+    return columns.at(0) + ";" + columns.at(1) + ";" + columns.at(2) + ";" + columns.at(3);
+}
+
+/**
+ * \brief Compare the deterministic columns of the results to a previous output of this program
+ * \ingroup distributed_routing
+ * \param reference_file_path Path of the previous output
+ * \param results The results of this run
+ * \return False if the file could not be read or a scenario differs
+ */
+static bool compare_to_reference(const std::string &reference_file_path, const std::vector<EvaluationResult> &results)
+{
+    std::ifstream reference_file(reference_file_path);
+    if (!reference_file.is_open())
+    {
+        std::cerr << "Could not read " << reference_file_path << std::endl;
+        return false;
+    }
+
+    std::map<std::string, std::vector<std::string>> reference_rows;
+    std::string line;
+    std::getline(reference_file, line); // header
+    while (std::getline(reference_file, line))
+    {
+        auto columns = split_csv_line(line);
+        if (columns.size() > last_timing_column)
+        {
+            reference_rows[get_scenario_key(columns)] = columns;
+        }
+    }
+
+    bool is_equal = true;
+    for (const EvaluationResult &result : results)
+    {
+        const auto columns = split_csv_line(result.to_csv());
+        const auto reference_row = reference_rows.find(get_scenario_key(columns));
+        if (reference_row == reference_rows.end())
+        {
+            std::cerr << "Scenario " << get_scenario_key(columns) << " is not in the reference" << std::endl;
+            is_equal = false;
+            continue;
+        }
+
+        for (size_t i = 0; i < columns.size(); ++i)
+        {
+            const bool is_timing = i >= first_timing_column && i <= last_timing_column;
+            const std::string reference_value = (i < reference_row->second.size()) ? reference_row->second[i] : "";
+            if (!is_timing && columns[i] != reference_value)
+            {
+                std::cerr << "Scenario " << get_scenario_key(columns) << ": column " << i << " is " << columns[i]
+                    << ", reference " << reference_value << std::endl;
+                is_equal = false;
+            }
+        }
+    }
+    return is_equal;
+}
+
+int main(int argc, char *argv[])
+{
+    cpm::init(argc, argv);
+    cpm::Logging::Instance().set_id("scenario_evaluation");
+
+    const std::vector<int> modes = cpm::cmd_parameter_ints("hlc_modes", {0, 1, 2}, argc, argv);
+    const std::vector<int> vehicle_counts = cpm::cmd_parameter_ints("vehicles", {4, 8, 12, 16, 20}, argc, argv);
+    const std::vector<int> seeds = cpm::cmd_parameter_ints("seeds", {101, 102, 103, 104, 105}, argc, argv);
+    const int n_steps = std::max(1, cpm::cmd_parameter_int("steps", 100, argc, argv));
+    const int n_jobs = std::max(0, cpm::cmd_parameter_int("jobs", 0, argc, argv));
+    const uint64_t round_timeout_nanos = 1000000ull * cpm::cmd_parameter_int("round_timeout_ms", 10000, argc, argv);
+    const std::string output_file_path = cpm::cmd_parameter_string("output", "scenario_evaluation.csv", argc, argv);
+    const std::string reference_file_path = cpm::cmd_parameter_string("reference", "", argc, argv);
+    const bool compact_paths = cpm::cmd_parameter_bool("compact_paths", false, argc, argv);
+    const bool verbose = cpm::cmd_parameter_bool("verbose", false, argc, argv);
+
+    std::vector<EvaluationScenario> scenarios;
+    for (int mode : modes)
+    {
+        for (int n_vehicles : vehicle_counts)
+        {
+            for (int seed : seeds)
+            {
+                EvaluationScenario scenario;
+                scenario.mode = static_cast<PriorityMode>(mode);
+                scenario.n_vehicles = n_vehicles;
+                scenario.seed = seed;
+                scenario.n_steps = n_steps;
+                scenario.compact_paths = compact_paths;
+                scenarios.push_back(scenario);
+            }
+        }
+    }
+
+    // Without a stream buffer, the output of the planners is discarded before it is formatted
+    std::streambuf *cout_buffer = std::cout.rdbuf();
+    if (!verbose)
+    {
+        std::cout.rdbuf(nullptr);
+    }
+
+    const ScenarioEvaluation evaluation(start_poses, dt, round_timeout_nanos);
+    std::vector<EvaluationResult> results(scenarios.size());
+    std::mutex progress_mutex;
+    size_t n_done = 0;
+    auto start_time = std::chrono::steady_clock::now();
+
+    cpm::ThreadPool thread_pool(n_jobs);
+    thread_pool.parallel_for(scenarios.size(), [&](size_t i) {
+        results[i] = evaluation.run(scenarios[i]);
+
+        std::lock_guard<std::mutex> lock(progress_mutex);
+        ++n_done;
+        std::cerr << "Scenario " << n_done << "/" << scenarios.size() << " done: " << results[i].to_csv() << std::endl;
+    });
+
+    std::cout.rdbuf(cout_buffer);
+    std::cout << "Evaluated " << scenarios.size() << " scenarios with " << thread_pool.size() << " jobs in "
+        << std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count() << " s" << std::endl;
+
+    std::ofstream output_file(output_file_path);
+    output_file << EvaluationResult::csv_header() << std::endl;
+    for (const EvaluationResult &result : results)
+    {
+        output_file << result.to_csv() << std::endl;
+    }
+    if (!output_file)
+    {
+        std::cerr << "Could not write " << output_file_path << std::endl;
+        return 1;
+    }
+    std::cout << "Results written to " << output_file_path << std::endl;
+
+    if (!reference_file_path.empty())
+    {
+        if (!compare_to_reference(reference_file_path, results))
+        {
+            return 1;
+        }
+        std::cout << "All scenarios match " << reference_file_path << std::endl;
+    }
+    return 0;
+}
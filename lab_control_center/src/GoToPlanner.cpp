@@ -82,10 +82,10 @@ void GoToPlanner::go_to_poses(
             const auto vehicle_id = entry.first;
             const auto& vehicle_timeseries = entry.second;
 
-            // if(!vehicle_timeseries.at("pose_x")->has_new_data(1.0)) continue;
-            double x = vehicle_timeseries.at("pose_x")->get_latest_value();
-            double y = vehicle_timeseries.at("pose_y")->get_latest_value();
-            double yaw = vehicle_timeseries.at("pose_yaw")->get_latest_value();
+            // if(!vehicle_timeseries.at(VehicleDataField::pose_x)->has_new_data(1.0)) continue;
+            double x = vehicle_timeseries.at(VehicleDataField::pose_x)->get_latest_value();
+            double y = vehicle_timeseries.at(VehicleDataField::pose_y)->get_latest_value();
+            double yaw = vehicle_timeseries.at(VehicleDataField::pose_yaw)->get_latest_value();
             vehicle_poses.push_back(x);
             vehicle_poses.push_back(y);
             vehicle_poses.push_back(yaw*180.0/M_PI);
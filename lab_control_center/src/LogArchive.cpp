@@ -0,0 +1,733 @@
+#include "LogArchive.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+/**
+ * \file LogArchive.cpp
+ * \ingroup lcc
+ */
+
+/**
+ * \brief Trigram of three bytes, packed into the lower 24 bits
+ * \ingroup lcc
+ */
+static uint32_t make_trigram(const char* c)
+{
+    return (static_cast<uint32_t>(static_cast<unsigned char>(c[0])) << 16)
+        | (static_cast<uint32_t>(static_cast<unsigned char>(c[1])) << 8)
+        | static_cast<uint32_t>(static_cast<unsigned char>(c[2]));
+}
+
+/**
+ * \brief Number of characters of an ECMAScript escape sequence after the backslash, e.g. 3 for \x41, 5 for \u0041,
+ * 2 for \cJ and the number of digits for \0 and back references like \12
+ * \param pattern The regex
+ * \param i Position of the backslash in pattern
+ * \ingroup lcc
+ */
+static size_t escape_length(const string& pattern, size_t i)
+{
+    if (i + 1 >= pattern.size()) return 0;
+
+    size_t length = 1;
+    switch (pattern[i + 1])
+    {
+        case 'x':
+            length = 3;
+            break;
+        case 'u':
+            length = 5;
+            break;
+        case 'c':
+            length = 2;
+            break;
+        default:
+            if (std::isdigit(static_cast<unsigned char>(pattern[i + 1])))
+            {
+                while (i + 1 + length < pattern.size() && std::isdigit(static_cast<unsigned char>(pattern[i + 1 + length]))) ++length;
+            }
+            break;
+    }
+    return std::min(length, pattern.size() - i - 1);
+}
+
+/**
+ * \brief Finds the literal strings that every match of an ECMAScript regex must contain. Conservative: Parts that
+ * are hard to analyze (groups, alternatives, escapes, character classes) are ignored, so the result may be empty.
+ * \param pattern The regex
+ * \param out_literals Required literals (each non-empty)
+ * \return True if the whole pattern is a plain literal without special characters (then a match is a substring match)
+ * \ingroup lcc
+ */
+static bool required_literals(const string& pattern, vector<string>& out_literals)
+{
+    out_literals.clear();
+
+    //With alternatives, no part of the pattern is required
+    if (pattern.find('|') != string::npos)
+    {
+        return false;
+    }
+
+    bool is_literal = true;
+    string current;
+    auto flush = [&](){
+        if (current.size() > 0) out_literals.push_back(current);
+        current.clear();
+    };
+
+    for (size_t i = 0; i < pattern.size(); ++i)
+    {
+        const char c = pattern[i];
+        switch (c)
+        {
+            case '*':
+            case '?':
+            case '{':
+                //The previous character is optional
+                if (current.size() > 0) current.pop_back();
+                flush();
+                is_literal = false;
+                if (c == '{')
+                {
+                    while (i < pattern.size() && pattern[i] != '}') ++i;
+                }
+                break;
+            case '+':
+                //The previous character is required once
+                flush();
+                is_literal = false;
+                break;
+            case '\\':
+                //The escaped character(s) are not part of the literal, skip the whole escape sequence
+                flush();
+                is_literal = false;
+                i += escape_length(pattern, i);
+                break;
+            case '[':
+                flush();
+                is_literal = false;
+                //Skip the character class, ']' directly after '[' or '[^' is part of the class
+                ++i;
+                if (i < pattern.size() && pattern[i] == '^') ++i;
+                if (i < pattern.size() && pattern[i] == ']') ++i;
+                while (i < pattern.size() && pattern[i] != ']')
+                {
+                    if (pattern[i] == '\\') ++i;
+                    ++i;
+                }
+                break;
+            case '(':
+            {
+                //Groups may be optional (quantifier after the group), skip them
+                flush();
+                is_literal = false;
+                int depth = 1;
+                ++i;
+                while (i < pattern.size() && depth > 0)
+                {
+                    if (pattern[i] == '\\') ++i;
+                    else if (pattern[i] == '(') ++depth;
+                    else if (pattern[i] == ')') --depth;
+                    if (depth > 0) ++i;
+                }
+                break;
+            }
+            case '^':
+            case '$':
+            case '.':
+            case ')':
+            case ']':
+            case '}':
+                flush();
+                is_literal = false;
+                break;
+            default:
+                current += c;
+                break;
+        }
+    }
+    flush();
+
+    return is_literal;
+}
+
+/**
+ * \brief Search string, compiled once per search
+ * \ingroup lcc
+ */
+struct LogMatcher
+{
+    //! The regex
+    std::regex regex;
+    //! Whether the regex is a plain literal, then literals contains the whole pattern
+    bool is_literal = false;
+    //! Literals that each match must contain
+    vector<string> literals;
+    //! Distinct trigrams of the literals
+    vector<uint32_t> trigrams;
+
+    /**
+     * \brief Compiles the regex (throws std::regex_error) and finds required literals and trigrams
+     * \param pattern The regex
+     */
+    explicit LogMatcher(const string& pattern)
+    :regex(pattern)
+    {
+        is_literal = required_literals(pattern, literals);
+        for (const string& literal : literals)
+        {
+            for (size_t k = 0; k + 3 <= literal.size(); ++k)
+            {
+                trigrams.push_back(make_trigram(literal.data() + k));
+            }
+        }
+        std::sort(trigrams.begin(), trigrams.end());
+        trigrams.erase(std::unique(trigrams.begin(), trigrams.end()), trigrams.end());
+    }
+
+    /**
+     * \brief Same result as std::regex_search(text, regex), but faster if the text does not contain the literals
+     * \param text The text
+     */
+    bool matches(const string& text) const
+    {
+        for (const string& literal : literals)
+        {
+            if (text.find(literal) == string::npos) return false;
+        }
+        return is_literal || std::regex_search(text, regex);
+    }
+};
+
+/**
+ * \brief Text of a log that filter_type refers to, as in the previous (linear) search
+ * \ingroup lcc
+ */
+static string filter_text(const string& id, const string& content, uint64_t stamp, LogArchive::FilterType filter_type)
+{
+    switch (filter_type)
+    {
+        case LogArchive::ID:
+            return id;
+        case LogArchive::Content:
+            return content;
+        case LogArchive::Timestamp:
+            return to_string(stamp);
+        default:
+            return id + content + to_string(stamp);
+    }
+}
+
+/**
+ * \brief Appends raw bytes of a value to a buffer
+ * \ingroup lcc
+ */
+template<typename T> static void append_bytes(string& buffer, const T& value)
+{
+    buffer.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+/**
+ * \brief Reads length bytes at offset, handles partial reads
+ * \return False if not all bytes could be read
+ * \ingroup lcc
+ */
+static bool read_fully(int fd, uint64_t offset, char* data, size_t length)
+{
+    while (length > 0)
+    {
+        const ssize_t n = ::pread(fd, data, length, static_cast<off_t>(offset));
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        data += n;
+        offset += static_cast<uint64_t>(n);
+        length -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+/**
+ * \brief Writes length bytes at offset, handles partial writes
+ * \return False on error
+ * \ingroup lcc
+ */
+static bool write_fully(int fd, uint64_t offset, const char* data, size_t length)
+{
+    while (length > 0)
+    {
+        const ssize_t n = ::pwrite(fd, data, length, static_cast<off_t>(offset));
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        data += n;
+        offset += static_cast<uint64_t>(n);
+        length -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+/**
+ * \brief Approximate memory usage of a log in bytes
+ * \ingroup lcc
+ */
+static size_t log_memory_usage(const Log& log)
+{
+    return sizeof(Log) + log.id().capacity() + log.content().capacity();
+}
+
+LogArchive::SpillFile::~SpillFile()
+{
+    if (fd >= 0) ::close(fd);
+}
+
+size_t LogArchive::SpilledSegment::memory_usage() const
+{
+    size_t bytes = sizeof(SpilledSegment)
+        + record_offsets.capacity() * sizeof(uint32_t)
+        + stamps.capacity() * sizeof(uint64_t)
+        + levels.capacity() * sizeof(unsigned short)
+        + id_indices.capacity() * sizeof(uint16_t)
+        + trigrams.capacity() * sizeof(uint32_t)
+        + posting_offsets.capacity() * sizeof(uint32_t);
+    for (const string& id : ids) bytes += sizeof(string) + id.capacity();
+    return bytes;
+}
+
+LogArchive::LogArchive(const string& _spill_filename, size_t _segment_size, size_t _memory_segments)
+:segment_size(std::max<size_t>(1, std::min(_segment_size, max_segment_size)))
+,memory_segments(_memory_segments)
+,spill_filename(_spill_filename)
+{
+    active_segment.reserve(segment_size);
+    open_spill_file();
+}
+
+LogArchive::~LogArchive()
+{
+    //The spill file is only a cache for the search, all logs are also written to the CSV file by LogStorage
+    ::unlink(spill_filename.c_str());
+}
+
+void LogArchive::open_spill_file()
+{
+    //Unlink first: A search that still reads the old file keeps it open until it finishes
+    ::unlink(spill_filename.c_str());
+
+    auto file = make_shared<SpillFile>();
+    file->fd = ::open(spill_filename.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (file->fd < 0)
+    {
+        cerr << "LogArchive: Could not open " << spill_filename << " (" << std::strerror(errno)
+            << "), only the newest logs can be searched" << endl;
+    }
+    spill_file = file;
+    spill_size = 0;
+}
+
+shared_ptr<const LogArchive::SpilledSegment> LogArchive::spill(const MemorySegment& segment)
+{
+    if (spill_file->fd < 0)
+    {
+        return nullptr;
+    }
+
+    auto index = make_shared<SpilledSegment>();
+    index->file = spill_file;
+    index->number = segment.number;
+    index->file_offset = spill_size;
+
+    const size_t n = segment.logs.size();
+    index->record_offsets.reserve(n + 1);
+    index->stamps.reserve(n);
+    index->levels.reserve(n);
+    index->id_indices.reserve(n);
+
+    //Records: stamp, level, length of id and content, id, content
+    string buffer;
+    vector<uint64_t> trigram_entries; //trigram << 16 | entry
+    for (size_t i = 0; i < n; ++i)
+    {
+        const Log& log = segment.logs[i];
+        const string& id = log.id();
+        const string& content = log.content();
+        const uint64_t stamp = log.stamp().nanoseconds();
+        const unsigned short level = log.log_level();
+
+        index->record_offsets.push_back(static_cast<uint32_t>(buffer.size()));
+        index->stamps.push_back(stamp);
+        index->levels.push_back(level);
+
+        //Segments usually contain few different IDs
+        auto id_it = std::find(index->ids.begin(), index->ids.end(), id);
+        if (id_it == index->ids.end())
+        {
+            index->ids.push_back(id);
+            id_it = index->ids.end() - 1;
+        }
+        index->id_indices.push_back(static_cast<uint16_t>(id_it - index->ids.begin()));
+
+        append_bytes(buffer, stamp);
+        append_bytes(buffer, level);
+        append_bytes(buffer, static_cast<uint32_t>(id.size()));
+        append_bytes(buffer, static_cast<uint32_t>(content.size()));
+        buffer.append(id);
+        buffer.append(content);
+
+        for (size_t k = 0; k + 3 <= content.size(); ++k)
+        {
+            trigram_entries.push_back((static_cast<uint64_t>(make_trigram(content.data() + k)) << 16) | i);
+        }
+    }
+    index->record_offsets.push_back(static_cast<uint32_t>(buffer.size()));
+    index->postings_offset = index->file_offset + buffer.size();
+
+    //Posting lists: entries are sorted within each trigram because of the sort order
+    std::sort(trigram_entries.begin(), trigram_entries.end());
+    trigram_entries.erase(std::unique(trigram_entries.begin(), trigram_entries.end()), trigram_entries.end());
+    uint32_t posting_bytes = 0;
+    for (size_t k = 0; k < trigram_entries.size(); ++k)
+    {
+        const uint32_t trigram = static_cast<uint32_t>(trigram_entries[k] >> 16);
+        if (index->trigrams.empty() || index->trigrams.back() != trigram)
+        {
+            index->trigrams.push_back(trigram);
+            index->posting_offsets.push_back(posting_bytes);
+        }
+        append_bytes(buffer, static_cast<uint16_t>(trigram_entries[k] & 0xFFFF));
+        posting_bytes += sizeof(uint16_t);
+    }
+    index->posting_offsets.push_back(posting_bytes);
+    index->trigrams.shrink_to_fit();
+    index->posting_offsets.shrink_to_fit();
+    index->ids.shrink_to_fit();
+
+    if (!write_fully(spill_file->fd, index->file_offset, buffer.data(), buffer.size()))
+    {
+        cerr << "LogArchive: Could not write to " << spill_filename << " (" << std::strerror(errno) << ")" << endl;
+        return nullptr;
+    }
+    spill_size += buffer.size();
+
+    return index;
+}
+
+void LogArchive::read_records(const SpilledSegment& segment, size_t first_entry, size_t last_entry, vector<Log>& out_logs) const
+{
+    out_logs.clear();
+    const uint32_t begin = segment.record_offsets.at(first_entry);
+    const uint32_t end = segment.record_offsets.at(last_entry + 1);
+    string buffer(end - begin, '\0');
+    if (!read_fully(segment.file->fd, segment.file_offset + begin, &buffer[0], buffer.size()))
+    {
+        return;
+    }
+
+    out_logs.reserve(last_entry - first_entry + 1);
+    const size_t header_size = sizeof(uint64_t) + sizeof(unsigned short) + 2 * sizeof(uint32_t);
+    for (size_t i = first_entry; i <= last_entry; ++i)
+    {
+        const size_t offset = segment.record_offsets[i] - begin;
+        uint32_t id_size = 0;
+        uint32_t content_size = 0;
+        std::memcpy(&id_size, buffer.data() + offset + sizeof(uint64_t) + sizeof(unsigned short), sizeof(uint32_t));
+        std::memcpy(&content_size, buffer.data() + offset + sizeof(uint64_t) + sizeof(unsigned short) + sizeof(uint32_t), sizeof(uint32_t));
+        if (offset + header_size + id_size + content_size > buffer.size())
+        {
+            out_logs.clear();
+            return;
+        }
+
+        const char* strings = buffer.data() + offset + header_size;
+        out_logs.emplace_back(
+            string(strings, id_size),
+            string(strings + id_size, content_size),
+            TimeStamp(segment.stamps[i]),
+            segment.levels[i]
+        );
+    }
+}
+
+void LogArchive::read_postings(const SpilledSegment& segment, size_t trigram_index, vector<uint16_t>& out_entries) const
+{
+    const uint32_t begin = segment.posting_offsets.at(trigram_index);
+    const uint32_t end = segment.posting_offsets.at(trigram_index + 1);
+    out_entries.resize((end - begin) / sizeof(uint16_t));
+    if (!read_fully(segment.file->fd, segment.postings_offset + begin, reinterpret_cast<char*>(out_entries.data()), end - begin))
+    {
+        out_entries.clear();
+    }
+}
+
+void LogArchive::append(const vector<Log>& logs)
+{
+    std::lock_guard<std::mutex> writer_lock(writer_mutex);
+
+    for (const Log& log : logs)
+    {
+        shared_ptr<const MemorySegment> completed;
+        {
+            std::lock_guard<std::mutex> lock(storage_mutex);
+            active_segment.push_back(log);
+            ++total_count;
+
+            if (active_segment.size() >= segment_size)
+            {
+                auto segment = make_shared<MemorySegment>();
+                segment->number = active_segment_number++;
+                segment->logs.swap(active_segment);
+                active_segment.reserve(segment_size);
+                memory_ring.push_back(segment);
+                completed = segment;
+            }
+        }
+
+        if (completed)
+        {
+            //Write the segment without holding the storage mutex, it can be searched in memory meanwhile
+            auto spilled = spill(*completed);
+
+            std::lock_guard<std::mutex> lock(storage_mutex);
+            if (spilled) spilled_segments.push_back(spilled);
+            while (memory_ring.size() > memory_segments)
+            {
+                memory_ring.pop_front();
+            }
+        }
+    }
+}
+
+vector<Log> LogArchive::get_recent_logs(size_t log_amount, unsigned short log_level) const
+{
+    std::lock_guard<std::mutex> lock(storage_mutex);
+    vector<Log> log_copy;
+
+    //Newest first: active segment, then the memory ring from the back
+    for (auto back_it = active_segment.rbegin(); back_it != active_segment.rend() && log_copy.size() < log_amount; ++back_it)
+    {
+        if (back_it->log_level() <= log_level) log_copy.push_back(*back_it);
+    }
+    for (auto segment_it = memory_ring.rbegin(); segment_it != memory_ring.rend() && log_copy.size() < log_amount; ++segment_it)
+    {
+        const vector<Log>& logs = (*segment_it)->logs;
+        for (auto back_it = logs.rbegin(); back_it != logs.rend() && log_copy.size() < log_amount; ++back_it)
+        {
+            if (back_it->log_level() <= log_level) log_copy.push_back(*back_it);
+        }
+    }
+
+    return log_copy;
+}
+
+vector<Log> LogArchive::get_memory_logs(unsigned short log_level) const
+{
+    std::lock_guard<std::mutex> lock(storage_mutex);
+    vector<Log> log_copy;
+
+    for (const auto& segment : memory_ring)
+    {
+        for (const Log& log : segment->logs)
+        {
+            if (log.log_level() <= log_level) log_copy.push_back(log);
+        }
+    }
+    for (const Log& log : active_segment)
+    {
+        if (log.log_level() <= log_level) log_copy.push_back(log);
+    }
+
+    return log_copy;
+}
+
+vector<Log> LogArchive::search(const string& filter_value, FilterType filter_type, unsigned short log_level,
+    size_t max_results, const std::atomic_bool& continue_search) const
+{
+    const LogMatcher matcher(filter_value);
+
+    //Snapshot: the active segment is copied (it is small), completed segments are immutable and shared
+    vector<Log> active_copy;
+    vector<shared_ptr<const MemorySegment>> ring_copy;
+    vector<shared_ptr<const SpilledSegment>> spilled_copy;
+    uint64_t oldest_memory_segment;
+    {
+        std::lock_guard<std::mutex> lock(storage_mutex);
+        active_copy = active_segment;
+        ring_copy.assign(memory_ring.begin(), memory_ring.end());
+        spilled_copy = spilled_segments;
+        oldest_memory_segment = ring_copy.empty() ? active_segment_number : ring_copy.front()->number;
+    }
+
+    //Results are collected from newest to oldest
+    vector<Log> search_result;
+    auto done = [&](){
+        return search_result.size() >= max_results || !continue_search.load();
+    };
+
+    //Logs in memory: linear search, newest first
+    auto search_logs = [&](const vector<Log>& logs){
+        for (auto back_it = logs.rbegin(); back_it != logs.rend() && !done(); ++back_it)
+        {
+            if (back_it->log_level() <= log_level
+                && matcher.matches(filter_text(back_it->id(), back_it->content(), back_it->stamp().nanoseconds(), filter_type)))
+            {
+                search_result.push_back(*back_it);
+            }
+        }
+    };
+
+    search_logs(active_copy);
+    for (auto segment_it = ring_copy.rbegin(); segment_it != ring_copy.rend() && !done(); ++segment_it)
+    {
+        search_logs((*segment_it)->logs);
+    }
+
+    //Spilled segments that are no longer in memory, newest first
+    vector<size_t> candidates;
+    vector<uint16_t> postings;
+    vector<uint16_t> intersection;
+    vector<Log> records;
+    for (auto segment_it = spilled_copy.rbegin(); segment_it != spilled_copy.rend() && !done(); ++segment_it)
+    {
+        const SpilledSegment& segment = **segment_it;
+        if (segment.number >= oldest_memory_segment) continue;
+
+        //Candidates, from the in-memory index (log level, ID, time stamp) and the trigram index (content)
+        candidates.clear();
+        const size_t n = segment.stamps.size();
+        bool check_records = true;
+        if (filter_type == ID)
+        {
+            vector<bool> id_matches(segment.ids.size());
+            for (size_t k = 0; k < segment.ids.size(); ++k) id_matches[k] = matcher.matches(segment.ids[k]);
+            for (size_t i = 0; i < n; ++i)
+            {
+                if (segment.levels[i] <= log_level && id_matches[segment.id_indices[i]]) candidates.push_back(i);
+            }
+            check_records = false;
+        }
+        else if (filter_type == Timestamp)
+        {
+            for (size_t i = 0; i < n; ++i)
+            {
+                if (segment.levels[i] <= log_level && matcher.matches(to_string(segment.stamps[i]))) candidates.push_back(i);
+            }
+            check_records = false;
+        }
+        else if (filter_type == Content && matcher.trigrams.size() > 0)
+        {
+            bool first = true;
+            bool skip_segment = false;
+            for (uint32_t trigram : matcher.trigrams)
+            {
+                auto trigram_it = std::lower_bound(segment.trigrams.begin(), segment.trigrams.end(), trigram);
+                if (trigram_it == segment.trigrams.end() || *trigram_it != trigram)
+                {
+                    skip_segment = true;
+                    break;
+                }
+
+                read_postings(segment, static_cast<size_t>(trigram_it - segment.trigrams.begin()), postings);
+                if (first)
+                {
+                    intersection.swap(postings);
+                    first = false;
+                }
+                else
+                {
+                    vector<uint16_t> merged;
+                    std::set_intersection(intersection.begin(), intersection.end(), postings.begin(), postings.end(),
+                        std::back_inserter(merged));
+                    intersection.swap(merged);
+                }
+                if (intersection.empty())
+                {
+                    skip_segment = true;
+                    break;
+                }
+            }
+            if (skip_segment) continue;
+
+            for (uint16_t i : intersection)
+            {
+                if (segment.levels[i] <= log_level) candidates.push_back(i);
+            }
+        }
+        else
+        {
+            for (size_t i = 0; i < n; ++i)
+            {
+                if (segment.levels[i] <= log_level) candidates.push_back(i);
+            }
+        }
+
+        //Read the candidates in chunks from the newest one, so that only few records are read if the search ends early
+        const size_t chunk_size = 256;
+        size_t end = candidates.size();
+        while (end > 0 && !done())
+        {
+            const size_t begin = (end > chunk_size) ? end - chunk_size : 0;
+            read_records(segment, candidates[begin], candidates[end - 1], records);
+            if (records.empty()) break;
+
+            for (size_t c = end; c > begin && !done(); --c)
+            {
+                const Log& log = records[candidates[c - 1] - candidates[begin]];
+                if (!check_records || matcher.matches(filter_text(log.id(), log.content(), segment.stamps[candidates[c - 1]], filter_type)))
+                {
+                    search_result.push_back(log);
+                }
+            }
+            end = begin;
+        }
+    }
+
+    if (!continue_search.load())
+    {
+        //Return empty result list if the search was aborted
+        search_result.clear();
+    }
+
+    std::reverse(search_result.begin(), search_result.end());
+    return search_result;
+}
+
+uint64_t LogArchive::size() const
+{
+    std::lock_guard<std::mutex> lock(storage_mutex);
+    return total_count;
+}
+
+size_t LogArchive::memory_usage() const
+{
+    std::lock_guard<std::mutex> lock(storage_mutex);
+    size_t bytes = active_segment.capacity() * sizeof(Log);
+    for (const Log& log : active_segment) bytes += log_memory_usage(log) - sizeof(Log);
+    for (const auto& segment : memory_ring)
+    {
+        bytes += (segment->logs.capacity() - segment->logs.size()) * sizeof(Log);
+        for (const Log& log : segment->logs) bytes += log_memory_usage(log);
+    }
+    for (const auto& segment : spilled_segments) bytes += segment->memory_usage();
+    return bytes;
+}
+
+uint64_t LogArchive::spill_file_size() const
+{
+    return spill_size.load();
+}
+
+void LogArchive::reset()
+{
+    std::lock_guard<std::mutex> writer_lock(writer_mutex);
+    std::lock_guard<std::mutex> lock(storage_mutex);
+    active_segment.clear();
+    active_segment_number = 0;
+    memory_ring.clear();
+    spilled_segments.clear();
+    total_count = 0;
+    open_spill_file();
+}
@@ -0,0 +1,228 @@
+#pragma once
+
+#include "defaults.hpp"
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <regex>
+
+#include "Log.hpp"
+
+/**
+ * \class LogArchive
+ * \brief Storage and search for received Log messages, used by LogStorage.
+ *
+ * Logs are appended to a segment of fixed size. The newest memory_segments completed segments are kept in memory
+ * (bounded ring, used for get_recent_logs and the first part of a search). Each completed segment is also written to
+ * an append-only binary spill file, so that older logs are not lost. For each spilled segment, only a small index
+ * stays in memory: file offset, time stamp and log level per entry, the IDs of the segment, and the trigram
+ * dictionary of the content. The posting lists of the trigrams (which entries contain which trigram) are stored
+ * in the spill file after the records of the segment.
+ *
+ * A search works segment by segment, from the newest to the oldest log, and stops as soon as enough results were
+ * found or the search was aborted. Literal parts of the search string are used to skip segments and entries
+ * that cannot match (trigrams for spilled segments, substring search for segments in memory); the regex is
+ * only applied to the remaining candidates.
+ *
+ * append and reset are serialized internally, any number of threads may read / search concurrently.
+ * \ingroup lcc
+ */
+class LogArchive
+{
+public:
+    /**
+     * \enum FilterType
+     * \brief For searching through the log storage: Which values should be considered (only the content, only the ID...)
+     */
+    enum FilterType {ID, Content, Timestamp, All};
+
+    //! Max. segment size, entries within a segment are indexed with 16 bit
+    static constexpr size_t max_segment_size = 65536;
+
+private:
+    /**
+     * \brief Open spill file, closed when the last segment index that refers to it is destroyed
+     * (so that a search that is still running during a reset can finish reading)
+     */
+    struct SpillFile
+    {
+        //! File descriptor, -1 if the file could not be opened
+        int fd = -1;
+
+        /**
+         * \brief Closes the file
+         */
+        ~SpillFile();
+    };
+
+    /**
+     * \brief Index of a segment that was written to the spill file, kept in memory
+     */
+    struct SpilledSegment
+    {
+        //! The file that contains the records and posting lists
+        shared_ptr<const SpillFile> file;
+        //! Number of the segment, counted from the first segment after construction / reset
+        uint64_t number = 0;
+        //! Position of the first record in the spill file
+        uint64_t file_offset = 0;
+        //! Per entry: Start of the record relative to file_offset, plus one element for the end of the last record
+        vector<uint32_t> record_offsets;
+        //! Per entry: Time stamp of the log
+        vector<uint64_t> stamps;
+        //! Per entry: Log level
+        vector<unsigned short> levels;
+        //! Per entry: Index into ids
+        vector<uint16_t> id_indices;
+        //! Distinct IDs of the segment
+        vector<string> ids;
+        //! Sorted, distinct trigrams of the content of all entries
+        vector<uint32_t> trigrams;
+        //! Per trigram: Start of its posting list (uint16_t entry indices) relative to postings_offset, plus one element for the end
+        vector<uint32_t> posting_offsets;
+        //! Position of the posting lists in the spill file
+        uint64_t postings_offset = 0;
+
+        /**
+         * \brief Approximate memory usage of the index in bytes
+         */
+        size_t memory_usage() const;
+    };
+
+    /**
+     * \brief Completed segment that is still kept in memory
+     */
+    struct MemorySegment
+    {
+        //! Number of the segment, see SpilledSegment
+        uint64_t number = 0;
+        //! The logs, in the order of reception
+        vector<Log> logs;
+    };
+
+    //! Number of logs per segment
+    const size_t segment_size;
+    //! Number of completed segments that are kept in memory
+    const size_t memory_segments;
+
+    //! Segment that is currently filled
+    vector<Log> active_segment;
+    //! Number of the active segment
+    uint64_t active_segment_number = 0;
+    //! Newest completed segments, oldest first
+    std::deque<shared_ptr<const MemorySegment>> memory_ring;
+    //! Index of all spilled segments, oldest first
+    vector<shared_ptr<const SpilledSegment>> spilled_segments;
+    //! Number of logs that were appended since construction / reset
+    uint64_t total_count = 0;
+    //! Protects active_segment, memory_ring, spilled_segments and total_count (not the file)
+    mutable std::mutex storage_mutex;
+
+    //! Filename of the spill file
+    const string spill_filename;
+    //! Current spill file; if it could not be opened, completed segments are dropped when they leave the memory ring
+    shared_ptr<const SpillFile> spill_file;
+    //! Write position in the spill file
+    std::atomic<uint64_t> spill_size{0};
+    //! Serializes append and reset
+    std::mutex writer_mutex;
+
+    /**
+     * \brief Deletes an existing spill file and creates a new, empty one
+     */
+    void open_spill_file();
+
+    /**
+     * \brief Writes a completed segment to the spill file, creates its index
+     * \param segment The segment
+     * \return The index, or nullptr if the segment could not be written
+     */
+    shared_ptr<const SpilledSegment> spill(const MemorySegment& segment);
+
+    /**
+     * \brief Reads the records of a spilled segment from first_entry to last_entry (inclusive)
+     * \param segment The segment
+     * \param first_entry First entry to read
+     * \param last_entry Last entry to read
+     * \param out_logs Logs in the range, empty if the file could not be read (e.g. after a reset)
+     */
+    void read_records(const SpilledSegment& segment, size_t first_entry, size_t last_entry, vector<Log>& out_logs) const;
+
+    /**
+     * \brief Reads the posting list of trigram i of a spilled segment
+     * \param segment The segment
+     * \param trigram_index Position of the trigram in segment.trigrams
+     * \param out_entries Entry indices, sorted; empty if the file could not be read
+     */
+    void read_postings(const SpilledSegment& segment, size_t trigram_index, vector<uint16_t>& out_entries) const;
+
+public:
+    /**
+     * \brief Constructor, creates (truncates) the spill file
+     * \param _spill_filename Filename of the spill file
+     * \param _segment_size Number of logs per segment, at most max_segment_size
+     * \param _memory_segments Number of completed segments that are kept in memory
+     */
+    LogArchive(const string& _spill_filename, size_t _segment_size = 4096, size_t _memory_segments = 3);
+
+    /**
+     * \brief Destructor, closes and deletes the spill file
+     */
+    ~LogArchive();
+
+    LogArchive(const LogArchive&) = delete;
+    LogArchive& operator=(const LogArchive&) = delete;
+
+    /**
+     * \brief Append logs. Completed segments are written to the spill file by the calling thread.
+     * \param logs Logs in the order of reception
+     */
+    void append(const vector<Log>& logs);
+
+    /**
+     * \brief The newest logs that are still in memory, newest first
+     * \param log_amount Max. number of logs to return
+     * \param log_level Only logs up to this level
+     */
+    vector<Log> get_recent_logs(size_t log_amount, unsigned short log_level) const;
+
+    /**
+     * \brief All logs that are still in memory (segment_size * (memory_segments + 1) at most), oldest first
+     * \param log_level Only logs up to this level
+     */
+    vector<Log> get_memory_logs(unsigned short log_level) const;
+
+    /**
+     * \brief Searches all logs that were received since construction / reset, including spilled ones.
+     * Matching is the same as std::regex_search on the text selected by filter_type (ID, content, time stamp in ns,
+     * or all three concatenated). Throws std::regex_error if filter_value is not a valid regex.
+     * \param filter_value The regex to search for
+     * \param filter_type Which part of the log must match
+     * \param log_level Only logs up to this level
+     * \param max_results Returns at most this many of the newest matches
+     * \param continue_search Set to false from another thread to abort, the search then returns an empty result
+     * \return Matches, oldest first
+     */
+    vector<Log> search(const string& filter_value, FilterType filter_type, unsigned short log_level,
+        size_t max_results, const std::atomic_bool& continue_search) const;
+
+    /**
+     * \brief Number of logs that were appended since construction / reset
+     */
+    uint64_t size() const;
+
+    /**
+     * \brief Approximate memory usage in bytes: logs in memory and index of the spilled segments
+     */
+    size_t memory_usage() const;
+
+    /**
+     * \brief Size of the spill file in bytes
+     */
+    uint64_t spill_file_size() const;
+
+    /**
+     * \brief Delete all logs, start a new spill file
+     */
+    void reset();
+};
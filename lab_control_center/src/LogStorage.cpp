@@ -8,7 +8,8 @@
 using namespace std::placeholders;
 LogStorage::LogStorage() :
     /*Set up communication*/
-    log_reader(std::bind(&LogStorage::log_callback, this, _1), "log", true)
+    log_reader(std::bind(&LogStorage::log_callback, this, _1), "log", true),
+    log_archive("all_received_logs.bin")
 {    
     file.open(filename, std::ofstream::out | std::ofstream::trunc);
     file << "ID,Timestamp,Content" << std::endl;
@@ -21,41 +22,50 @@ LogStorage::~LogStorage()
 }
 
 void LogStorage::log_callback(std::vector<Log>& samples) { 
-    std::lock_guard<std::mutex> lock_1(log_storage_mutex);
-    std::lock_guard<std::mutex> lock_2(log_buffer_mutex); 
-
-    for (auto& received_log : samples) {
-        //Make sure that the utf8-encoding is correct, or else Gtk will show a warning (Pango, regarding UTF-8)
-        //The warning will still show up, but the log message is altered s.t. the user can find the error
-        assert_utf8_validity(received_log);
-
-        log_storage.push_back(received_log);
-        log_buffer.push_back(received_log);
-
-        //Write logs immediately to csv file (taken from cpm library)
-        //For the log file: csv, so escape '"'
-        std::string str = received_log.content();
-        std::string log_string = std::string(str);
-        std::string escaped_quote = std::string("\"\"");
-        size_t pos = 0;
-        while ((pos = log_string.find('"', pos)) != std::string::npos) {
-            log_string.replace(pos, 1, escaped_quote);
-            pos += escaped_quote.size();
+    {
+        std::lock_guard<std::mutex> lock_2(log_buffer_mutex); 
+
+        for (auto& received_log : samples) {
+            //Make sure that the utf8-encoding is correct, or else Gtk will show a warning (Pango, regarding UTF-8)
+            //The warning will still show up, but the log message is altered s.t. the user can find the error
+            assert_utf8_validity(received_log);
+
+            log_buffer.push_back(received_log);
         }
-        //Also put the whole string in quotes
-        log_string.insert(0, "\"");
-        log_string += "\"";
 
+        //Clear buffer when some max size was reached - keep last elements
+        keep_last_elements(log_buffer, 100);
+    }
+
+    //The file writes do not hold the buffer mutex, so that the UI can get new logs meanwhile
+    {
         //Mutex for writing the message (file, writer) - is released when going out of scope
         std::lock_guard<std::mutex> lock(file_mutex);
 
-        //Add the message to the log file
-        file << received_log.id() << "," << received_log.stamp().nanoseconds() << "," << log_string << std::endl;
+        for (auto& received_log : samples) {
+            //Write logs immediately to csv file (taken from cpm library)
+            //For the log file: csv, so escape '"'
+            std::string str = received_log.content();
+            std::string log_string = std::string(str);
+            std::string escaped_quote = std::string("\"\"");
+            size_t pos = 0;
+            while ((pos = log_string.find('"', pos)) != std::string::npos) {
+                log_string.replace(pos, 1, escaped_quote);
+                pos += escaped_quote.size();
+            }
+            //Also put the whole string in quotes
+            log_string.insert(0, "\"");
+            log_string += "\"";
+
+            //Add the message to the log file, flushed once per callback (not per log)
+            file << received_log.id() << "," << received_log.stamp().nanoseconds() << "," << log_string << "\n";
+        }
+
+        file.flush();
     }
 
-    //Clear storage and buffer when some max size was reached - keep last elements
-    keep_last_elements(log_storage, 10000);
-    keep_last_elements(log_buffer, 100);
+    //Completed segments are written to the spill file here
+    log_archive.append(samples);
 }
 
 std::vector<Log> LogStorage::get_new_logs(unsigned int log_level) {
@@ -76,98 +86,36 @@ std::vector<Log> LogStorage::get_new_logs(unsigned int log_level) {
 }
 
 std::vector<Log> LogStorage::get_all_logs(unsigned short log_level) {
-    std::lock_guard<std::mutex> lock(log_storage_mutex);
-    std::vector<Log> log_copy;
-
-    for (auto log : log_storage)
-    {
-        //TODO: It could be more efficient to store logs of different levels in different data structures (though merging them would take more time)
-        if(log.log_level() <= log_level)
-        {
-            log_copy.push_back(log);
-        }
-    }
-
-    return log_copy;
+    return log_archive.get_memory_logs(log_level);
 }
 
 std::vector<Log> LogStorage::get_recent_logs(const long log_amount, unsigned short log_level) {
-    std::lock_guard<std::mutex> lock(log_storage_mutex);
-    std::vector<Log> log_copy;
-    long count = 0;
-    for (auto back_it = log_storage.rbegin(); back_it != log_storage.rend(); ++back_it)
-    {
-        //Only add log_amount most recent logs
-        if (count >= log_amount) break;
-
-        //Get next log, if it is within the given log level
-        if (back_it->log_level() <= log_level)
-        {
-            log_copy.push_back(*back_it);
-            ++count;
-        }
-    }
-
-    return log_copy;
+    if (log_amount <= 0) return std::vector<Log>();
+    return log_archive.get_recent_logs(static_cast<size_t>(log_amount), log_level);
 }
 
 std::vector<Log> LogStorage::perform_abortable_search(std::string filter_value, FilterType filter_type, unsigned short log_level, std::atomic_bool &continue_search) {
-    //Copy log_storage and perform search on copy only
-    std::unique_lock<std::mutex> lock(log_storage_mutex);
-    std::vector<Log> log_storage_copy = std::vector<Log>(log_storage);
-    lock.unlock();
-
     //Result vector
     std::vector<Log> search_result;
 
     try {
-        std::regex search_regex(filter_value);
-
-        for (auto iterator = log_storage_copy.begin(); iterator != log_storage_copy.end(); ++iterator) {
-            if (!continue_search.load()) {
-                //Return empty result list if the search was aborted
-                search_result.clear();
-                return search_result;
-            }
-
-            std::stringstream stream;
-            std::string filter_by_text;
-            switch (filter_type) {
-                case ID:
-                    filter_by_text = iterator->id();
-                    break;
-                case Content:
-                    filter_by_text = iterator->content();
-                    break;
-                case Timestamp:
-                    stream << iterator->stamp().nanoseconds();
-                    filter_by_text = stream.str();
-                    break;
-                default:
-                    stream << iterator->id() << iterator->content() << iterator->stamp().nanoseconds();
-                    filter_by_text = stream.str();
-                    break;
-            }
-
-            if (std::regex_search(filter_by_text, search_regex) && iterator->log_level() <= log_level) {
-                search_result.emplace_back(*iterator);
-            }
-
-            // if (filter_by_text.find(filter_value) != string::npos) {
-            //     search_result.emplace_back(*iterator);
-            // }
-        }
+        //Searches from the newest log backwards and stops after 100 matches, or if the search was aborted
+        search_result = log_archive.search(filter_value, filter_type, log_level, 100, continue_search);
     }
     catch (std::regex_error& e) {
         std::cout << "Regex error (due to filter string): " << e.what() << std::endl;
         search_result.push_back(Log("", "No results - Wrong regex expression!", TimeStamp(0), 0));
     }
 
-    if (search_result.size() == 0 && log_storage_copy.size() > 0) {
-        search_result.push_back(Log("", "No results", TimeStamp(0), 0));
+    if (!continue_search.load()) {
+        //Return empty result list if the search was aborted
+        search_result.clear();
+        return search_result;
     }
 
-    keep_last_elements(search_result, 100);
+    if (search_result.size() == 0 && log_archive.size() > 0) {
+        search_result.push_back(Log("", "No results", TimeStamp(0), 0));
+    }
 
     return search_result;
 }
@@ -211,9 +159,8 @@ void LogStorage::assert_utf8_validity(Log& log)
 
 void LogStorage::reset() 
 {
-    std::unique_lock<std::mutex> lock(log_storage_mutex);
     std::unique_lock<std::mutex> lock_2(log_buffer_mutex);
-    log_storage.clear();
+    log_archive.reset();
     log_buffer.clear();
 
     //Reset UI file
@@ -22,6 +22,7 @@
 #include "cpm/ParticipantSingleton.hpp"
 
 #include "Log.hpp"
+#include "LogArchive.hpp"
 
 /**
  * \brief Used to receive and store Log messages (cpm::Logging) from all participants in the current domain
@@ -29,11 +30,8 @@
  */
 class LogStorage {
 public:
-    /**
-     * \enum FilterType
-     * \brief For searching through the log storage: Which values should be considered (only the content, only the ID...)
-     */
-    enum FilterType {ID, Content, Timestamp, All};
+    //! For searching through the log storage: Which values should be considered (only the content, only the ID...)
+    using FilterType = LogArchive::FilterType;
 
 private:
     //Communication objects and callbacks
@@ -46,12 +44,10 @@ private:
     cpm::AsyncReader<Log> log_reader;
     //! Only keeps the newest logs, used when not in search-mode
     std::vector<Log> log_buffer;
-    //! Keeps all logs (might delete oldest ones if some limit is reached)
-    std::vector<Log> log_storage;
+    //! Keeps all logs: the newest in memory, older ones in a spill file, indexed for the search
+    LogArchive log_archive;
     //! Mutex for accessing log_buffer
     std::mutex log_buffer_mutex;
-    //! Mutex for accessing log_storage
-    std::mutex log_storage_mutex;
 
     //! File for logging, to write all received logs to
     std::ofstream file;
@@ -96,15 +92,15 @@ public:
     std::vector<Log> get_new_logs(unsigned int log_level);
     
     /**
-     * \brief Get all Log messages that have been received (remembers up to 10000 Log messages before old Log messages are deleted)
+     * \brief Get all Log messages that are still kept in memory (at least the newest 12288 Log messages), older ones can only be found with perform_abortable_search
      * \param log_level Get all messages up to this level
      * \return Vector of log messages
      */
     std::vector<Log> get_all_logs(unsigned short log_level);
 
     /**
-     * \brief Get the log_amount most recent Log messages of all that have been received
-     * \param log_amount How many logs should be returned (max value)
+     * \brief Get the log_amount most recent Log messages of all that have been received, newest first
+     * \param log_amount How many logs should be returned (max value, at most the logs that are kept in memory)
      * \param log_level Get all messages up to this level
      * \return Vector of log messages
      */
@@ -112,7 +108,8 @@ public:
 
     /**
      * \brief Performs a search that is supposed to be run asynchronously in a new thread - using a future is recommended to obtain the result. The search can be aborted by setting continue_search to false (should thus be false at start) - this is useful in case the user starts a new search before the old one is completed
-     * \param filter_value the string to search for (TODO: Later REGEX)
+     * Searches all logs received since the last reset (see LogArchive::search), returns the newest 100 matches.
+     * \param filter_value the regex to search for
      * \param filter_type where the filter should match (Log message, Log ID...)
      * \param log_level Get all messages up to this level
      * \param continue_search should be true initially, set to false to abort the search before it finished - the algorithm then returns immediately
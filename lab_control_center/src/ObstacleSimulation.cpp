@@ -1,5 +1,7 @@
 #include "ObstacleSimulation.hpp"
 
+#include <algorithm>
+
 /**
  * \file ObstacleSimulation.cpp
  * \ingroup lcc
@@ -13,6 +15,50 @@ trajectory(_trajectory)
 
     //We do not accept empty trajectories
     assert(trajectory.trajectory.size() > 0);
+
+    point_times.reserve(trajectory.trajectory.size());
+    for (auto& point : trajectory.trajectory)
+    {
+        point_times.push_back(point.time.has_value() ? point.time.value().get_mean() : 0.0);
+    }
+    point_times_sorted = std::is_sorted(point_times.begin(), point_times.end());
+}
+
+void ObstacleSimulation::update_current_trajectory(uint64_t elapsed_time, uint64_t time_step_size)
+{
+    const size_t last_index = point_times.size() - 1;
+    auto is_reached = [&] (size_t index) {
+        return elapsed_time >= point_times[index] * time_step_size;
+    };
+
+    //Usual case: The current point is still active or the next point becomes active
+    if (current_trajectory >= last_index || !is_reached(current_trajectory))
+    {
+        return;
+    }
+    ++current_trajectory;
+
+    if (current_trajectory < last_index && is_reached(current_trajectory))
+    {
+        if (point_times_sorted)
+        {
+            //Multiple points were skipped (e.g. large timer period or short time steps): First point that has not been reached
+            auto next_point = std::upper_bound(
+                point_times.begin() + current_trajectory, 
+                point_times.begin() + last_index, 
+                elapsed_time, 
+                [&] (uint64_t time, double point_time) { return time < point_time * time_step_size; }
+            );
+            current_trajectory = static_cast<size_t>(next_point - point_times.begin());
+        }
+        else
+        {
+            while (current_trajectory < last_index && is_reached(current_trajectory))
+            {
+                ++current_trajectory;
+            }
+        }
+    }
 }
 
 CommonroadObstacle ObstacleSimulation::construct_obstacle(ObstacleSimulationSegment& point, double x, double y, double yaw, uint64_t t_now)
@@ -76,7 +122,8 @@ std::pair<double, double> ObstacleSimulation::get_position(ObstacleSimulationSeg
     }
 
     //Add mean of shape position (lanelet ref is already translated to position in ObstacleSimulationManager)
-    double x, y = 0.0;
+    double x = 0.0;
+    double y = 0.0;
     double center_count = 0.0;
 
     for (auto circle : segment.shape.circles())
@@ -219,10 +266,7 @@ CommonroadObstacle ObstacleSimulation::get_state(uint64_t start_time, uint64_t t
     assert(trajectory.trajectory.at(current_trajectory).time.has_value());
 
     //Get to currently active index / trajectory point
-    while (t_now - start_time >= trajectory.trajectory.at(current_trajectory).time.value().get_mean() * time_step_size && current_trajectory < trajectory.trajectory.size() - 1)
-    {
-        ++current_trajectory;
-    }
+    update_current_trajectory(t_now - start_time, time_step_size);
     auto& point = trajectory.trajectory.at(current_trajectory);
 
     //These values are set either by interpolation or using the last data point or do not exist
@@ -232,7 +276,7 @@ CommonroadObstacle ObstacleSimulation::get_state(uint64_t start_time, uint64_t t
     if(point.position.has_value())
     {
         //Interpolate or stay at start / end point
-        if (point.time.value().get_mean() * time_step_size >= t_now - start_time && current_trajectory > 0)
+        if (point_times.at(current_trajectory) * time_step_size >= t_now - start_time && current_trajectory > 0)
         {
             //Interpolate
             interpolate_between(trajectory.trajectory.at(current_trajectory - 1), point, t_now - start_time, time_step_size, x, y, yaw);
@@ -286,13 +330,10 @@ VehicleCommandTrajectory ObstacleSimulation::get_trajectory(uint64_t start_time,
     assert(trajectory.trajectory.at(current_trajectory).time.has_value());
 
     //Get to currently active index / trajectory point
-    while (t_now - start_time >= trajectory.trajectory.at(current_trajectory).time.value().get_mean() * time_step_size && current_trajectory < trajectory.trajectory.size() - 1)
-    {
-        ++current_trajectory;
-    }
+    update_current_trajectory(t_now - start_time, time_step_size);
 
     //Behaviour for points before the final point
-    if (t_now - start_time < trajectory.trajectory.at(trajectory.trajectory.size() - 1).time.value().get_mean() * time_step_size)
+    if (t_now - start_time < point_times.back() * time_step_size)
     {
         //Send from previous over current point up to some time steps in the future
         size_t start_index = current_trajectory;
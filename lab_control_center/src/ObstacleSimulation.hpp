@@ -4,6 +4,7 @@
 #include "commonroad_classes/ObstacleSimulationData.hpp"
 
 #include <memory>
+#include <vector>
 
 #include "cpm/Logging.hpp"
 #include "cpm/CommandLineReader.hpp"
@@ -29,12 +30,24 @@ private:
     uint8_t obstacle_id;
     //! Trajectory data of the obstacle + obstacle type
     ObstacleSimulationData trajectory; //Important: Position should always be set! Translate lanelet refs beforehand!
-    //! Current position in the trajectory vector (used for simulation)
+    //! Current position in the trajectory vector (used for simulation), only moves forward until reset() is called
     size_t current_trajectory = 0;
+    //! Mean time of each trajectory point in time steps (0 if not set), precomputed for the lookup of the current trajectory point
+    std::vector<double> point_times;
+    //! If point_times is sorted, the current trajectory point can be found with a binary search
+    bool point_times_sorted = true;
 
     //! As we cannot just send single points, but need to send a trajectory to vehicles: Send up to 10 trajectory points from future time steps
     const size_t future_time_steps = 10;
 
+    /**
+     * \brief Move current_trajectory forward to the first trajectory point that has not been reached yet (or to the last point).
+     * Usually, this is the same or the next point. If more points were skipped, a binary search over point_times is used.
+     * \param elapsed_time Time since the start of the simulation, in ns
+     * \param time_step_size Commonroad time step size in ns
+     */
+    void update_current_trajectory(uint64_t elapsed_time, uint64_t time_step_size);
+
     /**
      * \brief Interpolation function that delivers state values in between set trajectory points
      * \param p1 First trajectory point to interpolate from
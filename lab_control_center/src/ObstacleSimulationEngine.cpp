@@ -0,0 +1,132 @@
+#include "ObstacleSimulationEngine.hpp"
+
+#include <exception>
+#include <mutex>
+
+/**
+ * \file ObstacleSimulationEngine.cpp
+ * \ingroup lcc
+ */
+
+ObstacleSimulationEngine::ObstacleSimulationEngine(size_t n_threads)
+:
+thread_pool(n_threads)
+{
+}
+
+std::vector<ObstacleSimulation*> ObstacleSimulationEngine::get_obstacles(std::function<bool(uint8_t)> filter)
+{
+    std::vector<ObstacleSimulation*> obstacles;
+    obstacles.reserve(simulated_obstacles.size());
+    for (auto& obstacle : simulated_obstacles)
+    {
+        if (filter(obstacle.second.get_id()))
+        {
+            obstacles.push_back(&(obstacle.second));
+        }
+    }
+    return obstacles;
+}
+
+void ObstacleSimulationEngine::for_each_index(size_t n, std::function<void(size_t)> function)
+{
+    if (n < min_parallel_obstacles || thread_pool.size() <= 1)
+    {
+        for (size_t i = 0; i < n; ++i)
+        {
+            function(i);
+        }
+    }
+    else
+    {
+        //Exceptions must not leave the workers, the first one is rethrown by the calling thread (like in a sequential loop)
+        std::exception_ptr error;
+        std::mutex error_mutex;
+        thread_pool.parallel_for(n, [&] (size_t i) {
+            try
+            {
+                function(i);
+            }
+            catch(...)
+            {
+                std::lock_guard<std::mutex> lock(error_mutex);
+                if (!error)
+                {
+                    error = std::current_exception();
+                }
+            }
+        });
+
+        if (error)
+        {
+            std::rethrow_exception(error);
+        }
+    }
+}
+
+void ObstacleSimulationEngine::add_obstacle(int id, ObstacleSimulationData& data)
+{
+    simulated_obstacles.emplace(id, ObstacleSimulation(data, id));
+}
+
+void ObstacleSimulationEngine::clear()
+{
+    simulated_obstacles.clear();
+}
+
+void ObstacleSimulationEngine::reset()
+{
+    for (auto& obstacle : simulated_obstacles)
+    {
+        obstacle.second.reset();
+    }
+}
+
+std::vector<uint8_t> ObstacleSimulationEngine::get_ids()
+{
+    std::vector<uint8_t> ids;
+    ids.reserve(simulated_obstacles.size());
+    for (auto& obstacle : simulated_obstacles)
+    {
+        ids.push_back(obstacle.second.get_id());
+    }
+    return ids;
+}
+
+CommonroadObstacleList ObstacleSimulationEngine::get_init_states(uint64_t t_now)
+{
+    auto obstacles = get_obstacles([] (uint8_t) { return true; });
+
+    CommonroadObstacleList obstacle_list;
+    obstacle_list.commonroad_obstacle_list().resize(obstacles.size());
+    for (size_t i = 0; i < obstacles.size(); ++i)
+    {
+        obstacle_list.commonroad_obstacle_list()[i] = obstacles[i]->get_init_state(t_now);
+    }
+    return obstacle_list;
+}
+
+CommonroadObstacleList ObstacleSimulationEngine::get_states(uint64_t start_time, uint64_t t_now, uint64_t time_step_size, std::function<bool(uint8_t)> filter)
+{
+    auto obstacles = get_obstacles(filter);
+
+    //Each state is written directly to its place in the message, so no copies of the obstacles (and their shapes) are required
+    CommonroadObstacleList obstacle_list;
+    auto& states = obstacle_list.commonroad_obstacle_list();
+    states.resize(obstacles.size());
+    for_each_index(obstacles.size(), [&] (size_t i) {
+        states[i] = obstacles[i]->get_state(start_time, t_now, time_step_size);
+    });
+    return obstacle_list;
+}
+
+std::vector<VehicleCommandTrajectory> ObstacleSimulationEngine::get_trajectories(uint64_t start_time, uint64_t t_now, uint64_t time_step_size, std::function<bool(uint8_t)> filter)
+{
+    auto obstacles = get_obstacles(filter);
+
+    std::vector<VehicleCommandTrajectory> trajectories(obstacles.size());
+    for_each_index(obstacles.size(), [&] (size_t i) {
+        trajectories[i] = obstacles[i]->get_trajectory(start_time, t_now, time_step_size);
+    });
+    return trajectories;
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include "commonroad_classes/ObstacleSimulationData.hpp"
+
+#include "ObstacleSimulation.hpp"
+
+#include "cpm/ThreadPool.hpp"
+#include "CommonroadObstacleList.hpp"
+#include "VehicleCommandTrajectory.hpp"
+
+#include <functional>
+#include <map>
+#include <vector>
+
+/**
+ * \class ObstacleSimulationEngine
+ * \brief Holds all simulated obstacles and computes their states / trajectories for one tick of the simulation.
+ * The obstacles of a tick are stepped in parallel on a fixed pool of worker threads (each obstacle only by one thread),
+ * and all obstacle states of a tick are collected in one CommonroadObstacleList, in the order of the obstacle IDs.
+ * Not thread-safe: The owner must synchronize calls (ObstacleSimulationManager uses its map_mutex).
+ * \ingroup lcc
+ */
+class ObstacleSimulationEngine
+{
+private:
+    //! Simulated obstacles by commonroad ID
+    std::map<int, ObstacleSimulation> simulated_obstacles;
+    //! Workers that step the obstacles
+    cpm::ThreadPool thread_pool;
+
+    //! Below this number of obstacles, they are stepped by the calling thread (waking up the workers takes longer)
+    static constexpr size_t min_parallel_obstacles = 32;
+
+    /**
+     * \brief Obstacles for which filter returns true, in the order of their IDs
+     * \param filter Gets the ID returned by ObstacleSimulation::get_id
+     */
+    std::vector<ObstacleSimulation*> get_obstacles(std::function<bool(uint8_t)> filter);
+
+    /**
+     * \brief Calls function(i) for all i in [0, n), in parallel for larger n
+     * \param n Number of indices
+     * \param function Function to call for each index
+     */
+    void for_each_index(size_t n, std::function<void(size_t)> function);
+
+public:
+    /**
+     * \brief Constructor
+     * \param n_threads Total number of threads used for stepping, including the calling thread; 0 uses all hardware threads
+     */
+    ObstacleSimulationEngine(size_t n_threads = 0);
+
+    /**
+     * \brief Add an obstacle (if no obstacle with the same ID exists)
+     * \param id Commonroad ID of the obstacle
+     * \param data Simulation data of the obstacle, lanelet references must already be translated
+     */
+    void add_obstacle(int id, ObstacleSimulationData& data);
+
+    /**
+     * \brief Remove all obstacles
+     */
+    void clear();
+
+    /**
+     * \brief Reset all obstacles to the start of their trajectory
+     */
+    void reset();
+
+    /**
+     * \brief IDs (see ObstacleSimulation::get_id) of all obstacles, in the order of their commonroad IDs
+     */
+    std::vector<uint8_t> get_ids();
+
+    /**
+     * \brief Initial states of all obstacles
+     * \param t_now Current time, used for timestamp of msg
+     */
+    CommonroadObstacleList get_init_states(uint64_t t_now);
+
+    /**
+     * \brief Current states of all obstacles for which filter returns true (see ObstacleSimulation::get_state)
+     * \param start_time Time when the simulation was started
+     * \param t_now Current time
+     * \param time_step_size Commonroad time step size in ns
+     * \param filter Gets the ID returned by ObstacleSimulation::get_id, called by the calling thread before stepping
+     */
+    CommonroadObstacleList get_states(uint64_t start_time, uint64_t t_now, uint64_t time_step_size, std::function<bool(uint8_t)> filter);
+
+    /**
+     * \brief Current trajectories of all obstacles for which filter returns true (see ObstacleSimulation::get_trajectory)
+     * \param start_time Time when the simulation was started
+     * \param t_now Current time
+     * \param time_step_size Commonroad time step size in ns
+     * \param filter Gets the ID returned by ObstacleSimulation::get_id, called by the calling thread before stepping
+     */
+    std::vector<VehicleCommandTrajectory> get_trajectories(uint64_t start_time, uint64_t t_now, uint64_t time_step_size, std::function<bool(uint8_t)> filter);
+};
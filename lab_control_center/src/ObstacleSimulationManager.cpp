@@ -66,11 +66,11 @@ void ObstacleSimulationManager::stop_timers()
     trajectory.header(header);
     
     std::lock_guard<std::mutex> lock(map_mutex);
-    for (auto& obstacle : simulated_obstacles)
+    for (auto id : simulation_engine.get_ids())
     {
-        if (get_obstacle_simulation_state(obstacle.second.get_id()) == ObstacleToggle::ToggleState::On) //TODO: Let the user choose which obstacle should be real in the UI
+        if (get_obstacle_simulation_state(id) == ObstacleToggle::ToggleState::On) //TODO: Let the user choose which obstacle should be real in the UI
         {
-            trajectory.vehicle_id(obstacle.second.get_id());
+            trajectory.vehicle_id(id);
             writer_vehicle_trajectory.write(trajectory);
         }
     }
@@ -86,18 +86,7 @@ void ObstacleSimulationManager::send_init_states()
         std::lock_guard<std::mutex> lock(map_mutex);
 
         //Get and send initial states
-        std::vector<CommonroadObstacle> initial_obstacle_states;
-        for (auto& obstacle : simulated_obstacles)
-        {
-            //if (get_obstacle_simulation_state(obstacle.second.get_id()) == ObstacleToggle::ToggleState::Simulated)
-            //{
-                initial_obstacle_states.push_back(obstacle.second.get_init_state(t_now));
-            //}
-        }
-
-        CommonroadObstacleList obstacle_list;
-        obstacle_list.commonroad_obstacle_list(initial_obstacle_states);
-        writer_commonroad_obstacle.write(obstacle_list);
+        writer_commonroad_obstacle.write(simulation_engine.get_init_states(t_now));
 
         //Send test init. trajectory messages
         // for (auto& obstacle : simulated_obstacles)
@@ -110,23 +99,14 @@ void ObstacleSimulationManager::send_init_states()
     });
 }
 
-std::vector<CommonroadObstacle> ObstacleSimulationManager::compute_all_next_states(uint64_t t_now, uint64_t start_time)
+CommonroadObstacleList ObstacleSimulationManager::compute_all_next_states(uint64_t t_now, uint64_t start_time)
 {
-    //TODO: Thread pool?
-    std::vector<CommonroadObstacle> next_obstacle_states;
     std::lock_guard<std::mutex> lock(map_mutex);
 
-    for (auto& obstacle : simulated_obstacles)
-    {
-        //Only simulate obstacles that are supposed to be simulated
-        if (get_obstacle_simulation_state(obstacle.second.get_id()) == ObstacleToggle::ToggleState::Simulated)
-        {
-            next_obstacle_states.push_back(obstacle.second.get_state(start_time, t_now, time_step_size));
-        }
-        
-    }
-
-    return next_obstacle_states;
+    //Only simulate obstacles that are supposed to be simulated
+    return simulation_engine.get_states(start_time, t_now, time_step_size, [&] (uint8_t id) {
+        return get_obstacle_simulation_state(id) == ObstacleToggle::ToggleState::Simulated;
+    });
 }
 
 void ObstacleSimulationManager::setup()
@@ -223,7 +203,7 @@ void ObstacleSimulationManager::create_obstacle_simulation(int id, ObstacleSimul
     }
 
     std::lock_guard<std::mutex> lock(map_mutex);
-    simulated_obstacles.emplace(id, ObstacleSimulation(data, id));
+    simulation_engine.add_obstacle(id, data);
 }
 
 //Suppress warning for unused parameter
@@ -248,20 +228,17 @@ void ObstacleSimulationManager::start_helper(bool wait_for_start_signal, bool si
         //Cannot be obtained before the timer was started
         auto start_time = simulation_timer->get_start_time();
         
-        auto next_obstacle_states = compute_all_next_states(t_now, start_time);
-
-        CommonroadObstacleList obstacle_list;
-        obstacle_list.commonroad_obstacle_list(next_obstacle_states);
-        writer_commonroad_obstacle.write(obstacle_list);
+        //All obstacle states of this tick are sent in one message
+        writer_commonroad_obstacle.write(compute_all_next_states(t_now, start_time));
 
         //Send test trajectory messages
         std::lock_guard<std::mutex> lock(map_mutex);
-        for (auto& obstacle : simulated_obstacles)
+        auto trajectories = simulation_engine.get_trajectories(start_time, t_now, time_step_size, [&] (uint8_t id) {
+            return get_obstacle_simulation_state(id) == ObstacleToggle::ToggleState::On; //TODO: Let the user choose which obstacle should be real in the UI
+        });
+        for (auto& trajectory : trajectories)
         {
-            if (get_obstacle_simulation_state(obstacle.second.get_id()) == ObstacleToggle::ToggleState::On) //TODO: Let the user choose which obstacle should be real in the UI
-            {
-                writer_vehicle_trajectory.write(obstacle.second.get_trajectory(start_time, t_now, time_step_size));
-            }
+            writer_vehicle_trajectory.write(trajectory);
         }
     });
 }
@@ -281,10 +258,7 @@ void ObstacleSimulationManager::stop()
     stop_timers();
 
     std::lock_guard<std::mutex> lock(map_mutex);
-    for (auto& simulated_obstacle : simulated_obstacles)
-    {
-        simulated_obstacle.second.reset();
-    }
+    simulation_engine.reset();
 
     send_init_states();
 }
@@ -294,7 +268,7 @@ void ObstacleSimulationManager::reset()
     stop_timers();
 
     std::lock_guard<std::mutex> lock(map_mutex);
-    simulated_obstacles.clear();
+    simulation_engine.clear();
     simulated_obstacle_states.clear();
 }
 
@@ -4,6 +4,7 @@
 #include "commonroad_classes/ObstacleSimulationData.hpp"
 
 #include "ObstacleSimulation.hpp"
+#include "ObstacleSimulationEngine.hpp"
 
 #include "cpm/Timer.hpp"
 #include "cpm/ParticipantSingleton.hpp"
@@ -29,8 +30,8 @@ private:
     //! Data object that can be used to access the obstacle's trajectories
     std::shared_ptr<CommonRoadScenario> scenario;
 
-    //! Store obstacles by ID
-    std::map<int, ObstacleSimulation> simulated_obstacles;
+    //! Stores the obstacles by ID and steps them in parallel
+    ObstacleSimulationEngine simulation_engine;
     //! Simulation state - relevant to decide which data to send for this obstacle (DDS Obstacle / Trajectory / Nothing)
     std::map<int, ObstacleToggle::ToggleState> simulated_obstacle_states;
     //! Mutex for access to the maps
@@ -83,11 +84,11 @@ private:
     void send_init_states();
 
     /**
-     * \brief Compute next states of commonroad obstacles based on the current time and return them; only consider obstacles that are supposed to be simulated by the LCC
+     * \brief Compute next states of commonroad obstacles based on the current time and return them as one list; only consider obstacles that are supposed to be simulated by the LCC
      * \param t_now Current time
      * \param start_time Time the simulation was started, to compute diff to t_now
      */
-    std::vector<CommonroadObstacle> compute_all_next_states(uint64_t t_now, uint64_t start_time);
+    CommonroadObstacleList compute_all_next_states(uint64_t t_now, uint64_t start_time);
 
     /**
      * \brief Either returns the content of the map or the default value (simulated); does not lock, so lock before calling!
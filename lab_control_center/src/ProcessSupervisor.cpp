@@ -0,0 +1,244 @@
+#include "ProcessSupervisor.hpp"
+
+#include <cerrno>
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+//Older glibc versions do not define the syscall number yet (it is the same on all architectures)
+#ifndef SYS_pidfd_open
+#define SYS_pidfd_open 434
+#endif
+
+/**
+ * \file ProcessSupervisor.cpp
+ * \ingroup lcc
+ */
+
+/**
+ * \brief pidfd_open, which has no glibc wrapper before glibc 2.36
+ * \ingroup lcc
+ */
+static int open_pidfd(int process_id)
+{
+    return static_cast<int>(syscall(SYS_pidfd_open, process_id, 0));
+}
+
+ProcessSupervisor::ProcessSupervisor()
+{
+    if (!is_supported())
+    {
+        return;
+    }
+
+    epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    stop_fd = eventfd(0, EFD_CLOEXEC);
+    if (epoll_fd < 0 || stop_fd < 0)
+    {
+        return;
+    }
+
+    //Token 0: Stop event
+    struct epoll_event stop_event;
+    stop_event.events = EPOLLIN;
+    stop_event.data.u64 = 0;
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, stop_fd, &stop_event) != 0)
+    {
+        return;
+    }
+
+    running.store(true);
+    supervisor_thread = std::thread([this] () {
+        supervise();
+    });
+}
+
+ProcessSupervisor::~ProcessSupervisor()
+{
+    running.store(false);
+    if (stop_fd >= 0)
+    {
+        uint64_t value = 1;
+        ssize_t written = write(stop_fd, &value, sizeof(value));
+        (void) written;
+    }
+    if (supervisor_thread.joinable())
+    {
+        supervisor_thread.join();
+    }
+
+    unwatch_all();
+    if (epoll_fd >= 0) close(epoll_fd);
+    if (stop_fd >= 0) close(stop_fd);
+}
+
+bool ProcessSupervisor::is_supported()
+{
+    //pidfd_open was added in Linux 5.3; test it once with the own PID
+    static const bool supported = [] () {
+        int pidfd = open_pidfd(getpid());
+        if (pidfd < 0)
+        {
+            return false;
+        }
+        close(pidfd);
+        return true;
+    }();
+    return supported;
+}
+
+void ProcessSupervisor::supervise()
+{
+    struct epoll_event events[16];
+    while (running.load())
+    {
+        int ready = epoll_wait(epoll_fd, events, 16, -1);
+        if (ready < 0)
+        {
+            if (errno == EINTR) continue;
+            break;
+        }
+
+        for (int i = 0; i < ready; ++i)
+        {
+            //Token 0 is the stop event, running is checked by the loop
+            const uint64_t token = events[i].data.u64;
+            if (token == 0)
+            {
+                continue;
+            }
+
+            //The process might have been unwatched in the meantime, then its token is no longer known
+            std::string name;
+            {
+                std::lock_guard<std::mutex> lock(watched_mutex);
+                auto name_it = names_by_token.find(token);
+                if (name_it == names_by_token.end())
+                {
+                    continue;
+                }
+                name = name_it->second;
+                names_by_token.erase(name_it);
+
+                auto& process = watched_processes.at(name);
+                process.exited = true;
+                close_pidfd(process);
+            }
+
+            std::lock_guard<std::mutex> lock(callback_mutex);
+            if (exit_callback)
+            {
+                exit_callback(name);
+            }
+        }
+    }
+}
+
+void ProcessSupervisor::close_pidfd(WatchedProcess& process)
+{
+    if (process.pidfd >= 0)
+    {
+        epoll_ctl(epoll_fd, EPOLL_CTL_DEL, process.pidfd, nullptr);
+        close(process.pidfd);
+        process.pidfd = -1;
+    }
+}
+
+bool ProcessSupervisor::watch(std::string name, int process_id)
+{
+    if (!running.load() || process_id <= 0)
+    {
+        return false;
+    }
+
+    //The process might already be gone (ESRCH), then its exit is reported right away
+    int pidfd = open_pidfd(process_id);
+    if (pidfd < 0 && errno != ESRCH)
+    {
+        return false;
+    }
+
+    std::unique_lock<std::mutex> lock(watched_mutex);
+    auto previous = watched_processes.find(name);
+    if (previous != watched_processes.end())
+    {
+        close_pidfd(previous->second);
+        names_by_token.erase(previous->second.token);
+        watched_processes.erase(previous);
+    }
+
+    WatchedProcess process;
+    process.process_id = process_id;
+    process.pidfd = pidfd;
+    process.token = next_token++;
+    process.exited = (pidfd < 0);
+
+    if (pidfd >= 0)
+    {
+        struct epoll_event event;
+        event.events = EPOLLIN;
+        event.data.u64 = process.token;
+        if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, pidfd, &event) != 0)
+        {
+            close(pidfd);
+            return false;
+        }
+        names_by_token[process.token] = name;
+    }
+
+    watched_processes[name] = process;
+    lock.unlock();
+
+    if (process.exited)
+    {
+        std::lock_guard<std::mutex> callback_lock(callback_mutex);
+        if (exit_callback)
+        {
+            exit_callback(name);
+        }
+    }
+
+    return true;
+}
+
+void ProcessSupervisor::unwatch(std::string name)
+{
+    std::lock_guard<std::mutex> lock(watched_mutex);
+    auto process = watched_processes.find(name);
+    if (process != watched_processes.end())
+    {
+        close_pidfd(process->second);
+        names_by_token.erase(process->second.token);
+        watched_processes.erase(process);
+    }
+}
+
+void ProcessSupervisor::unwatch_all()
+{
+    std::lock_guard<std::mutex> lock(watched_mutex);
+    for (auto& process : watched_processes)
+    {
+        close_pidfd(process.second);
+    }
+    watched_processes.clear();
+    names_by_token.clear();
+}
+
+std::optional<bool> ProcessSupervisor::is_running(std::string name)
+{
+    std::lock_guard<std::mutex> lock(watched_mutex);
+    auto process = watched_processes.find(name);
+    if (process == watched_processes.end())
+    {
+        return std::nullopt;
+    }
+    return !process->second.exited;
+}
+
+void ProcessSupervisor::set_exit_callback(std::function<void(std::string)> callback)
+{
+    std::lock_guard<std::mutex> lock(callback_mutex);
+    exit_callback = callback;
+}
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+
+/**
+ * \class ProcessSupervisor
+ * \brief Watches processes with a known PID (e.g. the process of a tmux session started by Deploy) and detects their exit right away,
+ * instead of checking for them periodically (e.g. with tmux ls). Each process is watched with a pidfd (Linux >= 5.3), which becomes
+ * readable when the process exits - also if the process is not a child of the LCC. A single thread waits for all pidfds with epoll.
+ * If pidfds are not supported, is_supported returns false and watch always fails, so that the caller can fall back to polling.
+ * \ingroup lcc
+ */
+class ProcessSupervisor
+{
+private:
+    //! Watched process, by name
+    struct WatchedProcess {
+        //! PID of the process
+        int process_id;
+        //! pidfd of the process, -1 after the exit was detected
+        int pidfd;
+        //! Used as epoll data, to identify the process even if the fd number is reused after unwatch
+        uint64_t token;
+        //! True if the process exited
+        bool exited;
+    };
+
+    //! Watched processes, by name
+    std::map<std::string, WatchedProcess> watched_processes;
+    //! Names of the watched processes, by token
+    std::map<uint64_t, std::string> names_by_token;
+    //! Next token for a watched process, 0 is used for the stop event
+    uint64_t next_token = 1;
+    //! For access to watched_processes, names_by_token and next_token
+    std::mutex watched_mutex;
+
+    //! Called (by the supervisor thread) with the name of a process when its exit was detected
+    std::function<void(std::string)> exit_callback;
+    //! For access to exit_callback, held while it is called, so that it is not called anymore after set_exit_callback returned
+    std::mutex callback_mutex;
+
+    //! Waits for all pidfds and the stop event
+    int epoll_fd = -1;
+    //! eventfd to wake up and stop the supervisor thread
+    int stop_fd = -1;
+    //! Waits for process exits
+    std::thread supervisor_thread;
+    //! To stop supervisor_thread
+    std::atomic_bool running{false};
+
+    /**
+     * \brief Function of the supervisor thread
+     */
+    void supervise();
+
+    /**
+     * \brief Remove the pidfd of a watched process from epoll and close it (watched_mutex must be locked)
+     * \param process The watched process
+     */
+    void close_pidfd(WatchedProcess& process);
+
+public:
+    /**
+     * \brief Constructor, starts the supervisor thread (if pidfds are supported)
+     */
+    ProcessSupervisor();
+
+    /**
+     * \brief Destructor, stops the supervisor thread and closes all pidfds
+     */
+    ~ProcessSupervisor();
+
+    /**
+     * \brief True if processes can be watched on this system (pidfd_open and epoll are available)
+     */
+    static bool is_supported();
+
+    /**
+     * \brief Start watching a process. Replaces a process watched under the same name before.
+     * If the process already exited, the exit is reported right away.
+     * \param name Name of the process, e.g. its tmux session
+     * \param process_id PID of the process
+     * \return False if the process cannot be watched (e.g. no pidfd support), in which case the caller must check for it itself
+     */
+    bool watch(std::string name, int process_id);
+
+    /**
+     * \brief Stop watching a process, e.g. before it is killed on purpose (so that this is not reported as a crash)
+     * \param name Name of the process
+     */
+    void unwatch(std::string name);
+
+    /**
+     * \brief Stop watching all processes
+     */
+    void unwatch_all();
+
+    /**
+     * \brief Get the state of a watched process, without any system calls
+     * \param name Name of the process
+     * \return True if the process is still running, false if it exited, no value if it is not watched
+     */
+    std::optional<bool> is_running(std::string name);
+
+    /**
+     * \brief Set the function that is called right after the exit of a watched process was detected (not for unwatched processes).
+     * It is called by the supervisor thread, so it should return quickly.
+     * \param callback Gets the name of the process, may be empty to remove the callback
+     */
+    void set_exit_callback(std::function<void(std::string)> callback);
+};
@@ -1,5 +1,8 @@
 #include "ProgramExecutor.hpp"
 
+//Environment passed to processes started with posix_spawn
+extern char** environ;
+
 /**
  * \file ProgramExecutor.cpp
  * \ingroup lcc
@@ -246,11 +249,9 @@ void ProgramExecutor::process_single_child_command(CommandMsg& msg)
     if (msg.command.request_type == RequestType::SEND_OUTPUT)
     {
         //Sometimes, this type of command seems to hang up, for unknown reasons. Thus, a timeout is added in this case.
-        //SIGTERM is set after 10 seconds, SIGKILL after 12 if TERM was not enough
-        //After the timeout, if the process was killed due to a timeout, ERROR is returned
-        std::stringstream stream;
-        stream << "timeout -k 12 10 " << msg.command.command << "; if [ $? != 0 ]; then echo 'ERROR'; fi";
-        std::string output = execute_command_get_output(stream.str().c_str());
+        //SIGTERM is sent after 10 seconds, SIGKILL shortly after if TERM was not enough
+        //After the timeout or if the command failed, ERROR is appended to the output
+        std::string output = execute_command_get_output(msg_string.c_str(), command_output_timeout_ms);
         
         //Create and send answer, repeat in case of failure (as the main process waits for it)
         while(! send_answer_msg(msg_response_queue_id, output, msg.mtype, true))
@@ -271,8 +272,13 @@ void ProgramExecutor::process_single_child_command(CommandMsg& msg)
     else
     {
         //We just want to execute the command without timeouts
-        //Simply use system() in this case
-        system(msg_string.c_str());
+        //Only wait for it (like system() would), so that no zombie process remains
+        int process_id = execute_command_get_pid(msg_string.c_str());
+        if (process_id > 0)
+        {
+            int status;
+            waitpid(process_id, &status, 0); //0 -> no flags here
+        }
     }
 }
 
@@ -443,25 +449,13 @@ bool ProgramExecutor::receive_command_msg(int msqid, CommandMsg& msg)
     return true;
 }
 
-std::string ProgramExecutor::execute_command_get_output(const char* cmd)
+std::string ProgramExecutor::execute_command_get_output(const char* cmd, int timeout_ms)
 {
-    //Code from stackoverflow
-    // std::array<char, 128> buffer;
-    // std::string result;
-    // std::unique_ptr<FILE, decltype(&pclose)> pipe(popen(cmd, "r"), pclose);
-    // if (!pipe) {
-    //     throw std::runtime_error("Could not use popen - deployment failed!");
-    // }
-    // while (fgets(buffer.data(), buffer.size(), pipe.get()) != nullptr) {
-    //     result += buffer.data();
-    // }
-    // return result;
-
     //We want to be able to kill the process early, so popen() is not really an option
     //Do smth similar to spawn_and_manage_process instead
+    //O_CLOEXEC: Commands started concurrently by other threads must not inherit the pipe, else we would not get EOF when this command finishes
     int command_pipe[2];
-
-    if (pipe(command_pipe))
+    if (pipe2(command_pipe, O_CLOEXEC))
     {
         std::stringstream error_msg;
         error_msg << "Pipe creation failed in execute_command_get_output, command: " << cmd;
@@ -469,74 +463,188 @@ std::string ProgramExecutor::execute_command_get_output(const char* cmd)
         return "ERROR";
     }
 
-    int process_id = fork();
-    if (process_id == 0)
-    {
-        //Tell the child to set its group process ID to its process ID, or else things like kill(-pid) to kill a ping-while-loop won't work
-        setpgid(0, 0);
+    int process_id = spawn_process(cmd, command_pipe[1]);
 
-        //We only want to write stdout, close the pipe's listen end
-        dup2(command_pipe[1], STDOUT_FILENO);
-        close(command_pipe[0]);
-        
-        //Actions to take within the new child process
-        //ACHTUNG: NUTZE chmod u+x für die Files, sonst: permission denied
-        execl("/bin/sh", "bash", "-c", cmd, NULL);
+    //We only want to listen, close the pipe's write end
+    close(command_pipe[1]);
 
-        //Error if execlp returns, cannot log this as this is not within the "parent" child
-        std::cerr << "Execl error in ProgramExecutor class: %s, for execution of '%s'" << std::strerror(errno) << cmd << std::endl;
+    if (process_id <= 0)
+    {
+        close(command_pipe[0]);
+        return "ERROR";
+    }
 
-        //Write to pipe because some response is still required / waited for
-        write(command_pipe[1], "ERROR", 5);
-        close(command_pipe[1]);
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+    auto remaining_ms = [&] () {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now()).count();
+    };
 
-        exit(EXIT_FAILURE);
+    //Wait until output is available and read all of it at once, until EOF (all writers closed the pipe), timeout or stop_threads
+    //The wait is done in slices, so that stop_threads is checked regularly
+    std::string out;
+    bool timed_out = false;
+    int epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    struct epoll_event pipe_event;
+    pipe_event.events = EPOLLIN;
+    pipe_event.data.fd = command_pipe[0];
+    if (epoll_fd < 0 || epoll_ctl(epoll_fd, EPOLL_CTL_ADD, command_pipe[0], &pipe_event) != 0 || fcntl(command_pipe[0], F_SETFL, O_NONBLOCK) != 0)
+    {
+        std::stringstream error_msg;
+        error_msg << "epoll setup failed in execute_command_get_output: " << std::strerror(errno) << ", command: " << cmd;
+        log(error_msg.str());
+        timed_out = true;
     }
-    else if (process_id > 0)
+
+    std::vector<char> buffer(read_buffer_size);
+    bool end_of_output = false;
+    while (!end_of_output && !timed_out && !stop_threads.load())
     {
-        //We are in the parent process and got the child's PID
+        auto wait_ms = remaining_ms();
+        if (wait_ms <= 0)
+        {
+            timed_out = true;
+            break;
+        }
 
-        //We only want to listen, close the pipe's write end
-        close(command_pipe[1]);
+        struct epoll_event event;
+        int ready = epoll_wait(epoll_fd, &event, 1, static_cast<int>(std::min<int64_t>(wait_ms, 100)));
+        if (ready < 0 && errno != EINTR)
+        {
+            std::stringstream error_msg;
+            error_msg << "epoll_wait failed in execute_command_get_output: " << std::strerror(errno) << ", command: " << cmd;
+            log(error_msg.str());
+            timed_out = true;
+            break;
+        }
+        if (ready <= 0)
+        {
+            continue;
+        }
 
-        //Get the output until no more characters are available
-        //!!!!!!!!!!!!!!!!!!!!!!!!
-        //TODO / NOTE: This might be very inefficient (mutex lock for each character for stop_threads.load()), shall I improve this?
-        //!!!!!!!!!!!!!!!!!!!!!!!!
-        char ch;
-        std::string out;
-        while (read(command_pipe[0], &ch, 1) && !stop_threads.load())
+        //Also read on EPOLLHUP: remaining data is only lost if we stop before read returns 0
+        while (true)
         {
-            out += ch;
+            ssize_t count = read(command_pipe[0], buffer.data(), buffer.size());
+            if (count > 0)
+            {
+                out.append(buffer.data(), static_cast<size_t>(count));
+            }
+            else
+            {
+                end_of_output = (count == 0 || (errno != EAGAIN && errno != EINTR));
+                break;
+            }
         }
+    }
+
+    if (epoll_fd >= 0) close(epoll_fd);
+    close(command_pipe[0]);
 
-        //Finally, close the pipe and kill the process
-        if (get_child_process_state(process_id) == PROCESS_STATE::DONE)
+    //The command usually terminates right after closing its output; it is killed if it does not do so until the timeout
+    int status = 0;
+    bool exited = false;
+    while (!timed_out && !stop_threads.load())
+    {
+        pid_t result = waitpid(process_id, &status, WNOHANG);
+        if (result != 0)
         {
-            //std::cout << "Success: execution of " << cmd << std::endl;
+            exited = (result == process_id);
+            break;
+        }
 
-            //Clean up by waiting / telling the child that it can "destroy itself"
-            int status;
-            waitpid(process_id, &status, 0); //0 -> no flags here
+        if (remaining_ms() <= 0)
+        {
+            timed_out = true;
+            break;
         }
-        else
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    if (!exited)
+    {
+        kill_process(process_id, command_output_kill_ms);
+    }
+
+    //Same as for the former shell wrapper (if [ $? != 0 ]; then echo 'ERROR'; fi)
+    if (!exited || !WIFEXITED(status) || WEXITSTATUS(status) != 0)
+    {
+        out += "ERROR\n";
+    }
+
+    //Return the obtained msg
+    return out;
+}
+
+bool ProgramExecutor::needs_shell(const char* cmd)
+{
+    //Anything that sh would interpret instead of just splitting the command at whitespace
+    return std::strpbrk(cmd, "|&;<>()$`\\\"'*?[]#~=%{}!\n") != nullptr;
+}
+
+int ProgramExecutor::spawn_process(const char* cmd, int stdout_fd)
+{
+    std::vector<std::string> arguments;
+    bool use_shell = needs_shell(cmd);
+    if (!use_shell)
+    {
+        std::stringstream stream(cmd);
+        std::string argument;
+        while (stream >> argument)
         {
-            kill_process(process_id, 100);
+            arguments.push_back(argument);
         }
+        use_shell = arguments.empty();
+    }
+    if (use_shell)
+    {
+        arguments = {"bash", "-c", cmd};
+    }
 
-        close(command_pipe[0]);
+    std::vector<char*> argv;
+    for (auto& argument : arguments)
+    {
+        argv.push_back(&argument[0]);
+    }
+    argv.push_back(nullptr);
+
+    //Set the group process ID of the new process to its process ID, or else things like kill(-pid) to kill a ping-while-loop won't work
+    posix_spawnattr_t attributes;
+    posix_spawnattr_init(&attributes);
+    posix_spawnattr_setflags(&attributes, POSIX_SPAWN_SETPGROUP);
+    posix_spawnattr_setpgroup(&attributes, 0);
+
+    posix_spawn_file_actions_t file_actions;
+    posix_spawn_file_actions_init(&file_actions);
+    if (stdout_fd >= 0)
+    {
+        posix_spawn_file_actions_adddup2(&file_actions, stdout_fd, STDOUT_FILENO);
+    }
 
-        //Return the obtained msg
-        return out;
+    //Unlike fork(), this does not copy the page tables of the (possibly large) calling process
+    pid_t process_id;
+    int error;
+    if (use_shell)
+    {
+        error = posix_spawn(&process_id, "/bin/sh", &file_actions, &attributes, argv.data(), environ);
     }
-    else 
+    else
+    {
+        error = posix_spawnp(&process_id, argv.at(0), &file_actions, &attributes, argv.data(), environ);
+    }
+
+    posix_spawn_file_actions_destroy(&file_actions);
+    posix_spawnattr_destroy(&attributes);
+
+    if (error != 0)
     {
         //We could not spawn a new process - usually, the program should not just break at this point, unless that behaviour is desired
         std::stringstream error_msg;
-        error_msg << "Error in ProgramExecutor class: Could not create child process in execute_command_get_output, command: " << cmd;
+        error_msg << "Error in ProgramExecutor class: Could not create child process: " << std::strerror(error) << ", command: " << cmd;
         log(error_msg.str());
-        return "ERROR";
+        return -1;
     }
+
+    return process_id;
 }
 
 bool ProgramExecutor::send_answer_msg(int msqid, std::string command_output, long command_id, bool execution_success)
@@ -590,34 +698,7 @@ bool ProgramExecutor::receive_answer_msg(int msqid, long command_id, AnswerMsg&
 
 int ProgramExecutor::execute_command_get_pid(const char* cmd)
 {
-    int process_id = fork();
-    if (process_id == 0)
-    {
-        //Tell the child to set its group process ID to its process ID, or else things like kill(-pid) to kill a ping-while-loop won't work
-        setpgid(0, 0);
-        
-        //Actions to take within the new child process
-        //ACHTUNG: NUTZE chmod u+x für die Files, sonst: permission denied
-        execl("/bin/sh", "bash", "-c", cmd, NULL);
-
-        //Error if execlp returns, cannot log this as this is not the "master" child
-        std::cerr << "Execl error in ProgramExecutor class: %s, for execution of '%s'" << std::strerror(errno) << cmd << std::endl;
-
-        exit(EXIT_FAILURE);
-    }
-    else if (process_id > 0)
-    {
-        //We are in the parent process and got the child's PID
-        return process_id;
-    }
-    else 
-    {
-        //We could not spawn a new process - usually, the program should not just break at this point, unless that behaviour is desired
-        std::stringstream error_msg;
-        error_msg << "Error in execute_command_get_pid: Could not create child process for " << cmd;
-        log(error_msg.str());
-        exit(EXIT_FAILURE);
-    }
+    return spawn_process(cmd);
 }
 
 ProgramExecutor::PROCESS_STATE ProgramExecutor::get_child_process_state(int process_id)
@@ -672,6 +753,10 @@ bool ProgramExecutor::spawn_and_manage_process(const char* cmd, unsigned int tim
 
     //Spawn and manage new process
     int process_id = execute_command_get_pid(cmd);
+    if (process_id <= 0)
+    {
+        return false;
+    }
     auto start_time = std::chrono::high_resolution_clock::now();
 
     auto time_passed_ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - start_time).count();
@@ -13,8 +13,12 @@
 #include <sstream>
 #include <string>
 #include <thread>
+#include <vector>
 
 //To spawn a process & get its PID
+#include <fcntl.h>
+#include <spawn.h>
+#include <sys/epoll.h>
 #include <sys/msg.h>
 #include <sys/types.h>
 #include <sys/wait.h>
@@ -40,6 +44,9 @@
  * \ingroup lcc
  */
 class ProgramExecutor {
+    //! Runs the private command execution functions directly, see test/ForkCommunicationTest.cpp
+    friend class ProgramExecutorTestAccess;
+
 public:
     /**
      * \brief Destructor; kill and wait for the child process, destroy the message queue
@@ -63,11 +70,10 @@ public:
     /**
      * \brief Call this function to start an external program, like a simulated vehicle etc.
      * You can use commands that would usually work in the terminal, like tmux commands.
-     * If no timeout is set, the command is started in the child using system(). Else, we
-     * fork explicitly, and kill the process after the timeout. During that time, other
-     * executions are "on hold" (no threads are used to allow to execute multiple commands
-     * with a timeout at once). Thus, commands can "pile up" in the msg queue for a while,
-     * but should finally be executed nonetheless.
+     * If no timeout is set, the command is started in the child and only waited for there. Else, 
+     * the process is killed after the timeout. Up to thread_pool_size commands are executed at once
+     * by the child, further commands "pile up" in the msg queue for a while, but should finally be 
+     * executed nonetheless. Commands without shell features are started directly, without a shell (see spawn_process).
      * 
      * If a timeout is set, the function also returns whether the executed command succeeded (= finished in time).
      * It also returns false if the command could not be sent via the IPC msg queue, either due to an internal failure or if the 
@@ -79,9 +85,10 @@ public:
     bool execute_command(std::string command, int timeout = -1);
 
     /**
-     * \brief Function to execute a shell command and get its output
+     * \brief Function to execute a shell command and get its output. Can be called by multiple threads at once,
+     * the commands are then executed concurrently by the child.
      * \param cmd A shell command
-     * \return Output of the shell command
+     * \return Output of the shell command (truncated to 5000 characters), with ERROR appended if it failed or timed out
      */
     std::string get_command_output(std::string cmd);
 
@@ -143,8 +150,15 @@ private:
     int msg_response_queue_id;
 
     //Variables for the child's thread pool
-    //! Amount of threads for parallel execution
-    const int thread_pool_size = 6;
+    //! Amount of threads for parallel execution, which is also the max. number of commands in flight at once
+    //! (each thread waits for the command it currently executes)
+    const int thread_pool_size = 16;
+    //! Timeout for commands of which the output is requested, SIGKILL is sent command_output_kill_ms after SIGTERM
+    const int command_output_timeout_ms = 10000;
+    //! See command_output_timeout_ms
+    const int command_output_kill_ms = 2000;
+    //! Size of the buffer for reading command outputs
+    static constexpr size_t read_buffer_size = 65536;
     //! Holds all worker threads
     std::vector<std::thread> thread_pool;
     //! Holds all open commands
@@ -279,13 +293,30 @@ private:
 
     /**
      * \brief Function to execute a shell command and get its output.
-     * Is currently not stopped if stop_threads becomes true. 
-     * But: A timeout of max. 10 seconds is always added to the command in the executing child 
-     * due to troubles with program errors before.
+     * The output is read in large blocks whenever epoll reports that the pipe is readable. The command is
+     * killed if it does not finish within timeout_ms or if stop_threads becomes true.
+     * \param cmd A shell command as C-String
+     * \param timeout_ms Time after which the command is killed
+     * \return Output of the shell command, with ERROR appended in case of a serious error, a command timeout or a non-zero exit code
+     */
+    std::string execute_command_get_output(const char* cmd, int timeout_ms);
+
+    /**
+     * \brief Checks if a command uses any shell features (pipes, redirections, quotes, variables, globbing, several commands...), 
+     * so that it cannot be started without a shell
+     * \param cmd A shell command as C-String
+     */
+    static bool needs_shell(const char* cmd);
+
+    /**
+     * \brief Start a command in a new process group, using posix_spawn (which uses vfork / clone without copying the
+     * memory of the calling process). Commands without shell features (see needs_shell) are started directly with their 
+     * arguments (separated by whitespace), else /bin/sh is used.
      * \param cmd A shell command as C-String
-     * \return Output of the shell command, or ERROR in case of a serious error or command timeout
+     * \param stdout_fd If >= 0, the stdout of the new process is redirected to this file descriptor
+     * \return PID of the new process, or -1 if it could not be started
      */
-    std::string execute_command_get_output(const char* cmd);
+    int spawn_process(const char* cmd, int stdout_fd = -1);
 
     /**
      * \brief Creates a command and manages it until it finished or a timeout occured or the HLC is no longer online; uses the three functions below.
@@ -299,7 +330,7 @@ private:
     /**
      * \brief Function to execute a shell command that returns the processes PID, so that the process can be controlled / monitored further
      * \param cmd A shell command as C-String
-     * \return Output of the shell command
+     * \return PID of the process, or -1 if it could not be started
      */
     int execute_command_get_pid(const char* cmd);
 
@@ -6,13 +6,24 @@
  */
 
 template<typename T>
-_TimeSeries<T>::_TimeSeries(string _name, string _format, string _unit)
-:name(_name)
+_TimeSeries<T>::_TimeSeries(string _name, string _format, string _unit, TimeSeriesStorage _storage)
+:storage(_storage)
+,samples(_storage.capacity)
+,name(_name)
 ,format(_format)
 ,unit(_unit)
 {
-    times.push_back(0);
-    values.push_back(T());
+    if constexpr (std::is_arithmetic<T>::value)
+    {
+        for (size_t level = 0; level < storage.levels; ++level)
+        {
+            buckets.emplace_back(new TimeSeriesRing<TimeSeriesBucket>(storage.bucket_capacity));
+        }
+        open_buckets.resize(storage.levels);
+        open_bucket_counts.resize(storage.levels, 0);
+    }
+
+    samples.push(Sample{0, T()});
 }
 
 
@@ -22,11 +33,40 @@ void _TimeSeries<T>::push_sample(uint64_t time, T value)
     // Lock scope
     {
         std::lock_guard<std::mutex> lock(m_mutex);
-        times.push_back(time);
-        values.push_back(value);   
+        samples.push(Sample{time, value});
+
+        if constexpr (std::is_arithmetic<T>::value)
+        {
+            // Each completed bucket is added to the open bucket of the next level
+            const double v = static_cast<double>(value);
+            TimeSeriesBucket entry{time, time, v, v, v};
+            for (size_t level = 0; level < buckets.size(); ++level)
+            {
+                TimeSeriesBucket &open_bucket = open_buckets[level];
+                if (open_bucket_counts[level] == 0)
+                {
+                    open_bucket = entry;
+                }
+                else
+                {
+                    open_bucket.time_last = entry.time_last;
+                    open_bucket.min = std::min(open_bucket.min, entry.min);
+                    open_bucket.max = std::max(open_bucket.max, entry.max);
+                    open_bucket.mean += entry.mean;
+                }
+
+                open_bucket_counts[level]++;
+                if (open_bucket_counts[level] < storage.bucket_factor) break;
+
+                open_bucket.mean /= static_cast<double>(open_bucket_counts[level]);
+                open_bucket_counts[level] = 0;
+                buckets[level]->push(open_bucket);
+                entry = open_bucket;
+            }
+        }
     }
 
-    for(auto callback : new_sample_callbacks)
+    for(const auto &callback : new_sample_callbacks)
     {
         if(callback)
         {
@@ -45,8 +85,9 @@ string _TimeSeries<T>::format_value(double value)
 template<typename T>
 T _TimeSeries<T>::get_latest_value() const
 {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    return values.back();
+    Sample sample{0, T()};
+    samples.read_newest(sample);
+    return sample.value;
 }
 
 
@@ -60,24 +101,86 @@ bool _TimeSeries<T>::has_new_data(double dt) const
 template<typename T>
 bool _TimeSeries<T>::has_data() const 
 {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    return ! (values.empty());
+    return samples.total() > 0;
 }
 
 template<typename T>
 uint64_t _TimeSeries<T>::get_latest_time() const
 {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    return times.back();
+    Sample sample{0, T()};
+    samples.read_newest(sample);
+    return sample.time;
 }
 
 template<typename T>
 vector<T> _TimeSeries<T>::get_last_n_values(size_t n) const 
 {
-    if(values.size() <= n) return values;
+    vector<Sample> last_samples;
+    samples.read_last(n, last_samples);
+
+    vector<T> values;
+    values.reserve(last_samples.size());
+    for (const auto &sample : last_samples) values.push_back(sample.value);
+    return values;
+}
+
+template<typename T>
+void _TimeSeries<T>::get_last_n_samples(size_t n, vector<uint64_t> &out_times, vector<T> &out_values) const 
+{
+    vector<Sample> last_samples;
+    samples.read_last(n, last_samples);
+
+    out_times.resize(last_samples.size());
+    out_values.resize(last_samples.size());
+    for (size_t i = 0; i < last_samples.size(); ++i)
+    {
+        out_times[i] = last_samples[i].time;
+        out_values[i] = last_samples[i].value;
+    }
+}
+
+template<typename T>
+uint64_t _TimeSeries<T>::get_samples_since(uint64_t begin, vector<uint64_t> &out_times, vector<T> &out_values) const 
+{
+    // The ring also holds the initial sample of the constructor
+    vector<Sample> new_samples;
+    const uint64_t first = samples.read_since(begin + 1, new_samples) - 1;
+
+    out_times.resize(new_samples.size());
+    out_values.resize(new_samples.size());
+    for (size_t i = 0; i < new_samples.size(); ++i)
+    {
+        out_times[i] = new_samples[i].time;
+        out_values[i] = new_samples[i].value;
+    }
+    return first;
+}
 
-    return vector<T>(values.end()-n, values.end());
+template<typename T>
+vector<TimeSeriesBucket> _TimeSeries<T>::get_downsampled(size_t level, size_t n) const 
+{
+    vector<TimeSeriesBucket> result;
+    if (level < buckets.size())
+    {
+        buckets[level]->read_last(n, result);
+    }
+    return result;
+}
+
+template<typename T>
+uint64_t _TimeSeries<T>::get_sample_count() const 
+{
+    // Without the initial sample of the constructor
+    return samples.total() - 1;
+}
+
+template<typename T>
+size_t _TimeSeries<T>::get_memory_usage() const 
+{
+    size_t memory = samples.memory_usage();
+    for (const auto &level : buckets) memory += level->memory_usage();
+    return memory;
 }
 
 template class _TimeSeries<double>;
-template class _TimeSeries<TrajectoryPoint>;
\ No newline at end of file
+template class _TimeSeries<TrajectoryPoint>;
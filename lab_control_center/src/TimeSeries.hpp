@@ -1,10 +1,51 @@
 #pragma once
 #include "defaults.hpp"
+#include "TimeSeriesRing.hpp"
 #include "VehicleCommandTrajectory.hpp"
 #include "cpm/get_time_ns.hpp"
 
 /**
- * \brief Data class for storing values & (receive) times to get latest / newest data etc
+ * \brief Min, max and mean of consecutive samples of a _TimeSeries, see _TimeSeries::get_downsampled
+ * \ingroup lcc
+ */
+struct TimeSeriesBucket
+{
+    //! Receive time of the first sample in the bucket
+    uint64_t time_first;
+    //! Receive time of the last sample in the bucket
+    uint64_t time_last;
+    //! Smallest value
+    double min;
+    //! Largest value
+    double max;
+    //! Mean value
+    double mean;
+};
+
+/**
+ * \brief Sizes of the storage of a _TimeSeries. The most recent samples are kept at full rate,
+ * older ones only as buckets with min / max / mean on one or more coarser levels.
+ * The memory per time series is fixed, the defaults need about 95 kB for TimeSeries and keep
+ * 40 s at full rate, 160 s in buckets of 16 samples, 45 min in buckets of 256 samples and
+ * 12 h in buckets of 4096 samples at 50 Hz.
+ * \ingroup lcc
+ */
+struct TimeSeriesStorage
+{
+    //! Number of samples kept at full rate
+    size_t capacity = 2048;
+    //! Number of samples (first level) or buckets (further levels) that are combined into one bucket
+    size_t bucket_factor = 16;
+    //! Number of buckets kept per level
+    size_t bucket_capacity = 512;
+    //! Number of downsampled levels, only used for arithmetic types
+    size_t levels = 3;
+};
+
+/**
+ * \brief Data class for storing values & (receive) times to get latest / newest data etc.
+ * The storage is bounded (see TimeSeriesStorage). There is one writer (the DDS callback), which is
+ * never blocked by readers (the UI), which get consistent copies (see TimeSeriesRing).
  * \ingroup lcc
  */
 template<typename T>
@@ -13,10 +54,27 @@ class _TimeSeries
     //! TODO
     vector<function<void(_TimeSeries&, uint64_t time, T value)>> new_sample_callbacks;
 
-    //! TODO
-    vector<uint64_t> times;
-    //! TODO
-    vector<T> values;
+    /**
+     * \brief One received value
+     */
+    struct Sample
+    {
+        //! Receive time
+        uint64_t time;
+        //! Value
+        T value;
+    };
+
+    //! Sizes of the rings
+    const TimeSeriesStorage storage;
+    //! Most recent samples at full rate
+    TimeSeriesRing<Sample> samples;
+    //! Downsampled levels, each bucket of level i combines storage.bucket_factor entries of level i-1 (or samples)
+    vector<std::unique_ptr<TimeSeriesRing<TimeSeriesBucket>>> buckets;
+    //! Buckets that are still being filled, one per level, only accessed by the writer. mean holds the sum until the bucket is complete.
+    vector<TimeSeriesBucket> open_buckets;
+    //! Number of entries in open_buckets
+    vector<size_t> open_bucket_counts;
 
     //! TODO
     const string name;
@@ -25,8 +83,8 @@ class _TimeSeries
     //! TODO
     const string unit;
 
-    //! TODO
-    mutable std::mutex m_mutex;
+    //! Serializes writers, readers do not use it
+    std::mutex m_mutex;
 
 public:
     /**
@@ -34,8 +92,9 @@ public:
      * \param _name TODO
      * \param _format TODO
      * \param _unit TODO
+     * \param _storage Sizes of the bounded storage
      */
-    _TimeSeries(string _name, string _format, string _unit);
+    _TimeSeries(string _name, string _format, string _unit, TimeSeriesStorage _storage = TimeSeriesStorage());
 
     /**
      * \brief TODO
@@ -87,6 +146,47 @@ public:
      */
     vector<T> get_last_n_values(size_t n) const;
 
+    /**
+     * \brief Consistent copy of the most recent samples at full rate, oldest first,
+     * at most TimeSeriesStorage::capacity
+     * \param n Maximum number of samples
+     * \param out_times Receive times
+     * \param out_values Values
+     */
+    void get_last_n_samples(size_t n, vector<uint64_t> &out_times, vector<T> &out_values) const;
+
+    /**
+     * \brief Consistent copy of the samples at full rate from the given sample index up to the newest, oldest first.
+     * Samples that are no longer stored are skipped.
+     * \param begin Index of the first sample, counted like get_sample_count (0 is the first received sample)
+     * \param out_times Receive times
+     * \param out_values Values
+     * \return Index of the first copied sample, begin unless it is no longer stored
+     */
+    uint64_t get_samples_since(uint64_t begin, vector<uint64_t> &out_times, vector<T> &out_values) const;
+
+    /**
+     * \brief Most recent complete buckets of a downsampled level, oldest first. Empty for non-arithmetic types.
+     * \param level 0 for buckets of TimeSeriesStorage::bucket_factor samples, 1 for buckets of bucket_factor^2 samples etc.
+     * \param n Maximum number of buckets
+     */
+    vector<TimeSeriesBucket> get_downsampled(size_t level, size_t n) const;
+
+    /**
+     * \brief Number of downsampled levels
+     */
+    size_t get_downsampled_levels() const {return buckets.size();}
+
+    /**
+     * \brief Number of samples received so far
+     */
+    uint64_t get_sample_count() const;
+
+    /**
+     * \brief Heap memory of the storage in bytes, constant
+     */
+    size_t get_memory_usage() const;
+
 };
 
 /**
@@ -42,65 +42,31 @@ TimeSeriesAggregator::TimeSeriesAggregator(uint8_t max_vehicle_id)
 
 void TimeSeriesAggregator::create_vehicle_timeseries(uint8_t vehicle_id) 
 {
-    timeseries_vehicles[vehicle_id] = map<string, shared_ptr<TimeSeries>>();
-
-    timeseries_vehicles[vehicle_id]["reference_deviation"] = make_shared<TimeSeries>(
-        "Reference Deviation", "%6.2f", "m");
-
-    timeseries_vehicles[vehicle_id]["pose_x"] = make_shared<TimeSeries>(
-        "Position X", "%6.2f", "m");
-
-    timeseries_vehicles[vehicle_id]["pose_y"] = make_shared<TimeSeries>(
-        "Position Y", "%6.2f", "m");
-
-    timeseries_vehicles[vehicle_id]["pose_yaw"] = make_shared<TimeSeries>(
-        "Yaw", "%6.3f", "rad");
-
-    timeseries_vehicles[vehicle_id]["ips_dt"] = make_shared<TimeSeries>(
-        "IPS age", "%3.0f", "ms");
-
-    timeseries_vehicles[vehicle_id]["speed"] = make_shared<TimeSeries>(
-        "Speed", "%5.2f", "m/s");
-    
-    timeseries_vehicles[vehicle_id]["battery_level"] = make_shared<TimeSeries>(
-        "Battery Level", "%3.0f", "%");
-
-    timeseries_vehicles[vehicle_id]["clock_delta"] = make_shared<TimeSeries>(
-        "Clock Delta", "%5.1f", "ms");
-
-    timeseries_vehicles[vehicle_id]["ips_x"] = make_shared<TimeSeries>(
-        "IPS Position X", "%6.2f", "m");
-
-    timeseries_vehicles[vehicle_id]["ips_y"] = make_shared<TimeSeries>(
-        "IPS Position Y", "%6.2f", "m");
-
-    timeseries_vehicles[vehicle_id]["ips_yaw"] = make_shared<TimeSeries>(
-        "IPS Yaw", "%6.3f", "rad");
-
-    timeseries_vehicles[vehicle_id]["odometer_distance"] = make_shared<TimeSeries>(
-        "Odometer Distance", "%7.2f", "m");
-
-    timeseries_vehicles[vehicle_id]["imu_acceleration_forward"] = make_shared<TimeSeries>(
-        "Acceleration Forward", "%4.1f", "m/s^2");
-
-    timeseries_vehicles[vehicle_id]["imu_acceleration_left"] = make_shared<TimeSeries>(
-        "Acceleration Left", "%4.1f", "m/s^2");
-
-    timeseries_vehicles[vehicle_id]["battery_voltage"] = make_shared<TimeSeries>(
-        "Battery Voltage", "%5.2f", "V");
-
-    timeseries_vehicles[vehicle_id]["motor_current"] = make_shared<TimeSeries>(
-        "Motor Current", "%5.2f", "A");
-
-    timeseries_vehicles[vehicle_id]["is_real"] = make_shared<TimeSeries>(
-        "Is Real", "%d", "-");
+    timeseries_vehicles[vehicle_id] = VehicleTimeSeries::create();
+    timeseries_vehicles_active[vehicle_id] = true;
+}
 
-    //To detect deviations from the required message frequency
-    timeseries_vehicles[vehicle_id]["last_msg_state"] = make_shared<TimeSeries>(
-    "VehicleState age", "%ull", "ms");
-    timeseries_vehicles[vehicle_id]["last_msg_observation"] = make_shared<TimeSeries>(
-    "VehicleObservation age", "%ull", "ms");
+VehicleTimeSeries& TimeSeriesAggregator::get_or_create_vehicle_timeseries(uint8_t vehicle_id)
+{
+    if(!timeseries_vehicles_active[vehicle_id])
+    {
+        create_vehicle_timeseries(vehicle_id);
+        update_vehicle_data_view();
+    }
+    return timeseries_vehicles[vehicle_id];
+}
 
+void TimeSeriesAggregator::update_vehicle_data_view()
+{
+    auto vehicles = make_shared<VehicleData::Map>();
+    for (size_t vehicle_id = 0; vehicle_id < timeseries_vehicles.size(); ++vehicle_id)
+    {
+        if(timeseries_vehicles_active[vehicle_id])
+        {
+            vehicles->emplace_hint(vehicles->end(), static_cast<uint8_t>(vehicle_id), timeseries_vehicles[vehicle_id]);
+        }
+    }
+    vehicle_data_view = VehicleData(vehicles);
 }
 
 /**
@@ -138,27 +104,24 @@ void TimeSeriesAggregator::handle_new_vehicleState_samples(std::vector<VehicleSt
     const uint64_t now = cpm::get_time_ns();
     for(auto& state : samples)
     {
-        if(timeseries_vehicles.count(state.vehicle_id()) == 0)
-        {
-            create_vehicle_timeseries(state.vehicle_id());
-        }
-        timeseries_vehicles[state.vehicle_id()]["pose_x"]                   ->push_sample(now, state.pose().x());
-        timeseries_vehicles[state.vehicle_id()]["pose_y"]                   ->push_sample(now, state.pose().y());
-        timeseries_vehicles[state.vehicle_id()]["pose_yaw"]                 ->push_sample(now, state.pose().yaw());
-        timeseries_vehicles[state.vehicle_id()]["speed"]                    ->push_sample(now, state.speed());
-        timeseries_vehicles[state.vehicle_id()]["battery_level"]            ->push_sample(now, voltage_to_percent(state.battery_voltage()));
-        timeseries_vehicles[state.vehicle_id()]["clock_delta"]              ->push_sample(now, double(int64_t(now)- int64_t(state.header().create_stamp().nanoseconds()))/1e6 );
-        timeseries_vehicles[state.vehicle_id()]["odometer_distance"]        ->push_sample(now, state.odometer_distance());
-        timeseries_vehicles[state.vehicle_id()]["imu_acceleration_forward"] ->push_sample(now, state.imu_acceleration_forward());
-        timeseries_vehicles[state.vehicle_id()]["imu_acceleration_left"]    ->push_sample(now, state.imu_acceleration_left());
-        timeseries_vehicles[state.vehicle_id()]["battery_voltage"]          ->push_sample(now, state.battery_voltage());
-        timeseries_vehicles[state.vehicle_id()]["motor_current"]            ->push_sample(now, state.motor_current());
-        timeseries_vehicles[state.vehicle_id()]["is_real"]                  ->push_sample(now, state.is_real());
+        const VehicleTimeSeries& vehicle_timeseries = get_or_create_vehicle_timeseries(state.vehicle_id());
+        vehicle_timeseries.at(VehicleDataField::pose_x)                  ->push_sample(now, state.pose().x());
+        vehicle_timeseries.at(VehicleDataField::pose_y)                  ->push_sample(now, state.pose().y());
+        vehicle_timeseries.at(VehicleDataField::pose_yaw)                ->push_sample(now, state.pose().yaw());
+        vehicle_timeseries.at(VehicleDataField::speed)                   ->push_sample(now, state.speed());
+        vehicle_timeseries.at(VehicleDataField::battery_level)           ->push_sample(now, voltage_to_percent(state.battery_voltage()));
+        vehicle_timeseries.at(VehicleDataField::clock_delta)             ->push_sample(now, double(int64_t(now)- int64_t(state.header().create_stamp().nanoseconds()))/1e6 );
+        vehicle_timeseries.at(VehicleDataField::odometer_distance)       ->push_sample(now, state.odometer_distance());
+        vehicle_timeseries.at(VehicleDataField::imu_acceleration_forward)->push_sample(now, state.imu_acceleration_forward());
+        vehicle_timeseries.at(VehicleDataField::imu_acceleration_left)   ->push_sample(now, state.imu_acceleration_left());
+        vehicle_timeseries.at(VehicleDataField::battery_voltage)         ->push_sample(now, state.battery_voltage());
+        vehicle_timeseries.at(VehicleDataField::motor_current)           ->push_sample(now, state.motor_current());
+        vehicle_timeseries.at(VehicleDataField::is_real)                 ->push_sample(now, state.is_real());
         // initialize reference deviation, since no reference is available at start 
-        timeseries_vehicles[state.vehicle_id()]["reference_deviation"]      ->push_sample(now, 0.0);
-        timeseries_vehicles[state.vehicle_id()]["ips_dt"]                   ->push_sample(now, static_cast<double>(1e-6*state.IPS_update_age_nanoseconds()));
+        vehicle_timeseries.at(VehicleDataField::reference_deviation)     ->push_sample(now, 0.0);
+        vehicle_timeseries.at(VehicleDataField::ips_dt)                  ->push_sample(now, static_cast<double>(1e-6*state.IPS_update_age_nanoseconds()));
         //To detect deviations from the required message frequency
-        timeseries_vehicles[state.vehicle_id()]["last_msg_state"]           ->push_sample(now, static_cast<double>(1e-6*now)); //Just remember the latest msg time and calculate diff in the UI
+        vehicle_timeseries.at(VehicleDataField::last_msg_state)          ->push_sample(now, static_cast<double>(1e-6*now)); //Just remember the latest msg time and calculate diff in the UI
 
         //Check for deviation from expected update frequency once, reset if deviation was detected
         auto it = last_vehicle_state_time_dev.find(state.vehicle_id());
@@ -198,17 +161,14 @@ void TimeSeriesAggregator::handle_new_vehicleObservation_samples(
     const uint64_t now = cpm::get_time_ns();
     for(auto& state : samples)
     {
-        if(timeseries_vehicles.count(state.vehicle_id()) == 0)
-        {
-            create_vehicle_timeseries(state.vehicle_id());
-        }
-        timeseries_vehicles[state.vehicle_id()]["ips_x"]  ->push_sample(now, state.pose().x());
-        timeseries_vehicles[state.vehicle_id()]["ips_y"]  ->push_sample(now, state.pose().y());
-        timeseries_vehicles[state.vehicle_id()]["ips_yaw"]->push_sample(now, state.pose().yaw());
+        const VehicleTimeSeries& vehicle_timeseries = get_or_create_vehicle_timeseries(state.vehicle_id());
+        vehicle_timeseries.at(VehicleDataField::ips_x)  ->push_sample(now, state.pose().x());
+        vehicle_timeseries.at(VehicleDataField::ips_y)  ->push_sample(now, state.pose().y());
+        vehicle_timeseries.at(VehicleDataField::ips_yaw)->push_sample(now, state.pose().yaw());
         // timeseries to check if any IPS data are available, push any data 
         //timeseries_vehicles[state.vehicle_id()]["ips"]    ->push_sample(now, true);
         //To detect deviations from the required message frequency
-        timeseries_vehicles[state.vehicle_id()]["last_msg_observation"] ->push_sample(now, static_cast<double>(1e-6*now)); //Just remember the latest msg time and calculate diff in the UI
+        vehicle_timeseries.at(VehicleDataField::last_msg_observation) ->push_sample(now, static_cast<double>(1e-6*now)); //Just remember the latest msg time and calculate diff in the UI
 
         //Check for long intervals without new information - TODO: WHICH VALUE MAKES SENSE HERE?
         auto it = last_vehicle_observation_time.find(state.vehicle_id());
@@ -230,6 +190,7 @@ VehicleData TimeSeriesAggregator::get_vehicle_data() {
     //--------------------------------------------------------------------------- CHECKS ------------------------------------
     //This function is called regularly in the UI, so we make sure that everything is checked regularly just by putting the tests in here as well
     // - Check for deviations in vehicle state msgs
+    bool vehicles_removed = false;
     for (auto it = last_vehicle_state_time.begin(); it != last_vehicle_state_time.end(); /*No ++ because this depends on whether a deletion took place*/)
     {
         //We use another structure for check_for_deviation here, because that function manipulates the entries given the iterator (may set to zero)
@@ -243,7 +204,9 @@ VehicleData TimeSeriesAggregator::get_vehicle_data() {
         if (now - it->second > max_allowed_age)
         {
             last_vehicle_observation_time.erase(it->first);
-            timeseries_vehicles.erase(it->first);
+            timeseries_vehicles[it->first] = VehicleTimeSeries();
+            timeseries_vehicles_active[it->first] = false;
+            vehicles_removed = true;
             it = last_vehicle_state_time.erase(it);
         }
         else
@@ -253,7 +216,13 @@ VehicleData TimeSeriesAggregator::get_vehicle_data() {
     }
     //--------------------------------------------------------------------------- ------- ------------------------------------
 
-    return timeseries_vehicles; 
+    if (vehicles_removed)
+    {
+        update_vehicle_data_view();
+    }
+
+    //Copying the view only copies a shared pointer
+    return vehicle_data_view; 
 }
 
 VehicleTrajectories TimeSeriesAggregator::get_vehicle_trajectory_commands() {
@@ -301,7 +270,9 @@ VehiclePathTracking TimeSeriesAggregator::get_vehicle_path_tracking_commands() {
 void TimeSeriesAggregator::reset_all_data()
 {
     std::lock_guard<std::mutex> lock(_mutex);
-    timeseries_vehicles.clear();
+    timeseries_vehicles.fill(VehicleTimeSeries());
+    timeseries_vehicles_active.fill(false);
+    update_vehicle_data_view();
     vehicle_commandTrajectory_reader = make_shared<cpm::MultiVehicleReader<VehicleCommandTrajectory>>(
         cpm::get_topic<VehicleCommandTrajectory>("vehicleCommandTrajectory"),
         vehicle_ids
@@ -4,6 +4,7 @@
 #include "VehicleState.hpp"
 #include "VehicleObservation.hpp"
 #include "TimeSeries.hpp"
+#include "VehicleData.hpp"
 #include "VehicleCommandTrajectory.hpp"
 #include "VehicleCommandPathTracking.hpp"
 
@@ -13,19 +14,10 @@
 #include "cpm/MultiVehicleReader.hpp"
 #include "cpm/get_time_ns.hpp"
 
+#include <array>
 #include <mutex>
 #include <unordered_map>
 
-/**
- * \brief Definition for VehicleData.
- * 
- * Outer Map: Vehicle ID (uint8_t) -> Inner Map
- * 
- * InnerMap: Identifier (e.g. "ips_x", "speed", ...) -> TimeSeries data for that identifier
- * \ingroup lcc
- */
-using VehicleData = map<uint8_t, map<string, shared_ptr<TimeSeries> > >;
-
 /**
  * \brief Definition for VehicleTrajectories.
  * 
@@ -49,31 +41,30 @@ using VehiclePathTracking = map<uint8_t, VehicleCommandPathTracking >;
 */
 class TimeSeriesAggregator
 {
-    //! Includes all current received vehicle data (pose, speed, battery level...), mapped to a vehicle ID
-    VehicleData timeseries_vehicles;
+    //! Includes all current received vehicle data (pose, speed, battery level...), one slot per vehicle ID, only valid if the vehicle is active
+    std::array<VehicleTimeSeries, 256> timeseries_vehicles;
+    //! Whether a slot in timeseries_vehicles is in use
+    std::array<bool, 256> timeseries_vehicles_active{};
+    //! Read-only snapshot of the active vehicles that is handed out by get_vehicle_data, replaced when vehicles are added or removed
+    VehicleData vehicle_data_view;
 
     /**
-     * \brief Creates entry for timeseries_vehicles for a vehicle, vehicle ID -> map of IDs (like speed) -> TimeSeries values. 
-     * Initializes the second map by constructing the time series entries, e.g. for speed, battery level...
+     * \brief Creates the time series (e.g. for speed, battery level...) of a vehicle in timeseries_vehicles.
+     * Call update_vehicle_data_view afterwards.
      * \param vehicle_id The vehicle ID to create the entry for
      */
     void create_vehicle_timeseries(uint8_t vehicle_id);
 
     /**
-     * \brief Takes samples by vehicle_state_reader and stores them in timeseries_vehicles.
-     * Also checks for deviation regarding the expected update frequency of the received entries.
-     * Deviations for entries where no update is performed are detected outside this class,
-     * when in the UI the currenty newest sample in timeseries_vehicles is determined to be out of date.
-     * \param samples The newly received VehicleState samples
+     * \brief Time series of a vehicle, created if it did not exist yet
+     * \param vehicle_id The vehicle ID
      */
-    void handle_new_vehicleState_samples(std::vector<VehicleState>& samples);
+    VehicleTimeSeries& get_or_create_vehicle_timeseries(uint8_t vehicle_id);
 
     /**
-     * \brief Takes samples by vehicle_observation_reader and stores them in timeseries_vehicles.
-     * Also checks for deviation regarding the expected update frequency of the received entries.
-     * \param samples The newly received VehicleObservation samples
+     * \brief Replaces vehicle_data_view by a snapshot of the currently active vehicles
      */
-    void handle_new_vehicleObservation_samples(std::vector<VehicleObservation>& samples);
+    void update_vehicle_data_view();
 
     //! Async. reader to receive vehicle state data from the vehicles and store them for later access in the LCC
     shared_ptr<cpm::AsyncReader<VehicleState>> vehicle_state_reader;
@@ -120,7 +111,25 @@ public:
     TimeSeriesAggregator(uint8_t max_vehicle_id);
 
     /**
-     * \brief Get current received vehicle data
+     * \brief Takes samples by vehicle_state_reader and stores them in timeseries_vehicles.
+     * Also checks for deviation regarding the expected update frequency of the received entries.
+     * Deviations for entries where no update is performed are detected outside this class,
+     * when in the UI the currenty newest sample in timeseries_vehicles is determined to be out of date.
+     * Public to be able to feed recorded or generated samples as well.
+     * \param samples The newly received VehicleState samples
+     */
+    void handle_new_vehicleState_samples(std::vector<VehicleState>& samples);
+
+    /**
+     * \brief Takes samples by vehicle_observation_reader and stores them in timeseries_vehicles.
+     * Also checks for deviation regarding the expected update frequency of the received entries.
+     * Public to be able to feed recorded or generated samples as well.
+     * \param samples The newly received VehicleObservation samples
+     */
+    void handle_new_vehicleObservation_samples(std::vector<VehicleObservation>& samples);
+
+    /**
+     * \brief Get current received vehicle data, as a cheap read-only view (no copy of the time series)
      */
     VehicleData get_vehicle_data();
 
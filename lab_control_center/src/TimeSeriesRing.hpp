@@ -0,0 +1,197 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+/**
+ * \class TimeSeriesRing
+ * \brief Fixed-capacity ring buffer with a single writer and any number of readers, used by _TimeSeries.
+ *
+ * Readers never block the writer: For trivially copyable elements, a reader copies the elements it wants
+ * and afterwards checks (like a seqlock) whether the writer has started to overwrite any of them in the
+ * meantime. In that case, it retries. There is one spare slot, so the writer only interferes with a reader
+ * if it pushes more than one element during the copy.
+ * Other element types are protected by a mutex instead.
+ *
+ * Concurrent writers must be serialized by the caller.
+ * \ingroup lcc
+ */
+template<typename E>
+class TimeSeriesRing
+{
+    //! Whether the lock-free read can be used
+    static constexpr bool lock_free = std::is_trivially_copyable<E>::value;
+
+    //! Maximum number of stored elements
+    size_t capacity;
+    //! capacity + 1, the spare slot is the one that is currently written
+    size_t n_slots;
+    //! Slots, element i (counted from the first push) is in slot i % n_slots
+    std::unique_ptr<E[]> slots;
+    //! Number of elements whose write has started
+    std::atomic<uint64_t> write_begin{0};
+    //! Number of elements whose write has finished
+    std::atomic<uint64_t> write_end{0};
+    //! Only used if the elements are not trivially copyable
+    mutable std::mutex slots_mutex;
+
+public:
+    /**
+     * \brief Constructor, allocates all slots
+     * \param _capacity Maximum number of stored elements, at least 1
+     */
+    explicit TimeSeriesRing(size_t _capacity)
+    :capacity(std::max<size_t>(1, _capacity))
+    ,n_slots(capacity + 1)
+    ,slots(new E[n_slots])
+    {
+    }
+
+    TimeSeriesRing(const TimeSeriesRing&) = delete;
+    TimeSeriesRing& operator=(const TimeSeriesRing&) = delete;
+
+    /**
+     * \brief Appends an element, overwrites the oldest one if the ring is full. Single writer only.
+     * \param element The new element
+     */
+    void push(const E& element)
+    {
+        const uint64_t index = write_end.load(std::memory_order_relaxed);
+        if constexpr (lock_free)
+        {
+            write_begin.store(index + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            slots[index % n_slots] = element;
+            write_end.store(index + 1, std::memory_order_release);
+        }
+        else
+        {
+            std::lock_guard<std::mutex> lock(slots_mutex);
+            slots[index % n_slots] = element;
+            write_begin.store(index + 1, std::memory_order_relaxed);
+            write_end.store(index + 1, std::memory_order_release);
+        }
+    }
+
+    /**
+     * \brief Number of elements pushed so far (including overwritten ones)
+     */
+    uint64_t total() const
+    {
+        return write_end.load(std::memory_order_acquire);
+    }
+
+    /**
+     * \brief Maximum number of stored elements
+     */
+    size_t get_capacity() const
+    {
+        return capacity;
+    }
+
+    /**
+     * \brief Consistent copy of the newest elements, oldest first
+     * \param n Maximum number of elements
+     * \param out Output, replaced
+     */
+    void read_last(size_t n, std::vector<E>& out) const
+    {
+        if constexpr (!lock_free)
+        {
+            std::lock_guard<std::mutex> lock(slots_mutex);
+            const uint64_t end = write_end.load(std::memory_order_relaxed);
+            const uint64_t begin = end - std::min<uint64_t>({n, end, capacity});
+            out.clear();
+            for (uint64_t i = begin; i < end; ++i) out.push_back(slots[i % n_slots]);
+            return;
+        }
+
+        for (int attempt = 0; ; ++attempt)
+        {
+            const uint64_t end = write_end.load(std::memory_order_acquire);
+            const uint64_t begin = end - std::min<uint64_t>({n, end, capacity});
+            out.resize(end - begin);
+            for (uint64_t i = begin; i < end; ++i) out[i - begin] = slots[i % n_slots];
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            const uint64_t overwritten = write_begin.load(std::memory_order_relaxed);
+            // Slots of elements with index < overwritten - n_slots may have been overwritten during the copy
+            if (overwritten <= begin + n_slots) return;
+
+            if (attempt > 100) std::this_thread::yield();
+        }
+    }
+
+    /**
+     * \brief Consistent copy of the elements from the given index (counted from the first push) up to the newest,
+     * oldest first. Elements that have already been overwritten are skipped.
+     * \param begin Index of the first element
+     * \param out Output, replaced
+     * \return Index of the first copied element, begin unless it has been overwritten
+     */
+    uint64_t read_since(uint64_t begin, std::vector<E>& out) const
+    {
+        if constexpr (!lock_free)
+        {
+            std::lock_guard<std::mutex> lock(slots_mutex);
+            const uint64_t end = write_end.load(std::memory_order_relaxed);
+            const uint64_t first = std::min(end, std::max(begin, end - std::min<uint64_t>(end, capacity)));
+            out.clear();
+            for (uint64_t i = first; i < end; ++i) out.push_back(slots[i % n_slots]);
+            return first;
+        }
+
+        for (int attempt = 0; ; ++attempt)
+        {
+            const uint64_t end = write_end.load(std::memory_order_acquire);
+            const uint64_t first = std::min(end, std::max(begin, end - std::min<uint64_t>(end, capacity)));
+            out.resize(end - first);
+            for (uint64_t i = first; i < end; ++i) out[i - first] = slots[i % n_slots];
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            const uint64_t overwritten = write_begin.load(std::memory_order_relaxed);
+            if (overwritten <= first + n_slots) return first;
+
+            if (attempt > 100) std::this_thread::yield();
+        }
+    }
+
+    /**
+     * \brief Consistent copy of the newest element
+     * \param out Output
+     * \return false if the ring is empty
+     */
+    bool read_newest(E& out) const
+    {
+        if constexpr (!lock_free)
+        {
+            std::lock_guard<std::mutex> lock(slots_mutex);
+            const uint64_t end = write_end.load(std::memory_order_relaxed);
+            if (end == 0) return false;
+            out = slots[(end - 1) % n_slots];
+            return true;
+        }
+
+        for (;;)
+        {
+            const uint64_t end = write_end.load(std::memory_order_acquire);
+            if (end == 0) return false;
+            out = slots[(end - 1) % n_slots];
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (write_begin.load(std::memory_order_relaxed) <= end - 1 + n_slots) return true;
+        }
+    }
+
+    /**
+     * \brief Heap memory of the slots in bytes
+     */
+    size_t memory_usage() const
+    {
+        return n_slots * sizeof(E);
+    }
+};
@@ -0,0 +1,121 @@
+#include "VehicleData.hpp"
+
+#include <stdexcept>
+
+/**
+ * \file VehicleData.cpp
+ * \ingroup lcc
+ */
+
+/**
+ * \brief Key, name, format and unit of a VehicleDataField
+ * \ingroup lcc
+ */
+struct VehicleDataFieldInfo
+{
+    //! Key as used in the UI
+    string key;
+    //! Name shown in the UI
+    string name;
+    //! printf format of the value
+    string format;
+    //! Unit shown in the UI
+    string unit;
+};
+
+/**
+ * \brief Infos of all fields, in the order of VehicleDataField
+ * \ingroup lcc
+ */
+static const std::array<VehicleDataFieldInfo, vehicle_data_field_count>& vehicle_data_field_infos()
+{
+    static const std::array<VehicleDataFieldInfo, vehicle_data_field_count> infos = {{
+        {"reference_deviation",         "Reference Deviation",      "%6.2f",    "m"},
+        {"pose_x",                      "Position X",               "%6.2f",    "m"},
+        {"pose_y",                      "Position Y",               "%6.2f",    "m"},
+        {"pose_yaw",                    "Yaw",                      "%6.3f",    "rad"},
+        {"ips_dt",                      "IPS age",                  "%3.0f",    "ms"},
+        {"speed",                       "Speed",                    "%5.2f",    "m/s"},
+        {"battery_level",               "Battery Level",            "%3.0f",    "%"},
+        {"clock_delta",                 "Clock Delta",              "%5.1f",    "ms"},
+        {"ips_x",                       "IPS Position X",           "%6.2f",    "m"},
+        {"ips_y",                       "IPS Position Y",           "%6.2f",    "m"},
+        {"ips_yaw",                     "IPS Yaw",                  "%6.3f",    "rad"},
+        {"odometer_distance",           "Odometer Distance",        "%7.2f",    "m"},
+        {"imu_acceleration_forward",    "Acceleration Forward",     "%4.1f",    "m/s^2"},
+        {"imu_acceleration_left",       "Acceleration Left",        "%4.1f",    "m/s^2"},
+        {"battery_voltage",             "Battery Voltage",          "%5.2f",    "V"},
+        {"motor_current",               "Motor Current",            "%5.2f",    "A"},
+        {"is_real",                     "Is Real",                  "%d",       "-"},
+        //To detect deviations from the required message frequency
+        {"last_msg_state",              "VehicleState age",         "%ull",     "ms"},
+        {"last_msg_observation",        "VehicleObservation age",   "%ull",     "ms"}
+    }};
+    return infos;
+}
+
+const string& vehicle_data_field_key(VehicleDataField field)
+{
+    return vehicle_data_field_infos().at(static_cast<size_t>(field)).key;
+}
+
+bool vehicle_data_field_from_key(const string& key, VehicleDataField& out_field)
+{
+    const auto& infos = vehicle_data_field_infos();
+    for (size_t i = 0; i < infos.size(); ++i)
+    {
+        if (infos[i].key == key)
+        {
+            out_field = static_cast<VehicleDataField>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+VehicleTimeSeries VehicleTimeSeries::create()
+{
+    VehicleTimeSeries vehicle_timeseries;
+    const auto& infos = vehicle_data_field_infos();
+    for (size_t i = 0; i < infos.size(); ++i)
+    {
+        vehicle_timeseries.fields[i] = make_shared<TimeSeries>(infos[i].name, infos[i].format, infos[i].unit);
+    }
+    return vehicle_timeseries;
+}
+
+const shared_ptr<TimeSeries>& VehicleTimeSeries::at(const string& key) const
+{
+    VehicleDataField field;
+    if (!vehicle_data_field_from_key(key, field))
+    {
+        throw std::out_of_range("VehicleTimeSeries: unknown key " + key);
+    }
+    return at(field);
+}
+
+size_t VehicleTimeSeries::count(const string& key) const
+{
+    VehicleDataField field;
+    return vehicle_data_field_from_key(key, field) ? 1 : 0;
+}
+
+/**
+ * \brief Shared empty map for empty views
+ * \ingroup lcc
+ */
+static shared_ptr<const VehicleData::Map> empty_vehicle_map()
+{
+    static const shared_ptr<const VehicleData::Map> empty = make_shared<const VehicleData::Map>();
+    return empty;
+}
+
+VehicleData::VehicleData()
+:vehicles(empty_vehicle_map())
+{
+}
+
+VehicleData::VehicleData(shared_ptr<const Map> _vehicles)
+:vehicles(_vehicles ? _vehicles : empty_vehicle_map())
+{
+}
@@ -0,0 +1,145 @@
+#pragma once
+#include "defaults.hpp"
+#include "TimeSeries.hpp"
+
+#include <array>
+
+/**
+ * \enum VehicleDataField
+ * \brief The time series that the TimeSeriesAggregator keeps for each vehicle, used as index into VehicleTimeSeries
+ * \ingroup lcc
+ */
+enum class VehicleDataField : size_t
+{
+    reference_deviation,
+    pose_x,
+    pose_y,
+    pose_yaw,
+    ips_dt,
+    speed,
+    battery_level,
+    clock_delta,
+    ips_x,
+    ips_y,
+    ips_yaw,
+    odometer_distance,
+    imu_acceleration_forward,
+    imu_acceleration_left,
+    battery_voltage,
+    motor_current,
+    is_real,
+    last_msg_state,
+    last_msg_observation,
+    //! Number of fields, not a field
+    COUNT
+};
+
+/**
+ * \brief Number of entries in VehicleDataField
+ * \ingroup lcc
+ */
+constexpr size_t vehicle_data_field_count = static_cast<size_t>(VehicleDataField::COUNT);
+
+/**
+ * \brief Key of the field as used in the UI (e.g. "pose_x")
+ * \param field The field
+ * \ingroup lcc
+ */
+const string& vehicle_data_field_key(VehicleDataField field);
+
+/**
+ * \brief Field for a key as returned by vehicle_data_field_key
+ * \param key The key, e.g. "pose_x"
+ * \param out_field The field, if the key exists
+ * \return false if there is no such field
+ * \ingroup lcc
+ */
+bool vehicle_data_field_from_key(const string& key, VehicleDataField& out_field);
+
+/**
+ * \class VehicleTimeSeries
+ * \brief All time series of one vehicle, indexed by VehicleDataField. Copies share the time series.
+ * \ingroup lcc
+ */
+class VehicleTimeSeries
+{
+    //! One time series per field
+    std::array<shared_ptr<TimeSeries>, vehicle_data_field_count> fields;
+
+public:
+    /**
+     * \brief Creates all time series (name, format and unit per field)
+     */
+    static VehicleTimeSeries create();
+
+    /**
+     * \brief Time series of a field
+     * \param field The field
+     */
+    const shared_ptr<TimeSeries>& at(VehicleDataField field) const
+    {
+        return fields[static_cast<size_t>(field)];
+    }
+
+    /**
+     * \brief Time series of a field, by key (see vehicle_data_field_key). Prefer at(VehicleDataField) in frequently called code.
+     * Throws std::out_of_range for unknown keys, like map::at.
+     * \param key The key, e.g. "pose_x"
+     */
+    const shared_ptr<TimeSeries>& at(const string& key) const;
+
+    /**
+     * \brief 1 if the key exists, else 0, like map::count
+     * \param key The key, e.g. "pose_x"
+     */
+    size_t count(const string& key) const;
+};
+
+/**
+ * \class VehicleData
+ * \brief Read-only view of the time series of all vehicles, vehicle ID -> VehicleTimeSeries.
+ *
+ * The view is an immutable snapshot that the TimeSeriesAggregator only replaces when vehicles are added or removed,
+ * so copies are cheap (one shared pointer). The time series themselves are shared and keep receiving new samples.
+ * Supports the read-only interface of the map that was used before (iteration in ID order, at, find, count).
+ * \ingroup lcc
+ */
+class VehicleData
+{
+public:
+    //! Vehicle ID -> time series of the vehicle
+    using Map = map<uint8_t, VehicleTimeSeries>;
+    //! Iterator type
+    using const_iterator = Map::const_iterator;
+
+private:
+    //! Shared, never modified after construction
+    shared_ptr<const Map> vehicles;
+
+public:
+    /**
+     * \brief Empty view
+     */
+    VehicleData();
+
+    /**
+     * \brief View of the given vehicles
+     * \param _vehicles Must not be modified afterwards
+     */
+    explicit VehicleData(shared_ptr<const Map> _vehicles);
+
+    //! Begin of the vehicles, in ID order
+    const_iterator begin() const {return vehicles->begin();}
+    //! End of the vehicles
+    const_iterator end() const {return vehicles->end();}
+    //! Vehicle entry or end()
+    const_iterator find(uint8_t vehicle_id) const {return vehicles->find(vehicle_id);}
+    //! Time series of a vehicle, throws std::out_of_range if the vehicle does not exist
+    const VehicleTimeSeries& at(uint8_t vehicle_id) const {return vehicles->at(vehicle_id);}
+    //! 1 if the vehicle exists, else 0
+    size_t count(uint8_t vehicle_id) const {return vehicles->count(vehicle_id);}
+    //! Number of vehicles
+    size_t size() const {return vehicles->size();}
+    //! Whether there is no vehicle
+    bool empty() const {return vehicles->empty();}
+};
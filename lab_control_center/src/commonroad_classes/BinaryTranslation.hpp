@@ -0,0 +1,172 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+/**
+ * \class BinaryWriter
+ * \brief Appends values in their in-memory representation to a buffer, used to store translated commonroad objects in the
+ * binary scenario cache (see CommonRoadBinaryCache). The cache is only read on the machine that wrote it, thus no
+ * endianness conversion takes place.
+ * \ingroup lcc_commonroad
+ */
+class BinaryWriter
+{
+    //! Written data
+    std::string buffer;
+
+public:
+    /**
+     * \brief Append a trivially copyable value (number, enum)
+     * \param value The value
+     */
+    template<typename T> void write(const T& value)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "Only trivially copyable types can be written directly");
+        buffer.append(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    /**
+     * \brief Append an optional value: a flag for its existence, then the value if it exists
+     * \param value The optional value
+     */
+    template<typename T> void write_optional(const std::optional<T>& value)
+    {
+        write<uint8_t>(value.has_value());
+        if (value.has_value())
+        {
+            write(value.value());
+        }
+    }
+
+    /**
+     * \brief Append a vector of trivially copyable values: its size, then the values
+     * \param values The vector
+     */
+    template<typename T> void write_vector(const std::vector<T>& values)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "Only trivially copyable types can be written directly");
+        write<uint64_t>(values.size());
+        buffer.append(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(T));
+    }
+
+    /**
+     * \brief Append a string: its size, then its characters
+     * \param text The string
+     */
+    void write_string(const std::string& text)
+    {
+        write<uint64_t>(text.size());
+        buffer.append(text);
+    }
+
+    /**
+     * \brief The written data
+     */
+    const std::string& get_buffer() const
+    {
+        return buffer;
+    }
+};
+
+/**
+ * \class BinaryReader
+ * \brief Reads values written by BinaryWriter from a memory region (e.g. a memory-mapped cache file), in the same order.
+ * Throws std::runtime_error if the data ends unexpectedly, so that a corrupt cache can be detected.
+ * \ingroup lcc_commonroad
+ */
+class BinaryReader
+{
+    //! Start of the memory region, not owned
+    const char* data;
+    //! Size of the memory region
+    size_t size;
+    //! Current read position
+    size_t position = 0;
+
+    /**
+     * \brief Throws if less than n bytes are left
+     * \param n Number of bytes that are about to be read
+     */
+    void require(size_t n) const
+    {
+        if (n > size - position)
+        {
+            throw std::runtime_error("BinaryReader: Unexpected end of data");
+        }
+    }
+
+public:
+    /**
+     * \brief Constructor
+     * \param _data Start of the memory region, must outlive the reader
+     * \param _size Size of the memory region
+     */
+    BinaryReader(const char* _data, size_t _size) : data(_data), size(_size) {}
+
+    /**
+     * \brief Read a trivially copyable value (number, enum)
+     */
+    template<typename T> T read()
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "Only trivially copyable types can be read directly");
+        require(sizeof(T));
+        T value;
+        std::memcpy(&value, data + position, sizeof(T));
+        position += sizeof(T);
+        return value;
+    }
+
+    /**
+     * \brief Read an optional value written with BinaryWriter::write_optional
+     */
+    template<typename T> std::optional<T> read_optional()
+    {
+        if (read<uint8_t>())
+        {
+            return std::optional<T>(read<T>());
+        }
+        return std::nullopt;
+    }
+
+    /**
+     * \brief Read a vector written with BinaryWriter::write_vector
+     */
+    template<typename T> std::vector<T> read_vector()
+    {
+        const uint64_t count = read<uint64_t>();
+        if (count > (size - position) / sizeof(T))
+        {
+            throw std::runtime_error("BinaryReader: Unexpected end of data");
+        }
+        std::vector<T> values(count);
+        std::memcpy(values.data(), data + position, count * sizeof(T));
+        position += count * sizeof(T);
+        return values;
+    }
+
+    /**
+     * \brief Read a string written with BinaryWriter::write_string
+     */
+    std::string read_string()
+    {
+        const uint64_t length = read<uint64_t>();
+        require(length);
+        std::string text(data + position, length);
+        position += length;
+        return text;
+    }
+
+    /**
+     * \brief Current read position in bytes from the start of the memory region
+     */
+    size_t get_position() const
+    {
+        return position;
+    }
+};
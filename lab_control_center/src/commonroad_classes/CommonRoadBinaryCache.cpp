@@ -0,0 +1,251 @@
+#include "commonroad_classes/CommonRoadBinaryCache.hpp"
+
+#include <cerrno>
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <experimental/filesystem>
+
+/**
+ * \file CommonRoadBinaryCache.cpp
+ * \ingroup lcc_commonroad
+ */
+
+/**
+ * \struct CacheFileHeader
+ * \brief Start of each cache file, followed by the entries and the XML document
+ * \ingroup lcc_commonroad
+ */
+struct CacheFileHeader
+{
+    //! Identifies cache files
+    char magic[8];
+    //! CommonRoadBinaryCache::format_version
+    uint32_t version;
+    //! Size of this struct, detects incompatible builds
+    uint32_t header_size;
+    //! Key of the scenario file
+    CommonRoadBinaryCache::SourceKey key;
+    //! Number of entries
+    uint64_t entry_count;
+    //! Size of the entries in bytes
+    uint64_t entries_size;
+    //! Size of the XML document in bytes
+    uint64_t xml_size;
+};
+
+/**
+ * \brief Magic bytes at the start of each cache file
+ * \ingroup lcc_commonroad
+ */
+static const char cache_file_magic[8] = {'C', 'P', 'M', 'C', 'R', 'B', 'I', 'N'};
+
+/**
+ * \brief FNV-1a hash, processing 8 bytes at a time (the remaining bytes one at a time)
+ * \param data Start of the data
+ * \param size Size of the data
+ * \ingroup lcc_commonroad
+ */
+static uint64_t fnv1a_hash(const char* data, size_t size)
+{
+    uint64_t hash = 14695981039346656037ull;
+    const uint64_t prime = 1099511628211ull;
+
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8)
+    {
+        uint64_t word;
+        std::memcpy(&word, data + i, 8);
+        hash = (hash ^ word) * prime;
+    }
+    for (; i < size; ++i)
+    {
+        hash = (hash ^ static_cast<unsigned char>(data[i])) * prime;
+    }
+    return hash;
+}
+
+CommonRoadBinaryCache::MappedScenario::~MappedScenario()
+{
+    if (mapping)
+    {
+        munmap(const_cast<char*>(mapping), mapping_size);
+    }
+}
+
+BinaryReader CommonRoadBinaryCache::MappedScenario::get_entries() const
+{
+    return BinaryReader(mapping + entries_offset, entries_size);
+}
+
+uint64_t CommonRoadBinaryCache::MappedScenario::get_entry_count() const
+{
+    return entry_count;
+}
+
+std::string CommonRoadBinaryCache::MappedScenario::get_xml() const
+{
+    return std::string(mapping + xml_offset, xml_size);
+}
+
+CommonRoadBinaryCache::CommonRoadBinaryCache(std::string _cache_directory)
+    :
+    cache_directory(_cache_directory)
+{
+}
+
+std::string CommonRoadBinaryCache::get_cache_filepath(const std::string& xml_filepath) const
+{
+    //The same scenario file might be loaded with different relative paths
+    std::string absolute_path = xml_filepath;
+    char resolved_path[PATH_MAX];
+    if (realpath(xml_filepath.c_str(), resolved_path))
+    {
+        absolute_path = resolved_path;
+    }
+
+    std::stringstream cache_filepath;
+    cache_filepath << cache_directory << "/" << std::hex << fnv1a_hash(absolute_path.data(), absolute_path.size()) << ".bin";
+    return cache_filepath.str();
+}
+
+std::optional<CommonRoadBinaryCache::SourceKey> CommonRoadBinaryCache::get_source_key(const std::string& xml_filepath)
+{
+    int fd = open(xml_filepath.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        return std::nullopt;
+    }
+
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) != 0)
+    {
+        close(fd);
+        return std::nullopt;
+    }
+
+    SourceKey key;
+    key.size = static_cast<uint64_t>(file_stat.st_size);
+    key.modification_time = static_cast<int64_t>(file_stat.st_mtim.tv_sec) * 1000000000ll + file_stat.st_mtim.tv_nsec;
+
+    if (key.size > 0)
+    {
+        void* data = mmap(nullptr, key.size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED)
+        {
+            close(fd);
+            return std::nullopt;
+        }
+        madvise(data, key.size, MADV_SEQUENTIAL);
+        key.hash = fnv1a_hash(static_cast<const char*>(data), key.size);
+        munmap(data, key.size);
+    }
+    else
+    {
+        key.hash = fnv1a_hash(nullptr, 0);
+    }
+
+    close(fd);
+    return key;
+}
+
+std::unique_ptr<CommonRoadBinaryCache::MappedScenario> CommonRoadBinaryCache::load(const std::string& xml_filepath, const SourceKey& key) const
+{
+    int fd = open(get_cache_filepath(xml_filepath).c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        return nullptr;
+    }
+
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) != 0 || static_cast<size_t>(file_stat.st_size) < sizeof(CacheFileHeader))
+    {
+        close(fd);
+        return nullptr;
+    }
+
+    const size_t file_size = static_cast<size_t>(file_stat.st_size);
+    void* data = mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED)
+    {
+        return nullptr;
+    }
+
+    auto scenario = std::unique_ptr<MappedScenario>(new MappedScenario());
+    scenario->mapping = static_cast<const char*>(data);
+    scenario->mapping_size = file_size;
+
+    CacheFileHeader header;
+    std::memcpy(&header, data, sizeof(CacheFileHeader));
+
+    const bool valid = std::memcmp(header.magic, cache_file_magic, sizeof(cache_file_magic)) == 0
+        && header.version == format_version
+        && header.header_size == sizeof(CacheFileHeader)
+        && header.key.size == key.size
+        && header.key.modification_time == key.modification_time
+        && header.key.hash == key.hash
+        && header.entries_size <= file_size - sizeof(CacheFileHeader)
+        && header.xml_size == file_size - sizeof(CacheFileHeader) - header.entries_size;
+    if (!valid)
+    {
+        //Outdated or incomplete, unmapped by the destructor
+        return nullptr;
+    }
+
+    scenario->entries_offset = sizeof(CacheFileHeader);
+    scenario->entries_size = header.entries_size;
+    scenario->entry_count = header.entry_count;
+    scenario->xml_offset = sizeof(CacheFileHeader) + header.entries_size;
+    scenario->xml_size = header.xml_size;
+    return scenario;
+}
+
+bool CommonRoadBinaryCache::store(const std::string& xml_filepath, const SourceKey& key, const BinaryWriter& entries, uint64_t entry_count, const std::string& xml) const
+{
+    std::error_code error;
+    std::experimental::filesystem::create_directories(cache_directory, error);
+    if (error)
+    {
+        return false;
+    }
+
+    CacheFileHeader header;
+    std::memcpy(header.magic, cache_file_magic, sizeof(cache_file_magic));
+    header.version = format_version;
+    header.header_size = sizeof(CacheFileHeader);
+    header.key = key;
+    header.entry_count = entry_count;
+    header.entries_size = entries.get_buffer().size();
+    header.xml_size = xml.size();
+
+    //Write to a temporary file first, so that other LCC instances never read an incomplete cache file
+    const std::string cache_filepath = get_cache_filepath(xml_filepath);
+    const std::string temporary_filepath = cache_filepath + "." + std::to_string(getpid()) + ".tmp";
+
+    FILE* file = fopen(temporary_filepath.c_str(), "wb");
+    if (!file)
+    {
+        return false;
+    }
+
+    bool written = fwrite(&header, sizeof(CacheFileHeader), 1, file) == 1
+        && fwrite(entries.get_buffer().data(), 1, entries.get_buffer().size(), file) == entries.get_buffer().size()
+        && fwrite(xml.data(), 1, xml.size(), file) == xml.size();
+    written = (fclose(file) == 0) && written;
+
+    if (!written || rename(temporary_filepath.c_str(), cache_filepath.c_str()) != 0)
+    {
+        unlink(temporary_filepath.c_str());
+        return false;
+    }
+    return true;
+}
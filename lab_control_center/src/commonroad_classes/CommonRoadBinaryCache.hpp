@@ -0,0 +1,142 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+
+#include "commonroad_classes/BinaryTranslation.hpp"
+
+/**
+ * \class CommonRoadBinaryCache
+ * \brief Versioned binary cache of translated commonroad scenarios, so that reloading a scenario does not require the XML
+ * translation of its lanelets, which make up most of large scenarios.
+ * One cache file exists per scenario file. It contains the translated lanelets and, as a (much smaller) XML document,
+ * all other elements of the scenario, in document order. The cache is only used if its version matches and if size,
+ * modification time and content hash of the scenario file are the same as when the cache was written.
+ * Cache files are memory-mapped for reading.
+ * \ingroup lcc_commonroad
+ */
+class CommonRoadBinaryCache
+{
+public:
+    //! Must be increased whenever the binary format of any cached class changes
+    static constexpr uint32_t format_version = 1;
+
+    /**
+     * \enum EntryType
+     * \brief Type of an entry of the cache, stored in front of each entry
+     */
+    enum EntryType : uint8_t
+    {
+        //! Lanelet stored with Lanelet::write_binary
+        LaneletEntry = 0,
+        //! Next element of the XML document of the remaining elements
+        XMLEntry = 1
+    };
+
+    /**
+     * \struct SourceKey
+     * \brief Identifies the content of a scenario file
+     */
+    struct SourceKey
+    {
+        //! File size in bytes
+        uint64_t size = 0;
+        //! Modification time in ns since epoch
+        int64_t modification_time = 0;
+        //! FNV-1a hash of the file content
+        uint64_t hash = 0;
+    };
+
+    /**
+     * \class MappedScenario
+     * \brief A valid cache file, memory-mapped as long as the object exists
+     */
+    class MappedScenario
+    {
+        //! Start of the mapping
+        const char* mapping = nullptr;
+        //! Size of the mapping
+        size_t mapping_size = 0;
+        //! Offset of the entries in the mapping
+        size_t entries_offset = 0;
+        //! Size of the entries
+        size_t entries_size = 0;
+        //! Number of entries
+        uint64_t entry_count = 0;
+        //! Offset of the XML document of the remaining elements in the mapping
+        size_t xml_offset = 0;
+        //! Size of the XML document
+        size_t xml_size = 0;
+
+        friend class CommonRoadBinaryCache;
+
+    public:
+        MappedScenario() = default;
+        MappedScenario(const MappedScenario&) = delete;
+        MappedScenario& operator=(const MappedScenario&) = delete;
+
+        /**
+         * \brief Unmaps the file
+         */
+        ~MappedScenario();
+
+        /**
+         * \brief Reader for the entries, each starts with its EntryType
+         */
+        BinaryReader get_entries() const;
+
+        /**
+         * \brief Number of entries
+         */
+        uint64_t get_entry_count() const;
+
+        /**
+         * \brief XML document (root node with attributes, all elements except for lanelets)
+         */
+        std::string get_xml() const;
+    };
+
+private:
+    //! Directory of the cache files
+    std::string cache_directory;
+
+    /**
+     * \brief Path of the cache file for a scenario file
+     * \param xml_filepath Path to the scenario file
+     */
+    std::string get_cache_filepath(const std::string& xml_filepath) const;
+
+public:
+    /**
+     * \brief Constructor
+     * \param _cache_directory Directory of the cache files, created when the first cache file is written
+     */
+    CommonRoadBinaryCache(std::string _cache_directory);
+
+    /**
+     * \brief Size, modification time and content hash of a file, or nullopt if it cannot be read
+     * \param xml_filepath Path to the scenario file
+     */
+    static std::optional<SourceKey> get_source_key(const std::string& xml_filepath);
+
+    /**
+     * \brief Maps the cache file of a scenario file, if it exists, has the current format_version and matches the key.
+     * Returns nullptr otherwise.
+     * \param xml_filepath Path to the scenario file
+     * \param key Key of the current content of the scenario file
+     */
+    std::unique_ptr<MappedScenario> load(const std::string& xml_filepath, const SourceKey& key) const;
+
+    /**
+     * \brief Writes the cache file of a scenario file (atomically, by renaming a temporary file).
+     * Returns false if the file could not be written.
+     * \param xml_filepath Path to the scenario file
+     * \param key Key of the content of the scenario file that was translated
+     * \param entries Entries, each starting with its EntryType
+     * \param entry_count Number of entries
+     * \param xml XML document of the remaining elements
+     */
+    bool store(const std::string& xml_filepath, const SourceKey& key, const BinaryWriter& entries, uint64_t entry_count, const std::string& xml) const;
+};
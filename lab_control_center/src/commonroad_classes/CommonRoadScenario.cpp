@@ -5,6 +5,25 @@
  * \ingroup lcc_commonroad
  */
 
+/**
+ * \brief Increments the revision of the scenario when it goes out of scope. Declare it before the locks of a function
+ * that changes the scenario, so that it is destroyed after the locks have been released (also if an error is thrown)
+ * \ingroup lcc_commonroad
+ */
+struct ScenarioRevisionIncrement
+{
+    //! Revision to increment
+    std::atomic<uint64_t>& revision;
+
+    /**
+     * \brief Increments the revision
+     */
+    ~ScenarioRevisionIncrement()
+    {
+        ++revision;
+    }
+};
+
 CommonRoadScenario::CommonRoadScenario()
 {
     //Sets up YAML storage for transformations of XML files stored in between sessions, done implicitly (yaml_transformation_storage)
@@ -70,6 +89,10 @@ void CommonRoadScenario::clear_data()
     dynamic_obstacles.clear();
     environment_obstacles.clear();
     planning_problems.clear();
+    lanelet_traffic_sign_positions.clear();
+    lanelet_traffic_light_positions.clear();
+    lanelet_index.clear();
+    static_obstacle_index.clear();
 
     if (reset_obstacle_sim_manager)
     {
@@ -105,6 +128,9 @@ void CommonRoadScenario::load_file(std::string xml_filepath, bool center_coordin
     //File_is_loading has been set to true with this operation as well, so other load_file calls
     //that got to the if(...) after the atomic operation are stopped
 
+    //The map view redraws the scenario when the revision changed
+    ScenarioRevisionIncrement revision_increment{revision};
+
     //This mutex exists for other operations than loading a file (e.g. drawing)
     //While a file loads, these operations either wait or abort (with try_lock)
     //Before throwing errors, we don't need to call unlock (follows RAII)
@@ -113,33 +139,35 @@ void CommonRoadScenario::load_file(std::string xml_filepath, bool center_coordin
     //Delete all old data
     clear_data();
 
-    //Translate new data
-    xmlpp::DomParser parser;
+    //Key of the file content before translating it, so that a change during the translation is not hidden by the cache
+    const bool cache_enabled = use_binary_cache.load();
+    std::optional<CommonRoadBinaryCache::SourceKey> source_key;
+    if (cache_enabled)
+    {
+        source_key = CommonRoadBinaryCache::get_source_key(xml_filepath);
+    }
+
+    //Translate new data, from the binary cache if it is up to date
+    bool translated_from_cache = false;
+    BinaryWriter cache_entries;
+    uint64_t cache_entry_count = 0;
+    std::string cache_xml;
     try
     {
-        //Parse XML file (DOM parser)
-        //xmlpp::KeepBlanks::KeepBlanks(false);
-        //Ignore whitespaces (see http://xmlsoft.org/html/libxml-parser.html#xmlParserOption)
-        parser.set_parser_options(256); //Remove blank nodes
-        parser.parse_file(xml_filepath);
-        if(!parser) {
-            std::cerr << "Cannot parse file!" << std::endl;
-            LCCErrorLogger::Instance().log_error("CommonRoadScenario: Cannot parse file!");
+        if (source_key.has_value())
+        {
+            translated_from_cache = translate_binary_cache(xml_filepath, source_key.value());
         }
 
-        //Get parent node
-        const auto pNode = parser.get_document()->get_root_node(); //deleted by DomParser.
-
-        //Store scenario attributes
-        translate_attributes(pNode);
-
-        //We want to go through the first layer of the CommonRoadScenario only - the objects that we want to store take the parsing from here 
-        //Thus, we go through the children of the scenario and parse each of them using according constructors
-        for(const auto& child : pNode->get_children())
+        if (!translated_from_cache)
         {
-            translate_element(child);
+            translate_xml_file(
+                xml_filepath, 
+                source_key.has_value() ? &cache_entries : nullptr, 
+                cache_entry_count, 
+                source_key.has_value() ? &cache_xml : nullptr
+            );
         }
-
     }
     catch(const SpecificationError& e)
     {
@@ -183,6 +211,15 @@ void CommonRoadScenario::load_file(std::string xml_filepath, bool center_coordin
         LCCErrorLogger::Instance().log_error("CommonRoadScenario: All relevant data fields are empty (except for version / author / affiliation)");
     }
 
+    //Store the translation before it is transformed, only valid translations are cached
+    if (source_key.has_value() && !translated_from_cache)
+    {
+        if (!binary_cache.store(xml_filepath, source_key.value(), cache_entries, cache_entry_count, cache_xml))
+        {
+            LCCErrorLogger::Instance().log_error("CommonRoadScenario: Could not write the binary cache for " + xml_filepath);
+        }
+    }
+
     //Apply transformation from location, if that exists
     if (location.has_value())
     {
@@ -207,6 +244,9 @@ void CommonRoadScenario::load_file(std::string xml_filepath, bool center_coordin
         transform_coordinate_system_helper(- center.first + 2.25, - center.second + 2.0);
     }
 
+    //Positions are final now (transform_coordinate_system_helper rebuilds the index on later transformations)
+    build_spatial_index();
+
     //Unlock the file write mutex for the following functions, which might need access to the data
     load_lock.unlock();
 
@@ -224,6 +264,114 @@ void CommonRoadScenario::load_file(std::string xml_filepath, bool center_coordin
     file_is_loading.store(false);
 }
 
+void CommonRoadScenario::set_binary_cache_enabled(bool enabled)
+{
+    use_binary_cache.store(enabled);
+}
+
+void CommonRoadScenario::set_spatial_index_enabled(bool enabled)
+{
+    use_spatial_index.store(enabled);
+}
+
+void CommonRoadScenario::translate_xml_file(const std::string& xml_filepath, BinaryWriter* cache_entries, uint64_t& cache_entry_count, std::string* cache_xml)
+{
+    cache_entry_count = 0;
+
+    //Each element of the first layer is translated using the according constructors as soon as it has been parsed
+    CommonRoadStreamingParser parser(
+        [&] (const xmlpp::Node* root_node) {
+            //Store scenario attributes
+            translate_attributes(root_node);
+        },
+        [&] (const xmlpp::Node* node) {
+            translate_element(node);
+
+            if (!cache_entries)
+            {
+                return false;
+            }
+
+            //Lanelets are stored in binary form, all other elements remain in the XML document of the cache
+            ++cache_entry_count;
+            if (node->get_name() == "lanelet")
+            {
+                cache_entries->write<uint8_t>(CommonRoadBinaryCache::LaneletEntry);
+                lanelets.at(xml_translation::get_attribute_int(node, "id", true).value()).write_binary(*cache_entries);
+                return false;
+            }
+            cache_entries->write<uint8_t>(CommonRoadBinaryCache::XMLEntry);
+            return true;
+        }
+    );
+    parser.parse(xml_filepath);
+
+    if (cache_xml)
+    {
+        *cache_xml = parser.get_document().write_to_string();
+    }
+}
+
+bool CommonRoadScenario::translate_binary_cache(const std::string& xml_filepath, const CommonRoadBinaryCache::SourceKey& key)
+{
+    auto cached_scenario = binary_cache.load(xml_filepath, key);
+    if (!cached_scenario)
+    {
+        return false;
+    }
+
+    try
+    {
+        BinaryReader entries = cached_scenario->get_entries();
+        uint64_t remaining_entries = cached_scenario->get_entry_count();
+
+        //Restores lanelets up to the next XML entry, so that the elements are translated in document order
+        auto restore_until_xml_entry = [&] () {
+            while (remaining_entries > 0)
+            {
+                --remaining_entries;
+                if (entries.read<uint8_t>() == CommonRoadBinaryCache::XMLEntry)
+                {
+                    return true;
+                }
+
+                Lanelet lanelet(entries, lanelet_traffic_sign_positions, lanelet_traffic_light_positions, draw_configuration);
+                lanelets.insert({lanelet.get_id(), lanelet});
+            }
+            return false;
+        };
+
+        CommonRoadStreamingParser parser(
+            [&] (const xmlpp::Node* root_node) {
+                translate_attributes(root_node);
+            },
+            [&] (const xmlpp::Node* node) {
+                if (!restore_until_xml_entry())
+                {
+                    throw std::runtime_error("More XML elements than XML entries");
+                }
+                translate_element(node);
+                return false;
+            }
+        );
+        parser.parse_string(cached_scenario->get_xml());
+
+        if (restore_until_xml_entry())
+        {
+            throw std::runtime_error("Less XML elements than XML entries");
+        }
+    }
+    catch(const std::exception& e)
+    {
+        //The cache file was written by this program from a valid translation, so any error means that it is unusable
+        clear_data();
+        LCCErrorLogger::Instance().log_error(std::string("CommonRoadScenario: Ignoring invalid binary cache for ") + xml_filepath + ": " + e.what());
+        return false;
+    }
+
+    return true;
+}
+
 void CommonRoadScenario::translate_attributes(const xmlpp::Node* root_node)
 {
     //If no value: Error is thrown anyway (set to true) - so in this case, we can directly use .value()
@@ -642,6 +790,8 @@ void CommonRoadScenario::transform_coordinate_system_helper(double translate_x,
 
         //Update center
         calculate_center();
+
+        build_spatial_index();
     }
 
     //We do not update the yaml transformation storage here
@@ -730,6 +880,8 @@ std::optional<std::pair<double, double>> CommonRoadScenario::get_lanelet_light_p
 
 void CommonRoadScenario::transform_coordinate_system(double lane_width, double angle, double translate_x, double translate_y) 
 {
+    ScenarioRevisionIncrement revision_increment{revision};
+
     //If a file is loading, do not block the UI, needs to be done again then
     std::shared_lock<std::shared_mutex> load_lock(load_file_mutex, std::try_to_lock);
 
@@ -780,6 +932,8 @@ void CommonRoadScenario::set_time_step_size(double new_time_step_size)
     //Only accept physically meaningful & useful values
     if (new_time_step_size <= 0) return;
 
+    ScenarioRevisionIncrement revision_increment{revision};
+
     //If a file is loading, do not block the UI, needs to be done again then
     std::shared_lock<std::shared_mutex> load_lock(load_file_mutex, std::try_to_lock);
 
@@ -839,9 +993,31 @@ void CommonRoadScenario::draw(const DrawingContext& ctx, double scale, double gl
         ctx->rotate(global_orientation);
 
         ctx->set_source_rgb(0.5,0.5,0.5); //Also used within lanelets as default color
-        for (auto &lanelet_entry : lanelets)
+        if (use_spatial_index.load() && scale > 0.0)
         {
-            lanelet_entry.second.draw(ctx, scale);
+            //Only draw lanelets within the visible area (clip extents are given in the current user space, so they already consider the view transformation)
+            //The margin accounts for line widths and lanelet descriptions that may exceed the lanelet bounds
+            double clip_x_min, clip_y_min, clip_x_max, clip_y_max;
+            ctx->get_clip_extents(clip_x_min, clip_y_min, clip_x_max, clip_y_max);
+            const double margin = 0.1;
+            SpatialIndex::Box visible_area{
+                clip_x_min / scale - margin,
+                clip_x_max / scale + margin,
+                clip_y_min / scale - margin,
+                clip_y_max / scale + margin
+            };
+
+            for (int id : lanelet_index.query(visible_area))
+            {
+                lanelets.at(id).draw(ctx, scale);
+            }
+        }
+        else
+        {
+            for (auto &lanelet_entry : lanelets)
+            {
+                lanelet_entry.second.draw(ctx, scale);
+            }
         }
 
         //Obstacles are drawn elsewhere, as they are explicitly simulated within the LCC
@@ -905,6 +1081,8 @@ void CommonRoadScenario::apply_stored_transformation()
     double rotation = 0.0;
     yaml_transformation_storage.load_transformation_from_profile(time_scale, scale, translate_x, translate_y, rotation);
 
+    ScenarioRevisionIncrement revision_increment{revision};
+
     //Need to acquire shared mutex to prevent from writing changes and reloading during draw
     //Is RAII, so I won't call unlock
     //To not block the UI:
@@ -951,6 +1129,11 @@ std::shared_ptr<CommonroadDrawConfiguration> CommonRoadScenario::get_draw_config
     return draw_configuration;
 }
 
+uint64_t CommonRoadScenario::get_revision() const
+{
+    return revision.load();
+}
+
 //This one is private
 void CommonRoadScenario::calculate_center()
 {
@@ -1000,6 +1183,75 @@ void CommonRoadScenario::calculate_center()
     center.second = (0.5 * y_min) + (0.5 * y_max);
 }
 
+//This one is private
+void CommonRoadScenario::build_spatial_index()
+{
+    //As for calculate_center, the translation mutex must be locked by the caller
+
+    std::vector<std::pair<int, SpatialIndex::Box>> lanelet_boxes;
+    lanelet_boxes.reserve(lanelets.size());
+    for (auto &lanelet_entry : lanelets)
+    {
+        auto x_y_range = lanelet_entry.second.get_range_x_y();
+        if (x_y_range.has_value())
+        {
+            SpatialIndex::Box box;
+            box.x_min = x_y_range.value()[0][0];
+            box.x_max = x_y_range.value()[0][1];
+            box.y_min = x_y_range.value()[1][0];
+            box.y_max = x_y_range.value()[1][1];
+            lanelet_boxes.emplace_back(lanelet_entry.first, box);
+        }
+    }
+    lanelet_index.build(std::move(lanelet_boxes));
+
+    //Static obstacles do not move, so their initial position is used
+    std::vector<std::pair<int, SpatialIndex::Box>> obstacle_boxes;
+    for (auto &static_obstacle : static_obstacles)
+    {
+        try
+        {
+            auto simulation_data = static_obstacle.second.get_obstacle_simulation_data();
+            if (simulation_data.trajectory.size() == 0)
+            {
+                continue;
+            }
+            auto& initial_point = simulation_data.trajectory.at(0);
+
+            std::optional<SpatialIndex::Box> box;
+            if (initial_point.position.has_value())
+            {
+                const double x = initial_point.position->first;
+                const double y = initial_point.position->second;
+                box = SpatialIndex::get_bounding_box(initial_point.shape, x, y, initial_point.orientation.value_or(0.0));
+                if (!box.has_value())
+                {
+                    box = SpatialIndex::Box{x, x, y, y};
+                }
+            }
+            else if (initial_point.lanelet_ref.has_value() && lanelets.count(initial_point.lanelet_ref.value()) > 0)
+            {
+                auto x_y_range = lanelets.at(initial_point.lanelet_ref.value()).get_range_x_y();
+                if (x_y_range.has_value())
+                {
+                    box = SpatialIndex::Box{x_y_range.value()[0][0], x_y_range.value()[0][1], x_y_range.value()[1][0], x_y_range.value()[1][1]};
+                }
+            }
+
+            if (box.has_value())
+            {
+                obstacle_boxes.emplace_back(static_obstacle.first, box.value());
+            }
+        }
+        catch (const std::exception&)
+        {
+            //Obstacles without valid position are not part of the index, the error is reported by the obstacle simulation
+            continue;
+        }
+    }
+    static_obstacle_index.build(std::move(obstacle_boxes));
+}
+
 double CommonRoadScenario::get_time_step_size()
 {
     //Need to acquire shared mutex to prevent from writing changes and reloading during get
@@ -1199,6 +1451,69 @@ std::optional<Lanelet> CommonRoadScenario::get_lanelet(int id)
     return std::nullopt;
 }
 
+std::vector<int> CommonRoadScenario::get_lanelet_ids_in_area(double x_min, double x_max, double y_min, double y_max)
+{
+    //Need to acquire shared mutex to prevent from writing changes and reloading during get
+    //RAII, so no need to call unlock
+    std::shared_lock<std::shared_mutex> load_lock(load_file_mutex);
+    std::shared_lock<std::shared_mutex> read_lock(write_changes_mutex);
+
+    SpatialIndex::Box area{x_min, x_max, y_min, y_max};
+    if (use_spatial_index.load())
+    {
+        return lanelet_index.query(area);
+    }
+
+    std::vector<int> ids;
+    for (auto &lanelet_entry : lanelets)
+    {
+        auto x_y_range = lanelet_entry.second.get_range_x_y();
+        if (x_y_range.has_value() && area.intersects({x_y_range.value()[0][0], x_y_range.value()[0][1], x_y_range.value()[1][0], x_y_range.value()[1][1]}))
+        {
+            ids.push_back(lanelet_entry.first);
+        }
+    }
+    return ids;
+}
+
+std::optional<int> CommonRoadScenario::get_nearest_lanelet_id(double x, double y)
+{
+    //Need to acquire shared mutex to prevent from writing changes and reloading during get
+    //RAII, so no need to call unlock
+    std::shared_lock<std::shared_mutex> load_lock(load_file_mutex);
+    std::shared_lock<std::shared_mutex> read_lock(write_changes_mutex);
+
+    if (use_spatial_index.load())
+    {
+        return lanelet_index.nearest(x, y, [&] (int id) {
+            return lanelets.at(id).get_distance(x, y);
+        });
+    }
+
+    std::optional<int> nearest_id;
+    double nearest_distance = std::numeric_limits<double>::infinity();
+    for (auto &lanelet_entry : lanelets)
+    {
+        const double distance = lanelet_entry.second.get_distance(x, y);
+        if (!nearest_id.has_value() || distance < nearest_distance)
+        {
+            nearest_id = lanelet_entry.first;
+            nearest_distance = distance;
+        }
+    }
+    return nearest_id;
+}
+
+std::vector<int> CommonRoadScenario::get_static_obstacle_ids_in_area(double x_min, double x_max, double y_min, double y_max)
+{
+    //Need to acquire shared mutex to prevent from writing changes and reloading during get
+    //RAII, so no need to call unlock
+    std::shared_lock<std::shared_mutex> load_lock(load_file_mutex);
+    std::shared_lock<std::shared_mutex> read_lock(write_changes_mutex);
+
+    return static_obstacle_index.query({x_min, x_max, y_min, y_max});
+}
+
 std::pair<double, double> CommonRoadScenario::get_lanelet_center(int id)
 {
     //Mutex locking not necessary / possible here (called within draw from other objects)
@@ -31,6 +31,9 @@
 #include "commonroad_classes/XMLTranslation.hpp"
 
 #include "commonroad_classes/CommonRoadTransformation.hpp"
+#include "commonroad_classes/CommonRoadBinaryCache.hpp"
+#include "commonroad_classes/CommonRoadStreamingParser.hpp"
+#include "commonroad_classes/SpatialIndex.hpp"
 
 #include "commonroad_classes/CommonroadDrawConfiguration.hpp"
 
@@ -218,6 +221,44 @@ private:
     //! We do not want to load a file if a file is already currently being loaded
     std::atomic_bool file_is_loading{false};
 
+    //! Incremented whenever the drawn content changes (see get_revision), always after the mutexes have been released
+    std::atomic<uint64_t> revision{0};
+
+    //! Translated scenarios, to skip the XML translation of lanelets when a file is loaded again
+    CommonRoadBinaryCache binary_cache{"./commonroad_cache"};
+    //! If false, files are always translated from XML and no cache files are written
+    std::atomic_bool use_binary_cache{true};
+
+    //! Bounding boxes of all lanelets, rebuilt whenever the scenario is loaded or transformed
+    SpatialIndex lanelet_index;
+    //! Bounding boxes of all static obstacles at their initial position (or of their lanelet, if the position is given by a lanelet reference)
+    SpatialIndex static_obstacle_index;
+    //! If false, draw and the area / nearest lanelet queries look at all elements (e.g. for comparisons in benchmarks)
+    std::atomic_bool use_spatial_index{true};
+
+    /**
+     * \brief Rebuild lanelet_index and static_obstacle_index, must be called after all changes of lanelet or obstacle positions
+     * Should only be called within a locked-mutex section
+     */
+    void build_spatial_index();
+
+    /**
+     * \brief Translate the XML file with the streaming parser (one element of the first layer at a time)
+     * \param xml_filepath Path to the XML file
+     * \param cache_entries If not nullptr, the translated lanelets and placeholders for the other elements are stored here, in document order
+     * \param cache_entry_count Number of entries written to cache_entries
+     * \param cache_xml If not nullptr, the XML document of all elements except for lanelets is stored here
+     */
+    void translate_xml_file(const std::string& xml_filepath, BinaryWriter* cache_entries, uint64_t& cache_entry_count, std::string* cache_xml);
+
+    /**
+     * \brief Translate the scenario from its cache file, if the cache file is up to date
+     * \param xml_filepath Path to the XML file
+     * \param key Key of the current content of the XML file
+     * \return False if no valid cache file exists (then, no data was translated)
+     */
+    bool translate_binary_cache(const std::string& xml_filepath, const CommonRoadBinaryCache::SourceKey& key);
+
     /**
      * \brief This function provides a translation of the node attributes in XML (as string) to one the expected node attributes of the root node (warning if non-existant)
      * \param root_node root_node
@@ -327,11 +368,26 @@ public:
      * It gets an XML file and parses it once, translating it to the C++ data structure
      * From there on, the CommonRoadScenario Object can be used to access the scenario, send it to HLCs, fit it to the map etc
      * An error is thrown in case the XML file is invalid / does not match the expected CommonRoad specs
+     * The file is parsed with a streaming (SAX) parser. The translation is stored in a binary cache (./commonroad_cache),
+     * which is used instead of the XML translation if the same file is loaded again (see CommonRoadBinaryCache)
      * \param xml_filepath The path of the XML file that specificies the commonroad scenario
      * \param center_coordinates Center the coordinates of the scenario automatically
      */
     void load_file(std::string xml_filepath, bool center_coordinates = true);
 
+    /**
+     * \brief Enable or disable the binary cache of translated scenarios for the following calls of load_file (enabled by default)
+     * \param enabled If false, files are always translated from XML and no cache files are written
+     */
+    void set_binary_cache_enabled(bool enabled);
+
+    /**
+     * \brief Enable or disable the use of the spatial index (enabled by default). If disabled, draw does not cull lanelets that are
+     * outside of the visible area and the area / nearest lanelet queries check all elements of the scenario.
+     * \param enabled If false, the spatial index is not used
+     */
+    void set_spatial_index_enabled(bool enabled);
+
     /**
      * \brief This function is used to fit the imported XML scenario to a given min. lane width
      * The lane with min width gets assigned min. width by scaling the whole scenario up until it fits
@@ -385,6 +441,13 @@ public:
      */
     std::shared_ptr<CommonroadDrawConfiguration> get_draw_configuration();
 
+    /**
+     * \brief Changes whenever the content that draw() draws might have changed (new file, transformation, reset),
+     * so that the map view can cache the drawn scenario. Incremented after the change is complete, so a draw call that
+     * was skipped during the change (because the mutexes were locked) is always followed by a new revision.
+     */
+    uint64_t get_revision() const;
+
     //Getter
     //We need to be able to get and set time_step_size, to change the speed of the simulation
     /**
@@ -450,6 +513,29 @@ public:
      */
     std::optional<Lanelet> get_lanelet(int id);
 
+    /**
+     * \brief Get the IDs of all lanelets whose bounding box intersects with the given area, in ascending order
+     * \param x_min Min. x value of the area
+     * \param x_max Max. x value of the area
+     * \param y_min Min. y value of the area
+     * \param y_max Max. y value of the area
+     */
+    std::vector<int> get_lanelet_ids_in_area(double x_min, double x_max, double y_min, double y_max);
+    /**
+     * \brief Get the ID of the lanelet closest to the given point (distance 0 if the point lies within the lanelet), if any lanelet exists
+     * \param x x value of the point
+     * \param y y value of the point
+     */
+    std::optional<int> get_nearest_lanelet_id(double x, double y);
+    /**
+     * \brief Get the IDs of all static obstacles whose bounding box (at their initial position) intersects with the given area, in ascending order
+     * \param x_min Min. x value of the area
+     * \param x_max Max. x value of the area
+     * \param y_min Min. y value of the area
+     * \param y_max Max. y value of the area
+     */
+    std::vector<int> get_static_obstacle_ids_in_area(double x_min, double x_max, double y_min, double y_max);
+
     ///////////////////////////////////////////////////////////////////////////////////////////
     ///////////////////                 DDS Functions               ///////////////////////////
     ///////////////////////////////////////////////////////////////////////////////////////////
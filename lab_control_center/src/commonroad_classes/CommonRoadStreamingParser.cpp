@@ -0,0 +1,182 @@
+#include "commonroad_classes/CommonRoadStreamingParser.hpp"
+
+#include <algorithm>
+#include <cctype>
+
+#include <libxml/parser.h>
+#include <libxml/SAX2.h>
+
+/**
+ * \file CommonRoadStreamingParser.cpp
+ * \ingroup lcc_commonroad
+ */
+
+CommonRoadStreamingParser::CommonRoadStreamingParser(
+    std::function<void(const xmlpp::Node*)> _root_callback,
+    std::function<bool(const xmlpp::Node*)> _element_callback
+)
+    :
+    xmlpp::SaxParser(false),
+    root_callback(_root_callback),
+    element_callback(_element_callback)
+{
+}
+
+void CommonRoadStreamingParser::parse(const std::string& filepath)
+{
+    try
+    {
+        parse_file(filepath);
+    }
+    catch(...)
+    {
+        //Stopping the parser after an error in a callback might lead to a parse error as well, the original error is more relevant
+        if (!callback_error)
+        {
+            throw;
+        }
+    }
+
+    if (callback_error)
+    {
+        std::rethrow_exception(callback_error);
+    }
+}
+
+void CommonRoadStreamingParser::parse_string(const std::string& contents)
+{
+    try
+    {
+        parse_memory(contents);
+    }
+    catch(...)
+    {
+        if (!callback_error)
+        {
+            throw;
+        }
+    }
+
+    if (callback_error)
+    {
+        std::rethrow_exception(callback_error);
+    }
+}
+
+xmlpp::Document& CommonRoadStreamingParser::get_document()
+{
+    return document;
+}
+
+void CommonRoadStreamingParser::flush_text()
+{
+    if (current_element && std::any_of(pending_text.begin(), pending_text.end(), [] (unsigned char c) { return !std::isspace(c); }))
+    {
+        set_line(current_element->add_child_text(pending_text));
+    }
+    pending_text.clear();
+}
+
+void CommonRoadStreamingParser::set_line(xmlpp::Node* node)
+{
+    //Line numbers are stored as unsigned short by libxml2 (larger values are not stored for elements)
+    const int line = std::min(xmlSAX2GetLineNumber(context_), 65535);
+    node->cobj()->line = static_cast<unsigned short>(std::max(line, 0));
+}
+
+void CommonRoadStreamingParser::stop_with_error()
+{
+    callback_error = std::current_exception();
+    xmlStopParser(context_);
+}
+
+void CommonRoadStreamingParser::on_start_element(const Glib::ustring& name, const AttributeList& attributes)
+{
+    if (callback_error) return;
+
+    try
+    {
+        flush_text();
+        ++depth;
+
+        xmlpp::Element* element = nullptr;
+        if (depth == 0)
+        {
+            element = document.create_root_node(name);
+        }
+        else if (depth == 1)
+        {
+            element = document.get_root_node()->add_child(name);
+        }
+        else
+        {
+            element = current_element->add_child(name);
+        }
+        set_line(element);
+
+        for (const auto& attribute : attributes)
+        {
+            element->set_attribute(attribute.name, attribute.value);
+        }
+
+        if (depth == 0)
+        {
+            //Elements of the first layer are added to the root node, it is not the current element
+            root_callback(element);
+        }
+        else
+        {
+            current_element = element;
+        }
+    }
+    catch(...)
+    {
+        stop_with_error();
+    }
+}
+
+void CommonRoadStreamingParser::on_end_element(const Glib::ustring& /*name*/)
+{
+    if (callback_error) return;
+
+    try
+    {
+        flush_text();
+
+        if (depth == 1)
+        {
+            xmlpp::Element* element = current_element;
+            current_element = nullptr;
+
+            //Translate the complete element, then free its subtree unless it is kept
+            if (!element_callback(element))
+            {
+                document.get_root_node()->remove_child(element);
+            }
+        }
+        else if (depth > 1)
+        {
+            current_element = current_element->get_parent();
+        }
+
+        --depth;
+    }
+    catch(...)
+    {
+        stop_with_error();
+    }
+}
+
+void CommonRoadStreamingParser::on_characters(const Glib::ustring& characters)
+{
+    //Text of the root node (between the first layer elements) is not relevant for the translation
+    if (current_element && !callback_error)
+    {
+        pending_text.append(characters.raw());
+    }
+}
+
+void CommonRoadStreamingParser::on_cdata_block(const Glib::ustring& text)
+{
+    on_characters(text);
+}
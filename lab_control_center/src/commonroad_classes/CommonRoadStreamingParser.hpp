@@ -0,0 +1,110 @@
+#pragma once
+
+#include <libxml++-2.6/libxml++/libxml++.h>
+
+#include <exception>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * \class CommonRoadStreamingParser
+ * \brief SAX parser for commonroad XML files. Instead of building the DOM of the whole file (xmlpp::DomParser), only the
+ * subtree of one element of the first layer (lanelet, obstacle, planning problem, ...) is built at a time. It is passed to
+ * the translation (the XML constructors of the commonroad classes) as soon as its end tag was parsed and is removed
+ * afterwards, unless it is supposed to be kept. Whitespace-only text is skipped, like with the option "remove blank nodes"
+ * of the DOM parser. Comments are skipped as well.
+ * Errors thrown during the translation are rethrown by parse with their original type.
+ * \ingroup lcc_commonroad
+ */
+class CommonRoadStreamingParser : public xmlpp::SaxParser
+{
+    //! Contains the root node (with its attributes) and the elements of the first layer that were kept
+    xmlpp::Document document;
+    //! Element that is currently built, nullptr outside of the first layer elements
+    xmlpp::Element* current_element = nullptr;
+    //! Depth of the current element, 0 for the root node
+    int depth = -1;
+    //! Text of the current element received so far (on_characters may be called multiple times for one text)
+    std::string pending_text;
+
+    //! Called with the root node after its start tag was parsed
+    std::function<void(const xmlpp::Node*)> root_callback;
+    //! Called with each complete element of the first layer, returns true if the element should be kept in the document
+    std::function<bool(const xmlpp::Node*)> element_callback;
+
+    //! Error thrown by a callback, the parser is stopped then
+    std::exception_ptr callback_error;
+
+    /**
+     * \brief Adds pending_text to the current element, if it contains more than whitespace
+     */
+    void flush_text();
+
+    /**
+     * \brief Sets the line of the node to the current line of the parser, for error messages of the translation
+     * \param node The node that was just created
+     */
+    void set_line(xmlpp::Node* node);
+
+    /**
+     * \brief Stops the parser after an error was thrown in a callback, the error is rethrown by parse
+     */
+    void stop_with_error();
+
+protected:
+    /**
+     * \brief SAX callback, creates the element
+     * \param name Name of the element
+     * \param attributes Attributes of the element
+     */
+    void on_start_element(const Glib::ustring& name, const AttributeList& attributes) override;
+
+    /**
+     * \brief SAX callback, passes complete elements of the first layer to element_callback
+     * \param name Name of the element
+     */
+    void on_end_element(const Glib::ustring& name) override;
+
+    /**
+     * \brief SAX callback, collects the text of the current element
+     * \param characters (Part of) the text
+     */
+    void on_characters(const Glib::ustring& characters) override;
+
+    /**
+     * \brief SAX callback, collects CDATA like text
+     * \param text (Part of) the text
+     */
+    void on_cdata_block(const Glib::ustring& text) override;
+
+public:
+    /**
+     * \brief Constructor
+     * \param _root_callback Called with the root node (the commonRoad node, only with its attributes) after its start tag was parsed
+     * \param _element_callback Called with each complete element of the first layer, in document order. Returns true if the
+     * element should be kept in get_document, else it is deleted after the call.
+     */
+    CommonRoadStreamingParser(
+        std::function<void(const xmlpp::Node*)> _root_callback,
+        std::function<bool(const xmlpp::Node*)> _element_callback
+    );
+
+    /**
+     * \brief Parse and translate the file. Throws xmlpp exceptions for invalid XML and rethrows errors of the callbacks.
+     * \param filepath Path to the XML file
+     */
+    void parse(const std::string& filepath);
+
+    /**
+     * \brief Parse and translate XML from memory, see parse
+     * \param contents The XML document
+     */
+    void parse_string(const std::string& contents);
+
+    /**
+     * \brief Document with the root node and the first layer elements that were kept by element_callback
+     */
+    xmlpp::Document& get_document();
+};
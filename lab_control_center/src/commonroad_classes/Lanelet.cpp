@@ -53,28 +53,7 @@ Lanelet::Lanelet(
         traffic_light_refs = translate_refs(node, "trafficLightRef");
 
         //Add positional values for each traffic sign / light ref
-        auto lanelet_id = xml_translation::get_attribute_int(node, "id", true).value();
-        //First: Add positions stored for the lanelet itself
-        for (const auto ref : traffic_sign_refs)
-        {
-            traffic_sign_positions[ref] = {lanelet_id, false};
-        }
-        for (const auto ref : traffic_light_refs)
-        {
-            traffic_light_positions[ref] = {lanelet_id, false};
-        }
-        //Then: Add or update positions defined for the stop_line
-        if (stop_line.has_value())
-        {
-            for (const auto ref : stop_line->traffic_sign_refs)
-            {
-                traffic_sign_positions[ref] = {lanelet_id, true};
-            }
-            for (const auto ref : stop_line->traffic_light_ref)
-            {
-                traffic_light_positions[ref] = {lanelet_id, true};
-            }
-        }
+        register_sign_and_light_positions(traffic_sign_positions, traffic_light_positions);
     }
     catch(const SpecificationError& e)
     {
@@ -122,6 +101,137 @@ Lanelet::Lanelet(
     // std::cout << "Lanelet end --------------------------" << std::endl << std::endl;
 }
 
+Lanelet::Lanelet(
+    BinaryReader& reader,
+    std::map<int, std::pair<int, bool>>& traffic_sign_positions, 
+    std::map<int, std::pair<int, bool>>& traffic_light_positions,
+    std::shared_ptr<CommonroadDrawConfiguration> _draw_configuration
+)
+    :
+    draw_configuration(_draw_configuration)
+{
+    //Same order as in write_binary
+    lanelet_id = reader.read<int>();
+    commonroad_line = reader.read<int>();
+
+    left_bound = read_bound(reader);
+    right_bound = read_bound(reader);
+
+    predecessors = reader.read_vector<int>();
+    successors = reader.read_vector<int>();
+    adjacent_left = reader.read_optional<Adjacent>();
+    adjacent_right = reader.read_optional<Adjacent>();
+
+    speed_limit = reader.read_optional<double>();
+
+    if (reader.read<uint8_t>())
+    {
+        StopLine line;
+        const uint64_t point_count = reader.read<uint64_t>();
+        for (uint64_t i = 0; i < point_count; ++i)
+        {
+            line.points.push_back(Point(reader));
+        }
+        line.line_marking = reader.read<LineMarking>();
+        line.traffic_sign_refs = reader.read_vector<int>();
+        line.traffic_light_ref = reader.read_vector<int>();
+        stop_line = line;
+    }
+
+    lanelet_type = reader.read_vector<LaneletType>();
+    user_one_way = reader.read_vector<VehicleType>();
+    user_bidirectional = reader.read_vector<VehicleType>();
+    traffic_sign_refs = reader.read_vector<int>();
+    traffic_light_refs = reader.read_vector<int>();
+
+    register_sign_and_light_positions(traffic_sign_positions, traffic_light_positions);
+}
+
+void Lanelet::write_binary(BinaryWriter& writer) const
+{
+    writer.write(lanelet_id);
+    writer.write(commonroad_line);
+
+    write_bound(writer, left_bound);
+    write_bound(writer, right_bound);
+
+    writer.write_vector(predecessors);
+    writer.write_vector(successors);
+    writer.write_optional(adjacent_left);
+    writer.write_optional(adjacent_right);
+
+    writer.write_optional(speed_limit);
+
+    writer.write<uint8_t>(stop_line.has_value());
+    if (stop_line.has_value())
+    {
+        writer.write<uint64_t>(stop_line->points.size());
+        for (const auto& point : stop_line->points)
+        {
+            point.write_binary(writer);
+        }
+        writer.write(stop_line->line_marking);
+        writer.write_vector(stop_line->traffic_sign_refs);
+        writer.write_vector(stop_line->traffic_light_ref);
+    }
+
+    writer.write_vector(lanelet_type);
+    writer.write_vector(user_one_way);
+    writer.write_vector(user_bidirectional);
+    writer.write_vector(traffic_sign_refs);
+    writer.write_vector(traffic_light_refs);
+}
+
+void Lanelet::write_bound(BinaryWriter& writer, const Bound& bound)
+{
+    writer.write<uint64_t>(bound.points.size());
+    for (const auto& point : bound.points)
+    {
+        point.write_binary(writer);
+    }
+    writer.write_optional(bound.line_marking);
+}
+
+Bound Lanelet::read_bound(BinaryReader& reader)
+{
+    Bound bound;
+    const uint64_t point_count = reader.read<uint64_t>();
+    for (uint64_t i = 0; i < point_count; ++i)
+    {
+        bound.points.push_back(Point(reader));
+    }
+    bound.line_marking = reader.read_optional<LineMarking>();
+    return bound;
+}
+
+void Lanelet::register_sign_and_light_positions(
+    std::map<int, std::pair<int, bool>>& traffic_sign_positions, 
+    std::map<int, std::pair<int, bool>>& traffic_light_positions
+)
+{
+    //First: Add positions stored for the lanelet itself
+    for (const auto ref : traffic_sign_refs)
+    {
+        traffic_sign_positions[ref] = {lanelet_id, false};
+    }
+    for (const auto ref : traffic_light_refs)
+    {
+        traffic_light_positions[ref] = {lanelet_id, false};
+    }
+    //Then: Add or update positions defined for the stop_line
+    if (stop_line.has_value())
+    {
+        for (const auto ref : stop_line->traffic_sign_refs)
+        {
+            traffic_sign_positions[ref] = {lanelet_id, true};
+        }
+        for (const auto ref : stop_line->traffic_light_ref)
+        {
+            traffic_light_positions[ref] = {lanelet_id, true};
+        }
+    }
+}
+
 Bound Lanelet::translate_bound(const xmlpp::Node* node, std::string name)
 {
     const auto bound_node = xml_translation::get_child_if_exists(node, name, true); //True because this is a required part of both specs (2018 and 2020)
@@ -870,6 +980,11 @@ void Lanelet::draw_ref(const DrawingContext& ctx, double scale, double global_or
     ctx->restore();
 }
 
+int Lanelet::get_id() const
+{
+    return lanelet_id;
+}
+
 std::pair<double, double> Lanelet::get_center()
 {
     //The calculation of the center follows a simple assumption: Center = Mean of middle segment (middle value of all points might not be within the lanelet boundaries)
@@ -995,6 +1110,45 @@ std::vector<Point> Lanelet::get_shape()
     return shape;
 }
 
+double Lanelet::get_distance(double x, double y)
+{
+    auto shape = get_shape();
+    if (shape.size() == 0)
+    {
+        return std::numeric_limits<double>::infinity();
+    }
+
+    //Even-odd rule for the inside test, minimum distance to all polygon edges otherwise
+    bool inside = false;
+    double min_squared_distance = std::numeric_limits<double>::infinity();
+    for (size_t i = 0, j = shape.size() - 1; i < shape.size(); j = i++)
+    {
+        const double x_i = shape.at(i).get_x();
+        const double y_i = shape.at(i).get_y();
+        const double x_j = shape.at(j).get_x();
+        const double y_j = shape.at(j).get_y();
+
+        if ((y_i > y) != (y_j > y) && x < (x_j - x_i) * (y - y_i) / (y_j - y_i) + x_i)
+        {
+            inside = !inside;
+        }
+
+        const double edge_x = x_j - x_i;
+        const double edge_y = y_j - y_i;
+        const double edge_squared_length = edge_x * edge_x + edge_y * edge_y;
+        double t = 0.0;
+        if (edge_squared_length > 0.0)
+        {
+            t = std::min(1.0, std::max(0.0, ((x - x_i) * edge_x + (y - y_i) * edge_y) / edge_squared_length));
+        }
+        const double dx = x_i + t * edge_x - x;
+        const double dy = y_i + t * edge_y - y;
+        min_squared_distance = std::min(min_squared_distance, dx * dx + dy * dy);
+    }
+
+    return inside ? 0.0 : std::sqrt(min_squared_distance);
+}
+
 std::string Lanelet::get_speed_limit()
 {
     std::stringstream speed_limit_stream;
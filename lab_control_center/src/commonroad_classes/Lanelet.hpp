@@ -9,6 +9,7 @@
 
 #include "commonroad_classes/geometry/Point.hpp"
 
+#include "commonroad_classes/BinaryTranslation.hpp"
 #include "commonroad_classes/InterfaceDraw.hpp"
 #include "commonroad_classes/InterfaceGeometry.hpp"
 #include "commonroad_classes/InterfaceTransform.hpp"
@@ -199,6 +200,29 @@ private:
      */
     LineMarking translate_line_marking(const xmlpp::Node* line_node);
 
+    /**
+     * \brief Store the lanelet positions of all traffic signs / lights referenced by the lanelet or its stop line
+     * \param traffic_sign_positions Maps traffic sign ID to lanelet ID and if the position comes from a stop line
+     * \param traffic_light_positions Maps traffic light ID to lanelet ID and if the position comes from a stop line
+     */
+    void register_sign_and_light_positions(
+        std::map<int, std::pair<int, bool>>& traffic_sign_positions, 
+        std::map<int, std::pair<int, bool>>& traffic_light_positions
+    );
+
+    /**
+     * \brief Store a bound for the binary scenario cache
+     * \param writer Writer to append the bound to
+     * \param bound The bound
+     */
+    static void write_bound(BinaryWriter& writer, const Bound& bound);
+
+    /**
+     * \brief Restore a bound stored with write_bound
+     * \param reader Reader positioned at the stored bound
+     */
+    static Bound read_bound(BinaryReader& reader);
+
     //Helper functions
     /**
      * \brief Set drawing style of a drawn boundary
@@ -234,6 +258,28 @@ public:
         std::shared_ptr<CommonroadDrawConfiguration> _draw_configuration
     );
 
+    /**
+     * \brief Restores a lanelet stored with write_binary (binary scenario cache), without any XML translation
+     * Throws std::runtime_error if the stored data is incomplete
+     * \param reader Reader positioned at the stored lanelet
+     * \param traffic_sign_positions As in the XML constructor
+     * \param traffic_light_positions As in the XML constructor
+     * \param _draw_configuration As in the XML constructor
+     */
+    Lanelet(
+        BinaryReader& reader, 
+        std::map<int, std::pair<int, bool>>& traffic_sign_positions, 
+        std::map<int, std::pair<int, bool>>& traffic_light_positions,
+        std::shared_ptr<CommonroadDrawConfiguration> _draw_configuration
+    );
+
+    /**
+     * \brief Store the translated lanelet for the binary scenario cache, can be restored with the BinaryReader constructor
+     * Must be called before any transformation of the lanelet
+     * \param writer Writer to append the lanelet to
+     */
+    void write_binary(BinaryWriter& writer) const;
+
     /**
      * \brief Iterate through the bounds, which should form pairs for each point (left and right)
      * Calculate distances
@@ -286,6 +332,11 @@ public:
 
     //Getter (no setter, bc we do not want to manipulate data except for transformation)
 
+    /**
+     * \brief Get the ID of the lanelet
+     */
+    int get_id() const;
+
     /**
      * \brief Get center (positional value) of the shape, if one exists
      * \return Center of the shape
@@ -322,6 +373,14 @@ public:
      */
     std::vector<Point> get_shape();
 
+    /**
+     * \brief Get the distance of a point to the lanelet shape (see get_shape)
+     * \param x x value of the point
+     * \param y y value of the point
+     * \return 0 if the point lies within the lanelet, else the distance to the closest boundary (or to the start / end of the lanelet)
+     */
+    double get_distance(double x, double y);
+
     //For table entries
     /**
      * \brief Get the lanelet speed limit or an empty string
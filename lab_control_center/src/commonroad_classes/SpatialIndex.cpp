@@ -0,0 +1,298 @@
+#include "commonroad_classes/SpatialIndex.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+/**
+ * \file SpatialIndex.cpp
+ * \ingroup lcc_commonroad
+ */
+
+bool SpatialIndex::Box::intersects(const Box& other) const
+{
+    return x_min <= other.x_max && other.x_min <= x_max && y_min <= other.y_max && other.y_min <= y_max;
+}
+
+double SpatialIndex::Box::distance_to(double x, double y) const
+{
+    const double dx = std::max({x_min - x, 0.0, x - x_max});
+    const double dy = std::max({y_min - y, 0.0, y - y_max});
+    return std::sqrt(dx * dx + dy * dy);
+}
+
+SpatialIndex::Box SpatialIndex::Box::merged(const Box& other) const
+{
+    Box box;
+    box.x_min = std::min(x_min, other.x_min);
+    box.x_max = std::max(x_max, other.x_max);
+    box.y_min = std::min(y_min, other.y_min);
+    box.y_max = std::max(y_max, other.y_max);
+    return box;
+}
+
+size_t SpatialIndex::get_column(double x) const
+{
+    //Also catches NaN
+    if (!(x > bounds.x_min))
+    {
+        return 0;
+    }
+    const double column = (x - bounds.x_min) / cell_size;
+    return (column >= static_cast<double>(columns - 1)) ? columns - 1 : static_cast<size_t>(column);
+}
+
+size_t SpatialIndex::get_row(double y) const
+{
+    if (!(y > bounds.y_min))
+    {
+        return 0;
+    }
+    const double row = (y - bounds.y_min) / cell_size;
+    return (row >= static_cast<double>(rows - 1)) ? rows - 1 : static_cast<size_t>(row);
+}
+
+void SpatialIndex::build(std::vector<std::pair<int, Box>> _entries)
+{
+    clear();
+    entries = std::move(_entries);
+    if (entries.empty())
+    {
+        return;
+    }
+
+    std::sort(entries.begin(), entries.end(), [] (const std::pair<int, Box>& a, const std::pair<int, Box>& b) {
+        return a.first < b.first;
+    });
+
+    //Cell size: At least the mean box size (so that boxes span few cells) and large enough that there are about as many cells as entries
+    bounds = entries.front().second;
+    double mean_extent = 0.0;
+    for (const auto& entry : entries)
+    {
+        bounds = bounds.merged(entry.second);
+        mean_extent += std::max(entry.second.x_max - entry.second.x_min, entry.second.y_max - entry.second.y_min);
+    }
+    mean_extent /= static_cast<double>(entries.size());
+
+    const double width = bounds.x_max - bounds.x_min;
+    const double height = bounds.y_max - bounds.y_min;
+    cell_size = std::max(std::sqrt(width * height / static_cast<double>(entries.size())), mean_extent);
+    if (!(cell_size > 0.0) || !std::isfinite(cell_size))
+    {
+        cell_size = std::max(std::max(width, height), 1.0);
+    }
+
+    //Very elongated scenarios would otherwise lead to many empty cells
+    const size_t max_cells = 4 * entries.size() + 16;
+    while (true)
+    {
+        columns = static_cast<size_t>(width / cell_size) + 1;
+        rows = static_cast<size_t>(height / cell_size) + 1;
+        if (columns * rows <= max_cells) break;
+        cell_size *= 2.0;
+    }
+
+    //Count the entries of each cell, then fill them in (compressed row storage)
+    cell_start.assign(columns * rows + 1, 0);
+    for (const auto& entry : entries)
+    {
+        for (size_t row = get_row(entry.second.y_min); row <= get_row(entry.second.y_max); ++row)
+        {
+            for (size_t column = get_column(entry.second.x_min); column <= get_column(entry.second.x_max); ++column)
+            {
+                ++cell_start.at(row * columns + column + 1);
+            }
+        }
+    }
+    for (size_t cell = 1; cell < cell_start.size(); ++cell)
+    {
+        cell_start.at(cell) += cell_start.at(cell - 1);
+    }
+
+    cell_entries.resize(cell_start.back());
+    std::vector<uint32_t> cell_fill(cell_start.begin(), cell_start.end() - 1);
+    for (uint32_t index = 0; index < entries.size(); ++index)
+    {
+        const Box& box = entries.at(index).second;
+        for (size_t row = get_row(box.y_min); row <= get_row(box.y_max); ++row)
+        {
+            for (size_t column = get_column(box.x_min); column <= get_column(box.x_max); ++column)
+            {
+                cell_entries.at(cell_fill.at(row * columns + column)++) = index;
+            }
+        }
+    }
+}
+
+void SpatialIndex::clear()
+{
+    entries.clear();
+    bounds = Box();
+    cell_size = 1.0;
+    columns = 0;
+    rows = 0;
+    cell_start.clear();
+    cell_entries.clear();
+}
+
+size_t SpatialIndex::size() const
+{
+    return entries.size();
+}
+
+std::vector<int> SpatialIndex::query(const Box& area) const
+{
+    std::vector<int> ids;
+    if (entries.empty() || !area.intersects(bounds))
+    {
+        return ids;
+    }
+
+    const size_t column_min = get_column(area.x_min);
+    const size_t column_max = get_column(area.x_max);
+    const size_t row_min = get_row(area.y_min);
+    const size_t row_max = get_row(area.y_max);
+
+    std::vector<uint32_t> found;
+    for (size_t row = row_min; row <= row_max; ++row)
+    {
+        for (size_t column = column_min; column <= column_max; ++column)
+        {
+            const size_t cell = row * columns + column;
+            for (uint32_t i = cell_start.at(cell); i < cell_start.at(cell + 1); ++i)
+            {
+                const uint32_t index = cell_entries.at(i);
+                const Box& box = entries.at(index).second;
+                if (!box.intersects(area))
+                {
+                    continue;
+                }
+
+                //Boxes spanning multiple cells are only reported in their first cell within the queried area
+                if (std::max(get_column(box.x_min), column_min) == column && std::max(get_row(box.y_min), row_min) == row)
+                {
+                    found.push_back(index);
+                }
+            }
+        }
+    }
+
+    //Entries are sorted by ID
+    std::sort(found.begin(), found.end());
+    ids.reserve(found.size());
+    for (uint32_t index : found)
+    {
+        ids.push_back(entries.at(index).first);
+    }
+    return ids;
+}
+
+std::optional<int> SpatialIndex::nearest(double x, double y, std::function<double(int)> get_distance) const
+{
+    if (entries.empty())
+    {
+        return std::nullopt;
+    }
+
+    const long center_column = static_cast<long>(get_column(x));
+    const long center_row = static_cast<long>(get_row(y));
+    const long max_ring = static_cast<long>(std::max(columns, rows));
+
+    std::optional<int> best_id;
+    double best_distance = std::numeric_limits<double>::infinity();
+
+    auto visit_cell = [&] (long column, long row) {
+        if (column < 0 || row < 0 || column >= static_cast<long>(columns) || row >= static_cast<long>(rows))
+        {
+            return;
+        }
+
+        const size_t cell = static_cast<size_t>(row) * columns + static_cast<size_t>(column);
+        for (uint32_t i = cell_start.at(cell); i < cell_start.at(cell + 1); ++i)
+        {
+            const auto& entry = entries.at(cell_entries.at(i));
+            if (entry.second.distance_to(x, y) > best_distance)
+            {
+                continue;
+            }
+
+            const double distance = get_distance(entry.first);
+            if (!best_id.has_value() || distance < best_distance || (distance == best_distance && entry.first < best_id.value()))
+            {
+                best_id = entry.first;
+                best_distance = distance;
+            }
+        }
+    };
+
+    for (long ring = 0; ring <= max_ring; ++ring)
+    {
+        //Cells of this ring are at least (ring - 1) cells away from the point (also if the point lies outside of the grid)
+        if (best_id.has_value() && static_cast<double>(ring - 1) * cell_size > best_distance)
+        {
+            break;
+        }
+
+        for (long column = center_column - ring; column <= center_column + ring; ++column)
+        {
+            visit_cell(column, center_row - ring);
+            if (ring > 0) visit_cell(column, center_row + ring);
+        }
+        for (long row = center_row - ring + 1; row <= center_row + ring - 1; ++row)
+        {
+            visit_cell(center_column - ring, row);
+            visit_cell(center_column + ring, row);
+        }
+    }
+
+    return best_id;
+}
+
+std::optional<SpatialIndex::Box> SpatialIndex::get_bounding_box(const CommonroadDDSShape& shape, double x, double y, double yaw)
+{
+    const double cos_yaw = std::cos(yaw);
+    const double sin_yaw = std::sin(yaw);
+
+    std::optional<Box> box;
+    auto add_point = [&] (double point_x, double point_y, double radius) {
+        Box point_box;
+        point_box.x_min = x + cos_yaw * point_x - sin_yaw * point_y - radius;
+        point_box.x_max = point_box.x_min + 2.0 * radius;
+        point_box.y_min = y + sin_yaw * point_x + cos_yaw * point_y - radius;
+        point_box.y_max = point_box.y_min + 2.0 * radius;
+        box = box.has_value() ? box->merged(point_box) : point_box;
+    };
+
+    for (const auto& circle : shape.circles())
+    {
+        add_point(circle.center().x(), circle.center().y(), circle.radius());
+    }
+
+    for (const auto& polygon : shape.polygons())
+    {
+        for (const auto& point : polygon.points())
+        {
+            add_point(point.x(), point.y(), 0.0);
+        }
+    }
+
+    for (const auto& rectangle : shape.rectangles())
+    {
+        const double cos_orientation = std::cos(rectangle.orientation());
+        const double sin_orientation = std::sin(rectangle.orientation());
+        for (double corner_x : {-0.5 * rectangle.length(), 0.5 * rectangle.length()})
+        {
+            for (double corner_y : {-0.5 * rectangle.width(), 0.5 * rectangle.width()})
+            {
+                add_point(
+                    rectangle.center().x() + cos_orientation * corner_x - sin_orientation * corner_y,
+                    rectangle.center().y() + sin_orientation * corner_x + cos_orientation * corner_y,
+                    0.0
+                );
+            }
+        }
+    }
+
+    return box;
+}
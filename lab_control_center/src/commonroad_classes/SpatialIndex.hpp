@@ -0,0 +1,128 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "CommonroadDDSShape.hpp"
+
+/**
+ * \class SpatialIndex
+ * \brief Uniform grid over the axis-aligned bounding boxes of scenario elements (lanelets, static obstacles), identified by their
+ * commonroad ID. Built once after the scenario was loaded or transformed, so that area queries (e.g. culling of elements outside
+ * of the visible part of the map view) and nearest-element queries do not need to look at every element of the scenario.
+ * The cell size is chosen w.r.t. the number and size of the boxes, so that each cell only contains few elements.
+ * Queries are const and can be performed concurrently.
+ * \ingroup lcc_commonroad
+ */
+class SpatialIndex
+{
+public:
+    /**
+     * \struct Box
+     * \brief Axis-aligned bounding box
+     */
+    struct Box
+    {
+        //! Minimum x value
+        double x_min = 0.0;
+        //! Maximum x value
+        double x_max = 0.0;
+        //! Minimum y value
+        double y_min = 0.0;
+        //! Maximum y value
+        double y_max = 0.0;
+
+        /**
+         * \brief True if the boxes overlap (touching counts as overlap)
+         * \param other The other box
+         */
+        bool intersects(const Box& other) const;
+
+        /**
+         * \brief Euclidean distance of a point to the box, 0 if the point lies within the box
+         * \param x x value of the point
+         * \param y y value of the point
+         */
+        double distance_to(double x, double y) const;
+
+        /**
+         * \brief Box that also contains the other box
+         * \param other The other box
+         */
+        Box merged(const Box& other) const;
+    };
+
+private:
+    //! Indexed boxes, sorted by ID
+    std::vector<std::pair<int, Box>> entries;
+    //! Bounding box of all entries, the grid starts at (x_min, y_min)
+    Box bounds;
+    //! Width and height of each cell
+    double cell_size = 1.0;
+    //! Number of cells in x direction
+    size_t columns = 0;
+    //! Number of cells in y direction
+    size_t rows = 0;
+    //! Start of the entries of each cell (row-major) in cell_entries, with an additional value for the end of the last cell
+    std::vector<uint32_t> cell_start;
+    //! Positions in entries, grouped by cell
+    std::vector<uint32_t> cell_entries;
+
+    /**
+     * \brief Cell column of an x value, clamped to the grid
+     * \param x The x value
+     */
+    size_t get_column(double x) const;
+
+    /**
+     * \brief Cell row of a y value, clamped to the grid
+     * \param y The y value
+     */
+    size_t get_row(double y) const;
+
+public:
+    /**
+     * \brief (Re-)builds the index
+     * \param _entries IDs and bounding boxes of the elements, IDs should be unique
+     */
+    void build(std::vector<std::pair<int, Box>> _entries);
+
+    /**
+     * \brief Removes all entries
+     */
+    void clear();
+
+    /**
+     * \brief Number of indexed elements
+     */
+    size_t size() const;
+
+    /**
+     * \brief IDs of all elements whose bounding box intersects with the area, in ascending order
+     * \param area The area, e.g. the visible part of the map
+     */
+    std::vector<int> query(const Box& area) const;
+
+    /**
+     * \brief ID of the element closest to a point, std::nullopt if the index is empty. Cells are searched in rings around the point
+     * until no closer element can exist. For equal distances, the smaller ID is returned.
+     * \param x x value of the point
+     * \param y y value of the point
+     * \param get_distance Returns the exact distance of the element with the given ID to the point, which must not be smaller than
+     * the distance of the point to its bounding box (e.g. 0 within a lanelet, else the distance to its boundary)
+     */
+    std::optional<int> nearest(double x, double y, std::function<double(int)> get_distance) const;
+
+    /**
+     * \brief Bounding box of a shape that is drawn at the given pose (translated by (x, y), then rotated by yaw, like in the map view).
+     * std::nullopt if the shape is empty.
+     * \param shape The shape
+     * \param x Translation in x direction
+     * \param y Translation in y direction
+     * \param yaw Rotation
+     */
+    static std::optional<Box> get_bounding_box(const CommonroadDDSShape& shape, double x = 0.0, double y = 0.0, double yaw = 0.0);
+};
@@ -53,6 +53,20 @@ Point::Point(double _x, double _y, double _z)
     z = std::optional<double>(_z);
 }
 
+Point::Point(BinaryReader& reader)
+{
+    x = reader.read<double>();
+    y = reader.read<double>();
+    z = reader.read_optional<double>();
+}
+
+void Point::write_binary(BinaryWriter& writer) const
+{
+    writer.write(x);
+    writer.write(y);
+    writer.write_optional(z);
+}
+
 void Point::transform_coordinate_system(double scale, double angle, double translate_x, double translate_y)
 {
     //Translate, rotate, scale as specified for commonroad, in this order
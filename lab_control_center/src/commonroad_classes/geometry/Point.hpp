@@ -2,6 +2,7 @@
 
 #include <libxml++-2.6/libxml++/libxml++.h>
 
+#include "commonroad_classes/BinaryTranslation.hpp"
 #include "commonroad_classes/InterfaceDraw.hpp"
 #include "commonroad_classes/InterfaceTransform.hpp"
 #include "commonroad_classes/XMLTranslation.hpp"
@@ -41,6 +42,18 @@ public:
      */
     Point(double _x, double _y, double _z);
 
+    /**
+     * \brief Fourth constructor, restores a point stored with write_binary (binary scenario cache)
+     * \param reader Reader positioned at the stored point
+     */
+    Point(BinaryReader& reader);
+
+    /**
+     * \brief Store the point for the binary scenario cache, can be restored with the BinaryReader constructor
+     * \param writer Writer to append the point to
+     */
+    void write_binary(BinaryWriter& writer) const;
+
     /**
      * \brief This function is used to fit the imported XML scenario to a given min. lane width
      * The lane with min width gets assigned min. width by scaling the whole scenario up until it fits
@@ -0,0 +1,172 @@
+#include <algorithm>
+#include <chrono>
+#include <experimental/filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include "cpm/CommandLineReader.hpp"
+#include "commonroad_classes/CommonRoadScenario.hpp"
+
+/**
+ * \file CommonRoadLoadBenchmark.cpp
+ * \brief Load time of CommonRoadScenario::load_file for the commonroad XML files of the repository, a synthetic scenario
+ * with --lanelets=INT (default 10000) lanelets and optionally --scenario=PATH. For each file, compares parsing the
+ * file with the previous DOM parser (without translation), the streaming translation without cache, the first load
+ * with cache (translation + writing the cache file) and loading from the cache, averaged over --runs=INT (default 5).
+ * The translation from the cache is checked against the XML translation, returns 1 on a mismatch.
+ * WARNING: Deletes the cache directory ./commonroad_cache of the working directory.
+ * \ingroup lcc_commonroad
+ */
+
+/**
+ * \brief Writes a scenario with n_lanelets lanelets, in rows of 100 adjacent lanelets, each with 10 points per bound
+ * \ingroup lcc_commonroad
+ */
+static void write_synthetic_scenario(const std::string& filepath, int n_lanelets)
+{
+    const int row_length = 100;
+    std::ofstream file(filepath);
+    file << std::fixed << std::setprecision(9);
+    file << "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n"
+        << "<commonRoad affiliation=\"CPM Lab\" author=\"CommonRoadLoadBenchmark\" benchmarkID=\"SYNTHETIC-1\" "
+        << "commonRoadVersion=\"2018b\" date=\"2020-01-01\" source=\"synthetic\" timeStepSize=\"0.1\">\n";
+
+    auto write_bound = [&](const char* name, double x0, double y, const char* marking) {
+        file << "      <" << name << ">\n";
+        for (int k = 0; k < 10; ++k)
+        {
+            file << "         <point>\n"
+                << "            <x>" << x0 + 0.1 * k << "</x>\n"
+                << "            <y>" << y + 0.001 * k * k << "</y>\n"
+                << "         </point>\n";
+        }
+        file << "         <lineMarking>" << marking << "</lineMarking>\n";
+        file << "      </" << name << ">\n";
+    };
+
+    for (int id = 1; id <= n_lanelets; ++id)
+    {
+        const int row = (id - 1) / row_length;
+        const int column = (id - 1) % row_length;
+        const double x0 = 0.9 * row;
+        const double y = 0.2 * column;
+
+        file << "   <lanelet id=\"" << id << "\">\n";
+        write_bound("leftBound", x0, y + 0.2, "dashed");
+        write_bound("rightBound", x0, y, "solid");
+        if (id - row_length >= 1) file << "      <predecessor ref=\"" << id - row_length << "\"/>\n";
+        if (id + row_length <= n_lanelets) file << "      <successor ref=\"" << id + row_length << "\"/>\n";
+        if (column + 1 < row_length && id + 1 <= n_lanelets) file << "      <adjacentLeft drivingDir=\"same\" ref=\"" << id + 1 << "\"/>\n";
+        if (column > 0) file << "      <adjacentRight drivingDir=\"same\" ref=\"" << id - 1 << "\"/>\n";
+        file << "   </lanelet>\n";
+    }
+    file << "</commonRoad>\n";
+}
+
+/**
+ * \brief Everything of a translated scenario that is compared between the XML and the cached translation
+ * \ingroup lcc_commonroad
+ */
+static std::vector<double> scenario_signature(CommonRoadScenario& scenario)
+{
+    std::vector<double> signature;
+    signature.push_back(scenario.get_time_step_size());
+    signature.push_back(scenario.get_dynamic_obstacle_ids().size());
+    signature.push_back(scenario.get_static_obstacle_ids().size());
+    signature.push_back(scenario.get_environment_obstacle_ids().size());
+    signature.push_back(scenario.get_planning_problem_ids().size());
+    for (int id : scenario.get_lanelet_ids())
+    {
+        auto lanelet = scenario.get_lanelet(id);
+        signature.push_back(id);
+        signature.push_back(lanelet->get_min_width());
+        for (auto& point : lanelet->get_shape())
+        {
+            signature.push_back(point.get_x());
+            signature.push_back(point.get_y());
+        }
+        auto stopline_center = lanelet->get_stopline_center();
+        signature.push_back(stopline_center.has_value() ? stopline_center->first : -1.0);
+    }
+    return signature;
+}
+
+int main(int argc, char *argv[]) {
+    const int n_lanelets = cpm::cmd_parameter_int("lanelets", 10000, argc, argv);
+    const int runs = std::max(1, cpm::cmd_parameter_int("runs", 5, argc, argv));
+    const std::string extra_scenario = cpm::cmd_parameter_string("scenario", "", argc, argv);
+
+    const std::string synthetic_scenario = "./CommonRoadLoadBenchmark_synthetic.xml";
+    write_synthetic_scenario(synthetic_scenario, n_lanelets);
+
+    std::vector<std::string> files = {
+        "./ui/map_view/LabMapCommonRoad.xml",
+        "./commonroad_HomePoses.xml",
+        synthetic_scenario
+    };
+    if (extra_scenario != "") files.push_back(extra_scenario);
+
+    auto time_ms = [](std::function<void()> function) {
+        auto t0 = std::chrono::steady_clock::now();
+        function();
+        auto t1 = std::chrono::steady_clock::now();
+        return std::chrono::duration<double, std::milli>(t1 - t0).count();
+    };
+
+    bool failed = false;
+    CommonRoadScenario scenario;
+    std::cout << std::fixed << std::setprecision(1);
+    for (const auto& file : files)
+    {
+        if (!std::experimental::filesystem::exists(file))
+        {
+            std::cout << file << ": not found, skipped" << std::endl;
+            continue;
+        }
+        std::experimental::filesystem::remove_all("./commonroad_cache");
+
+        double dom_ms = 0;
+        double streaming_ms = 0;
+        for (int r = 0; r < runs; ++r)
+        {
+            dom_ms += time_ms([&]() {
+                xmlpp::DomParser parser;
+                parser.set_parser_options(256);
+                parser.parse_file(file);
+            });
+
+            scenario.set_binary_cache_enabled(false);
+            streaming_ms += time_ms([&]() { scenario.load_file(file, false); });
+        }
+        const std::vector<double> expected = scenario_signature(scenario);
+
+        scenario.set_binary_cache_enabled(true);
+        const double first_load_ms = time_ms([&]() { scenario.load_file(file, false); });
+
+        double cached_ms = 0;
+        bool equal = true;
+        for (int r = 0; r < runs; ++r)
+        {
+            cached_ms += time_ms([&]() { scenario.load_file(file, false); });
+            equal = equal && (scenario_signature(scenario) == expected);
+        }
+        failed = failed || !equal;
+
+        std::cout << file << " (" << scenario.get_lanelet_ids().size() << " lanelets, "
+            << std::experimental::filesystem::file_size(file) / 1e6 << " MB)" << (equal ? "" : " MISMATCH") << std::endl;
+        std::cout << "  DOM parse only (previous parser)  " << std::setw(9) << dom_ms / runs << " ms" << std::endl;
+        std::cout << "  Streaming translation, no cache   " << std::setw(9) << streaming_ms / runs << " ms" << std::endl;
+        std::cout << "  First load, writes cache          " << std::setw(9) << first_load_ms << " ms" << std::endl;
+        std::cout << "  Load from cache                   " << std::setw(9) << cached_ms / runs << " ms" << std::endl;
+    }
+
+    if (failed)
+    {
+        std::cerr << "CommonRoadLoadBenchmark: cached translation differs from the XML translation" << std::endl;
+        return 1;
+    }
+    return 0;
+}
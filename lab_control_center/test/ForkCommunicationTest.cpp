@@ -1,388 +1,226 @@
 #include <chrono>
-#include <cstring>
+#include <fstream>
+#include <iomanip>
 #include <iostream>
 #include <sstream>
 #include <string>
 #include <thread>
+#include <vector>
 
-//To spawn a process & get its PID
-#include <sys/msg.h>
 #include <sys/types.h>
 #include <sys/wait.h>
 #include <unistd.h>
-#include <stdio.h>
-#include <stdlib.h>
 
-enum PROCESS_STATE {
-    RUNNING, ERROR, DONE
-};
-
-int execute_command_get_pid(const char* cmd)
-{
-    int process_id = fork();
-    if (process_id == 0)
-    {
-        //Tell the child to set its group process ID to its process ID, or else things like kill(-pid) to kill a ping-while-loop won't work
-        setpgid(0, 0);
-        
-        //Actions to take within the new child process
-        //ACHTUNG: NUTZE chmod u+x für die Files, sonst: permission denied
-        execl("/bin/sh", "bash", "-c", cmd, NULL);
+#include "ProgramExecutor.hpp"
 
-        //Error if execlp returns
-        std::cerr << "Execl error in Deploy class: %s, for execution of '%s'" << std::strerror(errno) << cmd << std::endl;
+/**
+ * \file ForkCommunicationTest.cpp
+ * \brief Tests the ProgramExecutor: Commands with and without shell features, failing commands and the command timeout,
+ * both directly (execute_command_get_output) and through the child process and its message queues (get_command_output,
+ * execute_command), also with several commands in flight at once. Afterwards, the throughput of reading large command
+ * outputs with execute_command_get_output is compared with the previous byte-wise reading (fork + sh, one read() per byte).
+ * Returns 1 if a check failed.
+ * \ingroup lcc
+ */
 
-        exit(EXIT_FAILURE);
-    }
-    else if (process_id > 0)
+/**
+ * \brief Access to the private functions of ProgramExecutor that run a command, see the friend declaration there
+ * \ingroup lcc
+ */
+class ProgramExecutorTestAccess
+{
+public:
+    /**
+     * \brief See ProgramExecutor::execute_command_get_output
+     */
+    static std::string execute_command_get_output(ProgramExecutor& executor, const char* cmd, int timeout_ms)
     {
-        //We are in the parent process and got the child's PID
-        return process_id;
+        return executor.execute_command_get_output(cmd, timeout_ms);
     }
-    else 
+
+    /**
+     * \brief See ProgramExecutor::needs_shell
+     */
+    static bool needs_shell(const char* cmd)
     {
-        //We could not spawn a new process - usually, the program should not just break at this point, unless that behaviour is desired
-        //TODO: Change behaviour
-        std::cerr << "Error in Deploy class: Could not create child process for " << cmd << std::endl;
-        exit(EXIT_FAILURE);
+        return ProgramExecutor::needs_shell(cmd);
     }
-}
+};
 
-PROCESS_STATE get_child_process_state(int process_id)
+/**
+ * \brief Reading the output of a command like ProgramExecutor did before: fork + sh, one read() per byte
+ * \ingroup lcc
+ */
+static std::string read_output_bytewise(const char* cmd)
 {
-    int process_status;
-    pid_t result = waitpid(process_id, &process_status, WNOHANG);
-
-    if (result == 0)
-    {
-        return PROCESS_STATE::RUNNING;
-    }
-    else if (result == -1)
+    int command_pipe[2];
+    if (pipe(command_pipe))
     {
-        return PROCESS_STATE::ERROR;
+        return "ERROR";
     }
-    else
-    {
-        return PROCESS_STATE::DONE;
-    }
-    
-}
 
-void kill_process(int process_id)
-{
-    //Tell the process to terminate - this way, it can terminate gracefully
-    //We mostly use bash, were whole process groups might be created - to kill those, we need the negative id
-    if (process_id > 0)
+    int process_id = fork();
+    if (process_id == 0)
     {
-        process_id *= (-1);
+        setpgid(0, 0);
+        dup2(command_pipe[1], STDOUT_FILENO);
+        close(command_pipe[0]);
+        execl("/bin/sh", "bash", "-c", cmd, NULL);
+        exit(EXIT_FAILURE);
     }
-
-    kill(process_id, SIGTERM);
-
-    //Wait for the process to terminate
-    std::this_thread::sleep_for(std::chrono::seconds(3));
-
-    //Check if the process terminated as desired
-    PROCESS_STATE state = get_child_process_state(process_id);
-
-    //If the process has not yet terminated, force a termination and clean up
-    if (state != PROCESS_STATE::DONE)
+    else if (process_id < 0)
     {
-        kill(process_id, SIGKILL);
-        int status;
-        waitpid(process_id, &status, 0); //0 -> no flags here
+        return "ERROR";
     }
-}
 
-bool spawn_and_manage_process(const char* cmd, unsigned int timeout_seconds)
-{
-    std::cout << "Executing " << cmd << std::endl;
-
-    //Spawn and manage new process
-    int process_id = execute_command_get_pid(cmd);
-    auto start_time = std::chrono::high_resolution_clock::now();
-
-    auto time_passed_ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - start_time).count();
-    //Regularly check status during execution until timeout - exit early if everything worked as planned, else run until error / timeout and return error
-    while (time_passed_ms < static_cast<int64_t>(timeout_seconds) * 1000)
+    close(command_pipe[1]);
+    char ch;
+    std::string out;
+    while (read(command_pipe[0], &ch, 1) > 0)
     {
-        //Check current program state
-        PROCESS_STATE state = get_child_process_state(process_id);
-
-        if (state == PROCESS_STATE::DONE)
-        {
-            std::cout << "Success: execution of " << cmd << std::endl;
-
-            //Clean up by waiting / telling the child that it can "destroy itself"
-            int status;
-            waitpid(process_id, &status, 0); //0 -> no flags here
-            return true;
-        }
-        else if (state == PROCESS_STATE::ERROR)
-        {
-            kill_process(process_id);
-            std::cout << "Error in execution of " << cmd << std::endl;
-            return false;
-        }
-
-        //Use longer sleep time until short before end of timeout
-        time_passed_ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - start_time).count();
-        auto remaining_time = static_cast<int64_t>(timeout_seconds) * 1000 - time_passed_ms;
-        if (remaining_time > 1000)
-        {
-            std::this_thread::sleep_for(std::chrono::seconds(1));
-        }
-        else if (remaining_time > 0)
-        {
-            std::this_thread::sleep_for(std::chrono::milliseconds(remaining_time));
-        }
-        
-        time_passed_ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - start_time).count();
+        out += ch;
     }
+    close(command_pipe[0]);
 
-    //Now kill the process, as it has not yet finished its execution
-    //std::cout << "Killing" << std::endl;
-    kill_process(process_id);
-    std::cout << "Could not execute in time: " << cmd << std::endl;
-    return false;
+    int status;
+    waitpid(process_id, &status, 0); //0 -> no flags here
+    return out;
 }
 
-//Communication with Pipes, from gnu.org, slightly modified
-std::string read_from_pipe (int file)
-{
-    FILE *stream;
-    char c;
-    std::stringstream read_stream;
-
-    stream = fdopen (file, "r");
-    while ((c = fgetc (stream)) != EOF)
-        read_stream << c;
-    fclose (stream);
-
-    return read_stream.str();
-}
-
-void write_to_pipe (int file, std::string msg)
-{
-  FILE *stream;
-  stream = fdopen (file, "w");
-  fprintf (stream, msg.c_str());
-  fclose (stream);
-}
-
-//! Communication via message queues requires a communication struct
-struct CommandMsg {
-    //! Always required, can be used as and ID to get a sepcific msg (won't be used here though)
-    long mtype;
-
-    //! Better to use only one additional entry, so if more than one is required, define another struct here
-    struct CommandInfo {
-        char command[500];
-        int timeout_seconds;
-    } command;
-};
+//! Number of failed checks
+static int n_failed = 0;
 
 /**
- * \brief Create a CommandMsg from a command string and a given timeout. Returns false if creation failed 
- * (usually: due to too large command_string, which is limited by the size of command in CommandInfo)
- * \param command_string The command to execute 
- * \param timeout_seconds Timeout for the command, set to a value <0 to disable timeouts for this command 
- *                      (SYSTEM is used then instead of using fork explicitly)
+ * \brief Prints the result of a check, counts failures
+ * \ingroup lcc
  */
-bool create_msg(std::string command_string, int timeout_seconds, CommandMsg& command_out)
+static void check(bool condition, const std::string& label)
 {
-    command_out.command.timeout_seconds = timeout_seconds; //In our syntax, this would mean that we do not want a timeout
-    command_out.mtype = 1; //Irrelevant for us
-
-    //WARNING: In a real-world scenario, do not forget to make sure that the command string is shorter than the size of
-    //command_out.command.command, else we do not get a null terminated C string or need to truncate (which would be undesirable as well)
-    std::strncpy(command_out.command.command, command_string.c_str(), sizeof(command_out.command.command));
-    command_out.command.command[sizeof(command_out.command.command)-1] = '\0'; //For safety reasons, in case the string is too long
-
-    //Now: Compare the copied string to the original, return false if this failed
-    if (std::strcmp(command_out.command.command, command_string.c_str()) != 0) 
-        return false;
-
-    return true;
+    std::cout << (condition ? "OK     " : "FAILED ") << label << std::endl;
+    if (!condition) ++n_failed;
 }
 
 /**
- * \brief Send the desired message on the given message queue. Prints an error and returns false if it failed, else returns true
- * \param msqid ID of the msg queue to use
- * \param msg Message to send
+ * \brief Throughput of reading large command outputs, byte-wise (fork + sh) vs. ProgramExecutor::execute_command_get_output,
+ * for one command at a time and for several commands in flight at once (one thread per command, like the worker threads of ProgramExecutor).
+ * Checks that the outputs of both methods are equal.
+ * \ingroup lcc
  */
-bool send_msg(int msqid, CommandMsg& msg)
+static void run_throughput_benchmark(ProgramExecutor& executor)
 {
-    //Send the message. There might be some problem with it, so do not forget to check for errors. The flag is not used (0)
-    auto return_code = msgsnd(msqid, &msg, sizeof(CommandMsg::CommandInfo), 0);
-    if (return_code == -1)
+    bool equal = true;
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "Output size [MiB]   Commands   byte-wise [MiB/s]   ProgramExecutor [MiB/s]" << std::endl;
+    for (size_t size_mib : {1, 4, 16})
     {
-        std::cerr << "ERROR: Could not send IPC Message: " << std::strerror(errno) << std::endl;
-        return false;
-    }
+        for (size_t n_commands : {1, 4})
+        {
+            std::stringstream command;
+            command << "head -c " << size_mib * 1024 * 1024 << " /dev/zero";
+            std::string command_string = command.str();
 
-    return true;
-}
+            double throughput[2];
+            std::vector<std::string> outputs[2];
+            for (int buffered = 0; buffered < 2; ++buffered)
+            {
+                outputs[buffered].resize(n_commands);
+                auto t0 = std::chrono::steady_clock::now();
+                std::vector<std::thread> threads;
+                for (size_t i = 0; i < n_commands; ++i)
+                {
+                    threads.emplace_back([&, i, buffered] () {
+                        outputs[buffered][i] = (buffered == 1)
+                            ? ProgramExecutorTestAccess::execute_command_get_output(executor, command_string.c_str(), 60000)
+                            : read_output_bytewise(command_string.c_str());
+                    });
+                }
+                for (auto& thread : threads)
+                {
+                    thread.join();
+                }
+                auto t1 = std::chrono::steady_clock::now();
+                throughput[buffered] = static_cast<double>(size_mib * n_commands) / std::chrono::duration<double>(t1 - t0).count();
+            }
 
-/**
- * \brief Receive a message on the given message queue. Prints an error and returns false if it failed, else returns true
- * \param msqid ID of the msg queue to use
- * \param msg The received msg is stored here
- */
-bool receive_msg(int msqid, CommandMsg& msg)
-{
-    auto return_code = msgrcv(msqid, &msg, sizeof(CommandMsg::CommandInfo), 0, 0);
-    if (return_code == -1)
-    {
-        std::cerr << "ERROR: Could not receive IPC Message: " << std::strerror(errno) << std::endl;
-        return false;
+            equal = equal && (outputs[0] == outputs[1]) && (outputs[1].at(0).size() == size_mib * 1024 * 1024);
+            std::cout << std::setw(17) << size_mib << std::setw(11) << n_commands << std::setw(20) << throughput[0] << std::setw(26) << throughput[1] << std::endl;
+        }
     }
 
-    return true;
+    check(equal, "Large outputs of ProgramExecutor and byte-wise reading are equal");
 }
 
-//In this test scenario, we want to create a parent and a child process
-//The parent process tells the child process which other processes to create
-//The child process then uses the above functions to do so
 int main(int argc, char *argv[]) {
-    //TODO: Deal with interrupts / program exit & kill the child process there
-
-    //Alternative for waiting (but without being able to determine if an error occured as in get_child_process_state):
-    //This always prevents zombie processes:
-    //signal(SIGCHLD, SIG_IGN);
-    //Currently, this is not used, instead, we always wait
-    //Advantage: We can see if a child process had to exit due to an error
-    //Disadvantage: We get zombie processes if our program crashes
-    //-> What is more important?
+    //The message queue keys are created from two existing files
+    const std::string queue_file = std::string(argv[0]) + "_queue";
+    std::ofstream(queue_file, std::ios::app).close();
 
-    //Create parent and child process, allow communication via pipe
-    //But: It does not seem to be advisable to use pipes for message-communication
-    // int command_pipe[2];
-
-    // if (pipe(command_pipe))
-    // {
-    //     std::cerr << "Pipe creation failed!" << std::endl;
-    //     return EXIT_FAILURE;
-    // }
-
-    //...
-    //We only want to listen, close the pipe's write end
-    //close(command_pipe[1]); std::string received_command = read_from_pipe(command_pipe[0]); ...
-    //We only want to write, close the pipe's listen end
-    //close(command_pipe[0]); write_to_pipe(command_pipe[1], "This is a test"); ...
-
-    //So: We will have to use something else instead
-    //Different methods exist for IPC (Inter Process Communication)
-    //- FIFOs
-    //- Message Queues
-    //- File Locking / Semaphores + File Access
-    //- Pipes
-    //- Signals
-    //...
-    //Our requirements: 
-    //- Send command strings of arbitrary length
-    //- Set a timeout or use SYSTEM (so: tell which one of those to use)
-    //- Maybe return to the main program if a child execution failed
-    //-> Message Queues seem to be the best choice in such a scenario
-    //Useful guide: http://beej.us/guide/bgipc/html/single/bgipc.html#fork
-
-    //For now, we will try to use a message queue
-    //To get a (hopefully) unqiue ID, we need to create one given a file location
-    //For better portability, we hope that argv[0] contains our current file location and use that 
-    //(It usually should)#
-    //NOTE: We do not use further control or error checking (e.g. in case of a full queue) right now,
-    //because due to the desired way of operation we do not expect the queue to become full
-    auto key = ftok(argv[0], 'a'); //The char is usually arbitrary, I chose a
-    auto msqid = msgget(key, 0666 | IPC_CREAT); //Permissions: rw-rw-rw-
-
-    if (key == -1 || msqid == -1)
+    //Fork before any other thread is started, as in the LCC
+    ProgramExecutor executor;
+    if (!executor.setup_child_process(argv[0], queue_file))
     {
-        std::cerr << "ERROR: Could not create IPC Message Queue which is required for communicating commands to start external programs!" << std::endl;
-        exit(EXIT_FAILURE);
+        std::cerr << "Could not create the child process" << std::endl;
+        return 1;
     }
 
-    int process_id = fork();
-    if (process_id == 0)
+    //Commands that are started without a shell
+    check(!ProgramExecutorTestAccess::needs_shell("head -c 1024 /dev/zero"), "needs_shell: plain command");
+    check(ProgramExecutorTestAccess::needs_shell("echo a | tr a b"), "needs_shell: pipe");
+    check(ProgramExecutorTestAccess::needs_shell("echo $HOME"), "needs_shell: variable");
+    check(ProgramExecutorTestAccess::needs_shell("ls *.cpp"), "needs_shell: globbing");
+    check(ProgramExecutorTestAccess::needs_shell("tmux new-session -d \"sleep 1\""), "needs_shell: quotes");
+
+    //Output and errors, directly
+    check(ProgramExecutorTestAccess::execute_command_get_output(executor, "echo hello", 5000) == "hello\n",
+        "execute_command_get_output: command without shell");
+    check(ProgramExecutorTestAccess::execute_command_get_output(executor, "echo a | tr a b", 5000) == "b\n",
+        "execute_command_get_output: command with shell");
+    check(ProgramExecutorTestAccess::execute_command_get_output(executor, "false", 5000) == "ERROR\n",
+        "execute_command_get_output: non-zero exit code returns ERROR");
+    check(ProgramExecutorTestAccess::execute_command_get_output(executor, "this_command_does_not_exist_4711", 5000).find("ERROR") != std::string::npos,
+        "execute_command_get_output: unknown program returns ERROR");
+
+    //Timeout: the command is killed, the output so far is kept and ERROR is appended
     {
-        //Tell the child to set its group process ID to its process ID, or else things like kill(-pid) to kill a ping-while-loop won't work
-        setpgid(0, 0);
-
-        //Now try to receive a message; the child waits if there currently is no message present
-        //0 to receive the next message on the queue, irrelevant of the value of mtype, flag not used (0 as well)
-        //TODO: Create a test scenario where the child gets killed while waiting, to test if that works
-        while (true)
-        {
-            CommandMsg msg;
-            receive_msg(msqid, msg);
-
-            std::cout << "Child received command: " << msg.command.command << std::endl;
-
-            //Exit condition - just compare the first characters, as strncpy fills up the char array
-            std::string msg_string = msg.command.command;
-            if (msg_string.compare(0, 4, "EXIT") == 0)
-                break;
-        }
-
-        std::cout << "Child is stopping execution..." << std::endl;
-
-        exit(EXIT_SUCCESS);
+        auto t0 = std::chrono::steady_clock::now();
+        std::string output = ProgramExecutorTestAccess::execute_command_get_output(executor, "echo partial; sleep 30", 300);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        check(output == "partial\nERROR\n", "execute_command_get_output: timeout returns the output so far and ERROR");
+        check(seconds < 10.0, "execute_command_get_output: timed out command is killed");
     }
-    else if (process_id > 0)
-    {
-        //We are in the parent process; simulate work using waiting functions, try to communicate with the child in between
 
-        //Create and send messages
-        for (auto i = 0; i < 12; ++i)
-        {
-            std::stringstream msg_stream;
-            msg_stream << "This is test number " << i + 1 << ".";
+    //Through the child process
+    check(executor.get_command_output("echo hello") == "hello\n", "get_command_output: output");
+    check(executor.get_command_output("false").find("ERROR") != std::string::npos, "get_command_output: failing command returns ERROR");
+    check(executor.execute_command("true", 5), "execute_command: command finished in time");
+    check(!executor.execute_command("sleep 30", 1), "execute_command: timeout returns false");
 
-            CommandMsg msg;
-            if (create_msg(msg_stream.str(), -1, msg))
-            {
-                send_msg(msqid, msg);
-            }
-            else
-            {
-                std::cerr << "ERROR: Could not create IPC Message, command string was too large" << std::endl;
-            }
-        }
-
-        //Send final msg to tell the child to stop its execution
-        CommandMsg msg;
-        if (create_msg("EXIT", -1, msg))
+    //Several commands in flight at once, each answer belongs to its request
+    {
+        const int n_threads = 8;
+        std::vector<std::string> outputs(n_threads);
+        std::vector<std::thread> threads;
+        for (int i = 0; i < n_threads; ++i)
         {
-            send_msg(msqid, msg);
+            threads.emplace_back([&, i] () {
+                outputs[i] = executor.get_command_output("sleep 0.2; echo " + std::to_string(i));
+            });
         }
-        else
+        bool all_match = true;
+        for (int i = 0; i < n_threads; ++i)
         {
-            std::cerr << "ERROR: Could not create IPC Message, command string was too large" << std::endl;
+            threads[i].join();
+            all_match = all_match && outputs[i] == std::to_string(i) + "\n";
         }
+        check(all_match, "get_command_output: concurrent commands");
+    }
 
-        //----------------------------------------CLEANING UP-----------------------------------------------------------//
-        //The parent ALWAYS has to wait for the child to finish, else ressources are not cleaned up
-        //There is an alternative to that (ignore SIGCHLD), but as far as I interpret it that would probably lead to 
-        //problems with get_child_process_state
-        int status;
-        waitpid(process_id, &status, 0); //0 -> no flags here
+    run_throughput_benchmark(executor);
 
-        //Destroy the message queue
-        auto return_code = msgctl(msqid, IPC_RMID, NULL);
-        if (return_code == -1)
-        {
-            std::cerr << "ERROR: Could not send IPC Message: " << std::strerror(errno) << std::endl;
-            exit(EXIT_FAILURE);
-        }
-
-        exit(EXIT_SUCCESS);
-    }
-    else 
+    if (n_failed > 0)
     {
-        //We could not spawn a new process - usually, the program should not just break at this point, unless that behaviour is desired
-        //TODO: Change behaviour
-        std::cerr << "Error when using fork: Could not create 'meta'-child process!";
-        exit(EXIT_FAILURE);
+        std::cerr << "ForkCommunicationTest: " << n_failed << " checks failed" << std::endl;
+        return 1;
     }
-
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,232 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <regex>
+#include <sstream>
+#include <unistd.h>
+#include <vector>
+
+#include "cpm/CommandLineReader.hpp"
+#include "LogArchive.hpp"
+
+/**
+ * \file LogStorageBenchmark.cpp
+ * \brief Ingest rate, memory footprint and query latency of the LogArchive (the storage of LogStorage) for
+ * --logs=INT (default 1000000) synthetic log messages, appended in batches of 100 like in the log callback.
+ * Each query is checked against a linear std::regex_search over all logs (newest 100 matches), returns 1 on a mismatch.
+ * For comparison, the previous search (copy of the newest 10000 logs, regex on every entry) is timed as well.
+ * \ingroup lcc
+ */
+
+/**
+ * \brief Resident memory of the process in bytes
+ * \ingroup lcc
+ */
+static size_t resident_memory()
+{
+    std::ifstream statm("/proc/self/statm");
+    size_t size = 0;
+    size_t resident = 0;
+    statm >> size >> resident;
+    return resident * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+}
+
+/**
+ * \brief Deterministic synthetic log number i, similar to the logs of an experiment with 20 vehicles
+ * \ingroup lcc
+ */
+static Log make_log(uint64_t i)
+{
+    const uint64_t stamp = 1600000000000000000ull + i * 1000000ull;
+    const unsigned short level = static_cast<unsigned short>(1 + i % 3);
+    std::stringstream content;
+    string id;
+    switch (i % 5)
+    {
+        case 0:
+            id = "vehicle_" + to_string(i % 20);
+            content << "Trajectory point " << (i % 997) << " is in the past, dt = " << (i % 50) << " ms";
+            break;
+        case 1:
+            id = "middleware_" + to_string(i % 20);
+            content << "Received command for vehicle " << (i % 20) << " with " << (i % 13) << " trajectory points";
+            break;
+        case 2:
+            id = "hlc";
+            content << "Timer missed deadline by " << (i % 1000) << " us in period " << i;
+            break;
+        case 3:
+            id = "lab_control_center";
+            content << "Vehicle " << (i % 20) << " battery at " << (7.0 + 0.001 * (i % 1500)) << " V";
+            break;
+        default:
+            id = "vehicle_" + to_string(i % 20);
+            content << "IPS update age " << (i % 250) << " ms";
+            break;
+    }
+    if (i % 100000 == 77)
+    {
+        content.str("");
+        content << "Watchdog timeout on vehicle " << (i % 20) << ", stopping";
+    }
+    return Log(id, content.str(), TimeStamp(stamp), level);
+}
+
+/**
+ * \brief Text that a filter type refers to, as in the previous search
+ * \ingroup lcc
+ */
+static string previous_filter_text(const Log& log, LogArchive::FilterType filter_type)
+{
+    std::stringstream stream;
+    switch (filter_type)
+    {
+        case LogArchive::ID:
+            return log.id();
+        case LogArchive::Content:
+            return log.content();
+        case LogArchive::Timestamp:
+            stream << log.stamp().nanoseconds();
+            return stream.str();
+        default:
+            stream << log.id() << log.content() << log.stamp().nanoseconds();
+            return stream.str();
+    }
+}
+
+/**
+ * \brief Expected result: The newest max_results matches of a linear search over all logs, oldest first
+ * \ingroup lcc
+ */
+static vector<Log> reference_search(uint64_t n_logs, const string& filter_value, LogArchive::FilterType filter_type,
+    unsigned short log_level, size_t max_results)
+{
+    std::regex search_regex(filter_value);
+    vector<Log> result;
+    for (uint64_t i = n_logs; i > 0 && result.size() < max_results; --i)
+    {
+        const Log log = make_log(i - 1);
+        if (log.log_level() <= log_level && std::regex_search(previous_filter_text(log, filter_type), search_regex))
+        {
+            result.push_back(log);
+        }
+    }
+    std::reverse(result.begin(), result.end());
+    return result;
+}
+
+/**
+ * \brief Search query of the benchmark
+ * \ingroup lcc
+ */
+struct Query
+{
+    //! Shown in the output
+    string label;
+    //! Regex
+    string filter_value;
+    //! Where the regex must match
+    LogArchive::FilterType filter_type;
+};
+
+int main(int argc, char *argv[]) {
+    const uint64_t n_logs = static_cast<uint64_t>(cpm::cmd_parameter_int("logs", 1000000, argc, argv));
+    const size_t batch_size = 100;
+    const size_t max_results = 100;
+    const unsigned short log_level = 3;
+
+    const size_t memory_start = resident_memory();
+    LogArchive archive("LogStorageBenchmark.bin");
+
+    // Ingest, generation of the logs is not measured
+    double ingest_seconds = 0;
+    vector<Log> batch;
+    for (uint64_t i = 0; i < n_logs; i += batch_size)
+    {
+        batch.clear();
+        for (uint64_t j = i; j < std::min(n_logs, i + batch_size); ++j) batch.push_back(make_log(j));
+
+        auto t0 = std::chrono::steady_clock::now();
+        archive.append(batch);
+        auto t1 = std::chrono::steady_clock::now();
+        ingest_seconds += std::chrono::duration<double>(t1 - t0).count();
+    }
+    const size_t memory_end = resident_memory();
+
+    cout << std::fixed << std::setprecision(1);
+    cout << n_logs << " logs, ingest " << n_logs / ingest_seconds * 1e-3 << " k logs/s" << endl;
+    cout << "Memory: " << archive.memory_usage() / 1e6 << " MB (resident +" << (memory_end - memory_start) / 1e6
+        << " MB), spill file " << archive.spill_file_size() / 1e6 << " MB" << endl;
+
+    // The previous storage kept the newest 10000 logs, the search copied them and ran the regex on every entry
+    vector<Log> previous_storage;
+    for (uint64_t i = (n_logs > 10000) ? n_logs - 10000 : 0; i < n_logs; ++i) previous_storage.push_back(make_log(i));
+
+    const vector<Query> queries = {
+        {"Content, frequent literal",           "is in the past",                    LogArchive::Content},
+        {"Content, rare literal",               "Watchdog timeout",                  LogArchive::Content},
+        {"Content, regex with literals",        "^Watchdog .* vehicle 1[0-9]",      LogArchive::Content},
+        {"Content, regex without literals",     "[0-9]{7}",                          LogArchive::Content},
+        {"Content, no match",                   "segmentation fault",                LogArchive::Content},
+        {"Content, hex escape",                 "\\x57atchdog timeout",              LogArchive::Content},
+        {"Content, unicode escape",             "\\u0057atchdog timeout",            LogArchive::Content},
+        {"Content, back reference",             "update age ([0-9])\\1 ms",          LogArchive::Content},
+        {"ID",                                  "middleware_11",                     LogArchive::ID},
+        {"Timestamp",                           "1600000000123",                     LogArchive::Timestamp},
+        {"All",                                 "hlcTimer missed deadline by 997 ",  LogArchive::All}
+    };
+
+    bool failed = false;
+    std::atomic_bool continue_search{true};
+    for (const Query& query : queries)
+    {
+        const int n_runs = 5;
+        vector<Log> result;
+        auto t0 = std::chrono::steady_clock::now();
+        for (int r = 0; r < n_runs; ++r)
+        {
+            result = archive.search(query.filter_value, query.filter_type, log_level, max_results, continue_search);
+        }
+        auto t1 = std::chrono::steady_clock::now();
+
+        // Previous search on the newest 10000 logs only
+        std::regex search_regex(query.filter_value);
+        auto t2 = std::chrono::steady_clock::now();
+        vector<Log> storage_copy(previous_storage);
+        vector<Log> previous_result;
+        for (const Log& log : storage_copy)
+        {
+            if (std::regex_search(previous_filter_text(log, query.filter_type), search_regex) && log.log_level() <= log_level)
+            {
+                previous_result.push_back(log);
+            }
+        }
+        auto t3 = std::chrono::steady_clock::now();
+
+        const vector<Log> expected = reference_search(n_logs, query.filter_value, query.filter_type, log_level, max_results);
+        bool equal = expected.size() == result.size();
+        for (size_t i = 0; equal && i < result.size(); ++i)
+        {
+            equal = result[i].id() == expected[i].id() && result[i].content() == expected[i].content()
+                && result[i].stamp().nanoseconds() == expected[i].stamp().nanoseconds()
+                && result[i].log_level() == expected[i].log_level();
+        }
+        failed = failed || !equal;
+
+        cout << std::setw(36) << std::left << query.label << std::right << std::setprecision(2)
+            << std::setw(10) << std::chrono::duration<double, std::milli>(t1 - t0).count() / n_runs << " ms, "
+            << std::setw(3) << result.size() << " results" << (equal ? "" : " (MISMATCH)")
+            << " | previous (10000 logs) " << std::setw(8) << std::chrono::duration<double, std::milli>(t3 - t2).count()
+            << " ms, " << previous_result.size() << " results" << endl;
+    }
+
+    if (failed)
+    {
+        cerr << "LogStorageBenchmark: search results differ from the linear search" << endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,235 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+
+#include "cpm/CommandLineReader.hpp"
+#include "commonroad_classes/CommonRoadScenario.hpp"
+#include "ui/map_view/MapLayerCache.hpp"
+
+/**
+ * \file MapViewRenderBenchmark.cpp
+ * \brief Offscreen benchmark of the map view rendering: Renders a CommonRoad scenario and synthetic dynamic content
+ * (vehicles, past trajectories, trajectory commands) to a Cairo image surface, like MapViewUi::draw. Compares drawing
+ * everything in every frame with the cached static layer (MapLayerCache), and measures frames during which the view is
+ * panned (the static layer is rendered again in every frame).
+ * Options: --scenario=PATH (default ./ui/map_view/LabMapCommonRoad.xml), --tiles=INT (draws the scenario tiles x tiles
+ * times to emulate a large scenario, default 3), --frames=INT (default 200), --vehicles=INT (default 20),
+ * --width=INT and --height=INT (default 1920 x 1080)
+ * \ingroup lcc_ui
+ */
+
+/**
+ * \brief View parameters as in MapViewUi
+ * \ingroup lcc_ui
+ */
+struct View
+{
+    //! Translation in x direction
+    double pan_x;
+    //! Translation in y direction
+    double pan_y;
+    //! Scale
+    double zoom;
+    //! Rotation around (2.25, 2)
+    double rotation;
+};
+
+/**
+ * \brief Transformation as in MapViewUi::apply_view_transform
+ * \ingroup lcc_ui
+ */
+static void apply_view_transform(const DrawingContext& ctx, const View& view)
+{
+    ctx->translate(view.pan_x, view.pan_y);
+    ctx->scale(view.zoom, -view.zoom);
+    ctx->translate(2.25, 2);
+    ctx->rotate(view.rotation);
+    ctx->translate(-2.25, -2);
+}
+
+/**
+ * \brief Static layer: The scenario, tiled, and the lab boundaries
+ * \ingroup lcc_ui
+ */
+static void draw_static_layer(const DrawingContext& ctx, const View& view, CommonRoadScenario& scenario, int tiles)
+{
+    ctx->save();
+    apply_view_transform(ctx, view);
+    for (int i = 0; i < tiles; ++i)
+    {
+        for (int j = 0; j < tiles; ++j)
+        {
+            scenario.draw(ctx, 1.0, 0.0, 4.5 * (i - tiles / 2), 4.0 * (j - tiles / 2));
+        }
+    }
+    ctx->set_line_width(0.005);
+    ctx->set_source_rgb(77.0/255.0, 147.0/255.0, 215.0/255.0);
+    ctx->rectangle(0, 0, 4.5, 4.0);
+    ctx->stroke();
+    ctx->restore();
+}
+
+/**
+ * \brief Dynamic layer: Vehicles driving on circles with past trajectory and trajectory command, similar in cost
+ * to MapViewUi::draw_vehicle_past_trajectory, draw_received_trajectory_commands and draw_vehicle_body
+ * \ingroup lcc_ui
+ */
+static void draw_dynamic_layer(const DrawingContext& ctx, const View& view, int n_vehicles, int frame)
+{
+    ctx->save();
+    apply_view_transform(ctx, view);
+    for (int v = 0; v < n_vehicles; ++v)
+    {
+        const double radius = 0.5 + 0.07 * v;
+        auto position = [&](double k, double& x, double& y) {
+            x = 2.25 + radius * std::cos(0.01 * k + v);
+            y = 2.0 + radius * std::sin(0.01 * k + v);
+        };
+
+        // Past trajectory, 100 points
+        double x, y;
+        position(frame - 100, x, y);
+        ctx->move_to(x, y);
+        for (int k = frame - 99; k <= frame; ++k)
+        {
+            position(k, x, y);
+            ctx->line_to(x, y);
+        }
+        ctx->set_source_rgb(1, 0, 0);
+        ctx->set_line_width(0.01);
+        ctx->stroke();
+
+        // Trajectory command, 10 segments with 20 interpolation steps each
+        for (int segment = 0; segment < 10; ++segment)
+        {
+            position(frame + 5 * segment, x, y);
+            ctx->move_to(x, y);
+            for (int step = 1; step <= 20; ++step)
+            {
+                position(frame + 5 * segment + 0.25 * step, x, y);
+                ctx->line_to(x, y);
+                ctx->set_source_rgb(0, 0, 0.8);
+                ctx->stroke();
+                ctx->move_to(x, y);
+            }
+        }
+
+        // Vehicle body and ID
+        position(frame, x, y);
+        ctx->save();
+        ctx->translate(x, y);
+        ctx->rotate(0.01 * frame + v + M_PI / 2);
+        ctx->rectangle(-0.1, -0.05, 0.22, 0.1);
+        ctx->set_source_rgb(0.2, 0.2, 0.2);
+        ctx->fill();
+        ctx->scale(0.01, -0.01);
+        ctx->move_to(0, 0);
+        ctx->set_source_rgb(1, 1, 1);
+        ctx->show_text(to_string(v + 1));
+        ctx->restore();
+    }
+    ctx->restore();
+}
+
+/**
+ * \brief Clears the surface, like the background of the drawing area
+ * \ingroup lcc_ui
+ */
+static void clear(const DrawingContext& ctx)
+{
+    ctx->save();
+    ctx->set_source_rgb(1, 1, 1);
+    ctx->paint();
+    ctx->restore();
+}
+
+int main(int argc, char *argv[]) {
+    const std::string scenario_file = cpm::cmd_parameter_string("scenario", "./ui/map_view/LabMapCommonRoad.xml", argc, argv);
+    const int tiles = cpm::cmd_parameter_int("tiles", 3, argc, argv);
+    const int frames = cpm::cmd_parameter_int("frames", 200, argc, argv);
+    const int n_vehicles = cpm::cmd_parameter_int("vehicles", 20, argc, argv);
+    const int width = cpm::cmd_parameter_int("width", 1920, argc, argv);
+    const int height = cpm::cmd_parameter_int("height", 1080, argc, argv);
+
+    CommonRoadScenario scenario;
+    scenario.load_file(scenario_file);
+    scenario.get_draw_configuration()->draw_traffic_signs.store(true);
+    scenario.get_draw_configuration()->draw_traffic_lights.store(true);
+
+    auto surface = Cairo::ImageSurface::create(Cairo::FORMAT_ARGB32, width, height);
+    auto ctx = Cairo::Context::create(surface);
+
+    // Initial view as in MapViewUi (centered, rotated by 90 degrees), zoomed out to show all tiles
+    View view;
+    view.zoom = std::min(width, height) / (6.0 * std::max(1, tiles));
+    view.pan_x = width / 2.0 - 2.25 * view.zoom;
+    view.pan_y = height / 2.0 + 2.0 * view.zoom;
+    view.rotation = M_PI / 2;
+    scenario.get_draw_configuration()->zoom_factor.store(view.zoom);
+
+    auto key_for = [&](const View& v) {
+        MapLayerCache::Key key;
+        key.width = width;
+        key.height = height;
+        key.pan_x = v.pan_x;
+        key.pan_y = v.pan_y;
+        key.zoom = v.zoom;
+        key.rotation = v.rotation;
+        key.content_revision = scenario.get_revision();
+        return key;
+    };
+
+    auto measure = [&](const string& label, std::function<void(int)> render_frame) {
+        auto t0 = std::chrono::steady_clock::now();
+        for (int frame = 0; frame < frames; ++frame)
+        {
+            render_frame(frame);
+        }
+        surface->flush();
+        auto t1 = std::chrono::steady_clock::now();
+        const double ms = std::chrono::duration<double, std::milli>(t1 - t0).count() / frames;
+        cout << std::setw(44) << std::left << label << std::right << std::fixed << std::setprecision(2)
+            << std::setw(8) << ms << " ms/frame (" << std::setprecision(0) << 1000.0 / ms << " fps max)" << endl;
+    };
+
+    cout << scenario_file << " x " << tiles * tiles << ", " << n_vehicles << " vehicles, "
+        << width << " x " << height << ", " << frames << " frames" << endl;
+
+    measure("Static layer only, drawn every frame", [&](int) {
+        clear(ctx);
+        draw_static_layer(ctx, view, scenario, tiles);
+    });
+
+    measure("Everything drawn every frame (previous)", [&](int frame) {
+        clear(ctx);
+        draw_static_layer(ctx, view, scenario, tiles);
+        draw_dynamic_layer(ctx, view, n_vehicles, frame);
+    });
+
+    MapLayerCache cache;
+    measure("Cached static layer + dynamic layer", [&](int frame) {
+        clear(ctx);
+        cache.paint(ctx, key_for(view), [&](const DrawingContext& layer_ctx) {
+            draw_static_layer(layer_ctx, view, scenario, tiles);
+        });
+        draw_dynamic_layer(ctx, view, n_vehicles, frame);
+    });
+    cout << "  static layer rendered " << cache.get_render_count() << " times" << endl;
+
+    View panned_view = view;
+    measure("Cached, view panned in every frame", [&](int frame) {
+        panned_view.pan_x = view.pan_x + frame;
+        clear(ctx);
+        cache.paint(ctx, key_for(panned_view), [&](const DrawingContext& layer_ctx) {
+            draw_static_layer(layer_ctx, panned_view, scenario, tiles);
+        });
+        draw_dynamic_layer(ctx, panned_view, n_vehicles, frame);
+    });
+    cout << "  static layer rendered " << cache.get_render_count() << " times" << endl;
+
+    surface->write_to_png("MapViewRenderBenchmark.png");
+    return 0;
+}
@@ -0,0 +1,118 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "cpm/CommandLineReader.hpp"
+#include "ObstacleSimulationEngine.hpp"
+
+/**
+ * \file ObstacleSimulationBenchmark.cpp
+ * \brief Time per tick of the obstacle simulation (ObstacleSimulationEngine::get_states, one CommonroadObstacleList per tick)
+ * for 10 to 2000 synthetic dynamic obstacles with --points=INT (default 200) trajectory points each, over --ticks=INT
+ * (default 500) ticks of 20 ms with a time step size of 0.1 s. Compares stepping on the calling thread only with stepping on
+ * --threads=INT threads (default 0: all hardware threads). Returns 1 if the resulting states differ.
+ * \ingroup lcc
+ */
+
+/**
+ * \brief Dynamic obstacle driving on a circle, with a rectangle shape
+ * \ingroup lcc
+ */
+static ObstacleSimulationData create_obstacle_data(int id, int n_points)
+{
+    ObstacleSimulationData data;
+    data.obstacle_type = ObstacleType::Car;
+    data.obstacle_class = ObstacleClass::Dynamic;
+
+    CommonroadDDSRectangle rectangle;
+    rectangle.length(0.22);
+    rectangle.width(0.1);
+    CommonroadDDSShape shape;
+    shape.rectangles(std::vector<CommonroadDDSRectangle>{rectangle});
+
+    const double radius = 0.5 + 0.01 * (id % 100);
+    for (int k = 0; k < n_points; ++k)
+    {
+        //IntervalOrExact can only be created from XML
+        xmlpp::Document document;
+        auto time_node = document.create_root_node("time");
+        time_node->add_child("exact")->add_child_text(std::to_string(k));
+
+        const double angle = 0.05 * k + id;
+        ObstacleSimulationSegment segment;
+        segment.position = std::make_pair(2.25 + radius * std::cos(angle), 2.0 + radius * std::sin(angle));
+        segment.orientation = angle + M_PI / 2;
+        segment.time = IntervalOrExact(time_node);
+        segment.shape = shape;
+        segment.is_exact = true;
+        data.trajectory.push_back(segment);
+    }
+
+    return data;
+}
+
+int main(int argc, char *argv[]) {
+    const int n_points = std::max(2, cpm::cmd_parameter_int("points", 200, argc, argv));
+    const int n_ticks = std::max(1, cpm::cmd_parameter_int("ticks", 500, argc, argv));
+    const int n_threads = std::max(0, cpm::cmd_parameter_int("threads", 0, argc, argv));
+
+    const uint64_t time_step_size = 100000000ull;
+    const uint64_t tick_period = 20000000ull;
+    const uint64_t start_time = 1000000000ull;
+
+    auto all_obstacles = [] (uint8_t) { return true; };
+
+    bool equal = true;
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "Obstacles   1 thread [ms/tick]   pool [ms/tick]" << std::endl;
+    for (int n_obstacles : {10, 100, 500, 1000, 2000})
+    {
+        ObstacleSimulationEngine sequential_engine(1);
+        ObstacleSimulationEngine parallel_engine(static_cast<size_t>(n_threads));
+        for (int id = 0; id < n_obstacles; ++id)
+        {
+            auto data = create_obstacle_data(id, n_points);
+            sequential_engine.add_obstacle(id, data);
+            parallel_engine.add_obstacle(id, data);
+        }
+
+        double duration_ms[2] = {0.0, 0.0};
+        ObstacleSimulationEngine* engines[2] = {&sequential_engine, &parallel_engine};
+        CommonroadObstacleList last_states[2];
+        for (int e = 0; e < 2; ++e)
+        {
+            auto t0 = std::chrono::steady_clock::now();
+            for (int tick = 0; tick < n_ticks; ++tick)
+            {
+                const uint64_t t_now = start_time + tick * tick_period;
+                last_states[e] = engines[e]->get_states(start_time, t_now, time_step_size, all_obstacles);
+            }
+            auto t1 = std::chrono::steady_clock::now();
+            duration_ms[e] = std::chrono::duration<double, std::milli>(t1 - t0).count() / n_ticks;
+        }
+
+        const auto& sequential_states = last_states[0].commonroad_obstacle_list();
+        const auto& parallel_states = last_states[1].commonroad_obstacle_list();
+        equal = equal && (sequential_states.size() == parallel_states.size());
+        for (size_t i = 0; equal && i < sequential_states.size(); ++i)
+        {
+            equal = sequential_states[i].vehicle_id() == parallel_states[i].vehicle_id()
+                && sequential_states[i].pose().x() == parallel_states[i].pose().x()
+                && sequential_states[i].pose().y() == parallel_states[i].pose().y()
+                && sequential_states[i].pose().yaw() == parallel_states[i].pose().yaw();
+        }
+
+        std::cout << std::setw(9) << n_obstacles << std::setw(21) << duration_ms[0] << std::setw(17) << duration_ms[1] << std::endl;
+    }
+
+    if (!equal)
+    {
+        std::cerr << "ObstacleSimulationBenchmark: States of sequential and parallel stepping differ" << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,179 @@
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <csignal>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "cpm/CommandLineReader.hpp"
+#include "ProcessSupervisor.hpp"
+
+/**
+ * \file ProcessSupervisorTest.cpp
+ * \brief Launches --processes=INT (default 20) local dummy processes (sleep), watches them with a ProcessSupervisor and kills
+ * them one after another (SIGKILL, every --interval_ms=INT, default 50 ms). Measures the latency between the kill and the exit callback,
+ * and also checks that a process that terminates by itself is reported, and that unwatched processes are not reported.
+ * Returns 1 if an exit was not reported within one second or if an unwatched process was reported.
+ * \ingroup lcc
+ */
+
+/**
+ * \brief Start a dummy process that sleeps for the given time, in its own process group (like the processes started by ProgramExecutor)
+ * \ingroup lcc
+ */
+static pid_t start_dummy_process(const char* seconds)
+{
+    pid_t process_id = fork();
+    if (process_id == 0)
+    {
+        setpgid(0, 0);
+        execlp("sleep", "sleep", seconds, static_cast<char*>(nullptr));
+        _exit(EXIT_FAILURE);
+    }
+    return process_id;
+}
+
+int main(int argc, char *argv[]) {
+    const int n_processes = std::max(1, cpm::cmd_parameter_int("processes", 20, argc, argv));
+    const int interval_ms = std::max(1, cpm::cmd_parameter_int("interval_ms", 50, argc, argv));
+
+    if (!ProcessSupervisor::is_supported())
+    {
+        std::cout << "ProcessSupervisorTest: pidfds are not supported on this system (Linux >= 5.3 required), nothing to test" << std::endl;
+        return 0;
+    }
+
+    //Time of detection for each reported process
+    std::mutex detection_mutex;
+    std::condition_variable detection_cv;
+    std::map<std::string, std::chrono::steady_clock::time_point> detection_times;
+
+    ProcessSupervisor supervisor;
+    supervisor.set_exit_callback([&] (std::string name) {
+        auto now = std::chrono::steady_clock::now();
+        std::lock_guard<std::mutex> lock(detection_mutex);
+        detection_times[name] = now;
+        detection_cv.notify_all();
+    });
+
+    auto wait_for_detection = [&] (const std::string& name) {
+        std::unique_lock<std::mutex> lock(detection_mutex);
+        return detection_cv.wait_for(lock, std::chrono::seconds(1), [&] { return detection_times.count(name) > 0; });
+    };
+
+    bool success = true;
+
+    //Killed processes: Latency between kill and callback
+    std::vector<pid_t> process_ids;
+    for (int i = 0; i < n_processes; ++i)
+    {
+        pid_t process_id = start_dummy_process("100");
+        process_ids.push_back(process_id);
+        if (!supervisor.watch("dummy_" + std::to_string(i), process_id))
+        {
+            std::cerr << "ProcessSupervisorTest: Could not watch process " << process_id << std::endl;
+            success = false;
+        }
+    }
+
+    std::vector<double> latencies_ms;
+    for (int i = 0; i < n_processes; ++i)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(interval_ms));
+
+        const std::string name = "dummy_" + std::to_string(i);
+        auto kill_time = std::chrono::steady_clock::now();
+        kill(process_ids.at(i), SIGKILL);
+
+        if (wait_for_detection(name))
+        {
+            std::lock_guard<std::mutex> lock(detection_mutex);
+            latencies_ms.push_back(std::chrono::duration<double, std::milli>(detection_times.at(name) - kill_time).count());
+        }
+        else
+        {
+            std::cerr << "ProcessSupervisorTest: Exit of " << name << " was not detected" << std::endl;
+            success = false;
+        }
+
+        //Not running anymore, but still watched until unwatch
+        auto running = supervisor.is_running(name);
+        success = success && running.has_value() && !running.value();
+
+        int status;
+        waitpid(process_ids.at(i), &status, 0); //0 -> no flags here
+    }
+
+    //Process that terminates by itself
+    pid_t short_process_id = start_dummy_process("0.2");
+    auto short_start_time = std::chrono::steady_clock::now();
+    supervisor.watch("short", short_process_id);
+    if (!wait_for_detection("short"))
+    {
+        std::cerr << "ProcessSupervisorTest: Exit of a terminating process was not detected" << std::endl;
+        success = false;
+    }
+    int status;
+    waitpid(short_process_id, &status, 0); //0 -> no flags here
+
+    //Processes that are killed on purpose are unwatched before
+    pid_t unwatched_process_id = start_dummy_process("100");
+    supervisor.watch("unwatched", unwatched_process_id);
+    supervisor.unwatch("unwatched");
+    kill(unwatched_process_id, SIGKILL);
+    waitpid(unwatched_process_id, &status, 0); //0 -> no flags here
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    {
+        std::lock_guard<std::mutex> lock(detection_mutex);
+        if (detection_times.count("unwatched") > 0 || supervisor.is_running("unwatched").has_value())
+        {
+            std::cerr << "ProcessSupervisorTest: Exit of an unwatched process was reported" << std::endl;
+            success = false;
+        }
+    }
+
+    //Process that exited before it was watched is reported right away
+    if (!supervisor.watch("already_exited", short_process_id) || !wait_for_detection("already_exited"))
+    {
+        std::cerr << "ProcessSupervisorTest: Exit of an already exited process was not reported" << std::endl;
+        success = false;
+    }
+
+    if (latencies_ms.size() > 0)
+    {
+        std::sort(latencies_ms.begin(), latencies_ms.end());
+        double mean_ms = 0.0;
+        for (double latency : latencies_ms)
+        {
+            mean_ms += latency;
+        }
+        mean_ms /= static_cast<double>(latencies_ms.size());
+
+        std::cout << std::fixed << std::setprecision(3);
+        std::cout << "Detection latency after SIGKILL for " << latencies_ms.size() << " processes [ms]: mean " << mean_ms
+            << ", median " << latencies_ms.at(latencies_ms.size() / 2) << ", max " << latencies_ms.back() << std::endl;
+    }
+    {
+        std::lock_guard<std::mutex> lock(detection_mutex);
+        if (detection_times.count("short") > 0)
+        {
+            std::cout << "Terminating process (sleep 0.2) reported after [ms]: "
+                << std::chrono::duration<double, std::milli>(detection_times.at("short") - short_start_time).count() << std::endl;
+        }
+    }
+
+    if (!success)
+    {
+        return 1;
+    }
+    return 0;
+}
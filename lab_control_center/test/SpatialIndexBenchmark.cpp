@@ -0,0 +1,170 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "cpm/CommandLineReader.hpp"
+#include "commonroad_classes/CommonRoadScenario.hpp"
+
+/**
+ * \file SpatialIndexBenchmark.cpp
+ * \brief Compares the spatial index of CommonRoadScenario with a scan over all lanelets on a synthetic scenario with
+ * --lanelets=INT (default 10000) lanelets: Area queries for --queries=INT (default 1000) random views of the size of the lab,
+ * nearest lanelet queries for as many random points, and offscreen rendering of --frames=INT (default 50) views with
+ * --width=INT x --height=INT (default 1920 x 1080) pixels. Returns 1 if the results of index and scan differ.
+ * \ingroup lcc_commonroad
+ */
+
+/**
+ * \brief Writes a scenario with n_lanelets lanelets, in rows of 100 adjacent lanelets, each with 10 points per bound
+ * \ingroup lcc_commonroad
+ */
+static void write_synthetic_scenario(const std::string& filepath, int n_lanelets)
+{
+    const int row_length = 100;
+    std::ofstream file(filepath);
+    file << std::fixed << std::setprecision(9);
+    file << "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n"
+        << "<commonRoad affiliation=\"CPM Lab\" author=\"SpatialIndexBenchmark\" benchmarkID=\"SYNTHETIC-1\" "
+        << "commonRoadVersion=\"2018b\" date=\"2020-01-01\" source=\"synthetic\" timeStepSize=\"0.1\">\n";
+
+    auto write_bound = [&](const char* name, double x0, double y, const char* marking) {
+        file << "      <" << name << ">\n";
+        for (int k = 0; k < 10; ++k)
+        {
+            file << "         <point>\n"
+                << "            <x>" << x0 + 0.1 * k << "</x>\n"
+                << "            <y>" << y + 0.001 * k * k << "</y>\n"
+                << "         </point>\n";
+        }
+        file << "         <lineMarking>" << marking << "</lineMarking>\n";
+        file << "      </" << name << ">\n";
+    };
+
+    for (int id = 1; id <= n_lanelets; ++id)
+    {
+        const int row = (id - 1) / row_length;
+        const int column = (id - 1) % row_length;
+        const double x0 = 0.9 * row;
+        const double y = 0.2 * column;
+
+        file << "   <lanelet id=\"" << id << "\">\n";
+        write_bound("leftBound", x0, y + 0.2, "dashed");
+        write_bound("rightBound", x0, y, "solid");
+        if (id - row_length >= 1) file << "      <predecessor ref=\"" << id - row_length << "\"/>\n";
+        if (id + row_length <= n_lanelets) file << "      <successor ref=\"" << id + row_length << "\"/>\n";
+        file << "   </lanelet>\n";
+    }
+    file << "</commonRoad>\n";
+}
+
+int main(int argc, char *argv[]) {
+    const int n_lanelets = std::max(1, cpm::cmd_parameter_int("lanelets", 10000, argc, argv));
+    const int n_queries = std::max(1, cpm::cmd_parameter_int("queries", 1000, argc, argv));
+    const int n_frames = std::max(1, cpm::cmd_parameter_int("frames", 50, argc, argv));
+    const int width = cpm::cmd_parameter_int("width", 1920, argc, argv);
+    const int height = cpm::cmd_parameter_int("height", 1080, argc, argv);
+
+    const std::string synthetic_scenario = "./SpatialIndexBenchmark_synthetic.xml";
+    write_synthetic_scenario(synthetic_scenario, n_lanelets);
+
+    CommonRoadScenario scenario;
+    scenario.set_binary_cache_enabled(false);
+    scenario.load_file(synthetic_scenario, false);
+
+    //Extent of the synthetic scenario
+    const double x_max = 0.9 * ((n_lanelets - 1) / 100 + 1);
+    const double y_max = 0.2 * std::min(n_lanelets, 100) + 0.2;
+
+    std::mt19937 generator(0);
+    std::uniform_real_distribution<double> random_x(-1.0, x_max + 1.0);
+    std::uniform_real_distribution<double> random_y(-1.0, y_max + 1.0);
+    std::vector<std::pair<double, double>> points;
+    for (int i = 0; i < n_queries; ++i)
+    {
+        points.emplace_back(random_x(generator), random_y(generator));
+    }
+
+    auto time_ms = [](std::function<void()> function) {
+        auto t0 = std::chrono::steady_clock::now();
+        function();
+        auto t1 = std::chrono::steady_clock::now();
+        return std::chrono::duration<double, std::milli>(t1 - t0).count();
+    };
+
+    //Area queries: Views of the size of the lab (4.5 m x 4 m)
+    std::vector<std::vector<int>> area_results[2];
+    double area_ms[2];
+    //Nearest lanelet queries
+    std::vector<std::optional<int>> nearest_results[2];
+    double nearest_ms[2];
+    //Rendering
+    double render_ms[2];
+
+    auto surface = Cairo::ImageSurface::create(Cairo::FORMAT_ARGB32, width, height);
+    auto ctx = Cairo::Context::create(surface);
+    const double zoom = std::min(width, height) / 4.0;
+
+    for (int use_index = 0; use_index < 2; ++use_index)
+    {
+        scenario.set_spatial_index_enabled(use_index == 1);
+
+        area_ms[use_index] = time_ms([&]() {
+            for (const auto& point : points)
+            {
+                area_results[use_index].push_back(
+                    scenario.get_lanelet_ids_in_area(point.first, point.first + 4.5, point.second, point.second + 4.0));
+            }
+        });
+
+        nearest_ms[use_index] = time_ms([&]() {
+            for (const auto& point : points)
+            {
+                nearest_results[use_index].push_back(scenario.get_nearest_lanelet_id(point.first, point.second));
+            }
+        });
+
+        render_ms[use_index] = time_ms([&]() {
+            for (int frame = 0; frame < n_frames; ++frame)
+            {
+                const auto& point = points.at(frame % points.size());
+
+                ctx->save();
+                ctx->set_source_rgb(1, 1, 1);
+                ctx->paint();
+                ctx->translate(-point.first * zoom, height + point.second * zoom);
+                ctx->scale(zoom, -zoom);
+                scenario.draw(ctx);
+                ctx->restore();
+            }
+            surface->flush();
+        });
+    }
+
+    const bool equal = (area_results[0] == area_results[1]) && (nearest_results[0] == nearest_results[1]);
+
+    size_t visible_lanelets = 0;
+    for (const auto& result : area_results[1])
+    {
+        visible_lanelets += result.size();
+    }
+
+    std::cout << std::fixed << std::setprecision(4);
+    std::cout << scenario.get_lanelet_ids().size() << " lanelets, on average " << visible_lanelets / n_queries << " in a view" << std::endl;
+    std::cout << "                          Scan         Index" << std::endl;
+    std::cout << "Area query [ms]     " << std::setw(10) << area_ms[0] / n_queries << "    " << std::setw(10) << area_ms[1] / n_queries << std::endl;
+    std::cout << "Nearest lanelet [ms]" << std::setw(10) << nearest_ms[0] / n_queries << "    " << std::setw(10) << nearest_ms[1] / n_queries << std::endl;
+    std::cout << "Render frame [ms]   " << std::setw(10) << render_ms[0] / n_frames << "    " << std::setw(10) << render_ms[1] / n_frames << std::endl;
+
+    if (!equal)
+    {
+        std::cerr << "SpatialIndexBenchmark: Results of index and scan differ" << std::endl;
+        return 1;
+    }
+    return 0;
+}
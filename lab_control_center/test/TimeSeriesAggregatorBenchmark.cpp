@@ -0,0 +1,210 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+#include <time.h>
+#include <vector>
+
+#include "cpm/CommandLineReader.hpp"
+#include "cpm/init.hpp"
+#include "cpm/Logging.hpp"
+#include "cpm/get_time_ns.hpp"
+#include "TimeSeriesAggregator.hpp"
+
+/**
+ * \file TimeSeriesAggregatorBenchmark.cpp
+ * \brief Feeds VehicleState samples of 50 vehicles at 50 Hz into the TimeSeriesAggregator (directly, as the
+ * AsyncReader callback would) while a UI thread calls get_vehicle_data at 50 Hz and reads the poses, like MapViewUi.
+ * Measures the CPU time of the callback and the latency of get_vehicle_data, and compares with the previous
+ * layout (string-keyed nested maps, copied for every call). Run with --seconds=INT (default 10), --vehicles=INT (default 50).
+ * \ingroup lcc
+ */
+
+/**
+ * \brief CPU time of the calling thread in microseconds
+ * \ingroup lcc
+ */
+static double thread_cpu_time_us()
+{
+    timespec t;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &t);
+    return t.tv_sec * 1e6 + t.tv_nsec * 1e-3;
+}
+
+/**
+ * \brief Mean, median and max of measurements
+ * \ingroup lcc
+ */
+static void print_statistics(const string& label, vector<double> values)
+{
+    if (values.empty()) return;
+    std::sort(values.begin(), values.end());
+    double mean = 0;
+    for (double v : values) mean += v;
+    mean /= values.size();
+    cout << std::setw(48) << std::left << label << std::right << std::fixed << std::setprecision(2)
+        << " mean " << std::setw(9) << mean << " us | median " << std::setw(9) << values[values.size() / 2]
+        << " us | max " << std::setw(9) << values.back() << " us" << endl;
+}
+
+/**
+ * \brief The previous storage of the TimeSeriesAggregator, for comparison: vehicle ID -> key -> time series,
+ * filled with string lookups and copied for every reader
+ * \ingroup lcc
+ */
+class PreviousLayout
+{
+    //! Data
+    map<uint8_t, map<string, shared_ptr<TimeSeries>>> timeseries_vehicles;
+    //! As in TimeSeriesAggregator
+    std::mutex _mutex;
+
+public:
+    //! Stores the samples as the previous handle_new_vehicleState_samples did
+    void handle_new_vehicleState_samples(std::vector<VehicleState>& samples)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        const uint64_t now = cpm::get_time_ns();
+        for(auto& state : samples)
+        {
+            if(timeseries_vehicles.count(state.vehicle_id()) == 0)
+            {
+                for (size_t i = 0; i < vehicle_data_field_count; ++i)
+                {
+                    const string &key = vehicle_data_field_key(static_cast<VehicleDataField>(i));
+                    timeseries_vehicles[state.vehicle_id()][key] = make_shared<TimeSeries>(key, "%f", "-");
+                }
+            }
+            timeseries_vehicles[state.vehicle_id()]["pose_x"]                   ->push_sample(now, state.pose().x());
+            timeseries_vehicles[state.vehicle_id()]["pose_y"]                   ->push_sample(now, state.pose().y());
+            timeseries_vehicles[state.vehicle_id()]["pose_yaw"]                 ->push_sample(now, state.pose().yaw());
+            timeseries_vehicles[state.vehicle_id()]["speed"]                    ->push_sample(now, state.speed());
+            timeseries_vehicles[state.vehicle_id()]["battery_level"]            ->push_sample(now, state.battery_voltage());
+            timeseries_vehicles[state.vehicle_id()]["clock_delta"]              ->push_sample(now, double(int64_t(now)- int64_t(state.header().create_stamp().nanoseconds()))/1e6 );
+            timeseries_vehicles[state.vehicle_id()]["odometer_distance"]        ->push_sample(now, state.odometer_distance());
+            timeseries_vehicles[state.vehicle_id()]["imu_acceleration_forward"] ->push_sample(now, state.imu_acceleration_forward());
+            timeseries_vehicles[state.vehicle_id()]["imu_acceleration_left"]    ->push_sample(now, state.imu_acceleration_left());
+            timeseries_vehicles[state.vehicle_id()]["battery_voltage"]          ->push_sample(now, state.battery_voltage());
+            timeseries_vehicles[state.vehicle_id()]["motor_current"]            ->push_sample(now, state.motor_current());
+            timeseries_vehicles[state.vehicle_id()]["is_real"]                  ->push_sample(now, state.is_real());
+            timeseries_vehicles[state.vehicle_id()]["reference_deviation"]      ->push_sample(now, 0.0);
+            timeseries_vehicles[state.vehicle_id()]["ips_dt"]                   ->push_sample(now, static_cast<double>(1e-6*state.IPS_update_age_nanoseconds()));
+            timeseries_vehicles[state.vehicle_id()]["last_msg_state"]           ->push_sample(now, static_cast<double>(1e-6*now));
+        }
+    }
+
+    //! Copy, as the previous get_vehicle_data returned
+    map<uint8_t, map<string, shared_ptr<TimeSeries>>> get_vehicle_data()
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return timeseries_vehicles;
+    }
+};
+
+/**
+ * \brief Runs writer and UI thread for the given layout
+ * \param handle Callback with the samples of one period
+ * \param read_poses get_vehicle_data plus reading all poses, returns the number of vehicles
+ * \ingroup lcc
+ */
+template<typename Handle, typename ReadPoses>
+static void run(const string& label, int seconds, size_t n_vehicles, Handle handle, ReadPoses read_poses)
+{
+    const auto period = std::chrono::milliseconds(20);
+    std::atomic_bool running{true};
+    vector<double> callback_cpu_us;
+    vector<double> get_vehicle_data_us;
+
+    std::thread ui_thread([&](){
+        auto next = std::chrono::steady_clock::now();
+        while (running)
+        {
+            auto t0 = std::chrono::steady_clock::now();
+            read_poses();
+            auto t1 = std::chrono::steady_clock::now();
+            get_vehicle_data_us.push_back(std::chrono::duration<double, std::micro>(t1 - t0).count());
+
+            next += period;
+            std::this_thread::sleep_until(next);
+        }
+    });
+
+    vector<VehicleState> samples(n_vehicles);
+    auto next = std::chrono::steady_clock::now();
+    const int n_periods = seconds * 50;
+    for (int k = 0; k < n_periods; ++k)
+    {
+        const uint64_t now = cpm::get_time_ns();
+        for (size_t i = 0; i < n_vehicles; ++i)
+        {
+            VehicleState &state = samples[i];
+            state.vehicle_id(static_cast<uint8_t>(i + 1));
+            state.pose().x(0.1 * i + 0.001 * k);
+            state.pose().y(0.05 * k);
+            state.pose().yaw(0.01 * k);
+            state.speed(1.0);
+            state.battery_voltage(8.0);
+            state.is_real(false);
+            state.header().create_stamp().nanoseconds(now);
+        }
+
+        const double c0 = thread_cpu_time_us();
+        handle(samples);
+        const double c1 = thread_cpu_time_us();
+        callback_cpu_us.push_back(c1 - c0);
+
+        next += period;
+        std::this_thread::sleep_until(next);
+    }
+    running = false;
+    ui_thread.join();
+
+    cout << label << endl;
+    print_statistics("  callback CPU time (" + to_string(n_vehicles) + " VehicleStates)", callback_cpu_us);
+    print_statistics("  get_vehicle_data + read all poses", get_vehicle_data_us);
+}
+
+int main(int argc, char *argv[]) {
+    cpm::init(argc, argv);
+    cpm::Logging::Instance().set_id("TimeSeriesAggregatorBenchmark");
+    const int seconds = cpm::cmd_parameter_int("seconds", 10, argc, argv);
+    const size_t n_vehicles = static_cast<size_t>(std::min(cpm::cmd_parameter_int("vehicles", 50, argc, argv), 254));
+
+    {
+        TimeSeriesAggregator aggregator(static_cast<uint8_t>(n_vehicles + 1));
+        run("Enum-indexed slots, shared view", seconds, n_vehicles,
+            [&](vector<VehicleState>& samples){ aggregator.handle_new_vehicleState_samples(samples); },
+            [&](){
+                const VehicleData vehicle_data = aggregator.get_vehicle_data();
+                double sum = 0;
+                for (const auto& entry : vehicle_data)
+                {
+                    sum += entry.second.at(VehicleDataField::pose_x)->get_latest_value();
+                    sum += entry.second.at(VehicleDataField::pose_y)->get_latest_value();
+                    sum += entry.second.at(VehicleDataField::pose_yaw)->get_latest_value();
+                }
+                return sum;
+            });
+    }
+
+    {
+        PreviousLayout previous;
+        run("Previous layout: string-keyed maps, copied", seconds, n_vehicles,
+            [&](vector<VehicleState>& samples){ previous.handle_new_vehicleState_samples(samples); },
+            [&](){
+                const auto vehicle_data = previous.get_vehicle_data();
+                double sum = 0;
+                for (const auto& entry : vehicle_data)
+                {
+                    sum += entry.second.at("pose_x")->get_latest_value();
+                    sum += entry.second.at("pose_y")->get_latest_value();
+                    sum += entry.second.at("pose_yaw")->get_latest_value();
+                }
+                return sum;
+            });
+    }
+
+    return 0;
+}
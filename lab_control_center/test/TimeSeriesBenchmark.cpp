@@ -0,0 +1,119 @@
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "cpm/CommandLineReader.hpp"
+#include "TimeSeries.hpp"
+
+/**
+ * \file TimeSeriesBenchmark.cpp
+ * \brief Memory and throughput of the TimeSeries storage for a long experiment: 20 vehicles with
+ * 20 time series each receive samples at 50 Hz for --minutes=INT (default 60) minutes of simulated time.
+ * Compares with the previous unbounded storage (one std::vector for times and values each).
+ * \ingroup lcc
+ */
+
+/**
+ * \brief Resident memory of the process in bytes
+ * \ingroup lcc
+ */
+static size_t resident_memory()
+{
+    std::ifstream statm("/proc/self/statm");
+    size_t size = 0;
+    size_t resident = 0;
+    statm >> size >> resident;
+    return resident * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+}
+
+int main(int argc, char *argv[]) {
+    const int minutes = cpm::cmd_parameter_int("minutes", 60, argc, argv);
+    const size_t n_vehicles = 20;
+    const size_t n_series_per_vehicle = 20;
+    const uint64_t period = 20000000ull; // 50 Hz
+    const uint64_t n_steps = static_cast<uint64_t>(minutes) * 60 * 50;
+
+    const size_t memory_start = resident_memory();
+
+    vector<std::unique_ptr<TimeSeries>> series;
+    for (size_t i = 0; i < n_vehicles * n_series_per_vehicle; ++i)
+    {
+        series.emplace_back(new TimeSeries("benchmark_" + to_string(i), "%f", "-"));
+    }
+
+    // Writer as in TimeSeriesAggregator, one sample per series and step
+    auto t0 = std::chrono::steady_clock::now();
+    for (uint64_t step = 1; step <= n_steps; ++step)
+    {
+        const uint64_t time = step * period;
+        for (size_t i = 0; i < series.size(); ++i)
+        {
+            series[i]->push_sample(time, static_cast<double>(i) + 1e-3 * static_cast<double>(step % 1000));
+        }
+    }
+    auto t1 = std::chrono::steady_clock::now();
+
+    const size_t memory_end = resident_memory();
+    size_t storage_bytes = 0;
+    for (const auto &s : series) storage_bytes += s->get_memory_usage();
+
+    const double n_pushes = static_cast<double>(n_steps) * series.size();
+    const double push_seconds = std::chrono::duration<double>(t1 - t0).count();
+    cout << std::fixed << std::setprecision(1);
+    cout << series.size() << " time series, " << minutes << " min at 50 Hz (" << n_pushes * 1e-6 << " M samples)" << endl;
+    cout << "Bounded storage:    " << storage_bytes / 1e6 << " MB (resident +" << (memory_end - memory_start) / 1e6 << " MB), "
+        << n_pushes / push_seconds * 1e-6 << " M samples/s" << endl;
+    cout << "Unbounded vectors:  at least " << n_pushes * (sizeof(uint64_t) + sizeof(double)) / 1e6 << " MB" << endl;
+
+    // Previous storage, one series, for the push throughput
+    {
+        std::mutex mutex;
+        vector<uint64_t> times;
+        vector<double> values;
+        auto t2 = std::chrono::steady_clock::now();
+        for (uint64_t step = 1; step <= n_steps; ++step)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            times.push_back(step * period);
+            values.push_back(1e-3 * static_cast<double>(step % 1000));
+        }
+        auto t3 = std::chrono::steady_clock::now();
+        cout << "Unbounded vectors:  " << n_steps / std::chrono::duration<double>(t3 - t2).count() * 1e-6 << " M samples/s (one series)" << endl;
+    }
+
+    // Reads as in the UI (MapViewUi, MonitoringUi) while the writer is running at full speed
+    {
+        TimeSeries &s = *series.front();
+        std::atomic_bool running{true};
+        std::thread writer([&](){
+            uint64_t time = (n_steps + 1) * period;
+            while (running)
+            {
+                s.push_sample(time, 1.0);
+                time += period;
+            }
+        });
+
+        const int n_reads = 100000;
+        size_t n_values = 0;
+        auto t4 = std::chrono::steady_clock::now();
+        for (int r = 0; r < n_reads; ++r)
+        {
+            n_values += s.get_last_n_values(100).size();
+            n_values += s.get_downsampled(1, 100).size();
+        }
+        auto t5 = std::chrono::steady_clock::now();
+        running = false;
+        writer.join();
+
+        cout << std::setprecision(2) << "Read last 100 values + 100 buckets during writes: "
+            << std::chrono::duration<double, std::micro>(t5 - t4).count() / n_reads << " us (" << n_values / n_reads << " entries)" << endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,159 @@
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "cpm/CommandLineReader.hpp"
+#include "TimeSeries.hpp"
+
+/**
+ * \file TimeSeriesStressTest.cpp
+ * \brief Concurrency test of the TimeSeries storage: One writer pushes as fast as possible while several readers
+ * check that every copy they get is consistent (consecutive samples, buckets that match the samples).
+ * Values equal the sample times, so any torn or mixed copy is detected. Returns 1 on failure.
+ * Run with --seconds=INT (default 5), --readers=INT (default 4)
+ * \ingroup lcc
+ */
+
+/**
+ * \brief Checks a copy of the samples, reports the first error
+ * \param times Receive times
+ * \param values Values
+ * \param n Requested number of samples
+ * \param capacity Storage capacity
+ * \ingroup lcc
+ */
+static bool check_samples(const vector<uint64_t> &times, const vector<double> &values, size_t n, size_t capacity)
+{
+    if (times.size() != values.size() || times.size() > n || times.size() > capacity)
+    {
+        cerr << "Wrong number of samples: " << times.size() << endl;
+        return false;
+    }
+    for (size_t i = 0; i < times.size(); ++i)
+    {
+        // The initial sample of the constructor has time and value 0 as well
+        if (values[i] != static_cast<double>(times[i]))
+        {
+            cerr << "Torn sample: time " << times[i] << ", value " << values[i] << endl;
+            return false;
+        }
+        if (i > 0 && times[i] != times[i - 1] + 1)
+        {
+            cerr << "Samples not consecutive: " << times[i - 1] << ", " << times[i] << endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * \brief Checks a copy of the buckets of a level, each has span samples, see check_samples
+ * \ingroup lcc
+ */
+static bool check_buckets(const vector<TimeSeriesBucket> &buckets, uint64_t span)
+{
+    for (size_t i = 0; i < buckets.size(); ++i)
+    {
+        const TimeSeriesBucket &b = buckets[i];
+        const bool ok =
+            b.time_last == b.time_first + span - 1 &&
+            (b.time_first - 1) % span == 0 && // samples start at time 1
+            b.min == static_cast<double>(b.time_first) &&
+            b.max == static_cast<double>(b.time_last) &&
+            b.mean == 0.5 * static_cast<double>(b.time_first + b.time_last) &&
+            (i == 0 || b.time_first == buckets[i - 1].time_last + 1);
+        if (!ok)
+        {
+            cerr << "Inconsistent bucket: " << b.time_first << " - " << b.time_last << ", min " << b.min
+                << ", max " << b.max << ", mean " << b.mean << endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char *argv[]) {
+    const int seconds = cpm::cmd_parameter_int("seconds", 5, argc, argv);
+    const int n_readers = cpm::cmd_parameter_int("readers", 4, argc, argv);
+
+    // Small storage, so that the writer wraps around often
+    TimeSeriesStorage storage;
+    storage.capacity = 256;
+    storage.bucket_factor = 4;
+    storage.bucket_capacity = 64;
+    storage.levels = 3;
+    TimeSeries timeseries("stress", "%f", "-", storage);
+
+    std::atomic_bool running{true};
+    std::atomic_bool failed{false};
+    std::atomic<uint64_t> n_reads{0};
+
+    std::thread writer([&](){
+        uint64_t time = 1;
+        while (running)
+        {
+            timeseries.push_sample(time, static_cast<double>(time));
+            ++time;
+        }
+    });
+
+    std::vector<std::thread> readers;
+    for (int r = 0; r < n_readers; ++r)
+    {
+        readers.emplace_back([&, r](){
+            vector<uint64_t> times;
+            vector<double> values;
+            uint64_t i = r;
+            while (running && !failed)
+            {
+                // Alternate between small, large and full-capacity reads
+                const size_t n = (i % 3 == 0) ? 1 : ((i % 3 == 1) ? 100 : storage.capacity);
+                timeseries.get_last_n_samples(n, times, values);
+                if (!check_samples(times, values, n, storage.capacity)) failed = true;
+
+                const vector<double> last_values = timeseries.get_last_n_values(n);
+                for (size_t j = 1; j < last_values.size(); ++j)
+                {
+                    if (last_values[j] != last_values[j - 1] + 1)
+                    {
+                        cerr << "Values not consecutive" << endl;
+                        failed = true;
+                    }
+                }
+
+                uint64_t span = storage.bucket_factor;
+                for (size_t level = 0; level < timeseries.get_downsampled_levels(); ++level)
+                {
+                    if (!check_buckets(timeseries.get_downsampled(level, storage.bucket_capacity), span)) failed = true;
+                    span *= storage.bucket_factor;
+                }
+
+                // Time and value are read separately, but each must belong to a complete sample
+                const double latest_value = timeseries.get_latest_value();
+                if (latest_value != static_cast<double>(static_cast<uint64_t>(latest_value))) failed = true;
+
+                ++i;
+                ++n_reads;
+            }
+        });
+    }
+
+    std::this_thread::sleep_for(std::chrono::seconds(seconds));
+    running = false;
+    writer.join();
+    for (auto &reader : readers) reader.join();
+
+    cout << "Samples written: " << timeseries.get_sample_count()
+        << ", consistent reads: " << n_reads.load() << endl;
+
+    if (failed || n_reads == 0)
+    {
+        cerr << "TimeSeriesStressTest failed" << endl;
+        return 1;
+    }
+
+    cout << "TimeSeriesStressTest passed" << endl;
+    return 0;
+}
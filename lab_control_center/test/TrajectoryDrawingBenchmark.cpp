@@ -0,0 +1,262 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+
+#include "cpm/CommandLineReader.hpp"
+#include "TrajectoryInterpolation.hpp"
+#include "ui/map_view/TrajectoryDrawingCache.hpp"
+
+/**
+ * \file TrajectoryDrawingBenchmark.cpp
+ * \brief Offscreen benchmark of drawing received trajectory commands and past trajectories in the map view: Renders
+ * --vehicles=INT (default 30) trajectory commands with --points=INT (default 200) points each and the past trajectories
+ * of the vehicles to a Cairo image surface. Compares the previous drawing (Hermite interpolation of every segment in every
+ * frame, copy of the last 100 poses from the time series in every frame) with the TrajectoryDrawingCache. A new command is
+ * received every --command_period=INT (default 20) frames, i.e. at 2.5 Hz for a map view redrawn every 20 ms, and every
+ * vehicle sends --poses_per_frame=INT (default 2) new poses in each frame, received in one batch. Options: --frames=INT (default 200), --width=INT and --height=INT (default 1920 x 1080).
+ * Returns 1 if the tessellation of the cache differs from the previous interpolation or the cached past trajectory
+ * differs from the last poses of the time series.
+ * \ingroup lcc_ui
+ */
+
+/**
+ * \brief Trajectory command of vehicle v on a circle around the lab center, received at time t_command
+ * \ingroup lcc_ui
+ */
+static VehicleCommandTrajectory make_command(int v, int n_points, uint64_t t_command)
+{
+    const double radius = 0.4 + 0.05 * v;
+    const double omega = 0.2;
+    const uint64_t dt = 100000000ull;
+
+    rti::core::vector<TrajectoryPoint> trajectory_points;
+    for (int i = 0; i < n_points; ++i)
+    {
+        const uint64_t t = t_command + i * dt;
+        const double phi = omega * 1e-9 * static_cast<double>(t % 1000000000000ull) + v;
+        trajectory_points.push_back(TrajectoryPoint(TimeStamp(t),
+            2.25 + radius * std::cos(phi), 2.0 + radius * std::sin(phi),
+            -radius * omega * std::sin(phi), radius * omega * std::cos(phi)));
+    }
+
+    VehicleCommandTrajectory command;
+    command.vehicle_id(static_cast<uint8_t>(v + 1));
+    command.header(Header(TimeStamp(t_command), TimeStamp(t_command)));
+    command.trajectory_points(trajectory_points);
+    return command;
+}
+
+/**
+ * \brief Previous MapViewUi::draw_received_trajectory_commands for one command: Interpolation and one stroke per step
+ * \ingroup lcc_ui
+ */
+static void draw_trajectory_previous(const DrawingContext& ctx, const VehicleCommandTrajectory& trajectory, uint64_t t_now)
+{
+    rti::core::vector<TrajectoryPoint> trajectory_segment = trajectory.trajectory_points();
+
+    ctx->save();
+    ctx->set_line_width(0.01);
+    for (size_t i = 1; i < trajectory_segment.size(); ++i)
+    {
+        const int n_interp = 20;
+
+        ctx->begin_new_path();
+        ctx->move_to(trajectory_segment[i-1].px(), trajectory_segment[i-1].py());
+        for (int interp_step = 1; interp_step <= n_interp; ++interp_step)
+        {
+            const uint64_t delta_t = trajectory_segment[i].t().nanoseconds() - trajectory_segment[i-1].t().nanoseconds();
+            const uint64_t t_cur = (delta_t * interp_step) / n_interp + trajectory_segment[i-1].t().nanoseconds();
+
+            TrajectoryInterpolation interp(t_cur, trajectory_segment[i-1], trajectory_segment[i]);
+            ctx->line_to(interp.position_x, interp.position_y);
+
+            if (t_cur < t_now) ctx->set_source_rgb(0.7,0.7,0.7);
+            else ctx->set_source_rgb(0,0,0.8);
+
+            ctx->stroke();
+            ctx->move_to(interp.position_x, interp.position_y);
+        }
+    }
+
+    ctx->begin_new_path();
+    for (size_t i = 0; i < trajectory_segment.size(); ++i)
+    {
+        if (trajectory_segment.at(i).t().nanoseconds() < t_now) ctx->set_source_rgb(0.7,0.7,0.7);
+        else ctx->set_source_rgb(0,0,0.8);
+
+        ctx->arc(trajectory_segment[i].px(), trajectory_segment[i].py(), 0.02, 0.0, 2 * M_PI);
+        ctx->fill();
+    }
+    ctx->restore();
+}
+
+/**
+ * \brief Previous MapViewUi::draw_vehicle_past_trajectory
+ * \ingroup lcc_ui
+ */
+static void draw_past_trajectory_previous(const DrawingContext& ctx, const VehicleTimeSeries& vehicle_timeseries)
+{
+    vector<double> trajectory_x = vehicle_timeseries.at(VehicleDataField::pose_x)->get_last_n_values(100);
+    vector<double> trajectory_y = vehicle_timeseries.at(VehicleDataField::pose_y)->get_last_n_values(100);
+    for (size_t i = 1; i < trajectory_x.size(); ++i)
+    {
+        if(i == 1) ctx->move_to(trajectory_x[i], trajectory_y[i]);
+        else ctx->line_to(trajectory_x[i], trajectory_y[i]);
+    }
+    ctx->set_source_rgb(1,0,0);
+    ctx->set_line_width(0.01);
+    ctx->stroke();
+}
+
+/**
+ * \brief Checks the cached tessellation against the interpolation of the previous drawing
+ * \ingroup lcc_ui
+ */
+static bool tessellation_matches(const TrajectoryDrawingCache::Tessellation& tessellation, const VehicleCommandTrajectory& command)
+{
+    const auto& points = command.trajectory_points();
+    const size_t steps = TrajectoryDrawingCache::n_interpolation_steps;
+    if (tessellation.vertices.size() != (points.size() - 1) * (steps + 1)) return false;
+    if (tessellation.points.size() != points.size()) return false;
+
+    size_t k = 0;
+    for (size_t i = 1; i < points.size(); ++i)
+    {
+        const auto& start = tessellation.vertices[k++];
+        if (!start.starts_segment || start.x != points[i-1].px() || start.y != points[i-1].py()) return false;
+
+        const uint64_t delta_t = points[i].t().nanoseconds() - points[i-1].t().nanoseconds();
+        for (size_t step = 1; step <= steps; ++step)
+        {
+            const uint64_t t_cur = (delta_t * step) / steps + points[i-1].t().nanoseconds();
+            TrajectoryInterpolation interp(t_cur, points[i-1], points[i]);
+            const auto& vertex = tessellation.vertices[k++];
+            if (vertex.starts_segment || vertex.t != t_cur || vertex.x != interp.position_x || vertex.y != interp.position_y) return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char *argv[]) {
+    const int n_vehicles = cpm::cmd_parameter_int("vehicles", 30, argc, argv);
+    const int n_points = cpm::cmd_parameter_int("points", 200, argc, argv);
+    const int command_period = std::max(1, cpm::cmd_parameter_int("command_period", 20, argc, argv));
+    const int frames = cpm::cmd_parameter_int("frames", 200, argc, argv);
+    const int width = cpm::cmd_parameter_int("width", 1920, argc, argv);
+    const int height = cpm::cmd_parameter_int("height", 1080, argc, argv);
+    const int poses_per_frame = std::max(1, cpm::cmd_parameter_int("poses_per_frame", 2, argc, argv));
+
+    auto surface = Cairo::ImageSurface::create(Cairo::FORMAT_ARGB32, width, height);
+    auto ctx = Cairo::Context::create(surface);
+
+    // View as in MapViewUi: lab centered, y axis up
+    const double zoom = std::min(width, height) / 5.0;
+    auto begin_frame = [&]() {
+        ctx->save();
+        ctx->set_source_rgb(1, 1, 1);
+        ctx->paint();
+        ctx->restore();
+        ctx->save();
+        ctx->translate(width / 2.0 - 2.25 * zoom, height / 2.0 + 2.0 * zoom);
+        ctx->scale(zoom, -zoom);
+    };
+
+    // Emulated time: 20 ms per frame, poses received every frame
+    const uint64_t t_start = 1600000000000000000ull;
+    const uint64_t frame_period = 20000000ull;
+    vector<VehicleTimeSeries> vehicle_timeseries;
+    for (int v = 0; v < n_vehicles; ++v) vehicle_timeseries.push_back(VehicleTimeSeries::create());
+
+    vector<VehicleCommandTrajectory> commands(n_vehicles);
+    auto receive = [&](int frame) {
+        const uint64_t t_now = t_start + frame * frame_period;
+        for (int v = 0; v < n_vehicles; ++v)
+        {
+            if (frame % command_period == 0) commands[v] = make_command(v, n_points, t_now - 500000000ull);
+            // Poses received in one batch share the receive time, as in TimeSeriesAggregator
+            for (int k = 0; k < poses_per_frame; ++k)
+            {
+                const double phi = 0.2e-9 * static_cast<double>(t_now % 1000000000000ull) + v + 0.001 * k;
+                vehicle_timeseries[v].at(VehicleDataField::pose_x)->push_sample(t_now, 2.25 + (0.4 + 0.05 * v) * std::cos(phi));
+                vehicle_timeseries[v].at(VehicleDataField::pose_y)->push_sample(t_now, 2.0 + (0.4 + 0.05 * v) * std::sin(phi));
+            }
+        }
+        return t_now;
+    };
+
+    // Receiving data is not measured. The emulated time continues across the measurements.
+    int received_frames = 0;
+    auto measure = [&](const string& label, std::function<void(uint64_t)> draw_frame) {
+        double drawing_ms = 0;
+        for (int frame = 0; frame < frames; ++frame)
+        {
+            const uint64_t t_now = receive(received_frames++);
+            auto t0 = std::chrono::steady_clock::now();
+            begin_frame();
+            draw_frame(t_now);
+            ctx->restore();
+            surface->flush();
+            auto t1 = std::chrono::steady_clock::now();
+            drawing_ms += std::chrono::duration<double, std::milli>(t1 - t0).count();
+        }
+        const double ms = drawing_ms / frames;
+        cout << std::setw(44) << std::left << label << std::right << std::fixed << std::setprecision(2)
+            << std::setw(8) << ms << " ms/frame (" << std::setprecision(0) << 1000.0 / ms << " fps max)" << endl;
+    };
+
+    cout << n_vehicles << " vehicles, " << n_points << " trajectory points, new command every " << command_period
+        << " frames, " << width << " x " << height << ", " << frames << " frames" << endl;
+
+    measure("Previous: interpolation every frame", [&](uint64_t t_now) {
+        for (int v = 0; v < n_vehicles; ++v)
+        {
+            draw_trajectory_previous(ctx, commands[v], t_now);
+            draw_past_trajectory_previous(ctx, vehicle_timeseries[v]);
+        }
+    });
+
+    TrajectoryDrawingCache cache;
+    bool matches = true;
+    measure("TrajectoryDrawingCache", [&](uint64_t t_now) {
+        for (int v = 0; v < n_vehicles; ++v)
+        {
+            const auto& tessellation = cache.get_trajectory(static_cast<uint8_t>(v + 1), commands[v]);
+            TrajectoryDrawingCache::draw_trajectory(ctx, tessellation, t_now);
+            TrajectoryDrawingCache::draw_past_trajectory(ctx, cache.get_past_trajectory(static_cast<uint8_t>(v + 1), vehicle_timeseries[v]));
+        }
+        cache.end_frame();
+    });
+    cout << "  " << cache.get_tessellation_count() << " commands tessellated" << endl;
+
+    // Only the geometry, without rasterization
+    measure("TrajectoryDrawingCache, lookup only", [&](uint64_t) {
+        for (int v = 0; v < n_vehicles; ++v)
+        {
+            cache.get_trajectory(static_cast<uint8_t>(v + 1), commands[v]);
+            cache.get_past_trajectory(static_cast<uint8_t>(v + 1), vehicle_timeseries[v]);
+        }
+        cache.end_frame();
+    });
+
+    for (int v = 0; v < n_vehicles; ++v)
+    {
+        matches = matches && tessellation_matches(cache.get_trajectory(static_cast<uint8_t>(v + 1), commands[v]), commands[v]);
+
+        const auto& past = cache.get_past_trajectory(static_cast<uint8_t>(v + 1), vehicle_timeseries[v]);
+        vector<double> expected_x = vehicle_timeseries[v].at(VehicleDataField::pose_x)->get_last_n_values(TrajectoryDrawingCache::past_trajectory_length);
+        vector<double> expected_y = vehicle_timeseries[v].at(VehicleDataField::pose_y)->get_last_n_values(TrajectoryDrawingCache::past_trajectory_length);
+        matches = matches && past.x == expected_x && past.y == expected_y;
+    }
+
+    surface->write_to_png("TrajectoryDrawingBenchmark.png");
+
+    if (!matches)
+    {
+        cerr << "TrajectoryDrawingBenchmark: cached geometry differs from the previous interpolation" << endl;
+        return 1;
+    }
+    return 0;
+}
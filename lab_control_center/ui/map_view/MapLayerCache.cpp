@@ -0,0 +1,75 @@
+#include "MapLayerCache.hpp"
+
+/**
+ * \file MapLayerCache.cpp
+ * \ingroup lcc_ui
+ */
+
+bool MapLayerCache::Key::operator==(const Key& other) const
+{
+    return width == other.width
+        && height == other.height
+        && pan_x == other.pan_x
+        && pan_y == other.pan_y
+        && zoom == other.zoom
+        && rotation == other.rotation
+        && content_revision == other.content_revision
+        && content_flags == other.content_flags;
+}
+
+bool MapLayerCache::Key::operator!=(const Key& other) const
+{
+    return !(*this == other);
+}
+
+bool MapLayerCache::is_valid_for(const Key& _key) const
+{
+    return valid && surface && key == _key;
+}
+
+void MapLayerCache::invalidate()
+{
+    valid = false;
+}
+
+void MapLayerCache::paint(const DrawingContext& ctx, const Key& _key, const std::function<void(const DrawingContext&)>& draw_layer)
+{
+    if (_key.width <= 0 || _key.height <= 0)
+    {
+        return;
+    }
+
+    if (!is_valid_for(_key))
+    {
+        //Re-use the surface if the size did not change, else create a new one that matches the target (device scale, format)
+        if (!surface || key.width != _key.width || key.height != _key.height)
+        {
+            surface = Cairo::Surface::create(ctx->get_target(), Cairo::CONTENT_COLOR_ALPHA, _key.width, _key.height);
+        }
+
+        auto layer_ctx = Cairo::Context::create(surface);
+
+        //Clear old content
+        layer_ctx->save();
+        layer_ctx->set_operator(Cairo::OPERATOR_CLEAR);
+        layer_ctx->paint();
+        layer_ctx->restore();
+
+        draw_layer(layer_ctx);
+        surface->flush();
+
+        key = _key;
+        valid = true;
+        ++render_count;
+    }
+
+    ctx->save();
+    ctx->set_source(surface, 0, 0);
+    ctx->paint();
+    ctx->restore();
+}
+
+uint64_t MapLayerCache::get_render_count() const
+{
+    return render_count;
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include "defaults.hpp"
+#include "commonroad_classes/InterfaceDraw.hpp"
+
+/**
+ * \class MapLayerCache
+ * \brief Caches a layer of the map view that rarely changes (e.g. the CommonRoad lanelets, the lab boundaries) in an
+ * offscreen Cairo surface of the size of the view. The layer is only drawn again when its Key changes, i.e. when the
+ * view is zoomed, panned, rotated or resized, or when the content (e.g. the scenario) changed. Otherwise, painting the
+ * layer is a single copy of the surface.
+ * \ingroup lcc_ui
+ */
+class MapLayerCache
+{
+public:
+    /**
+     * \struct Key
+     * \brief Everything the content of the cached layer depends on
+     */
+    struct Key
+    {
+        //! Width of the view in pixels
+        int width = 0;
+        //! Height of the view in pixels
+        int height = 0;
+        //! View translation in x direction
+        double pan_x = 0;
+        //! View translation in y direction
+        double pan_y = 0;
+        //! View scale
+        double zoom = 0;
+        //! View rotation
+        double rotation = 0;
+        //! Changes whenever the content of the layer changes, e.g. when a new scenario was loaded
+        uint64_t content_revision = 0;
+        //! Draw options of the content, e.g. which optional parts are shown
+        uint64_t content_flags = 0;
+
+        /**
+         * \brief Equal if all members are equal
+         * \param other Key to compare with
+         */
+        bool operator==(const Key& other) const;
+
+        /**
+         * \brief Not equal if any member differs
+         * \param other Key to compare with
+         */
+        bool operator!=(const Key& other) const;
+    };
+
+private:
+    //! The rendered layer, nullptr if not yet rendered
+    Cairo::RefPtr<Cairo::Surface> surface;
+    //! Key of the rendered layer
+    Key key;
+    //! False if the layer must be rendered again in any case
+    bool valid = false;
+    //! How often the layer was rendered, for statistics
+    uint64_t render_count = 0;
+
+public:
+    /**
+     * \brief Whether paint would use the cached layer for this key (without rendering it again)
+     * \param _key Current key
+     */
+    bool is_valid_for(const Key& _key) const;
+
+    /**
+     * \brief Render the layer again on the next call of paint
+     */
+    void invalidate();
+
+    /**
+     * \brief Paints the layer on the context at (0, 0) in the current user coordinates of ctx (the widget coordinates).
+     * Calls draw_layer first if the cached layer is invalid for the key. draw_layer gets a context to a new surface
+     * that is similar to the target of ctx (same device scale), with the identity transformation; it must apply the
+     * view transformation itself.
+     * \param ctx Context to paint on, e.g. the one of the map view
+     * \param _key Current key
+     * \param draw_layer Draws the layer in widget coordinates
+     */
+    void paint(const DrawingContext& ctx, const Key& _key, const std::function<void(const DrawingContext&)>& draw_layer);
+
+    /**
+     * \brief How often the layer was rendered since construction
+     */
+    uint64_t get_render_count() const;
+};
@@ -4,12 +4,6 @@
 #include <libxml++-2.6/libxml++/libxml++.h>
 #include <math.h>
 
-#include "TrajectoryInterpolation.hpp"
-#include "TrajectoryInterpolation.cxx"
-
-#include "PathInterpolation.hpp"
-#include "PathInterpolation.cxx"
-
 #include <stdio.h>
 
 /**
@@ -48,16 +42,7 @@ MapViewUi::MapViewUi(
     //image_arrow = Cairo::ImageSurface::create_from_png("ui/map_view/arrow.png");
     image_labcam = Cairo::ImageSurface::create_from_png("ui/map_view/labcam.png");
     
-    update_dispatcher.connect([&](){ 
-        //Pan depending on key press
-        if (key_up) pan_y += key_move;
-        if (key_down) pan_y -= key_move;
-        if (key_left) pan_x += key_move;
-        if (key_right) pan_x -= key_move;
-
-        vehicle_data = this->get_vehicle_data();
-        drawingArea->queue_draw(); 
-    });
+    update_dispatcher.connect([&](){ update(); });
 
     run_draw_thread.store(true);
     draw_loop_thread = std::thread([&](){
@@ -116,6 +101,7 @@ MapViewUi::MapViewUi(
 
         //std::cout << pan_x << " " << pan_y << " " << zoom << std::endl;
 
+        redraw_requested = true;
         return true; 
     });
 
@@ -129,6 +115,7 @@ MapViewUi::MapViewUi(
             if (event->keyval == GDK_KEY_Left) key_left = true;
             if (event->keyval == GDK_KEY_Right) key_right = true;
 
+            redraw_requested = true;
             if (key_up || key_down || key_left || key_right) return true; //Signal was handled
         }
         return false; //Propagate signal
@@ -164,9 +151,9 @@ MapViewUi::MapViewUi(
                 auto& vehicle_timeseries = vehicle_data.at(path_painting_in_progress_vehicle_id);
 
                 Pose2D pose;
-                pose.x(vehicle_timeseries.at("pose_x")->get_latest_value());
-                pose.y(vehicle_timeseries.at("pose_y")->get_latest_value());
-                pose.yaw(vehicle_timeseries.at("pose_yaw")->get_latest_value());
+                pose.x(vehicle_timeseries.at(VehicleDataField::pose_x)->get_latest_value());
+                pose.y(vehicle_timeseries.at(VehicleDataField::pose_y)->get_latest_value());
+                pose.yaw(vehicle_timeseries.at(VehicleDataField::pose_yaw)->get_latest_value());
                 path_painting_in_progress.push_back(pose);
             }
         }
@@ -179,6 +166,7 @@ MapViewUi::MapViewUi(
             old_event_y = event->y;
         }
 
+        redraw_requested = true;
         return true;
     });
 
@@ -197,6 +185,8 @@ MapViewUi::MapViewUi(
             path_painting_in_progress.clear();
             path_painting_in_progress_vehicle_id = -1;
         }
+
+        redraw_requested = true;
         return true;
     });
 
@@ -270,6 +260,7 @@ MapViewUi::MapViewUi(
             old_event_y = event->y;
         }
 
+        redraw_requested = true;
         return true;
     });
 
@@ -335,10 +326,10 @@ int MapViewUi::find_vehicle_id_in_focus()
         const auto vehicle_id = entry.first;
         const auto& vehicle_timeseries = entry.second;
 
-        if(!vehicle_timeseries.at("pose_x")->has_new_data(1.0)) continue;
+        if(!vehicle_timeseries.at(VehicleDataField::pose_x)->has_new_data(1.0)) continue;
 
-        double dx = mouse_x - vehicle_timeseries.at("pose_x")->get_latest_value();
-        double dy = mouse_y - vehicle_timeseries.at("pose_y")->get_latest_value();
+        double dx = mouse_x - vehicle_timeseries.at(VehicleDataField::pose_x)->get_latest_value();
+        double dy = mouse_y - vehicle_timeseries.at(VehicleDataField::pose_y)->get_latest_value();
 
         double dist_sq = dx*dx + dy*dy;
         if(dist_sq < 0.04 && dist_sq < dist_sq_min)
@@ -350,18 +341,89 @@ int MapViewUi::find_vehicle_id_in_focus()
     return id;
 }
 
-void MapViewUi::draw(const DrawingContext& ctx)
+void MapViewUi::update()
+{
+    //Pan depending on key press
+    if (key_up) pan_y += key_move;
+    if (key_down) pan_y -= key_move;
+    if (key_left) pan_x += key_move;
+    if (key_right) pan_x -= key_move;
+    if (key_up || key_down || key_left || key_right) redraw_requested = true;
+
+    vehicle_data = this->get_vehicle_data();
+
+    //Redraw when new vehicle data arrived
+    uint64_t vehicle_data_time = 0;
+    for(const auto& entry : vehicle_data) {
+        vehicle_data_time = std::max(vehicle_data_time, entry.second.at(VehicleDataField::pose_x)->get_latest_time());
+    }
+    if (vehicle_data_time != latest_vehicle_data_time)
+    {
+        latest_vehicle_data_time = vehicle_data_time;
+        redraw_requested = true;
+    }
+
+    //Redraw when the scenario or its draw configuration changed, and while the view is centered initially (see signal_draw)
+    if (!static_layer_cache.is_valid_for(get_static_layer_key()) || map_tick >= 0)
+    {
+        redraw_requested = true;
+    }
+
+    ++ticks_since_redraw;
+    if (redraw_requested || time_dependent_content_drawn || ticks_since_redraw >= idle_redraw_ticks)
+    {
+        redraw_requested = false;
+        ticks_since_redraw = 0;
+        drawingArea->queue_draw();
+    }
+}
+
+void MapViewUi::apply_view_transform(const DrawingContext& ctx)
+{
+    // transforming (*)
+    ctx->translate(pan_x, pan_y);
+    ctx->scale(zoom, -zoom);
+    
+    // rotate mapview without changing the center of the map
+    ctx->translate(rotation_fixpoint_x,rotation_fixpoint_y);
+    ctx->rotate(rotation);
+    ctx->translate(-rotation_fixpoint_x,-rotation_fixpoint_y);
+}
+
+MapLayerCache::Key MapViewUi::get_static_layer_key()
+{
+    MapLayerCache::Key key;
+    key.width = drawingArea->get_width();
+    key.height = drawingArea->get_height();
+    key.pan_x = pan_x;
+    key.pan_y = pan_y;
+    key.zoom = zoom;
+    key.rotation = rotation;
+
+    if (commonroad_scenario)
+    {
+        key.content_revision = commonroad_scenario->get_revision();
+
+        //Options of the draw configuration that are used when drawing the scenario
+        auto draw_configuration = commonroad_scenario->get_draw_configuration();
+        assert(draw_configuration);
+        key.content_flags = 
+            (draw_configuration->draw_traffic_signs.load() ? 1 : 0)
+            | (draw_configuration->draw_traffic_lights.load() ? 2 : 0)
+            | (draw_configuration->draw_lanelet_id.load() ? 4 : 0)
+            | (draw_configuration->draw_lanelet_orientation.load() ? 8 : 0)
+            | (draw_configuration->draw_goal_description.load() ? 16 : 0)
+            | (draw_configuration->draw_init_state.load() ? 32 : 0);
+    }
+
+    return key;
+}
+
+void MapViewUi::draw_static_layers(const DrawingContext& ctx)
 {
     ctx->save();
-    {   
-        // transforming (*)
-        ctx->translate(pan_x, pan_y);
-        ctx->scale(zoom, -zoom);
-        
-        // rotate mapview without changing the center of the map
-        ctx->translate(rotation_fixpoint_x,rotation_fixpoint_y);
-        ctx->rotate(rotation);
-        ctx->translate(-rotation_fixpoint_x,-rotation_fixpoint_y);       
+    {
+        apply_view_transform(ctx);
 
         //draw_grid(ctx);
         //Draw map
@@ -370,53 +432,75 @@ void MapViewUi::draw(const DrawingContext& ctx)
             commonroad_scenario->draw(ctx);
         }
 
+        draw_lab_boundaries(ctx);
+
+        draw_labcam(ctx);
+    }
+    ctx->restore();
+}
+
+void MapViewUi::draw(const DrawingContext& ctx)
+{
+    //Static layers are only drawn again if the view or the scenario changed, else the cached surface is used
+    static_layer_cache.paint(ctx, get_static_layer_key(), [&](const DrawingContext& layer_ctx) {
+        draw_static_layers(layer_ctx);
+    });
+
+    bool time_dependent_content = false;
+
+    ctx->save();
+    {   
+        apply_view_transform(ctx);
+
         // Draw vehicle focus disk
-        if(vehicle_id_in_focus >= 0 && path_painting_in_progress_vehicle_id < 0)
+        if(vehicle_id_in_focus >= 0 && path_painting_in_progress_vehicle_id < 0 && vehicle_data.count(vehicle_id_in_focus) > 0)
         {
             ctx->set_source_rgba(0,0,1,0.4);
             ctx->arc(
-                vehicle_data.at(vehicle_id_in_focus).at("pose_x")->get_latest_value(),
-                vehicle_data.at(vehicle_id_in_focus).at("pose_y")->get_latest_value(),
+                vehicle_data.at(vehicle_id_in_focus).at(VehicleDataField::pose_x)->get_latest_value(),
+                vehicle_data.at(vehicle_id_in_focus).at(VehicleDataField::pose_y)->get_latest_value(),
                 0.2, 0.0, 2 * M_PI
             );
             ctx->fill();
         }
 
-        draw_lab_boundaries(ctx);
-
-        draw_labcam(ctx);
-
-        draw_received_trajectory_commands(ctx);
+        time_dependent_content |= draw_received_trajectory_commands(ctx);
 
-        draw_received_path_tracking_commands(ctx);
+        time_dependent_content |= draw_received_path_tracking_commands(ctx);
 
         for(const auto& entry : vehicle_data) {
-            //const auto vehicle_id = entry.first;
+            const auto vehicle_id = entry.first;
             const auto& vehicle_timeseries = entry.second;
 
-            if(vehicle_timeseries.at("pose_x")->has_new_data(1.0))
+            if(vehicle_timeseries.at(VehicleDataField::pose_x)->has_new_data(1.0))
             {
-                draw_vehicle_past_trajectory(ctx, vehicle_timeseries);
+                draw_vehicle_past_trajectory(ctx, vehicle_timeseries, vehicle_id);
             }
         }
 
-        draw_received_visualization_commands(ctx);
+        time_dependent_content |= draw_received_visualization_commands(ctx);
 
-        draw_commonroad_obstacles(ctx);
+        time_dependent_content |= draw_commonroad_obstacles(ctx);
 
         draw_path_painting(ctx);
+        time_dependent_content |= (path_painting_in_progress.size() > 1);
 
         for(const auto& entry : vehicle_data) {
             const auto vehicle_id = entry.first;
             const auto& vehicle_timeseries = entry.second;
 
-            if(vehicle_timeseries.at("pose_x")->has_new_data(1.0))
+            if(vehicle_timeseries.at(VehicleDataField::pose_x)->has_new_data(1.0))
             {
                 draw_vehicle_body(ctx, vehicle_timeseries, vehicle_id);
             }
         }
     }
     ctx->restore();
+
+    //Forget the cached geometry of vehicles that were not drawn, e.g. because their commands are outdated
+    trajectory_drawing_cache.end_frame();
+
+    time_dependent_content_drawn = time_dependent_content;
 }
 
 void MapViewUi::draw_lab_boundaries(const DrawingContext& ctx)
@@ -455,165 +539,46 @@ void MapViewUi::draw_lab_boundaries(const DrawingContext& ctx)
     ctx->restore();
 }
 
-void MapViewUi::draw_received_trajectory_commands(const DrawingContext& ctx)
+bool MapViewUi::draw_received_trajectory_commands(const DrawingContext& ctx)
 {
     VehicleTrajectories vehicleTrajectories = get_vehicle_trajectory_command_callback();
+    bool drawn = false;
+
+    uint64_t t_now = cpm::get_time_ns();
 
-    ctx->save();
     for(const auto& entry : vehicleTrajectories) 
     {
-        //const auto vehicle_id = entry.first;
+        const auto vehicle_id = entry.first;
         const auto& trajectory = entry.second;
 
-        rti::core::vector<TrajectoryPoint> trajectory_segment = trajectory.trajectory_points();
-        
-        if(trajectory_segment.size() < 2 ) continue;
-        
-        uint64_t t_now = cpm::get_time_ns();
-
-        ctx->set_line_width(0.01);
-
-        // Draw trajectory interpolation - use other color for already invalid parts (timestamp older than current point in time)
-        // start from 1 because of i-1
-        for (size_t i = 1; i < trajectory_segment.size(); ++i)
-        {
-            const int n_interp = 20;
-            
-            ctx->begin_new_path();
-            ctx->move_to(trajectory_segment[i-1].px(),
-                         trajectory_segment[i-1].py()
-            );   
-            for (int interp_step = 1; interp_step <= n_interp; ++interp_step)
-            {
-                const uint64_t delta_t = 
-                        trajectory_segment[i].t().nanoseconds() 
-                    - trajectory_segment[i-1].t().nanoseconds();
-
-                const uint64_t t_cur = (delta_t * interp_step) / n_interp + trajectory_segment[i-1].t().nanoseconds();
+        if(trajectory.trajectory_points().size() < 2 ) continue;
+        drawn = true;
 
-                TrajectoryInterpolation interp(
-                    t_cur,
-                    trajectory_segment[i-1],  
-                    trajectory_segment[i]
-                );
-                
-                ctx->line_to(interp.position_x,
-                             interp.position_y
-                );
-
-                if (t_cur < t_now)
-                {
-                    //Color for past segments
-                    ctx->set_source_rgb(0.7,0.7,0.7);
-                }
-                else
-                {
-                    //Color for current and future segments
-                    ctx->set_source_rgb(0,0,0.8);
-                }
-
-                ctx->stroke();
-                ctx->move_to(interp.position_x,
-                             interp.position_y
-                );
-            }
-        }
-
-        // Draw trajectory points
-        ctx->begin_new_path();
-        for(size_t i = 0; i < trajectory_segment.size(); ++i)
-        {
-            //Color based on future / current interpolation
-            uint64_t t_cur = trajectory_segment.at(i).t().nanoseconds();
-            if (t_cur < t_now)
-            {
-                ctx->set_source_rgb(0.7,0.7,0.7);
-            }
-            else
-            {
-                ctx->set_source_rgb(0,0,0.8);
-            }
-
-            ctx->arc(
-                trajectory_segment[i].px(),
-                trajectory_segment[i].py(),
-                0.02, 0.0, 2 * M_PI
-            );
-            ctx->fill();
-        }
+        //Only interpolated again if the vehicle received a new command
+        TrajectoryDrawingCache::draw_trajectory(ctx, trajectory_drawing_cache.get_trajectory(vehicle_id, trajectory), t_now);
     }
-    ctx->restore();
+
+    return drawn;
 }
 
-void MapViewUi::draw_received_path_tracking_commands(const DrawingContext& ctx)
+bool MapViewUi::draw_received_path_tracking_commands(const DrawingContext& ctx)
 {
     VehiclePathTracking vehiclePathTracking = get_vehicle_path_tracking_command_callback();
+    bool drawn = false;
 
-    ctx->save();
     for(const auto& entry : vehiclePathTracking) 
     {
+        const auto vehicle_id = entry.first;
         const auto& command = entry.second;
 
-        rti::core::vector<PathPoint> path = command.path();
-        
-        if(path.size() < 2 ) continue;
-
-        ctx->set_line_width(0.01);
-
-        // Draw trajectory interpolation - use other color for already invalid parts (timestamp older than current point in time)
-        // start from 1 because of i-1
-        for (size_t i = 1; i < path.size(); ++i)
-        {
-            const int n_interp = 20;
-            
-            ctx->begin_new_path();
-            ctx->move_to(path[i-1].pose().x(),
-                         path[i-1].pose().y()
-            );   
-
-            double start = path[i-1].s();
-            double end = path[i].s();
-            double ds = (end - start) / n_interp;
-            double s_query = start;
-
-            for (int j = 0; j < n_interp; j++)
-            {
-                s_query += ds;
-
-                // calculate distance to reference path
-                PathInterpolation path_interpolation(
-                    s_query, path[i-1], path[i]
-                );
-                
-                ctx->line_to(path_interpolation.position_x,
-                             path_interpolation.position_y
-                );
-
-                ctx->set_source_rgb(0,0.8,0.8);
-
-                ctx->stroke();
-                ctx->move_to(path_interpolation.position_x,
-                             path_interpolation.position_y
-                );
-            }
-        }
+        if(command.path().size() < 2 ) continue;
+        drawn = true;
 
-        // Draw path points
-        ctx->begin_new_path();
-        for(size_t i = 0; i < path.size(); ++i)
-        {
-            ctx->set_source_rgb(0,0.8,0.8);
-
-            ctx->arc(
-                path[i].pose().x(),
-                path[i].pose().y(),
-                0.02, 0.0, 2 * M_PI
-            );
-            ctx->fill();
-        }
+        //Only interpolated again if the vehicle received a new command
+        TrajectoryDrawingCache::draw_path(ctx, trajectory_drawing_cache.get_path(vehicle_id, command));
     }
 
-    ctx->restore();
+    return drawn;
 }
 
 void MapViewUi::draw_path_painting(const DrawingContext& ctx)
@@ -687,7 +652,7 @@ void get_text_offset(Cairo::TextExtents ext, StringMessageAnchor anchor, double&
 
 
 //Draw all received viz commands on the screen
-void MapViewUi::draw_received_visualization_commands(const DrawingContext& ctx) {
+bool MapViewUi::draw_received_visualization_commands(const DrawingContext& ctx) {
     //Get commands
     std::vector<Visualization> visualization_commands = get_visualization_msgs_callback();
 
@@ -767,6 +732,8 @@ void MapViewUi::draw_received_visualization_commands(const DrawingContext& ctx)
             ctx->restore();
         }
     }
+
+    return visualization_commands.size() > 0;
 }
 
 void MapViewUi::draw_text_bounding_box(const DrawingContext& ctx, Cairo::TextExtents extents)
@@ -964,27 +931,19 @@ void MapViewUi::draw_labcam(const DrawingContext& ctx)
 }
 
 
-void MapViewUi::draw_vehicle_past_trajectory(const DrawingContext& ctx, const map<string, shared_ptr<TimeSeries>>& vehicle_timeseries)
+void MapViewUi::draw_vehicle_past_trajectory(const DrawingContext& ctx, const VehicleTimeSeries& vehicle_timeseries, uint8_t vehicle_id)
 {
-    vector<double> trajectory_x = vehicle_timeseries.at("pose_x")->get_last_n_values(100);
-    vector<double> trajectory_y = vehicle_timeseries.at("pose_y")->get_last_n_values(100);
-    for (size_t i = 1; i < trajectory_x.size(); ++i)
-    {
-        if(i == 1) ctx->move_to(trajectory_x[i], trajectory_y[i]);
-        else ctx->line_to(trajectory_x[i], trajectory_y[i]);
-    }
-    ctx->set_source_rgb(1,0,0);
-    ctx->set_line_width(0.01);
-    ctx->stroke();
+    //Only the poses received since the last frame are read from the time series
+    TrajectoryDrawingCache::draw_past_trajectory(ctx, trajectory_drawing_cache.get_past_trajectory(vehicle_id, vehicle_timeseries));
 }
 
-void MapViewUi::draw_vehicle_body(const DrawingContext& ctx, const map<string, shared_ptr<TimeSeries>>& vehicle_timeseries, uint8_t vehicle_id)
+void MapViewUi::draw_vehicle_body(const DrawingContext& ctx, const VehicleTimeSeries& vehicle_timeseries, uint8_t vehicle_id)
 {
     ctx->save();
     {                        
-        const double x = vehicle_timeseries.at("pose_x")->get_latest_value();
-        const double y = vehicle_timeseries.at("pose_y")->get_latest_value();
-        const double yaw = vehicle_timeseries.at("pose_yaw")->get_latest_value();
+        const double x = vehicle_timeseries.at(VehicleDataField::pose_x)->get_latest_value();
+        const double y = vehicle_timeseries.at(VehicleDataField::pose_y)->get_latest_value();
+        const double yaw = vehicle_timeseries.at(VehicleDataField::pose_yaw)->get_latest_value();
 
         ctx->translate(x,y);
         ctx->rotate(yaw);
@@ -1181,20 +1140,34 @@ std::pair<double, double> MapViewUi::get_shape_center(CommonroadDDSShape& shape)
     return std::pair<double, double>(x, y);
 }
 
-void MapViewUi::draw_commonroad_obstacles(const DrawingContext& ctx)
+bool MapViewUi::draw_commonroad_obstacles(const DrawingContext& ctx)
 {
     //Behavior is currently similar to drawing a vehicle - TODO: Improve this later on    
     ctx->set_source_rgb(1,.5,.1);
 
     assert(get_obstacle_data);
-    for (auto entry : get_obstacle_data())
-    {
-        ctx->save();
+    std::vector<CommonroadObstacle> obstacles = get_obstacle_data();
+
+    //Obstacles outside of the visible area are not drawn, the margin (in pixels) leaves space for the description
+    double clip_x_min, clip_y_min, clip_x_max, clip_y_max;
+    ctx->get_clip_extents(clip_x_min, clip_y_min, clip_x_max, clip_y_max);
+    const double margin = 100.0 / zoom;
+    const SpatialIndex::Box visible_area{clip_x_min - margin, clip_x_max + margin, clip_y_min - margin, clip_y_max + margin};
 
+    for (auto& entry : obstacles)
+    {
         const double x = entry.pose().x();
         const double y = entry.pose().y();
         const double yaw = entry.pose().yaw();
 
+        auto bounding_box = SpatialIndex::get_bounding_box(entry.shape(), x, y, yaw);
+        if (bounding_box.has_value() && !bounding_box->intersects(visible_area))
+        {
+            continue;
+        }
+
+        ctx->save();
+
         ctx->translate(x,y);
         ctx->rotate(yaw);
 
@@ -1316,6 +1289,8 @@ void MapViewUi::draw_commonroad_obstacles(const DrawingContext& ctx)
         ctx->restore();
         ctx->restore();
     }
+
+    return obstacles.size() > 0;
 }
 
 Gtk::DrawingArea* MapViewUi::get_parent()
@@ -1326,4 +1301,5 @@ Gtk::DrawingArea* MapViewUi::get_parent()
 
 void MapViewUi::rotate_by(double rotation) {
     this->rotation = std::fmod(this->rotation + (rotation * M_PI / 180), 2*M_PI);
+    redraw_requested = true;
 }
@@ -3,6 +3,7 @@
 #include <gtkmm.h>
 #include "defaults.hpp"
 #include "TimeSeries.hpp"
+#include "VehicleData.hpp"
 #include <thread>
 #include <mutex>
 #include <sstream>
@@ -18,6 +19,8 @@
 
 #include "commonroad_classes/CommonRoadScenario.hpp"
 #include "LCCErrorLogger.hpp"
+#include "MapLayerCache.hpp"
+#include "TrajectoryDrawingCache.hpp"
 
 /**
  * \brief Used in a lot of classes, provides a reference to the drawing context of the map view, 
@@ -25,11 +28,6 @@
  * \ingroup lcc_ui
  */
 using DrawingContext = ::Cairo::RefPtr< ::Cairo::Context >;
-/**
- * \brief Maps vehicle ID to map: Data ID, TimeSeries data (e.g. battery->battery data)
- * \ingroup lcc_ui
- */
-using VehicleData = map<uint8_t, map<string, shared_ptr<TimeSeries> > >;
 /**
  * \brief Maps vehicle ID to current vehicle trajectory
  * \ingroup lcc_ui
@@ -64,9 +62,24 @@ class MapViewUi
     std::function<std::vector<Visualization>()> get_visualization_msgs_callback;
     //! GTK dispatcher to connect to GTK's UI thread, for all drawing operations
     Glib::Dispatcher update_dispatcher;
-    //! Calls update_dispatcher every 20ms for smooth map updates
+    //! Calls update_dispatcher every 20ms, which decides if the map needs to be redrawn
     std::thread draw_loop_thread;
     std::atomic_bool run_draw_thread;
+
+    //! Static layers (commonroad scenario, lab boundaries, labcam), only redrawn on zoom / pan / rotation / resize or when the scenario changed
+    MapLayerCache static_layer_cache;
+    //! Tessellated trajectory / path tracking commands and past trajectories of the vehicles, only updated when new data was received
+    TrajectoryDrawingCache trajectory_drawing_cache;
+    //! Set by user input (mouse, keys), the map is redrawn on the next update tick
+    bool redraw_requested = true;
+    //! True if the last drawn frame contained time-dependent content (trajectory commands, obstacles, visualizations, path painting), which is redrawn on every update tick
+    bool time_dependent_content_drawn = false;
+    //! Time of the newest vehicle pose that was drawn, to redraw when new vehicle data arrives
+    uint64_t latest_vehicle_data_time = 0;
+    //! Update ticks since the last redraw
+    int ticks_since_redraw = 0;
+    //! Without new data or user input, the map is still redrawn every idle_redraw_ticks update ticks (e.g. to remove vehicles that stopped sending)
+    static constexpr int idle_redraw_ticks = 10;
     //! Image object for the car
     Cairo::RefPtr<Cairo::ImageSurface> image_car;
     //! Image object for an object, currently not in use
@@ -150,6 +163,29 @@ class MapViewUi
      */
     void draw(const DrawingContext& ctx);
 
+    /**
+     * \brief Transforms the context from widget coordinates to world coordinates (pan, zoom, rotation)
+     * \param ctx The drawing context, to draw on the map view
+     */
+    void apply_view_transform(const DrawingContext& ctx);
+
+    /**
+     * \brief Everything the static layers depend on (view size, pan, zoom, rotation, scenario revision and draw configuration)
+     */
+    MapLayerCache::Key get_static_layer_key();
+
+    /**
+     * \brief Draws the layers that rarely change (commonroad scenario, lab boundaries, labcam) in widget coordinates, used for static_layer_cache
+     * \param ctx The drawing context of the cache surface
+     */
+    void draw_static_layers(const DrawingContext& ctx);
+
+    /**
+     * \brief Called on every update tick (every 20ms) in the UI thread: Applies key presses, gets the vehicle data
+     * and redraws the map if necessary (new data, user input, changed static layers, time-dependent content)
+     */
+    void update();
+
     /**
      * \brief Deprecated, draw a grid in the map view
      * \param ctx The drawing context, to draw on the map view
@@ -171,10 +207,12 @@ class MapViewUi
      * \brief Draws the past trajectory of the vehicle
      * \param ctx The drawing context, to draw on the map view
      * \param vehicle_timeseries Gives past vehicle pose_x and pose_y values for drawing the past trajectory between them
+     * \param vehicle_id ID of the vehicle, to look up its cached past trajectory
      */
     void draw_vehicle_past_trajectory(
         const DrawingContext& ctx, 
-        const map<string, shared_ptr<TimeSeries>>& vehicle_timeseries
+        const VehicleTimeSeries& vehicle_timeseries,
+        uint8_t vehicle_id
     );
 
     /**
@@ -185,7 +223,7 @@ class MapViewUi
      */
     void draw_vehicle_body(
         const DrawingContext& ctx, 
-        const map<string, shared_ptr<TimeSeries>>& vehicle_timeseries, 
+        const VehicleTimeSeries& vehicle_timeseries, 
         uint8_t vehicle_id
     );
 
@@ -213,26 +251,30 @@ class MapViewUi
     /**
      * \brief Draw the vehicle's future trajectory, with one color for past and another for future parts of the trajectory
      * \param ctx The drawing context, to draw on the map view
+     * \return True if any trajectory was drawn
      */
-    void draw_received_trajectory_commands(const DrawingContext& ctx);
+    bool draw_received_trajectory_commands(const DrawingContext& ctx);
 
     /**
      * \brief Draw received path tracking
      * \param ctx The drawing context, to draw on the map view
+     * \return True if any path was drawn
      */
-    void draw_received_path_tracking_commands(const DrawingContext& ctx);
+    bool draw_received_path_tracking_commands(const DrawingContext& ctx);
 
     /**
      * \brief Draw all received commonroad obstacles from get_obstacle_data
      * \param ctx The drawing context, to draw on the map view
+     * \return True if any obstacle was drawn
      */
-    void draw_commonroad_obstacles(const DrawingContext& ctx);
+    bool draw_commonroad_obstacles(const DrawingContext& ctx);
 
     /**
      * \brief draw function that uses the viz callback to get all received viz commands and draws them on the screen
      * \param ctx The drawing context, to draw on the map view
+     * \return True if any visualization was drawn
      */
-    void draw_received_visualization_commands(const DrawingContext& ctx);
+    bool draw_received_visualization_commands(const DrawingContext& ctx);
 
     /**
      * \brief Helper function to draw text surrounded by a small filled rectangle with white background and transparency
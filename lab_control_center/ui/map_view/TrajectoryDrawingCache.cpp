@@ -0,0 +1,350 @@
+#include "TrajectoryDrawingCache.hpp"
+
+#include "TrajectoryInterpolation.hpp"
+#include "TrajectoryInterpolation.cxx"
+
+#include "PathInterpolation.hpp"
+#include "PathInterpolation.cxx"
+
+/**
+ * \file TrajectoryDrawingCache.cpp
+ * \ingroup lcc_ui
+ */
+
+bool TrajectoryDrawingCache::CommandKey::operator==(const CommandKey& other) const
+{
+    return create_stamp == other.create_stamp
+        && size == other.size
+        && first == other.first
+        && last == other.last;
+}
+
+const TrajectoryDrawingCache::Tessellation& TrajectoryDrawingCache::get_trajectory(uint8_t vehicle_id, const VehicleCommandTrajectory& command)
+{
+    const auto& trajectory_points = command.trajectory_points();
+
+    CommandKey key;
+    key.create_stamp = command.header().create_stamp().nanoseconds();
+    key.size = trajectory_points.size();
+    if (key.size > 0)
+    {
+        key.first = static_cast<double>(trajectory_points[0].t().nanoseconds());
+        key.last = static_cast<double>(trajectory_points[key.size - 1].t().nanoseconds());
+    }
+
+    auto entry_it = trajectories.find(vehicle_id);
+    if (entry_it != trajectories.end() && entry_it->second.key == key)
+    {
+        entry_it->second.used_in_frame = frame;
+        return entry_it->second.tessellation;
+    }
+
+    CommandEntry& entry = trajectories[vehicle_id];
+    entry.key = key;
+    entry.used_in_frame = frame;
+    ++tessellation_count;
+
+    auto& vertices = entry.tessellation.vertices;
+    auto& points = entry.tessellation.points;
+    vertices.clear();
+    points.clear();
+    vertices.reserve((key.size > 1) ? (key.size - 1) * (n_interpolation_steps + 1) : 0);
+    points.reserve(key.size);
+
+    // Same interpolation as the vehicle, see TrajectoryInterpolation
+    for (size_t i = 1; i < key.size; ++i)
+    {
+        const TrajectoryPoint& start_point = trajectory_points[i-1];
+        const TrajectoryPoint& end_point = trajectory_points[i];
+        const uint64_t t_start = start_point.t().nanoseconds();
+        const uint64_t delta_t = end_point.t().nanoseconds() - t_start;
+
+        vertices.push_back(Vertex{start_point.px(), start_point.py(), t_start, true});
+        for (int interp_step = 1; interp_step <= n_interpolation_steps; ++interp_step)
+        {
+            const uint64_t t_cur = (delta_t * interp_step) / n_interpolation_steps + t_start;
+            TrajectoryInterpolation interp(t_cur, start_point, end_point);
+            vertices.push_back(Vertex{interp.position_x, interp.position_y, t_cur, false});
+        }
+    }
+
+    for (const auto& point : trajectory_points)
+    {
+        points.push_back(Vertex{point.px(), point.py(), point.t().nanoseconds(), false});
+    }
+
+    return entry.tessellation;
+}
+
+const TrajectoryDrawingCache::Tessellation& TrajectoryDrawingCache::get_path(uint8_t vehicle_id, const VehicleCommandPathTracking& command)
+{
+    const auto& path = command.path();
+
+    CommandKey key;
+    key.create_stamp = command.header().create_stamp().nanoseconds();
+    key.size = path.size();
+    if (key.size > 0)
+    {
+        key.first = path[0].s();
+        key.last = path[key.size - 1].s();
+    }
+
+    auto entry_it = paths.find(vehicle_id);
+    if (entry_it != paths.end() && entry_it->second.key == key)
+    {
+        entry_it->second.used_in_frame = frame;
+        return entry_it->second.tessellation;
+    }
+
+    CommandEntry& entry = paths[vehicle_id];
+    entry.key = key;
+    entry.used_in_frame = frame;
+    ++tessellation_count;
+
+    auto& vertices = entry.tessellation.vertices;
+    auto& points = entry.tessellation.points;
+    vertices.clear();
+    points.clear();
+    vertices.reserve((key.size > 1) ? (key.size - 1) * (n_interpolation_steps + 1) : 0);
+    points.reserve(key.size);
+
+    for (size_t i = 1; i < key.size; ++i)
+    {
+        vertices.push_back(Vertex{path[i-1].pose().x(), path[i-1].pose().y(), 0, true});
+
+        const double start = path[i-1].s();
+        const double end = path[i].s();
+        const double ds = (end - start) / n_interpolation_steps;
+        double s_query = start;
+
+        for (int j = 0; j < n_interpolation_steps; ++j)
+        {
+            s_query += ds;
+            PathInterpolation path_interpolation(s_query, path[i-1], path[i]);
+            vertices.push_back(Vertex{path_interpolation.position_x, path_interpolation.position_y, 0, false});
+        }
+    }
+
+    for (const auto& point : path)
+    {
+        points.push_back(Vertex{point.pose().x(), point.pose().y(), 0, false});
+    }
+
+    return entry.tessellation;
+}
+
+const TrajectoryDrawingCache::PastTrajectory& TrajectoryDrawingCache::get_past_trajectory(uint8_t vehicle_id, const VehicleTimeSeries& vehicle_timeseries)
+{
+    const auto& series_x = vehicle_timeseries.at(VehicleDataField::pose_x);
+    const auto& series_y = vehicle_timeseries.at(VehicleDataField::pose_y);
+
+    PastTrajectoryEntry& entry = past_trajectories[vehicle_id];
+    entry.used_in_frame = frame;
+
+    //The vehicle data was reset (new time series) or the time series restarted
+    const uint64_t latest_time = series_y->get_latest_time();
+    if (entry.source != series_y.get() || latest_time < entry.latest_time)
+    {
+        entry.source = series_y.get();
+        entry.latest_time = 0;
+        entry.sample_count = 0;
+        entry.trajectory.x.clear();
+        entry.trajectory.y.clear();
+    }
+
+    const uint64_t sample_count = series_y->get_sample_count();
+    if (sample_count == entry.sample_count)
+    {
+        return entry.trajectory;
+    }
+
+    //Only read the new poses. A received pose is pushed to pose_x and then to pose_y, poses received together share
+    //the same time, so x and y are matched by their sample index
+    //(x may already contain a newer pose than y, which is then added in the next frame)
+    const uint64_t begin = std::max(entry.sample_count,
+        (sample_count > past_trajectory_length) ? sample_count - past_trajectory_length : 0);
+    vector<uint64_t> times_x, times_y;
+    vector<double> values_x, values_y;
+    const uint64_t first_y = series_y->get_samples_since(begin, times_y, values_y);
+    const uint64_t first_x = series_x->get_samples_since(begin, times_x, values_x);
+    const uint64_t first = std::max(first_x, first_y);
+    const uint64_t end = std::min(first_x + values_x.size(), first_y + values_y.size());
+
+    auto& trajectory = entry.trajectory;
+    if (first > entry.sample_count)
+    {
+        //Poses in between were skipped, they are older than the past trajectory
+        trajectory.x.clear();
+        trajectory.y.clear();
+    }
+    for (uint64_t i = first; i < end; ++i)
+    {
+        trajectory.x.push_back(values_x[i - first_x]);
+        trajectory.y.push_back(values_y[i - first_y]);
+        entry.latest_time = times_y[i - first_y];
+    }
+    entry.sample_count = std::max(entry.sample_count, end);
+
+    if (trajectory.x.size() > past_trajectory_length)
+    {
+        const size_t n_remove = trajectory.x.size() - past_trajectory_length;
+        trajectory.x.erase(trajectory.x.begin(), trajectory.x.begin() + n_remove);
+        trajectory.y.erase(trajectory.y.begin(), trajectory.y.begin() + n_remove);
+    }
+
+    return trajectory;
+}
+
+template<typename Entry> void TrajectoryDrawingCache::remove_unused(map<uint8_t, Entry>& entries)
+{
+    for (auto it = entries.begin(); it != entries.end(); /*No ++ because this depends on whether a deletion took place*/)
+    {
+        if (it->second.used_in_frame != frame)
+        {
+            it = entries.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
+
+void TrajectoryDrawingCache::end_frame()
+{
+    remove_unused(trajectories);
+    remove_unused(paths);
+    remove_unused(past_trajectories);
+    ++frame;
+}
+
+uint64_t TrajectoryDrawingCache::get_tessellation_count() const
+{
+    return tessellation_count;
+}
+
+void TrajectoryDrawingCache::draw_trajectory(const DrawingContext& ctx, const Tessellation& tessellation, uint64_t t_now)
+{
+    ctx->save();
+    ctx->set_line_width(0.01);
+
+    auto set_color = [&](bool past) {
+        if (past)
+        {
+            //Color for past segments
+            ctx->set_source_rgb(0.7,0.7,0.7);
+        }
+        else
+        {
+            //Color for current and future segments
+            ctx->set_source_rgb(0,0,0.8);
+        }
+    };
+
+    // Draw trajectory interpolation - use other color for already invalid parts (timestamp older than current point in time)
+    // Consecutive lines of the same color are stroked together
+    ctx->begin_new_path();
+    bool has_path = false;
+    bool path_is_past = false;
+    bool needs_move = true;
+    double previous_x = 0;
+    double previous_y = 0;
+    for (const Vertex& vertex : tessellation.vertices)
+    {
+        if (vertex.starts_segment)
+        {
+            previous_x = vertex.x;
+            previous_y = vertex.y;
+            needs_move = true;
+            continue;
+        }
+
+        const bool is_past = vertex.t < t_now;
+        if (has_path && is_past != path_is_past)
+        {
+            set_color(path_is_past);
+            ctx->stroke();
+            needs_move = true;
+        }
+        if (needs_move)
+        {
+            ctx->move_to(previous_x, previous_y);
+            needs_move = false;
+        }
+
+        ctx->line_to(vertex.x, vertex.y);
+        has_path = true;
+        path_is_past = is_past;
+        previous_x = vertex.x;
+        previous_y = vertex.y;
+    }
+    if (has_path)
+    {
+        set_color(path_is_past);
+        ctx->stroke();
+    }
+
+    // Draw trajectory points, one fill per color
+    for (bool past : {true, false})
+    {
+        ctx->begin_new_path();
+        bool any_point = false;
+        for (const Vertex& point : tessellation.points)
+        {
+            if ((point.t < t_now) != past) continue;
+
+            ctx->begin_new_sub_path();
+            ctx->arc(point.x, point.y, 0.02, 0.0, 2 * M_PI);
+            any_point = true;
+        }
+        if (any_point)
+        {
+            set_color(past);
+            ctx->fill();
+        }
+    }
+
+    ctx->restore();
+}
+
+void TrajectoryDrawingCache::draw_path(const DrawingContext& ctx, const Tessellation& tessellation)
+{
+    ctx->save();
+    ctx->set_line_width(0.01);
+    ctx->set_source_rgb(0,0.8,0.8);
+
+    ctx->begin_new_path();
+    for (const Vertex& vertex : tessellation.vertices)
+    {
+        if (vertex.starts_segment) ctx->move_to(vertex.x, vertex.y);
+        else ctx->line_to(vertex.x, vertex.y);
+    }
+    ctx->stroke();
+
+    // Draw path points
+    ctx->begin_new_path();
+    for (const Vertex& point : tessellation.points)
+    {
+        ctx->begin_new_sub_path();
+        ctx->arc(point.x, point.y, 0.02, 0.0, 2 * M_PI);
+    }
+    ctx->fill();
+
+    ctx->restore();
+}
+
+void TrajectoryDrawingCache::draw_past_trajectory(const DrawingContext& ctx, const PastTrajectory& past_trajectory)
+{
+    if (past_trajectory.x.size() < 2) return;
+
+    ctx->save();
+    ctx->move_to(past_trajectory.x[0], past_trajectory.y[0]);
+    for (size_t i = 1; i < past_trajectory.x.size(); ++i)
+    {
+        ctx->line_to(past_trajectory.x[i], past_trajectory.y[i]);
+    }
+    ctx->set_source_rgb(1,0,0);
+    ctx->set_line_width(0.01);
+    ctx->stroke();
+    ctx->restore();
+}
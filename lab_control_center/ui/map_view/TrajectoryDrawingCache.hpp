@@ -0,0 +1,194 @@
+#pragma once
+
+#include "defaults.hpp"
+#include "VehicleData.hpp"
+#include "VehicleCommandTrajectory.hpp"
+#include "VehicleCommandPathTracking.hpp"
+#include "commonroad_classes/InterfaceDraw.hpp"
+
+/**
+ * \class TrajectoryDrawingCache
+ * \brief Per-vehicle geometry of the trajectory commands, path tracking commands and past trajectories drawn in the map view.
+ * Commands are received at the rate of the HLC, but drawn at the rate of the map view. Thus, each received command is
+ * tessellated (interpolated) into a polyline only once, the polyline is kept until the vehicle receives a different command.
+ * Past trajectories are extended by the new poses only, instead of copying the last poses from the time series in every frame.
+ * Only to be used from the UI thread.
+ * \ingroup lcc_ui
+ */
+class TrajectoryDrawingCache
+{
+public:
+    /**
+     * \struct Vertex
+     * \brief Vertex of a tessellated command
+     */
+    struct Vertex
+    {
+        //! x position in m
+        double x;
+        //! y position in m
+        double y;
+        //! Time of the interpolation in ns (trajectories only), decides the color of the line that ends in this vertex
+        uint64_t t;
+        //! True if the vertex starts a new segment (move_to), else a line from the previous vertex ends in this vertex (line_to)
+        bool starts_segment;
+    };
+
+    /**
+     * \struct Tessellation
+     * \brief A tessellated command: The interpolated polyline and the points of the command
+     */
+    struct Tessellation
+    {
+        //! Polyline, n_interpolation_steps lines per segment of the command
+        vector<Vertex> vertices;
+        //! Points of the command, drawn as dots (starts_segment is unused)
+        vector<Vertex> points;
+    };
+
+    /**
+     * \struct PastTrajectory
+     * \brief The most recent poses of a vehicle
+     */
+    struct PastTrajectory
+    {
+        //! x positions, oldest first
+        vector<double> x;
+        //! y positions, oldest first
+        vector<double> y;
+    };
+
+    //! Number of lines each segment of a command is interpolated with
+    static constexpr int n_interpolation_steps = 20;
+    //! Number of poses of the past trajectory
+    static constexpr size_t past_trajectory_length = 100;
+
+private:
+    /**
+     * \struct CommandKey
+     * \brief Identifies a received command. The header stamp alone is not sufficient, as not all HLCs set it.
+     */
+    struct CommandKey
+    {
+        //! Create stamp of the header
+        uint64_t create_stamp = 0;
+        //! Number of points of the command
+        size_t size = 0;
+        //! Time (trajectory) or arc length (path) of the first point
+        double first = 0;
+        //! Time (trajectory) or arc length (path) of the last point
+        double last = 0;
+
+        /**
+         * \brief Equal if all members are equal
+         * \param other Key to compare with
+         */
+        bool operator==(const CommandKey& other) const;
+    };
+
+    /**
+     * \struct CommandEntry
+     * \brief Cached tessellation of the last command of a vehicle
+     */
+    struct CommandEntry
+    {
+        //! The command the tessellation belongs to
+        CommandKey key;
+        //! The tessellation
+        Tessellation tessellation;
+        //! Frame in which the entry was used last
+        uint64_t used_in_frame = 0;
+    };
+
+    /**
+     * \struct PastTrajectoryEntry
+     * \brief Cached past trajectory of a vehicle
+     */
+    struct PastTrajectoryEntry
+    {
+        //! Time series the past trajectory was read from, compared by address to notice a reset of the vehicle data
+        const TimeSeries* source = nullptr;
+        //! Receive time of the newest pose in the past trajectory
+        uint64_t latest_time = 0;
+        //! Number of poses (sample index of pose_x and pose_y) read into the past trajectory
+        uint64_t sample_count = 0;
+        //! The poses
+        PastTrajectory trajectory;
+        //! Frame in which the entry was used last
+        uint64_t used_in_frame = 0;
+    };
+
+    //! Maps vehicle ID to its tessellated trajectory command
+    map<uint8_t, CommandEntry> trajectories;
+    //! Maps vehicle ID to its tessellated path tracking command
+    map<uint8_t, CommandEntry> paths;
+    //! Maps vehicle ID to its past trajectory
+    map<uint8_t, PastTrajectoryEntry> past_trajectories;
+    //! Current frame, see end_frame
+    uint64_t frame = 1;
+    //! Number of tessellated commands, for statistics
+    uint64_t tessellation_count = 0;
+
+    /**
+     * \brief Removes all entries of the map that were not used in the current frame
+     */
+    template<typename Entry> void remove_unused(map<uint8_t, Entry>& entries);
+
+public:
+    /**
+     * \brief Tessellation of the trajectory command of a vehicle, interpolated with TrajectoryInterpolation.
+     * Only computed if the command differs from the one of the last call for this vehicle.
+     * \param vehicle_id ID of the vehicle
+     * \param command The received trajectory command of the vehicle
+     */
+    const Tessellation& get_trajectory(uint8_t vehicle_id, const VehicleCommandTrajectory& command);
+
+    /**
+     * \brief Tessellation of the path tracking command of a vehicle, interpolated with PathInterpolation.
+     * Only computed if the command differs from the one of the last call for this vehicle.
+     * \param vehicle_id ID of the vehicle
+     * \param command The received path tracking command of the vehicle
+     */
+    const Tessellation& get_path(uint8_t vehicle_id, const VehicleCommandPathTracking& command);
+
+    /**
+     * \brief The last past_trajectory_length poses of a vehicle. Only the poses received since the last call for this
+     * vehicle are read from its time series.
+     * \param vehicle_id ID of the vehicle
+     * \param vehicle_timeseries Time series of the vehicle
+     */
+    const PastTrajectory& get_past_trajectory(uint8_t vehicle_id, const VehicleTimeSeries& vehicle_timeseries);
+
+    /**
+     * \brief To be called after each drawn frame: Removes the entries of all vehicles that were not requested in this
+     * frame, e.g. because their commands are outdated
+     */
+    void end_frame();
+
+    /**
+     * \brief Number of commands tessellated since construction
+     */
+    uint64_t get_tessellation_count() const;
+
+    /**
+     * \brief Draws a tessellated trajectory command, in grey where the interpolation time is in the past, else in blue
+     * \param ctx The drawing context, to draw on the map view
+     * \param tessellation Result of get_trajectory
+     * \param t_now Current time in ns
+     */
+    static void draw_trajectory(const DrawingContext& ctx, const Tessellation& tessellation, uint64_t t_now);
+
+    /**
+     * \brief Draws a tessellated path tracking command
+     * \param ctx The drawing context, to draw on the map view
+     * \param tessellation Result of get_path
+     */
+    static void draw_path(const DrawingContext& ctx, const Tessellation& tessellation);
+
+    /**
+     * \brief Draws a past trajectory
+     * \param ctx The drawing context, to draw on the map view
+     * \param past_trajectory Result of get_past_trajectory
+     */
+    static void draw_past_trajectory(const DrawingContext& ctx, const PastTrajectory& past_trajectory);
+};
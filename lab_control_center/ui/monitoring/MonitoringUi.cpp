@@ -254,7 +254,7 @@ void MonitoringUi::init_ui_dispatcher()
         {
             const auto vehicle_id = entry.first;
 
-            auto vehicle_sensor_timeseries = entry.second;
+            const auto& vehicle_sensor_timeseries = entry.second;
             for (size_t i = 0; i < rows_restricted.size(); ++i)
             {
                 Gtk::Label* label = nullptr;
@@ -587,8 +587,8 @@ void MonitoringUi::init_ui_dispatcher()
                     {
                         // is vehicle on its reference trajectory? else stop 
 
-                        auto pose_x = vehicle_sensor_timeseries.at("pose_x")->get_latest_value();
-                        auto pose_y = vehicle_sensor_timeseries.at("pose_y")->get_latest_value();
+                        auto pose_x = vehicle_sensor_timeseries.at(VehicleDataField::pose_x)->get_latest_value();
+                        auto pose_y = vehicle_sensor_timeseries.at(VehicleDataField::pose_y)->get_latest_value();
 
                         VehicleTrajectories vehicleTrajectories = get_vehicle_trajectory();
                         VehicleTrajectories::iterator trajectory = vehicleTrajectories.find(vehicle_id);
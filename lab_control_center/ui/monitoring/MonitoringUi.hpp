@@ -17,6 +17,7 @@
 #include <math.h>
 
 #include "TimeSeries.hpp"
+#include "VehicleData.hpp"
 #include "defaults.hpp"
 #include "cpm/Logging.hpp"
 #include "cpm/get_time_ns.hpp"
@@ -26,7 +27,6 @@
 
 #include "ui/setup/CrashChecker.hpp"
 
-using VehicleData = map<uint8_t, map<string, shared_ptr<TimeSeries> > >;
 using VehicleTrajectories = map<uint8_t, VehicleCommandTrajectory >;
 
 /**
@@ -18,16 +18,29 @@ CrashChecker::CrashChecker(
     ui_dispatcher.connect(sigc::mem_fun(*this, &CrashChecker::ui_dispatch));
 
     crash_check_running.store(false);
+
+    //Supervised local programs report their exit right away, then the crash check does not have to wait for its next period
+    deploy_functions->set_crash_callback([this] (std::string) {
+        std::lock_guard<std::mutex> lock(crash_check_wakeup_mutex);
+        local_exit_detected = true;
+        crash_check_wakeup.notify_all();
+    });
 }
 
 CrashChecker::~CrashChecker()
 {
+    deploy_functions->set_crash_callback(std::function<void(std::string)>());
     kill_crash_check_thread();
 }
 
 void CrashChecker::kill_crash_check_thread()
 {
-    crash_check_running.store(false);
+    {
+        std::lock_guard<std::mutex> lock(crash_check_wakeup_mutex);
+        crash_check_running.store(false);
+    }
+    crash_check_wakeup.notify_all();
+
     if (thread_deploy_crash_check.joinable())
     {
         thread_deploy_crash_check.join();
@@ -227,7 +240,13 @@ void CrashChecker::start_checking(bool script_used, bool use_middleware_without_
 
                 update_crashed_participants(crashed_participants);
 
-                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+                //Checks for local programs that are supervised by Deploy do not spawn any process, others share one call of tmux ls
+                //Wait until the next period or until Deploy reports the exit of a local program
+                std::unique_lock<std::mutex> lock(crash_check_wakeup_mutex);
+                crash_check_wakeup.wait_for(lock, crash_check_period, [this] { 
+                    return local_exit_detected || !crash_check_running.load(); 
+                });
+                local_exit_detected = false;
             }
         }
     );
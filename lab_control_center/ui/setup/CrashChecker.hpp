@@ -15,6 +15,8 @@
 #include <algorithm>
 #include <atomic>
 #include <array>
+#include <chrono>
+#include <condition_variable>
 #include <functional>
 #include <iostream>
 #include <memory>
@@ -57,6 +59,14 @@ private:
     std::vector<std::string> newly_crashed_participants;
     //! For the thread_deploy_crash_check thread, stop condition (stops if false)
     std::atomic_bool crash_check_running;
+    //! To wake up thread_deploy_crash_check when it is stopped or when Deploy detected the exit of a local program
+    std::condition_variable crash_check_wakeup;
+    //! For crash_check_wakeup and local_exit_detected
+    std::mutex crash_check_wakeup_mutex;
+    //! Set by the crash callback of Deploy, so that the next check is done right away
+    bool local_exit_detected = false;
+    //! Period of the crash checks if no exit of a local program was reported by Deploy before
+    const std::chrono::milliseconds crash_check_period{1000};
     //! Dialog window, displays crash messages / crashed participants to the user
     std::shared_ptr<Gtk::MessageDialog> crash_dialog;
     /**
@@ -12,6 +12,8 @@ Deploy::Deploy(
     stop_vehicle(_stop_vehicle),
     program_executor(_program_executor)
 {
+    process_supervisor = std::make_shared<ProcessSupervisor>();
+
     //Construct the path to the folder by erasing all parts to the executable that are obsolete
     //Executable path: .../software/lab_control_center/build/lab_control_center
     //-> Remove everything up to the third-last slash
@@ -132,7 +134,7 @@ void Deploy::deploy_local_hlc(bool use_simulated_time, std::vector<unsigned int>
             std::cout << command.str() << std::endl;
 
             //Execute command
-            program_executor->execute_command(command.str());
+            start_session(hlc_session, command.str());
         }
 
         deploy_middleware(sim_time_string, vehicle_ids_stream);
@@ -225,7 +227,7 @@ void Deploy::deploy_separate_local_hlcs(bool use_simulated_time, std::vector<uns
         deployed_local_hlcs.push_back(vehicle_id);
 
         //Execute command
-        program_executor->execute_command(command.str());
+        start_session(hlc_session + "_" + std::to_string(vehicle_id), command.str());
     }
 
     std::stringstream vehicle_ids_stream;
@@ -313,7 +315,7 @@ void Deploy::deploy_middleware(std::string sim_time_string, std::stringstream& v
         << " >" << software_top_folder_path << "/lcc_script_logs/stdout_" << middleware_session << ".txt 2>" << software_top_folder_path << "/lcc_script_logs/stderr_" << middleware_session << ".txt\"";
 
     //Execute command
-    program_executor->execute_command(middleware_command.str());
+    start_session(middleware_session, middleware_command.str());
 }
 
 void Deploy::deploy_sim_vehicles(std::vector<unsigned int> simulated_vehicle_ids, bool use_simulated_time) 
@@ -351,7 +353,7 @@ void Deploy::deploy_sim_vehicle(unsigned int id, bool use_simulated_time)
         << " >" << software_top_folder_path << "/lcc_script_logs/stdout_" << vehicle_session << id << ".txt 2>" << software_top_folder_path << "/lcc_script_logs/stderr_" << vehicle_session << id << ".txt\"";
 
     //Execute command
-    program_executor->execute_command(command.str());
+    start_session(session_name.str(), command.str());
 }
 
 void Deploy::stop_vehicles(std::vector<unsigned int> vehicle_ids)
@@ -640,8 +642,8 @@ void Deploy::deploy_ips()
         << " >" << software_top_folder_path << "/lcc_script_logs/stdout_" << basler_session << ".txt 2>" << software_top_folder_path << "/lcc_script_logs/stderr_" << basler_session << ".txt\"";
 
     //Execute command
-    program_executor->execute_command(command_ips.str());
-    program_executor->execute_command(command_basler.str());
+    start_session(ips_session, command_ips.str());
+    start_session(basler_session, command_basler.str());
 }
 
 void Deploy::kill_ips() {
@@ -665,7 +667,7 @@ void Deploy::deploy_labcam(std::string path, std::string file_name){
         << " >" << software_top_folder_path << "/lcc_script_logs/stdout_" << labcam_session << ".txt 2>" << software_top_folder_path << "/lcc_script_logs/stderr_" << labcam_session << ".txt\"";
     
     //Execute command
-    program_executor->execute_command(command.str());
+    start_session(labcam_session, command.str());
 }
 
 
@@ -739,14 +741,14 @@ void Deploy::deploy_recording(std::string recording_folder)
     command 
         << "tmux new-session -d "
         << "-s \"" << recording_session << "\" "
-        << "rtirecordingservice "
+        << "\"rtirecordingservice "
         << "-cfgFile " << config_path_out << " "
         << "-cfgName cpm_recorder" << " "
-        << ">" << software_top_folder_path << "/lcc_script_logs/stdout_recording.txt 2>" << software_top_folder_path << "/lcc_script_logs/stderr_recording.txt";
+        << ">" << software_top_folder_path << "/lcc_script_logs/stdout_recording.txt 2>" << software_top_folder_path << "/lcc_script_logs/stderr_recording.txt\"";
     
     //std::cout << command.str() << std::endl;
     //Execute command
-    program_executor->execute_command(command.str());
+    start_session(recording_session, command.str());
 }
 
 void Deploy::kill_recording() 
@@ -759,6 +761,11 @@ void Deploy::kill_recording()
 bool Deploy::session_exists(std::string session_id)
 {
     std::string running_sessions = program_executor->get_command_output("tmux ls");
+    return session_listed(session_id, running_sessions);
+}
+
+bool Deploy::session_listed(std::string session_id, const std::string& running_sessions)
+{
     session_id += ":";
 
     if (running_sessions.find("ERROR") != std::string::npos)
@@ -774,6 +781,60 @@ bool Deploy::session_exists(std::string session_id)
     return running_sessions.find(session_id) != std::string::npos;
 }
 
+bool Deploy::session_running(std::string session_id, std::optional<std::string>& running_sessions)
+{
+    //Supervised sessions: The state is known without spawning any process
+    auto supervised_running = process_supervisor->is_running(session_id);
+    if (supervised_running.has_value())
+    {
+        return supervised_running.value();
+    }
+
+    if (!running_sessions.has_value())
+    {
+        running_sessions = program_executor->get_command_output("tmux ls");
+    }
+    return session_listed(session_id, running_sessions.value());
+}
+
+void Deploy::start_session(std::string session_id, std::string command)
+{
+    const std::string new_session = "tmux new-session -d ";
+    if (!ProcessSupervisor::is_supported() || command.compare(0, new_session.size(), new_session) != 0)
+    {
+        //Crashes of this session are detected with tmux ls
+        process_supervisor->unwatch(session_id);
+        program_executor->execute_command(command);
+        return;
+    }
+
+    //Let tmux print the PID of the program in the new session (which ends with the program), to supervise it
+    command.insert(new_session.size(), "-P -F \"#{pane_pid}\" ");
+    std::string output = program_executor->get_command_output(command);
+
+    int process_id = 0;
+    if (output.find("ERROR") == std::string::npos)
+    {
+        process_id = std::atoi(output.c_str());
+    }
+
+    if (!process_supervisor->watch(session_id, process_id))
+    {
+        cpm::Logging::Instance().write(
+            2, 
+            "Could not supervise tmux session %s (output: %s), using tmux ls to check for crashes", 
+            session_id.c_str(),
+            output.c_str()
+        );
+        process_supervisor->unwatch(session_id);
+    }
+}
+
+void Deploy::set_crash_callback(std::function<void(std::string)> callback)
+{
+    process_supervisor->set_exit_callback(callback);
+}
+
 std::vector<std::string> Deploy::check_for_crashes(bool script_started,bool deploy_distributed, bool has_local_hlc, bool lab_mode_on, bool check_for_recording)
 {
     //std::cout << "Gets called with: " << script_started << ", " << deploy_remote << ", " << has_local_hlc << ", " << lab_mode_on << ", " << check_for_recording << std::endl;
@@ -786,15 +847,18 @@ std::vector<std::string> Deploy::check_for_crashes(bool script_started,bool depl
     //If script_started is false, no HLC script was started, so we do not need to check for that
     //The same holds for lab_mode_on, check_for_recording and their associated programs
 
+    //Sessions that are not supervised share one call of tmux ls
+    std::optional<std::string> running_sessions;
+
     std::vector<std::string> crashed_participants;
     if (!(deploy_distributed))
     {
         if (script_started)
         {
-            if(! session_exists(hlc_session)) crashed_participants.push_back("HLC");
+            if(! session_running(hlc_session, running_sessions)) crashed_participants.push_back("HLC");
         }
 
-        if(! session_exists(middleware_session)) crashed_participants.push_back("Middleware");
+        if(! session_running(middleware_session, running_sessions)) crashed_participants.push_back("Middleware");
     }
     if (deploy_distributed && has_local_hlc)
     {
@@ -802,22 +866,22 @@ std::vector<std::string> Deploy::check_for_crashes(bool script_started,bool depl
         {
             for( unsigned int local_hlc : deployed_local_hlcs ) {
                 std::string tmp_session_name = hlc_session+"_"+std::to_string(local_hlc);
-                if(! session_exists(tmp_session_name)){
+                if(! session_running(tmp_session_name, running_sessions)){
                     crashed_participants.push_back(tmp_session_name);
                 }
             }   
         }
-        if(! session_exists(middleware_session)) crashed_participants.push_back("Middleware");
+        if(! session_running(middleware_session, running_sessions)) crashed_participants.push_back("Middleware");
     }
     if (lab_mode_on)
     {
-        if(! session_exists(ips_session)) crashed_participants.push_back("IPS");
-        if(! session_exists(basler_session)) crashed_participants.push_back("Basler LED detection");
+        if(! session_running(ips_session, running_sessions)) crashed_participants.push_back("IPS");
+        if(! session_running(basler_session, running_sessions)) crashed_participants.push_back("Basler LED detection");
     }
     if (check_for_recording)
     {
-        if(! session_exists(recording_session)) crashed_participants.push_back("DDS Recording");
-        if(! session_exists(labcam_session)) crashed_participants.push_back("LabCam");
+        if(! session_running(recording_session, running_sessions)) crashed_participants.push_back("DDS Recording");
+        if(! session_running(labcam_session, running_sessions)) crashed_participants.push_back("LabCam");
     }
 
     return crashed_participants;
@@ -825,6 +889,9 @@ std::vector<std::string> Deploy::check_for_crashes(bool script_started,bool depl
 
 void Deploy::kill_session(std::string session_id, float delay) // delay default is 0 (see Deploy.hpp)
 {
+    //Killing the session on purpose is not a crash
+    process_supervisor->unwatch(session_id);
+
     if (session_exists(session_id))
     {
         std::stringstream command;
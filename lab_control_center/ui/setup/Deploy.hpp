@@ -12,6 +12,7 @@
 #include <iostream>
 #include <map>
 #include <memory>
+#include <optional>
 #include <regex>        // to replace file contents
 #include <stdexcept>
 #include <string>
@@ -26,6 +27,7 @@
 
 #include "cpm/Logging.hpp"
 #include "ProgramExecutor.hpp"
+#include "ProcessSupervisor.hpp"
 
 /**
  * \brief This class is responsible for managing deployment of HLC and vehicle scripts / programs and other participants that are launched from the LCC
@@ -210,6 +212,13 @@ public:
      */
     std::vector<std::string> check_for_crashes(bool script_started, bool deploy_distributed, bool has_local_hlc, bool lab_mode_on, bool check_for_recording);
 
+    /**
+     * \brief Set a function that is called right after a supervised local program (see start_session) exited,
+     * so that crashes can be reported without waiting for the next call of check_for_crashes.
+     * \param callback Gets the tmux session ID of the program, called by another thread; may be empty to remove the callback
+     */
+    void set_crash_callback(std::function<void(std::string)> callback);
+
 private:
     /**
      * \enum PROCESS_STATE
@@ -234,6 +243,9 @@ private:
     //! Provides safer access to deploying functions (uses a child process that was forked before creation of DDS threads etc.)
     std::shared_ptr<ProgramExecutor> program_executor;
     
+    //! Detects the exit of local programs started with start_session right away, without calling tmux ls
+    std::shared_ptr<ProcessSupervisor> process_supervisor;
+
     //! In case of distributed / remote deployment, some vehicles might not be matched because not enough HLCs are available. The remaining HLCs are simulated on the local machine, their ID is stored here.
     std::vector<unsigned int> deployed_local_hlcs;
 
@@ -253,6 +265,30 @@ private:
      */
     bool session_exists(std::string session_id);
 
+    /**
+     * \brief Check if the given tmux session is listed in the output of tmux ls
+     * \param session_id ID of the tmux session
+     * \param running_sessions Output of tmux ls
+     * \return True if the session exists or if the output of tmux ls indicates an error, false otherwise
+     */
+    bool session_listed(std::string session_id, const std::string& running_sessions);
+
+    /**
+     * \brief Check if the program in the given tmux session is still running. Uses the process_supervisor if the session
+     * was started with start_session, else tmux ls (called at most once for all sessions checked with the same running_sessions)
+     * \param session_id ID of the tmux session
+     * \param running_sessions Output of tmux ls, obtained on the first call that requires it
+     * \return True if the program / the session is running, false otherwise
+     */
+    bool session_running(std::string session_id, std::optional<std::string>& running_sessions);
+
+    /**
+     * \brief Start a tmux session and supervise its program with process_supervisor (if supported), so that its exit is detected right away
+     * \param session_id ID of the tmux session
+     * \param command Command that starts the session, must start with "tmux new-session -d " to be supervised
+     */
+    void start_session(std::string session_id, std::string command);
+
     /**
      * \brief Kill a tmux session with the given session_id - only if it exists (uses session_exists)
      * \param session_id ID of the tmux session
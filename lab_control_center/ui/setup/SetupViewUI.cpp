@@ -197,11 +197,11 @@ SetupViewUI::SetupViewUI
 
                 //Get currently active vehicles
                 active_real_vehicles.clear();
-                for (auto vehicle_entry : get_vehicle_data())
+                for (const auto& vehicle_entry : get_vehicle_data())
                 {
                     auto id = vehicle_entry.first;
-                    auto entry_real = vehicle_entry.second.at("is_real");
-                    auto entry_pose_x = vehicle_entry.second.at("pose_x");
+                    auto entry_real = vehicle_entry.second.at(VehicleDataField::is_real);
+                    auto entry_pose_x = vehicle_entry.second.at(VehicleDataField::pose_x);
 
                     //Continue if the entry is no longer valid (can happen e.g. during destruction)
                     if (!entry_real || !entry_pose_x) continue;
@@ -43,6 +43,14 @@
 #define REFLECT_REMAINDER	TRUE
 #define CHECK_VALUE			0xBB3D
 
+/*
+ * crcFast() and the slice-by-N variants below work on the reflected
+ * remainder and therefore assume reflected data and remainder.
+ */
+#if (REFLECT_DATA != TRUE) || (REFLECT_REMAINDER != TRUE)
+#error "The table driven CRC implementations require REFLECT_DATA and REFLECT_REMAINDER"
+#endif
+
 
 /*
  * Derive parameters from the standard-specific parameters in crc.h.
@@ -108,18 +116,97 @@ reflect(uint32_t data, uint8_t nBits)
 }	/* reflect() */
 
 
+/*
+ * Lookup table of the reflected algorithm: crcTable[b] is the
+ * (reflected) remainder of the byte b.
+ */
 crc  crcTable[256];
 
+/*
+ * INITIAL_REMAINDER in the bit order of the reflected algorithm.
+ */
+static crc  crcInitialRemainder;
+
+#ifndef __AVR__
+/*
+ * Tables for slicing-by-8: crcTableSlice[k - 1][b] is the remainder of
+ * the byte b followed by k zero bytes. Together with crcTable, N bytes
+ * are processed with N independent table lookups. 3.5 KiB, so they are
+ * not compiled for the ATmega with its 8 KiB of RAM.
+ */
+static crc  crcTableSlice[7][256];
+#endif
+
+
+/*********************************************************************
+ *
+ * Function:    crcSlow()
+ * 
+ * Description: Compute the CRC of a given message, a bit at a time.
+ *
+ * Notes:		Reference for the table driven implementations, does
+ *				not need crcInit().
+ *
+ * Returns:		The CRC of the message.
+ *
+ *********************************************************************/
+crc
+crcSlow(uint8_t const message[], int nBytes)
+{
+    crc            remainder = INITIAL_REMAINDER;
+	int            byte;
+	uint8_t  bit;
+
+
+    /*
+     * Perform modulo-2 division, a byte at a time.
+     */
+    for (byte = 0; byte < nBytes; ++byte)
+    {
+        /*
+         * Bring the next byte into the remainder.
+         */
+        remainder ^= (REFLECT_DATA(message[byte]) << (WIDTH - 8));
+
+        /*
+         * Perform modulo-2 division, a bit at a time.
+         */
+        for (bit = 8; bit > 0; --bit)
+        {
+            /*
+             * Try to divide the current data bit.
+             */
+            if (remainder & TOPBIT)
+            {
+                remainder = (remainder << 1) ^ POLYNOMIAL;
+            }
+            else
+            {
+                remainder = (remainder << 1);
+            }
+        }
+    }
+
+    /*
+     * The final remainder is the CRC result.
+     */
+    return (REFLECT_REMAINDER(remainder) ^ FINAL_XOR_VALUE);
+
+}   /* crcSlow() */
+
 
 /*********************************************************************
  *
  * Function:    crcInit()
  * 
- * Description: Populate the partial CRC lookup table.
+ * Description: Populate the partial CRC lookup tables.
  *
  * Notes:		This function must be rerun any time the CRC standard
  *				is changed.  If desired, it can be run "offline" and
  *				the table results stored in an embedded system's ROM.
+ *				The tables hold the remainders of the reflected
+ *				algorithm, which shifts towards the LSB. This avoids
+ *				reflecting every message byte in crcFast().
  *
  * Returns:		None defined.
  *
@@ -127,20 +214,23 @@ crc  crcTable[256];
 void
 crcInit(void)
 {
+    const crc      polynomial = REFLECT_REMAINDER(POLYNOMIAL);
     crc			   remainder;
 	int			   dividend;
 	uint8_t  bit;
 
 
+    crcInitialRemainder = REFLECT_REMAINDER(INITIAL_REMAINDER);
+
     /*
      * Compute the remainder of each possible dividend.
      */
     for (dividend = 0; dividend < 256; ++dividend)
     {
         /*
-         * Start with the dividend followed by zeros.
+         * Start with the dividend, the reflected algorithm shifts towards the LSB.
          */
-        remainder = dividend << (WIDTH - 8);
+        remainder = dividend;
 
         /*
          * Perform modulo-2 division, a bit at a time.
@@ -150,13 +240,13 @@ crcInit(void)
             /*
              * Try to divide the current data bit.
              */			
-            if (remainder & TOPBIT)
+            if (remainder & 0x01)
             {
-                remainder = (remainder << 1) ^ POLYNOMIAL;
+                remainder = (remainder >> 1) ^ polynomial;
             }
             else
             {
-                remainder = (remainder << 1);
+                remainder = (remainder >> 1);
             }
         }
 
@@ -166,6 +256,21 @@ crcInit(void)
         crcTable[dividend] = remainder;
     }
 
+#ifndef __AVR__
+    /*
+     * Each further table appends one zero byte to the previous one.
+     */
+    for (dividend = 0; dividend < 256; ++dividend)
+    {
+        remainder = crcTable[dividend];
+        for (bit = 0; bit < 7; ++bit)
+        {
+            remainder = crcTable[remainder & 0xFF] ^ (remainder >> 8);
+            crcTableSlice[bit][dividend] = remainder;
+        }
+    }
+#endif
+
 }   /* crcInit() */
 
 
@@ -183,8 +288,7 @@ crcInit(void)
 crc
 crcFast(uint8_t const message[], int nBytes)
 {
-    crc	           remainder = INITIAL_REMAINDER;
-    uint8_t  data;
+    crc	           remainder = crcInitialRemainder;
 	int            byte;
 
 
@@ -193,13 +297,125 @@ crcFast(uint8_t const message[], int nBytes)
      */
     for (byte = 0; byte < nBytes; ++byte)
     {
-        data = REFLECT_DATA(message[byte]) ^ (remainder >> (WIDTH - 8));
-  		remainder = crcTable[data] ^ (remainder << 8);
+  		remainder = crcTable[(uint8_t)(remainder ^ message[byte])] ^ (remainder >> 8);
     }
 
     /*
-     * The final remainder is the CRC.
+     * The final remainder is the CRC, it is already reflected.
      */
-    return (REFLECT_REMAINDER(remainder) ^ FINAL_XOR_VALUE);
+    return (remainder ^ FINAL_XOR_VALUE);
 
 }   /* crcFast() */
+
+
+/*********************************************************************
+ *
+ * Function:    crcBegin(), crcUpdate(), crcEnd()
+ * 
+ * Description: Compute the CRC of a message that arrives byte by byte:
+ *				crcEnd(crcUpdate(...crcUpdate(crcBegin(), m[0])..., m[n-1]))
+ *				is crcFast(m, n).
+ *
+ * Notes:		crcInit() must be called first.
+ *
+ * Returns:		The intermediate remainder, crcEnd() the CRC.
+ *
+ *********************************************************************/
+crc
+crcBegin(void)
+{
+    return (crcInitialRemainder);
+
+}   /* crcBegin() */
+
+crc
+crcUpdate(crc remainder, uint8_t data)
+{
+    return (crcTable[(uint8_t)(remainder ^ data)] ^ (remainder >> 8));
+
+}   /* crcUpdate() */
+
+crc
+crcEnd(crc remainder)
+{
+    return (remainder ^ FINAL_XOR_VALUE);
+
+}   /* crcEnd() */
+
+
+#ifndef __AVR__
+/*********************************************************************
+ *
+ * Function:    crcSlice4()
+ * 
+ * Description: Compute the CRC of a given message, four bytes at a time.
+ *
+ * Notes:		crcInit() must be called first.
+ *
+ * Returns:		The CRC of the message.
+ *
+ *********************************************************************/
+crc
+crcSlice4(uint8_t const message[], int nBytes)
+{
+    crc	           remainder = crcInitialRemainder;
+
+
+    for (; nBytes >= 4; nBytes -= 4, message += 4)
+    {
+        remainder ^= message[0] | (message[1] << 8);
+        remainder = crcTableSlice[2][remainder & 0xFF]
+                  ^ crcTableSlice[1][remainder >> 8]
+                  ^ crcTableSlice[0][message[2]]
+                  ^ crcTable[message[3]];
+    }
+
+    for (; nBytes > 0; --nBytes, ++message)
+    {
+  		remainder = crcTable[(uint8_t)(remainder ^ *message)] ^ (remainder >> 8);
+    }
+
+    return (remainder ^ FINAL_XOR_VALUE);
+
+}   /* crcSlice4() */
+
+
+/*********************************************************************
+ *
+ * Function:    crcSlice8()
+ * 
+ * Description: Compute the CRC of a given message, eight bytes at a time.
+ *
+ * Notes:		crcInit() must be called first.
+ *
+ * Returns:		The CRC of the message.
+ *
+ *********************************************************************/
+crc
+crcSlice8(uint8_t const message[], int nBytes)
+{
+    crc	           remainder = crcInitialRemainder;
+
+
+    for (; nBytes >= 8; nBytes -= 8, message += 8)
+    {
+        remainder ^= message[0] | (message[1] << 8);
+        remainder = crcTableSlice[6][remainder & 0xFF]
+                  ^ crcTableSlice[5][remainder >> 8]
+                  ^ crcTableSlice[4][message[2]]
+                  ^ crcTableSlice[3][message[3]]
+                  ^ crcTableSlice[2][message[4]]
+                  ^ crcTableSlice[1][message[5]]
+                  ^ crcTableSlice[0][message[6]]
+                  ^ crcTable[message[7]];
+    }
+
+    for (; nBytes > 0; --nBytes, ++message)
+    {
+  		remainder = crcTable[(uint8_t)(remainder ^ *message)] ^ (remainder >> 8);
+    }
+
+    return (remainder ^ FINAL_XOR_VALUE);
+
+}   /* crcSlice8() */
+#endif
@@ -34,10 +34,20 @@
 typedef uint16_t crc;
 
 /**
- * \brief Initializes crc
+ * \brief Initializes the lookup tables, must be called before crcFast(), crcSlice4() and crcSlice8()
  */
 void  crcInit(void);
 
+/**
+ * \brief Computes crc on a message bit by bit, reference for the table driven variants
+ * 
+ * \param message message for which the crc should be computed
+ * \param nBytes length of message
+ * 
+ * \return the message's crc
+ */
+crc   crcSlow(uint8_t const message[], int nBytes);
+
 /**
  * \brief Computes crc on a message
  * 
@@ -48,5 +58,55 @@ void  crcInit(void);
  */
 crc   crcFast(uint8_t const message[], int nBytes);
 
+/**
+ * \brief Starts the byte by byte computation of a crc, e.g. for bytes that arrive one at a time in an interrupt
+ * 
+ * \return remainder to be passed to crcUpdate()
+ */
+crc   crcBegin(void);
+
+/**
+ * \brief Appends one byte to a crc computation started with crcBegin()
+ * 
+ * \param remainder result of crcBegin() or of the previous crcUpdate()
+ * \param data next byte of the message
+ * 
+ * \return the new remainder
+ */
+crc   crcUpdate(crc remainder, uint8_t data);
+
+/**
+ * \brief Finishes a crc computation started with crcBegin()
+ * 
+ * \param remainder result of the last crcUpdate()
+ * 
+ * \return the message's crc, same as crcFast() on the whole message
+ */
+crc   crcEnd(crc remainder);
+
+#ifndef __AVR__
+/**
+ * \brief Computes crc on a message with slicing-by-4, same result as crcFast(). Not available
+ *        on the ATmega, where the additional tables do not fit in RAM.
+ * 
+ * \param message message for which the crc should be computed
+ * \param nBytes length of message
+ * 
+ * \return the message's crc
+ */
+crc   crcSlice4(uint8_t const message[], int nBytes);
+
+/**
+ * \brief Computes crc on a message with slicing-by-8, same result as crcFast(). Not available
+ *        on the ATmega, where the additional tables do not fit in RAM.
+ * 
+ * \param message message for which the crc should be computed
+ * \param nBytes length of message
+ * 
+ * \return the message's crc
+ */
+crc   crcSlice8(uint8_t const message[], int nBytes);
+#endif
+
 
 #endif /* _crc_h */
\ No newline at end of file
@@ -50,6 +50,7 @@ int main(void)
 	
 	watchdog_disable(); // allow for longer setup procedures
 	
+	crcInit(); // must be before spi_setup()
 	twi_init();
 	motor_setup();
 	odometer_setup();
@@ -58,7 +59,6 @@ int main(void)
 	led_setup();
 	adc_setup();
 	const bool imu_init_status = imu_setup(); // must be after twi_init()
-	crcInit();
 	tests_setup();
 	
 	
@@ -78,6 +78,7 @@ int main(void)
 		
 		if(safe_mode_flag) 
 		{
+			spi_discard_received();
             if ((PINA & 1) == 0) { // test mode
 			    tests_apply(&spi_miso_data, &spi_mosi_data);
             }
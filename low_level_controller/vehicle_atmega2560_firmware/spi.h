@@ -21,17 +21,27 @@
 
 /**
  * \brief Exchanges fixed bytes of data with the mid_level_controller via SPI.
- *        Note: This low_level_controller is the slave. Since the communication
- *              is synchronous, spi_exchange will block until the transfer is
- *              completed.
- * \param packet_send       The package to be sent to mid_level_controller.
- * \param packet_received   The received package from mid_level_controller.
+ *        Note: This low_level_controller is the slave. The bytes are transferred
+ *              in the interrupts, spi_exchange prepares the answer of the next
+ *              exchange and blocks until that exchange is completed.
+ * \param packet_send       The package to be sent to mid_level_controller in the next exchange.
+ * \param packet_received   The received package from mid_level_controller, unchanged
+ *                          if no package with a correct CRC has been received.
  * 
  * \author maczijewski
  * \ingroup low_level_controller
  */
 void spi_exchange(spi_miso_data_t *packet_send, spi_mosi_data_t *packet_received);
 
+/**
+ * \brief Drops a received package that has not been picked up by spi_exchange yet.
+ *        Called in the safe-mode, so that a command from before the timeout is not
+ *        applied once the communication resumes.
+ * 
+ * \ingroup low_level_controller
+ */
+void spi_discard_received();
+
 /**
  * \brief Sets up all relevant registers such that SPI can be used.
  * 
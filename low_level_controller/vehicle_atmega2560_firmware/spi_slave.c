@@ -0,0 +1,176 @@
+/**
+ * \file spi_slave.c
+ *
+ * \ingroup low_level_controller
+ */
+
+
+#include <stddef.h>
+#include <string.h>
+#include "util.h"
+#include "spi_slave.h"
+
+/**
+ * \brief Keeps the compiler from moving memory accesses across this point, e.g. buffer
+ *        writes behind the flag that hands the buffer over to the interrupt.
+ * \ingroup low_level_controller
+ */
+#define SPI_SLAVE_MEMORY_BARRIER() __asm__ __volatile__("" ::: "memory")
+
+#ifdef __AVR__
+#include <avr/interrupt.h>
+#define SPI_SLAVE_DISABLE_INTERRUPTS() cli()
+#define SPI_SLAVE_ENABLE_INTERRUPTS() sei()
+#else
+// Host tests call the "interrupts" from the same thread
+#define SPI_SLAVE_DISABLE_INTERRUPTS()
+#define SPI_SLAVE_ENABLE_INTERRUPTS()
+#endif
+
+/**
+ * \brief Position of the CRC in the mosi packet, it counts as zero for the CRC
+ * \ingroup low_level_controller
+ */
+#define MOSI_CRC_OFFSET offsetof(spi_mosi_data_t, CRC)
+
+
+/**
+ * \brief Looks up the byte after the current one, at the end of a frame the first byte of the next frame.
+ * \ingroup low_level_controller
+ */
+static inline uint8_t next_miso_byte(spi_slave_t *slave)
+{
+	if (slave->miso_index >= SPI_BUFFER_SIZE)
+	{
+		// start of the next frame, the mosi CRC of this frame is known by now
+		if (slave->miso_pending)
+		{
+			slave->miso_buffer ^= 1;
+			slave->miso_pending = 0;
+		}
+		slave->miso_frame = slave->miso_frames[slave->miso_buffer][slave->mosi_correct];
+		slave->miso_index = 0;
+	}
+	return slave->miso_frame[slave->miso_index++];
+}
+
+
+void spi_slave_init(spi_slave_t *slave)
+{
+	memset(slave, 0, sizeof(spi_slave_t));
+	
+	// the first lookup starts a new frame
+	slave->miso_index = SPI_BUFFER_SIZE;
+	slave->mosi_CRC = crcBegin();
+	
+	spi_miso_data_t packet_send;
+	memset(&packet_send, 0, sizeof(spi_miso_data_t));
+	spi_slave_prepare(slave, &packet_send);
+}
+
+
+void spi_slave_prepare(spi_slave_t *slave, const spi_miso_data_t *packet_send)
+{
+	// From here on the interrupt does not switch buffers, so the other buffer is not read
+	slave->miso_pending = 0;
+	SPI_SLAVE_MEMORY_BARRIER();
+	
+	uint8_t (*frames)[SPI_BUFFER_SIZE] = slave->miso_frames[slave->miso_buffer ^ 1];
+	spi_miso_data_t* packet_wrong_CRC = (spi_miso_data_t*) frames[0];
+	spi_miso_data_t* packet_correct_CRC = (spi_miso_data_t*) frames[1];
+	
+	memcpy(packet_wrong_CRC, packet_send, sizeof(spi_miso_data_t));
+	SET_BIT(packet_wrong_CRC->status_flags, 1);
+	packet_wrong_CRC->CRC = 0;
+	packet_wrong_CRC->CRC = crcFast(frames[0], sizeof(spi_miso_data_t));
+	
+	memcpy(packet_correct_CRC, packet_send, sizeof(spi_miso_data_t));
+	CLEAR_BIT(packet_correct_CRC->status_flags, 1);
+	packet_correct_CRC->CRC = 0;
+	packet_correct_CRC->CRC = crcFast(frames[1], sizeof(spi_miso_data_t));
+	
+	SPI_SLAVE_MEMORY_BARRIER();
+	slave->miso_pending = 1;
+}
+
+
+bool spi_slave_get_mosi(spi_slave_t *slave, spi_mosi_data_t *packet_received)
+{
+	bool received = false;
+	
+	SPI_SLAVE_DISABLE_INTERRUPTS();
+	if (slave->mosi_new)
+	{
+		memcpy(packet_received, slave->mosi_frames[slave->mosi_buffer ^ 1], sizeof(spi_mosi_data_t));
+		slave->mosi_new = 0;
+		received = true;
+	}
+	SPI_SLAVE_ENABLE_INTERRUPTS();
+	
+	return received;
+}
+
+
+void spi_slave_discard_mosi(spi_slave_t *slave)
+{
+	SPI_SLAVE_DISABLE_INTERRUPTS();
+	slave->mosi_new = 0;
+	memset(slave->mosi_frames[slave->mosi_buffer ^ 1], 0, sizeof(spi_mosi_data_t));
+	SPI_SLAVE_ENABLE_INTERRUPTS();
+}
+
+
+uint8_t spi_slave_select(spi_slave_t *slave)
+{
+	slave->mosi_correct = 0;
+	slave->mosi_index = 0;
+	slave->mosi_CRC = crcBegin();
+	
+	slave->miso_index = SPI_BUFFER_SIZE;
+	const uint8_t first = next_miso_byte(slave);
+	slave->miso_next = next_miso_byte(slave);
+	return first;
+}
+
+
+void spi_slave_transfer_complete(spi_slave_t *slave, uint8_t received)
+{
+	// the byte after the one that is being sent now
+	slave->miso_next = next_miso_byte(slave);
+	
+	const uint8_t index = slave->mosi_index;
+	if (index < sizeof(spi_mosi_data_t))
+	{
+		slave->mosi_frames[slave->mosi_buffer][index] = received;
+		
+		if (index == MOSI_CRC_OFFSET || index == MOSI_CRC_OFFSET + 1)
+		{
+			received = 0;
+		}
+		slave->mosi_CRC = crcUpdate(slave->mosi_CRC, received);
+		
+		if (index == sizeof(spi_mosi_data_t) - 1)
+		{
+			const spi_mosi_data_t* packet = (const spi_mosi_data_t*) slave->mosi_frames[slave->mosi_buffer];
+			if (packet->CRC == crcEnd(slave->mosi_CRC))
+			{
+				slave->mosi_correct = 1;
+				slave->mosi_buffer ^= 1;
+				slave->mosi_new = 1;
+			}
+		}
+	}
+	
+	slave->mosi_index = index + 1;
+	if (slave->mosi_index >= SPI_BUFFER_SIZE)
+	{
+		slave->mosi_index = 0;
+		slave->mosi_CRC = crcBegin();
+	}
+}
+
+
+void spi_slave_deselect(spi_slave_t *slave)
+{
+	slave->n_exchanges++;
+}
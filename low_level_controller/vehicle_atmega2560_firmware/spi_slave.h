@@ -0,0 +1,131 @@
+/**
+ * \file spi_slave.h
+ *
+ * \brief Frame handling of the SPI slave, independent of the SPI registers so that it can be
+ *        compiled and tested on a host. \link spi.c \endlink connects it to the SPI interrupts.
+ * 
+ * While the slave select is low, the mid_level_controller clocks frames of SPI_BUFFER_SIZE bytes.
+ * The interrupt after each byte only loads the next byte, which has been looked up
+ * in the previous interrupt, and feeds the received byte into a running CRC. The answer
+ * frames are prepared ahead by the main loop, CRC included, in two variants: with
+ * status flag bit 1 set ("mosi packet not received yet") and cleared. They are double
+ * buffered, so the main loop can prepare the next answer while the current one is sent.
+ * Thus no work is left for the main loop during an exchange, and the master only has to
+ * leave time for the interrupt latency between the bytes.
+ * 
+ * \ingroup low_level_controller
+ */ 
+
+
+#ifndef SPI_SLAVE_H_
+#define SPI_SLAVE_H_
+
+
+#include <stdbool.h>
+#include "spi_packets.h"
+#include "crc.h"
+
+/**
+ * \brief State of the SPI slave, shared by the interrupts and the main loop.
+ * 
+ * \ingroup low_level_controller
+ */
+typedef struct
+{
+	//! Answer frames [buffer][mosi received correctly]
+	uint8_t miso_frames[2][2][SPI_BUFFER_SIZE];
+	//! Buffer of miso_frames that is read by the interrupt, the other one is written by the main loop
+	volatile uint8_t miso_buffer;
+	//! The main loop has prepared the other buffer, it is used from the next frame on
+	volatile uint8_t miso_pending;
+	//! Frame that is currently sent
+	const uint8_t* miso_frame;
+	//! Index of the next byte of miso_frame to look up
+	uint8_t miso_index;
+	//! Byte for the next transfer, looked up ahead
+	volatile uint8_t miso_next;
+
+	//! Received packets [receive buffer, last correct packet], swapped on a correct CRC
+	uint8_t mosi_frames[2][sizeof(spi_mosi_data_t)];
+	//! Index of the receive buffer in mosi_frames
+	uint8_t mosi_buffer;
+	//! Index of the next byte to receive within the frame
+	uint8_t mosi_index;
+	//! Running CRC of the received packet
+	crc mosi_CRC;
+	//! A packet with a correct CRC has been received in the current exchange
+	uint8_t mosi_correct;
+	//! A packet with a correct CRC has been received since the last spi_slave_get_mosi()
+	volatile uint8_t mosi_new;
+
+	//! Incremented at the end of each exchange (slave select high)
+	volatile uint8_t n_exchanges;
+} spi_slave_t;
+
+/**
+ * \brief Resets the state, answers with an all zero packet until spi_slave_prepare() is called.
+ *        crcInit() must be called first.
+ * \param slave The state
+ * 
+ * \ingroup low_level_controller
+ */
+void spi_slave_init(spi_slave_t *slave);
+
+/**
+ * \brief Main loop: prepares the answer for the next exchange, including both CRC variants.
+ *        Must not be called from an interrupt.
+ * \param slave The state
+ * \param packet_send The package to be sent to mid_level_controller, status flag bit 1 is set by the slave
+ * 
+ * \ingroup low_level_controller
+ */
+void spi_slave_prepare(spi_slave_t *slave, const spi_miso_data_t *packet_send);
+
+/**
+ * \brief Main loop: copies the last packet with a correct CRC, with interrupts disabled.
+ * \param slave The state
+ * \param packet_received Output, unchanged if no new packet has been received
+ * \return true if a new packet has been received since the last call
+ * 
+ * \ingroup low_level_controller
+ */
+bool spi_slave_get_mosi(spi_slave_t *slave, spi_mosi_data_t *packet_received);
+
+/**
+ * \brief Main loop: drops the last packet with a correct CRC, with interrupts disabled. Used when the
+ *        safe-mode is entered, so that a command received before it is not applied after it.
+ * \param slave The state
+ * 
+ * \ingroup low_level_controller
+ */
+void spi_slave_discard_mosi(spi_slave_t *slave);
+
+/**
+ * \brief Interrupt, slave select low: switches to a newly prepared answer.
+ * \param slave The state
+ * \return First byte of the frame, to be written into the data register before the first clock
+ * 
+ * \ingroup low_level_controller
+ */
+uint8_t spi_slave_select(spi_slave_t *slave);
+
+/**
+ * \brief Interrupt, end of a byte transfer. The interrupt must first write miso_next into the
+ *        data register and call this function afterwards.
+ * \param slave The state
+ * \param received The received byte
+ * 
+ * \ingroup low_level_controller
+ */
+void spi_slave_transfer_complete(spi_slave_t *slave, uint8_t received);
+
+/**
+ * \brief Interrupt, slave select high: end of the exchange.
+ * \param slave The state
+ * 
+ * \ingroup low_level_controller
+ */
+void spi_slave_deselect(spi_slave_t *slave);
+
+
+#endif /* SPI_SLAVE_H_ */
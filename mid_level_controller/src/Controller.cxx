@@ -11,8 +11,8 @@
 
 using namespace std::placeholders;
 
-Controller::Controller(uint8_t _vehicle_id, std::function<uint64_t()> _get_time)
-:mpcController(_vehicle_id, std::bind(&Controller::get_stop_signals, this, _1, _2))
+Controller::Controller(uint8_t _vehicle_id, std::function<uint64_t()> _get_time, MpcParameters mpc_parameters)
+:mpcController(_vehicle_id, std::bind(&Controller::get_stop_signals, this, _1, _2), mpc_parameters)
 ,pathTrackingController(_vehicle_id)
 ,m_get_time(_get_time)
 ,topic_vehicleCommandDirect(cpm::VehicleIDFilteredTopic<VehicleCommandDirect>(cpm::get_topic<VehicleCommandDirect>("vehicleCommandDirect"), _vehicle_id))
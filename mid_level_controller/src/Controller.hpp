@@ -154,8 +154,9 @@ public:
      * \brief TODO
      * \param vehicle_id TODO
      * \param _get_time TODO
+     * \param mpc_parameters Model parameters, horizons and optimizer settings of the MpcController
      */
-    Controller(uint8_t vehicle_id, std::function<uint64_t()> _get_time);
+    Controller(uint8_t vehicle_id, std::function<uint64_t()> _get_time, MpcParameters mpc_parameters = MpcParameters());
 
     /**
      * \brief TODO
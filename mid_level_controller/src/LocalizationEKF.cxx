@@ -0,0 +1,347 @@
+#include "LocalizationEKF.hpp"
+#include <cmath>
+
+/**
+ * \file LocalizationEKF.cxx
+ * \ingroup vehicle
+ */
+
+/**
+ * \brief Invert a symmetric, positive definite 3x3 matrix using its cofactors
+ * \param A Input
+ * \param A_inv Output
+ * \ingroup vehicle
+ */
+static void invert_3x3(const double A[3][3], double A_inv[3][3])
+{
+    A_inv[0][0] = A[1][1]*A[2][2] - A[1][2]*A[2][1];
+    A_inv[0][1] = A[0][2]*A[2][1] - A[0][1]*A[2][2];
+    A_inv[0][2] = A[0][1]*A[1][2] - A[0][2]*A[1][1];
+    A_inv[1][0] = A[1][2]*A[2][0] - A[1][0]*A[2][2];
+    A_inv[1][1] = A[0][0]*A[2][2] - A[0][2]*A[2][0];
+    A_inv[1][2] = A[0][2]*A[1][0] - A[0][0]*A[1][2];
+    A_inv[2][0] = A[1][0]*A[2][1] - A[1][1]*A[2][0];
+    A_inv[2][1] = A[0][1]*A[2][0] - A[0][0]*A[2][1];
+    A_inv[2][2] = A[0][0]*A[1][1] - A[0][1]*A[1][0];
+
+    const double det = A[0][0]*A_inv[0][0] + A[0][1]*A_inv[1][0] + A[0][2]*A_inv[2][0];
+    for (int i = 0; i < 3; ++i)
+        for (int j = 0; j < 3; ++j)
+            A_inv[i][j] /= det;
+}
+
+/**
+ * \brief C = A * B for 3x3 matrices, C must not alias A or B
+ * \param A Left factor
+ * \param B Right factor
+ * \param C Output
+ * \ingroup vehicle
+ */
+static void multiply_3x3(const double A[3][3], const double B[3][3], double C[3][3])
+{
+    for (int i = 0; i < 3; ++i)
+        for (int j = 0; j < 3; ++j)
+            C[i][j] = A[i][0]*B[0][j] + A[i][1]*B[1][j] + A[i][2]*B[2][j];
+}
+
+/**
+ * \brief Motion Jacobian of one step, identity except for the coupling of the yaw into x and y.
+ * Products of these matrices stay in this form, with the coupling terms summed up.
+ * \param a d(x)/d(yaw)
+ * \param b d(y)/d(yaw)
+ * \param F Output
+ * \ingroup vehicle
+ */
+static void motion_jacobian(double a, double b, double F[3][3])
+{
+    F[0][0] = 1; F[0][1] = 0; F[0][2] = a;
+    F[1][0] = 0; F[1][1] = 1; F[1][2] = b;
+    F[2][0] = 0; F[2][1] = 0; F[2][2] = 1;
+}
+
+LocalizationEKF::LocalizationEKF()
+{
+    reset();
+}
+
+void LocalizationEKF::predict(const LocalizationEKFState& previous, LocalizationEKFState& current)
+{
+    double delta_s = current.odometer_distance - previous.odometer_distance;
+    double delta_yaw = remainder(current.imu_yaw - previous.imu_yaw, 2*M_PI);
+
+    // ignore signal discontinuities
+    if(!(-0.5 < delta_s && delta_s < 0.5)) {
+        delta_s = 0;
+    }
+
+    if(!(-1.5 < delta_yaw && delta_yaw < 1.5)) {
+        delta_yaw = 0;
+    }
+
+    // Dead reckoning, same model as in Localization
+    const double yaw = previous.x[2] + delta_yaw;
+    const double c = cos(yaw);
+    const double s = sin(yaw);
+    current.x[0] = previous.x[0] + delta_s * c;
+    current.x[1] = previous.x[1] + delta_s * s;
+    current.x[2] = remainder(yaw, 2*M_PI);
+
+    // P = F*P*F' + G*Q*G'
+    const double a = -delta_s * s;
+    const double b = delta_s * c;
+    double F[3][3];
+    motion_jacobian(a, b, F);
+
+    double FP[3][3];
+    multiply_3x3(F, previous.P, FP);
+    for (int i = 0; i < 3; ++i)
+        for (int j = 0; j < 3; ++j)
+            current.P[i][j] = FP[i][0]*F[j][0] + FP[i][1]*F[j][1] + FP[i][2]*F[j][2];
+
+    const double var_s = pow(odometer_std_relative * delta_s, 2);
+    const double var_yaw = pow(imu_yaw_std, 2) + pow(imu_yaw_std_relative * delta_yaw, 2);
+    const double G[3][2] = {{c, a}, {s, b}, {0, 1}};
+    double Q[3][3];
+    for (int i = 0; i < 3; ++i)
+        for (int j = 0; j < 3; ++j)
+            Q[i][j] = G[i][0]*G[j][0]*var_s + G[i][1]*G[j][1]*var_yaw;
+
+    for (int i = 0; i < 3; ++i)
+        for (int j = 0; j < 3; ++j)
+            current.P[i][j] += Q[i][j];
+
+    // Prefix sums, see get_process_noise_between()
+    current.jacobian_sum[0] = previous.jacobian_sum[0] + a;
+    current.jacobian_sum[1] = previous.jacobian_sum[1] + b;
+    for (int i = 0; i < 3; ++i) current.correction_sum[i] = correction_sum[i];
+
+    const double* J = current.jacobian_sum;
+    for (int i = 0; i < 3; ++i)
+        for (int j = 0; j < 3; ++j)
+            current.noise_sum[i][j] = previous.noise_sum[i][j] + Q[i][j];
+    for (int i = 0; i < 2; ++i)
+        for (int j = 0; j < 3; ++j)
+            current.noise_jacobian_sum[i][j] = previous.noise_jacobian_sum[i][j] + J[i] * Q[j][2];
+    current.noise_yaw_sum = previous.noise_yaw_sum + Q[2][2];
+    for (int i = 0; i < 2; ++i)
+    {
+        current.noise_yaw_jacobian_sum[i] = previous.noise_yaw_jacobian_sum[i] + Q[2][2] * J[i];
+        for (int j = 0; j < 2; ++j)
+            current.noise_yaw_jacobian_sq_sum[i][j] = previous.noise_yaw_jacobian_sq_sum[i][j] + Q[2][2] * J[i] * J[j];
+    }
+}
+
+void LocalizationEKF::get_process_noise_between(const LocalizationEKFState& state_k, const LocalizationEKFState& state_n, double Q_nk[3][3])
+{
+    // Q_nk = sum_{i=k+1..n} F_ni * Q_i * F_ni', with F_ni = I + D_i * e3' and D_i = J_n - J_i.
+    // Expanding the product leaves terms that are linear in the prefix sums stored in each step.
+    const double* J_n = state_n.jacobian_sum;
+
+    for (int i = 0; i < 3; ++i)
+        for (int j = 0; j < 3; ++j)
+            Q_nk[i][j] = state_n.noise_sum[i][j] - state_k.noise_sum[i][j];
+
+    // sum D_i * (Q_i * e3)' and its transpose
+    double noise_yaw_column[3];
+    for (int j = 0; j < 3; ++j) noise_yaw_column[j] = Q_nk[j][2];
+    for (int i = 0; i < 2; ++i)
+    {
+        for (int j = 0; j < 3; ++j)
+        {
+            const double T = J_n[i] * noise_yaw_column[j]
+                - (state_n.noise_jacobian_sum[i][j] - state_k.noise_jacobian_sum[i][j]);
+            Q_nk[i][j] += T;
+            Q_nk[j][i] += T;
+        }
+    }
+
+    // sum Q_i(3,3) * D_i * D_i'
+    const double delta_yaw_sum = state_n.noise_yaw_sum - state_k.noise_yaw_sum;
+    double delta_yaw_jacobian_sum[2];
+    for (int i = 0; i < 2; ++i)
+        delta_yaw_jacobian_sum[i] = state_n.noise_yaw_jacobian_sum[i] - state_k.noise_yaw_jacobian_sum[i];
+    for (int i = 0; i < 2; ++i)
+    {
+        for (int j = 0; j < 2; ++j)
+        {
+            Q_nk[i][j] += J_n[i] * J_n[j] * delta_yaw_sum
+                - J_n[i] * delta_yaw_jacobian_sum[j]
+                - delta_yaw_jacobian_sum[i] * J_n[j]
+                + (state_n.noise_yaw_jacobian_sq_sum[i][j] - state_k.noise_yaw_jacobian_sq_sum[i][j]);
+        }
+    }
+}
+
+int LocalizationEKF::find_state_index(uint64_t t_now, uint64_t period, uint64_t t_observation)
+{
+    if(t_observation > t_now || period == 0) return -1;
+
+    // Direct guess, assuming no periods were skipped
+    uint64_t steps_back = (t_now - t_observation + period - 1) / period;
+    if(steps_back > LOCALIZATION_BUFFER_SIZE-1) steps_back = LOCALIZATION_BUFFER_SIZE-1;
+    size_t i = LOCALIZATION_BUFFER_SIZE-1 - steps_back;
+
+    // Skipped periods move the step closer to the newest one, usually not more than one or two
+    while(i < LOCALIZATION_BUFFER_SIZE-1 && get_state(i).t + period <= t_observation) i++;
+    while(i > 0 && get_state(i).t > t_observation) i--;
+
+    const LocalizationEKFState& state_i = get_state(i);
+    if(state_i.t <= t_observation && t_observation < state_i.t + period)
+    {
+        return static_cast<int>(i);
+    }
+    return -1;
+}
+
+void LocalizationEKF::fuse_observation(size_t index, const VehicleObservation& observation)
+{
+    LocalizationEKFState& state_k = get_state(index);
+    LocalizationEKFState& state_n = get_state(LOCALIZATION_BUFFER_SIZE-1);
+
+    // Pose at the observation time, including the corrections that were applied after it was stored
+    const double delta_yaw_since = correction_sum[2] - state_k.correction_sum[2];
+    double x_k[3];
+    x_k[0] = state_k.x[0] + (correction_sum[0] - state_k.correction_sum[0]) + state_k.jacobian_sum[0] * delta_yaw_since;
+    x_k[1] = state_k.x[1] + (correction_sum[1] - state_k.correction_sum[1]) + state_k.jacobian_sum[1] * delta_yaw_since;
+    x_k[2] = state_k.x[2] + delta_yaw_since;
+
+    double innovation[3];
+    innovation[0] = observation.pose().x() - x_k[0];
+    innovation[1] = observation.pose().y() - x_k[1];
+    innovation[2] = remainder(observation.pose().yaw() - x_k[2], 2*M_PI);
+
+    // Covariance at step k, consistent with all observations fused so far (which are older than step k):
+    // P_n = F_nk * P_k * F_nk' + Q_nk  =>  P_k = F_nk^-1 * (P_n - Q_nk) * F_nk^-T
+    double Q_nk[3][3];
+    get_process_noise_between(state_k, state_n, Q_nk);
+    double P_nk[3][3];
+    for (int i = 0; i < 3; ++i)
+        for (int j = 0; j < 3; ++j)
+            P_nk[i][j] = state_n.P[i][j] - Q_nk[i][j];
+
+    double F_nk_inv[3][3];
+    motion_jacobian(
+        state_k.jacobian_sum[0] - state_n.jacobian_sum[0],
+        state_k.jacobian_sum[1] - state_n.jacobian_sum[1],
+        F_nk_inv
+    );
+
+    // Cross covariance between the newest step and step k: C = F_nk * P_k = (P_n - Q_nk) * F_nk^-T
+    double C[3][3];
+    for (int i = 0; i < 3; ++i)
+        for (int j = 0; j < 3; ++j)
+            C[i][j] = P_nk[i][0]*F_nk_inv[j][0] + P_nk[i][1]*F_nk_inv[j][1] + P_nk[i][2]*F_nk_inv[j][2];
+    double P_k[3][3];
+    multiply_3x3(F_nk_inv, C, P_k);
+
+    // Can only happen after numerical problems or out-of-order observations, do not trust the result then
+    if(!(P_k[0][0] > 0 && P_k[1][1] > 0 && P_k[2][2] > 0))
+    {
+        state_k.has_valid_observation = true;
+        return;
+    }
+
+    // Innovation covariance, the IPS measures the full pose (H = I)
+    double S[3][3];
+    for (int i = 0; i < 3; ++i)
+        for (int j = 0; j < 3; ++j)
+            S[i][j] = P_k[i][j];
+    S[0][0] += pow(ips_position_std, 2);
+    S[1][1] += pow(ips_position_std, 2);
+    S[2][2] += pow(ips_yaw_std, 2);
+    double S_inv[3][3];
+    invert_3x3(S, S_inv);
+
+    // Gain for the newest step
+    double K[3][3];
+    multiply_3x3(C, S_inv, K);
+
+    double delta[3];
+    for (int i = 0; i < 3; ++i)
+        delta[i] = K[i][0]*innovation[0] + K[i][1]*innovation[1] + K[i][2]*innovation[2];
+
+    // P_n = P_n - K * C'
+    for (int i = 0; i < 3; ++i)
+        for (int j = 0; j < 3; ++j)
+            state_n.P[i][j] -= K[i][0]*C[j][0] + K[i][1]*C[j][1] + K[i][2]*C[j][2];
+    for (int i = 0; i < 3; ++i)
+        for (int j = i+1; j < 3; ++j)
+            state_n.P[i][j] = state_n.P[j][i] = 0.5 * (state_n.P[i][j] + state_n.P[j][i]);
+
+    state_n.x[0] += delta[0];
+    state_n.x[1] += delta[1];
+    state_n.x[2] = remainder(state_n.x[2] + delta[2], 2*M_PI);
+
+    // Remember the correction, so that older steps can be corrected in O(1) on later observations
+    correction_sum[0] += delta[0] - state_n.jacobian_sum[0] * delta[2];
+    correction_sum[1] += delta[1] - state_n.jacobian_sum[1] * delta[2];
+    correction_sum[2] += delta[2];
+    for (int i = 0; i < 3; ++i) state_n.correction_sum[i] = correction_sum[i];
+
+    state_k.has_valid_observation = true;
+}
+
+Pose2D LocalizationEKF::update(
+    uint64_t t_now,
+    uint64_t period,
+    VehicleState vehicleState,
+    VehicleObservation sample_vehicleObservation,
+    uint64_t sample_vehicleObservation_age
+)
+{
+    // Save new sensor data, predict current step
+    {
+        LocalizationEKFState localizationStateNew;
+        localizationStateNew.t = t_now;
+        localizationStateNew.imu_yaw = vehicleState.imu_yaw();
+        localizationStateNew.odometer_distance = vehicleState.odometer_distance();
+        write_next_state(localizationStateNew);
+
+        predict(get_state(LOCALIZATION_BUFFER_SIZE-2), get_state(LOCALIZATION_BUFFER_SIZE-1));
+    }
+
+    // Check for new observation, fuse it at the time it was taken
+    if(sample_vehicleObservation_age < 10000000000ull)
+    {
+        int index = find_state_index(
+            t_now,
+            period,
+            sample_vehicleObservation.header().create_stamp().nanoseconds()
+        );
+
+        // skip it if we have already done this on a previous update()
+        if(index >= 0 && !get_state(index).has_valid_observation)
+        {
+            fuse_observation(index, sample_vehicleObservation);
+        }
+    }
+
+    // output latest pose
+    const LocalizationEKFState& newest = get_state(LOCALIZATION_BUFFER_SIZE-1);
+    return Pose2D(newest.x[0], newest.x[1], newest.x[2]);
+}
+
+void LocalizationEKF::reset()
+{
+    for (size_t i = 0; i < LOCALIZATION_BUFFER_SIZE; ++i)
+    {
+        LocalizationEKFState& state = state_buffer[i];
+        for (int j = 0; j < 3; ++j)
+        {
+            state.x[j] = 0;
+            state.correction_sum[j] = correction_sum[j];
+            for (int k = 0; k < 3; ++k) state.P[j][k] = 0;
+        }
+        state.P[0][0] = pow(initial_position_std, 2);
+        state.P[1][1] = pow(initial_position_std, 2);
+        state.P[2][2] = pow(initial_yaw_std, 2);
+    }
+}
+
+void LocalizationEKF::get_covariance(double P_out[3][3])
+{
+    const LocalizationEKFState& newest = get_state(LOCALIZATION_BUFFER_SIZE-1);
+    for (int i = 0; i < 3; ++i)
+        for (int j = 0; j < 3; ++j)
+            P_out[i][j] = newest.P[i][j];
+}
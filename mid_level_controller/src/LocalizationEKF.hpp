@@ -0,0 +1,172 @@
+#pragma once
+
+#include "VehicleState.hpp"
+#include "VehicleObservation.hpp"
+#include "Localization.hpp"
+#include <cassert>
+
+/**
+ * \struct LocalizationEKFState
+ * \brief One step of the EKF history, used to fuse delayed IPS observations
+ * \ingroup vehicle
+ */
+struct LocalizationEKFState
+{
+    //! Time of the step in nanoseconds
+    uint64_t t = 0;
+    //! Local sensor data
+    double imu_yaw = 0;
+    //! Local sensor data
+    double odometer_distance = 0;
+    //! True if an IPS observation was already fused for this step
+    bool has_valid_observation = false;
+    //! Pose estimate [x, y, yaw] at this step, including all corrections known at the time it was written
+    double x[3] = {0, 0, 0};
+    //! Pose covariance at this step, as it was when the step was written
+    double P[3][3] = {{0, 0, 0}, {0, 0, 0}, {0, 0, 0}};
+    //! Prefix sums J of the motion Jacobian entries d(x)/d(yaw) and d(y)/d(yaw) up to this step
+    double jacobian_sum[2] = {0, 0};
+    //! Value of the correction accumulators when this step was written
+    double correction_sum[3] = {0, 0, 0};
+
+    //! Prefix sum of the process noise Q
+    double noise_sum[3][3] = {{0, 0, 0}, {0, 0, 0}, {0, 0, 0}};
+    //! Prefix sum of J * (third column of Q)'
+    double noise_jacobian_sum[2][3] = {{0, 0, 0}, {0, 0, 0}};
+    //! Prefix sum of the yaw process noise Q(3,3)
+    double noise_yaw_sum = 0;
+    //! Prefix sum of Q(3,3) * J
+    double noise_yaw_jacobian_sum[2] = {0, 0};
+    //! Prefix sum of Q(3,3) * J * J'
+    double noise_yaw_jacobian_sq_sum[2][2] = {{0, 0}, {0, 0}};
+};
+
+/**
+ * \class LocalizationEKF
+ * \brief Extended Kalman filter for the vehicle pose with bounded cost for delayed IPS observations.
+ *
+ * Dead reckoning (odometer + IMU yaw) is used for the prediction, the IPS pose for the correction.
+ * Unlike Localization, a delayed observation is not handled by recomputing every step since
+ * the observation time. Instead, a single retrodiction step is used: The observation is fused
+ * with the state at its time and the correction is carried to the current step using the
+ * cross covariance. The motion Jacobians of this model only couple yaw into x/y, so the product of
+ * all Jacobians between two steps reduces to a difference of prefix sums (J). The same holds for the
+ * process noise accumulated between two steps and for corrections that happened after a step was
+ * stored. Therefore, the cost per update is constant and independent of the IPS latency.
+ * \ingroup vehicle
+ */
+class LocalizationEKF
+{
+    /**
+     * \brief The filter saves a history of its state (a fixed lag),
+     * so that delayed observations can be fused at the time they were taken.
+     */
+    LocalizationEKFState state_buffer[LOCALIZATION_BUFFER_SIZE];
+    //! Index of oldest element, index of next overwrite
+    size_t state_buffer_index = 0;
+
+    //! Sum of all applied corrections in x, compensated by the Jacobian prefix sums, see update()
+    double correction_sum[3] = {0, 0, 0};
+
+    //! Std. deviation of the odometer, relative to the driven distance
+    static constexpr double odometer_std_relative = 0.1;
+    //! Std. deviation of the IMU yaw increment per step in rad
+    static constexpr double imu_yaw_std = 0.002;
+    //! Std. deviation of the IMU yaw increment, relative to the yaw increment
+    static constexpr double imu_yaw_std_relative = 0.02;
+    //! Std. deviation of the IPS position in m
+    static constexpr double ips_position_std = 0.003;
+    //! Std. deviation of the IPS yaw in rad
+    static constexpr double ips_yaw_std = 0.01;
+    //! Initial std. deviation of the position after a reset in m
+    static constexpr double initial_position_std = 10.0;
+    //! Initial std. deviation of the yaw after a reset in rad
+    static constexpr double initial_yaw_std = 4.0;
+
+    /**
+     * \brief Access to the history, 0 is the oldest, LOCALIZATION_BUFFER_SIZE-1 the newest step
+     * \param i Index relative to the oldest element
+     */
+    LocalizationEKFState& get_state(size_t i)
+    {
+        assert(i < LOCALIZATION_BUFFER_SIZE);
+        return state_buffer[(i + state_buffer_index) % LOCALIZATION_BUFFER_SIZE];
+    }
+
+    /**
+     * \brief Append a step to the history, overwrites the oldest one
+     * \param state The new step
+     */
+    void write_next_state(const LocalizationEKFState& state)
+    {
+        state_buffer[state_buffer_index] = state;
+        state_buffer_index = (state_buffer_index+1) % LOCALIZATION_BUFFER_SIZE;
+    }
+
+    /**
+     * \brief EKF prediction with the odometer and IMU data of the current step
+     * \param previous The previous step
+     * \param current The current step, x and P are overwritten
+     */
+    void predict(const LocalizationEKFState& previous, LocalizationEKFState& current);
+
+    /**
+     * \brief Process noise accumulated from step k to step n, propagated to step n
+     * \param state_k Older step
+     * \param state_n Newer step
+     * \param Q_nk Output
+     */
+    void get_process_noise_between(const LocalizationEKFState& state_k, const LocalizationEKFState& state_n, double Q_nk[3][3]);
+
+    /**
+     * \brief Find the history index of the step that contains the given time in [t, t + period).
+     * Returns -1 if it is not in the history (anymore).
+     * \param t_now Time of the newest step
+     * \param period Period of update()
+     * \param t_observation Creation time of the observation
+     */
+    int find_state_index(uint64_t t_now, uint64_t period, uint64_t t_observation);
+
+    /**
+     * \brief Fuse an observation that belongs to a (past) step into the newest step
+     * \param index History index of the step the observation belongs to
+     * \param observation The IPS observation
+     */
+    void fuse_observation(size_t index, const VehicleObservation& observation);
+
+public:
+    /**
+     * \brief Constructor, starts with an unknown pose
+     */
+    LocalizationEKF();
+
+    /**
+     * \brief Same interface and assumptions as Localization::update:
+     * The 'vehicleState' always has new sensor data.
+     * The 'sample_vehicleObservation' update may be delayed and intermittent.
+     * If no new observation is available, a repeat of the most recent one is expected.
+     * \param t_now Current time in nanoseconds
+     * \param period Period of the calls in nanoseconds
+     * \param vehicleState Contains the current odometer and IMU data
+     * \param sample_vehicleObservation Most recent IPS observation
+     * \param sample_vehicleObservation_age Age of the IPS observation in nanoseconds
+     */
+    Pose2D update(
+        uint64_t t_now,
+        uint64_t period,
+        VehicleState vehicleState,
+        VehicleObservation sample_vehicleObservation,
+        uint64_t sample_vehicleObservation_age
+    );
+
+    /**
+     * \brief Forget the pose, the next IPS observation determines it again
+     */
+    void reset();
+
+    /**
+     * \brief Covariance of the current pose estimate [x, y, yaw]
+     * \param P_out Output
+     */
+    void get_covariance(double P_out[3][3]);
+};
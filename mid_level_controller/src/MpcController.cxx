@@ -1,7 +1,9 @@
 #include "MpcController.hpp"
+#include <algorithm>
 #include <cassert>
 #include <iostream>
 #include <sstream>
+#include <stdexcept>
 #include "cpm/Logging.hpp"
 #include "cpm/TimeMeasurement.hpp"
 #include "TrajectoryInterpolation.hpp"
@@ -11,12 +13,29 @@
  * \ingroup vehicle
  */
 
-MpcController::MpcController(uint8_t _vehicle_id, std::function<void(double&, double&)> _stop_vehicle)
+MpcController::MpcController(uint8_t _vehicle_id, std::function<void(double&, double&)> _stop_vehicle, MpcParameters _parameters)
 :
     writer_Visualization("visualization")
     ,vehicle_id(_vehicle_id)
+    ,parameters(_parameters)
+    ,MPC_prediction_steps(_parameters.prediction_steps)
+    ,MPC_control_steps(_parameters.control_steps)
+    ,dt_MPC(_parameters.dt)
+    ,dynamics_parameters(_parameters.dynamics_parameters)
     ,stop_vehicle(_stop_vehicle)
 {
+    std::string parameters_error;
+    if(!parameters.is_valid(parameters_error))
+    {
+        throw std::invalid_argument("MpcController: " + parameters_error);
+    }
+
+    reference_trajectory_x.reserve(MPC_MAX_PREDICTION_STEPS);
+    reference_trajectory_y.reserve(MPC_MAX_PREDICTION_STEPS);
+
+    // The generated code is fixed to its horizons and time step, see MpcParameters
+    bool use_casadi_mpc_fn = (dt_MPC == MpcParameters().dt);
+
     const casadi_int n_in = casadi_mpc_fn_n_in();
     const casadi_int n_out = casadi_mpc_fn_n_out();
 
@@ -67,9 +86,30 @@ MpcController::MpcController(uint8_t _vehicle_id, std::function<void(double&, do
             name = casadi_mpc_fn_name_out(i_var - n_in);
         }
 
+        // Buffers for the horizons in parameters
+        casadi_int n_rows_buffer = n_rows;
+        if (name == "var_u" || name == "var_momentum" || name == "var_u_next" || name == "var_momentum_next")
+        {
+            n_rows_buffer = static_cast<casadi_int>(MPC_control_steps);
+        }
+        else if (name == "var_reference_trajectory_x" || name == "var_reference_trajectory_y"
+            || name == "trajectory_x" || name == "trajectory_y")
+        {
+            n_rows_buffer = static_cast<casadi_int>(MPC_prediction_steps);
+        }
+        use_casadi_mpc_fn = use_casadi_mpc_fn && (n_rows_buffer == n_rows);
+
+        // The trajectory buffers are sized for the largest supported horizon
+        casadi_int n_rows_allocated = n_rows_buffer;
+        if (name == "var_reference_trajectory_x" || name == "var_reference_trajectory_y"
+            || name == "trajectory_x" || name == "trajectory_y")
+        {
+            n_rows_allocated = std::max(n_rows, static_cast<casadi_int>(MPC_MAX_PREDICTION_STEPS));
+        }
+
         assert(casadi_vars.count(name) == 0);
-        casadi_vars[name] = std::vector<casadi_real>(n_rows * n_cols, 1e-12); // Can not be zero exactly, because the CadADi gradient is wrong at zero
-        casadi_vars_size[name] = std::array<casadi_int, 2>{{n_rows, n_cols}};
+        casadi_vars[name] = std::vector<casadi_real>(n_rows_allocated * n_cols, 1e-12); // Can not be zero exactly, because the CadADi gradient is wrong at zero
+        casadi_vars_size[name] = std::array<casadi_int, 2>{{n_rows_buffer, n_cols}};
         casadi_real* p_buffer = casadi_vars[name].data();
 
         if (i_var < n_in) 
@@ -143,6 +183,21 @@ MpcController::MpcController(uint8_t _vehicle_id, std::function<void(double&, do
 
     assert(casadi_vars_size["var_u_next"][0] == static_cast<casadi_int>(MPC_control_steps));
     assert(casadi_vars_size["var_u_next"][1] == 3);
+
+    if (use_casadi_mpc_fn)
+    {
+        mpc_fn = [](const casadi_real** arg, casadi_real** res) {
+            casadi_mpc_fn(arg, res, nullptr, nullptr, 0);
+        };
+    }
+    else
+    {
+        mpc_fn = MpcGradientStep(MPC_prediction_steps, MPC_control_steps, dt_MPC);
+        cpm::Logging::Instance().write(
+            3,
+            "MPC: %d prediction steps, %d control steps, dt %f differ from casadi_mpc_fn, using MpcGradientStep.",
+            static_cast<int>(MPC_prediction_steps), static_cast<int>(MPC_control_steps), dt_MPC);
+    }
 }
 
 void MpcController::update(
@@ -157,14 +212,11 @@ void MpcController::update(
 
     const VehicleState vehicleState_predicted_start = delay_compensation_prediction(vehicleState);
 
-    std::vector<double> mpc_reference_trajectory_x;
-    std::vector<double> mpc_reference_trajectory_y;
-
     if(!interpolate_reference_trajectory(
         t_now, 
         commandTrajectory,
-        mpc_reference_trajectory_x,
-        mpc_reference_trajectory_y
+        reference_trajectory_x,
+        reference_trajectory_y
     ))
     {
         reset_optimizer();
@@ -172,13 +224,13 @@ void MpcController::update(
         return;
     }
 
-    assert(mpc_reference_trajectory_x.size() == MPC_prediction_steps);
-    assert(mpc_reference_trajectory_y.size() == MPC_prediction_steps);
+    assert(reference_trajectory_x.size() == MPC_prediction_steps);
+    assert(reference_trajectory_y.size() == MPC_prediction_steps);
 
     optimize_control_inputs(
         vehicleState_predicted_start,
-        mpc_reference_trajectory_x,
-        mpc_reference_trajectory_y,
+        reference_trajectory_x,
+        reference_trajectory_y,
         out_motor_throttle, 
         out_steering_servo
     );
@@ -204,7 +256,7 @@ void MpcController::optimize_control_inputs(
 )
 {
     cpm::TimeMeasurement::Instance().start("mpc_casadi");
-    for (int i = 0; i < 20; ++i)
+    for (int i = 0; i < parameters.iterations; ++i)
     {
         casadi_vars["var_x0"][0] = vehicleState_predicted_start.pose().x();
         casadi_vars["var_x0"][1] = vehicleState_predicted_start.pose().y();
@@ -238,14 +290,13 @@ void MpcController::optimize_control_inputs(
             casadi_vars["var_reference_trajectory_y"][j] = mpc_reference_trajectory_y[j];
         }
 
-        casadi_vars["var_learning_rate"][0] = 0.4;
-        casadi_vars["var_momentum_rate"][0] = 0.6;
+        casadi_vars["var_learning_rate"][0] = parameters.learning_rate;
+        casadi_vars["var_momentum_rate"][0] = parameters.momentum_rate;
         
         // Run casadi
-        casadi_mpc_fn(
+        mpc_fn(
             (const casadi_real**)(casadi_arguments.data()), 
-            casadi_results.data(), 
-            nullptr, nullptr, 0);
+            casadi_results.data());
 
     }
     cpm::TimeMeasurement::Instance().stop("mpc_casadi");
@@ -253,7 +304,8 @@ void MpcController::optimize_control_inputs(
     //cpm::Logging::Instance().write("objective value %f ",casadi_vars["objective"][0]);
 
     cpm::TimeMeasurement::Instance().start("mpc_opt_vis");
-    if(casadi_vars["objective"][0] < 1.5)
+    const double max_objective = MPC_MAX_OBJECTIVE_PER_PREDICTION_STEP * MPC_prediction_steps;
+    if(casadi_vars["objective"][0] < max_objective)
     {
         out_motor_throttle = fmin(1.0,fmax(-1.0,casadi_vars["var_u_next"][0]));
         out_steering_servo = fmin(1.0,fmax(-1.0,casadi_vars["var_u_next"][MPC_control_steps]));
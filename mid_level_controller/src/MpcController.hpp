@@ -1,10 +1,13 @@
 #pragma once
 #include "casadi_mpc_fn.h"
+#include <functional>
 #include <map>
 #include <string>
 #include <array>
 #include <vector>
 #include "VehicleModel.hpp"
+#include "MpcParameters.hpp"
+#include "MpcGradientStep.hpp"
 #include "VehicleCommandTrajectory.hpp"
 #include "VehicleState.hpp"
 #include "Visualization.hpp"
@@ -17,10 +20,19 @@
  * optimization are developed in Matlab with CasADi.
  * Here we just call the resulting generated code.
  * See tools/vehicle_dynamics_identification_and_mpc/MpcController.m
+ * For horizons other than the generated ones, the same function
+ * is evaluated by MpcGradientStep.
  */
 
 #define MPC_DELAY_COMPENSATION_STEPS (3)
 
+/**
+ * \brief Largest accepted MPC objective per prediction step, the objective sums the tracking error over the
+ * prediction horizon. 1.5 for the 6 steps of the generated code.
+ * \ingroup vehicle
+ */
+#define MPC_MAX_OBJECTIVE_PER_PREDICTION_STEP (0.25)
+
 /**
  * \class MpcController
  * \brief TODO
@@ -43,22 +55,31 @@ class MpcController
     //! TODO
     std::vector<casadi_real*> casadi_results;
 
-    //! TODO
-    const size_t MPC_prediction_steps = 6;
-    //! TODO
-    const size_t MPC_control_steps = 3;
+    //! Model parameters, horizons and optimizer settings
+    const MpcParameters parameters;
+    //! Number of predicted states, from parameters
+    const size_t MPC_prediction_steps;
+    //! Number of distinct inputs over the prediction horizon, from parameters
+    const size_t MPC_control_steps;
     //! The period in which update() is called
     const double dt_control_loop = 0.02; 
-    //! The MPC prediction time step
-    const double dt_MPC = 0.05;
+    //! The MPC prediction time step, from parameters
+    const double dt_MPC;
 
+    //! Parameters of the vehicle dynamics, from parameters
+    const std::vector<double> dynamics_parameters;
 
-    //! TODO load parameters via DDS parameters
-    std::vector<double> dynamics_parameters = { 1.004582, -0.142938, 0.195236, 3.560576, -2.190728, -9.726828, 2.515565, 1.321199, 0.032208, -0.012863 };
+    //! Evaluates one gradient step, casadi_mpc_fn() if the horizons match the generated code, else MpcGradientStep
+    std::function<void(const casadi_real**, casadi_real**)> mpc_fn;
 
     //! TODO
     double battery_voltage_lowpass_filtered = 8;
 
+    //! Reference trajectory of the current update(), allocated once for MPC_MAX_PREDICTION_STEPS
+    std::vector<double> reference_trajectory_x;
+    //! Reference trajectory of the current update(), allocated once for MPC_MAX_PREDICTION_STEPS
+    std::vector<double> reference_trajectory_y;
+
 
     //! Holds the N most recent outputs/commands. oldest first, newest last
     double motor_output_history[MPC_DELAY_COMPENSATION_STEPS];
@@ -125,8 +146,9 @@ public:
      * \brief TODO
      * \param _vehicle_id TODO
      * \param _stop_vehicle TODO
+     * \param _parameters Model parameters, horizons and optimizer settings, must be valid (MpcParameters::is_valid)
      */
-    MpcController(uint8_t _vehicle_id, std::function<void(double&, double&)> _stop_vehicle);
+    MpcController(uint8_t _vehicle_id, std::function<void(double&, double&)> _stop_vehicle, MpcParameters _parameters = MpcParameters());
 
     /**
      * \brief TODO
@@ -0,0 +1,158 @@
+#include "MpcGradientStep.hpp"
+#include <cassert>
+#include <cmath>
+
+/**
+ * \file MpcGradientStep.cxx
+ * \ingroup vehicle
+ */
+
+MpcGradientStep::MpcGradientStep(size_t _prediction_steps, size_t _control_steps, double _dt)
+:prediction_steps(_prediction_steps)
+,control_steps(_control_steps)
+,dt(_dt)
+{
+    assert(prediction_steps >= 1);
+    assert(control_steps >= 1 && control_steps <= prediction_steps);
+
+    // As in MpcController.m: the middle and the last point are weighted more
+    reference_weight.assign(prediction_steps, 1.0);
+    reference_weight[(prediction_steps + 1) / 2 - 1] = 2;
+    reference_weight[prediction_steps - 1] = 3;
+
+    // As in MpcController.m: u_idx = ceil((1:Hp)/Hp*Hu)
+    input_index.resize(prediction_steps);
+    for (size_t k = 0; k < prediction_steps; ++k)
+    {
+        input_index[k] = ((k + 1) * control_steps + prediction_steps - 1) / prediction_steps - 1;
+    }
+
+    states.resize(4 * (prediction_steps + 1));
+}
+
+void MpcGradientStep::operator()(const casadi_real** arg, casadi_real** res) const
+{
+    const casadi_real* x0 = arg[0];
+    const casadi_real* u0 = arg[1];
+    const casadi_real* u = arg[2];
+    const casadi_real* momentum = arg[3];
+    const casadi_real* p = arg[4];
+    const casadi_real* reference_x = arg[5];
+    const casadi_real* reference_y = arg[6];
+    const casadi_real learning_rate = arg[7][0];
+    const casadi_real momentum_rate = arg[8][0];
+
+    casadi_real* trajectory_x = res[0];
+    casadi_real* trajectory_y = res[1];
+    casadi_real* objective = res[2];
+    casadi_real* momentum_next = res[3];
+    casadi_real* u_next = res[4];
+
+    const size_t Hu = control_steps;
+
+    // Forward: predicted states, see vehicle_dynamics.m
+    for (size_t i = 0; i < 4; ++i) states[i] = x0[i];
+    double J = 0;
+    for (size_t k = 0; k < prediction_steps; ++k)
+    {
+        const double* x = &states[4 * k];
+        double* x_next = &states[4 * (k + 1)];
+        const size_t j = input_index[k];
+        const double f = u[j];
+        const double delta = u[Hu + j] + p[8];
+        const double V = u[2 * Hu + j];
+
+        const double speed_factor = p[0] * x[3] * (1 + p[1] * delta * delta);
+        const double angle = x[2] + p[2] * delta + p[9];
+        const double sign_f = (f < 0) ? -1.0 : ((f > 0) ? 1.0 : f);
+
+        x_next[0] = x[0] + dt * speed_factor * cos(angle);
+        x_next[1] = x[1] + dt * speed_factor * sin(angle);
+        x_next[2] = x[2] + dt * p[3] * x[3] * delta;
+        x_next[3] = x[3] + dt * (p[4] * x[3] + (p[5] + p[6] * V) * sign_f * pow(fabs(f), p[7]));
+
+        trajectory_x[k] = x_next[0];
+        trajectory_y[k] = x_next[1];
+
+        const double error_x = reference_weight[k] * (x_next[0] - reference_x[k]);
+        const double error_y = reference_weight[k] * (x_next[1] - reference_y[k]);
+        J += error_x * error_x + error_y * error_y;
+    }
+
+    // Input rate penalty, the gradient is accumulated in momentum_next (-gradient, see below)
+    const double rate_weight[2] = {0.50, 0.01};
+    for (size_t c = 0; c < 2; ++c)
+    {
+        for (size_t j = 0; j < Hu; ++j)
+        {
+            const double previous = (j == 0) ? u0[c] : u[c * Hu + j - 1];
+            const double difference = u[c * Hu + j] - previous;
+            J += rate_weight[c] * difference * difference;
+
+            momentum_next[c * Hu + j] = 2 * rate_weight[c] * difference;
+            if (j > 0) momentum_next[c * Hu + j - 1] -= 2 * rate_weight[c] * difference;
+        }
+    }
+    *objective = J;
+
+    // Backward: adjoint of the states, gradient of the inputs
+    double adjoint[4] = {0, 0, 0, 0};
+    for (size_t k = prediction_steps; k-- > 0;)
+    {
+        const double* x = &states[4 * k];
+        const double* x_next = &states[4 * (k + 1)];
+
+        // Tracking error of x_next
+        const double w2 = 2 * reference_weight[k] * reference_weight[k];
+        adjoint[0] += w2 * (x_next[0] - reference_x[k]);
+        adjoint[1] += w2 * (x_next[1] - reference_y[k]);
+
+        const size_t j = input_index[k];
+        const double f = u[j];
+        const double delta = u[Hu + j] + p[8];
+        const double V = u[2 * Hu + j];
+
+        const double delta_factor = 1 + p[1] * delta * delta;
+        const double speed_factor = p[0] * x[3] * delta_factor;
+        const double angle = x[2] + p[2] * delta + p[9];
+        const double c = cos(angle);
+        const double s = sin(angle);
+        const double sign_f = (f < 0) ? -1.0 : ((f > 0) ? 1.0 : f);
+
+        // Partial derivatives of the step x_next = x + dt * dynamics(x, u)
+        const double d_px_d_yaw = -dt * speed_factor * s;
+        const double d_px_d_speed = dt * p[0] * delta_factor * c;
+        const double d_px_d_delta = dt * (p[0] * x[3] * 2 * p[1] * delta * c - speed_factor * s * p[2]);
+        const double d_py_d_yaw = dt * speed_factor * c;
+        const double d_py_d_speed = dt * p[0] * delta_factor * s;
+        const double d_py_d_delta = dt * (p[0] * x[3] * 2 * p[1] * delta * s + speed_factor * c * p[2]);
+        const double d_yaw_d_speed = dt * p[3] * delta;
+        const double d_yaw_d_delta = dt * p[3] * x[3];
+        const double d_speed_d_speed = dt * p[4];
+        // d/df sign(f)*|f|^p8 = sign(f)^2 * p8 * |f|^(p8-1), zero at f = 0 as in CasADi
+        const double d_speed_d_f = dt * (p[5] + p[6] * V) * sign_f * sign_f * p[7] * pow(fabs(f), p[7] - 1);
+
+        momentum_next[j] += adjoint[3] * d_speed_d_f;
+        momentum_next[Hu + j] += adjoint[0] * d_px_d_delta + adjoint[1] * d_py_d_delta + adjoint[2] * d_yaw_d_delta;
+
+        const double adjoint_yaw = adjoint[2] + adjoint[0] * d_px_d_yaw + adjoint[1] * d_py_d_yaw;
+        const double adjoint_speed = adjoint[3] + adjoint[0] * d_px_d_speed + adjoint[1] * d_py_d_speed
+            + adjoint[2] * d_yaw_d_speed + adjoint[3] * d_speed_d_speed;
+        adjoint[2] = adjoint_yaw;
+        adjoint[3] = adjoint_speed;
+    }
+
+    // momentum_next holds the gradient so far: step = -gradient, the voltage column has no step
+    for (size_t i = 0; i < 2 * Hu; ++i)
+    {
+        momentum_next[i] = momentum_rate * momentum[i] - momentum_next[i];
+    }
+    for (size_t i = 2 * Hu; i < 3 * Hu; ++i)
+    {
+        momentum_next[i] = momentum_rate * momentum[i];
+    }
+    for (size_t i = 0; i < 3 * Hu; ++i)
+    {
+        u_next[i] = u[i] + learning_rate * momentum_next[i];
+    }
+}
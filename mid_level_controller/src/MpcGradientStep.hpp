@@ -0,0 +1,50 @@
+#pragma once
+#include <stddef.h>
+#include <vector>
+#include "casadi_mpc_fn.h"
+
+/**
+ * \class MpcGradientStep
+ * \brief One gradient descent step of the MPC for any horizon, the same function that
+ * tools/vehicle_dynamics_identification_and_mpc/MpcController.m generates with CasADi
+ * (casadi_mpc_fn.c, which is fixed to 6 prediction steps, 3 control steps and dt = 0.05).
+ * 
+ * The prediction is integrated forward, the gradient of the objective with respect to
+ * the inputs is computed backward along the prediction (adjoint method), so the cost is
+ * linear in the prediction horizon. Arguments and results use the memory layout of the
+ * CasADi function (dense, column-major), so both can be used with the same buffers.
+ * \ingroup vehicle
+ */
+class MpcGradientStep
+{
+    //! Hp
+    size_t prediction_steps;
+    //! Hu
+    size_t control_steps;
+    //! Prediction time step
+    double dt;
+
+    //! Weights of the reference tracking error per prediction step
+    std::vector<double> reference_weight;
+    //! Index of the input (0..Hu-1) which is applied in each prediction step
+    std::vector<size_t> input_index;
+    //! Predicted states, 4 per step, x0 first
+    mutable std::vector<double> states;
+
+public:
+    /**
+     * \brief Constructor
+     * \param prediction_steps Hp, number of predicted states
+     * \param control_steps Hu, number of distinct inputs, at most Hp
+     * \param dt Prediction time step in seconds
+     */
+    MpcGradientStep(size_t prediction_steps, size_t control_steps, double dt);
+
+    /**
+     * \brief Evaluates the function, same arguments and results as casadi_mpc_fn().
+     * \param arg var_x0[1x4], var_u0[1x2], var_u[Hu x 3], var_momentum[Hu x 3], var_params[10],
+     *            var_reference_trajectory_x[Hp], var_reference_trajectory_y[Hp], var_learning_rate, var_momentum_rate
+     * \param res trajectory_x[Hp], trajectory_y[Hp], objective, var_momentum_next[Hu x 3], var_u_next[Hu x 3]
+     */
+    void operator()(const casadi_real** arg, casadi_real** res) const;
+};
@@ -0,0 +1,58 @@
+#include "MpcParameters.hpp"
+#include <algorithm>
+#include "cpm/Logging.hpp"
+#include "cpm/Parameter.hpp"
+
+/**
+ * \file MpcParameters.cxx
+ * \ingroup vehicle
+ */
+
+bool MpcParameters::is_valid(std::string &error) const
+{
+    if(dynamics_parameters.size() != 10)
+    {
+        error = "mpc/dynamics_parameters must have 10 entries";
+        return false;
+    }
+    if(prediction_steps < 1 || prediction_steps > MPC_MAX_PREDICTION_STEPS)
+    {
+        error = "mpc/prediction_steps must be in [1, " + std::to_string(MPC_MAX_PREDICTION_STEPS) + "]";
+        return false;
+    }
+    if(control_steps < 1 || control_steps > prediction_steps)
+    {
+        error = "mpc/control_steps must be in [1, mpc/prediction_steps]";
+        return false;
+    }
+    if(!(dt > 0) || !(learning_rate > 0) || !(momentum_rate >= 0) || iterations < 1)
+    {
+        error = "mpc/dt, mpc/learning_rate and mpc/iterations must be positive, mpc/momentum_rate non-negative";
+        return false;
+    }
+    return true;
+}
+
+MpcParameters MpcParameters::from_parameter_server()
+{
+    MpcParameters parameters;
+    parameters.dynamics_parameters = cpm::parameter_doubles("mpc/dynamics_parameters");
+    parameters.prediction_steps = static_cast<size_t>(std::max(0, cpm::parameter_int("mpc/prediction_steps")));
+    parameters.control_steps = static_cast<size_t>(std::max(0, cpm::parameter_int("mpc/control_steps")));
+    parameters.dt = cpm::parameter_double("mpc/dt");
+    parameters.learning_rate = cpm::parameter_double("mpc/learning_rate");
+    parameters.momentum_rate = cpm::parameter_double("mpc/momentum_rate");
+    parameters.iterations = cpm::parameter_int("mpc/iterations");
+
+    std::string error;
+    if(!parameters.is_valid(error))
+    {
+        cpm::Logging::Instance().write(
+            1,
+            "Error: MPC parameters: %s. Using the defaults.",
+            error.c_str());
+        return MpcParameters();
+    }
+
+    return parameters;
+}
@@ -0,0 +1,48 @@
+#pragma once
+#include <stddef.h>
+#include <string>
+#include <vector>
+
+/**
+ * \brief Largest supported MPC prediction horizon, the MPC buffers are sized for it
+ * \ingroup vehicle
+ */
+#define MPC_MAX_PREDICTION_STEPS (30)
+
+/**
+ * \struct MpcParameters
+ * \brief Model parameters, horizons and optimizer settings of the MpcController.
+ * The defaults are the values that casadi_mpc_fn.c was generated with. On the vehicle,
+ * they can be loaded from the parameter server (LCC, parameters.yaml) at startup,
+ * so that retuning does not require a new build.
+ * \ingroup vehicle
+ */
+struct MpcParameters
+{
+    //! Parameters of the vehicle dynamics, see tools/vehicle_dynamics_identification_and_mpc/vehicle_dynamics.m
+    std::vector<double> dynamics_parameters = { 1.004582, -0.142938, 0.195236, 3.560576, -2.190728, -9.726828, 2.515565, 1.321199, 0.032208, -0.012863 };
+    //! Number of predicted states (Hp)
+    size_t prediction_steps = 6;
+    //! Number of distinct inputs over the prediction horizon (Hu), at most prediction_steps
+    size_t control_steps = 3;
+    //! The MPC prediction time step in seconds
+    double dt = 0.05;
+    //! Gradient descent step size
+    double learning_rate = 0.4;
+    //! Gradient descent momentum
+    double momentum_rate = 0.6;
+    //! Gradient descent steps per control cycle
+    int iterations = 20;
+
+    /**
+     * \brief Checks the sizes and ranges of all values
+     * \param error Output, reason if the parameters are invalid
+     */
+    bool is_valid(std::string &error) const;
+
+    /**
+     * \brief Requests all values with the prefix "mpc/" from the parameter server, blocks until they are received.
+     * Invalid values are reported and replaced by the defaults.
+     */
+    static MpcParameters from_parameter_server();
+};
@@ -0,0 +1,83 @@
+#include "SimulationCollisionGrid.hpp"
+#include <algorithm>
+
+/**
+ * \file SimulationCollisionGrid.cxx
+ * \ingroup vehicle
+ */
+
+SimulationCollisionGrid::SimulationCollisionGrid(double _collision_distance)
+:collision_distance(_collision_distance)
+{
+    // Colliding vehicles have a center distance of at most twice the radius of their bounding circle (plus the collision distance)
+    cell_size = 2 * hypot(VEHICLE_HALF_LENGTH, VEHICLE_HALF_WIDTH) + 2 * collision_distance;
+}
+
+void SimulationCollisionGrid::find_collisions(const std::vector<PathNode>& poses, std::vector<std::pair<size_t, size_t>>& collisions_out)
+{
+    collisions_out.clear();
+
+    cell_entries.resize(poses.size());
+    for (size_t i = 0; i < poses.size(); ++i)
+    {
+        cell_entries[i].first = cell_key(
+            static_cast<int64_t>(floor(poses[i].x / cell_size)),
+            static_cast<int64_t>(floor(poses[i].y / cell_size))
+        );
+        cell_entries[i].second = i;
+    }
+    std::sort(cell_entries.begin(), cell_entries.end());
+
+    // Each pair of neighbouring cells is visited once: the cell itself and four of its eight neighbours
+    const int64_t neighbour_offsets[4][2] = {{1, -1}, {1, 0}, {1, 1}, {0, 1}};
+
+    for (size_t k = 0; k < cell_entries.size(); ++k)
+    {
+        const size_t i = cell_entries[k].second;
+        const int64_t cell_x = static_cast<int64_t>(floor(poses[i].x / cell_size));
+        const int64_t cell_y = static_cast<int64_t>(floor(poses[i].y / cell_size));
+
+        auto check_pair = [&](size_t j) {
+            if(min_distance_vehicle_to_vehicle(poses[i], poses[j]) < collision_distance)
+            {
+                collisions_out.push_back(std::make_pair(std::min(i, j), std::max(i, j)));
+            }
+        };
+
+        // Same cell, only the following entries
+        for (size_t l = k + 1; l < cell_entries.size() && cell_entries[l].first == cell_entries[k].first; ++l)
+        {
+            check_pair(cell_entries[l].second);
+        }
+
+        for (const auto& offset : neighbour_offsets)
+        {
+            const int64_t key = cell_key(cell_x + offset[0], cell_y + offset[1]);
+            auto it = std::lower_bound(
+                cell_entries.begin(), cell_entries.end(),
+                std::make_pair(key, size_t(0))
+            );
+            for (; it != cell_entries.end() && it->first == key; ++it)
+            {
+                check_pair(it->second);
+            }
+        }
+    }
+
+    std::sort(collisions_out.begin(), collisions_out.end());
+}
+
+void SimulationCollisionGrid::find_collisions_pairwise(const std::vector<PathNode>& poses, std::vector<std::pair<size_t, size_t>>& collisions_out)
+{
+    collisions_out.clear();
+    for (size_t i = 0; i < poses.size(); ++i)
+    {
+        for (size_t j = i + 1; j < poses.size(); ++j)
+        {
+            if(min_distance_vehicle_to_vehicle(poses[i], poses[j]) < collision_distance)
+            {
+                collisions_out.push_back(std::make_pair(i, j));
+            }
+        }
+    }
+}
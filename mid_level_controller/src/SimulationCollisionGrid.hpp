@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "geometry.hpp"
+
+/**
+ * \class SimulationCollisionGrid
+ * \brief Broadphase for the collision check between many simulated vehicles.
+ * The vehicle centers are sorted into a uniform grid, whose cells are large enough that colliding vehicles
+ * are always in the same or in neighbouring cells. The exact min_distance_vehicle_to_vehicle check is only
+ * done for these candidate pairs, which makes the check O(n log n) instead of O(n^2) for spread out vehicles.
+ * \ingroup vehicle
+ */
+class SimulationCollisionGrid
+{
+    //! Edge length of a grid cell in m
+    double cell_size;
+    //! Distance below which two vehicles collide, see min_distance_vehicle_to_vehicle
+    double collision_distance;
+
+    //! Cell key and vehicle index, sorted by the key. Kept as member to reuse its memory
+    std::vector<std::pair<int64_t, size_t>> cell_entries;
+
+    /**
+     * \brief Key of the cell (cell_x, cell_y)
+     * \param cell_x Cell index in x
+     * \param cell_y Cell index in y
+     */
+    static int64_t cell_key(int64_t cell_x, int64_t cell_y)
+    {
+        // Shifted as unsigned, cell indices are negative left of and below the origin
+        return static_cast<int64_t>((static_cast<uint64_t>(cell_x) << 32) ^ (static_cast<uint64_t>(cell_y) & 0xffffffffull));
+    }
+
+public:
+    /**
+     * \brief Constructor
+     * \param _collision_distance Two vehicles collide if min_distance_vehicle_to_vehicle is smaller than this value
+     */
+    SimulationCollisionGrid(double _collision_distance = 0.001);
+
+    /**
+     * \brief Find all colliding pairs
+     * \param poses Vehicle poses
+     * \param collisions_out Output, pairs of indices (i < j) into poses
+     */
+    void find_collisions(const std::vector<PathNode>& poses, std::vector<std::pair<size_t, size_t>>& collisions_out);
+
+    /**
+     * \brief Reference implementation that checks all pairs, for tests and benchmarks
+     * \param poses Vehicle poses
+     * \param collisions_out Output, pairs of indices (i < j) into poses
+     */
+    void find_collisions_pairwise(const std::vector<PathNode>& poses, std::vector<std::pair<size_t, size_t>>& collisions_out);
+};
@@ -0,0 +1,177 @@
+#include "SimulationFleet.hpp"
+#include "cpm/get_topic.hpp"
+#include "cpm/Logging.hpp"
+#include "cpm/stamp_message.hpp"
+
+/**
+ * \file SimulationFleet.cxx
+ * \ingroup vehicle
+ */
+
+SimulationFleet::SimulationFleet(std::vector<uint8_t> vehicle_ids, std::function<uint64_t()> get_time, size_t n_threads)
+:writer_vehicleState("vehicleState")
+,thread_pool(n_threads)
+{
+    size_t n_extra_vehicles = 0;
+
+    for (uint8_t vehicle_id : vehicle_ids)
+    {
+        std::unique_ptr<FleetVehicle> vehicle(new FleetVehicle());
+        vehicle->vehicle_id = vehicle_id;
+        vehicle->stop_counter.store(0);
+
+        // Vehicles without a default starting position are lined up next to the map
+        vector<double> starting_position = {0.0};
+        if(vehicle_id >= NUM_DEFAULT_STARTING_POSITIONS)
+        {
+            starting_position = {
+                0.3 + 0.4 * (n_extra_vehicles % 12),
+                4.3 + 0.3 * (n_extra_vehicles / 12),
+                0.0
+            };
+            ++n_extra_vehicles;
+        }
+
+        vehicle->simulationIPS = std::unique_ptr<SimulationIPS>(new SimulationIPS("vehicleObservation", vehicle_id));
+        vehicle->simulationVehicle = std::unique_ptr<SimulationVehicle>(
+            new SimulationVehicle(*(vehicle->simulationIPS), vehicle_id, starting_position, false)
+        );
+        vehicle->topic_vehicleObservationFiltered = std::unique_ptr<cpm::VehicleIDFilteredTopic<VehicleObservation>>(
+            new cpm::VehicleIDFilteredTopic<VehicleObservation>(cpm::get_topic<VehicleObservation>("vehicleObservation"), vehicle_id)
+        );
+        vehicle->reader_vehicleObservation = std::unique_ptr<cpm::Reader<VehicleObservation>>(
+            new cpm::Reader<VehicleObservation>(*(vehicle->topic_vehicleObservationFiltered))
+        );
+        vehicle->localization = std::unique_ptr<Localization>(new Localization());
+        vehicle->controller = std::unique_ptr<Controller>(new Controller(vehicle_id, get_time));
+
+        vehicles.push_back(std::move(vehicle));
+    }
+
+    poses.resize(vehicles.size());
+}
+
+void SimulationFleet::step_vehicle(FleetVehicle& vehicle, size_t index, uint64_t t_now, uint64_t period_nanoseconds)
+{
+    try
+    {
+        // get IPS observation
+        VehicleObservation sample_vehicleObservation;
+        uint64_t sample_vehicleObservation_age;
+        vehicle.reader_vehicleObservation->get_sample(
+            t_now,
+            sample_vehicleObservation,
+            sample_vehicleObservation_age
+        );
+
+        double motor_throttle = 0;
+        double steering_servo = 0;
+
+        if(vehicle.stop_counter.load() == 0)
+        {
+            vehicle.controller->get_control_signals(t_now, motor_throttle, steering_servo);
+        }
+        else
+        {
+            vehicle.controller->get_stop_signals(motor_throttle, steering_servo);
+        }
+
+        VehicleState vehicleState = vehicle.simulationVehicle->update(
+            motor_throttle,
+            steering_servo,
+            t_now,
+            period_nanoseconds/1e9,
+            vehicle.vehicle_id
+        );
+        vehicleState.is_real(false); // Is not real, is simulated
+
+        // Share the true pose for the collision check
+        double px, py, yaw, speed;
+        vehicle.simulationVehicle->get_state(px, py, yaw, speed);
+        poses[index] = PathNode(px, py, cos(yaw), sin(yaw));
+
+        Pose2D new_pose = vehicle.localization->update(
+            t_now,
+            period_nanoseconds,
+            vehicleState,
+            sample_vehicleObservation,
+            sample_vehicleObservation_age
+        );
+        vehicleState.pose(new_pose);
+        vehicleState.motor_throttle(motor_throttle);
+        vehicleState.steering_servo(steering_servo);
+        vehicleState.vehicle_id(vehicle.vehicle_id);
+        vehicleState.IPS_update_age_nanoseconds(sample_vehicleObservation_age);
+        cpm::stamp_message(vehicleState, t_now, 60000000ull);
+
+        vehicle.controller->update_vehicle_state(vehicleState);
+        writer_vehicleState.write(vehicleState);
+
+        if(vehicle.loop_count == 25)
+        {
+            vehicle.localization->reset();
+        }
+        vehicle.loop_count++;
+    }
+    catch(const dds::core::Exception& e)
+    {
+        std::string err_message = e.what();
+        cpm::Logging::Instance().write(
+            1,
+            "Error: %s",
+            err_message.c_str());
+    }
+
+    if (vehicle.stop_counter.load() > 0)
+    {
+        //Reset if the counter will stop in the next round
+        if (vehicle.stop_counter.load() == 1)
+        {
+            vehicle.controller->reset();
+        }
+
+        vehicle.stop_counter.store(vehicle.stop_counter.load() - 1);
+    }
+}
+
+void SimulationFleet::update(uint64_t t_now, uint64_t period_nanoseconds)
+{
+    thread_pool.parallel_for(vehicles.size(), [&](size_t i) {
+        step_vehicle(*(vehicles[i]), i, t_now, period_nanoseconds);
+    });
+
+    // All vehicles are at t_now, so no pose history is required (unlike SimulationVehicle::get_collisions)
+    collision_grid.find_collisions(poses, collisions);
+    for (const auto& collision : collisions)
+    {
+        cpm::Logging::Instance().write(
+            1,
+            "Warning: Simulation: Collision of vehicle %u with vehicle %u at time %llu.",
+            static_cast<unsigned int>(vehicles[collision.first]->vehicle_id),
+            static_cast<unsigned int>(vehicles[collision.second]->vehicle_id),
+            static_cast<unsigned long long>(t_now));
+    }
+}
+
+void SimulationFleet::stop()
+{
+    for (auto& vehicle : vehicles)
+    {
+        vehicle->stop_counter.store(STOP_STEPS);
+    }
+}
+
+std::vector<std::pair<uint8_t, uint8_t>> SimulationFleet::get_collisions()
+{
+    std::vector<std::pair<uint8_t, uint8_t>> result;
+    for (const auto& collision : collisions)
+    {
+        result.push_back(std::make_pair(vehicles[collision.first]->vehicle_id, vehicles[collision.second]->vehicle_id));
+    }
+    return result;
+}
+
+size_t SimulationFleet::size() const
+{
+    return vehicles.size();
+}
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <stdint.h>
+#include <utility>
+#include <vector>
+
+#include "VehicleObservation.hpp"
+#include "VehicleState.hpp"
+#include "cpm/Reader.hpp"
+#include "cpm/ThreadPool.hpp"
+#include "cpm/VehicleIDFilteredTopic.hpp"
+#include "cpm/Writer.hpp"
+
+#include "Controller.hpp"
+#include "Localization.hpp"
+#include "SimulationCollisionGrid.hpp"
+#include "SimulationIPS.hpp"
+#include "SimulationVehicle.hpp"
+#include "geometry.hpp"
+
+/**
+ * \class SimulationFleet
+ * \brief Simulates many vehicles in one process, as an alternative to one vehicle_rpi_firmware process per simulated vehicle.
+ * Each vehicle still has its own controller, localization, simulated IPS and DDS topics (vehicleState, vehicleObservation,
+ * vehiclePoseSimulated), so that the rest of the lab cannot tell the difference. All vehicles share one DDS participant,
+ * are stepped in parallel on a fixed thread pool and exchange their poses through memory for the collision check,
+ * which uses a uniform grid broadphase (SimulationCollisionGrid) instead of checking all pairs.
+ * \ingroup vehicle
+ */
+class SimulationFleet
+{
+    /**
+     * \struct FleetVehicle
+     * \brief Everything that a single vehicle process would own in main.cxx
+     */
+    struct FleetVehicle
+    {
+        //! ID of the vehicle
+        uint8_t vehicle_id;
+        //! Simulated IPS, publishes the delayed observations of this vehicle
+        std::unique_ptr<SimulationIPS> simulationIPS;
+        //! Vehicle dynamics
+        std::unique_ptr<SimulationVehicle> simulationVehicle;
+        //! Filtered topic for the observations of this vehicle
+        std::unique_ptr<cpm::VehicleIDFilteredTopic<VehicleObservation>> topic_vehicleObservationFiltered;
+        //! Reader for the observations of this vehicle
+        std::unique_ptr<cpm::Reader<VehicleObservation>> reader_vehicleObservation;
+        //! Localization of this vehicle
+        std::unique_ptr<Localization> localization;
+        //! Controller of this vehicle
+        std::unique_ptr<Controller> controller;
+        //! Number of steps so far, see main.cxx
+        int64_t loop_count = 0;
+        //! Number of remaining steps after a stop signal, see main.cxx
+        std::atomic_uint_least32_t stop_counter;
+    };
+
+    //! Vehicles of the fleet
+    std::vector<std::unique_ptr<FleetVehicle>> vehicles;
+
+    //! Shared by all vehicles, the samples are keyed by the vehicle ID
+    cpm::Writer<VehicleState> writer_vehicleState;
+
+    //! Workers to step the vehicles in parallel
+    cpm::ThreadPool thread_pool;
+
+    //! True pose of each vehicle after the last step, index as in vehicles
+    std::vector<PathNode> poses;
+
+    //! Broadphase for the collision check
+    SimulationCollisionGrid collision_grid;
+
+    //! Result of the last collision check, as indices into vehicles
+    std::vector<std::pair<size_t, size_t>> collisions;
+
+    //! 50 Hz -> pause for one second after a stop signal
+    const uint32_t STOP_STEPS = 50;
+
+    /**
+     * \brief One control and simulation step of a single vehicle, same as the loop in main.cxx for VEHICLE_SIMULATION
+     * \param vehicle The vehicle
+     * \param index Index of the vehicle in vehicles / poses
+     * \param t_now Current time
+     * \param period_nanoseconds Step size
+     */
+    void step_vehicle(FleetVehicle& vehicle, size_t index, uint64_t t_now, uint64_t period_nanoseconds);
+
+public:
+    /**
+     * \brief Create all vehicles
+     * \param vehicle_ids IDs of the simulated vehicles
+     * \param get_time Time source of the controllers, usually the timer that calls update()
+     * \param n_threads Size of the thread pool, 0 for the number of cores
+     */
+    SimulationFleet(std::vector<uint8_t> vehicle_ids, std::function<uint64_t()> get_time, size_t n_threads = 0);
+
+    /**
+     * \brief Step all vehicles and check for collisions
+     * \param t_now Current time
+     * \param period_nanoseconds Step size
+     */
+    void update(uint64_t t_now, uint64_t period_nanoseconds);
+
+    /**
+     * \brief Reaction to the stop signal for all vehicles, see main.cxx
+     */
+    void stop();
+
+    /**
+     * \brief Collisions found in the last update(), as pairs of vehicle IDs
+     */
+    std::vector<std::pair<uint8_t, uint8_t>> get_collisions();
+
+    /**
+     * \brief Number of simulated vehicles
+     */
+    size_t size() const;
+};
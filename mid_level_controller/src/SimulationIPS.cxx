@@ -1,7 +1,6 @@
 #include "SimulationIPS.hpp"
 #include "cpm/ParticipantSingleton.hpp"
 #include "cpm/stamp_message.hpp"
-#include <stdlib.h>
 #include <cmath>
 
 /**
@@ -9,21 +8,12 @@
  * \ingroup vehicle
  */
 
-/**
- * \brief TODO
- * \ingroup vehicle
- */
-static inline double frand() { return (double(rand()))/RAND_MAX; }
-
-/**
- * \brief TODO
- * \ingroup vehicle
- */
-static inline double frand_sym() { return frand()*2-1; }
-
-SimulationIPS::SimulationIPS(std::string topic_name)
+SimulationIPS::SimulationIPS(std::string topic_name, uint32_t seed)
 :
     writer_vehicleObservation(topic_name)
+    ,random_engine(seed)
+    ,noise_distribution(-1.0, 1.0)
+    ,detection_distribution(0, 19)
 {
     
 }
@@ -33,13 +23,13 @@ SimulationIPS::SimulationIPS(std::string topic_name)
 void SimulationIPS::update(VehicleObservation simulatedState)
 {
     // Simulate probability of detection
-    if( rand()%20 == 1 ) return;
+    if( detection_distribution(random_engine) == 1 ) return;
 
 
     // simulate signal noise
-    simulatedState.pose().x(simulatedState.pose().x() + 0.002 * frand_sym());
-    simulatedState.pose().y(simulatedState.pose().y() + 0.002 * frand_sym());
-    simulatedState.pose().yaw(simulatedState.pose().yaw() + 0.01 * frand_sym());
+    simulatedState.pose().x(simulatedState.pose().x() + 0.002 * noise_distribution(random_engine));
+    simulatedState.pose().y(simulatedState.pose().y() + 0.002 * noise_distribution(random_engine));
+    simulatedState.pose().yaw(simulatedState.pose().yaw() + 0.01 * noise_distribution(random_engine));
 
     simulatedState.pose().yaw(remainder(simulatedState.pose().yaw(), 2*M_PI)); // yaw in range [-PI, PI]
 
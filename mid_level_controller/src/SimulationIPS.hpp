@@ -1,7 +1,9 @@
 #pragma once
 #include "VehicleObservation.hpp"
 #include "cpm/Writer.hpp"
+#include <cstdint>
 #include <list>
+#include <random>
 #include <string>
 
 /**
@@ -17,12 +19,20 @@ class SimulationIPS
     //! TODO
     std::list<VehicleObservation> delay_buffer;
 
+    //! Random number generator for the simulated detection loss and signal noise, one per simulated IPS (vehicles may be updated concurrently)
+    std::mt19937 random_engine;
+    //! Uniform distribution in [-1, 1) for the simulated signal noise
+    std::uniform_real_distribution<double> noise_distribution;
+    //! Uniform distribution over [0, 19] for the simulated probability of detection
+    std::uniform_int_distribution<int> detection_distribution;
+
 public:
     /**
      * \brief TODO Constructor
      * \param topic_name TODO
+     * \param seed Seed of the random number generator, e.g. the vehicle ID, so that simulation runs are reproducible
      */
-    SimulationIPS(std::string topic_name);
+    SimulationIPS(std::string topic_name, uint32_t seed = 0);
 
     /**
      * \brief TODO
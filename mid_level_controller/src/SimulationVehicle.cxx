@@ -12,11 +12,19 @@ extern "C" {
 #include "../../low_level_controller/vehicle_atmega2560_firmware/crc.h"
 }
 
-SimulationVehicle::SimulationVehicle(SimulationIPS& _simulationIPS, uint8_t vehicle_id, vector<double> starting_position)
+SimulationVehicle::SimulationVehicle(SimulationIPS& _simulationIPS, uint8_t vehicle_id, vector<double> starting_position, bool check_collisions)
 :writer_vehiclePoseSimulated("vehiclePoseSimulated")
-,reader_vehiclePoseSimulated(cpm::get_topic<VehicleObservation>("vehiclePoseSimulated"), MAX_NUM_VEHICLES)
 ,simulationIPS(_simulationIPS)
+,random_engine(vehicle_id)
+,drift_distribution(0.0, 1.0)
 {
+    if(check_collisions)
+    {
+        reader_vehiclePoseSimulated = std::unique_ptr<cpm::MultiVehicleReader<VehicleObservation>>(
+            new cpm::MultiVehicleReader<VehicleObservation>(cpm::get_topic<VehicleObservation>("vehiclePoseSimulated"), MAX_NUM_VEHICLES)
+        );
+    }
+
     // select a starting position on the "map2" layout
     const std::vector<double> nodes_x = std::vector<double>{2.2500e+00,3.1500e+00,2.2500e+00,3.1575e+00,3.8074e+00,3.8795e+00,4.2103e+00,4.3584e+00,4.2450e+00,4.3950e+00,3.8956e+00,4.0623e+00,3.8242e+00,3.0500e+00,3.0500e+00,2.3250e+00,2.4884e+00,2.4750e+00,2.6065e+00,3.1425e+00,2.2500e+00,2.4750e+00,2.1750e+00,3.0500e+00,2.0250e+00,3.0500e+00,2.3250e+00,2.2500e+00,1.3500e+00,1.3425e+00,6.9264e-01,6.2050e-01,2.8966e-01,1.4158e-01,2.5500e-01,1.0500e-01,6.0440e-01,6.7576e-01,4.3775e-01,1.4500e+00,1.4500e+00,2.0116e+00,1.8935e+00,1.3575e+00,2.0250e+00,1.4500e+00,1.4500e+00,2.1750e+00,3.1500e+00,2.2500e+00,3.1575e+00,2.2500e+00,3.8074e+00,3.8795e+00,4.2103e+00,4.3584e+00,3.8956e+00,3.8242e+00,4.0623e+00,2.4884e+00,2.3250e+00,2.6065e+00,2.4750e+00,3.1425e+00,2.2500e+00,2.1750e+00,2.0250e+00,2.2500e+00,1.3500e+00,1.3425e+00,6.9264e-01,6.2050e-01,2.8966e-01,1.4158e-01,6.0440e-01,4.3775e-01,6.7576e-01,2.0116e+00,1.8935e+00,1.3575e+00,};
     const std::vector<double> nodes_y = std::vector<double>{3.7450e+00,3.7390e+00,3.8950e+00,3.8888e+00,3.5902e+00,3.7217e+00,2.9310e+00,2.9549e+00,2.0000e+00,2.0000e+00,2.1939e+00,2.9071e+00,2.3258e+00,2.0750e+00,2.2250e+00,2.8000e+00,3.5006e+00,2.8000e+00,3.4081e+00,3.5892e+00,2.2250e+00,2.0000e+00,2.8000e+00,1.9250e+00,2.8000e+00,1.7750e+00,2.0000e+00,2.0750e+00,3.7390e+00,3.8888e+00,3.5902e+00,3.7217e+00,2.9310e+00,2.9549e+00,2.0000e+00,2.0000e+00,2.1939e+00,2.3258e+00,2.9071e+00,2.0750e+00,2.2250e+00,3.5006e+00,3.4081e+00,3.5892e+00,2.0000e+00,1.9250e+00,1.7750e+00,2.0000e+00,2.6100e-01,2.5500e-01,1.1119e-01,1.0500e-01,4.0979e-01,2.7828e-01,1.0690e+00,1.0451e+00,1.8061e+00,1.6742e+00,1.0929e+00,4.9935e-01,1.2000e+00,5.9189e-01,1.2000e+00,4.1081e-01,1.7750e+00,1.2000e+00,1.2000e+00,1.9250e+00,2.6100e-01,1.1119e-01,4.0979e-01,2.7828e-01,1.0690e+00,1.0451e+00,1.8061e+00,1.0929e+00,1.6742e+00,4.9935e-01,5.9189e-01,4.1081e-01,};
@@ -24,13 +32,13 @@ SimulationVehicle::SimulationVehicle(SimulationIPS& _simulationIPS, uint8_t vehi
     const std::vector<double> nodes_sin = std::vector<double>{0.0000e+00,-5.0058e-02,0.0000e+00,-5.0154e-02,-4.8090e-01,-4.8086e-01,-9.8725e-01,-9.8724e-01,-1.0000e+00,-1.0000e+00,-4.7568e-01,-9.8724e-01,-4.7568e-01,-3.4318e-05,3.4305e-05,1.0000e+00,7.8703e-01,1.0000e+00,7.8703e-01,-5.0169e-02,0.0000e+00,1.0000e+00,-1.0000e+00,-3.4318e-05,-1.0000e+00,3.4305e-05,1.0000e+00,0.0000e+00,5.0058e-02,5.0154e-02,4.8090e-01,4.8086e-01,9.8725e-01,9.8724e-01,1.0000e+00,1.0000e+00,4.7568e-01,4.7568e-01,9.8724e-01,3.4318e-05,-3.4305e-05,-7.8703e-01,-7.8703e-01,5.0169e-02,-1.0000e+00,3.4318e-05,-3.4305e-05,-1.0000e+00,-5.0058e-02,0.0000e+00,-5.0154e-02,0.0000e+00,-4.8090e-01,-4.8086e-01,-9.8725e-01,-9.8724e-01,-4.7568e-01,-4.7568e-01,-9.8724e-01,7.8703e-01,1.0000e+00,7.8703e-01,1.0000e+00,-5.0169e-02,0.0000e+00,-1.0000e+00,-1.0000e+00,0.0000e+00,5.0058e-02,5.0154e-02,4.8090e-01,4.8086e-01,9.8725e-01,9.8724e-01,4.7568e-01,9.8724e-01,4.7568e-01,-7.8703e-01,-7.8703e-01,5.0169e-02,};
     const std::vector<double> index_map {2,3,5,7,9,55,53,50,51,69,71,73,35,33,31,29,14,25,62,66,46,40,24,17};  
 
-    //Log error if ID higher than expected with current setup - Current method must be changed anyway
-    if (static_cast<size_t>(vehicle_id) + 1 > index_map.size())
-    {   
-        cpm::Logging::Instance().write(1, "%s", "Vehicle ID too high for current simulation setup!");
-    }
-
     if(starting_position.size() != 3){
+        //Log error if ID higher than expected with current setup - Current method must be changed anyway
+        if (static_cast<size_t>(vehicle_id) + 1 > index_map.size())
+        {   
+            cpm::Logging::Instance().write(1, "%s", "Vehicle ID too high for current simulation setup!");
+        }
+
         //TODO: Change method, this is not valid for vehicle IDs > 23
         px = nodes_x.at(index_map.at(vehicle_id));
         py = nodes_y.at(index_map.at(vehicle_id));
@@ -83,7 +91,7 @@ VehicleState SimulationVehicle::update(
     );
 
     distance += dt * speed;
-    yaw_measured += dt * d_yaw + 1e-4 * frand(); // simulate random biased gyro drift
+    yaw_measured += dt * d_yaw + 1e-4 * drift_distribution(random_engine); // simulate random biased gyro drift
     yaw_measured = remainder(yaw_measured, 2*M_PI); // yaw in range [-PI, PI]
 
 
@@ -101,21 +109,24 @@ VehicleState SimulationVehicle::update(
     }
 
     
-    // save current pose
-    ego_pose_history[t_now] = Pose2D(px, py, yaw);
-    // Check for collision
-    std::map<uint8_t, uint64_t> collisions = get_collisions(t_now, vehicle_id);
-    for (auto const& colli : collisions)
+    if(reader_vehiclePoseSimulated)
     {
-        cpm::Logging::Instance().write(
-            1,
-            "Warning: Simulation: Collision with vehicle %u at time %llu.", 
-            static_cast<unsigned int>(colli.first), colli.second);
+        // save current pose
+        ego_pose_history[t_now] = Pose2D(px, py, yaw);
+        // Check for collision
+        std::map<uint8_t, uint64_t> collisions = get_collisions(t_now, vehicle_id);
+        for (auto const& colli : collisions)
+        {
+            cpm::Logging::Instance().write(
+                1,
+                "Warning: Simulation: Collision with vehicle %u at time %llu.", 
+                static_cast<unsigned int>(colli.first), colli.second);
+        }
+        // Erase trajectory points which are older than 0.5 seconds
+        const uint64_t past_threshold_time = t_now - 500000000ull;
+        auto last_valid_it = ego_pose_history.upper_bound(past_threshold_time);
+        ego_pose_history.erase(ego_pose_history.begin(), last_valid_it);
     }
-    // Erase trajectory points which are older than 0.5 seconds
-    const uint64_t past_threshold_time = t_now - 500000000ull;
-    auto last_valid_it = ego_pose_history.upper_bound(past_threshold_time);
-    ego_pose_history.erase(ego_pose_history.begin(), last_valid_it);
 
     /*std::cout 
     << "dt"                    << "  " << dt                    << std::endl
@@ -161,7 +172,7 @@ std::map<uint8_t, uint64_t>  SimulationVehicle::get_collisions(
     
     std::map<uint8_t, VehicleObservation> sample_out; 
     std::map<uint8_t, uint64_t> sample_age_out;
-    reader_vehiclePoseSimulated.get_samples(t_now, sample_out, sample_age_out);
+    reader_vehiclePoseSimulated->get_samples(t_now, sample_out, sample_age_out);
     for(const auto& entry : sample_out)
     {
         const auto vehicle_id_in = entry.first;
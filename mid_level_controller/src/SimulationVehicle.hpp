@@ -14,6 +14,8 @@
 #include "VehicleObservation.hpp"
 #include "VehicleState.hpp"
 #include "SimulationIPS.hpp"
+#include <memory>
+#include <random>
 #include <vector>
 
 extern "C" {
@@ -36,12 +38,11 @@ extern "C" {
  * \ingroup vehicle
  */
 #define MAX_NUM_VEHICLES 30
-
 /**
- * \brief TODO
+ * \brief Number of vehicle IDs (starting at 0) that have a default starting position on the "map2" layout
  * \ingroup vehicle
  */
-static inline double frand() { return (double(rand()))/RAND_MAX; }
+#define NUM_DEFAULT_STARTING_POSITIONS 24
 
 /**
  * \class SimulationVehicle
@@ -79,12 +80,17 @@ class SimulationVehicle
 
     //! TODO
     cpm::Writer<VehicleObservation> writer_vehiclePoseSimulated;
-    //! TODO
-    cpm::MultiVehicleReader<VehicleObservation> reader_vehiclePoseSimulated;
+    //! TODO, only used if the vehicle checks for collisions itself
+    std::unique_ptr<cpm::MultiVehicleReader<VehicleObservation>> reader_vehiclePoseSimulated;
 
     //! TODO
     SimulationIPS& simulationIPS;
 
+    //! Per-vehicle random number generator for the simulated gyro drift, seeded with the vehicle ID (vehicles may be updated concurrently)
+    std::mt19937 random_engine;
+    //! Uniform distribution in [0, 1) for the simulated gyro drift
+    std::uniform_real_distribution<double> drift_distribution;
+
     //! For collision checks:
     std::map<uint64_t, Pose2D> ego_pose_history;
     /**
@@ -101,8 +107,10 @@ public:
      * \param _simulationIPS TODO
      * \param vehicle_id TODO
      * \param starting_position TODO
+     * \param check_collisions If true, the vehicle subscribes to the poses of all other simulated vehicles and checks for collisions
+     * with them. Set it to false if this is done centrally, e.g. by SimulationFleet.
      */
-    SimulationVehicle(SimulationIPS& _simulationIPS, uint8_t vehicle_id, vector<double> starting_position);
+    SimulationVehicle(SimulationIPS& _simulationIPS, uint8_t vehicle_id, vector<double> starting_position, bool check_collisions = true);
 
     /**
      * \brief TODO
@@ -32,6 +32,7 @@ using std::vector;
 
 #include "SensorCalibration.hpp"
 #include "Localization.hpp"
+#include "LocalizationEKF.hpp"
 #include "Controller.hpp"
 
 
@@ -52,7 +53,7 @@ int main(int argc, char *argv[])
     //rti::config::Logger::instance().verbosity(rti::config::Verbosity::WARNING);
 
     if(argc < 2) {
-        std::cerr << "Usage: vehicle_rpi_firmware --simulated_time=BOOL --vehicle_id=INT --dds_domain=INT(optional) --pose=DOUBLE,DOUBLE,DOUBLE(optional;only simulation; x,y,yaw)" << std::endl;
+        std::cerr << "Usage: vehicle_rpi_firmware --simulated_time=BOOL --vehicle_id=INT --dds_domain=INT(optional) --pose=DOUBLE,DOUBLE,DOUBLE(optional;only simulation; x,y,yaw) --localization=buffer|ekf(optional) --spi=bytewise|spidev(optional) --spi_speed_hz=INT(optional) --spi_inter_byte_delay_us=INT(optional) --spi_inter_frame_delay_us=INT(optional) --mpc_parameters=BOOL(optional; load the MPC parameters from the LCC)" << std::endl;
         return 1;
     }
 
@@ -60,6 +61,8 @@ int main(int argc, char *argv[])
 
     const int vehicle_id = cpm::cmd_parameter_int("vehicle_id", 0, argc, argv);
     const bool enable_simulated_time = cpm::cmd_parameter_bool("simulated_time", false, argc, argv);
+    //Localization filter: "buffer" (reprocessing of the state history) or "ekf" (Kalman filter with bounded cost for delayed observations)
+    const bool use_localization_ekf = (cpm::cmd_parameter_string("localization", "buffer", argc, argv) == "ekf");
 
     if(vehicle_id <= 0 || vehicle_id > 255) { //Upper bound due to use of uint8_t
         std::cerr << "Invalid vehicle ID." << std::endl;
@@ -83,7 +86,16 @@ int main(int argc, char *argv[])
         cpm::Logging::Instance().write(1, "%s", "bcm2835_init failed. Are you running as root??");
         exit(EXIT_FAILURE);
     }
-    spi_init();
+    //SPI transfer: "bytewise" (bcm2835, busy waits) or "spidev" (one ioctl per frame, the kernel inserts the pauses)
+    spi_config_t spi_config = spi_default_config();
+    if (cpm::cmd_parameter_string("spi", "bytewise", argc, argv) == "spidev")
+    {
+        spi_config.mode = SPI_TRANSFER_SPIDEV;
+    }
+    spi_config.speed_hz = static_cast<uint32_t>(cpm::cmd_parameter_int("spi_speed_hz", spi_config.speed_hz, argc, argv));
+    spi_config.inter_byte_delay_us = static_cast<uint16_t>(cpm::cmd_parameter_int("spi_inter_byte_delay_us", spi_config.inter_byte_delay_us, argc, argv));
+    spi_config.inter_frame_delay_us = static_cast<uint16_t>(cpm::cmd_parameter_int("spi_inter_frame_delay_us", spi_config.inter_frame_delay_us, argc, argv));
+    spi_init_config(spi_config);
     const bool allow_simulated_time = false;
 
     //Enable RTT measurement
@@ -94,7 +106,7 @@ int main(int argc, char *argv[])
     if(starting_position.size() != 1 && starting_position.size() != 3) {
         starting_position = {0.0};
     }
-    SimulationIPS simulationIPS(topic_vehicleObservation_name);
+    SimulationIPS simulationIPS(topic_vehicleObservation_name, vehicle_id);
     SimulationVehicle simulationVehicle(simulationIPS, vehicle_id, starting_position);
     const bool allow_simulated_time = true;
 #endif
@@ -111,7 +123,14 @@ int main(int argc, char *argv[])
         enable_simulated_time);
 
     Localization localization;
-    Controller controller(vehicle_id, [&](){return update_loop->get_time();});
+    LocalizationEKF localization_ekf;
+    //MPC model parameters and horizons from the parameter server (parameters.yaml, prefix "mpc/"), or the compiled defaults
+    MpcParameters mpc_parameters;
+    if (cpm::cmd_parameter_bool("mpc_parameters", false, argc, argv))
+    {
+        mpc_parameters = MpcParameters::from_parameter_server();
+    }
+    Controller controller(vehicle_id, [&](){return update_loop->get_time();}, mpc_parameters);
 
     
     // Timing / profiling helper
@@ -225,13 +244,29 @@ int main(int argc, char *argv[])
                 // Process sensor data
                 if(transmission_successful) 
                 {
-                    Pose2D new_pose = localization.update(
-                        t_now,
-                        period_nanoseconds,
-                        vehicleState,
-                        sample_vehicleObservation, 
-                        sample_vehicleObservation_age
-                    );
+                    Pose2D new_pose;
+                    cpm::TimeMeasurement::Instance().start("localization");
+                    if(use_localization_ekf)
+                    {
+                        new_pose = localization_ekf.update(
+                            t_now,
+                            period_nanoseconds,
+                            vehicleState,
+                            sample_vehicleObservation, 
+                            sample_vehicleObservation_age
+                        );
+                    }
+                    else
+                    {
+                        new_pose = localization.update(
+                            t_now,
+                            period_nanoseconds,
+                            vehicleState,
+                            sample_vehicleObservation, 
+                            sample_vehicleObservation_age
+                        );
+                    }
+                    cpm::TimeMeasurement::Instance().stop("localization");
                     vehicleState.pose(new_pose);
                     vehicleState.motor_throttle(motor_throttle);
                     vehicleState.steering_servo(steering_servo);
@@ -256,6 +291,7 @@ int main(int argc, char *argv[])
                 if(loop_count == 25)
                 {
                     localization.reset();
+                    localization_ekf.reset();
                 }
                 loop_count++;
             }
@@ -0,0 +1,78 @@
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "cpm/CommandLineReader.hpp"
+#include "cpm/Logging.hpp"
+#include "cpm/Timer.hpp"
+#include "cpm/TimeMeasurement.hpp"
+#include "cpm/init.hpp"
+
+#include "SimulationFleet.hpp"
+
+/**
+ * \file main_fleet.cxx
+ * \ingroup vehicle
+ */
+
+/**
+ * \brief Main function of the fleet simulation, which simulates several vehicles in one process
+ * \ingroup vehicle
+ */
+int main(int argc, char *argv[])
+{
+    if(argc < 2) {
+        std::cerr << "Usage: vehicle_fleet_simulation --simulated_time=BOOL --vehicle_ids=INT,INT,... --threads=INT(optional) --dds_domain=INT(optional)" << std::endl;
+        return 1;
+    }
+
+    cpm::init(argc, argv);
+
+    const std::vector<int> vehicle_ids_int = cpm::cmd_parameter_ints("vehicle_ids", {1}, argc, argv);
+    const bool enable_simulated_time = cpm::cmd_parameter_bool("simulated_time", false, argc, argv);
+    const int n_threads = cpm::cmd_parameter_int("threads", 0, argc, argv);
+
+    std::vector<uint8_t> vehicle_ids;
+    for (int vehicle_id : vehicle_ids_int)
+    {
+        if(vehicle_id <= 0 || vehicle_id > 255) { //Upper bound due to use of uint8_t
+            std::cerr << "Invalid vehicle ID " << vehicle_id << "." << std::endl;
+            return 1;
+        }
+        vehicle_ids.push_back(static_cast<uint8_t>(vehicle_id));
+    }
+    std::cout << "Simulating " << vehicle_ids.size() << " vehicles" << std::endl;
+    cpm::Logging::Instance().set_id("vehicle_fleet_simulation");
+
+    const uint64_t period_nanoseconds = 20000000ull; // 50 Hz
+    auto update_loop = cpm::Timer::create(
+        "vehicle_fleet_simulation",
+        period_nanoseconds, 0,
+        false,
+        true,
+        enable_simulated_time);
+
+    SimulationFleet fleet(vehicle_ids, [&](){return update_loop->get_time();}, static_cast<size_t>(std::max(n_threads, 0)));
+
+    update_loop->start(
+        //Callback for update signal
+        [&](uint64_t t_now)
+        {
+            cpm::TimeMeasurement::Instance().start("cycle");
+            fleet.update(t_now, period_nanoseconds);
+            cpm::TimeMeasurement::Instance().stop("cycle");
+        },
+        //Callback for stop signal
+        [&](){
+            fleet.stop();
+
+            cpm::Logging::Instance().write(
+                3,
+                "Received stop %s",
+                "signal");
+        }
+    );
+
+    return 0;
+}
@@ -4,7 +4,11 @@
 #include <stdlib.h>
 #include <stdbool.h>
 #include <string.h>
+#include <fcntl.h>
+#include <sys/ioctl.h>
+#include <linux/spi/spidev.h>
 #include "spi.h"
+#include "spi_protocol.h"
 #include "../../low_level_controller/vehicle_atmega2560_firmware/crc.h"
 
 /**
@@ -13,15 +17,28 @@
  */
 
 /**
- * \brief Checks whether the crc value provided by the low_level_controller is correct.
- * \param spi_miso_data Data, which has been sent from low_level_controller.
+ * \brief Device of SPI0, used by SPI_TRANSFER_SPIDEV
  * \ingroup vehicle
  */
-static bool check_CRC_miso(spi_miso_data_t spi_miso_data) { 
-    uint16_t mosi_CRC = spi_miso_data.CRC;
-    spi_miso_data.CRC = 0;
-    return mosi_CRC == crcFast((uint8_t*)(&spi_miso_data), sizeof(spi_miso_data_t));
-}
+#define SPIDEV_DEVICE "/dev/spidev0.0"
+
+/**
+ * \brief Configuration set by spi_init_config()
+ * \ingroup vehicle
+ */
+static spi_config_t spi_config;
+
+/**
+ * \brief File descriptor of SPIDEV_DEVICE, only SPI_TRANSFER_SPIDEV
+ * \ingroup vehicle
+ */
+static int spidev_fd = -1;
+
+/**
+ * \brief One entry per byte of a frame for the spidev ioctl, so that the kernel can pause after each byte
+ * \ingroup vehicle
+ */
+static struct spi_ioc_transfer spidev_transfers[SPI_BUFFER_SIZE];
 
 /**
  * \brief The purpose of this variable is just to make sure that for-loop in busy wait
@@ -42,18 +59,99 @@ static void busy_wait(int n) {
     }
 }
 
-void spi_init() {
-    if (!bcm2835_spi_begin()) {
-        printf("bcm2835_spi_begin failed. Are you running as root??\n");
-        exit(EXIT_FAILURE);
+/**
+ * \brief Transfers a frame byte by byte with bcm2835_spi_transfer, SPI_TRANSFER_BYTEWISE
+ * \ingroup vehicle
+ */
+static void transfer_frame_bytewise(const uint8_t *mosi, uint8_t *miso, int n_bytes, void *context) {
+    (void) context;
+
+    busy_wait(2000);
+
+    for (int i = 0; i < n_bytes; ++i)
+    {
+        miso[i] = bcm2835_spi_transfer(mosi[i]);
+        busy_wait(3000);
+    }
+
+    busy_wait(10000);
+}
+
+/**
+ * \brief Transfers a frame with a single ioctl, SPI_TRANSFER_SPIDEV
+ * \ingroup vehicle
+ */
+static void transfer_frame_spidev(const uint8_t *mosi, uint8_t *miso, int n_bytes, void *context) {
+    (void) context;
+
+    for (int i = 0; i < n_bytes; ++i)
+    {
+        spidev_transfers[i].tx_buf = (unsigned long)(mosi + i);
+        spidev_transfers[i].rx_buf = (unsigned long)(miso + i);
+    }
+
+    if (ioctl(spidev_fd, SPI_IOC_MESSAGE(SPI_BUFFER_SIZE), spidev_transfers) < 0) {
+        // Fails the CRC check, the frame is repeated
+        memset(miso, 0, n_bytes);
     }
+}
+
+spi_config_t spi_default_config() {
+    spi_config_t config;
+    config.mode = SPI_TRANSFER_BYTEWISE;
+    config.speed_hz = 1000000;
+    config.inter_byte_delay_us = 10;
+    config.inter_frame_delay_us = 10;
+    return config;
+}
+
+void spi_init() {
+    spi_init_config(spi_default_config());
+}
+
+void spi_init_config(spi_config_t config) {
+    spi_config = config;
 
     crcInit();
 
-    bcm2835_spi_setBitOrder(BCM2835_SPI_BIT_ORDER_MSBFIRST);
-    bcm2835_spi_setDataMode(BCM2835_SPI_MODE0);
-    bcm2835_spi_setClockDivider(BCM2835_SPI_CLOCK_DIVIDER_256);
-    bcm2835_spi_chipSelect(BCM2835_SPI_CS_NONE);
+    if (spi_config.mode == SPI_TRANSFER_SPIDEV) {
+        spidev_fd = open(SPIDEV_DEVICE, O_RDWR);
+        if (spidev_fd < 0) {
+            printf("Opening %s failed. Is SPI enabled in /boot/config.txt?\n", SPIDEV_DEVICE);
+            exit(EXIT_FAILURE);
+        }
+
+        // The chip select is driven manually below, as for SPI_TRANSFER_BYTEWISE
+        uint8_t mode = SPI_MODE_0 | SPI_NO_CS;
+        uint8_t bits = 8;
+        if (ioctl(spidev_fd, SPI_IOC_WR_MODE, &mode) < 0
+            || ioctl(spidev_fd, SPI_IOC_WR_BITS_PER_WORD, &bits) < 0
+            || ioctl(spidev_fd, SPI_IOC_WR_MAX_SPEED_HZ, &spi_config.speed_hz) < 0) {
+            printf("Configuring %s failed.\n", SPIDEV_DEVICE);
+            exit(EXIT_FAILURE);
+        }
+
+        memset(spidev_transfers, 0, sizeof(spidev_transfers));
+        for (int i = 0; i < SPI_BUFFER_SIZE; ++i)
+        {
+            spidev_transfers[i].len = 1;
+            spidev_transfers[i].speed_hz = spi_config.speed_hz;
+            spidev_transfers[i].bits_per_word = 8;
+            spidev_transfers[i].delay_usecs = spi_config.inter_byte_delay_us;
+        }
+        spidev_transfers[SPI_BUFFER_SIZE - 1].delay_usecs = spi_config.inter_frame_delay_us;
+    }
+    else {
+        if (!bcm2835_spi_begin()) {
+            printf("bcm2835_spi_begin failed. Are you running as root??\n");
+            exit(EXIT_FAILURE);
+        }
+
+        bcm2835_spi_setBitOrder(BCM2835_SPI_BIT_ORDER_MSBFIRST);
+        bcm2835_spi_setDataMode(BCM2835_SPI_MODE0);
+        bcm2835_spi_setClockDivider(BCM2835_SPI_CLOCK_DIVIDER_256);
+        bcm2835_spi_chipSelect(BCM2835_SPI_CS_NONE);
+    }
 
     // enable CS pin
     bcm2835_gpio_fsel(RPI_GPIO_P1_24, BCM2835_GPIO_FSEL_OUTP);
@@ -72,38 +170,21 @@ void spi_transfer(
     int *transmission_successful_out
 )
 {
-    *transmission_successful_out = 0;
-
-    spi_mosi_data.CRC = crcFast((uint8_t*)(&spi_mosi_data), sizeof(spi_mosi_data_t));
-
     // CS low => transmission start
     bcm2835_gpio_clr(RPI_GPIO_P1_24);
 
-    for (int i = 1; i < 4; ++i) // Try transmission 3 times at most
-    {
-        uint8_t SPI_recv_buffer[SPI_BUFFER_SIZE];
-        uint8_t* mosi_data_ptr = (uint8_t*)(&spi_mosi_data);
-
-
-        busy_wait(2000);
-
-        for (int i = 0; i < SPI_BUFFER_SIZE; ++i)
-        {
-            SPI_recv_buffer[i] = bcm2835_spi_transfer(mosi_data_ptr[i]);
-            busy_wait(3000);
-        }
-
-        busy_wait(10000);
-
-        *n_transmission_attempts_out = i;
+    if (spi_config.mode == SPI_TRANSFER_SPIDEV) {
+        // Time for the pin change interrupt of the ATmega, which loads the first byte
+        usleep(spi_config.inter_frame_delay_us);
 
-        memcpy(spi_miso_data_out, SPI_recv_buffer, sizeof(spi_miso_data_t));
-
-        if(check_CRC_miso(*spi_miso_data_out) && !(spi_miso_data_out->status_flags & 2))
-        {
-            *transmission_successful_out = 1;
-            break;
-        }
+        spi_protocol_exchange(spi_mosi_data, spi_miso_data_out,
+            n_transmission_attempts_out, transmission_successful_out,
+            transfer_frame_spidev, NULL);
+    }
+    else {
+        spi_protocol_exchange(spi_mosi_data, spi_miso_data_out,
+            n_transmission_attempts_out, transmission_successful_out,
+            transfer_frame_bytewise, NULL);
     }
 
     // CS high => transmission end
@@ -1,12 +1,62 @@
 #pragma once
+#include <stdint.h>
 #include "../../low_level_controller/vehicle_atmega2560_firmware/spi_packets.h"
 
 /**
- * \brief Sets up all relevant registers such that SPI can be used.
+ * \brief How the frames are moved over the bus, see spi_config_t
+ * \ingroup vehicle
+ */
+typedef enum
+{
+    //! One bcm2835_spi_transfer per byte with busy waits in between (default)
+    SPI_TRANSFER_BYTEWISE = 0,
+    //! One ioctl on /dev/spidev0.0 per frame, the kernel pauses between the bytes without using the CPU
+    SPI_TRANSFER_SPIDEV = 1
+} spi_transfer_mode_t;
+
+/**
+ * \brief Configuration of the SPI master.
+ *
+ * The ATmega is the slave and loads the next byte into its data register in an interrupt
+ * after each byte, the frames and CRCs are handled in the interrupts as well (see spi_slave.h).
+ * Since its transmit register is not buffered, it cannot keep up with back-to-back bytes,
+ * so a single transfer of the whole frame needs a pause of at least the interrupt latency
+ * after every byte (inter_byte_delay_us).
+ * \ingroup vehicle
+ */
+typedef struct
+{
+    //! Transfer mode
+    spi_transfer_mode_t mode;
+    //! SPI clock in Hz, only SPI_TRANSFER_SPIDEV (SPI_TRANSFER_BYTEWISE uses BCM2835_SPI_CLOCK_DIVIDER_256)
+    uint32_t speed_hz;
+    //! Pause after each byte, which the ATmega needs to prepare the next byte, only SPI_TRANSFER_SPIDEV
+    uint16_t inter_byte_delay_us;
+    //! Pause after the slave select and after each frame, only SPI_TRANSFER_SPIDEV
+    uint16_t inter_frame_delay_us;
+} spi_config_t;
+
+/**
+ * \brief Default configuration: SPI_TRANSFER_BYTEWISE, which matches the timing that has been used so far
+ * \ingroup vehicle
+ */
+spi_config_t spi_default_config();
+
+/**
+ * \brief Sets up all relevant registers such that SPI can be used, with the default configuration.
+ *        bcm2835_init() must be called first.
  * \ingroup vehicle
  */
 void spi_init();
 
+/**
+ * \brief Sets up all relevant registers such that SPI can be used.
+ *        bcm2835_init() must be called first.
+ * \param config Transfer mode and timing
+ * \ingroup vehicle
+ */
+void spi_init_config(spi_config_t config);
+
 /**
  * \brief Exchanges fixed bytes of data with the mid_level_controller via SPI.
  *        Note: This mid_level_controller is the master.
@@ -25,4 +75,4 @@ void spi_transfer(
     spi_miso_data_t *spi_miso_data_out,
     int *n_transmission_attempts_out,
     int *transmission_successful_out
-);
\ No newline at end of file
+);
@@ -0,0 +1,54 @@
+#include <string.h>
+#include "spi_protocol.h"
+#include "../../low_level_controller/vehicle_atmega2560_firmware/crc.h"
+
+/**
+ * \file spi_protocol.c
+ * \ingroup vehicle
+ */
+
+void spi_protocol_set_CRC_mosi(spi_mosi_data_t *spi_mosi_data) {
+    spi_mosi_data->CRC = 0;
+    spi_mosi_data->CRC = crcSlice8((uint8_t*)(spi_mosi_data), sizeof(spi_mosi_data_t));
+}
+
+bool spi_protocol_check_CRC_miso(const spi_miso_data_t *spi_miso_data) {
+    spi_miso_data_t copy = *spi_miso_data;
+    copy.CRC = 0;
+    return spi_miso_data->CRC == crcSlice8((uint8_t*)(&copy), sizeof(spi_miso_data_t));
+}
+
+void spi_protocol_exchange(
+    spi_mosi_data_t spi_mosi_data,
+    spi_miso_data_t *spi_miso_data_out,
+    int *n_transmission_attempts_out,
+    int *transmission_successful_out,
+    spi_transfer_frame_t transfer_frame,
+    void *context
+)
+{
+    *transmission_successful_out = 0;
+    *n_transmission_attempts_out = 0;
+
+    // The frame is longer than the mosi packet, the remaining bytes are padding
+    uint8_t SPI_send_buffer[SPI_BUFFER_SIZE];
+    memset(SPI_send_buffer, 0, SPI_BUFFER_SIZE);
+    spi_protocol_set_CRC_mosi(&spi_mosi_data);
+    memcpy(SPI_send_buffer, &spi_mosi_data, sizeof(spi_mosi_data_t));
+
+    for (int i = 1; i <= SPI_MAX_TRANSMISSION_ATTEMPTS; ++i)
+    {
+        uint8_t SPI_recv_buffer[SPI_BUFFER_SIZE];
+        transfer_frame(SPI_send_buffer, SPI_recv_buffer, SPI_BUFFER_SIZE, context);
+
+        *n_transmission_attempts_out = i;
+
+        memcpy(spi_miso_data_out, SPI_recv_buffer, sizeof(spi_miso_data_t));
+
+        if(spi_protocol_check_CRC_miso(spi_miso_data_out) && !(spi_miso_data_out->status_flags & 2))
+        {
+            *transmission_successful_out = 1;
+            break;
+        }
+    }
+}
@@ -0,0 +1,63 @@
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+#include "../../low_level_controller/vehicle_atmega2560_firmware/spi_packets.h"
+
+/**
+ * \file spi_protocol.h
+ * \brief Framing, CRC and retry logic of the SPI exchange with the low_level_controller,
+ *        independent of the SPI hardware so that it can be tested on a host with a loopback mock.
+ *
+ * One exchange consists of up to SPI_MAX_TRANSMISSION_ATTEMPTS frames of SPI_BUFFER_SIZE bytes
+ * while the slave select stays low. The low_level_controller answers with its status flag
+ * "mosi packet not received" (bit 1) until it has received a frame with a correct CRC,
+ * so the first attempt never succeeds.
+ *
+ * \ingroup vehicle
+ */
+
+/**
+ * \brief Maximum number of frames per exchange
+ * \ingroup vehicle
+ */
+#define SPI_MAX_TRANSMISSION_ATTEMPTS 3
+
+/**
+ * \brief Transfers one frame of n_bytes in both directions.
+ * \param mosi Bytes to be sent to the low_level_controller
+ * \param miso Bytes received from the low_level_controller
+ * \param n_bytes Frame length, SPI_BUFFER_SIZE
+ * \param context User data, e.g. the state of a mock
+ * \ingroup vehicle
+ */
+typedef void (*spi_transfer_frame_t)(const uint8_t *mosi, uint8_t *miso, int n_bytes, void *context);
+
+/**
+ * \brief Fills the CRC of a mosi packet, computed with CRC = 0.
+ * \param spi_mosi_data The package to be sent to low_level_controller
+ * \ingroup vehicle
+ */
+void spi_protocol_set_CRC_mosi(spi_mosi_data_t *spi_mosi_data);
+
+/**
+ * \brief Checks whether the crc value provided by the low_level_controller is correct.
+ * \param spi_miso_data Data, which has been sent from low_level_controller.
+ * \ingroup vehicle
+ */
+bool spi_protocol_check_CRC_miso(const spi_miso_data_t *spi_miso_data);
+
+/**
+ * \brief Exchanges one packet with the low_level_controller, see spi_transfer() for the parameters.
+ *        crcInit() must be called first.
+ * \param transfer_frame Transfers a single frame, called once per attempt
+ * \param context Passed to transfer_frame
+ * \ingroup vehicle
+ */
+void spi_protocol_exchange(
+    spi_mosi_data_t spi_mosi_data,
+    spi_miso_data_t *spi_miso_data_out,
+    int *n_transmission_attempts_out,
+    int *transmission_successful_out,
+    spi_transfer_frame_t transfer_frame,
+    void *context
+);
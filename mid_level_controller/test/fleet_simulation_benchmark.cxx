@@ -0,0 +1,125 @@
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cstdlib>
+#include <ctime>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include "cpm/CommandLineReader.hpp"
+#include "cpm/Logging.hpp"
+#include "cpm/init.hpp"
+
+#include "SimulationCollisionGrid.hpp"
+#include "SimulationFleet.hpp"
+
+/**
+ * \file fleet_simulation_benchmark.cxx
+ * \brief Benchmark of SimulationFleet: Collision check (grid vs. all pairs) and CPU time per simulated step
+ * for 10, 50 and 200 vehicles. The simulation runs in virtual time, as fast as possible.
+ * \ingroup vehicle
+ */
+
+/**
+ * \brief CPU time of the whole process (all threads) in seconds
+ * \ingroup vehicle
+ */
+static double process_cpu_time()
+{
+    timespec t;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &t);
+    return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+/**
+ * \brief Random vehicle poses on an area that grows with the number of vehicles, plus some forced collisions
+ * \param n Number of vehicles
+ * \ingroup vehicle
+ */
+static std::vector<PathNode> random_poses(size_t n)
+{
+    std::vector<PathNode> poses;
+    const double side = sqrt(n * 0.3);
+    for (size_t i = 0; i < n; ++i)
+    {
+        double yaw = 2 * M_PI * rand() / RAND_MAX;
+        double x = side * rand() / RAND_MAX;
+        double y = side * rand() / RAND_MAX;
+        if(i % 10 == 9)
+        {
+            // Overlaps with the previous vehicle
+            x = poses.back().x + 0.1;
+            y = poses.back().y + 0.05;
+        }
+        poses.push_back(PathNode(x, y, cos(yaw), sin(yaw)));
+    }
+    return poses;
+}
+
+/**
+ * \brief Runs the benchmarks
+ * \ingroup vehicle
+ */
+int main(int argc, char *argv[])
+{
+    cpm::init(argc, argv);
+    cpm::Logging::Instance().set_id("fleet_simulation_benchmark");
+    const int n_steps = cpm::cmd_parameter_int("steps", 500, argc, argv);
+    const int n_threads = cpm::cmd_parameter_int("threads", 0, argc, argv);
+
+    std::cout << "Collision check" << std::endl;
+    for (size_t n : {10, 50, 200, 1000})
+    {
+        std::vector<PathNode> poses = random_poses(n);
+        SimulationCollisionGrid grid;
+        std::vector<std::pair<size_t, size_t>> collisions_grid;
+        std::vector<std::pair<size_t, size_t>> collisions_pairwise;
+
+        const int repetitions = 100;
+        auto t0 = std::chrono::steady_clock::now();
+        for (int r = 0; r < repetitions; ++r) grid.find_collisions(poses, collisions_grid);
+        auto t1 = std::chrono::steady_clock::now();
+        for (int r = 0; r < repetitions; ++r) grid.find_collisions_pairwise(poses, collisions_pairwise);
+        auto t2 = std::chrono::steady_clock::now();
+
+        assert(collisions_grid == collisions_pairwise);
+        if(collisions_grid != collisions_pairwise)
+        {
+            std::cerr << "Grid and pairwise collision check differ for " << n << " vehicles" << std::endl;
+            return 1;
+        }
+
+        std::cout << std::setw(6) << n << " vehicles | "
+            << collisions_grid.size() << " collisions | grid "
+            << std::chrono::duration<double, std::micro>(t1 - t0).count() / repetitions << " us | pairwise "
+            << std::chrono::duration<double, std::micro>(t2 - t1).count() / repetitions << " us" << std::endl;
+    }
+
+    std::cout << "Fleet step (" << n_steps << " steps)" << std::endl;
+    for (size_t n : {10, 50, 200})
+    {
+        std::vector<uint8_t> vehicle_ids;
+        for (size_t i = 1; i <= n; ++i) vehicle_ids.push_back(static_cast<uint8_t>(i));
+
+        const uint64_t period = 20000000ull;
+        uint64_t t_now = 1000000000000ull;
+        SimulationFleet fleet(vehicle_ids, [&](){ return t_now; }, static_cast<size_t>(std::max(n_threads, 0)));
+
+        const double cpu_start = process_cpu_time();
+        auto wall_start = std::chrono::steady_clock::now();
+        for (int step = 0; step < n_steps; ++step)
+        {
+            fleet.update(t_now, period);
+            t_now += period;
+        }
+        auto wall_end = std::chrono::steady_clock::now();
+        const double cpu_end = process_cpu_time();
+
+        std::cout << std::setw(6) << n << " vehicles | CPU "
+            << (cpu_end - cpu_start) / n_steps * 1e3 << " ms/step | wall "
+            << std::chrono::duration<double, std::milli>(wall_end - wall_start).count() / n_steps << " ms/step" << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,380 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "VehicleObservation.hpp"
+#include "VehicleState.hpp"
+#include "cpm/CommandLineReader.hpp"
+
+#include "Localization.hpp"
+#include "LocalizationEKF.hpp"
+
+/**
+ * \file localization_replay.cxx
+ * \brief Host tool that replays a recorded (or synthetic) odometry/IMU/IPS sequence through
+ * Localization and LocalizationEKF and compares their accuracy and CPU time.
+ *
+ * CSV input (--file=...), one row per vehicle update, header line optional:
+ * t_now,imu_yaw,odometer_distance,obs_stamp,obs_x,obs_y,obs_yaw,obs_age[,true_x,true_y,true_yaw]
+ * Without ground truth, the estimate at the time of each new IPS observation is compared with that observation.
+ * Returns 1 if the errors of a filter exceed the tolerances (--max_rms_position, --max_position_error, --max_rms_yaw),
+ * s.t. the tool can be run as a test.
+ * \ingroup vehicle
+ */
+
+/**
+ * \struct ReplaySample
+ * \brief One row of the replayed sequence
+ * \ingroup vehicle
+ */
+struct ReplaySample
+{
+    //! Time of the update in ns
+    uint64_t t_now = 0;
+    //! IMU yaw in rad
+    double imu_yaw = 0;
+    //! Odometer distance in m
+    double odometer_distance = 0;
+    //! Creation time of the most recent IPS observation in ns
+    uint64_t obs_stamp = 0;
+    //! IPS pose
+    double obs_x = 0;
+    //! IPS pose
+    double obs_y = 0;
+    //! IPS pose
+    double obs_yaw = 0;
+    //! Age of the IPS observation in ns
+    uint64_t obs_age = 0;
+    //! True if the ground truth is set
+    bool has_truth = false;
+    //! Ground truth pose
+    double true_x = 0;
+    //! Ground truth pose
+    double true_y = 0;
+    //! Ground truth pose
+    double true_yaw = 0;
+};
+
+/**
+ * \struct ReplayResult
+ * \brief Accuracy and timing of one filter
+ * \ingroup vehicle
+ */
+struct ReplayResult
+{
+    //! Sum of squared position errors
+    double sum_sq_position_error = 0;
+    //! Sum of squared yaw errors
+    double sum_sq_yaw_error = 0;
+    //! Largest position error
+    double max_position_error = 0;
+    //! Number of compared samples
+    size_t n_errors = 0;
+    //! Update durations in ns
+    std::vector<double> update_durations;
+};
+
+/**
+ * \struct ReplayTolerances
+ * \brief Largest errors of a filter that are accepted
+ * \ingroup vehicle
+ */
+struct ReplayTolerances
+{
+    //! Largest RMS position error in m
+    double max_rms_position = 0;
+    //! Largest single position error in m
+    double max_position_error = 0;
+    //! Largest RMS yaw error in rad
+    double max_rms_yaw = 0;
+};
+
+/**
+ * \brief Read the CSV format described above
+ * \param filename Path to the file
+ * \ingroup vehicle
+ */
+static std::vector<ReplaySample> read_csv(const std::string& filename)
+{
+    std::vector<ReplaySample> samples;
+    std::ifstream file(filename);
+    std::string line;
+    while(std::getline(file, line))
+    {
+        if(line.empty() || !(isdigit(line[0]) || line[0] == '-')) continue;
+        std::replace(line.begin(), line.end(), ',', ' ');
+        std::stringstream stream(line);
+        ReplaySample sample;
+        stream >> sample.t_now >> sample.imu_yaw >> sample.odometer_distance
+            >> sample.obs_stamp >> sample.obs_x >> sample.obs_y >> sample.obs_yaw >> sample.obs_age;
+        if(stream.fail()) continue;
+        if(stream >> sample.true_x >> sample.true_y >> sample.true_yaw) sample.has_truth = true;
+        samples.push_back(sample);
+    }
+    return samples;
+}
+
+/**
+ * \brief Synthetic drive on a circle with odometer scale error, gyro drift and a delayed, noisy IPS with dropouts
+ * \param n_steps Number of updates
+ * \param period Update period in ns
+ * \param ips_delay_steps IPS latency in periods
+ * \ingroup vehicle
+ */
+static std::vector<ReplaySample> generate_sequence(size_t n_steps, uint64_t period, size_t ips_delay_steps)
+{
+    srand(0);
+    auto frand_sym = [](){ return 2.0 * rand() / RAND_MAX - 1.0; };
+
+    const uint64_t t_start = 1000000000000ull;
+    const double dt = period * 1e-9;
+    const double speed = 1.0;
+    const double radius = 1.2;
+
+    std::vector<ReplaySample> samples(n_steps);
+    std::vector<ReplaySample> ips_delay_buffer;
+    double x = 2.0, y = 2.0, yaw = 0, distance = 0, imu_yaw = 0.3;
+    ReplaySample last_observation;
+    bool has_observation = false;
+
+    for (size_t i = 0; i < n_steps; ++i)
+    {
+        ReplaySample& sample = samples[i];
+        sample.t_now = t_start + i * period;
+
+        const double yaw_rate = speed / radius * ((i / 1000) % 2 == 0 ? 1 : -1);
+        yaw += yaw_rate * dt;
+        x += speed * dt * cos(yaw);
+        y += speed * dt * sin(yaw);
+        distance += 1.02 * speed * dt;
+        imu_yaw = remainder(imu_yaw + yaw_rate * dt + 1e-4 * frand_sym() + 2e-5, 2*M_PI);
+
+        sample.imu_yaw = imu_yaw;
+        sample.odometer_distance = distance;
+        sample.has_truth = true;
+        sample.true_x = x;
+        sample.true_y = y;
+        sample.true_yaw = remainder(yaw, 2*M_PI);
+
+        if(rand() % 20 != 1)
+        {
+            ReplaySample observation;
+            observation.obs_stamp = sample.t_now;
+            observation.obs_x = x + 0.002 * frand_sym();
+            observation.obs_y = y + 0.002 * frand_sym();
+            observation.obs_yaw = remainder(yaw + 0.01 * frand_sym(), 2*M_PI);
+            ips_delay_buffer.push_back(observation);
+        }
+
+        while(!ips_delay_buffer.empty() && ips_delay_buffer.front().obs_stamp + ips_delay_steps * period <= sample.t_now)
+        {
+            last_observation = ips_delay_buffer.front();
+            ips_delay_buffer.erase(ips_delay_buffer.begin());
+            has_observation = true;
+        }
+
+        sample.obs_stamp = last_observation.obs_stamp;
+        sample.obs_x = last_observation.obs_x;
+        sample.obs_y = last_observation.obs_y;
+        sample.obs_yaw = last_observation.obs_yaw;
+        sample.obs_age = has_observation ? (sample.t_now - last_observation.obs_stamp) : 1000000000000ull;
+    }
+    return samples;
+}
+
+/**
+ * \brief Run one filter over the sequence
+ * \param filter Localization or LocalizationEKF
+ * \param samples The sequence
+ * \param period Update period in ns
+ * \param warmup_steps Steps that are ignored for the accuracy
+ * \ingroup vehicle
+ */
+template<typename Filter>
+static ReplayResult replay(Filter& filter, const std::vector<ReplaySample>& samples, uint64_t period, size_t warmup_steps)
+{
+    ReplayResult result;
+    result.update_durations.reserve(samples.size());
+    std::vector<Pose2D> outputs;
+    outputs.reserve(samples.size());
+    uint64_t last_obs_stamp = 0;
+
+    for (size_t i = 0; i < samples.size(); ++i)
+    {
+        const ReplaySample& sample = samples[i];
+
+        VehicleState vehicleState;
+        vehicleState.imu_yaw(sample.imu_yaw);
+        vehicleState.odometer_distance(sample.odometer_distance);
+
+        VehicleObservation observation;
+        observation.header().create_stamp().nanoseconds(sample.obs_stamp);
+        observation.pose().x(sample.obs_x);
+        observation.pose().y(sample.obs_y);
+        observation.pose().yaw(sample.obs_yaw);
+
+        auto t_start = std::chrono::steady_clock::now();
+        Pose2D pose = filter.update(sample.t_now, period, vehicleState, observation, sample.obs_age);
+        auto t_end = std::chrono::steady_clock::now();
+        result.update_durations.push_back(std::chrono::duration<double, std::nano>(t_end - t_start).count());
+        outputs.push_back(pose);
+
+        // Same as in main.cxx
+        if(i == 25) filter.reset();
+        if(i < warmup_steps) continue;
+
+        if(sample.has_truth)
+        {
+            double e = hypot(pose.x() - sample.true_x, pose.y() - sample.true_y);
+            double e_yaw = remainder(pose.yaw() - sample.true_yaw, 2*M_PI);
+            result.sum_sq_position_error += e*e;
+            result.sum_sq_yaw_error += e_yaw*e_yaw;
+            result.max_position_error = std::max(result.max_position_error, e);
+            result.n_errors++;
+        }
+        else if(sample.obs_stamp != last_obs_stamp && sample.obs_stamp <= sample.t_now)
+        {
+            // Compare the estimate at the observation time with the observation
+            size_t steps_back = (sample.t_now - sample.obs_stamp + period - 1) / period;
+            if(steps_back <= i && steps_back + warmup_steps <= i)
+            {
+                const Pose2D& past_pose = outputs[i - steps_back];
+                double e = hypot(past_pose.x() - sample.obs_x, past_pose.y() - sample.obs_y);
+                double e_yaw = remainder(past_pose.yaw() - sample.obs_yaw, 2*M_PI);
+                result.sum_sq_position_error += e*e;
+                result.sum_sq_yaw_error += e_yaw*e_yaw;
+                result.max_position_error = std::max(result.max_position_error, e);
+                result.n_errors++;
+            }
+        }
+        last_obs_stamp = sample.obs_stamp;
+    }
+    return result;
+}
+
+/**
+ * \brief Print accuracy and timing statistics
+ * \param name Name of the filter
+ * \param result Replay result
+ * \ingroup vehicle
+ */
+static void print_result(const std::string& name, ReplayResult result)
+{
+    std::vector<double>& d = result.update_durations;
+    std::sort(d.begin(), d.end());
+    double mean = 0;
+    for (double v : d) mean += v;
+    mean /= std::max<size_t>(d.size(), 1);
+
+    const size_t n = std::max<size_t>(result.n_errors, 1);
+    std::cout << std::setw(10) << name
+        << std::fixed << std::setprecision(4)
+        << " | RMS pos [m] " << sqrt(result.sum_sq_position_error / n)
+        << " | max pos [m] " << result.max_position_error
+        << " | RMS yaw [rad] " << sqrt(result.sum_sq_yaw_error / n)
+        << std::setprecision(2)
+        << " | mean [us] " << mean * 1e-3
+        << " | p99 [us] " << d.at(d.size() * 99 / 100) * 1e-3
+        << " | max [us] " << d.back() * 1e-3
+        << std::endl;
+}
+
+/**
+ * \brief Check the accuracy of a filter against the tolerances, print the exceeded ones
+ * \param name Name of the filter
+ * \param result Replay result
+ * \param tolerances Accepted errors
+ * \return False if no sample was compared or a tolerance was exceeded
+ * \ingroup vehicle
+ */
+static bool check_result(const std::string& name, const ReplayResult& result, const ReplayTolerances& tolerances)
+{
+    if(result.n_errors == 0)
+    {
+        std::cerr << name << ": no samples to compare with, check the input and --warmup_steps" << std::endl;
+        return false;
+    }
+
+    const double rms_position = sqrt(result.sum_sq_position_error / result.n_errors);
+    const double rms_yaw = sqrt(result.sum_sq_yaw_error / result.n_errors);
+    bool is_ok = true;
+    if(rms_position > tolerances.max_rms_position)
+    {
+        std::cerr << name << ": RMS position error " << rms_position << " m exceeds " << tolerances.max_rms_position << " m" << std::endl;
+        is_ok = false;
+    }
+    if(result.max_position_error > tolerances.max_position_error)
+    {
+        std::cerr << name << ": max position error " << result.max_position_error << " m exceeds " << tolerances.max_position_error << " m" << std::endl;
+        is_ok = false;
+    }
+    if(rms_yaw > tolerances.max_rms_yaw)
+    {
+        std::cerr << name << ": RMS yaw error " << rms_yaw << " rad exceeds " << tolerances.max_rms_yaw << " rad" << std::endl;
+        is_ok = false;
+    }
+    return is_ok;
+}
+
+/**
+ * \brief Replays a sequence through both localization filters
+ * \ingroup vehicle
+ */
+int main(int argc, char *argv[])
+{
+    const std::string filename = cpm::cmd_parameter_string("file", "", argc, argv);
+    const uint64_t period = cpm::cmd_parameter_uint64_t("period", 20000000ull, argc, argv);
+    const int n_steps = cpm::cmd_parameter_int("steps", 50000, argc, argv);
+    const int ips_delay_steps = cpm::cmd_parameter_int("ips_delay_steps", 4, argc, argv);
+    const int warmup_steps = cpm::cmd_parameter_int("warmup_steps", 100, argc, argv);
+
+    ReplayTolerances tolerances;
+    tolerances.max_rms_position = cpm::cmd_parameter_double("max_rms_position", 0.02, argc, argv);
+    tolerances.max_position_error = cpm::cmd_parameter_double("max_position_error", 0.1, argc, argv);
+    tolerances.max_rms_yaw = cpm::cmd_parameter_double("max_rms_yaw", 0.02, argc, argv);
+
+    std::vector<ReplaySample> samples;
+    if(filename.empty())
+    {
+        std::cout << "Synthetic sequence: " << n_steps << " steps, IPS delay " << ips_delay_steps << " steps" << std::endl;
+        samples = generate_sequence(n_steps, period, ips_delay_steps);
+    }
+    else
+    {
+        samples = read_csv(filename);
+        std::cout << "Read " << samples.size() << " samples from " << filename << std::endl;
+    }
+
+    if(samples.empty())
+    {
+        std::cerr << "Usage: localization_replay --file=CSV(optional) --period=NS --steps=INT --ips_delay_steps=INT --warmup_steps=INT"
+            " --max_rms_position=M --max_position_error=M --max_rms_yaw=RAD" << std::endl;
+        return 1;
+    }
+
+    // The filters hold large state histories, keep them off the stack
+    std::unique_ptr<Localization> localization(new Localization());
+    std::unique_ptr<LocalizationEKF> localization_ekf(new LocalizationEKF());
+
+    const ReplayResult result = replay(*localization, samples, period, warmup_steps);
+    const ReplayResult result_ekf = replay(*localization_ekf, samples, period, warmup_steps);
+    print_result("buffer", result);
+    print_result("ekf", result_ekf);
+
+    // Both checks are run, s.t. all exceeded tolerances are printed
+    const bool is_ok = check_result("buffer", result, tolerances);
+    const bool is_ok_ekf = check_result("ekf", result_ekf, tolerances);
+    if(!is_ok || !is_ok_ekf)
+    {
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,207 @@
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include "MpcGradientStep.hpp"
+#include "MpcParameters.hpp"
+#include "casadi_mpc_fn.h"
+
+/**
+ * \file mpc_horizon_benchmark.cxx
+ * \brief Checks MpcGradientStep against the CasADi generated casadi_mpc_fn (6 / 3 steps, dt = 0.05)
+ * and measures the solve time (one control cycle, i.e. MpcParameters::iterations gradient steps)
+ * as a function of the prediction horizon.
+ * \ingroup vehicle
+ */
+
+/**
+ * \brief Buffers for the arguments and results of one MPC function, layout as in casadi_mpc_fn
+ * \ingroup vehicle
+ */
+struct MpcBuffers
+{
+    //! Arguments, see MpcGradientStep::operator()
+    std::vector<std::vector<casadi_real>> arguments;
+    //! Results, see MpcGradientStep::operator()
+    std::vector<std::vector<casadi_real>> results;
+    //! Pointers into arguments
+    std::vector<const casadi_real*> argument_pointers;
+    //! Pointers into results
+    std::vector<casadi_real*> result_pointers;
+
+    MpcBuffers(size_t Hp, size_t Hu)
+    {
+        arguments = {
+            std::vector<casadi_real>(4), std::vector<casadi_real>(2),
+            std::vector<casadi_real>(Hu * 3), std::vector<casadi_real>(Hu * 3),
+            std::vector<casadi_real>(10), std::vector<casadi_real>(Hp), std::vector<casadi_real>(Hp),
+            std::vector<casadi_real>(1), std::vector<casadi_real>(1)
+        };
+        results = {
+            std::vector<casadi_real>(Hp), std::vector<casadi_real>(Hp), std::vector<casadi_real>(1),
+            std::vector<casadi_real>(Hu * 3), std::vector<casadi_real>(Hu * 3)
+        };
+        for (auto& a : arguments) argument_pointers.push_back(a.data());
+        for (auto& r : results) result_pointers.push_back(r.data());
+    }
+};
+
+/**
+ * \brief Random value in [lo, hi]
+ * \ingroup vehicle
+ */
+static double random_uniform(double lo, double hi)
+{
+    return lo + (hi - lo) * rand() / double(RAND_MAX);
+}
+
+/**
+ * \brief Fills the arguments like MpcController does, with a reference on a circle ahead of the vehicle
+ * \ingroup vehicle
+ */
+static void fill_arguments(MpcBuffers& buffers, size_t Hp, size_t Hu, double dt, const MpcParameters& parameters, bool randomize)
+{
+    auto& a = buffers.arguments;
+    const double speed = randomize ? random_uniform(0.2, 1.5) : 1.0;
+    a[0] = {randomize ? random_uniform(0, 4) : 2.0, randomize ? random_uniform(0, 4) : 2.0, randomize ? random_uniform(-3, 3) : 0.3, speed};
+    a[1] = {randomize ? random_uniform(-1, 1) : 0.2, randomize ? random_uniform(-1, 1) : 0.1};
+    for (size_t j = 0; j < Hu; ++j)
+    {
+        a[2][j] = randomize ? random_uniform(-1, 1) : 1e-12;
+        a[2][Hu + j] = randomize ? random_uniform(-1, 1) : 1e-12;
+        a[2][2 * Hu + j] = randomize ? random_uniform(7, 8.4) : 8;
+        a[3][j] = randomize ? random_uniform(-0.1, 0.1) : 0;
+        a[3][Hu + j] = randomize ? random_uniform(-0.1, 0.1) : 0;
+        a[3][2 * Hu + j] = 0;
+    }
+    a[4] = parameters.dynamics_parameters;
+    for (size_t k = 0; k < Hp; ++k)
+    {
+        const double s = speed * dt * (k + 1);
+        a[5][k] = a[0][0] + sin(s) + (randomize ? random_uniform(-0.05, 0.05) : 0);
+        a[6][k] = a[0][1] + 1 - cos(s) + (randomize ? random_uniform(-0.05, 0.05) : 0);
+    }
+    a[7] = {parameters.learning_rate};
+    a[8] = {parameters.momentum_rate};
+}
+
+/**
+ * \brief One control cycle as in MpcController::optimize_control_inputs
+ * \ingroup vehicle
+ */
+template<typename F>
+static void solve(F&& f, MpcBuffers& buffers, size_t Hu, int iterations)
+{
+    auto& a = buffers.arguments;
+    auto& r = buffers.results;
+    for (int i = 0; i < iterations; ++i)
+    {
+        for (size_t j = 0; j < 2 * Hu; ++j)
+        {
+            a[2][j] = fmin(1.0, fmax(-1.0, r[4][j]));
+            a[3][j] = r[3][j];
+        }
+        f(buffers.argument_pointers.data(), buffers.result_pointers.data());
+    }
+}
+
+int main()
+{
+    const MpcParameters parameters;
+
+    // Same results as the CasADi function
+    {
+        const size_t Hp = 6;
+        const size_t Hu = 3;
+        MpcGradientStep gradient_step(Hp, Hu, 0.05);
+        double max_difference = 0;
+        srand(1);
+        for (int trial = 0; trial < 1000; ++trial)
+        {
+            MpcBuffers casadi_buffers(Hp, Hu);
+            fill_arguments(casadi_buffers, Hp, Hu, 0.05, parameters, true);
+            MpcBuffers generic_buffers = casadi_buffers;
+            generic_buffers.argument_pointers.clear();
+            generic_buffers.result_pointers.clear();
+            for (auto& v : generic_buffers.arguments) generic_buffers.argument_pointers.push_back(v.data());
+            for (auto& v : generic_buffers.results) generic_buffers.result_pointers.push_back(v.data());
+
+            casadi_mpc_fn(casadi_buffers.argument_pointers.data(), casadi_buffers.result_pointers.data(), nullptr, nullptr, 0);
+            gradient_step(generic_buffers.argument_pointers.data(), generic_buffers.result_pointers.data());
+
+            for (size_t i = 0; i < casadi_buffers.results.size(); ++i)
+            {
+                for (size_t j = 0; j < casadi_buffers.results[i].size(); ++j)
+                {
+                    const double expected = casadi_buffers.results[i][j];
+                    const double difference = fabs(generic_buffers.results[i][j] - expected) / std::max(1.0, fabs(expected));
+                    max_difference = std::max(max_difference, difference);
+                }
+            }
+        }
+        std::cout << "MpcGradientStep vs. casadi_mpc_fn: max relative difference " << max_difference << std::endl;
+        if(!(max_difference < 1e-9))
+        {
+            std::cerr << "MpcGradientStep differs from casadi_mpc_fn" << std::endl;
+            return 1;
+        }
+    }
+
+    // Solve time per control cycle
+    const int n_cycles = 2000;
+    std::cout << "Solve time per control cycle (" << parameters.iterations << " gradient steps), us" << std::endl;
+    std::cout << "    Hp    Hu |     mean      p99 | objective" << std::endl;
+
+    auto report = [&](size_t Hp, size_t Hu, const char* name, std::vector<double>& times, double objective) {
+        std::sort(times.begin(), times.end());
+        double mean = 0;
+        for (double t : times) mean += t;
+        mean /= times.size();
+        std::cout << std::setw(6) << Hp << std::setw(6) << Hu << " | "
+            << std::setw(8) << std::fixed << std::setprecision(1) << mean << " "
+            << std::setw(8) << times[times.size() * 99 / 100] << " | "
+            << std::setprecision(4) << objective << " " << name << std::endl;
+        std::cout.unsetf(std::ios::fixed);
+    };
+
+    {
+        MpcBuffers buffers(6, 3);
+        std::vector<double> times;
+        for (int cycle = 0; cycle < n_cycles; ++cycle)
+        {
+            fill_arguments(buffers, 6, 3, 0.05, parameters, false);
+            auto t0 = std::chrono::steady_clock::now();
+            solve([](const casadi_real** arg, casadi_real** res) { casadi_mpc_fn(arg, res, nullptr, nullptr, 0); },
+                buffers, 3, parameters.iterations);
+            auto t1 = std::chrono::steady_clock::now();
+            times.push_back(std::chrono::duration<double, std::micro>(t1 - t0).count());
+        }
+        report(6, 3, "(casadi_mpc_fn)", times, buffers.results[2][0]);
+    }
+
+    for (size_t Hp : {3, 6, 10, 15, 20, 30})
+    {
+        const size_t Hu = std::max<size_t>(1, Hp / 2);
+        // Same prediction time span as the default
+        const double dt = 0.3 / Hp;
+        MpcGradientStep gradient_step(Hp, Hu, dt);
+        MpcBuffers buffers(Hp, Hu);
+        std::vector<double> times;
+        for (int cycle = 0; cycle < n_cycles; ++cycle)
+        {
+            fill_arguments(buffers, Hp, Hu, dt, parameters, false);
+            auto t0 = std::chrono::steady_clock::now();
+            solve(gradient_step, buffers, Hu, parameters.iterations);
+            auto t1 = std::chrono::steady_clock::now();
+            times.push_back(std::chrono::duration<double, std::micro>(t1 - t0).count());
+        }
+        report(Hp, Hu, "(MpcGradientStep)", times, buffers.results[2][0]);
+    }
+
+    return 0;
+}
@@ -0,0 +1,209 @@
+#include <cassert>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+extern "C" {
+#include "../../low_level_controller/vehicle_atmega2560_firmware/crc.h"
+#include "spi_protocol.h"
+}
+
+/**
+ * \file spi_crc_test.cxx
+ * \brief Host test of the CRC implementations and of the SPI framing / retry logic with a loopback mock
+ * of the low_level_controller, followed by a CRC benchmark.
+ * \ingroup vehicle
+ */
+
+/**
+ * \brief Behaves like spi_exchange() of the low_level_controller for one exchange (slave select low),
+ * optionally with bit errors on the bus.
+ * \ingroup vehicle
+ */
+struct LoopbackSlave
+{
+    //! Answer if the last received mosi frame had a correct CRC
+    uint8_t miso_correct_CRC[SPI_BUFFER_SIZE];
+    //! Answer otherwise, also before the first frame
+    uint8_t miso_wrong_CRC[SPI_BUFFER_SIZE];
+    //! Points to one of the two answers
+    uint8_t* miso_buffer;
+    //! Last correctly received packet
+    spi_mosi_data_t packet_received;
+    //! Whether packet_received is valid
+    bool received = false;
+    //! Number of frames so far
+    int n_frames = 0;
+    //! Frames (1-based) in which a mosi bit is flipped
+    std::vector<int> corrupt_mosi_frames;
+    //! Frames (1-based) in which a miso bit is flipped
+    std::vector<int> corrupt_miso_frames;
+
+    LoopbackSlave(spi_miso_data_t packet_send)
+    {
+        packet_send.status_flags &= ~2;
+        packet_send.CRC = 0;
+        packet_send.CRC = crcFast((uint8_t*)(&packet_send), sizeof(spi_miso_data_t));
+        memset(miso_correct_CRC, 0, SPI_BUFFER_SIZE);
+        memcpy(miso_correct_CRC, &packet_send, sizeof(spi_miso_data_t));
+
+        packet_send.status_flags |= 2;
+        packet_send.CRC = 0;
+        packet_send.CRC = crcFast((uint8_t*)(&packet_send), sizeof(spi_miso_data_t));
+        memset(miso_wrong_CRC, 0, SPI_BUFFER_SIZE);
+        memcpy(miso_wrong_CRC, &packet_send, sizeof(spi_miso_data_t));
+
+        miso_buffer = miso_wrong_CRC;
+    }
+
+    static bool contains(const std::vector<int>& frames, int frame)
+    {
+        for (int f : frames) if(f == frame) return true;
+        return false;
+    }
+
+    void transfer_frame(const uint8_t *mosi, uint8_t *miso, int n_bytes)
+    {
+        assert(n_bytes == SPI_BUFFER_SIZE);
+        n_frames++;
+
+        uint8_t mosi_buffer[SPI_BUFFER_SIZE];
+        memcpy(mosi_buffer, mosi, SPI_BUFFER_SIZE);
+        memcpy(miso, miso_buffer, SPI_BUFFER_SIZE);
+
+        if(contains(corrupt_mosi_frames, n_frames)) mosi_buffer[n_frames % sizeof(spi_mosi_data_t)] ^= 0x10;
+        if(contains(corrupt_miso_frames, n_frames)) miso[n_frames % sizeof(spi_miso_data_t)] ^= 0x01;
+
+        // Validate the mosi CRC after the complete frame
+        spi_mosi_data_t* mosi_packet = (spi_mosi_data_t*) mosi_buffer;
+        const uint16_t mosi_CRC_actual = mosi_packet->CRC;
+        mosi_packet->CRC = 0;
+        if(mosi_CRC_actual == crcFast(mosi_buffer, sizeof(spi_mosi_data_t)))
+        {
+            miso_buffer = miso_correct_CRC;
+            memcpy(&packet_received, mosi_buffer, sizeof(spi_mosi_data_t));
+            received = true;
+        }
+    }
+
+    static void transfer_frame_callback(const uint8_t *mosi, uint8_t *miso, int n_bytes, void *context)
+    {
+        static_cast<LoopbackSlave*>(context)->transfer_frame(mosi, miso, n_bytes);
+    }
+};
+
+/**
+ * \brief Runs one exchange against a LoopbackSlave and checks the reported result
+ * \ingroup vehicle
+ */
+static void test_exchange(std::vector<int> corrupt_mosi_frames, std::vector<int> corrupt_miso_frames,
+    int expected_attempts, int expected_successful)
+{
+    spi_miso_data_t packet_send;
+    memset(&packet_send, 0, sizeof(spi_miso_data_t));
+    packet_send.tick = 123456;
+    packet_send.odometer_steps = -4711;
+    packet_send.imu_yaw = 31000;
+    packet_send.battery_voltage = 812;
+    packet_send.status_flags = 1;
+
+    spi_mosi_data_t spi_mosi_data;
+    memset(&spi_mosi_data, 0, sizeof(spi_mosi_data_t));
+    spi_mosi_data.motor_mode = SPI_MOTOR_MODE_FORWARD;
+    spi_mosi_data.motor_pwm = 250;
+    spi_mosi_data.servo_command = -600;
+    spi_mosi_data.vehicle_id = 7;
+
+    LoopbackSlave slave(packet_send);
+    slave.corrupt_mosi_frames = corrupt_mosi_frames;
+    slave.corrupt_miso_frames = corrupt_miso_frames;
+
+    spi_miso_data_t spi_miso_data;
+    int n_transmission_attempts = -1;
+    int transmission_successful = -1;
+    spi_protocol_exchange(spi_mosi_data, &spi_miso_data, &n_transmission_attempts, &transmission_successful,
+        LoopbackSlave::transfer_frame_callback, &slave);
+
+    assert(n_transmission_attempts == expected_attempts);
+    assert(transmission_successful == expected_successful);
+    assert(slave.n_frames == expected_attempts);
+
+    if(transmission_successful)
+    {
+        assert(slave.received);
+        assert(slave.packet_received.motor_pwm == 250);
+        assert(slave.packet_received.servo_command == -600);
+        assert(slave.packet_received.vehicle_id == 7);
+        assert(spi_miso_data.tick == 123456);
+        assert(spi_miso_data.odometer_steps == -4711);
+        assert(spi_miso_data.imu_yaw == 31000);
+        assert(spi_miso_data.battery_voltage == 812);
+        assert(spi_miso_data.status_flags == 1);
+    }
+}
+
+/**
+ * \brief Mean time per call in nanoseconds
+ * \ingroup vehicle
+ */
+static double benchmark(std::function<crc(uint8_t const*, int)> f, const std::vector<uint8_t>& data, int repetitions)
+{
+    volatile crc sink = 0;
+    auto t0 = std::chrono::steady_clock::now();
+    for (int r = 0; r < repetitions; ++r) sink = sink ^ f(data.data(), static_cast<int>(data.size()));
+    auto t1 = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(t1 - t0).count() / repetitions;
+}
+
+int main()
+{
+    crcInit();
+
+    // Values of the implementation that has been used on both sides so far
+    const uint8_t check_message[] = {'1', '2', '3', '4', '5', '6', '7', '8', '9'};
+    assert(crcSlow(check_message, 9) == 0x3590);
+    assert(crcFast(check_message, 9) == 0x3590);
+
+    // All implementations agree, for every length and alignment
+    srand(0);
+    std::vector<uint8_t> data(1024 + 8);
+    for (auto& byte : data) byte = static_cast<uint8_t>(rand());
+    for (int offset = 0; offset < 8; ++offset)
+    {
+        for (int n = 0; n <= 300; ++n)
+        {
+            const crc expected = crcSlow(data.data() + offset, n);
+            assert(crcFast(data.data() + offset, n) == expected);
+            assert(crcSlice4(data.data() + offset, n) == expected);
+            assert(crcSlice8(data.data() + offset, n) == expected);
+        }
+    }
+
+    // Framing and retry: the first frame is always answered with "mosi not received"
+    test_exchange({}, {}, 2, 1);
+    test_exchange({1}, {}, 3, 1);
+    test_exchange({}, {2}, 3, 1);
+    test_exchange({1, 2}, {}, 3, 0);
+    test_exchange({}, {2, 3}, 3, 0);
+    test_exchange({2, 3}, {}, 2, 1);
+
+    std::cout << "All tests passed" << std::endl;
+
+    // Benchmark
+    std::cout << "CRC benchmark (ns per message)" << std::endl;
+    for (int n : {12, 27, 1024})
+    {
+        std::vector<uint8_t> message(data.begin(), data.begin() + n);
+        const int repetitions = 2000000 / n;
+        std::cout << std::setw(6) << n << " bytes | slow " << benchmark(crcSlow, message, repetitions)
+            << " | fast " << benchmark(crcFast, message, repetitions)
+            << " | slice4 " << benchmark(crcSlice4, message, repetitions)
+            << " | slice8 " << benchmark(crcSlice8, message, repetitions) << std::endl;
+    }
+
+    return 0;
+}
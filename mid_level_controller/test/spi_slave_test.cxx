@@ -0,0 +1,311 @@
+#include <cassert>
+#include <cstring>
+#include <functional>
+#include <iostream>
+
+extern "C" {
+#include "../../low_level_controller/vehicle_atmega2560_firmware/crc.h"
+#include "../../low_level_controller/vehicle_atmega2560_firmware/spi_slave.h"
+#include "spi_protocol.h"
+}
+
+/**
+ * \file spi_slave_test.cxx
+ * \brief Host test of the SPI slave frame handling of the low_level_controller (spi_slave.c) against the
+ * framing and retry logic of the mid_level_controller (spi_protocol.c), connected by a simulated SPI register layer.
+ * \ingroup vehicle
+ */
+
+/**
+ * \brief Simulated SPI registers of the ATmega2560 in slave mode, with the interrupts of spi.c.
+ * The master clocks the bytes back to back; only the interrupt runs in between, as on the vehicle
+ * if the master pauses for the interrupt latency.
+ * \ingroup vehicle
+ */
+struct SimulatedSPI
+{
+    //! Firmware state, as in spi.c
+    spi_slave_t spi_slave;
+    //! Shift register, loaded by writing SPDR. Holds the received byte after a transfer, like on the AVR.
+    uint8_t shift_register = 0;
+    //! Receive buffer, read by reading SPDR
+    uint8_t receive_buffer = 0;
+    //! Writes to SPDR during a transfer (WCOL)
+    int n_write_collisions = 0;
+    //! Whether a byte is currently clocked
+    bool transfer_active = false;
+    //! Whether the slave select is low
+    bool selected = false;
+    //! Called after the given byte of each frame, e.g. to emulate the main loop
+    std::function<void(int byte)> on_byte;
+    //! Bytes clocked in the current exchange
+    int n_bytes = 0;
+
+    SimulatedSPI()
+    {
+        spi_slave_init(&spi_slave);
+    }
+
+    uint8_t read_SPDR() { return receive_buffer; }
+
+    void write_SPDR(uint8_t data)
+    {
+        if(transfer_active) n_write_collisions++;
+        else shift_register = data;
+    }
+
+    //! ISR(SPI_STC_vect) of spi.c
+    void isr_transfer_complete()
+    {
+        const uint8_t received = read_SPDR();
+        write_SPDR(spi_slave.miso_next);
+        spi_slave_transfer_complete(&spi_slave, received);
+    }
+
+    //! ISR(PCINT0_vect) of spi.c
+    void isr_pin_change()
+    {
+        if(!selected) spi_slave_deselect(&spi_slave);
+        else write_SPDR(spi_slave_select(&spi_slave));
+    }
+
+    void set_slave_select(bool low)
+    {
+        selected = low;
+        isr_pin_change();
+        n_bytes = 0;
+    }
+
+    uint8_t clock_byte(uint8_t mosi)
+    {
+        assert(selected);
+        transfer_active = true;
+        const uint8_t miso = shift_register;
+        shift_register = mosi;
+        transfer_active = false;
+        receive_buffer = mosi;
+        isr_transfer_complete();
+        if(on_byte) on_byte(n_bytes);
+        n_bytes++;
+        return miso;
+    }
+
+    static void transfer_frame_callback(const uint8_t *mosi, uint8_t *miso, int n_bytes, void *context)
+    {
+        SimulatedSPI* spi = static_cast<SimulatedSPI*>(context);
+        for (int i = 0; i < n_bytes; ++i)
+        {
+            miso[i] = spi->clock_byte(mosi[i]);
+        }
+    }
+};
+
+/**
+ * \brief Bit errors on the bus, applied by a wrapper around SimulatedSPI::transfer_frame_callback
+ * \ingroup vehicle
+ */
+struct FaultyBus
+{
+    //! The slave
+    SimulatedSPI* spi;
+    //! Frames so far
+    int n_frames = 0;
+    //! Flip a mosi bit in this frame (1-based), 0 for none
+    int corrupt_mosi_frame = 0;
+
+    static void transfer_frame_callback(const uint8_t *mosi, uint8_t *miso, int n_bytes, void *context)
+    {
+        FaultyBus* bus = static_cast<FaultyBus*>(context);
+        bus->n_frames++;
+        uint8_t mosi_copy[SPI_BUFFER_SIZE];
+        memcpy(mosi_copy, mosi, n_bytes);
+        if(bus->n_frames == bus->corrupt_mosi_frame) mosi_copy[3] ^= 0x40;
+        SimulatedSPI::transfer_frame_callback(mosi_copy, miso, n_bytes, bus->spi);
+    }
+};
+
+/**
+ * \brief State packet with values derived from i
+ * \ingroup vehicle
+ */
+static spi_miso_data_t make_miso(int i)
+{
+    spi_miso_data_t packet;
+    memset(&packet, 0, sizeof(spi_miso_data_t));
+    packet.tick = 1000 + i;
+    packet.odometer_steps = -17 * i;
+    packet.imu_yaw = static_cast<uint16_t>(300 * i);
+    packet.speed = static_cast<int16_t>(i);
+    packet.battery_voltage = 800;
+    packet.status_flags = i % 2; // IMU status
+    return packet;
+}
+
+/**
+ * \brief Command packet with values derived from i
+ * \ingroup vehicle
+ */
+static spi_mosi_data_t make_mosi(int i)
+{
+    spi_mosi_data_t packet;
+    memset(&packet, 0, sizeof(spi_mosi_data_t));
+    packet.pi_tick = 5000 + i;
+    packet.motor_pwm = static_cast<int16_t>(i % 400);
+    packet.servo_command = static_cast<int16_t>(-i);
+    packet.motor_mode = SPI_MOTOR_MODE_FORWARD;
+    packet.vehicle_id = 3;
+    return packet;
+}
+
+/**
+ * \brief One exchange as on the vehicle: slave select low, spi_protocol_exchange, slave select high
+ * \ingroup vehicle
+ */
+static void exchange(SimulatedSPI& spi, spi_transfer_frame_t transfer_frame, void* context, spi_mosi_data_t mosi,
+    spi_miso_data_t& miso_out, int& attempts, int& successful)
+{
+    spi.set_slave_select(true);
+    spi_protocol_exchange(mosi, &miso_out, &attempts, &successful, transfer_frame, context);
+    spi.set_slave_select(false);
+}
+
+int main()
+{
+    crcInit();
+
+    // Incremental CRC as used in the interrupt
+    {
+        uint8_t message[40];
+        for (int i = 0; i < 40; ++i) message[i] = static_cast<uint8_t>(i * 37 + 11);
+        crc remainder = crcBegin();
+        for (int i = 0; i < 40; ++i) remainder = crcUpdate(remainder, message[i]);
+        assert(crcEnd(remainder) == crcFast(message, 40));
+    }
+
+    // Sequence of exchanges with the main loop in between, as in main.c
+    {
+        SimulatedSPI spi;
+        for (int i = 0; i < 200; ++i)
+        {
+            // main loop: sensors of this iteration are sent in the next exchange
+            const spi_miso_data_t packet_send = make_miso(i);
+            spi_slave_prepare(&spi.spi_slave, &packet_send);
+
+            spi_miso_data_t miso;
+            int attempts = 0;
+            int successful = 0;
+            const uint8_t n_exchanges = spi.spi_slave.n_exchanges;
+            exchange(spi, SimulatedSPI::transfer_frame_callback, &spi, make_mosi(i), miso, attempts, successful);
+
+            assert(spi.spi_slave.n_exchanges == static_cast<uint8_t>(n_exchanges + 1));
+            assert(successful == 1);
+            assert(attempts == 2); // the first answer always reports "mosi not received"
+            assert(miso.tick == packet_send.tick);
+            assert(miso.odometer_steps == packet_send.odometer_steps);
+            assert(miso.imu_yaw == packet_send.imu_yaw);
+            assert(miso.status_flags == packet_send.status_flags);
+
+            spi_mosi_data_t mosi;
+            memset(&mosi, 0, sizeof(spi_mosi_data_t));
+            assert(spi_slave_get_mosi(&spi.spi_slave, &mosi));
+            assert(mosi.pi_tick == make_mosi(i).pi_tick);
+            assert(mosi.motor_pwm == make_mosi(i).motor_pwm);
+            assert(mosi.servo_command == make_mosi(i).servo_command);
+            assert(mosi.vehicle_id == 3);
+            assert(!spi_slave_get_mosi(&spi.spi_slave, &mosi));
+        }
+        assert(spi.n_write_collisions == 0);
+    }
+
+    // The main loop prepares a new answer during a frame: the frame in flight is not torn,
+    // the new answer is used from the next frame on
+    {
+        SimulatedSPI spi;
+        const spi_miso_data_t packet_first = make_miso(1);
+        const spi_miso_data_t packet_second = make_miso(2);
+        spi_slave_prepare(&spi.spi_slave, &packet_first);
+        spi.on_byte = [&](int byte) {
+            if(byte == 10) spi_slave_prepare(&spi.spi_slave, &packet_second);
+        };
+
+        spi_miso_data_t miso;
+        int attempts = 0;
+        int successful = 0;
+        exchange(spi, SimulatedSPI::transfer_frame_callback, &spi, make_mosi(1), miso, attempts, successful);
+        assert(successful == 1 && attempts == 2);
+        assert(miso.tick == packet_second.tick); // second frame
+        assert(spi_protocol_check_CRC_miso(&miso));
+    }
+
+    // Corrupted mosi in the first frame: the slave reports it, the third frame succeeds
+    {
+        SimulatedSPI spi;
+        FaultyBus bus;
+        bus.spi = &spi;
+        bus.corrupt_mosi_frame = 1;
+        const spi_miso_data_t packet_send = make_miso(7);
+        spi_slave_prepare(&spi.spi_slave, &packet_send);
+
+        spi_miso_data_t miso;
+        int attempts = 0;
+        int successful = 0;
+        exchange(spi, FaultyBus::transfer_frame_callback, &bus, make_mosi(7), miso, attempts, successful);
+        assert(successful == 1 && attempts == 3);
+        assert(miso.tick == packet_send.tick);
+    }
+
+    // Corrupted mosi in all but the first frame: the packet of the first frame is used
+    {
+        SimulatedSPI spi;
+        FaultyBus bus;
+        bus.spi = &spi;
+        bus.corrupt_mosi_frame = 2;
+        const spi_miso_data_t packet_send = make_miso(8);
+        spi_slave_prepare(&spi.spi_slave, &packet_send);
+
+        spi_miso_data_t miso;
+        int attempts = 0;
+        int successful = 0;
+        exchange(spi, FaultyBus::transfer_frame_callback, &bus, make_mosi(8), miso, attempts, successful);
+        assert(successful == 1 && attempts == 2);
+
+        spi_mosi_data_t mosi;
+        assert(spi_slave_get_mosi(&spi.spi_slave, &mosi));
+        assert(mosi.pi_tick == make_mosi(8).pi_tick);
+    }
+
+    // Safe-mode after an exchange whose packet was not picked up: the packet is dropped,
+    // the next exchange after the safe-mode is received as usual
+    {
+        SimulatedSPI spi;
+        const spi_miso_data_t packet_send = make_miso(9);
+        spi_slave_prepare(&spi.spi_slave, &packet_send);
+
+        spi_miso_data_t miso;
+        int attempts = 0;
+        int successful = 0;
+        exchange(spi, SimulatedSPI::transfer_frame_callback, &spi, make_mosi(9), miso, attempts, successful);
+        assert(successful == 1);
+
+        spi_slave_discard_mosi(&spi.spi_slave);
+        spi_mosi_data_t mosi;
+        memset(&mosi, 0, sizeof(spi_mosi_data_t));
+        assert(!spi_slave_get_mosi(&spi.spi_slave, &mosi));
+        assert(mosi.pi_tick == 0);
+
+        exchange(spi, SimulatedSPI::transfer_frame_callback, &spi, make_mosi(10), miso, attempts, successful);
+        assert(successful == 1);
+        assert(spi_slave_get_mosi(&spi.spi_slave, &mosi));
+        assert(mosi.pi_tick == make_mosi(10).pi_tick);
+    }
+
+    // No exchange completed: nothing received
+    {
+        SimulatedSPI spi;
+        spi_mosi_data_t mosi;
+        assert(!spi_slave_get_mosi(&spi.spi_slave, &mosi));
+    }
+
+    std::cout << "All tests passed" << std::endl;
+    return 0;
+}